@@ -564,6 +564,8 @@ namespace C3D
             // Increase our capacity by the resize factor
             auto newCapacity = static_cast<u64>(static_cast<f32>(m_capacity) * resize_factor);
             if (newCapacity == 0) newCapacity = default_capacity;
+            // Small capacities (like 1) would not grow at all due to rounding so we always grow by at least one element
+            if (newCapacity <= m_capacity) newCapacity = m_capacity + 1;
 
             ReAlloc(newCapacity);
         }
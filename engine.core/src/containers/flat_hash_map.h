@@ -0,0 +1,579 @@
+#pragma once
+#include <bit>
+#include <cstring>
+#include <memory>
+
+#if defined(C3D_SIMD_SSE)
+#include <emmintrin.h>
+#endif
+
+#include "asserts/asserts.h"
+#include "defines.h"
+#include "memory/global_memory_system.h"
+
+namespace C3D
+{
+    constexpr auto FLAT_HASH_MAP_DEFAULT_CAPACITY    = 32;
+    constexpr auto FLAT_HASH_MAP_DEFAULT_LOAD_FACTOR = 0.875;
+    /** @brief The number of control bytes that are matched at once (the width of an SSE2 register). */
+    constexpr auto FLAT_HASH_MAP_GROUP_SIZE = 16;
+
+    /** @brief Control byte for a slot that has never been used. Full slots store a 7-bit tag so their highest bit is never set. */
+    constexpr i8 FLAT_HASH_MAP_EMPTY = -128;
+    /** @brief Control byte for a slot whose element was deleted (a tombstone). Probing has to continue past these slots. */
+    constexpr i8 FLAT_HASH_MAP_DELETED = -2;
+
+    /** @brief A group of control bytes that can be matched against a tag all at once. */
+    class FlatHashMapGroup
+    {
+    public:
+        /** @brief Loads the group starting at the provided control byte. NOTE: ctrl must be aligned to FLAT_HASH_MAP_GROUP_SIZE. */
+        explicit FlatHashMapGroup(const i8* ctrl)
+#if defined(C3D_SIMD_SSE)
+            : m_ctrl(_mm_load_si128(reinterpret_cast<const __m128i*>(ctrl)))
+#else
+            : m_ctrl(ctrl)
+#endif
+        {}
+
+        /** @brief Returns a mask with a bit set for every slot in this group with a control byte equal to the provided tag. */
+        [[nodiscard]] u32 Match(const i8 tag) const
+        {
+#if defined(C3D_SIMD_SSE)
+            return static_cast<u32>(_mm_movemask_epi8(_mm_cmpeq_epi8(m_ctrl, _mm_set1_epi8(tag))));
+#else
+            u32 mask = 0;
+            for (u32 i = 0; i < FLAT_HASH_MAP_GROUP_SIZE; ++i)
+            {
+                if (m_ctrl[i] == tag) mask |= 1u << i;
+            }
+            return mask;
+#endif
+        }
+
+        /** @brief Returns a mask with a bit set for every empty slot in this group. */
+        [[nodiscard]] u32 MatchEmpty() const { return Match(FLAT_HASH_MAP_EMPTY); }
+
+        /** @brief Returns a mask with a bit set for every empty or deleted slot in this group (the slots with the highest bit set). */
+        [[nodiscard]] u32 MatchEmptyOrDeleted() const
+        {
+#if defined(C3D_SIMD_SSE)
+            return static_cast<u32>(_mm_movemask_epi8(m_ctrl));
+#else
+            u32 mask = 0;
+            for (u32 i = 0; i < FLAT_HASH_MAP_GROUP_SIZE; ++i)
+            {
+                if (m_ctrl[i] < 0) mask |= 1u << i;
+            }
+            return mask;
+#endif
+        }
+
+        /** @brief Returns a mask with a bit set for every full slot in this group. */
+        [[nodiscard]] u32 MatchFull() const { return ~MatchEmptyOrDeleted() & 0xFFFF; }
+
+    private:
+#if defined(C3D_SIMD_SSE)
+        __m128i m_ctrl;
+#else
+        const i8* m_ctrl;
+#endif
+    };
+
+    /**
+     * @brief Implementation of a HashMap with Open-Adressing based on SwissTable.
+     * Next to the slots (which hold the keys and values) we store a separate array of 1-byte control values. Every control byte stores
+     * if a slot is empty, deleted or full. Full slots store 7 bits of the hash of their key. Lookups compare 16 control bytes at a time
+     * (with SSE2 when available) so we only ever touch the slots whose tag matches.
+     *
+     * When the HashFunc defines is_transparent (like std::hash<String> does) keys can be looked up with any type that the HashFunc
+     * accepts and that can be compared to a Key. For example a HashMap<String, u32> can be searched with a const char* without
+     * constructing a temporary String.
+     *
+     * @tparam Key The Key type used to index into the HashMap
+     * @tparam Value The Value type used with this HashMap
+     * @tparam HashFunc The HashFunction used to hash Keys before inserting them
+     * @tparam LF Determines when the HashMap needs to grow in size (0.0 < LoadFactor < 1.0, where a LoadFactor of 0.5 means that
+     * when the HashMap is 50% full we grow the HashMap)
+     * @tparam Allocator The allocator used by this HashMap
+     */
+    template <class Key, class Value, class HashFunc = std::hash<Key>, double LF = FLAT_HASH_MAP_DEFAULT_LOAD_FACTOR,
+              class Allocator = DynamicAllocator>
+    class FlatHashMap
+    {
+        static_assert(LF > 0.0, "The Load Factor of a FlatHashMap must be > 0.0");
+        static_assert(LF < 1.0, "The Load Factor of a FlatHashMap must be < 1.0 since lookups stop at the first empty slot");
+
+        /** @brief True if the HashFunc (and therefore this HashMap) supports lookups with types other than Key. */
+        static constexpr bool IS_TRANSPARENT = requires { typename HashFunc::is_transparent; };
+
+        template <class K>
+        static constexpr bool IsLookupKey = std::is_same_v<std::remove_cvref_t<K>, Key> || IS_TRANSPARENT;
+
+        class FlatHashMapIterator
+        {
+            void FindNextOccupiedIndex()
+            {
+                // We start at the element after our current element (which is at m_index)
+                u64 i = m_index + 1;
+                while (i < m_map->m_capacity)
+                {
+                    // Check all the remaining slots in the group that contains i at once
+                    const u64 groupStart = i & ~static_cast<u64>(FLAT_HASH_MAP_GROUP_SIZE - 1);
+                    const u32 mask       = FlatHashMapGroup(m_map->m_ctrl + groupStart).MatchFull() >> (i - groupStart);
+                    if (mask)
+                    {
+                        m_index = i + std::countr_zero(mask);
+                        return;
+                    }
+                    i = groupStart + FLAT_HASH_MAP_GROUP_SIZE;
+                }
+
+                // If we get to this part we could not find a next occupied element
+                // so we set our index to the end of the internal array
+                m_index = m_map->m_capacity;
+            }
+
+        public:
+            using DifferenceType    = std::ptrdiff_t;
+            using Pointer           = Value*;
+            using Reference         = Value&;
+            using iterator_category = std::forward_iterator_tag;
+
+            FlatHashMapIterator() = default;
+
+            explicit FlatHashMapIterator(const FlatHashMap* map) : m_index(INVALID_ID_U64), m_map(map) { FindNextOccupiedIndex(); }
+
+            FlatHashMapIterator(const FlatHashMap* map, const u64 currentIndex) : m_index(currentIndex), m_map(map) {}
+
+            // Dereference operator
+            Reference operator*() const { return m_map->m_slots[m_index].value; }
+
+            /** @brief Gets the key of the element that this iterator currently points to. */
+            const Key& GetKey() const { return m_map->m_slots[m_index].key; }
+
+            // Pre and post-increment operators
+            FlatHashMapIterator& operator++()
+            {
+                FindNextOccupiedIndex();
+                return *this;
+            }
+
+            FlatHashMapIterator operator++(int)
+            {
+                auto copy = *this;
+                FindNextOccupiedIndex();
+                return copy;
+            }
+
+            bool operator==(const FlatHashMapIterator& other) const { return m_map == other.m_map && m_index == other.m_index; }
+
+            bool operator!=(const FlatHashMapIterator& other) const { return m_map != other.m_map || m_index != other.m_index; }
+
+        private:
+            u64 m_index              = 0;
+            const FlatHashMap* m_map = nullptr;
+        };
+
+    public:
+        struct Slot
+        {
+            Key key;
+            Value value;
+        };
+
+        FlatHashMap(Allocator* allocator = BaseAllocator<Allocator>::GetDefault()) : m_allocator(allocator) {}
+
+        FlatHashMap(const FlatHashMap& other) { Copy(other); }
+        FlatHashMap& operator=(const FlatHashMap& other)
+        {
+            if (this != &other) Copy(other);
+            return *this;
+        }
+
+        FlatHashMap(FlatHashMap&&)            = delete;
+        FlatHashMap& operator=(FlatHashMap&&) = delete;
+
+        ~FlatHashMap() { Destroy(); }
+
+        void Create()
+        {
+            if (m_ctrl == nullptr)
+            {
+                Allocate(FLAT_HASH_MAP_DEFAULT_CAPACITY);
+            }
+        }
+
+        /**
+         * @brief Creates the HashMap with enough room for at least the provided number of elements (before it needs to grow).
+         */
+        void Create(const u64 count)
+        {
+            if (m_ctrl == nullptr)
+            {
+                Allocate(CapacityFor(count));
+            }
+        }
+
+        /**
+         * @brief Clears all the entries from the hashmap without destroying underlying memory
+         * meaning you can keep using the hashmap as if it was just freshly created
+         */
+        void Clear()
+        {
+            if (m_ctrl)
+            {
+                // Destroy all the occupied slots
+                for (u64 i = 0; i < m_capacity; ++i)
+                {
+                    if (m_ctrl[i] >= 0) std::destroy_at(&m_slots[i]);
+                }
+                // Mark every slot as empty again
+                std::memset(m_ctrl, FLAT_HASH_MAP_EMPTY, m_capacity);
+                // Reset the number of items
+                m_count      = 0;
+                m_growthLeft = MaxLoad(m_capacity);
+            }
+        }
+
+        /**
+         * @brief Destroys the Hashmap. This clears the Hashmap entirely and also deletes it's internal memory
+         */
+        void Destroy()
+        {
+            // First we clear (which calls the destructor for all active keys and values)
+            Clear();
+            // Then we free our actual memory
+            if (m_ctrl)
+            {
+                m_allocator->Free(m_ctrl);
+                m_allocator->Free(m_slots);
+                m_ctrl       = nullptr;
+                m_slots      = nullptr;
+                m_capacity   = 0;
+                m_growthLeft = 0;
+            }
+        }
+
+        /**
+         * @brief Inserts/Sets the provided <Key, Value> in the HashMap
+         * If there is a <Key, Value> pair with the same Key already, it's value will be overwritten
+         *
+         * @param key The key you want to use
+         * @param value The value you want to insert
+         */
+        void Set(Key key, Value value) { Insert(std::move(key), std::move(value)); }
+
+        /**
+         * @brief Inserts/Sets the provided <Key, Value> in the HashMap
+         * If there is a <Key, Value> pair with the same Key already, it's value will be overwritten
+         *
+         * @param key The key you want to use
+         * @param value The value you want to insert
+         */
+        void Insert(Key key, Value value)
+        {
+#ifdef _DEBUG
+            C3D_ASSERT_MSG(m_ctrl != nullptr, "Tried Insert() before FlatHashMap.Create() was called.");
+#endif
+            const auto hash  = Hash(key);
+            const auto index = FindIndex(key, hash);
+            if (index != INVALID_ID_U64)
+            {
+                // We have found our matching item so let's replace it's value
+                m_slots[index].value = std::move(value);
+                return;
+            }
+
+            if (m_growthLeft == 0)
+            {
+                // If at least half of our load is made up out of deleted slots we can simply rehash at the same capacity to clean them up
+                Rehash(m_count * 2 < MaxLoad(m_capacity) ? m_capacity : m_capacity * 2);
+            }
+
+            InsertUnique(hash, std::move(key), std::move(value));
+        }
+
+        /**
+         * @brief Deletes the <Key, Value> pair with the provided Key.
+         * If the <Key, Value> pair is not found, nothing will happen.
+         *
+         * @param key The Key of the <Key, Value> pair you want to remove
+         */
+        template <class K>
+            requires IsLookupKey<K>
+        void Delete(const K& key)
+        {
+            const auto index = FindIndex(key, Hash(key));
+            if (index == INVALID_ID_U64) return;
+
+            std::destroy_at(&m_slots[index]);
+            m_count--;
+
+            // If the group still contains an empty slot no lookup has ever continued past this group (since lookups stop at the first
+            // group with an empty slot). This means we can mark our slot as empty again instead of leaving a tombstone behind.
+            const u64 groupStart = index & ~static_cast<u64>(FLAT_HASH_MAP_GROUP_SIZE - 1);
+            if (FlatHashMapGroup(m_ctrl + groupStart).MatchEmpty())
+            {
+                m_ctrl[index] = FLAT_HASH_MAP_EMPTY;
+                m_growthLeft++;
+            }
+            else
+            {
+                m_ctrl[index] = FLAT_HASH_MAP_DELETED;
+            }
+        }
+
+        /**
+         * @brief Finds the Value out of the <Key, Value> pair with the provided Key.
+         *
+         * @param key The Key you want to search for
+         * @return A pointer to the value belonging to the provided Key or nullptr if the Key is not present
+         */
+        template <class K>
+            requires IsLookupKey<K>
+        [[nodiscard]] Value* Find(const K& key)
+        {
+            const auto index = FindIndex(key, Hash(key));
+            return index == INVALID_ID_U64 ? nullptr : &m_slots[index].value;
+        }
+
+        template <class K>
+            requires IsLookupKey<K>
+        [[nodiscard]] const Value* Find(const K& key) const
+        {
+            const auto index = FindIndex(key, Hash(key));
+            return index == INVALID_ID_U64 ? nullptr : &m_slots[index].value;
+        }
+
+        /**
+         * @brief Gets the Value out of the <Key, Value> pair with the provided Key.
+         *
+         * @param key The Key you want to search for
+         * @return A reference to the value belonging to the provided Key
+         */
+        template <class K>
+            requires IsLookupKey<K>
+        Value& Get(const K& key)
+        {
+            auto value = Find(key);
+            if (!value)
+            {
+                C3D_FAIL("The provided key does not exist");
+            }
+            return *value;
+        }
+
+        template <class K>
+            requires IsLookupKey<K>
+        [[nodiscard]] const Value& Get(const K& key) const
+        {
+            auto value = Find(key);
+            if (!value)
+            {
+                C3D_FAIL("The provided key does not exist");
+            }
+            return *value;
+        }
+
+        /**
+         * @brief Checks if the provided Key is present in the HashMap
+         *
+         * @param key The Key you want to check for.
+         * @return True if the key is present; False otherwise
+         */
+        template <class K>
+            requires IsLookupKey<K>
+        [[nodiscard]] bool Has(const K& key) const
+        {
+            return FindIndex(key, Hash(key)) != INVALID_ID_U64;
+        }
+
+        template <class K>
+            requires IsLookupKey<K>
+        [[nodiscard]] bool Contains(const K& key) const
+        {
+            return Has(key);
+        }
+
+        Value& operator[](const Key& key) { return Get(key); }
+
+        [[nodiscard]] const Value& operator[](const Key& key) const { return Get(key); }
+
+        [[nodiscard]] FlatHashMapIterator begin() const { return FlatHashMapIterator(this); }
+
+        [[nodiscard]] FlatHashMapIterator end() const { return FlatHashMapIterator(this, m_capacity); }
+
+        [[nodiscard]] u64 Capacity() const { return m_capacity; }
+
+        [[nodiscard]] u64 Count() const { return m_count; }
+
+        [[nodiscard]] double LoadFactor() const { return LF; }
+
+    private:
+        /** @brief Returns the number of elements that fit in the provided capacity before we need to grow. */
+        static u64 MaxLoad(const u64 capacity) { return static_cast<u64>(capacity * LF); }
+
+        /** @brief Returns the smallest valid capacity (a power of 2 and at least one group) that can hold the provided count. */
+        static u64 CapacityFor(const u64 count)
+        {
+            u64 capacity = FLAT_HASH_MAP_GROUP_SIZE;
+            while (MaxLoad(capacity) < count) capacity *= 2;
+            return capacity;
+        }
+
+        /**
+         * @brief Hashes the provided key and mixes the result.
+         * Our string hashes are FNV-style where the lower bits only depend on the lower bits of every character. Since we use the lower
+         * 7 bits as tag and the bits above that to pick a group we mix the hash to spread the entropy over all the bits.
+         */
+        template <class K>
+        static u64 Hash(const K& key)
+        {
+            u64 hash = HashFunc()(key);
+            hash ^= hash >> 33;
+            hash *= 0xFF51AFD7ED558CCDull;
+            hash ^= hash >> 33;
+            return hash;
+        }
+
+        /** @brief The 7-bit tag we store in the control byte of a full slot. */
+        static i8 Tag(const u64 hash) { return static_cast<i8>(hash & 0x7F); }
+
+        /** @brief The group where we start probing for the provided hash. */
+        u64 StartGroup(const u64 hash) const { return (hash >> 7) & (m_capacity / FLAT_HASH_MAP_GROUP_SIZE - 1); }
+
+        /**
+         * @brief Returns the index of the slot that contains the provided key (or INVALID_ID_U64 if it does not exist).
+         * We probe group by group (using triangular numbers which visits every group exactly once since our number of groups is always
+         * a power of 2). Within a group we only compare the keys of the slots with a matching tag and we can stop probing as soon as we
+         * find a group with an empty slot (since our key would have been inserted there).
+         */
+        template <class K>
+        u64 FindIndex(const K& key, const u64 hash) const
+        {
+            const u64 groupCount = m_capacity / FLAT_HASH_MAP_GROUP_SIZE;
+            const u64 groupMask  = groupCount - 1;
+            const i8 tag         = Tag(hash);
+
+            u64 group = StartGroup(hash);
+            for (u64 step = 1; step <= groupCount; ++step)
+            {
+                const u64 groupStart = group * FLAT_HASH_MAP_GROUP_SIZE;
+                const FlatHashMapGroup controls(m_ctrl + groupStart);
+
+                for (u32 mask = controls.Match(tag); mask; mask &= mask - 1)
+                {
+                    const u64 index = groupStart + std::countr_zero(mask);
+                    if (m_slots[index].key == key) return index;
+                }
+
+                if (controls.MatchEmpty()) return INVALID_ID_U64;
+
+                group = (group + step) & groupMask;
+            }
+            return INVALID_ID_U64;
+        }
+
+        /** @brief Inserts the provided key and value into the first empty or deleted slot. The key must not be present yet. */
+        void InsertUnique(const u64 hash, Key&& key, Value&& value)
+        {
+            const u64 groupMask = m_capacity / FLAT_HASH_MAP_GROUP_SIZE - 1;
+
+            u64 group = StartGroup(hash);
+            for (u64 step = 1;; ++step)
+            {
+                const u64 groupStart = group * FLAT_HASH_MAP_GROUP_SIZE;
+                const u32 mask       = FlatHashMapGroup(m_ctrl + groupStart).MatchEmptyOrDeleted();
+                if (mask)
+                {
+                    const u64 index = groupStart + std::countr_zero(mask);
+                    // Reusing a deleted slot does not take up any extra room
+                    if (m_ctrl[index] == FLAT_HASH_MAP_EMPTY) m_growthLeft--;
+
+                    m_ctrl[index] = Tag(hash);
+                    new (&m_slots[index]) Slot{ std::move(key), std::move(value) };
+                    m_count++;
+                    return;
+                }
+
+                group = (group + step) & groupMask;
+            }
+        }
+
+        void Allocate(const u64 capacity)
+        {
+            // NOTE: Our control bytes are aligned to the size of a group so every group can be loaded with an aligned load
+            m_ctrl = static_cast<i8*>(m_allocator->AllocateBlock(MemoryType::HashMap, capacity, FLAT_HASH_MAP_GROUP_SIZE));
+            // NOTE: The slots are not constructed until something is inserted into them
+            m_slots = static_cast<Slot*>(m_allocator->AllocateBlock(MemoryType::HashMap, capacity * sizeof(Slot), alignof(Slot)));
+            std::memset(m_ctrl, FLAT_HASH_MAP_EMPTY, capacity);
+
+            m_capacity   = capacity;
+            m_count      = 0;
+            m_growthLeft = MaxLoad(capacity);
+        }
+
+        void Rehash(const u64 newCapacity)
+        {
+            // Take a copy of our old capacity and data
+            const auto oldCapacity = m_capacity;
+            const auto oldCtrl     = m_ctrl;
+            const auto oldSlots    = m_slots;
+
+            Allocate(newCapacity);
+
+            // Move all our elements over (which rehashes them with our new capacity and gets rid of all tombstones)
+            for (u64 i = 0; i < oldCapacity; ++i)
+            {
+                if (oldCtrl[i] >= 0)
+                {
+                    auto& oldSlot = oldSlots[i];
+                    InsertUnique(Hash(oldSlot.key), std::move(oldSlot.key), std::move(oldSlot.value));
+                    std::destroy_at(&oldSlot);
+                }
+            }
+
+            // Free our old data
+            m_allocator->Free(oldCtrl);
+            m_allocator->Free(oldSlots);
+        }
+
+        void Copy(const FlatHashMap& other)
+        {
+            // We first destroy any data we might already have
+            Destroy();
+
+            m_allocator = other.m_allocator;
+
+            if (other.m_ctrl)
+            {
+                // The other HashMap has actual data which we need to copy. Since we use the same capacity every element can simply be
+                // copied into the same slot
+                Allocate(other.m_capacity);
+                std::memcpy(m_ctrl, other.m_ctrl, m_capacity);
+                for (u64 i = 0; i < m_capacity; ++i)
+                {
+                    if (m_ctrl[i] >= 0) new (&m_slots[i]) Slot{ other.m_slots[i].key, other.m_slots[i].value };
+                }
+
+                m_count      = other.m_count;
+                m_growthLeft = other.m_growthLeft;
+            }
+        }
+
+        /** @brief The control bytes (one for every slot). */
+        i8* m_ctrl = nullptr;
+        /** @brief The underlying array of slots. */
+        Slot* m_slots = nullptr;
+
+        /** @brief The total number of slots in this HashMap (always a power of 2 and a multiple of FLAT_HASH_MAP_GROUP_SIZE). */
+        u64 m_capacity = 0;
+        /** @brief The number of items stored in this HashMap. */
+        u64 m_count = 0;
+        /** @brief The number of empty slots we can still fill before we need to grow (deleted slots do not count as empty). */
+        u64 m_growthLeft = 0;
+        /** @brief A pointer to the allocator to be used by this HashMap. */
+        Allocator* m_allocator = nullptr;
+    };
+}  // namespace C3D
@@ -0,0 +1,180 @@
+#include "cson_binary.h"
+
+#include <bit>
+#include <cstring>
+
+#include "string/string_utils.h"
+
+namespace C3D
+{
+    const static vec4 emptyVec = { 0, 0, 0, 0 };
+
+    static CSONStringView GetStringAt(const u8* base, const u64 offset)
+    {
+        // Every string is stored as a u32 length followed by it's (null-terminated) characters
+        u32 length;
+        std::memcpy(&length, base + offset, sizeof(u32));
+        return CSONStringView(reinterpret_cast<const char*>(base + offset + sizeof(u32)), length);
+    }
+
+    bool CSONStringView::Equals(const char* other) const
+    {
+        return std::strncmp(m_data, other, m_size) == 0 && other[m_size] == '\0';
+    }
+
+    bool CSONStringView::IEquals(const char* other) const
+    {
+        return StringUtils::IEquals(m_data, other, static_cast<i32>(m_size)) && other[m_size] == '\0';
+    }
+
+    CSONStringView CSONPropertyView::GetName() const
+    {
+        if (m_property->name == 0) return CSONStringView();
+        return GetStringAt(m_base, m_property->name);
+    }
+
+    bool CSONPropertyView::IsBasicType() const
+    {
+        return m_property->type == PropertyTypeBool || m_property->type == PropertyTypeF64 || m_property->type == PropertyTypeI64;
+    }
+
+    bool CSONPropertyView::GetBool() const
+    {
+        if (m_property->type == PropertyTypeBool)
+        {
+            return m_property->value != 0;
+        }
+        ERROR_LOG("Property: '{}' does not hold a bool. Returning false.", GetName().Data());
+        return false;
+    }
+
+    i64 CSONPropertyView::GetI64() const
+    {
+        if (m_property->type == PropertyTypeI64)
+        {
+            return std::bit_cast<i64>(m_property->value);
+        }
+        ERROR_LOG("Property: '{}' does not hold a i64. Returning 0.", GetName().Data());
+        return 0;
+    }
+
+    f64 CSONPropertyView::GetF64() const
+    {
+        if (m_property->type == PropertyTypeF64)
+        {
+            return std::bit_cast<f64>(m_property->value);
+        }
+        ERROR_LOG("Property: '{}' does not hold a f64. Returning 0.0.", GetName().Data());
+        return 0.0;
+    }
+
+    f32 CSONPropertyView::GetF32() const
+    {
+        if (m_property->type == PropertyTypeF64)
+        {
+            return static_cast<f32>(std::bit_cast<f64>(m_property->value));
+        }
+        ERROR_LOG("Property: '{}' does not hold a f64. Returning 0.0.", GetName().Data());
+        return 0.0f;
+    }
+
+    CSONStringView CSONPropertyView::GetString() const
+    {
+        if (m_property->type == PropertyTypeString)
+        {
+            return GetStringAt(m_base, m_property->value);
+        }
+        ERROR_LOG("Property: '{}' does not hold a String. Returning empty string.", GetName().Data());
+        return CSONStringView();
+    }
+
+    CSONObjectView CSONPropertyView::GetObject() const
+    {
+        if (m_property->type == PropertyTypeObject)
+        {
+            return CSONObjectView(m_base, reinterpret_cast<const CSONBinaryObject*>(m_base + m_property->value));
+        }
+        ERROR_LOG("Property: '{}' does not hold a CSONObject. Returning empty CSONObject.", GetName().Data());
+        return CSONObjectView();
+    }
+
+    CSONObjectView CSONPropertyView::GetArray() const
+    {
+        if (m_property->type == PropertyTypeObject)
+        {
+            return CSONObjectView(m_base, reinterpret_cast<const CSONBinaryObject*>(m_base + m_property->value));
+        }
+        ERROR_LOG("Property: '{}' does not hold a CSONArray. Returning empty CSONArray.", GetName().Data());
+        return CSONObjectView();
+    }
+
+    vec4 CSONPropertyView::GetVec4() const
+    {
+        if (m_property->type == PropertyTypeObject)
+        {
+            const auto array = GetArray();
+            if (array.Size() != 4)
+            {
+                ERROR_LOG("Property: '{}' does not hold a 4 element array.", GetName().Data());
+                return emptyVec;
+            }
+
+            return vec4(array[0].GetF64(), array[1].GetF64(), array[2].GetF64(), array[3].GetF64());
+        }
+
+        ERROR_LOG("Property: '{}' does not hold an array.", GetName().Data());
+        return emptyVec;
+    }
+
+    bool CSONObjectView::Find(const char* name, CSONPropertyView& property) const
+    {
+        for (const auto current : *this)
+        {
+            if (current.GetName() == name)
+            {
+                property = current;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool CSONObjectView::Has(const char* name) const
+    {
+        CSONPropertyView property;
+        return Find(name, property);
+    }
+
+    CSONObject CSONObjectView::ToObject() const
+    {
+        CSONObject object(GetType());
+        object.properties.Reserve(Size());
+
+        for (const auto property : *this)
+        {
+            auto& p = object.properties.EmplaceBack();
+            if (!property.GetName().Empty()) p.name = property.GetName().ToString();
+
+            switch (property.GetType())
+            {
+                case PropertyTypeI64:
+                    p.value = property.GetI64();
+                    break;
+                case PropertyTypeF64:
+                    p.value = property.GetF64();
+                    break;
+                case PropertyTypeBool:
+                    p.value = property.GetBool();
+                    break;
+                case PropertyTypeString:
+                    p.value = property.GetString().ToString();
+                    break;
+                case PropertyTypeObject:
+                    p.value = property.GetObject().ToObject();
+                    break;
+            }
+        }
+
+        return object;
+    }
+}  // namespace C3D
@@ -0,0 +1,186 @@
+#pragma once
+#include "cson_types.h"
+#include "defines.h"
+
+namespace C3D
+{
+    /*
+     * Binary CSON layout (all values are little-endian and every offset is relative to the start of the data):
+     *
+     * CSONBinaryHeader
+     * String pool:  For every unique string (names and values) a u32 length followed by the characters and a null-terminator.
+     *               Every string starts on a 4 byte boundary.
+     * Objects:      For every object (and array) a CSONBinaryObject followed by it's CSONBinaryProperty entries.
+     *               Every object starts on an 8 byte boundary so the values can be read in place.
+     */
+
+    /** @brief The magic number at the start of every binary CSON file ("CSNB"). */
+    constexpr u32 CSON_BINARY_MAGIC = 0x424E5343;
+    /** @brief The current version of the binary CSON format. */
+    constexpr u32 CSON_BINARY_VERSION = 1;
+    /** @brief The file extension used for binary CSON files. */
+    constexpr auto CSON_BINARY_FILE_EXTENSION = "csonb";
+
+    struct CSONBinaryHeader
+    {
+        u32 magic   = CSON_BINARY_MAGIC;
+        u32 version = CSON_BINARY_VERSION;
+        /** @brief The total size of the binary data in bytes (including this header). */
+        u64 size = 0;
+        /** @brief The offset of the root object. */
+        u32 root = 0;
+        /** @brief The number of strings in the string pool. */
+        u32 stringCount = 0;
+    };
+
+    struct CSONBinaryObject
+    {
+        /** @brief The CSONObjectType of this object. */
+        u32 type = 0;
+        /** @brief The number of properties that directly follow this object. */
+        u32 count = 0;
+    };
+
+    struct CSONBinaryProperty
+    {
+        /** @brief The offset of the name of this property in the string pool (or 0 for properties that are part of an array). */
+        u32 name = 0;
+        /** @brief The CSONPropertyValueType of this property. */
+        u32 type = 0;
+        /** @brief The value (i64, f64 or bool) or the offset of the string or object for strings and objects. */
+        u64 value = 0;
+    };
+
+    static_assert(sizeof(CSONBinaryHeader) == 24);
+    static_assert(sizeof(CSONBinaryObject) == 8);
+    static_assert(sizeof(CSONBinaryProperty) == 16);
+
+    /** @brief A non-owning view of a string that is stored in (binary or text) CSON data. */
+    class C3D_API CSONStringView
+    {
+    public:
+        CSONStringView() = default;
+        CSONStringView(const char* data, const u32 size) : m_data(data), m_size(size) {}
+
+        /** @brief Gets a pointer to the characters of this string. Only strings in binary CSON data are null-terminated. */
+        [[nodiscard]] const char* Data() const { return m_data; }
+        [[nodiscard]] u32 Size() const { return m_size; }
+        [[nodiscard]] bool Empty() const { return m_size == 0; }
+
+        [[nodiscard]] bool Equals(const char* other) const;
+        [[nodiscard]] bool IEquals(const char* other) const;
+
+        bool operator==(const char* other) const { return Equals(other); }
+
+        /** @brief Copies the characters into a String. */
+        [[nodiscard]] String ToString() const { return String(m_data, m_size); }
+
+    private:
+        const char* m_data = "";
+        u32 m_size         = 0;
+    };
+
+    class CSONObjectView;
+
+    /** @brief A non-owning view of a property in binary CSON data. All values are read in place without allocating. */
+    class C3D_API CSONPropertyView
+    {
+    public:
+        CSONPropertyView() = default;
+        CSONPropertyView(const u8* base, const CSONBinaryProperty* property) : m_base(base), m_property(property) {}
+
+        [[nodiscard]] bool IsValid() const { return m_property != nullptr; }
+
+        /** @brief Gets the name of this property. Will be empty for properties that are part of an array. */
+        [[nodiscard]] CSONStringView GetName() const;
+
+        [[nodiscard]] u32 GetType() const { return m_property->type; }
+        [[nodiscard]] bool IsBasicType() const;
+
+        [[nodiscard]] bool GetBool() const;
+        [[nodiscard]] i64 GetI64() const;
+        [[nodiscard]] f64 GetF64() const;
+        [[nodiscard]] f32 GetF32() const;
+        [[nodiscard]] CSONStringView GetString() const;
+
+        [[nodiscard]] CSONObjectView GetObject() const;
+        [[nodiscard]] CSONObjectView GetArray() const;
+
+        [[nodiscard]] vec4 GetVec4() const;
+
+    private:
+        const u8* m_base                     = nullptr;
+        const CSONBinaryProperty* m_property = nullptr;
+    };
+
+    /** @brief A non-owning view of an object (or array) in binary CSON data. */
+    class C3D_API CSONObjectView
+    {
+    public:
+        class Iterator
+        {
+        public:
+            Iterator() = default;
+            Iterator(const u8* base, const CSONBinaryProperty* property) : m_base(base), m_property(property) {}
+
+            CSONPropertyView operator*() const { return CSONPropertyView(m_base, m_property); }
+
+            Iterator& operator++()
+            {
+                m_property++;
+                return *this;
+            }
+
+            bool operator==(const Iterator& other) const { return m_property == other.m_property; }
+            bool operator!=(const Iterator& other) const { return m_property != other.m_property; }
+
+        private:
+            const u8* m_base                     = nullptr;
+            const CSONBinaryProperty* m_property = nullptr;
+        };
+
+        CSONObjectView() = default;
+        CSONObjectView(const u8* base, const CSONBinaryObject* object) : m_base(base), m_object(object) {}
+
+        [[nodiscard]] bool IsValid() const { return m_object != nullptr; }
+
+        [[nodiscard]] CSONObjectType GetType() const
+        {
+            return m_object ? static_cast<CSONObjectType>(m_object->type) : CSONObjectType::Object;
+        }
+        [[nodiscard]] bool IsArray() const { return GetType() == CSONObjectType::Array; }
+
+        [[nodiscard]] u32 Size() const { return m_object ? m_object->count : 0; }
+        [[nodiscard]] bool IsEmpty() const { return Size() == 0; }
+
+        /** @brief Gets the property at the provided index. */
+        [[nodiscard]] CSONPropertyView operator[](const u32 index) const { return CSONPropertyView(m_base, Properties() + index); }
+
+        /**
+         * @brief Finds the property with the provided name.
+         *
+         * @param name The name of the property you are looking for
+         * @param property The view that will be set to the property if it is found
+         * @return True if the property was found; False otherwise
+         */
+        bool Find(const char* name, CSONPropertyView& property) const;
+
+        [[nodiscard]] bool Has(const char* name) const;
+
+        /** @brief Converts this view (and all of it's children) into a CSONObject that owns all of it's data. */
+        [[nodiscard]] CSONObject ToObject() const;
+
+        [[nodiscard]] Iterator begin() const { return Iterator(m_base, Properties()); }
+        [[nodiscard]] Iterator end() const { return Iterator(m_base, Properties() + Size()); }
+
+    private:
+        const CSONBinaryProperty* Properties() const
+        {
+            // The properties of an object are stored directly after it
+            return m_object ? reinterpret_cast<const CSONBinaryProperty*>(m_object + 1) : nullptr;
+        }
+
+        const u8* m_base                 = nullptr;
+        const CSONBinaryObject* m_object = nullptr;
+    };
+}  // namespace C3D
@@ -0,0 +1,177 @@
+#include "cson_binary_reader.h"
+
+#include <cstring>
+
+#include "logger/logger.h"
+
+namespace C3D
+{
+    /** @brief The maximum depth of nested objects that we accept. */
+    constexpr u32 CSON_BINARY_MAX_DEPTH = 256;
+
+    bool CSONBinaryReader::Open(const String& path)
+    {
+        Close();
+
+        if (!m_file.Open(path))
+        {
+            ERROR_LOG("Failed to open binary CSON file: '{}'.", path);
+            return false;
+        }
+
+        if (!Open(m_file.GetData(), m_file.GetSize()))
+        {
+            ERROR_LOG("The file: '{}' does not contain valid binary CSON.", path);
+            m_file.Close();
+            return false;
+        }
+
+        return true;
+    }
+
+    bool CSONBinaryReader::Open(const u8* data, const u64 size)
+    {
+        m_data = data;
+        m_size = size;
+
+        if (!Validate())
+        {
+            m_data = nullptr;
+            m_size = 0;
+            return false;
+        }
+        return true;
+    }
+
+    void CSONBinaryReader::Close()
+    {
+        m_file.Close();
+        m_data = nullptr;
+        m_size = 0;
+    }
+
+    CSONObjectView CSONBinaryReader::GetRoot() const
+    {
+        if (!m_data) return CSONObjectView();
+
+        const auto header = reinterpret_cast<const CSONBinaryHeader*>(m_data);
+        return CSONObjectView(m_data, reinterpret_cast<const CSONBinaryObject*>(m_data + header->root));
+    }
+
+    bool CSONBinaryReader::IsBinary(const u8* data, const u64 size)
+    {
+        if (!data || size < sizeof(CSONBinaryHeader)) return false;
+
+        u32 magic;
+        std::memcpy(&magic, data, sizeof(u32));
+        return magic == CSON_BINARY_MAGIC;
+    }
+
+    bool CSONBinaryReader::Validate() const
+    {
+        if (!IsBinary(m_data, m_size))
+        {
+            ERROR_LOG("Data does not start with a binary CSON header.");
+            return false;
+        }
+
+        if (reinterpret_cast<uintptr_t>(m_data) % alignof(CSONBinaryProperty) != 0)
+        {
+            ERROR_LOG("Binary CSON data must be aligned to at least: {} bytes.", alignof(CSONBinaryProperty));
+            return false;
+        }
+
+        const auto header = reinterpret_cast<const CSONBinaryHeader*>(m_data);
+        if (header->version != CSON_BINARY_VERSION)
+        {
+            ERROR_LOG("Unsupported binary CSON version: {} (expected: {}).", header->version, CSON_BINARY_VERSION);
+            return false;
+        }
+
+        if (header->size > m_size)
+        {
+            ERROR_LOG("Binary CSON data is truncated ({} bytes instead of {}).", m_size, header->size);
+            return false;
+        }
+
+        // Check that every offset in the data points to something within the data so all the views can be used without any checks
+        return ValidateObject(header->root, 0);
+    }
+
+    bool CSONBinaryReader::ValidateObject(const u64 offset, const u32 depth) const
+    {
+        if (depth > CSON_BINARY_MAX_DEPTH)
+        {
+            ERROR_LOG("Binary CSON data exceeds the maximum depth of: {}.", CSON_BINARY_MAX_DEPTH);
+            return false;
+        }
+
+        if (offset < sizeof(CSONBinaryHeader) || offset % alignof(CSONBinaryProperty) != 0 || offset + sizeof(CSONBinaryObject) > m_size)
+        {
+            ERROR_LOG("Binary CSON object at offset: {} is invalid.", offset);
+            return false;
+        }
+
+        const auto object = reinterpret_cast<const CSONBinaryObject*>(m_data + offset);
+        if (object->type > static_cast<u32>(CSONObjectType::Array))
+        {
+            ERROR_LOG("Binary CSON object at offset: {} has an invalid type.", offset);
+            return false;
+        }
+
+        const u64 propertiesStart = offset + sizeof(CSONBinaryObject);
+        const u64 propertiesEnd   = propertiesStart + static_cast<u64>(object->count) * sizeof(CSONBinaryProperty);
+        if (propertiesEnd > m_size)
+        {
+            ERROR_LOG("Binary CSON object at offset: {} has more properties than fit in the data.", offset);
+            return false;
+        }
+
+        const auto properties = reinterpret_cast<const CSONBinaryProperty*>(m_data + propertiesStart);
+        for (u32 i = 0; i < object->count; ++i)
+        {
+            const auto& property = properties[i];
+            if (property.name != 0 && !ValidateString(property.name)) return false;
+
+            switch (property.type)
+            {
+                case PropertyTypeI64:
+                case PropertyTypeF64:
+                case PropertyTypeBool:
+                    break;
+                case PropertyTypeString:
+                    if (!ValidateString(property.value)) return false;
+                    break;
+                case PropertyTypeObject:
+                    // Children are always stored after their parent which guarantees that there are no cycles
+                    if (property.value < propertiesEnd || !ValidateObject(property.value, depth + 1)) return false;
+                    break;
+                default:
+                    ERROR_LOG("Binary CSON property has an invalid type: {}.", property.type);
+                    return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool CSONBinaryReader::ValidateString(const u64 offset) const
+    {
+        if (offset < sizeof(CSONBinaryHeader) || offset + sizeof(u32) > m_size)
+        {
+            ERROR_LOG("Binary CSON string at offset: {} is invalid.", offset);
+            return false;
+        }
+
+        u32 length;
+        std::memcpy(&length, m_data + offset, sizeof(u32));
+
+        const u64 end = offset + sizeof(u32) + length;
+        if (end >= m_size || m_data[end] != '\0')
+        {
+            ERROR_LOG("Binary CSON string at offset: {} is invalid.", offset);
+            return false;
+        }
+        return true;
+    }
+}  // namespace C3D
@@ -0,0 +1,52 @@
+#pragma once
+#include "cson_binary.h"
+#include "defines.h"
+#include "platform/mapped_file.h"
+
+namespace C3D
+{
+    /**
+     * @brief Reads binary CSON data (as written by CSONWriter::WriteBinary()) without copying or allocating anything.
+     * Files are mapped into memory and all names and values are read in place through the CSONObjectView and CSONPropertyView types.
+     * Views remain valid until the reader is closed, opened again or destroyed.
+     */
+    class C3D_API CSONBinaryReader
+    {
+    public:
+        /**
+         * @brief Maps the binary CSON file at the provided path into memory and validates it.
+         *
+         * @param path The path to the binary CSON file
+         * @return True if successful; False otherwise
+         */
+        bool Open(const String& path);
+
+        /**
+         * @brief Uses the provided binary CSON data. The data is not copied so it must remain valid while this reader is used.
+         * The data must be aligned to at least 8 bytes.
+         *
+         * @param data A pointer to the binary CSON data
+         * @param size The size of the data in bytes
+         * @return True if the data is valid binary CSON; False otherwise
+         */
+        bool Open(const u8* data, u64 size);
+
+        void Close();
+
+        /** @brief Gets a view of the root object. Will be an invalid view if no (valid) data is opened. */
+        [[nodiscard]] CSONObjectView GetRoot() const;
+
+        /** @brief Checks if the provided data starts with a binary CSON header. */
+        [[nodiscard]] static bool IsBinary(const u8* data, u64 size);
+
+    private:
+        bool Validate() const;
+        bool ValidateObject(u64 offset, u32 depth) const;
+        bool ValidateString(u64 offset) const;
+
+        MappedFile m_file;
+
+        const u8* m_data = nullptr;
+        u64 m_size       = 0;
+    };
+}  // namespace C3D
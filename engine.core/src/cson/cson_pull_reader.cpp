@@ -0,0 +1,483 @@
+#include "cson_pull_reader.h"
+
+#include <bit>
+#include <charconv>
+#include <cstring>
+
+#include "logger/logger.h"
+#include "math/c3d_math.h"
+#include "string/string_utils.h"
+
+#if defined(C3D_SIMD_SSE)
+#include <emmintrin.h>
+#endif
+
+namespace C3D
+{
+    /** @brief The maximum number of characters that we show of the input when a parsing error occurs. */
+    constexpr u64 CSON_ERROR_CONTEXT_LENGTH = 16;
+
+    static bool IsWhitespace(const char c) { return c == ' ' || c == '\n' || c == '\r' || c == '\t'; }
+
+    bool CSONEvent::GetBool() const
+    {
+        if (type == CSONEventType::Bool) return boolValue;
+
+        ERROR_LOG("Property: '{}' does not hold a bool. Returning false.", name.ToString());
+        return false;
+    }
+
+    i64 CSONEvent::GetI64() const
+    {
+        if (type == CSONEventType::I64) return i64Value;
+
+        ERROR_LOG("Property: '{}' does not hold a i64. Returning 0.", name.ToString());
+        return 0;
+    }
+
+    f64 CSONEvent::GetF64() const
+    {
+        if (type == CSONEventType::F64) return f64Value;
+        if (type == CSONEventType::I64) return static_cast<f64>(i64Value);
+
+        ERROR_LOG("Property: '{}' does not hold a f64. Returning 0.0.", name.ToString());
+        return 0.0;
+    }
+
+    f32 CSONEvent::GetF32() const { return static_cast<f32>(GetF64()); }
+
+    CSONStringView CSONEvent::GetString() const
+    {
+        if (type == CSONEventType::String) return stringValue;
+
+        ERROR_LOG("Property: '{}' does not hold a String. Returning empty string.", name.ToString());
+        return CSONStringView();
+    }
+
+    CSONPullReader::CSONPullReader(const char* data, const u64 size) { Reset(data, size); }
+
+    CSONPullReader::CSONPullReader(const String& input) { Reset(input.Data(), input.Size()); }
+
+    CSONPullReader::CSONPullReader(const CSONObjectView& root) { Reset(root); }
+
+    void CSONPullReader::Reset(const char* data, const u64 size)
+    {
+        m_pos             = data;
+        m_end             = data + size;
+        m_binaryRoot      = CSONObjectView();
+        m_binary          = false;
+        m_depth           = 0;
+        m_line            = 1;
+        m_expectSeparator = false;
+        m_started         = false;
+        m_error           = false;
+    }
+
+    void CSONPullReader::Reset(const CSONObjectView& root)
+    {
+        Reset(nullptr, 0);
+        m_binaryRoot = root;
+        m_binary     = true;
+    }
+
+    bool CSONPullReader::Next(CSONEvent& event)
+    {
+        event.name = CSONStringView();
+
+        if (m_error)
+        {
+            event.type = CSONEventType::Error;
+            return false;
+        }
+
+        return m_binary ? NextBinary(event) : NextText(event);
+    }
+
+    bool CSONPullReader::NextMember(CSONEvent& event)
+    {
+        if (!Next(event)) return false;
+        return event.type != CSONEventType::EndObject && event.type != CSONEventType::EndArray;
+    }
+
+    bool CSONPullReader::Skip(const CSONEvent& event)
+    {
+        if (event.type != CSONEventType::StartObject && event.type != CSONEventType::StartArray) return !m_error;
+
+        // We keep reading until the object or array that was started by this event is closed again
+        const auto depth = m_depth - 1;
+
+        CSONEvent current;
+        while (m_depth > depth)
+        {
+            if (!Next(current)) return false;
+        }
+        return true;
+    }
+
+    bool CSONPullReader::ReadF32Array(const CSONEvent& event, f32* values, const u32 count)
+    {
+        if (!event.IsArray())
+        {
+            ERROR_LOG("Property: '{}' does not hold an array.", event.name.ToString());
+            Skip(event);
+            return false;
+        }
+
+        u32 index  = 0;
+        bool valid = true;
+
+        CSONEvent value;
+        while (NextMember(value))
+        {
+            if (index < count && value.IsNumber())
+            {
+                values[index] = value.GetF32();
+            }
+            else
+            {
+                valid = false;
+                Skip(value);
+            }
+            index++;
+        }
+
+        return valid && !m_error && index == count;
+    }
+
+    bool CSONPullReader::ReadVec4(const CSONEvent& event, vec4& value)
+    {
+        f32 values[4];
+        if (!ReadF32Array(event, values, 4)) return false;
+
+        value = vec4(values[0], values[1], values[2], values[3]);
+        return true;
+    }
+
+    bool CSONPullReader::NextText(CSONEvent& event)
+    {
+        SkipWhitespace();
+
+        if (m_depth == 0)
+        {
+            if (m_started || m_pos == m_end)
+            {
+                // After the root object (or array) only whitespace and comments are allowed
+                if (m_pos != m_end) return Error(event, "end of file");
+
+                m_started  = true;
+                event.type = CSONEventType::EndOfFile;
+                return false;
+            }
+
+            m_started = true;
+            if (*m_pos == '{')
+            {
+                m_pos++;
+                return Push(CSONObjectType::Object, event);
+            }
+            if (*m_pos == '[')
+            {
+                m_pos++;
+                return Push(CSONObjectType::Array, event);
+            }
+            return Error(event, "{ or [");
+        }
+
+        const auto type     = m_stack[m_depth - 1].type;
+        const auto isObject = type == CSONObjectType::Object;
+        const auto closer   = isObject ? '}' : ']';
+
+        if (m_expectSeparator)
+        {
+            if (m_pos != m_end && *m_pos == ',')
+            {
+                m_pos++;
+                m_expectSeparator = false;
+                SkipWhitespace();
+            }
+            else if (m_pos != m_end && *m_pos == closer)
+            {
+                m_pos++;
+                return Pop(type, event);
+            }
+            else
+            {
+                return Error(event, isObject ? "',' or '}'" : "',' or ']'");
+            }
+        }
+
+        // Empty objects and arrays (or a trailing comma) are closed right away
+        if (m_pos != m_end && *m_pos == closer)
+        {
+            m_pos++;
+            return Pop(type, event);
+        }
+
+        if (isObject)
+        {
+            if (m_pos == m_end || *m_pos != '"' || !ReadString(event.name)) return Error(event, "string literal key or }");
+
+            SkipWhitespace();
+            if (m_pos == m_end || *m_pos != ':') return Error(event, ":");
+
+            m_pos++;
+            SkipWhitespace();
+        }
+
+        return ReadValue(event);
+    }
+
+    bool CSONPullReader::NextBinary(CSONEvent& event)
+    {
+        if (m_depth == 0)
+        {
+            if (m_started || !m_binaryRoot.IsValid())
+            {
+                event.type = CSONEventType::EndOfFile;
+                return false;
+            }
+
+            m_started = true;
+            return Push(m_binaryRoot.GetType(), event, m_binaryRoot);
+        }
+
+        auto& top = m_stack[m_depth - 1];
+        if (top.current == top.end) return Pop(top.type, event);
+
+        const auto property = *top.current;
+        ++top.current;
+
+        event.name = property.GetName();
+        switch (property.GetType())
+        {
+            case PropertyTypeI64:
+                event.type     = CSONEventType::I64;
+                event.i64Value = property.GetI64();
+                return true;
+            case PropertyTypeF64:
+                event.type     = CSONEventType::F64;
+                event.f64Value = property.GetF64();
+                return true;
+            case PropertyTypeBool:
+                event.type      = CSONEventType::Bool;
+                event.boolValue = property.GetBool();
+                return true;
+            case PropertyTypeString:
+                event.type        = CSONEventType::String;
+                event.stringValue = property.GetString();
+                return true;
+            case PropertyTypeObject:
+            {
+                const auto object = property.GetObject();
+                return Push(object.GetType(), event, object);
+            }
+            default:
+                return Error(event, "a valid property type");
+        }
+    }
+
+    bool CSONPullReader::ReadValue(CSONEvent& event)
+    {
+        if (m_pos == m_end) return Error(event, "a valid value");
+
+        const auto remaining = static_cast<u64>(m_end - m_pos);
+        switch (*m_pos)
+        {
+            case '{':
+                m_pos++;
+                return Push(CSONObjectType::Object, event);
+            case '[':
+                m_pos++;
+                return Push(CSONObjectType::Array, event);
+            case '"':
+                if (!ReadString(event.stringValue)) return Error(event, "a closing '\"'");
+                event.type        = CSONEventType::String;
+                m_expectSeparator = true;
+                return true;
+            case '-':
+            case '0':
+            case '1':
+            case '2':
+            case '3':
+            case '4':
+            case '5':
+            case '6':
+            case '7':
+            case '8':
+            case '9':
+                return ReadNumber(event);
+            case 't':
+            case 'T':
+                if (remaining >= 4 && StringUtils::IEquals(m_pos, "true", 4))
+                {
+                    m_pos += 4;
+                    event.type        = CSONEventType::Bool;
+                    event.boolValue   = true;
+                    m_expectSeparator = true;
+                    return true;
+                }
+                break;
+            case 'f':
+            case 'F':
+                if (remaining >= 5 && StringUtils::IEquals(m_pos, "false", 5))
+                {
+                    m_pos += 5;
+                    event.type        = CSONEventType::Bool;
+                    event.boolValue   = false;
+                    m_expectSeparator = true;
+                    return true;
+                }
+                break;
+        }
+
+        return Error(event, "a valid value");
+    }
+
+    bool CSONPullReader::ReadString(CSONStringView& str)
+    {
+        // Strings have no escape sequences so they simply end at the next '"'
+        const auto start = m_pos + 1;
+        const auto close = static_cast<const char*>(std::memchr(start, '"', m_end - start));
+        if (!close) return false;
+
+        str   = CSONStringView(start, static_cast<u32>(close - start));
+        m_pos = close + 1;
+        return true;
+    }
+
+    bool CSONPullReader::ReadNumber(CSONEvent& event)
+    {
+        const auto start = m_pos;
+        auto end         = m_pos;
+        if (*end == '-') end++;
+
+        bool isFloat = false;
+        while (end != m_end)
+        {
+            const auto c = *end;
+            if (c >= '0' && c <= '9')
+            {
+                end++;
+            }
+            else if (c == '.' || c == 'e' || c == 'E')
+            {
+                isFloat = true;
+                end++;
+            }
+            else if ((c == '+' || c == '-') && (end[-1] == 'e' || end[-1] == 'E'))
+            {
+                end++;
+            }
+            else
+            {
+                break;
+            }
+        }
+
+        std::from_chars_result result;
+        if (isFloat)
+        {
+            event.type = CSONEventType::F64;
+            result     = std::from_chars(start, end, event.f64Value);
+        }
+        else
+        {
+            event.type = CSONEventType::I64;
+            result     = std::from_chars(start, end, event.i64Value);
+        }
+
+        if (result.ec != std::errc() || result.ptr != end) return Error(event, "a valid number");
+
+        m_pos             = end;
+        m_expectSeparator = true;
+        return true;
+    }
+
+    bool CSONPullReader::Push(const CSONObjectType type, CSONEvent& event, const CSONObjectView& view)
+    {
+        if (m_depth == CSON_PULL_READER_MAX_DEPTH) return Error(event, "objects and arrays to be nested less deeply");
+
+        m_stack[m_depth++] = { type, view.begin(), view.end() };
+
+        event.type        = type == CSONObjectType::Object ? CSONEventType::StartObject : CSONEventType::StartArray;
+        m_expectSeparator = false;
+        return true;
+    }
+
+    bool CSONPullReader::Pop(const CSONObjectType type, CSONEvent& event)
+    {
+        m_depth--;
+
+        event.type = type == CSONObjectType::Object ? CSONEventType::EndObject : CSONEventType::EndArray;
+        // The object or array that just ended is a complete value in it's parent
+        m_expectSeparator = true;
+        return true;
+    }
+
+    void CSONPullReader::SkipWhitespace()
+    {
+        while (true)
+        {
+#if defined(C3D_SIMD_SSE)
+            // Skip runs of whitespace 16 characters at a time (counting the newlines as we go)
+            const auto spaces   = _mm_set1_epi8(' ');
+            const auto newlines = _mm_set1_epi8('\n');
+            const auto returns  = _mm_set1_epi8('\r');
+            const auto tabs     = _mm_set1_epi8('\t');
+
+            while (m_end - m_pos >= 16)
+            {
+                const auto chunk     = _mm_loadu_si128(reinterpret_cast<const __m128i*>(m_pos));
+                const auto isNewline = _mm_cmpeq_epi8(chunk, newlines);
+                const auto isSpace   = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, spaces), isNewline),
+                                                    _mm_or_si128(_mm_cmpeq_epi8(chunk, returns), _mm_cmpeq_epi8(chunk, tabs)));
+
+                const auto newlineMask = static_cast<u32>(_mm_movemask_epi8(isNewline));
+                const auto otherMask   = ~static_cast<u32>(_mm_movemask_epi8(isSpace)) & 0xFFFF;
+                if (otherMask == 0)
+                {
+                    m_line += std::popcount(newlineMask);
+                    m_pos += 16;
+                    continue;
+                }
+
+                // Only skip up to the first character that is not whitespace
+                const auto skip = std::countr_zero(otherMask);
+                m_line += std::popcount(newlineMask & ((1u << skip) - 1));
+                m_pos += skip;
+                break;
+            }
+#endif
+            while (m_pos != m_end && IsWhitespace(*m_pos))
+            {
+                if (*m_pos == '\n') m_line++;
+                m_pos++;
+            }
+
+            if (m_pos == m_end || *m_pos != '#') return;
+
+            // Comments run until the end of the line
+            const auto newline = static_cast<const char*>(std::memchr(m_pos, '\n', m_end - m_pos));
+            m_pos              = newline ? newline : m_end;
+        }
+    }
+
+    bool CSONPullReader::Error(CSONEvent& event, const char* expected)
+    {
+        if (m_pos == m_end)
+        {
+            ERROR_LOG("Parsing error on line: {}. Expected: '{}' but found: 'end of file'.", m_line, expected);
+        }
+        else
+        {
+            // Show the input up to the end of the line where the error occurred
+            auto length = Min(CSON_ERROR_CONTEXT_LENGTH, static_cast<u64>(m_end - m_pos));
+            if (const auto newline = static_cast<const char*>(std::memchr(m_pos, '\n', length))) length = newline - m_pos;
+            ERROR_LOG("Parsing error on line: {}. Expected: '{}' but found: '{}'.", m_line, expected, String(m_pos, length));
+        }
+
+        m_error    = true;
+        event.type = CSONEventType::Error;
+        return false;
+    }
+}  // namespace C3D
@@ -0,0 +1,175 @@
+#pragma once
+#include "cson_binary.h"
+#include "defines.h"
+#include "string/string.h"
+
+namespace C3D
+{
+    /** @brief The maximum depth of nested objects and arrays that the CSONPullReader supports. */
+    constexpr u32 CSON_PULL_READER_MAX_DEPTH = 64;
+
+    enum class CSONEventType : u8
+    {
+        None,
+        StartObject,
+        EndObject,
+        StartArray,
+        EndArray,
+        I64,
+        F64,
+        Bool,
+        String,
+        EndOfFile,
+        Error,
+    };
+
+    /** @brief A single event produced by the CSONPullReader. Strings point directly into the input so no memory is allocated. */
+    struct C3D_API CSONEvent
+    {
+        CSONEventType type = CSONEventType::None;
+        /** @brief The name of the property. Empty for values in an array and for the End events. */
+        CSONStringView name;
+
+        [[nodiscard]] bool IsNumber() const { return type == CSONEventType::I64 || type == CSONEventType::F64; }
+        [[nodiscard]] bool IsObject() const { return type == CSONEventType::StartObject; }
+        [[nodiscard]] bool IsArray() const { return type == CSONEventType::StartArray; }
+
+        [[nodiscard]] bool GetBool() const;
+        [[nodiscard]] i64 GetI64() const;
+        /** @brief Gets the value as a f64. Integers are converted since whole floats are written without a decimal point. */
+        [[nodiscard]] f64 GetF64() const;
+        [[nodiscard]] f32 GetF32() const;
+        [[nodiscard]] CSONStringView GetString() const;
+
+        CSONStringView stringValue;
+        i64 i64Value   = 0;
+        f64 f64Value   = 0.0;
+        bool boolValue = false;
+    };
+
+    /**
+     * @brief A single-pass, pull-style reader for CSON that does not allocate any memory.
+     * Every call to Next() reads exactly one event from the input so callers can consume values directly
+     * (without building a CSONObject tree first). It can read text CSON as well as binary CSON data (through a CSONObjectView).
+     *
+     * A typical loop over the properties of an object looks like:
+     *     while (reader.NextMember(event)) { if (event.name.IEquals("name")) { ... } else reader.Skip(event); }
+     */
+    class C3D_API CSONPullReader
+    {
+        struct StackEntry
+        {
+            CSONObjectType type = CSONObjectType::Object;
+            /** @brief The next and end property (only used when reading binary CSON). */
+            CSONObjectView::Iterator current;
+            CSONObjectView::Iterator end;
+        };
+
+    public:
+        CSONPullReader() = default;
+        CSONPullReader(const char* data, u64 size);
+        explicit CSONPullReader(const String& input);
+        explicit CSONPullReader(const CSONObjectView& root);
+
+        /**
+         * @brief Starts reading the provided text CSON. The data is not copied so it must remain valid while this reader is used.
+         *
+         * @param data A pointer to the text CSON
+         * @param size The size of the text in bytes
+         */
+        void Reset(const char* data, u64 size);
+
+        /** @brief Starts reading the binary CSON that the provided view points to. */
+        void Reset(const CSONObjectView& root);
+
+        /**
+         * @brief Reads the next event from the input.
+         *
+         * @param event The event that will be filled in
+         * @return True if an event was read; False at the end of the input or when an error occurred
+         */
+        bool Next(CSONEvent& event);
+
+        /**
+         * @brief Reads the next member of the object or array that we are currently in.
+         *
+         * @param event The event that will be filled in
+         * @return True if a member was read; False once the current object or array ends (or when an error occurred)
+         */
+        bool NextMember(CSONEvent& event);
+
+        /**
+         * @brief Skips the provided event. For StartObject and StartArray events the entire object or array is skipped.
+         * Other events were already completely read so nothing needs to happen for those.
+         *
+         * @param event The event that was just returned by Next() or NextMember()
+         * @return True if successful; False if an error occurred
+         */
+        bool Skip(const CSONEvent& event);
+
+        /**
+         * @brief Reads an array of exactly count numbers (including the closing EndArray) that was started by the provided event.
+         * If the event did not start an array it is skipped.
+         *
+         * @param event The event that was just returned by Next() or NextMember()
+         * @param values A pointer to at least count f32s that will be filled in
+         * @param count The number of values the array should contain
+         * @return True if the event started an array containing exactly count numbers; False otherwise
+         */
+        bool ReadF32Array(const CSONEvent& event, f32* values, u32 count);
+
+        /** @brief Reads an array of 4 numbers that was started by the provided event into a vec4. */
+        bool ReadVec4(const CSONEvent& event, vec4& value);
+
+        /**
+         * @brief Reads all events with the provided visitor. The visitor is called with every event (as a const CSONEvent&)
+         * and should return true to continue reading or false to stop.
+         *
+         * @return True if all events were read successfully; False if an error occurred or the visitor stopped
+         */
+        template <typename Visitor>
+        bool Visit(Visitor&& visitor)
+        {
+            CSONEvent event;
+            while (Next(event))
+            {
+                if (!visitor(event)) return false;
+            }
+            return !m_error;
+        }
+
+        [[nodiscard]] bool HasError() const { return m_error; }
+        [[nodiscard]] u32 GetDepth() const { return m_depth; }
+        [[nodiscard]] u32 GetLine() const { return m_line; }
+
+    private:
+        bool NextText(CSONEvent& event);
+        bool NextBinary(CSONEvent& event);
+
+        bool ReadValue(CSONEvent& event);
+        bool ReadString(CSONStringView& str);
+        bool ReadNumber(CSONEvent& event);
+
+        bool Push(CSONObjectType type, CSONEvent& event, const CSONObjectView& view = CSONObjectView());
+        bool Pop(CSONObjectType type, CSONEvent& event);
+
+        void SkipWhitespace();
+
+        bool Error(CSONEvent& event, const char* expected);
+
+        const char* m_pos = nullptr;
+        const char* m_end = nullptr;
+
+        CSONObjectView m_binaryRoot;
+        bool m_binary = false;
+
+        StackEntry m_stack[CSON_PULL_READER_MAX_DEPTH];
+        u32 m_depth = 0;
+        u32 m_line  = 1;
+
+        /** @brief True if we have read a complete value and expect a ',' or the end of the current object or array next. */
+        bool m_expectSeparator = false;
+        bool m_started         = false;
+        bool m_error           = false;
+    };
+}  // namespace C3D
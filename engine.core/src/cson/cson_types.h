@@ -8,65 +8,6 @@
 
 namespace C3D
 {
-    enum class CSONTokenizeMode
-    {
-        Default,
-        Whitespace,
-        NumericLiteral,
-        StringLiteral,
-        Comment,
-    };
-
-    enum class CSONTokenType : u8
-    {
-        Unknown,
-        Whitespace,
-        Comma,
-        Colon,
-        OperatorPlus,
-        OperatorMinus,
-        OperatorEquals,
-        OperatorSlash,
-        OperatorAsterisk,
-        OpenSquareBrace,
-        CloseSquareBrace,
-        OpenCurlyBrace,
-        CloseCurlyBrace,
-        StringLiteral,
-        Integer,
-        Float,
-        Boolean,
-        Comment,
-        NewLine,
-        EndOfFile,
-    };
-
-    struct CSONToken
-    {
-        CSONTokenType type = CSONTokenType::Unknown;
-        u32 start          = 0;
-        u32 end            = 0;
-        u32 line           = 0;
-
-        CSONToken() {}
-        CSONToken(CSONTokenType type, u32 pos, u32 line) : type(type), start(pos), end(pos), line(line) {}
-        CSONToken(CSONTokenType type, u32 start, u32 end, u32 line) : type(type), start(start), end(end), line(line) {}
-    };
-
-    enum class CSONParseMode
-    {
-        ObjectOrArray,
-        KeyOrEndOfObject,
-        Colon,
-        Value,
-        CommaOrEndOfObject,
-        ArrayValueAfterOpen,
-        ArrayValueAfterComma,
-        ArraySeparatorOrEnd,
-        NegativeArrayValue,
-        EndOfFile,
-    };
-
     enum class CSONObjectType
     {
         Object,
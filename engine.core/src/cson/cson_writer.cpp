@@ -1,10 +1,118 @@
 
 #include "cson_writer.h"
 
+#include <bit>
+#include <cstring>
+
+#include "containers/flat_hash_map.h"
+#include "cson_binary.h"
+#include "math/c3d_math.h"
 #include "platform/file_system.h"
 
 namespace C3D
 {
+    using CSONStringOffsetMap = FlatHashMap<String, u32>;
+
+    static u64 AppendBytes(DynamicArray<u8>& output, const void* data, const u64 size)
+    {
+        const auto offset = output.Size();
+        const auto needed = offset + size;
+        // Resize() only reserves exactly what we ask for so we grow geometrically ourselves
+        if (needed > output.Capacity()) output.Reserve(Max(needed, output.Capacity() * 2));
+        output.Resize(needed);
+        if (data)
+        {
+            std::memcpy(output.GetData() + offset, data, size);
+        }
+        else
+        {
+            // Resize() does not initialize trivial types so we zero the bytes ourselves
+            std::memset(output.GetData() + offset, 0, size);
+        }
+        return offset;
+    }
+
+    static void AlignTo(DynamicArray<u8>& output, const u64 alignment)
+    {
+        const auto padding = (alignment - output.Size() % alignment) % alignment;
+        if (padding > 0) AppendBytes(output, nullptr, padding);
+    }
+
+    static void AddBinaryString(const String& str, DynamicArray<u8>& output, CSONStringOffsetMap& offsets)
+    {
+        if (offsets.Has(str)) return;
+
+        // Strings are stored as a u32 length followed by the characters and a null-terminator
+        AlignTo(output, alignof(u32));
+        const auto length = static_cast<u32>(str.Size());
+        const auto offset = AppendBytes(output, &length, sizeof(u32));
+        AppendBytes(output, str.Data(), length + 1);
+
+        offsets.Set(str, static_cast<u32>(offset));
+    }
+
+    static void CollectBinaryStrings(const CSONObject& object, DynamicArray<u8>& output, CSONStringOffsetMap& offsets)
+    {
+        for (const auto& property : object.properties)
+        {
+            if (!property.name.Empty()) AddBinaryString(property.name, output, offsets);
+
+            if (property.GetType() == PropertyTypeString)
+            {
+                AddBinaryString(property.GetString(), output, offsets);
+            }
+            else if (property.GetType() == PropertyTypeObject)
+            {
+                CollectBinaryStrings(property.GetObject(), output, offsets);
+            }
+        }
+    }
+
+    static u64 WriteBinaryObject(const CSONObject& object, DynamicArray<u8>& output, const CSONStringOffsetMap& offsets)
+    {
+        // Every object starts on an 8 byte boundary so it's properties can be read in place
+        AlignTo(output, alignof(CSONBinaryProperty));
+
+        const CSONBinaryObject header = { static_cast<u32>(object.type), static_cast<u32>(object.properties.Size()) };
+        const auto offset             = AppendBytes(output, &header, sizeof(CSONBinaryObject));
+
+        // We reserve room for all the properties first so child objects are always stored after their parent
+        const auto propertiesOffset = AppendBytes(output, nullptr, object.properties.Size() * sizeof(CSONBinaryProperty));
+
+        for (u32 i = 0; i < object.properties.Size(); ++i)
+        {
+            const auto& property = object.properties[i];
+
+            CSONBinaryProperty binary;
+            binary.name = property.name.Empty() ? 0 : *offsets.Find(property.name);
+            binary.type = property.GetType();
+
+            switch (binary.type)
+            {
+                case PropertyTypeI64:
+                    binary.value = std::bit_cast<u64>(property.GetI64());
+                    break;
+                case PropertyTypeF64:
+                    binary.value = std::bit_cast<u64>(property.GetF64());
+                    break;
+                case PropertyTypeBool:
+                    binary.value = property.GetBool() ? 1 : 0;
+                    break;
+                case PropertyTypeString:
+                    binary.value = *offsets.Find(property.GetString());
+                    break;
+                case PropertyTypeObject:
+                    binary.value = WriteBinaryObject(property.GetObject(), output, offsets);
+                    break;
+            }
+
+            // Writing the child object may have reallocated our output so we can only copy the property in by offset
+            std::memcpy(output.GetData() + propertiesOffset + i * sizeof(CSONBinaryProperty), &binary, sizeof(CSONBinaryProperty));
+        }
+
+        return offset;
+    }
+
     void CSONWriter::WriteProperty(const CSONProperty& property, String& output, bool last, bool isInlineArray)
     {
         // First we add the name (if it's not empty)
@@ -176,4 +284,45 @@ namespace C3D
 
         return true;
     }
+
+    void CSONWriter::WriteBinary(const CSONObject& object, DynamicArray<u8>& output)
+    {
+        output.Clear();
+
+        // Make room for the header which we will fill in at the end when we know all the offsets
+        AppendBytes(output, nullptr, sizeof(CSONBinaryHeader));
+
+        // First we store all the unique strings so the same name is only stored once (no matter how often it's used)
+        CSONStringOffsetMap offsets;
+        offsets.Create();
+        CollectBinaryStrings(object, output, offsets);
+
+        CSONBinaryHeader header;
+        header.stringCount = static_cast<u32>(offsets.Count());
+        header.root        = static_cast<u32>(WriteBinaryObject(object, output, offsets));
+        header.size        = output.Size();
+
+        std::memcpy(output.GetData(), &header, sizeof(CSONBinaryHeader));
+    }
+
+    bool CSONWriter::WriteBinaryToFile(const CSONObject& object, const String& path)
+    {
+        File file;
+        if (!file.Open(path, FileModeWrite | FileModeBinary))
+        {
+            ERROR_LOG("Failed to open binary CSON file: '{}'.", path);
+            return false;
+        }
+
+        DynamicArray<u8> output;
+        WriteBinary(object, output);
+
+        if (!file.Write(output.GetData(), output.Size()))
+        {
+            ERROR_LOG("Failed to write binary CSON to file: '{}'.", path);
+            return false;
+        }
+
+        return true;
+    }
 }  // namespace C3D
\ No newline at end of file
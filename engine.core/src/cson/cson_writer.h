@@ -11,6 +11,16 @@ namespace C3D
         void Write(const CSONObject& object, String& output);
         bool WriteToFile(const CSONObject& object, const String& path);
 
+        /**
+         * @brief Writes the provided object in the binary CSON format (see cson_binary.h).
+         * Binary CSON can be read in place by the CSONBinaryReader without any parsing or allocations.
+         *
+         * @param object The object you want to write
+         * @param output The array that the binary data will be written into (any existing data is cleared)
+         */
+        void WriteBinary(const CSONObject& object, DynamicArray<u8>& output);
+        bool WriteBinaryToFile(const CSONObject& object, const String& path);
+
     private:
         void WriteProperty(const CSONProperty& property, String& output, bool last, bool isInlineArray);
         void WriteArray(const CSONArray& array, String& output);
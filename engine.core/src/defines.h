@@ -92,6 +92,14 @@ constexpr auto ToUnderlying(E e) noexcept
 #error "Unknown platform!"
 #endif
 
+// SIMD detection
+#if defined(__AVX__)
+#define C3D_SIMD_AVX 1
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define C3D_SIMD_SSE 1
+#endif
+
 #ifdef C3D_EXPORT
 #ifdef _MSC_VER
 #define C3D_API __declspec(dllexport)
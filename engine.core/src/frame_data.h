@@ -4,7 +4,7 @@
 
 namespace C3D
 {
-    class LinearAllocator;
+    class FrameAllocator;
 
     struct TimeData
     {
@@ -30,14 +30,18 @@ namespace C3D
         TimeData timeData;
         /** @brief The number of meshes drawn in the last frame. */
         u32 drawnMeshCount = 0;
+        /** @brief The number of (instanced) draw calls that were needed to draw those meshes. */
+        u32 meshDrawCallCount = 0;
         /** @brief The number of terrain meshes drawn in the last frame. */
         u32 drawnTerrainCount = 0;
         /** @brief The number of shadow meshes drawn in the last frame. */
         u32 drawnShadowMeshCount = 0;
+        /** @brief The number of (instanced) draw calls that were needed to draw the shadow meshes into a single cascade. */
+        u32 shadowMeshDrawCallCount = 0;
         /** @brief The number of debug meshes drawn in the last frame. */
         u32 drawnDebugCount = 0;
-        /** @brief A pointer to the engine's frame allocator. */
-        LinearAllocator* allocator = nullptr;
+        /** @brief A pointer to the engine's frame allocator. Safe to use from jobs, memory stays valid until the end of the next frame. */
+        FrameAllocator* allocator = nullptr;
         /** @brief The current frame number, typically used for data synchronization. */
         u64 frameNumber = INVALID_ID_U64;
         /** @brief The current draw index for this frame. Used to track queue submissions for this frame. */
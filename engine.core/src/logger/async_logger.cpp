@@ -0,0 +1,223 @@
+
+#include "async_logger.h"
+
+#include <algorithm>
+
+namespace C3D
+{
+    /** @brief The generation of the last AsyncLogger that was created. Used to invalidate the thread local queues of old instances. */
+    static std::atomic<u32> s_generation = 0;
+
+    /** @brief The queue of the calling thread. Nullptr if this thread could not get a queue. */
+    static thread_local ThreadLogQueue* t_logQueue = nullptr;
+    /** @brief The generation of the AsyncLogger that t_logQueue belongs to. */
+    static thread_local u32 t_logQueueGeneration = 0;
+
+    AsyncLogger::AsyncLogger(const AsyncLoggerConfig& config, std::shared_ptr<spdlog::logger> logger)
+        : m_config(config), m_logger(std::move(logger))
+    {
+        // Our ring buffers must be a power of 2 so we can wrap around with a simple mask
+        m_config.threadBufferSize = std::bit_ceil(std::max(m_config.threadBufferSize, static_cast<u32>(KibiBytes(1))));
+
+        m_generation = s_generation.fetch_add(1, std::memory_order_relaxed) + 1;
+        m_queues     = std::make_unique<ThreadLogQueue[]>(m_config.maxThreads);
+
+        m_batch.reserve(1024);
+        m_batchEnds.resize(m_config.maxThreads);
+
+        m_running.store(true, std::memory_order_release);
+        m_thread = std::thread([this] { Run(); });
+    }
+
+    AsyncLogger::~AsyncLogger()
+    {
+        {
+            // Take the lock to ensure our background thread does not miss the fact that we stopped running
+            std::lock_guard lock(m_wakeMutex);
+            m_running.store(false, std::memory_order_release);
+        }
+        m_wakeCondition.notify_one();
+
+        // Our background thread writes all remaining messages before it exits
+        if (m_thread.joinable()) m_thread.join();
+    }
+
+    void AsyncLogger::Flush()
+    {
+        const auto threadCount = std::min(m_threadCount.load(std::memory_order_acquire), m_config.maxThreads);
+        for (u32 i = 0; i < threadCount; ++i)
+        {
+            auto& queue = m_queues[i];
+            if (!queue.ready.load(std::memory_order_acquire)) continue;
+
+            // Wait until everything that was written to this queue (up until now) has been consumed
+            const auto head = queue.head.load(std::memory_order_acquire);
+            while (queue.tail.load(std::memory_order_acquire) < head)
+            {
+                m_wakeCondition.notify_one();
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    ThreadLogQueue* AsyncLogger::GetThreadQueue()
+    {
+        if (t_logQueueGeneration == m_generation) return t_logQueue;
+
+        t_logQueueGeneration = m_generation;
+        t_logQueue           = nullptr;
+
+        const auto slot = m_threadCount.fetch_add(1, std::memory_order_acq_rel);
+        if (slot >= m_config.maxThreads)
+        {
+            // All queues are taken so this thread will have to log synchronously
+            return nullptr;
+        }
+
+        auto& queue    = m_queues[slot];
+        queue.capacity = m_config.threadBufferSize;
+        queue.memory   = std::make_unique<u64[]>(queue.capacity / sizeof(u64));
+        queue.ready.store(true, std::memory_order_release);
+
+        t_logQueue = &queue;
+        return t_logQueue;
+    }
+
+    u8* AsyncLogger::Reserve(ThreadLogQueue& queue, const u64 size)
+    {
+        // Only this thread writes head so a relaxed load is enough
+        auto head = queue.head.load(std::memory_order_relaxed);
+
+        const auto offset     = head & (queue.capacity - 1);
+        const auto contiguous = queue.capacity - offset;
+        // If the record does not fit before the end of the buffer we need to pad the rest of the buffer and start at the beginning
+        const auto needed = size > contiguous ? size + contiguous : size;
+
+        while (head + needed - queue.tail.load(std::memory_order_acquire) > queue.capacity)
+        {
+            if (m_config.overflowPolicy == LogOverflowPolicy::Drop)
+            {
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+                m_totalDropped.fetch_add(1, std::memory_order_relaxed);
+                return nullptr;
+            }
+
+            // Wake our background thread so it makes room for us
+            m_wakeCondition.notify_one();
+            std::this_thread::yield();
+        }
+
+        if (size > contiguous)
+        {
+            // Fill the rest of the buffer with a padding record (which has no format function). If there is not even enough room for a
+            // header we skip the rest of the buffer without writing anything (the background thread knows to skip these tails as well)
+            if (contiguous >= sizeof(LogRecordHeader))
+            {
+                new (queue.GetData() + offset) LogRecordHeader{ static_cast<u32>(contiguous), spdlog::level::off, {}, nullptr, nullptr };
+            }
+            head += contiguous;
+            queue.head.store(head, std::memory_order_release);
+        }
+
+        return queue.GetData() + (head & (queue.capacity - 1));
+    }
+
+    void AsyncLogger::Commit(ThreadLogQueue& queue, const u64 size)
+    {
+        // Publish the record to the background thread
+        queue.head.store(queue.head.load(std::memory_order_relaxed) + size, std::memory_order_release);
+    }
+
+    void AsyncLogger::Run()
+    {
+        while (true)
+        {
+            // Read running before we write our batch so we always write everything that was logged before we were stopped
+            const auto running = m_running.load(std::memory_order_acquire);
+            const auto written = WriteBatch();
+
+            if (written > 0) continue;
+            if (!running) break;
+
+            std::unique_lock lock(m_wakeMutex);
+            m_wakeCondition.wait_for(lock, std::chrono::milliseconds(m_config.flushIntervalMs),
+                                     [this] { return !m_running.load(std::memory_order_acquire); });
+        }
+    }
+
+    u64 AsyncLogger::WriteBatch()
+    {
+        m_batch.clear();
+
+        // Collect all records that are available in every queue
+        const auto threadCount = std::min(m_threadCount.load(std::memory_order_acquire), m_config.maxThreads);
+        for (u32 i = 0; i < threadCount; ++i)
+        {
+            auto& queue = m_queues[i];
+            if (!queue.ready.load(std::memory_order_acquire))
+            {
+                m_batchEnds[i] = 0;
+                continue;
+            }
+
+            const auto head = queue.head.load(std::memory_order_acquire);
+            for (auto position = queue.tail.load(std::memory_order_relaxed); position < head;)
+            {
+                const auto offset     = position & (queue.capacity - 1);
+                const auto contiguous = queue.capacity - offset;
+                if (contiguous < sizeof(LogRecordHeader))
+                {
+                    // Tails that are too small to hold a header are always padding
+                    position += contiguous;
+                    continue;
+                }
+
+                const auto header = reinterpret_cast<const LogRecordHeader*>(queue.GetData() + offset);
+                if (header->formatFunc) m_batch.push_back(header);
+                position += header->size;
+            }
+            m_batchEnds[i] = head;
+        }
+
+        // Every queue is ordered but we need to merge them so messages from different threads are written in the order they were logged
+        std::ranges::stable_sort(m_batch, [](const LogRecordHeader* a, const LogRecordHeader* b) { return a->time < b->time; });
+
+        for (const auto header : m_batch)
+        {
+            m_formatBuffer.clear();
+
+            try
+            {
+                header->formatFunc(header->format, reinterpret_cast<const u8*>(header + 1), m_formatBuffer);
+            }
+            catch (const fmt::format_error& e)
+            {
+                m_formatBuffer.clear();
+                fmt::format_to(std::back_inserter(m_formatBuffer), "[ASYNC_LOGGER] - Failed to format: '{}' ({}).", header->format,
+                               e.what());
+            }
+
+            m_logger->log(header->time, spdlog::source_loc{}, header->level,
+                          spdlog::string_view_t(m_formatBuffer.data(), m_formatBuffer.size()));
+        }
+
+        // Now that all records are written we can give the memory back to the threads
+        for (u32 i = 0; i < threadCount; ++i)
+        {
+            if (m_batchEnds[i] != 0) m_queues[i].tail.store(m_batchEnds[i], std::memory_order_release);
+        }
+
+        if (const auto dropped = m_dropped.exchange(0, std::memory_order_relaxed); dropped > 0)
+        {
+            m_logger->warn("[ASYNC_LOGGER] - Dropped {} messages because a ring buffer was full.", dropped);
+        }
+
+        if (!m_batch.empty())
+        {
+            // We only flush our sinks once per batch instead of once per message
+            m_logger->flush();
+        }
+
+        return m_batch.size();
+    }
+}  // namespace C3D
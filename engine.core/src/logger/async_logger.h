@@ -0,0 +1,265 @@
+
+#pragma once
+#include <spdlog/spdlog.h>
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <condition_variable>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include "defines.h"
+
+namespace C3D
+{
+    /** @brief What a thread should do when it logs while it's ring buffer is full. */
+    enum class LogOverflowPolicy : u8
+    {
+        /** @brief Wait until the background thread has made enough room. No messages are lost. */
+        Block,
+        /** @brief Drop the message. The number of dropped messages is reported by the background thread. */
+        Drop,
+    };
+
+    struct AsyncLoggerConfig
+    {
+        /** @brief The size (in bytes) of the ring buffer of every thread that logs. Rounded up to a power of 2. */
+        u32 threadBufferSize = KibiBytes(64);
+        /** @brief The maximum number of threads that get their own ring buffer. Other threads log synchronously. */
+        u32 maxThreads = 64;
+        /** @brief What to do when a thread logs while it's ring buffer is full. */
+        LogOverflowPolicy overflowPolicy = LogOverflowPolicy::Block;
+        /** @brief The maximum time (in milliseconds) that the background thread waits before writing the next batch. */
+        u32 flushIntervalMs = 2;
+    };
+
+    /** @brief Formats the encoded arguments that follow a LogRecordHeader with the provided format into out. */
+    using LogFormatFunc = void (*)(const char* format, const u8* args, fmt::memory_buffer& out);
+
+    struct LogRecordHeader
+    {
+        /** @brief The size of the record in bytes (including this header). Always a multiple of 8. */
+        u32 size;
+        /** @brief The level that was used to log this record. */
+        spdlog::level::level_enum level;
+        /** @brief The time at which the message was logged. */
+        spdlog::log_clock::time_point time;
+        /** @brief The format string (which needs to outlive the record, like all string literals do). */
+        const char* format;
+        /** @brief The function that decodes the arguments and formats the message. Nullptr for padding records. */
+        LogFormatFunc formatFunc;
+    };
+
+    namespace LogArgs
+    {
+        constexpr u64 AlignedSize(const u64 size) { return (size + 7) & ~static_cast<u64>(7); }
+
+        /** @brief Strings (and string-like types) are copied into the record since they might be destroyed before we format them. */
+        template <class T>
+        concept IsStringLike = std::is_same_v<T, const char*> || std::is_same_v<T, char*> || std::is_same_v<T, std::string> ||
+                               std::is_same_v<T, std::string_view> || requires(const T& t) {
+                                   { t.Data() } -> std::convertible_to<const char*>;
+                                   { t.Size() } -> std::convertible_to<u64>;
+                               };
+
+        /** @brief Trivially copyable arguments are stored by value and formatted (with their own formatter) on the background thread. */
+        template <class T>
+        struct Encoder
+        {
+            static constexpr bool SUPPORTED = std::is_trivially_copyable_v<T>;
+
+            static u64 GetSize(const T&) { return AlignedSize(sizeof(T)); }
+
+            static u8* Encode(u8* dst, const T& value)
+            {
+                std::memcpy(dst, &value, sizeof(T));
+                return dst + AlignedSize(sizeof(T));
+            }
+
+            static T Decode(const u8*& src)
+            {
+                std::array<std::byte, sizeof(T)> bytes;
+                std::memcpy(bytes.data(), src, sizeof(T));
+                src += AlignedSize(sizeof(T));
+                return std::bit_cast<T>(bytes);
+            }
+        };
+
+        template <class T>
+            requires IsStringLike<T>
+        struct Encoder<T>
+        {
+            static constexpr bool SUPPORTED = true;
+
+            static std::string_view View(const T& value)
+            {
+                if constexpr (std::is_pointer_v<T>)
+                {
+                    return value ? std::string_view(value) : std::string_view("(null)");
+                }
+                else if constexpr (requires(const T& t) { t.Data(); })
+                {
+                    return std::string_view(value.Data(), value.Size());
+                }
+                else
+                {
+                    return std::string_view(value);
+                }
+            }
+
+            static u64 GetSize(const T& value) { return AlignedSize(sizeof(u64) + View(value).size()); }
+
+            static u8* Encode(u8* dst, const T& value)
+            {
+                const auto view = View(value);
+                const u64 size  = view.size();
+                std::memcpy(dst, &size, sizeof(u64));
+                std::memcpy(dst + sizeof(u64), view.data(), size);
+                return dst + AlignedSize(sizeof(u64) + size);
+            }
+
+            static std::string_view Decode(const u8*& src)
+            {
+                u64 size;
+                std::memcpy(&size, src, sizeof(u64));
+                const auto view = std::string_view(reinterpret_cast<const char*>(src + sizeof(u64)), size);
+                src += AlignedSize(sizeof(u64) + size);
+                return view;
+            }
+        };
+
+        /** @brief NOTE: We add const before decaying so string literals (deduced as char[N]) decay to const char*. */
+        template <class T>
+        using EncoderFor = Encoder<std::decay_t<const T>>;
+
+        template <class... Args>
+        void FormatRecord(const char* format, const u8* args, fmt::memory_buffer& out)
+        {
+            // NOTE: Elements of a braced initializer list are evaluated in order so we decode the arguments in the order we encoded them
+            std::tuple<decltype(EncoderFor<Args>::Decode(args))...> decoded{ EncoderFor<Args>::Decode(args)... };
+            std::apply([&](auto&... values) { fmt::vformat_to(std::back_inserter(out), format, fmt::make_format_args(values...)); },
+                       decoded);
+        }
+    }  // namespace LogArgs
+
+    /** @brief A single producer, single consumer ring buffer of log records. Only the owning thread writes and only the background
+     * thread of the AsyncLogger reads. */
+    struct alignas(64) ThreadLogQueue
+    {
+        /** @brief The memory for our records. Stored as u64s so every record is 8 byte aligned. */
+        std::unique_ptr<u64[]> memory;
+        /** @brief The size of memory in bytes. Always a power of 2. */
+        u64 capacity = 0;
+        /** @brief The total number of bytes that were ever written. Only written by the owning thread. */
+        std::atomic<u64> head = 0;
+        /** @brief The total number of bytes that were ever consumed. Only written by the background thread. */
+        std::atomic<u64> tail = 0;
+        /** @brief Set once memory has been allocated so the background thread can safely read this queue. */
+        std::atomic<bool> ready = false;
+
+        [[nodiscard]] u8* GetData() const { return reinterpret_cast<u8*>(memory.get()); }
+    };
+
+    /**
+     * @brief The backend for asynchronous logging.
+     * Every thread copies the format string pointer and it's encoded arguments into it's own lock-free ring buffer. A background thread
+     * collects the records of all threads in batches, sorts them by time, formats them and writes them to the sinks of the logger.
+     */
+    class C3D_API AsyncLogger
+    {
+    public:
+        AsyncLogger(const AsyncLoggerConfig& config, std::shared_ptr<spdlog::logger> logger);
+
+        AsyncLogger(const AsyncLogger&) = delete;
+        AsyncLogger(AsyncLogger&&)      = delete;
+
+        AsyncLogger& operator=(const AsyncLogger&) = delete;
+        AsyncLogger& operator=(AsyncLogger&&)      = delete;
+
+        ~AsyncLogger();
+
+        /**
+         * @brief Enqueues a message for the background thread.
+         *
+         * @return True if the message was handled (enqueued or dropped according to our overflow policy). False if the caller should
+         * log the message synchronously (because this thread has no ring buffer or the message is too large to fit).
+         */
+        template <class... Args>
+        bool Enqueue(const spdlog::level::level_enum level, const char* format, const Args&... args)
+        {
+            if constexpr ((LogArgs::EncoderFor<Args>::SUPPORTED && ...))
+            {
+                const u64 size = sizeof(LogRecordHeader) + (0 + ... + LogArgs::EncoderFor<Args>::GetSize(args));
+
+                const auto queue = GetThreadQueue();
+                if (!queue || size > queue->capacity / 4) return false;
+
+                const auto record = Reserve(*queue, size);
+                // We dropped this message since the queue was full
+                if (!record) return true;
+
+                new (record) LogRecordHeader{ static_cast<u32>(size), level, spdlog::log_clock::now(), format,
+                                              &LogArgs::FormatRecord<Args...> };
+
+                auto cursor = record + sizeof(LogRecordHeader);
+                ((cursor = LogArgs::EncoderFor<Args>::Encode(cursor, args)), ...);
+
+                Commit(*queue, size);
+                return true;
+            }
+            else
+            {
+                // Some of our arguments can't be safely copied so we format on this thread and only defer the writing
+                const auto str = fmt::vformat(format, fmt::make_format_args(args...));
+                return Enqueue(level, "{}", std::string_view(str));
+            }
+        }
+
+        /** @brief Blocks until every message that was enqueued before this call has been written. */
+        void Flush();
+
+        /** @brief Gets the total number of messages that were dropped because a ring buffer was full. */
+        [[nodiscard]] u64 GetDroppedCount() const { return m_totalDropped.load(std::memory_order_relaxed); }
+
+    private:
+        ThreadLogQueue* GetThreadQueue();
+
+        /** @brief Reserves size contiguous bytes in the provided queue. Returns nullptr if the message should be dropped. */
+        u8* Reserve(ThreadLogQueue& queue, u64 size);
+        /** @brief Publishes the record that was written in the memory returned by Reserve(). */
+        static void Commit(ThreadLogQueue& queue, u64 size);
+
+        void Run();
+        u64 WriteBatch();
+
+        AsyncLoggerConfig m_config;
+        std::shared_ptr<spdlog::logger> m_logger;
+
+        /** @brief A unique number for this instance so threads know when their (thread local) queue belongs to a previous instance. */
+        u32 m_generation = 0;
+
+        std::unique_ptr<ThreadLogQueue[]> m_queues;
+        std::atomic<u32> m_threadCount = 0;
+
+        /** @brief The number of messages that were dropped since the background thread last reported it. */
+        std::atomic<u64> m_dropped      = 0;
+        std::atomic<u64> m_totalDropped = 0;
+
+        /** @brief The records (and the end of the consumed range of every queue) of the batch that is currently being written. */
+        std::vector<const LogRecordHeader*> m_batch;
+        std::vector<u64> m_batchEnds;
+        fmt::memory_buffer m_formatBuffer;
+
+        std::atomic<bool> m_running = false;
+        std::mutex m_wakeMutex;
+        std::condition_variable m_wakeCondition;
+        std::thread m_thread;
+    };
+}  // namespace C3D
@@ -41,6 +41,46 @@ namespace C3D
         logger->sinks().push_back(sink);
     }
 
+    void Logger::RemoveSink(const spdlog::sink_ptr& sink)
+    {
+        // Ensure that our sink does not receive any pending messages after it has been removed
+        Flush();
+
+        auto& sinks = GetCoreLogger()->sinks();
+        std::erase(sinks, sink);
+    }
+
+    bool Logger::StartAsync(const AsyncLoggerConfig& config)
+    {
+        ASSERT_INIT;
+
+        auto& asyncLogger = GetAsyncLogger();
+        if (asyncLogger.load(std::memory_order_acquire))
+        {
+            GetCoreLogger()->error("[LOGGER] - StartAsync() - Logger is already asynchronous.");
+            return false;
+        }
+
+        asyncLogger.store(new AsyncLogger(config, GetCoreLogger()), std::memory_order_release);
+        return true;
+    }
+
+    void Logger::StopAsync()
+    {
+        // Our destructor writes all pending messages and joins the background thread
+        delete GetAsyncLogger().exchange(nullptr, std::memory_order_acq_rel);
+    }
+
+    void Logger::Flush()
+    {
+        if (const auto asyncLogger = GetAsyncLogger().load(std::memory_order_acquire))
+        {
+            asyncLogger->Flush();
+        }
+    }
+
+    bool Logger::IsAsync() { return GetAsyncLogger().load(std::memory_order_acquire) != nullptr; }
+
     bool& Logger::GetInitialized()
     {
         static bool initialized = false;
@@ -52,4 +92,10 @@ namespace C3D
         static std::shared_ptr<spdlog::logger> coreLogger;
         return coreLogger;
     }
+
+    std::atomic<AsyncLogger*>& Logger::GetAsyncLogger()
+    {
+        static std::atomic<AsyncLogger*> asyncLogger = nullptr;
+        return asyncLogger;
+    }
 }  // namespace C3D
@@ -5,6 +5,7 @@
 #include <spdlog/spdlog.h>
 
 #include "asserts/asserts.h"
+#include "async_logger.h"
 #include "defines.h"
 
 namespace C3D
@@ -19,65 +20,106 @@ namespace C3D
         static void Init();
 
         static void AddSink(spdlog::sink_ptr sink);
+        static void RemoveSink(const spdlog::sink_ptr& sink);
+
+        /**
+         * @brief Switches the logger to asynchronous mode. Messages are copied (unformatted) into a ring buffer of the calling thread
+         * and a background thread formats and writes them in batches.
+         * NOTE: Only the pointer to the format string is stored for messages with arguments so it must outlive the message (like all
+         * string literals do).
+         *
+         * @param config The configuration for the asynchronous backend
+         * @return True if successful, False if the logger is already asynchronous
+         */
+        static bool StartAsync(const AsyncLoggerConfig& config = {});
+        /** @brief Writes all pending messages and switches the logger back to synchronous mode.
+         * NOTE: No other thread may log while this is running. */
+        static void StopAsync();
+        /** @brief Blocks until all messages that were logged before this call have been written. */
+        static void Flush();
+
+        [[nodiscard]] static bool IsAsync();
 
         template <class... Args>
         static void Debug(const char* format, Args&&... args)
         {
             ASSERT_INIT;
-            const auto str = fmt::vformat(format, fmt::make_format_args(args...));
-            GetCoreLogger()->debug(str);
+            Log(spdlog::level::debug, format, args...);
         }
 
         template <class... Args>
         static void Trace(const char* format, Args&&... args)
         {
             ASSERT_INIT;
-            const auto str = fmt::vformat(format, fmt::make_format_args(args...));
-            GetCoreLogger()->trace(str);
+            Log(spdlog::level::trace, format, args...);
         }
 
         template <class... Args>
         static void Info(const char* format, Args&&... args)
         {
             ASSERT_INIT;
-            const auto str = fmt::vformat(format, fmt::make_format_args(args...));
-            GetCoreLogger()->info(str);
+            Log(spdlog::level::info, format, args...);
         }
 
         template <class... Args>
         static void Warn(const char* format, Args&&... args)
         {
             ASSERT_INIT;
-            const auto str = fmt::vformat(format, fmt::make_format_args(args...));
-            GetCoreLogger()->warn(str);
+            Log(spdlog::level::warn, format, args...);
         }
 
         static void Error(const char* str)
         {
             ASSERT_INIT;
-            GetCoreLogger()->error(str);
+            Log(spdlog::level::err, "{}", str);
         }
 
         template <class... Args>
         static void Error(const char* format, Args&&... args)
         {
             ASSERT_INIT;
-            const auto str = fmt::vformat(format, fmt::make_format_args(args...));
-            GetCoreLogger()->error(str);
+            Log(spdlog::level::err, format, args...);
         }
 
         template <class... Args>
         static void Fatal(const char* format, Args&&... args)
         {
             ASSERT_INIT;
+            // Make sure everything that happened before the fatal error is written before we assert
+            Flush();
             const auto str = fmt::vformat(format, fmt::make_format_args(args...));
             GetCoreLogger()->critical(str);
             C3D_ASSERT_MSG(false, "Fatal Exception occured");
         }
 
     private:
+        template <class... Args>
+        static void Log(const spdlog::level::level_enum level, const char* format, const Args&... args)
+        {
+            const auto& logger = GetCoreLogger();
+            // Skip the formatting entirely for messages that would be filtered out anyway
+            if (!logger->should_log(level)) return;
+
+            if (const auto asyncLogger = GetAsyncLogger().load(std::memory_order_acquire))
+            {
+                if constexpr (sizeof...(Args) == 0)
+                {
+                    // Messages without arguments are often not string literals so we copy them instead of storing the pointer
+                    if (asyncLogger->Enqueue(level, "{}", std::string_view(format))) return;
+                }
+                else
+                {
+                    if (asyncLogger->Enqueue(level, format, args...)) return;
+                }
+            }
+
+            const auto str = fmt::vformat(format, fmt::make_format_args(args...));
+            logger->log(level, str);
+        }
+
         static bool& GetInitialized();
         static std::shared_ptr<spdlog::logger>& GetCoreLogger();
+        static std::atomic<AsyncLogger*>& GetAsyncLogger();
     };
 
 #ifdef C3D_LOG_DEBUG
@@ -0,0 +1,96 @@
+#pragma once
+#include "containers/dynamic_array.h"
+#include "frustum.h"
+#include "math_types.h"
+
+namespace C3D
+{
+    /**
+     * @brief A list of AABBs that stores every component in it's own array (structure of arrays).
+     * This allows the AABBs to be tested against a frustum multiple at a time (see Frustum::IntersectsWithAABBs()).
+     */
+    template <class Allocator = DynamicAllocator>
+    class AABBList
+    {
+    public:
+        explicit AABBList(Allocator* allocator = BaseAllocator<Allocator>::GetDefault())
+            : m_centerX(allocator), m_centerY(allocator), m_centerZ(allocator), m_extentsX(allocator), m_extentsY(allocator),
+              m_extentsZ(allocator)
+        {}
+
+        AABBList(const u64 initialCapacity, Allocator* allocator = BaseAllocator<Allocator>::GetDefault()) : AABBList(allocator)
+        {
+            Reserve(initialCapacity);
+        }
+
+        void Reserve(const u64 capacity)
+        {
+            m_centerX.Reserve(capacity);
+            m_centerY.Reserve(capacity);
+            m_centerZ.Reserve(capacity);
+            m_extentsX.Reserve(capacity);
+            m_extentsY.Reserve(capacity);
+            m_extentsZ.Reserve(capacity);
+        }
+
+        void PushBack(const AABB& aabb)
+        {
+            m_centerX.PushBack(aabb.center.x);
+            m_centerY.PushBack(aabb.center.y);
+            m_centerZ.PushBack(aabb.center.z);
+            m_extentsX.PushBack(aabb.extents.x);
+            m_extentsY.PushBack(aabb.extents.y);
+            m_extentsZ.PushBack(aabb.extents.z);
+        }
+
+        void Set(const u64 index, const AABB& aabb)
+        {
+            m_centerX[index]  = aabb.center.x;
+            m_centerY[index]  = aabb.center.y;
+            m_centerZ[index]  = aabb.center.z;
+            m_extentsX[index] = aabb.extents.x;
+            m_extentsY[index] = aabb.extents.y;
+            m_extentsZ[index] = aabb.extents.z;
+        }
+
+        [[nodiscard]] AABB Get(const u64 index) const
+        {
+            return { vec3(m_centerX[index], m_centerY[index], m_centerZ[index]),
+                     vec3(m_extentsX[index], m_extentsY[index], m_extentsZ[index]) };
+        }
+
+        void Clear()
+        {
+            m_centerX.Clear();
+            m_centerY.Clear();
+            m_centerZ.Clear();
+            m_extentsX.Clear();
+            m_extentsY.Clear();
+            m_extentsZ.Clear();
+        }
+
+        void Destroy()
+        {
+            m_centerX.Destroy();
+            m_centerY.Destroy();
+            m_centerZ.Destroy();
+            m_extentsX.Destroy();
+            m_extentsY.Destroy();
+            m_extentsZ.Destroy();
+        }
+
+        /** @brief Gets a view over the arrays that can be passed to Frustum::IntersectsWithAABBs(). */
+        [[nodiscard]] AABBArrays GetArrays() const
+        {
+            return { m_centerX.GetData(),  m_centerY.GetData(),  m_centerZ.GetData(), m_extentsX.GetData(),
+                     m_extentsY.GetData(), m_extentsZ.GetData(), m_centerX.Size() };
+        }
+
+        [[nodiscard]] u64 Size() const { return m_centerX.Size(); }
+        [[nodiscard]] bool Empty() const { return m_centerX.Empty(); }
+
+    private:
+        DynamicArray<f32, Allocator> m_centerX, m_centerY, m_centerZ;
+        DynamicArray<f32, Allocator> m_extentsX, m_extentsY, m_extentsZ;
+    };
+}  // namespace C3D
@@ -0,0 +1,673 @@
+#include "bvh.h"
+
+#include <algorithm>
+
+#include "logger/logger.h"
+
+namespace C3D
+{
+    bool BVH::Create(const u32 initialCapacity, const f32 margin)
+    {
+        m_margin = margin;
+
+        // A tree with n leaves always has n - 1 internal nodes
+        m_nodes.Reserve(initialCapacity * 2);
+        Clear();
+        return true;
+    }
+
+    void BVH::Destroy()
+    {
+        m_nodes.Destroy();
+        m_root      = INVALID_ID;
+        m_freeList  = INVALID_ID;
+        m_leafCount = 0;
+    }
+
+    void BVH::Clear()
+    {
+        m_nodes.Clear();
+        m_root      = INVALID_ID;
+        m_freeList  = INVALID_ID;
+        m_leafCount = 0;
+    }
+
+    void BVH::Build(const Extents3D* bounds, const u32* userData, const u32 count, u32* outProxies)
+    {
+        Clear();
+        m_nodes.Reserve(count * 2);
+
+        for (u32 i = 0; i < count; ++i)
+        {
+            const auto leaf = AllocateNode();
+
+            auto& node    = m_nodes[leaf];
+            node.bounds   = { bounds[i].min - m_margin, bounds[i].max + m_margin };
+            node.userData = userData[i];
+
+            outProxies[i] = leaf;
+        }
+
+        m_leafCount = count;
+        Rebuild();
+    }
+
+    void BVH::Rebuild()
+    {
+        if (m_leafCount == 0)
+        {
+            Clear();
+            return;
+        }
+
+        DynamicArray<u32> leaves(m_leafCount);
+
+        // Gather all our leaves and free all internal nodes (since we will create new ones)
+        for (u32 i = 0; i < m_nodes.Size(); ++i)
+        {
+            if (m_nodes[i].height < 0) continue;
+
+            if (m_nodes[i].IsLeaf())
+            {
+                leaves.PushBack(i);
+            }
+            else
+            {
+                FreeNode(i);
+            }
+        }
+
+        m_root                 = BuildRecursive(leaves.GetData(), leaves.Size(), 0);
+        m_nodes[m_root].parent = INVALID_ID;
+    }
+
+    u32 BVH::Insert(const Extents3D& bounds, const u32 userData)
+    {
+        const auto leaf = AllocateNode();
+
+        auto& node    = m_nodes[leaf];
+        node.bounds   = { bounds.min - m_margin, bounds.max + m_margin };
+        node.userData = userData;
+
+        InsertLeaf(leaf);
+        m_leafCount++;
+        return leaf;
+    }
+
+    void BVH::Remove(const u32 proxy)
+    {
+        if (proxy >= m_nodes.Size() || !m_nodes[proxy].IsLeaf() || m_nodes[proxy].height < 0)
+        {
+            ERROR_LOG("Invalid proxy: {} provided.", proxy);
+            return;
+        }
+
+        RemoveLeaf(proxy);
+        FreeNode(proxy);
+        m_leafCount--;
+    }
+
+    bool BVH::Update(const u32 proxy, const Extents3D& bounds)
+    {
+        if (proxy >= m_nodes.Size() || !m_nodes[proxy].IsLeaf() || m_nodes[proxy].height < 0)
+        {
+            ERROR_LOG("Invalid proxy: {} provided.", proxy);
+            return false;
+        }
+
+        const auto& fatBounds = m_nodes[proxy].bounds;
+
+        // If the object still fits in it's fattened bounds (and those are not way too large) we don't have to do anything
+        const Extents3D largeBounds = { bounds.min - m_margin * 4.0f, bounds.max + m_margin * 4.0f };
+        if (Contains(fatBounds, bounds) && Contains(largeBounds, fatBounds))
+        {
+            return false;
+        }
+
+        RemoveLeaf(proxy);
+        m_nodes[proxy].bounds = { bounds.min - m_margin, bounds.max + m_margin };
+        InsertLeaf(proxy);
+        return true;
+    }
+
+    f32 BVH::GetCost() const
+    {
+        if (m_root == INVALID_ID) return 0.0f;
+
+        const f32 rootArea = GetArea(m_nodes[m_root].bounds);
+        if (rootArea <= 0.0f) return 0.0f;
+
+        f32 totalArea = 0.0f;
+        for (const auto& node : m_nodes)
+        {
+            if (node.height <= 0) continue;
+            totalArea += GetArea(node.bounds);
+        }
+        return totalArea / rootArea;
+    }
+
+    bool BVH::Validate() const
+    {
+        if (m_root == INVALID_ID) return m_leafCount == 0;
+
+        if (m_nodes[m_root].parent != INVALID_ID)
+        {
+            ERROR_LOG("Root node has a parent.");
+            return false;
+        }
+
+        u32 leafCount = 0;
+        if (!ValidateNode(m_root, leafCount)) return false;
+
+        if (leafCount != m_leafCount)
+        {
+            ERROR_LOG("Found: {} leaves but expected: {}.", leafCount, m_leafCount);
+            return false;
+        }
+
+        // Every node should either be in use or on our free list
+        u32 freeCount = 0;
+        for (auto index = m_freeList; index != INVALID_ID; index = m_nodes[index].parent)
+        {
+            freeCount++;
+        }
+
+        const u32 usedCount = m_leafCount * 2 - 1;
+        if (usedCount + freeCount != m_nodes.Size())
+        {
+            ERROR_LOG("Found: {} used nodes and: {} free nodes but we have: {} nodes.", usedCount, freeCount, m_nodes.Size());
+            return false;
+        }
+
+        return true;
+    }
+
+    u32 BVH::AllocateNode()
+    {
+        u32 index;
+        if (m_freeList != INVALID_ID)
+        {
+            index      = m_freeList;
+            m_freeList = m_nodes[index].parent;
+        }
+        else
+        {
+            index = m_nodes.Size();
+            m_nodes.EmplaceBack();
+        }
+
+        auto& node    = m_nodes[index];
+        node.parent   = INVALID_ID;
+        node.left     = INVALID_ID;
+        node.right    = INVALID_ID;
+        node.height   = 0;
+        node.userData = INVALID_ID;
+        return index;
+    }
+
+    void BVH::FreeNode(const u32 index)
+    {
+        auto& node  = m_nodes[index];
+        node.height = -1;
+        node.left   = INVALID_ID;
+        node.right  = INVALID_ID;
+        node.parent = m_freeList;
+        m_freeList  = index;
+    }
+
+    void BVH::InsertLeaf(const u32 leaf)
+    {
+        if (m_root == INVALID_ID)
+        {
+            m_root               = leaf;
+            m_nodes[leaf].parent = INVALID_ID;
+            return;
+        }
+
+        // Find the best sibling for our new leaf by descending the tree and using the SAH to decide which way to go
+        const auto leafBounds = m_nodes[leaf].bounds;
+
+        auto index = m_root;
+        while (!m_nodes[index].IsLeaf())
+        {
+            const auto& node = m_nodes[index];
+
+            const f32 area         = GetArea(node.bounds);
+            const f32 combinedArea = GetArea(Combine(node.bounds, leafBounds));
+
+            // The cost of creating a new parent for this node and the new leaf
+            const f32 cost = 2.0f * combinedArea;
+            // The minimum cost of pushing the leaf further down the tree (every ancestor will grow by this amount)
+            const f32 inheritanceCost = 2.0f * (combinedArea - area);
+
+            // The cost of descending into one of the children
+            const auto getChildCost = [&](const u32 childIndex) {
+                const auto& child = m_nodes[childIndex];
+                const f32 newArea = GetArea(Combine(child.bounds, leafBounds));
+                return (child.IsLeaf() ? newArea : newArea - GetArea(child.bounds)) + inheritanceCost;
+            };
+
+            const f32 leftCost  = getChildCost(node.left);
+            const f32 rightCost = getChildCost(node.right);
+
+            // Stop if creating a new parent here is cheaper than descending
+            if (cost < leftCost && cost < rightCost) break;
+
+            index = leftCost < rightCost ? node.left : node.right;
+        }
+
+        const auto sibling   = index;
+        const auto oldParent = m_nodes[sibling].parent;
+
+        // NOTE: This could grow our array of nodes so we don't hold on to any references before this point
+        const auto newParent = AllocateNode();
+
+        auto& parent  = m_nodes[newParent];
+        parent.parent = oldParent;
+        parent.bounds = Combine(leafBounds, m_nodes[sibling].bounds);
+        parent.height = m_nodes[sibling].height + 1;
+        parent.left   = sibling;
+        parent.right  = leaf;
+
+        if (oldParent != INVALID_ID)
+        {
+            // The sibling was not the root
+            auto& oldParentNode = m_nodes[oldParent];
+            if (oldParentNode.left == sibling)
+            {
+                oldParentNode.left = newParent;
+            }
+            else
+            {
+                oldParentNode.right = newParent;
+            }
+        }
+        else
+        {
+            // The sibling was the root
+            m_root = newParent;
+        }
+
+        m_nodes[sibling].parent = newParent;
+        m_nodes[leaf].parent    = newParent;
+
+        RefitAncestors(newParent);
+    }
+
+    void BVH::RemoveLeaf(const u32 leaf)
+    {
+        if (leaf == m_root)
+        {
+            m_root = INVALID_ID;
+            return;
+        }
+
+        const auto parent      = m_nodes[leaf].parent;
+        const auto grandParent = m_nodes[parent].parent;
+        const auto sibling     = m_nodes[parent].left == leaf ? m_nodes[parent].right : m_nodes[parent].left;
+
+        if (grandParent != INVALID_ID)
+        {
+            // Replace our parent with our sibling
+            auto& grandParentNode = m_nodes[grandParent];
+            if (grandParentNode.left == parent)
+            {
+                grandParentNode.left = sibling;
+            }
+            else
+            {
+                grandParentNode.right = sibling;
+            }
+
+            m_nodes[sibling].parent = grandParent;
+            FreeNode(parent);
+
+            RefitAncestors(grandParent);
+        }
+        else
+        {
+            // Our parent was the root so our sibling becomes the new root
+            m_root                  = sibling;
+            m_nodes[sibling].parent = INVALID_ID;
+            FreeNode(parent);
+        }
+
+        m_nodes[leaf].parent = INVALID_ID;
+    }
+
+    void BVH::RefitAncestors(u32 index)
+    {
+        while (index != INVALID_ID)
+        {
+            index = Balance(index);
+
+            auto& node        = m_nodes[index];
+            const auto& left  = m_nodes[node.left];
+            const auto& right = m_nodes[node.right];
+
+            node.height = 1 + Max(left.height, right.height);
+            node.bounds = Combine(left.bounds, right.bounds);
+
+            index = node.parent;
+        }
+    }
+
+    u32 BVH::Balance(const u32 iA)
+    {
+        auto& a = m_nodes[iA];
+        if (a.IsLeaf() || a.height < 2) return iA;
+
+        const auto iB = a.left;
+        const auto iC = a.right;
+        auto& b       = m_nodes[iB];
+        auto& c       = m_nodes[iC];
+
+        const i32 balance = c.height - b.height;
+
+        if (balance > 1)
+        {
+            // Rotate C up
+            const auto iF = c.left;
+            const auto iG = c.right;
+            auto& f       = m_nodes[iF];
+            auto& g       = m_nodes[iG];
+
+            // Swap A and C
+            c.left   = iA;
+            c.parent = a.parent;
+            a.parent = iC;
+
+            // A's old parent should point to C
+            if (c.parent != INVALID_ID)
+            {
+                auto& parent = m_nodes[c.parent];
+                if (parent.left == iA)
+                {
+                    parent.left = iC;
+                }
+                else
+                {
+                    parent.right = iC;
+                }
+            }
+            else
+            {
+                m_root = iC;
+            }
+
+            // Keep the highest of F and G as a child of C
+            if (f.height > g.height)
+            {
+                c.right  = iF;
+                a.right  = iG;
+                g.parent = iA;
+                a.bounds = Combine(b.bounds, g.bounds);
+                c.bounds = Combine(a.bounds, f.bounds);
+                a.height = 1 + Max(b.height, g.height);
+                c.height = 1 + Max(a.height, f.height);
+            }
+            else
+            {
+                c.right  = iG;
+                a.right  = iF;
+                f.parent = iA;
+                a.bounds = Combine(b.bounds, f.bounds);
+                c.bounds = Combine(a.bounds, g.bounds);
+                a.height = 1 + Max(b.height, f.height);
+                c.height = 1 + Max(a.height, g.height);
+            }
+
+            return iC;
+        }
+
+        if (balance < -1)
+        {
+            // Rotate B up
+            const auto iD = b.left;
+            const auto iE = b.right;
+            auto& d       = m_nodes[iD];
+            auto& e       = m_nodes[iE];
+
+            // Swap A and B
+            b.left   = iA;
+            b.parent = a.parent;
+            a.parent = iB;
+
+            // A's old parent should point to B
+            if (b.parent != INVALID_ID)
+            {
+                auto& parent = m_nodes[b.parent];
+                if (parent.left == iA)
+                {
+                    parent.left = iB;
+                }
+                else
+                {
+                    parent.right = iB;
+                }
+            }
+            else
+            {
+                m_root = iB;
+            }
+
+            // Keep the highest of D and E as a child of B
+            if (d.height > e.height)
+            {
+                b.right  = iD;
+                a.left   = iE;
+                e.parent = iA;
+                a.bounds = Combine(c.bounds, e.bounds);
+                b.bounds = Combine(a.bounds, d.bounds);
+                a.height = 1 + Max(c.height, e.height);
+                b.height = 1 + Max(a.height, d.height);
+            }
+            else
+            {
+                b.right  = iE;
+                a.left   = iD;
+                d.parent = iA;
+                a.bounds = Combine(c.bounds, d.bounds);
+                b.bounds = Combine(a.bounds, e.bounds);
+                a.height = 1 + Max(c.height, d.height);
+                b.height = 1 + Max(a.height, e.height);
+            }
+
+            return iB;
+        }
+
+        return iA;
+    }
+
+    u32 BVH::BuildRecursive(u32* leaves, const u32 count, const u32 depth)
+    {
+        if (count == 1) return leaves[0];
+
+        const auto getCentroid = [this](const u32 leaf) {
+            const auto& bounds = m_nodes[leaf].bounds;
+            return (bounds.min + bounds.max) * 0.5f;
+        };
+
+        // Find the bounds of the centroids of all leaves
+        Extents3D centroidBounds = { vec3(F32_MAX), vec3(-F32_MAX) };
+        for (u32 i = 0; i < count; ++i)
+        {
+            const auto centroid = getCentroid(leaves[i]);
+            centroidBounds.min  = glm::min(centroidBounds.min, centroid);
+            centroidBounds.max  = glm::max(centroidBounds.max, centroid);
+        }
+
+        const vec3 centroidSize = centroidBounds.max - centroidBounds.min;
+
+        u32 mid = 0;
+
+        if (depth < BVH_MAX_SAH_DEPTH)
+        {
+            // Bin the leaves along every axis and find the split with the lowest SAH cost
+            struct Bin
+            {
+                Extents3D bounds = { vec3(F32_MAX), vec3(-F32_MAX) };
+                u32 count        = 0;
+            };
+
+            f32 bestCost  = F32_MAX;
+            u32 bestAxis  = 0;
+            u32 bestSplit = 0;
+
+            for (u32 axis = 0; axis < 3; ++axis)
+            {
+                if (centroidSize[axis] <= F32_EPSILON) continue;
+
+                Bin bins[BVH_SAH_BINS];
+                const f32 scale = BVH_SAH_BINS / centroidSize[axis];
+
+                for (u32 i = 0; i < count; ++i)
+                {
+                    const auto binIndex = Min(static_cast<u32>((getCentroid(leaves[i])[axis] - centroidBounds.min[axis]) * scale),
+                                              BVH_SAH_BINS - 1);
+                    auto& bin  = bins[binIndex];
+                    bin.bounds = Combine(bin.bounds, m_nodes[leaves[i]].bounds);
+                    bin.count++;
+                }
+
+                // Sweep from the right to find the area and count of everything right of every split
+                f32 rightAreas[BVH_SAH_BINS];
+                u32 rightCounts[BVH_SAH_BINS];
+
+                Extents3D rightBounds = { vec3(F32_MAX), vec3(-F32_MAX) };
+                u32 rightCount        = 0;
+                for (u32 i = BVH_SAH_BINS - 1; i > 0; --i)
+                {
+                    rightBounds = Combine(rightBounds, bins[i].bounds);
+                    rightCount += bins[i].count;
+
+                    rightAreas[i]  = rightCount > 0 ? GetArea(rightBounds) : 0.0f;
+                    rightCounts[i] = rightCount;
+                }
+
+                // Then sweep from the left and evaluate the cost of splitting after every bin
+                Extents3D leftBounds = { vec3(F32_MAX), vec3(-F32_MAX) };
+                u32 leftCount        = 0;
+                for (u32 i = 0; i < BVH_SAH_BINS - 1; ++i)
+                {
+                    leftBounds = Combine(leftBounds, bins[i].bounds);
+                    leftCount += bins[i].count;
+
+                    if (leftCount == 0 || rightCounts[i + 1] == 0) continue;
+
+                    const f32 cost = leftCount * GetArea(leftBounds) + rightCounts[i + 1] * rightAreas[i + 1];
+                    if (cost < bestCost)
+                    {
+                        bestCost  = cost;
+                        bestAxis  = axis;
+                        bestSplit = i;
+                    }
+                }
+            }
+
+            if (bestCost < F32_MAX)
+            {
+                const f32 scale = BVH_SAH_BINS / centroidSize[bestAxis];
+                const auto it   = std::partition(leaves, leaves + count, [&](const u32 leaf) {
+                    const auto binIndex =
+                        Min(static_cast<u32>((getCentroid(leaf)[bestAxis] - centroidBounds.min[bestAxis]) * scale), BVH_SAH_BINS - 1);
+                    return binIndex <= bestSplit;
+                });
+                mid = static_cast<u32>(it - leaves);
+            }
+        }
+
+        if (mid == 0 || mid == count)
+        {
+            // Either we are too deep or the SAH could not find a split (all centroids are equal) so we split on the median
+            u32 axis = 0;
+            if (centroidSize.y > centroidSize[axis]) axis = 1;
+            if (centroidSize.z > centroidSize[axis]) axis = 2;
+
+            mid = count / 2;
+            std::nth_element(leaves, leaves + mid, leaves + count,
+                             [&](const u32 a, const u32 b) { return getCentroid(a)[axis] < getCentroid(b)[axis]; });
+        }
+
+        const auto left  = BuildRecursive(leaves, mid, depth + 1);
+        const auto right = BuildRecursive(leaves + mid, count - mid, depth + 1);
+
+        const auto index = AllocateNode();
+
+        auto& node  = m_nodes[index];
+        node.left   = left;
+        node.right  = right;
+        node.bounds = Combine(m_nodes[left].bounds, m_nodes[right].bounds);
+        node.height = 1 + Max(m_nodes[left].height, m_nodes[right].height);
+
+        m_nodes[left].parent  = index;
+        m_nodes[right].parent = index;
+
+        return index;
+    }
+
+    bool BVH::ValidateNode(const u32 index, u32& outLeafCount) const
+    {
+        const auto& node = m_nodes[index];
+
+        if (node.height < 0)
+        {
+            ERROR_LOG("Node: {} is in the tree but is marked as unused.", index);
+            return false;
+        }
+
+        if (node.IsLeaf())
+        {
+            if (node.right != INVALID_ID || node.height != 0)
+            {
+                ERROR_LOG("Leaf: {} has a right child or a height that is not 0.", index);
+                return false;
+            }
+
+            outLeafCount++;
+            return true;
+        }
+
+        const auto& left  = m_nodes[node.left];
+        const auto& right = m_nodes[node.right];
+
+        if (left.parent != index || right.parent != index)
+        {
+            ERROR_LOG("The children of node: {} don't have it as their parent.", index);
+            return false;
+        }
+
+        if (node.height != 1 + Max(left.height, right.height))
+        {
+            ERROR_LOG("Node: {} has an invalid height.", index);
+            return false;
+        }
+
+        if (!Contains(node.bounds, left.bounds) || !Contains(node.bounds, right.bounds))
+        {
+            ERROR_LOG("The bounds of node: {} don't contain the bounds of it's children.", index);
+            return false;
+        }
+
+        return ValidateNode(node.left, outLeafCount) && ValidateNode(node.right, outLeafCount);
+    }
+
+    BVH::FrustumTestResult BVH::TestAgainstFrustum(const Frustum& frustum, const Extents3D& bounds)
+    {
+        const vec3 center  = (bounds.min + bounds.max) * 0.5f;
+        const vec3 extents = bounds.max - center;
+
+        auto result = FrustumTestResult::Inside;
+        for (const auto& side : frustum.sides)
+        {
+            const f32 signedDistance = side.SignedDistance(center);
+            const f32 radius = extents.x * Abs(side.normal.x) + extents.y * Abs(side.normal.y) + extents.z * Abs(side.normal.z);
+
+            // Completely behind this plane
+            if (signedDistance + radius < 0.0f) return FrustumTestResult::Outside;
+            // Partially behind this plane
+            if (signedDistance - radius < 0.0f) result = FrustumTestResult::Intersects;
+        }
+        return result;
+    }
+}  // namespace C3D
@@ -0,0 +1,385 @@
+#pragma once
+#include "c3d_math.h"
+#include "containers/dynamic_array.h"
+#include "defines.h"
+#include "frustum.h"
+#include "math_types.h"
+#include "ray.h"
+
+namespace C3D
+{
+    /** @brief The maximum depth of the tree that our queries support. Trees built by the BVH stay well below this. */
+    constexpr u32 BVH_MAX_QUERY_DEPTH = 256;
+    /** @brief Below this depth the SAH build is used. Deeper than this we split on the median to guarantee a bounded depth. */
+    constexpr u32 BVH_MAX_SAH_DEPTH = 64;
+    /** @brief The amount of bins that are used to evaluate the surface area heuristic for every axis. */
+    constexpr u32 BVH_SAH_BINS = 12;
+
+    struct BVHNode
+    {
+        /** @brief The bounds of this node. For leaves these are the (fattened) bounds of the object. */
+        Extents3D bounds;
+        /** @brief The index of the parent of this node. For unused nodes this is the index of the next unused node. */
+        u32 parent = INVALID_ID;
+        /** @brief The indices of the children of this node. Both are INVALID_ID for leaves. */
+        u32 left  = INVALID_ID;
+        u32 right = INVALID_ID;
+        /** @brief The height of this node in the tree. Leaves have a height of 0 and unused nodes a height of -1. */
+        i32 height = -1;
+        /** @brief The user provided data for leaves. */
+        u32 userData = INVALID_ID;
+
+        [[nodiscard]] bool IsLeaf() const { return left == INVALID_ID; }
+    };
+
+    /**
+     * @brief A dynamic bounding volume hierarchy of axis aligned bounding boxes.
+     * Every object is a leaf in the tree which is identified by a proxy (which stays valid until the object is removed).
+     * Objects can be added in bulk with Build() which creates the tree top-down using the surface area heuristic (SAH).
+     * Objects can also be inserted, removed and moved individually. Leaves store their bounds with an extra margin so small movements
+     * don't require any changes to the tree. When an object moves out of it's fattened bounds it's leaf is reinserted and all
+     * ancestors are refit (and rebalanced) on the way up.
+     */
+    class C3D_API BVH
+    {
+    public:
+        /**
+         * @brief Creates the BVH.
+         *
+         * @param initialCapacity The amount of objects that we expect to store
+         * @param margin The amount that the bounds of every leaf are expanded by
+         */
+        bool Create(u32 initialCapacity = 64, f32 margin = 0.1f);
+        void Destroy();
+
+        /** @brief Removes all objects from the BVH. */
+        void Clear();
+
+        /**
+         * @brief Replaces all objects in the BVH with the provided objects and builds an optimized tree for them.
+         *
+         * @param bounds An array of count bounds
+         * @param userData An array of count user provided values (one for each object)
+         * @param count The amount of objects
+         * @param outProxies An array of count proxies that will be filled with the proxy for every object
+         */
+        void Build(const Extents3D* bounds, const u32* userData, u32 count, u32* outProxies);
+
+        /** @brief Rebuilds the tree for the objects that are currently stored using the SAH. All proxies remain valid. */
+        void Rebuild();
+
+        /** @brief Inserts a new object and returns the proxy that identifies it. */
+        u32 Insert(const Extents3D& bounds, u32 userData);
+
+        /** @brief Removes the object with the provided proxy. */
+        void Remove(u32 proxy);
+
+        /**
+         * @brief Updates the bounds of the object with the provided proxy.
+         * Returns true if the tree had to be changed and false if the new bounds still fit inside of the leaf's fattened bounds.
+         */
+        bool Update(u32 proxy, const Extents3D& bounds);
+
+        [[nodiscard]] u32 GetUserData(const u32 proxy) const { return m_nodes[proxy].userData; }
+        [[nodiscard]] const Extents3D& GetFatBounds(const u32 proxy) const { return m_nodes[proxy].bounds; }
+
+        [[nodiscard]] u32 GetLeafCount() const { return m_leafCount; }
+        [[nodiscard]] u32 GetHeight() const { return m_root == INVALID_ID ? 0 : m_nodes[m_root].height; }
+
+        /** @brief Gets the SAH cost of the tree (the surface areas of all internal nodes relative to the root). Lower is better. */
+        [[nodiscard]] f32 GetCost() const;
+
+        /** @brief Checks the structure of the tree. Returns false if anything is not as it should be. Intended for tests and debugging. */
+        [[nodiscard]] bool Validate() const;
+
+        /**
+         * @brief Calls callback(userData, distance) for every object whose bounds are hit by the provided ray within maxDistance.
+         * The distance is the distance along the ray at which the (fattened) bounds are entered.
+         */
+        template <typename Callback>
+        void QueryRay(const Ray& ray, f32 maxDistance, Callback&& callback) const;
+
+        /** @brief Calls callback(userData) for every object whose bounds intersect with the provided frustum. */
+        template <typename Callback>
+        void QueryFrustum(const Frustum& frustum, Callback&& callback) const;
+
+        /** @brief Calls callback(userData) for every object whose bounds intersect with the provided sphere. */
+        template <typename Callback>
+        void QuerySphere(const Sphere& sphere, Callback&& callback) const;
+
+        /**
+         * @brief Calls callback(userData) for every object whose bounds (grown by radius on every axis) are hit by the infinite line
+         * through point in the provided direction. This finds every object that is within radius of the line (and possibly a few more).
+         */
+        template <typename Callback>
+        void QueryLine(const vec3& point, const vec3& direction, f32 radius, Callback&& callback) const;
+
+        /** @brief Calls callback(userData) for every object whose bounds overlap with the provided bounds. */
+        template <typename Callback>
+        void QueryBounds(const Extents3D& bounds, Callback&& callback) const;
+
+    private:
+        enum class FrustumTestResult : u8
+        {
+            Outside,
+            Intersects,
+            Inside,
+        };
+
+        u32 AllocateNode();
+        void FreeNode(u32 index);
+
+        void InsertLeaf(u32 leaf);
+        void RemoveLeaf(u32 leaf);
+
+        /** @brief Walks from the provided node up to the root refitting the bounds and balancing the tree on the way. */
+        void RefitAncestors(u32 index);
+        /** @brief Rotates the subtree at the provided index if it is imbalanced. Returns the (new) root of the subtree. */
+        u32 Balance(u32 index);
+
+        /** @brief Builds a subtree (top-down using the SAH) for the provided leaves and returns the index of it's root. */
+        u32 BuildRecursive(u32* leaves, u32 count, u32 depth);
+
+        /** @brief Calls callback(userData) for every leaf in the subtree with the provided root. */
+        template <typename Callback>
+        void ForEachLeaf(u32 root, Callback&& callback) const;
+
+        [[nodiscard]] bool ValidateNode(u32 index, u32& outLeafCount) const;
+
+        static FrustumTestResult TestAgainstFrustum(const Frustum& frustum, const Extents3D& bounds);
+
+        static Extents3D Combine(const Extents3D& a, const Extents3D& b) { return { glm::min(a.min, b.min), glm::max(a.max, b.max) }; }
+
+        static bool Contains(const Extents3D& outer, const Extents3D& inner)
+        {
+            return outer.min.x <= inner.min.x && outer.min.y <= inner.min.y && outer.min.z <= inner.min.z && inner.max.x <= outer.max.x &&
+                   inner.max.y <= outer.max.y && inner.max.z <= outer.max.z;
+        }
+
+        static bool Overlaps(const Extents3D& a, const Extents3D& b)
+        {
+            return a.min.x <= b.max.x && b.min.x <= a.max.x && a.min.y <= b.max.y && b.min.y <= a.max.y && a.min.z <= b.max.z &&
+                   b.min.z <= a.max.z;
+        }
+
+        /** @brief Half of the surface area of the provided bounds (which is all we need to compare costs). */
+        static f32 GetArea(const Extents3D& bounds)
+        {
+            const vec3 size = bounds.max - bounds.min;
+            return size.x * size.y + size.y * size.z + size.z * size.x;
+        }
+
+        /** @brief Tests the provided ray (with precomputed inverse direction) against the bounds using the slab method. */
+        static bool IntersectsRay(const vec3& origin, const vec3& inverseDirection, const Extents3D& bounds, f32 maxDistance,
+                                  f32& outDistance)
+        {
+            const vec3 t0   = (bounds.min - origin) * inverseDirection;
+            const vec3 t1   = (bounds.max - origin) * inverseDirection;
+            const vec3 tMin = glm::min(t0, t1);
+            const vec3 tMax = glm::max(t0, t1);
+
+            const f32 enter = Max(Max(tMin.x, tMin.y), Max(tMin.z, 0.0f));
+            const f32 exit  = Min(Min(tMax.x, tMax.y), Min(tMax.z, maxDistance));
+
+            outDistance = enter;
+            return enter <= exit;
+        }
+
+        /** @brief Tests if the infinite line (with precomputed inverse direction) hits the bounds grown by radius on every axis. */
+        static bool IntersectsLine(const vec3& point, const vec3& inverseDirection, const Extents3D& bounds, const f32 radius)
+        {
+            const vec3 t0   = (bounds.min - radius - point) * inverseDirection;
+            const vec3 t1   = (bounds.max + radius - point) * inverseDirection;
+            const vec3 tMin = glm::min(t0, t1);
+            const vec3 tMax = glm::max(t0, t1);
+
+            return Max(Max(tMin.x, tMin.y), tMin.z) <= Min(Min(tMax.x, tMax.y), tMax.z);
+        }
+
+        DynamicArray<BVHNode> m_nodes;
+
+        /** @brief The index of the root node. INVALID_ID if the tree is empty. */
+        u32 m_root = INVALID_ID;
+        /** @brief The index of the first unused node (the others are linked through their parent index). */
+        u32 m_freeList = INVALID_ID;
+
+        u32 m_leafCount = 0;
+        f32 m_margin    = 0.1f;
+    };
+
+    template <typename Callback>
+    void BVH::QueryRay(const Ray& ray, const f32 maxDistance, Callback&& callback) const
+    {
+        if (m_root == INVALID_ID) return;
+
+        // NOTE: Division by zero gives us +/- infinity which the slab test handles correctly
+        const vec3 inverseDirection = 1.0f / ray.direction;
+
+        u32 stack[BVH_MAX_QUERY_DEPTH];
+        u32 stackSize      = 0;
+        stack[stackSize++] = m_root;
+
+        while (stackSize > 0)
+        {
+            const auto& node = m_nodes[stack[--stackSize]];
+
+            f32 distance;
+            if (!IntersectsRay(ray.origin, inverseDirection, node.bounds, maxDistance, distance)) continue;
+
+            if (node.IsLeaf())
+            {
+                callback(node.userData, distance);
+            }
+            else
+            {
+                stack[stackSize++] = node.left;
+                stack[stackSize++] = node.right;
+            }
+        }
+    }
+
+    template <typename Callback>
+    void BVH::QueryFrustum(const Frustum& frustum, Callback&& callback) const
+    {
+        if (m_root == INVALID_ID) return;
+
+        u32 stack[BVH_MAX_QUERY_DEPTH];
+        u32 stackSize      = 0;
+        stack[stackSize++] = m_root;
+
+        while (stackSize > 0)
+        {
+            const auto index = stack[--stackSize];
+            const auto& node = m_nodes[index];
+
+            const auto result = TestAgainstFrustum(frustum, node.bounds);
+            if (result == FrustumTestResult::Outside) continue;
+
+            if (node.IsLeaf())
+            {
+                callback(node.userData);
+            }
+            else if (result == FrustumTestResult::Inside)
+            {
+                // The entire subtree is inside of the frustum so we don't need to test any of it's nodes
+                ForEachLeaf(index, callback);
+            }
+            else
+            {
+                stack[stackSize++] = node.left;
+                stack[stackSize++] = node.right;
+            }
+        }
+    }
+
+    template <typename Callback>
+    void BVH::QuerySphere(const Sphere& sphere, Callback&& callback) const
+    {
+        if (m_root == INVALID_ID) return;
+
+        const f32 radiusSquared = sphere.radius * sphere.radius;
+
+        u32 stack[BVH_MAX_QUERY_DEPTH];
+        u32 stackSize      = 0;
+        stack[stackSize++] = m_root;
+
+        while (stackSize > 0)
+        {
+            const auto& node = m_nodes[stack[--stackSize]];
+
+            // The squared distance between the center of the sphere and the closest point in the bounds
+            const vec3 closest = glm::min(glm::max(sphere.center, node.bounds.min), node.bounds.max);
+            const vec3 offset  = closest - sphere.center;
+            if (glm::dot(offset, offset) > radiusSquared) continue;
+
+            if (node.IsLeaf())
+            {
+                callback(node.userData);
+            }
+            else
+            {
+                stack[stackSize++] = node.left;
+                stack[stackSize++] = node.right;
+            }
+        }
+    }
+
+    template <typename Callback>
+    void BVH::QueryLine(const vec3& point, const vec3& direction, const f32 radius, Callback&& callback) const
+    {
+        if (m_root == INVALID_ID) return;
+
+        // NOTE: Division by zero gives us +/- infinity which the slab test handles correctly
+        const vec3 inverseDirection = 1.0f / direction;
+
+        u32 stack[BVH_MAX_QUERY_DEPTH];
+        u32 stackSize      = 0;
+        stack[stackSize++] = m_root;
+
+        while (stackSize > 0)
+        {
+            const auto& node = m_nodes[stack[--stackSize]];
+
+            // NOTE: We can't use the bounding sphere of the node here since the spheres of it's children are not always contained in it
+            if (!IntersectsLine(point, inverseDirection, node.bounds, radius)) continue;
+
+            if (node.IsLeaf())
+            {
+                callback(node.userData);
+            }
+            else
+            {
+                stack[stackSize++] = node.left;
+                stack[stackSize++] = node.right;
+            }
+        }
+    }
+
+    template <typename Callback>
+    void BVH::QueryBounds(const Extents3D& bounds, Callback&& callback) const
+    {
+        if (m_root == INVALID_ID) return;
+
+        u32 stack[BVH_MAX_QUERY_DEPTH];
+        u32 stackSize      = 0;
+        stack[stackSize++] = m_root;
+
+        while (stackSize > 0)
+        {
+            const auto& node = m_nodes[stack[--stackSize]];
+            if (!Overlaps(node.bounds, bounds)) continue;
+
+            if (node.IsLeaf())
+            {
+                callback(node.userData);
+            }
+            else
+            {
+                stack[stackSize++] = node.left;
+                stack[stackSize++] = node.right;
+            }
+        }
+    }
+
+    template <typename Callback>
+    void BVH::ForEachLeaf(const u32 root, Callback&& callback) const
+    {
+        u32 stack[BVH_MAX_QUERY_DEPTH];
+        u32 stackSize      = 0;
+        stack[stackSize++] = root;
+
+        while (stackSize > 0)
+        {
+            const auto& node = m_nodes[stack[--stackSize]];
+            if (node.IsLeaf())
+            {
+                callback(node.userData);
+            }
+            else
+            {
+                stack[stackSize++] = node.left;
+                stack[stackSize++] = node.right;
+            }
+        }
+    }
+}  // namespace C3D
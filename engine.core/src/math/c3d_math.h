@@ -356,6 +356,21 @@ namespace C3D
         return x < 0.0f ? -1.0f : 1.0f;
     }
 
+    /**
+     * @brief Transforms the provided (local space) AABB by the provided model matrix.
+     * The resulting AABB fully contains the transformed box, also when the model matrix contains a rotation.
+     */
+    C3D_API C3D_INLINE AABB TransformAABB(const mat4& model, const vec3& center, const vec3& extents)
+    {
+        AABB result;
+        result.center = model * vec4(center, 1.0f);
+        for (u32 i = 0; i < 3; ++i)
+        {
+            result.extents[i] = Abs(model[0][i]) * extents.x + Abs(model[1][i]) * extents.y + Abs(model[2][i]) * extents.z;
+        }
+        return result;
+    }
+
     C3D_API C3D_INLINE f32 DistancePointToLine(const vec3& point, const vec3& lineStart, const vec3& lineDirection)
     {
         f32 magnitude = glm::length(glm::cross(point - lineStart, lineDirection));
@@ -1,8 +1,32 @@
 
 #include "frustum.h"
 
+#include <cstring>
+
+#if defined(C3D_SIMD_AVX)
+#include <immintrin.h>
+#elif defined(C3D_SIMD_SSE)
+#include <emmintrin.h>
+#endif
+
+#include "c3d_math.h"
+
 namespace C3D
 {
+    /** @brief Tests the AABB at the provided index against all planes. Uses the exact same operations as the SIMD path. */
+    static bool AABBIntersectsWithPlanes(const Plane3D* sides, const AABBArrays& aabbs, const u64 i)
+    {
+        for (u32 p = 0; p < FrustumPlaneMax; ++p)
+        {
+            const auto& n = sides[p].normal;
+
+            const f32 signedDistance = n.x * aabbs.centerX[i] + n.y * aabbs.centerY[i] + n.z * aabbs.centerZ[i] - sides[p].distance;
+            const f32 radius         = Abs(n.x) * aabbs.extentsX[i] + Abs(n.y) * aabbs.extentsY[i] + Abs(n.z) * aabbs.extentsZ[i];
+            if (!(signedDistance + radius >= 0.0f)) return false;
+        }
+        return true;
+    }
+
     Frustum::Frustum(const vec3& position, const vec3& forward, const vec3& right, const vec3& up, f32 nearClip, f32 farClip, f32 fov,
                      f32 aspectRatio)
     {
@@ -61,6 +85,111 @@ namespace C3D
         return true;
     }
 
+    void Frustum::IntersectsWithAABBs(const AABBArrays& aabbs, u64* outVisibility) const
+    {
+        std::memset(outVisibility, 0, sizeof(u64) * GetVisibilityMaskSize(aabbs.count));
+
+        u64 i = 0;
+
+#if defined(C3D_SIMD_AVX) || defined(C3D_SIMD_SSE)
+#if defined(C3D_SIMD_AVX)
+        constexpr u64 batchSize = 8;
+        using f32xN             = __m256;
+
+#define C3D_SET1(x) _mm256_set1_ps(x)
+#define C3D_LOAD(p) _mm256_loadu_ps(p)
+#define C3D_MUL(a, b) _mm256_mul_ps(a, b)
+#define C3D_ADD(a, b) _mm256_add_ps(a, b)
+#define C3D_SUB(a, b) _mm256_sub_ps(a, b)
+#define C3D_AND(a, b) _mm256_and_ps(a, b)
+#define C3D_GE(a, b) _mm256_cmp_ps(a, b, _CMP_GE_OQ)
+#define C3D_MOVEMASK(a) _mm256_movemask_ps(a)
+#else
+        constexpr u64 batchSize = 4;
+        using f32xN             = __m128;
+
+#define C3D_SET1(x) _mm_set1_ps(x)
+#define C3D_LOAD(p) _mm_loadu_ps(p)
+#define C3D_MUL(a, b) _mm_mul_ps(a, b)
+#define C3D_ADD(a, b) _mm_add_ps(a, b)
+#define C3D_SUB(a, b) _mm_sub_ps(a, b)
+#define C3D_AND(a, b) _mm_and_ps(a, b)
+#define C3D_GE(a, b) _mm_cmpge_ps(a, b)
+#define C3D_MOVEMASK(a) _mm_movemask_ps(a)
+#endif
+
+        // Broadcast the components of every plane once so they can be reused for every batch
+        f32xN normalX[FrustumPlaneMax], normalY[FrustumPlaneMax], normalZ[FrustumPlaneMax], distance[FrustumPlaneMax];
+        f32xN absNormalX[FrustumPlaneMax], absNormalY[FrustumPlaneMax], absNormalZ[FrustumPlaneMax];
+
+        for (u32 p = 0; p < FrustumPlaneMax; ++p)
+        {
+            normalX[p]    = C3D_SET1(sides[p].normal.x);
+            normalY[p]    = C3D_SET1(sides[p].normal.y);
+            normalZ[p]    = C3D_SET1(sides[p].normal.z);
+            distance[p]   = C3D_SET1(sides[p].distance);
+            absNormalX[p] = C3D_SET1(Abs(sides[p].normal.x));
+            absNormalY[p] = C3D_SET1(Abs(sides[p].normal.y));
+            absNormalZ[p] = C3D_SET1(Abs(sides[p].normal.z));
+        }
+
+        const auto zero = C3D_SET1(0.0f);
+
+        for (; i + batchSize <= aabbs.count; i += batchSize)
+        {
+            const auto centerX  = C3D_LOAD(aabbs.centerX + i);
+            const auto centerY  = C3D_LOAD(aabbs.centerY + i);
+            const auto centerZ  = C3D_LOAD(aabbs.centerZ + i);
+            const auto extentsX = C3D_LOAD(aabbs.extentsX + i);
+            const auto extentsY = C3D_LOAD(aabbs.extentsY + i);
+            const auto extentsZ = C3D_LOAD(aabbs.extentsZ + i);
+
+            // Start with all lanes set and clear every lane that is fully behind one of the planes
+            auto inside = C3D_GE(zero, zero);
+            for (u32 p = 0; p < FrustumPlaneMax; ++p)
+            {
+                // The signed distance from the center of the AABB to the plane
+                auto signedDistance = C3D_ADD(C3D_MUL(normalX[p], centerX), C3D_MUL(normalY[p], centerY));
+                signedDistance      = C3D_SUB(C3D_ADD(signedDistance, C3D_MUL(normalZ[p], centerZ)), distance[p]);
+                // The extents of the AABB projected onto the normal of the plane
+                auto radius = C3D_ADD(C3D_MUL(absNormalX[p], extentsX), C3D_MUL(absNormalY[p], extentsY));
+                radius      = C3D_ADD(radius, C3D_MUL(absNormalZ[p], extentsZ));
+
+                inside = C3D_AND(inside, C3D_GE(C3D_ADD(signedDistance, radius), zero));
+            }
+
+            // NOTE: batchSize divides 64 so a batch never straddles two words of our visibility mask
+            const auto mask = static_cast<u64>(C3D_MOVEMASK(inside));
+            outVisibility[i / 64] |= mask << (i % 64);
+        }
+
+#undef C3D_SET1
+#undef C3D_LOAD
+#undef C3D_MUL
+#undef C3D_ADD
+#undef C3D_SUB
+#undef C3D_AND
+#undef C3D_GE
+#undef C3D_MOVEMASK
+#endif
+
+        // Test the remaining AABBs (or all of them if we don't have SIMD support) one at a time
+        for (; i < aabbs.count; ++i)
+        {
+            if (AABBIntersectsWithPlanes(sides, aabbs, i)) outVisibility[i / 64] |= 1ull << (i % 64);
+        }
+    }
+
+    void Frustum::IntersectsWithAABBsScalar(const AABBArrays& aabbs, u64* outVisibility) const
+    {
+        std::memset(outVisibility, 0, sizeof(u64) * GetVisibilityMaskSize(aabbs.count));
+
+        for (u64 i = 0; i < aabbs.count; ++i)
+        {
+            if (AABBIntersectsWithPlanes(sides, aabbs, i)) outVisibility[i / 64] |= 1ull << (i % 64);
+        }
+    }
+
     void FrustumCornerPointsInWorldSpace(const mat4& projectionView, vec4* corners)
     {
         mat4 inverseViewProjection = glm::inverse(projectionView);
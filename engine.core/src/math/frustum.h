@@ -17,6 +17,24 @@ namespace C3D
         FrustumPlaneMax
     };
 
+    /** @brief A view over a list of AABBs that are stored as a structure of arrays (one array per component). */
+    struct AABBArrays
+    {
+        const f32* centerX  = nullptr;
+        const f32* centerY  = nullptr;
+        const f32* centerZ  = nullptr;
+        const f32* extentsX = nullptr;
+        const f32* extentsY = nullptr;
+        const f32* extentsZ = nullptr;
+        u64 count           = 0;
+    };
+
+    /** @brief Gets the amount of u64s that are required to store a visibility bit for the provided amount of AABBs. */
+    constexpr u64 GetVisibilityMaskSize(const u64 count) { return (count + 63) / 64; }
+
+    /** @brief Checks if the bit for the provided index is set in the provided visibility mask. */
+    constexpr bool IsVisible(const u64* visibility, const u64 index) { return (visibility[index / 64] >> (index % 64)) & 1; }
+
     struct C3D_API Frustum
     {
         Frustum() = default;
@@ -28,6 +46,18 @@ namespace C3D
 
         [[nodiscard]] bool IntersectsWithAABB(const AABB& aabb) const;
 
+        /**
+         * @brief Tests all the provided AABBs against this frustum. Depending on the available instruction set 8 (AVX) or 4 (SSE)
+         * AABBs are tested at the same time. Bit i of outVisibility is set if AABB i intersects with this frustum.
+         *
+         * @param aabbs The AABBs that should be tested
+         * @param outVisibility A visibility mask that can hold at least GetVisibilityMaskSize(aabbs.count) u64s
+         */
+        void IntersectsWithAABBs(const AABBArrays& aabbs, u64* outVisibility) const;
+
+        /** @brief Same as IntersectsWithAABBs() but tests a single AABB at a time (without using SIMD instructions). */
+        void IntersectsWithAABBsScalar(const AABBArrays& aabbs, u64* outVisibility) const;
+
         Plane3D sides[FrustumPlaneMax] = {};
     };
 
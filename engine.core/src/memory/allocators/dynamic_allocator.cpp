@@ -1,11 +1,56 @@
-
 #include "dynamic_allocator.h"
 
+#include <atomic>
+
 #include "logger/logger.h"
 #include "metrics/metrics.h"
 
 namespace C3D
 {
+    /** @brief Protects the lists of thread caches of all allocators and the cache indices that are in use. */
+    static std::mutex s_threadCacheRegistryMutex;
+    static u32 s_threadCacheIndicesInUse = 0;
+
+    struct DynamicAllocator::ThreadCache
+    {
+        struct Magazine
+        {
+            /** @brief A stack of free slots. The most recently freed (and therefore most likely cached) slot is on top. */
+            void* slots[THREAD_CACHE_MAX_SLOTS];
+            u32 count = 0;
+        };
+
+        /** @brief Allocations (or frees when negative) that have not been added to the MetricSystem yet. */
+        struct PendingMetrics
+        {
+            std::atomic<i64> count     = 0;
+            std::atomic<i64> requested = 0;
+            std::atomic<i64> required  = 0;
+        };
+
+        void Track(const MemoryType type, const i64 count, const i64 requested, const i64 required)
+        {
+#ifdef C3D_MEMORY_METRICS
+            // NOTE: Only the owning thread adds to these but they can be flushed from any thread
+            auto& pending = pendingMetrics[ToUnderlying(type)];
+            pending.count.fetch_add(count, std::memory_order_relaxed);
+            pending.requested.fetch_add(requested, std::memory_order_relaxed);
+            pending.required.fetch_add(required, std::memory_order_relaxed);
+#endif
+        }
+
+        /** @brief The allocator that this cache belongs to or nullptr if that allocator has been destroyed. */
+        std::atomic<const DynamicAllocator*> owner = nullptr;
+        /** @brief The previous and next cache in the owner's list of caches. */
+        ThreadCache* prev = nullptr;
+        ThreadCache* next = nullptr;
+
+        Magazine magazines[SLAB_SIZE_CLASS_COUNT];
+#ifdef C3D_MEMORY_METRICS
+        PendingMetrics pendingMetrics[MAX_MEMORY_TYPES];
+#endif
+    };
+
     DynamicAllocator::DynamicAllocator(const AllocatorType type) : BaseAllocator(ToUnderlying(type)) {}
 
     bool DynamicAllocator::Create(void* memory, const u64 totalMemory, const u64 usableMemory)
@@ -16,7 +61,14 @@ namespace C3D
             return false;
         }
 
-        const u64 freeListMemoryRequirement = totalMemory - usableMemory;
+        const u64 slabMapSize = GetSlabMapSize(usableMemory);
+        if (totalMemory <= usableMemory + slabMapSize)
+        {
+            ERROR_LOG("TotalMemory: {} is too small. Please use GetMemoryRequirements(). Creation failed", totalMemory);
+            return false;
+        }
+
+        const u64 freeListMemoryRequirement = totalMemory - usableMemory - slabMapSize;
 
         m_totalSize  = totalMemory;
         m_memorySize = usableMemory;
@@ -24,16 +76,42 @@ namespace C3D
         // The first part of our memory will be used by our freelist
         m_freeList.Create(memory, freeListMemoryRequirement, SMALLEST_POSSIBLE_ALLOCATION, usableMemory);
 
-        // The second part of the memory will store the actual data that this allocator manages
-        m_memory = static_cast<char*>(memory) + freeListMemoryRequirement;
+        // The second part of our memory is used to keep track of which regions of our memory are slabs
+        m_slabMap     = static_cast<u8*>(memory) + freeListMemoryRequirement;
+        m_slabMapSize = slabMapSize;
+        std::memset(m_slabMap, 0, m_slabMapSize);
+
+        // The third part of the memory will store the actual data that this allocator manages
+        m_memory      = reinterpret_cast<char*>(m_slabMap) + m_slabMapSize;
+        m_slabMapBase = reinterpret_cast<u64>(m_memory) & ~(SLAB_SIZE - 1);
+
+        for (u32 i = 0; i < SLAB_SIZE_CLASS_COUNT; ++i)
+        {
+            auto& sizeClass    = m_sizeClasses[i];
+            sizeClass.slotSize = static_cast<u32>(SLAB_MIN_SIZE_CLASS << i);
+            sizeClass.capacity = static_cast<u32>((SLAB_SIZE - sizeof(SlabHeader)) / (sizeClass.slotSize + sizeof(SlabSlotInfo)));
+            sizeClass.cacheCapacity = static_cast<u32>(std::min<u64>(THREAD_CACHE_MAX_SLOTS, THREAD_CACHE_MAX_BYTES / sizeClass.slotSize));
+            sizeClass.partial  = nullptr;
+            sizeClass.empty    = nullptr;
+        }
+
+        // Slabs are only worth it if we have enough memory to spare
+        m_slabsEnabled = usableMemory >= SLAB_MIN_ALLOCATOR_SIZE;
 
         TRACE(
-            "Create() - Successfully created DynamicAllocator managing {} bytes. Total memory usage = ({} + {} = {}) "
-            "(UsableMemory + FreeListMemory = total)",
-            usableMemory, usableMemory, freeListMemoryRequirement, totalMemory);
+            "Create() - Successfully created DynamicAllocator managing {} bytes. Total memory usage = ({} + {} + {} = {}) "
+            "(UsableMemory + FreeListMemory + SlabMapMemory = total)",
+            usableMemory, usableMemory, freeListMemoryRequirement, slabMapSize, totalMemory);
 
         // Create a metrics object to track the allocations this allocator does
         m_id = Metrics.CreateAllocator("DYNAMIC_ALLOCATOR", static_cast<AllocatorType>(m_type), usableMemory);
+        Metrics.SetFragmentationCallback(
+            m_id,
+            [](const void* user, FragmentationReport& report) {
+                static_cast<const DynamicAllocator*>(user)->GetFragmentationReport(report);
+                return true;
+            },
+            this);
 
         m_initialized = true;
         return true;
@@ -41,26 +119,314 @@ namespace C3D
 
     bool DynamicAllocator::Destroy()
     {
+        SetThreadCachesEnabled(false);
+
+        // Our FreeList is about to be destroyed so we can no longer provide fragmentation reports
+        Metrics.SetFragmentationCallback(m_id, nullptr, nullptr);
         m_freeList.Destroy();
 
-        m_totalSize = 0;
-        m_memory    = nullptr;
+        for (auto& sizeClass : m_sizeClasses)
+        {
+            sizeClass.partial = nullptr;
+            sizeClass.empty   = nullptr;
+        }
+
+        m_totalSize    = 0;
+        m_memory       = nullptr;
+        m_slabMap      = nullptr;
+        m_slabsEnabled = false;
 
         // Destroy the metrics object associated with this
         Metrics.DestroyAllocator(m_id);
         return true;
     }
 
-    void* DynamicAllocator::AllocateBlock(const MemoryType type, u64 size, const u16 alignment) const
+    void* DynamicAllocator::AllocateBlock(const MemoryType type, const u64 size, const u16 alignment) const
     {
-        std::lock_guard allocGuard(m_mutex);
-
         if (size == 0 || alignment == 0)
         {
             ERROR_LOG("Allocate() requires a valid size and alignment");
             return nullptr;
         }
 
+        if (m_slabsEnabled && size <= SLAB_MAX_SIZE_CLASS && alignment <= SLAB_MAX_SIZE_CLASS)
+        {
+            // Small allocations are served from our size-class slabs
+            return AllocateFromSlab(type, size, alignment);
+        }
+
+        return AllocateFromFreeList(type, size, alignment);
+    }
+
+    void DynamicAllocator::Free(void* block) const
+    {
+        if (!block)
+        {
+            FATAL_LOG("Called with nullptr block.");
+        }
+
+        if (m_memory == nullptr || m_totalSize == 0)
+        {
+            // Tried to free something from this allocator while it is not managing any memory
+            FATAL_LOG("Called while dynamic allocator is not managing memory.");
+        }
+
+        if (block < m_memory || block > m_memory + m_totalSize)
+        {
+            void* endOfBlock = m_memory + m_totalSize;
+            FATAL_LOG("Called with block ({}) outside of allocator range ({}) - ({}).", block, m_memory, endOfBlock);
+        }
+
+        if (IsSlabBlock(block))
+        {
+            FreeToSlab(static_cast<char*>(block));
+        }
+        else
+        {
+            FreeToFreeList(static_cast<char*>(block));
+        }
+    }
+
+    bool DynamicAllocator::GetSizeAlignment(void* block, u64* outSize, u16* outAlignment) const
+    {
+        if (IsSlabBlock(block))
+        {
+            const auto& info = GetSlotInfo(block);
+            *outSize         = info.size;
+            *outAlignment    = static_cast<u16>(1 << info.alignmentShift);
+            return true;
+        }
+
+        std::lock_guard getSizeAlignmentGuard(m_mutex);
+
+        // Get the size
+        const auto userDataPtr  = static_cast<char*>(block);
+        const auto sizePtr      = reinterpret_cast<u32*>(userDataPtr - sizeof(AllocSizeMarker));
+        const auto userDataSize = *sizePtr;
+
+        // Get the footer
+        const auto footer = reinterpret_cast<AllocFooter*>(userDataPtr + userDataSize);
+
+        *outSize      = userDataSize;
+        *outAlignment = footer->alignment;
+        return true;
+    }
+
+    bool DynamicAllocator::GetAlignment(void* block, u16* outAlignment) const
+    {
+        return GetAlignment(static_cast<const void*>(block), outAlignment);
+    }
+
+    bool DynamicAllocator::GetAlignment(const void* block, u16* outAlignment) const
+    {
+        if (IsSlabBlock(block))
+        {
+            *outAlignment = static_cast<u16>(1 << GetSlotInfo(block).alignmentShift);
+            return true;
+        }
+
+        std::lock_guard getAlignmentGuard(m_mutex);
+
+        // Get the size
+        const auto userDataPtr  = static_cast<const char*>(block);
+        const auto sizePtr      = reinterpret_cast<const u32*>(userDataPtr - sizeof(AllocSizeMarker));
+        const auto userDataSize = *sizePtr;
+
+        // Get the footer
+        const auto footer = reinterpret_cast<const AllocFooter*>(userDataPtr + userDataSize);
+
+        *outAlignment = footer->alignment;
+        return true;
+    }
+
+    u64 DynamicAllocator::FreeSpace() const
+    {
+        u64 freeSpace;
+        {
+            std::lock_guard freeSpaceGuard(m_mutex);
+            freeSpace = m_freeList.FreeSpace();
+        }
+
+        for (auto& sizeClass : m_sizeClasses)
+        {
+            std::lock_guard sizeClassGuard(sizeClass.mutex);
+            if (sizeClass.empty) freeSpace += SLAB_SIZE;
+        }
+        return freeSpace;
+    }
+
+    u64 DynamicAllocator::GetTotalUsableSize() const { return m_totalSize; }
+
+    void DynamicAllocator::GetFragmentationReport(FragmentationReport& outReport) const
+    {
+        std::lock_guard freeListGuard(m_mutex);
+        m_freeList.GetFragmentationReport(outReport);
+    }
+
+    void DynamicAllocator::SetSlabsEnabled(const bool enabled) { m_slabsEnabled = enabled && m_slabMap; }
+
+    bool DynamicAllocator::SetThreadCachesEnabled(const bool enabled)
+    {
+        if (enabled == m_threadCachesEnabled) return true;
+
+        if (enabled)
+        {
+#ifdef C3D_MEMORY_METRICS_POINTERS
+            // Every allocation needs to be tracked individually so we can't count them lazily per thread
+            WARN_LOG("Thread caches are not supported when C3D_MEMORY_METRICS_POINTERS is defined.");
+            return false;
+#else
+            std::lock_guard registryGuard(s_threadCacheRegistryMutex);
+
+            if (s_threadCacheIndicesInUse == (1u << MAX_THREAD_CACHED_ALLOCATORS) - 1)
+            {
+                WARN_LOG("The maximum number of allocators with thread caches: {} has been reached.", MAX_THREAD_CACHED_ALLOCATORS);
+                return false;
+            }
+
+            m_threadCacheIndex = std::countr_one(s_threadCacheIndicesInUse);
+            s_threadCacheIndicesInUse |= 1u << m_threadCacheIndex;
+            m_threadCachesEnabled = true;
+#endif
+            Metrics.SetFlushCallback(m_id, [](const void* user) { static_cast<const DynamicAllocator*>(user)->FlushMetrics(); }, this);
+            return true;
+        }
+
+        {
+            std::lock_guard registryGuard(s_threadCacheRegistryMutex);
+
+            // Detach all caches. The threads that own them will delete them once they notice
+            // NOTE: The slots in these caches are simply dropped so this is only valid if we are about to be destroyed
+            while (m_threadCaches)
+            {
+                const auto cache = m_threadCaches;
+                FlushThreadCacheMetrics(cache);
+                m_threadCaches = cache->next;
+                cache->owner.store(nullptr, std::memory_order_release);
+            }
+
+            s_threadCacheIndicesInUse &= ~(1u << m_threadCacheIndex);
+            m_threadCacheIndex    = INVALID_ID;
+            m_threadCachesEnabled = false;
+        }
+
+        // NOTE: This must happen outside of the registry lock since the MetricSystem calls FlushMetrics()
+        Metrics.SetFlushCallback(m_id, nullptr, nullptr);
+        return true;
+    }
+
+    void DynamicAllocator::FlushThreadCache() const
+    {
+        if (!m_threadCachesEnabled) return;
+
+        const auto cache = GetThreadCache();
+        for (u32 i = 0; i < SLAB_SIZE_CLASS_COUNT; ++i)
+        {
+            auto& magazine = cache->magazines[i];
+            if (magazine.count > 0)
+            {
+                PushSlots(i, magazine.slots, magazine.count);
+                magazine.count = 0;
+            }
+        }
+    }
+
+    void DynamicAllocator::FlushMetrics() const
+    {
+        std::lock_guard registryGuard(s_threadCacheRegistryMutex);
+        for (auto cache = m_threadCaches; cache; cache = cache->next)
+        {
+            FlushThreadCacheMetrics(cache);
+        }
+    }
+
+    DynamicAllocator::ThreadCache* DynamicAllocator::GetThreadCache() const
+    {
+        /** @brief The caches of the current thread (one for every allocator with thread caches enabled). */
+        struct ThreadCaches
+        {
+            ThreadCache* caches[MAX_THREAD_CACHED_ALLOCATORS] = {};
+
+            ~ThreadCaches()
+            {
+                // The thread is exiting so we give all our cached slots back
+                std::lock_guard registryGuard(s_threadCacheRegistryMutex);
+                for (const auto cache : caches)
+                {
+                    if (!cache) continue;
+
+                    if (const auto owner = cache->owner.load(std::memory_order_acquire))
+                    {
+                        owner->ReleaseThreadCache(cache);
+                    }
+                    delete cache;
+                }
+            }
+        };
+        static thread_local ThreadCaches t_threadCaches;
+
+        auto& cache = t_threadCaches.caches[m_threadCacheIndex];
+        if (cache && cache->owner.load(std::memory_order_acquire) == this) return cache;
+
+        std::lock_guard registryGuard(s_threadCacheRegistryMutex);
+
+        // If we have a cache it belongs to an allocator that was destroyed (and it has already been detached)
+        delete cache;
+
+        cache = new ThreadCache();
+        cache->owner.store(this, std::memory_order_release);
+        cache->next = m_threadCaches;
+        if (m_threadCaches) m_threadCaches->prev = cache;
+        m_threadCaches = cache;
+
+        return cache;
+    }
+
+    void DynamicAllocator::ReleaseThreadCache(ThreadCache* cache) const
+    {
+        for (u32 i = 0; i < SLAB_SIZE_CLASS_COUNT; ++i)
+        {
+            auto& magazine = cache->magazines[i];
+            if (magazine.count > 0) PushSlots(i, magazine.slots, magazine.count);
+            magazine.count = 0;
+        }
+
+        FlushThreadCacheMetrics(cache);
+
+        // Remove the cache from our list
+        if (cache->prev)
+        {
+            cache->prev->next = cache->next;
+        }
+        else
+        {
+            m_threadCaches = cache->next;
+        }
+
+        if (cache->next) cache->next->prev = cache->prev;
+
+        cache->owner.store(nullptr, std::memory_order_release);
+    }
+
+    void DynamicAllocator::FlushThreadCacheMetrics(ThreadCache* cache) const
+    {
+#ifdef C3D_MEMORY_METRICS
+        for (u8 type = 0; type < MAX_MEMORY_TYPES; ++type)
+        {
+            auto& pending = cache->pendingMetrics[type];
+            const auto count     = pending.count.exchange(0, std::memory_order_relaxed);
+            const auto requested = pending.requested.exchange(0, std::memory_order_relaxed);
+            const auto required  = pending.required.exchange(0, std::memory_order_relaxed);
+            if (count == 0 && requested == 0 && required == 0) continue;
+
+            std::lock_guard metricsGuard(m_metricsMutex);
+            Metrics.AllocateBatch(m_id, static_cast<MemoryType>(type), count, requested, required);
+        }
+#endif
+    }
+
+    void* DynamicAllocator::AllocateFromFreeList(const MemoryType type, const u64 size, const u16 alignment) const
+    {
         /* NOTE: Our total required size for an allocation is made up of the following:
          *  - The user's requested size
          *	- The alignment required for the requested size
@@ -73,7 +439,13 @@ namespace C3D
         assert(requiredSize < MAX_SINGLE_ALLOC_SIZE);
 
         u64 baseOffset = 0;
-        if (m_freeList.AllocateBlock(requiredSize, &baseOffset))
+        bool allocated;
+        {
+            std::lock_guard allocGuard(m_mutex);
+            allocated = m_freeList.TryAllocateBlock(requiredSize, &baseOffset);
+        }
+
+        if (allocated)
         {
             /*
              * Our memory layout is as follows:
@@ -107,118 +479,308 @@ namespace C3D
                   sizeof(AllocFooter), ALLOC_SIZE_MARKER_SIZE, requiredSize, basePtr);
 #endif
 
-            MetricsAllocate(m_id, type, size, requiredSize, userDataPtr);
+            TrackAllocation(type, size, requiredSize, userDataPtr);
 
             std::memset(userDataPtr, 0, size);
             return userDataPtr;
         }
 
-        const auto available = m_freeList.FreeSpace();
+        const auto available = FreeSpace();
         ERROR_LOG("No blocks of memory large enough to allocate from.");
         ERROR_LOG("Requested size: {}, total space available: {}.", size, available);
 
         throw std::bad_alloc();
     }
 
-    void DynamicAllocator::Free(void* block) const
+    void DynamicAllocator::FreeToFreeList(char* userDataPtr) const
     {
-        std::lock_guard freeGuard(m_mutex);
-
-        if (!block)
-        {
-            FATAL_LOG("Called with nullptr block.");
-        }
-
-        if (m_memory == nullptr || m_totalSize == 0)
-        {
-            // Tried to free something from this allocator while it is not managing any memory
-            FATAL_LOG("Called while dynamic allocator is not managing memory.");
-        }
-
-        if (block < m_memory || block > m_memory + m_totalSize)
-        {
-            void* endOfBlock = m_memory + m_totalSize;
-            FATAL_LOG("Called with block ({}) outside of allocator range ({}) - ({}).", block, m_memory, endOfBlock);
-        }
-
-        // The provided address points to the user's data block
-        const auto userDataPtr = static_cast<char*>(block);
         // If we subtract the size of our ALLOC_SIZE_MARKER we get our size
-        const auto blockSize = reinterpret_cast<u32*>(userDataPtr - sizeof(AllocSizeMarker));
+        const auto blockSize = *reinterpret_cast<u32*>(userDataPtr - sizeof(AllocSizeMarker));
         // If we add the size of the user's data to our user data block ptr we get our alloc footer
-        const auto footer = reinterpret_cast<AllocFooter*>(userDataPtr + *blockSize);
+        const auto footer = reinterpret_cast<AllocFooter*>(userDataPtr + blockSize);
         // We can figure out the memory type that was associated with this allocation
         const auto memoryType = footer->type;
         // We can now calculate the total size of our entire data combined
-        const u64 requiredSize = footer->alignment + sizeof(AllocSizeMarker) + *blockSize + sizeof(AllocFooter);
+        const u64 requiredSize = footer->alignment + sizeof(AllocSizeMarker) + blockSize + sizeof(AllocFooter);
         // From our header we can find the pointer to the start of our current block and subtract the start of our
         // managed memory block we get an offset into our managed block of memory
         const u64 offset = static_cast<char*>(footer->start) - m_memory;
-        // Then we simply free this memory
-        if (!m_freeList.FreeBlock(requiredSize, offset))
-        {
-            ERROR_LOG("Failed to free block in Freelist.");
-        }
 
 #ifdef C3D_TRACE_ALLOCS
         TRACE("Freed {} bytes at {}.", requiredSize, footer->start);
 #endif
 
-        MetricsFree(m_id, memoryType, *blockSize, requiredSize, userDataPtr);
+        {
+            std::lock_guard freeGuard(m_mutex);
+            // Then we simply free this memory
+            if (!m_freeList.FreeBlock(requiredSize, offset))
+            {
+                ERROR_LOG("Failed to free block in Freelist.");
+            }
+        }
+
+        TrackFree(memoryType, blockSize, requiredSize, userDataPtr);
     }
 
-    bool DynamicAllocator::GetSizeAlignment(void* block, u64* outSize, u16* outAlignment) const
+    void* DynamicAllocator::AllocateFromSlab(const MemoryType type, const u64 size, const u16 alignment) const
     {
-        std::lock_guard getSizeAlignmentGuard(m_mutex);
+        // Our slots are aligned to their size so we pick a size class that satisfies both the size and alignment
+        const auto sizeClassIndex = GetSizeClassIndex(std::max<u64>(size, alignment));
+        const auto& sizeClass     = m_sizeClasses[sizeClassIndex];
 
-        // Get the size
-        const auto userDataPtr  = static_cast<char*>(block);
-        const auto sizePtr      = reinterpret_cast<u32*>(userDataPtr - sizeof(AllocSizeMarker));
-        const auto userDataSize = *sizePtr;
+        void* block;
+        if (m_threadCachesEnabled)
+        {
+            const auto cache = GetThreadCache();
+            auto& magazine   = cache->magazines[sizeClassIndex];
+            if (magazine.count == 0)
+            {
+                // Our cache is empty so we refill half of it in a single batch
+                const auto count = std::max(sizeClass.cacheCapacity / 2, 1u);
+                magazine.count   = PopSlots(sizeClassIndex, magazine.slots, count);
+                if (magazine.count == 0)
+                {
+                    ERROR_LOG("No slots available for an allocation of size: {}.", size);
+                    throw std::bad_alloc();
+                }
+            }
+            block = magazine.slots[--magazine.count];
+
+            cache->Track(type, 1, static_cast<i64>(size), sizeClass.slotSize);
+        }
+        else
+        {
+            if (PopSlots(sizeClassIndex, &block, 1) == 0)
+            {
+                ERROR_LOG("No slots available for an allocation of size: {}.", size);
+                throw std::bad_alloc();
+            }
+            TrackAllocation(type, size, sizeClass.slotSize, block);
+        }
 
-        // Get the footer
-        const auto footer = reinterpret_cast<AllocFooter*>(userDataPtr + userDataSize);
+        // NOTE: The slot is ours now so we don't need a lock to store it's info
+        auto& info          = GetSlotInfo(block);
+        info.size           = static_cast<u16>(size);
+        info.type           = type;
+        info.alignmentShift = static_cast<u8>(std::countr_zero(alignment));
 
-        *outSize      = userDataSize;
-        *outAlignment = footer->alignment;
-        return true;
+        std::memset(block, 0, size);
+        return block;
     }
 
-    bool DynamicAllocator::GetAlignment(void* block, u16* outAlignment) const
+    void DynamicAllocator::FreeToSlab(char* userDataPtr) const
     {
-        std::lock_guard getAlignmentGuard(m_mutex);
+        const auto sizeClassIndex = GetSlabHeader(userDataPtr)->sizeClass;
+        const auto& sizeClass     = m_sizeClasses[sizeClassIndex];
+        // Copy the info since the slot can be reused as soon as we have put it back
+        const auto info = GetSlotInfo(userDataPtr);
 
-        // Get the size
-        const auto userDataPtr  = static_cast<char*>(block);
-        const auto sizePtr      = reinterpret_cast<u32*>(userDataPtr - sizeof(AllocSizeMarker));
-        const auto userDataSize = *sizePtr;
+        if (m_threadCachesEnabled)
+        {
+            // The slot goes into the cache of the calling thread (which does not have to be the thread that allocated it)
+            const auto cache = GetThreadCache();
+            auto& magazine   = cache->magazines[sizeClassIndex];
+            if (magazine.count == sizeClass.cacheCapacity)
+            {
+                // Our cache is full so we give the oldest half back to the slabs in a single batch
+                const auto count = std::max(sizeClass.cacheCapacity / 2, 1u);
+                PushSlots(sizeClassIndex, magazine.slots, count);
+                std::memmove(magazine.slots, magazine.slots + count, (magazine.count - count) * sizeof(void*));
+                magazine.count -= count;
+            }
+            magazine.slots[magazine.count++] = userDataPtr;
+
+            cache->Track(info.type, -1, -static_cast<i64>(info.size), -static_cast<i64>(sizeClass.slotSize));
+        }
+        else
+        {
+            PushSlots(sizeClassIndex, reinterpret_cast<void* const*>(&userDataPtr), 1);
+            TrackFree(info.type, info.size, sizeClass.slotSize, userDataPtr);
+        }
+    }
 
-        // Get the footer
-        const auto footer = reinterpret_cast<AllocFooter*>(userDataPtr + userDataSize);
+    u32 DynamicAllocator::PopSlots(const u32 sizeClassIndex, void** outBlocks, const u32 count) const
+    {
+        auto& sizeClass = m_sizeClasses[sizeClassIndex];
 
-        *outAlignment = footer->alignment;
-        return true;
+        std::lock_guard sizeClassGuard(sizeClass.mutex);
+
+        for (u32 i = 0; i < count; ++i)
+        {
+            auto slab = sizeClass.partial;
+            if (!slab)
+            {
+                // We have no slabs with free slots left so we use our empty slab or create a new one
+                if (sizeClass.empty)
+                {
+                    slab            = sizeClass.empty;
+                    sizeClass.empty = nullptr;
+                }
+                else
+                {
+                    slab = CreateSlab(sizeClassIndex);
+                    // We are out of memory so we return the slots we managed to get
+                    if (!slab) return i;
+                }
+                sizeClass.partial = slab;
+            }
+
+            if (slab->freeSlots)
+            {
+                // Reuse a previously freed slot
+                outBlocks[i]    = slab->freeSlots;
+                slab->freeSlots = *static_cast<void**>(slab->freeSlots);
+            }
+            else
+            {
+                // Take the next slot that was never used before
+                outBlocks[i] = GetSlabBase(slab) + static_cast<u64>(slab->bumpIndex++) * sizeClass.slotSize;
+            }
+
+            slab->used++;
+            if (slab->used == sizeClass.capacity)
+            {
+                // The slab is full so we remove it from the list of slabs with free slots (we always allocate from the head)
+                sizeClass.partial = slab->next;
+                if (sizeClass.partial) sizeClass.partial->prev = nullptr;
+                slab->next = nullptr;
+            }
+        }
+
+        return count;
     }
 
-    bool DynamicAllocator::GetAlignment(const void* block, u16* outAlignment) const
+    void DynamicAllocator::PushSlots(const u32 sizeClassIndex, void* const* blocks, const u32 count) const
     {
-        std::lock_guard getAlignmentGuard(m_mutex);
+        auto& sizeClass = m_sizeClasses[sizeClassIndex];
 
-        // Get the size
-        const auto userDataPtr  = static_cast<const char*>(block);
-        const auto sizePtr      = reinterpret_cast<const u32*>(userDataPtr - sizeof(AllocSizeMarker));
-        const auto userDataSize = *sizePtr;
+        std::lock_guard sizeClassGuard(sizeClass.mutex);
 
-        // Get the footer
-        const auto footer = reinterpret_cast<const AllocFooter*>(userDataPtr + userDataSize);
+        for (u32 i = 0; i < count; ++i)
+        {
+            const auto block = blocks[i];
+            const auto slab  = GetSlabHeader(block);
+
+            // Push the slot onto the slab's list of free slots
+            *static_cast<void**>(block) = slab->freeSlots;
+            slab->freeSlots             = block;
+
+            if (slab->used == sizeClass.capacity)
+            {
+                // The slab was full so it was not in our list of slabs with free slots yet
+                slab->prev = nullptr;
+                slab->next = sizeClass.partial;
+                if (sizeClass.partial) sizeClass.partial->prev = slab;
+                sizeClass.partial = slab;
+            }
+
+            slab->used--;
+            if (slab->used == 0)
+            {
+                // The slab is empty so we remove it from our list
+                if (slab->prev)
+                {
+                    slab->prev->next = slab->next;
+                }
+                else
+                {
+                    sizeClass.partial = slab->next;
+                }
+
+                if (slab->next) slab->next->prev = slab->prev;
+
+                slab->prev      = nullptr;
+                slab->next      = nullptr;
+                slab->freeSlots = nullptr;
+                slab->bumpIndex = 0;
+
+                // We keep a single empty slab around and give the memory of the others back to our FreeList
+                if (sizeClass.empty)
+                {
+                    DestroySlab(slab);
+                }
+                else
+                {
+                    sizeClass.empty = slab;
+                }
+            }
+        }
+    }
 
-        *outAlignment = footer->alignment;
-        return true;
+    SlabHeader* DynamicAllocator::CreateSlab(const u32 sizeClass) const
+    {
+        std::lock_guard allocGuard(m_mutex);
+
+        // Allocate twice the size of a slab so we are guaranteed to find a slab that is aligned to SLAB_SIZE inside of it
+        u64 offset = 0;
+        if (!m_freeList.TryAllocateBlock(SLAB_SIZE * 2, &offset))
+        {
+            ERROR_LOG("Failed to reserve memory for a new slab of size class: {}.", sizeClass);
+            return nullptr;
+        }
+
+        const auto start   = reinterpret_cast<u64>(m_memory) + offset;
+        const auto aligned = GetAligned(start, SLAB_SIZE);
+        const auto head    = aligned - start;
+        const auto tail    = SLAB_SIZE - head;
+
+        // Give back the memory before and after our slab
+        if (head > 0) m_freeList.FreeBlock(head, offset);
+        if (tail > 0) m_freeList.FreeBlock(tail, offset + head + SLAB_SIZE);
+
+        m_slabMap[(aligned - m_slabMapBase) / SLAB_SIZE] = static_cast<u8>(sizeClass + 1);
+
+        const auto slab = new (reinterpret_cast<void*>(aligned + SLAB_SIZE - sizeof(SlabHeader))) SlabHeader();
+        slab->sizeClass = static_cast<u8>(sizeClass);
+        return slab;
     }
 
-    u64 DynamicAllocator::FreeSpace() const { return m_freeList.FreeSpace(); }
+    void DynamicAllocator::DestroySlab(SlabHeader* slab) const
+    {
+        const auto base = GetSlabBase(slab);
 
-    u64 DynamicAllocator::GetTotalUsableSize() const { return m_totalSize; }
+        std::lock_guard freeGuard(m_mutex);
+        m_slabMap[(reinterpret_cast<u64>(base) - m_slabMapBase) / SLAB_SIZE] = 0;
+        m_freeList.FreeBlock(SLAB_SIZE, base - m_memory);
+    }
+
+    bool DynamicAllocator::IsSlabBlock(const void* block) const
+    {
+        if (!m_slabMap) return false;
+
+        const auto address = reinterpret_cast<u64>(block);
+        if (address < reinterpret_cast<u64>(m_memory) || address >= reinterpret_cast<u64>(m_memory) + m_memorySize) return false;
+
+        // NOTE: The entry for the region of a live block can't change so we don't need a lock here
+        return m_slabMap[(address - m_slabMapBase) / SLAB_SIZE] != 0;
+    }
+
+    SlabSlotInfo& DynamicAllocator::GetSlotInfo(const void* block) const
+    {
+        const auto slab       = GetSlabHeader(block);
+        const auto& sizeClass = m_sizeClasses[slab->sizeClass];
+        const auto index      = static_cast<u64>(static_cast<const char*>(block) - GetSlabBase(block)) / sizeClass.slotSize;
+
+        // The slot infos are stored right in front of the slab header
+        const auto infos = reinterpret_cast<SlabSlotInfo*>(slab) - sizeClass.capacity;
+        return infos[index];
+    }
+
+    void DynamicAllocator::TrackAllocation(const MemoryType type, const u64 requestedSize, const u64 requiredSize, void* block) const
+    {
+#ifdef C3D_MEMORY_METRICS
+        std::lock_guard metricsGuard(m_metricsMutex);
+        MetricsAllocate(m_id, type, requestedSize, requiredSize, block);
+#endif
+    }
+
+    void DynamicAllocator::TrackFree(const MemoryType type, const u64 requestedSize, const u64 requiredSize, void* block) const
+    {
+#ifdef C3D_MEMORY_METRICS
+        std::lock_guard metricsGuard(m_metricsMutex);
+        MetricsFree(m_id, type, requestedSize, requiredSize, block);
+#endif
+    }
 
     DynamicAllocator* DynamicAllocator::GetDefault()
     {
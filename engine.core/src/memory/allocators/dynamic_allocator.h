@@ -1,5 +1,8 @@
 
 #pragma once
+#include <bit>
+#include <mutex>
+
 #include "base_allocator.h"
 #include "defines.h"
 #include "logger/logger.h"
@@ -25,6 +28,48 @@ namespace C3D
     constexpr auto MAX_SINGLE_ALLOC_SIZE        = GibiBytes(4);
     constexpr auto SMALLEST_POSSIBLE_ALLOCATION = sizeof(AllocFooter) + sizeof(AllocSizeMarker) + 1 + 1;
 
+    /** @brief The size of a single slab. Slabs are always aligned to their size so we can find the slab of any block in O(1). */
+    constexpr u64 SLAB_SIZE = KibiBytes(32);
+    /** @brief The smallest and largest size class that is served from slabs. Larger allocations go through the FreeList. */
+    constexpr u64 SLAB_MIN_SIZE_CLASS = 16;
+    constexpr u64 SLAB_MAX_SIZE_CLASS = KibiBytes(4);
+    /** @brief The number of (power of two) size classes between SLAB_MIN_SIZE_CLASS and SLAB_MAX_SIZE_CLASS. */
+    constexpr u64 SLAB_SIZE_CLASS_COUNT = 9;
+    /** @brief Allocators that manage less memory than this don't use slabs since the slabs would take up too much of their memory. */
+    constexpr u64 SLAB_MIN_ALLOCATOR_SIZE = SLAB_SIZE * 16;
+
+    /** @brief The maximum number of DynamicAllocators that can have thread caches enabled at the same time. */
+    constexpr u32 MAX_THREAD_CACHED_ALLOCATORS = 8;
+    /** @brief The maximum number of free slots (and bytes) that a single thread caches per size class. */
+    constexpr u32 THREAD_CACHE_MAX_SLOTS = 64;
+    constexpr u64 THREAD_CACHE_MAX_BYTES = KibiBytes(16);
+
+    /** @brief Information about a single slot in a slab. Stored in an array at the end of the slab. */
+    struct SlabSlotInfo
+    {
+        /** @brief The size that the user requested. */
+        u16 size = 0;
+        /** @brief The memory type of the user's memory. (used to keep track of where allocations are coming from) */
+        MemoryType type = MemoryType::Unknown;
+        /** @brief The requested alignment stored as a power of two. */
+        u8 alignmentShift = 0;
+    };
+
+    /** @brief The header of a slab. Stored at the very end of the slab (after the slot infos) so the slots stay aligned. */
+    struct SlabHeader
+    {
+        /** @brief The previous and next slab in the size class's list of slabs with free slots. */
+        SlabHeader* prev = nullptr;
+        SlabHeader* next = nullptr;
+        /** @brief A singly-linked list of freed slots (the pointer to the next free slot is stored in the slot itself). */
+        void* freeSlots = nullptr;
+        /** @brief The number of slots that are in use. */
+        u32 used = 0;
+        /** @brief The index of the first slot that was never handed out. */
+        u32 bumpIndex = 0;
+        u8 sizeClass = 0;
+    };
+
     class C3D_API DynamicAllocator final : public BaseAllocator<DynamicAllocator>
     {
     public:
@@ -49,14 +94,105 @@ namespace C3D
         bool GetAlignment(void* block, u16* outAlignment) const override;
         bool GetAlignment(const void* block, u16* outAlignment) const override;
 
+        /** @brief Gets the amount of free memory. Memory in slabs that are fully empty (and cached for reuse) is counted as free. */
         [[nodiscard]] u64 FreeSpace() const;
         [[nodiscard]] u64 GetTotalUsableSize() const;
 
+        /** @brief Fills out a report about the fragmentation of the free memory in our FreeList (memory in slabs is not included). */
+        void GetFragmentationReport(FragmentationReport& outReport) const;
+
+        /** @brief Enables or disables the size-class slabs for allocations up to SLAB_MAX_SIZE_CLASS.
+         * Must be called before the first allocation is made. Slabs are enabled by default for all but very small allocators. */
+        void SetSlabsEnabled(bool enabled);
+        [[nodiscard]] bool AreSlabsEnabled() const { return m_slabsEnabled; }
+
+        /**
+         * @brief Enables or disables per-thread caches of free slots in front of the slabs.
+         * With caches enabled a thread allocates and frees small blocks from it's own cache without taking any locks.
+         * Slots are moved between the cache and the slabs in batches. Blocks can be freed by any thread (the slot simply
+         * ends up in the cache of the freeing thread). Must be called before the first allocation is made.
+         *
+         * @return True if successful, false if too many allocators already have thread caches enabled
+         */
+        bool SetThreadCachesEnabled(bool enabled);
+        [[nodiscard]] bool AreThreadCachesEnabled() const { return m_threadCachesEnabled; }
+
+        /** @brief Returns all slots that are cached by the calling thread back to the slabs. */
+        void FlushThreadCache() const;
+
+        /** @brief Adds the allocations that were counted by the thread caches to the MetricSystem.
+         * This is called automatically by the MetricSystem before it reads the stats of this allocator. */
+        void FlushMetrics() const;
+
         static constexpr u64 GetMemoryRequirements(u64 usableSize);
 
         static DynamicAllocator* GetDefault();
 
     private:
+        /** @brief A size class with the list of slabs that still have free slots. Every size class has it's own lock so
+         * allocations of different sizes never wait on eachother. */
+        struct SizeClass
+        {
+            std::mutex mutex;
+            /** @brief The slabs that have at least one free slot. */
+            SlabHeader* partial = nullptr;
+            /** @brief A single fully empty slab that we keep around to prevent creating and destroying slabs over and over. */
+            SlabHeader* empty = nullptr;
+            u32 slotSize      = 0;
+            u32 capacity      = 0;
+            /** @brief The number of slots that a thread cache can hold for this size class. */
+            u32 cacheCapacity = 0;
+        };
+
+        /** @brief A cache of free slots (for every size class) for a single thread. Defined in dynamic_allocator.cpp. */
+        struct ThreadCache;
+
+        static constexpr u64 GetSlabMapSize(u64 usableSize);
+        static constexpr u32 GetSizeClassIndex(u64 size);
+
+        void* AllocateFromFreeList(MemoryType type, u64 size, u16 alignment) const;
+        void FreeToFreeList(char* userDataPtr) const;
+
+        void* AllocateFromSlab(MemoryType type, u64 size, u16 alignment) const;
+        void FreeToSlab(char* userDataPtr) const;
+
+        /** @brief Takes count free slots from the slabs of the provided size class (creating new slabs if required).
+         * Returns the number of slots that were taken, which is less than count if we ran out of memory for new slabs. */
+        u32 PopSlots(u32 sizeClassIndex, void** outBlocks, u32 count) const;
+        /** @brief Gives count slots back to the slabs of the provided size class. */
+        void PushSlots(u32 sizeClassIndex, void* const* blocks, u32 count) const;
+
+        /** @brief Gets the cache of the calling thread (creating it if the thread has none yet). */
+        ThreadCache* GetThreadCache() const;
+        /** @brief Flushes the provided cache and detaches it from this allocator. Caller must hold the thread cache registry lock. */
+        void ReleaseThreadCache(ThreadCache* cache) const;
+        /** @brief Adds the pending metrics of the provided cache to the MetricSystem. Caller must hold the thread cache registry lock. */
+        void FlushThreadCacheMetrics(ThreadCache* cache) const;
+
+        /** @brief Creates a new slab (aligned to SLAB_SIZE) from our FreeList. */
+        SlabHeader* CreateSlab(u32 sizeClass) const;
+        /** @brief Returns the memory of the provided slab to our FreeList. */
+        void DestroySlab(SlabHeader* slab) const;
+
+        /** @brief Checks if the provided block was allocated from one of our slabs. */
+        [[nodiscard]] bool IsSlabBlock(const void* block) const;
+
+        [[nodiscard]] static char* GetSlabBase(const void* block)
+        {
+            return reinterpret_cast<char*>(reinterpret_cast<u64>(block) & ~(SLAB_SIZE - 1));
+        }
+
+        [[nodiscard]] static SlabHeader* GetSlabHeader(const void* block)
+        {
+            return reinterpret_cast<SlabHeader*>(GetSlabBase(block) + SLAB_SIZE - sizeof(SlabHeader));
+        }
+
+        [[nodiscard]] SlabSlotInfo& GetSlotInfo(const void* block) const;
+
+        /** @brief Keeps the MetricSystem up-to-date. Updates are serialized since the MetricSystem is not thread-safe. */
+        void TrackAllocation(MemoryType type, u64 requestedSize, u64 requiredSize, void* block) const;
+        void TrackFree(MemoryType type, u64 requestedSize, u64 requiredSize, void* block) const;
+
         bool m_initialized = false;
         // The total size including our freelist
         u64 m_totalSize = 0;
@@ -68,10 +204,43 @@ namespace C3D
         char* m_memory = nullptr;
         // A mutex to ensure allocations happen in a thread-safe manor
         mutable std::mutex m_mutex;
+
+        /** @brief Our size classes (16, 32, 64 ... 4096 bytes). */
+        mutable SizeClass m_sizeClasses[SLAB_SIZE_CLASS_COUNT];
+        /** @brief For every SLAB_SIZE region of our memory the (size class + 1) of the slab in it or 0 if the region is not a slab. */
+        u8* m_slabMap = nullptr;
+        /** @brief The address of the start of the first region in our slab map. */
+        u64 m_slabMapBase   = 0;
+        u64 m_slabMapSize   = 0;
+        bool m_slabsEnabled = false;
+
+        /** @brief All the thread caches that belong to this allocator (protected by a global registry lock). */
+        mutable ThreadCache* m_threadCaches = nullptr;
+        /** @brief The index into every thread's array of caches that belongs to this allocator. */
+        u32 m_threadCacheIndex     = INVALID_ID;
+        bool m_threadCachesEnabled = false;
+
+#ifdef C3D_MEMORY_METRICS
+        // The MetricSystem is not thread-safe so we need to serialize updates to it from the different size classes
+        mutable std::mutex m_metricsMutex;
+#endif
     };
 
+    constexpr u64 DynamicAllocator::GetSlabMapSize(const u64 usableSize)
+    {
+        // One entry per region plus one extra since our memory does not have to start at a region boundary
+        return usableSize / SLAB_SIZE + 2;
+    }
+
+    constexpr u32 DynamicAllocator::GetSizeClassIndex(const u64 size)
+    {
+        if (size <= SLAB_MIN_SIZE_CLASS) return 0;
+        // Round up to the next power of two and subtract the power of our smallest size class (16 = 2^4)
+        return static_cast<u32>(std::bit_width(size - 1)) - 4;
+    }
+
     constexpr u64 DynamicAllocator::GetMemoryRequirements(const u64 usableSize)
     {
-        return FreeList::GetMemoryRequirement(usableSize, SMALLEST_POSSIBLE_ALLOCATION) + usableSize;
+        return FreeList::GetMemoryRequirement(usableSize, SMALLEST_POSSIBLE_ALLOCATION) + GetSlabMapSize(usableSize) + usableSize;
     }
 }  // namespace C3D
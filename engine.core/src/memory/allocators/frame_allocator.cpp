@@ -0,0 +1,244 @@
+#include "frame_allocator.h"
+
+#include <algorithm>
+
+#include "logger/logger.h"
+#include "memory/global_memory_system.h"
+#include "metrics/metrics.h"
+
+namespace C3D
+{
+    /** @brief The next thread slot that will be handed out. Slots are never reused so a thread keeps it's slot for it's lifetime. */
+    static std::atomic<u32> s_nextThreadSlot = 0;
+    /** @brief The slot of the calling thread. Assigned the first time the thread allocates from a FrameAllocator. */
+    static thread_local u32 t_threadSlot = INVALID_ID;
+
+    FrameAllocator::FrameAllocator() : BaseAllocator(ToUnderlying(AllocatorType::Linear)) {}
+
+    bool FrameAllocator::Create(const char* name, const u64 frameSize, const u32 frameCount)
+    {
+        if (frameSize < FRAME_ALLOCATOR_THREAD_REGION_SIZE)
+        {
+            ERROR_LOG("FrameSize: {} must be at least: {}.", frameSize, FRAME_ALLOCATOR_THREAD_REGION_SIZE);
+            return false;
+        }
+
+        if (frameCount == 0 || frameCount > FRAME_ALLOCATOR_MAX_FRAMES)
+        {
+            ERROR_LOG("FrameCount: {} must be in the range [1, {}].", frameCount, FRAME_ALLOCATOR_MAX_FRAMES);
+            return false;
+        }
+
+        m_frameSize     = frameSize;
+        m_frameCount    = frameCount;
+        m_frameIndex    = 0;
+        m_highWaterMark = 0;
+        m_offset.store(0, std::memory_order_relaxed);
+
+        // NOTE: We don't clear our memory here since AllocateBlock() clears every block it hands out anyway
+        m_memoryBlock = static_cast<char*>(Memory.AllocateBlock(MemoryType::LinearAllocator, m_frameSize * m_frameCount, 64));
+
+        // We add one extra region which is shared by all threads that don't have a slot
+        constexpr auto regionCount = FRAME_ALLOCATOR_MAX_THREADS + 1;
+
+        auto regions    = Memory.AllocateBlock(MemoryType::LinearAllocator, sizeof(ThreadRegion) * regionCount, alignof(ThreadRegion));
+        m_threadRegions = static_cast<ThreadRegion*>(regions);
+        std::uninitialized_default_construct_n(m_threadRegions, regionCount);
+
+        // Create an metrics object to track the allocations this frame allocator is doing
+        m_id = Metrics.CreateAllocator(name, AllocatorType::Linear, m_frameSize * m_frameCount);
+        return true;
+    }
+
+    void FrameAllocator::Destroy()
+    {
+        INFO_LOG("Destroying.");
+
+        if (m_memoryBlock)
+        {
+            Memory.Free(m_memoryBlock);
+            Memory.Free(m_threadRegions);
+
+            // Destroy the metrics object associated with this allocator
+            Metrics.DestroyAllocator(m_id, false);
+        }
+
+        m_memoryBlock   = nullptr;
+        m_threadRegions = nullptr;
+        m_frameSize     = 0;
+        m_frameCount    = 0;
+    }
+
+    void* FrameAllocator::AllocateBlock(const MemoryType type, const u64 size, const u16 alignment) const
+    {
+        if (!m_memoryBlock)
+        {
+            ERROR_LOG("Not initialized.");
+            return nullptr;
+        }
+
+        const auto slot = GetThreadSlot();
+        if (slot != INVALID_ID)
+        {
+            // Fast path: only the calling thread ever touches this region during a frame
+            return AllocateFromRegion(m_threadRegions[slot], type, size, alignment);
+        }
+
+        // Threads without a slot share a single region
+        std::lock_guard sharedRegionGuard(m_sharedRegionMutex);
+        return AllocateFromRegion(m_threadRegions[FRAME_ALLOCATOR_MAX_THREADS], type, size, alignment);
+    }
+
+    void FrameAllocator::Free(void* block) const {}
+
+    void FrameAllocator::BeginFrame()
+    {
+        // Keep track of the most memory we have ever needed for a single frame
+        m_highWaterMark = std::max(m_highWaterMark, GetAllocated());
+
+#ifdef C3D_MEMORY_METRICS
+        // Our metrics show the allocations of the frame that just ended
+        Metrics.FreeAll(m_id);
+#endif
+
+        for (u32 slot = 0; slot <= FRAME_ALLOCATOR_MAX_THREADS; ++slot)
+        {
+            auto& region = m_threadRegions[slot];
+            if (region.allocated > region.highWaterMark)
+            {
+                region.highWaterMark = region.allocated;
+                if (slot < FRAME_ALLOCATOR_MAX_THREADS) Metrics.SetThreadHighWaterMark(m_id, slot, region.highWaterMark);
+            }
+
+#ifdef C3D_MEMORY_METRICS
+            if (region.allocated > 0)
+            {
+                for (u32 type = 0; type < MAX_MEMORY_TYPES; ++type)
+                {
+                    if (region.counts[type] == 0) continue;
+
+                    const auto size = static_cast<i64>(region.sizes[type]);
+                    Metrics.AllocateBatch(m_id, static_cast<MemoryType>(type), region.counts[type], size, size);
+                    region.counts[type] = 0;
+                    region.sizes[type]  = 0;
+                }
+            }
+#endif
+
+            // The region pointed into the previous frame so threads need to take a new one from the next frame
+            region.current   = nullptr;
+            region.end       = nullptr;
+            region.allocated = 0;
+        }
+
+        m_frameIndex = (m_frameIndex + 1) % m_frameCount;
+        m_offset.store(0, std::memory_order_relaxed);
+    }
+
+    void FrameAllocator::FreeAll()
+    {
+        if (!m_memoryBlock) return;
+
+        for (u32 slot = 0; slot <= FRAME_ALLOCATOR_MAX_THREADS; ++slot)
+        {
+            // NOTE: We keep the high-water marks since they track the usage over the lifetime of this allocator
+            const auto highWaterMark = m_threadRegions[slot].highWaterMark;
+            m_threadRegions[slot]    = ThreadRegion();
+
+            m_threadRegions[slot].highWaterMark = highWaterMark;
+        }
+
+        m_frameIndex = 0;
+        m_offset.store(0, std::memory_order_relaxed);
+
+        // Ensure that the metrics keep track of the fact that we just freed all memory for this allocator
+        Metrics.FreeAll(m_id);
+    }
+
+    u64 FrameAllocator::GetThreadHighWaterMark(const u32 threadSlot) const
+    {
+        if (threadSlot >= FRAME_ALLOCATOR_MAX_THREADS) return 0;
+
+        // Include the frame that is currently in progress
+        const auto& region = m_threadRegions[threadSlot];
+        return std::max(region.highWaterMark, region.allocated);
+    }
+
+    u32 FrameAllocator::GetThreadSlot()
+    {
+        if (t_threadSlot == INVALID_ID)
+        {
+            const auto slot = s_nextThreadSlot.fetch_add(1, std::memory_order_relaxed);
+            if (slot >= FRAME_ALLOCATOR_MAX_THREADS)
+            {
+                // All slots are taken so this thread will have to use the shared region. We still store the slot so we don't keep
+                // incrementing our counter (which could eventually wrap around)
+                t_threadSlot = FRAME_ALLOCATOR_MAX_THREADS;
+                return INVALID_ID;
+            }
+            t_threadSlot = slot;
+        }
+        return t_threadSlot < FRAME_ALLOCATOR_MAX_THREADS ? t_threadSlot : INVALID_ID;
+    }
+
+    FrameAllocator* FrameAllocator::GetDefault()
+    {
+        static auto allocator = new FrameAllocator();
+        return allocator;
+    }
+
+    void* FrameAllocator::AllocateFromRegion(ThreadRegion& region, const MemoryType type, const u64 size, const u16 alignment) const
+    {
+        char* block = nullptr;
+
+        if (size <= FRAME_ALLOCATOR_MAX_REGION_ALLOCATION)
+        {
+            block = reinterpret_cast<char*>(GetAligned(reinterpret_cast<u64>(region.current), alignment));
+            if (!region.current || block + size > region.end)
+            {
+                // Our region is exhausted so we take a new one from the current frame (the remainder of the old region is wasted)
+                region.current = AllocateShared(FRAME_ALLOCATOR_THREAD_REGION_SIZE, 64);
+                region.end     = region.current ? region.current + FRAME_ALLOCATOR_THREAD_REGION_SIZE : nullptr;
+                block          = reinterpret_cast<char*>(GetAligned(reinterpret_cast<u64>(region.current), alignment));
+            }
+
+            if (region.current) region.current = block + size;
+        }
+
+        if (!block)
+        {
+            // The allocation is too large for a region (or there is no room left for a full region) so we take it from the frame directly
+            block = AllocateShared(size, alignment);
+            if (!block)
+            {
+                ERROR_LOG("Failed to allocate: {} bytes. The frame has run out of memory.", size);
+                throw std::bad_alloc();
+            }
+        }
+
+        region.allocated += size;
+#ifdef C3D_MEMORY_METRICS
+        region.counts[ToUnderlying(type)]++;
+        region.sizes[ToUnderlying(type)] += size;
+#endif
+
+        std::memset(block, 0, size);
+        return block;
+    }
+
+    char* FrameAllocator::AllocateShared(const u64 size, const u16 alignment) const
+    {
+        // Reserve enough space to be able to align the block inside of it
+        const u64 reserved = size + alignment - 1;
+
+        // NOTE: We use a compare-exchange instead of a fetch_add so a request that does not fit does not use up the rest of the frame
+        u64 offset = m_offset.load(std::memory_order_relaxed);
+        do
+        {
+            if (offset + reserved > m_frameSize) return nullptr;
+        } while (!m_offset.compare_exchange_weak(offset, offset + reserved, std::memory_order_relaxed));
+
+        const auto frame = m_memoryBlock + m_frameSize * m_frameIndex;
+        return reinterpret_cast<char*>(GetAligned(reinterpret_cast<u64>(frame + offset), alignment));
+    }
+}  // namespace C3D
@@ -0,0 +1,112 @@
+#pragma once
+#include <atomic>
+#include <mutex>
+
+#include "base_allocator.h"
+#include "defines.h"
+
+namespace C3D
+{
+    /** @brief The maximum number of frames that a FrameAllocator can keep alive at the same time. */
+    constexpr u32 FRAME_ALLOCATOR_MAX_FRAMES = 4;
+    /** @brief The maximum number of threads that get their own bump region. Other threads share a single (locked) region. */
+    constexpr u32 FRAME_ALLOCATOR_MAX_THREADS = MAX_METRICS_THREADS;
+    /** @brief The amount of memory a thread takes from the shared part of the frame whenever it's own region runs out. */
+    constexpr u64 FRAME_ALLOCATOR_THREAD_REGION_SIZE = KibiBytes(64);
+    /** @brief Allocations larger than this are taken directly from the shared part of the frame instead of the thread's region. */
+    constexpr u64 FRAME_ALLOCATOR_MAX_REGION_ALLOCATION = FRAME_ALLOCATOR_THREAD_REGION_SIZE / 4;
+
+    /**
+     * @brief A thread-safe linear allocator for memory that only needs to live for a couple of frames.
+     * Every thread bumps through it's own region of memory (without any synchronization). These regions, and allocations that are too
+     * large for them, are taken from the current frame with a single atomic operation. The memory is split into frameCount frames that are
+     * used round-robin so memory allocated in frame N stays valid until BeginFrame() is called frameCount times. This allows data that is
+     * produced during frame N to be read (for example by the renderer) in frame N + 1 without copying it.
+     */
+    class C3D_API FrameAllocator final : public BaseAllocator<FrameAllocator>
+    {
+    public:
+        FrameAllocator();
+
+        /**
+         * @brief Creates the frame allocator.
+         *
+         * @param name The name of this allocator (used for metrics)
+         * @param frameSize The amount of memory that is available for a single frame
+         * @param frameCount The amount of frames that are kept alive at the same time (at most FRAME_ALLOCATOR_MAX_FRAMES)
+         */
+        bool Create(const char* name, u64 frameSize, u32 frameCount = 2);
+        void Destroy();
+
+        /** @brief Allocates a (zeroed) block of memory that stays valid for frameCount frames. Can be called from any thread. */
+        void* AllocateBlock(MemoryType type, u64 size, u16 alignment = 1) const override;
+        /** @brief Does nothing since memory is only freed when the frame it was allocated in is reused. */
+        void Free(void* block) const override;
+
+        /**
+         * @brief Starts a new frame. The memory of the oldest frame is reused, memory of the other frames stays valid.
+         * Also updates the high-water marks and reports the usage of the frame that just ended to the MetricSystem.
+         * NOTE: No other thread may allocate from this allocator while this is running.
+         */
+        void BeginFrame();
+
+        /** @brief Frees the memory of all frames at once. NOTE: No other thread may allocate from this allocator while this is running. */
+        void FreeAll();
+
+        [[nodiscard]] u64 GetFrameSize() const { return m_frameSize; }
+        [[nodiscard]] u32 GetFrameCount() const { return m_frameCount; }
+        [[nodiscard]] u64 GetTotalSize() const { return m_frameSize * m_frameCount; }
+
+        /** @brief Gets the amount of memory that is taken from the current frame (including unused parts of thread regions). */
+        [[nodiscard]] u64 GetAllocated() const { return m_offset.load(std::memory_order_relaxed); }
+
+        /** @brief Gets the most memory that was taken from a single frame since this allocator was created. */
+        [[nodiscard]] u64 GetHighWaterMark() const { return m_highWaterMark; }
+        /** @brief Gets the most memory that the thread with the provided slot has allocated in a single frame. */
+        [[nodiscard]] u64 GetThreadHighWaterMark(u32 threadSlot) const;
+
+        /** @brief Gets the slot of the calling thread (which is used to find it's region in every FrameAllocator).
+         * Returns INVALID_ID if all slots are taken, in which case the thread uses the shared region. */
+        static u32 GetThreadSlot();
+
+        static FrameAllocator* GetDefault();
+
+    private:
+        struct alignas(64) ThreadRegion
+        {
+            /** @brief The part of the current frame that this thread can still bump through. */
+            char* current = nullptr;
+            char* end     = nullptr;
+
+            /** @brief The amount of memory this thread has allocated in the current frame. */
+            u64 allocated = 0;
+            /** @brief The most memory this thread has allocated in a single frame. */
+            u64 highWaterMark = 0;
+
+#ifdef C3D_MEMORY_METRICS
+            /** @brief The allocations this thread made during the current frame (per MemoryType). */
+            u32 counts[MAX_MEMORY_TYPES] = {};
+            u64 sizes[MAX_MEMORY_TYPES]  = {};
+#endif
+        };
+
+        void* AllocateFromRegion(ThreadRegion& region, MemoryType type, u64 size, u16 alignment) const;
+
+        /** @brief Takes a block directly from the current frame. Returns nullptr if the frame does not have enough memory left. */
+        char* AllocateShared(u64 size, u16 alignment) const;
+
+        /** @brief The size of a single frame and the amount of frames that we cycle through. */
+        u64 m_frameSize  = 0;
+        u32 m_frameCount = 0;
+        /** @brief The index of the frame that we are currently allocating from. */
+        u32 m_frameIndex = 0;
+
+        /** @brief The offset of the next free byte in the current frame. */
+        mutable std::atomic<u64> m_offset = 0;
+        u64 m_highWaterMark               = 0;
+
+        /** @brief A region for every thread slot followed by a single region that is shared by all threads without a slot. */
+        ThreadRegion* m_threadRegions = nullptr;
+        mutable std::mutex m_sharedRegionMutex;
+    };
+}  // namespace C3D
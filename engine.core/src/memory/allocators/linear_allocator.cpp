@@ -78,8 +78,9 @@ namespace C3D
     {
         if (m_memoryBlock)
         {
+            // NOTE: We only clear the part that was actually used. AllocateBlock() clears every block it hands out anyway
+            std::memset(m_memoryBlock, 0, m_allocated);
             m_allocated = 0;
-            std::memset(m_memoryBlock, 0, m_totalSize);
 
             // Ensure that the metrics keep track of the fact that we just freed all memory for this allocator
             Metrics.FreeAll(m_id);
@@ -1,4 +1,3 @@
-
 #include "free_list.h"
 
 namespace C3D
@@ -6,25 +5,12 @@ namespace C3D
     bool FreeList::Create(void* memory, const u64 memorySizeForNodes, const u64 smallestPossibleAllocation, const u64 managedSize)
     {
         m_smallestPossibleAllocation = smallestPossibleAllocation;
-        m_totalNodes                 = memorySizeForNodes / sizeof(Node);
-        m_nodesSize                  = memorySizeForNodes;
         m_totalManagedSize           = managedSize;
 
-        m_nodes = static_cast<Node*>(memory);
-        std::memset(m_nodes, 0, m_nodesSize);
-
-        // Set all our nodes to invalid
-        for (u64 i = 0; i < m_totalNodes; i++)
-        {
-            m_nodes[i].size   = 0;
-            m_nodes[i].next   = nullptr;
-            m_nodes[i].offset = INVALID_ID_U64;
-        }
+        ResetNodes(memory, memorySizeForNodes);
 
-        // Set our head as the first node with all the memory available
-        m_head         = &m_nodes[0];
-        m_head->size   = m_totalManagedSize;
-        m_head->offset = 0;
+        // Start with a single free block that spans all the memory
+        AddFreeBlock(GetNode(0, m_totalManagedSize));
 
         TRACE("Created FreeList with: {} nodes to manage: {} bytes of memory.", m_totalNodes, m_totalManagedSize);
         return true;
@@ -34,146 +20,84 @@ namespace C3D
     {
         // Zero out our nodes
         std::memset(m_nodes, 0, m_nodesSize);
-        m_nodes = nullptr;
+        m_nodes       = nullptr;
+        m_offsetRoot  = INVALID_ID;
+        m_sizeRoot    = INVALID_ID;
+        m_unusedNodes = INVALID_ID;
         // NOTE: We can't free our memory since the user of this class is responsible for the memory we are using.
     }
 
-    bool FreeList::Resize(void* newMemory, const u64 newSize, void** outOldMemory)
+    bool FreeList::Resize(void* newMemory, const u64 newMemorySizeForNodes, const u64 newManagedSize, void** outOldMemory)
     {
-        if (m_totalManagedSize > newSize) return false;
-
-        *outOldMemory             = m_nodes;
-        const auto sizeDifference = newSize - m_totalManagedSize;
-        const auto oldSize        = m_totalManagedSize;
-        const auto oldHead        = m_head;
-
-        m_nodes = static_cast<Node*>(newMemory);
-
-        m_totalNodes       = newSize / m_smallestPossibleAllocation;
-        m_totalManagedSize = newSize;
-
-        // Invalidate the size and offset for all nodes (except for the head)
-        for (u64 i = 1; i < m_totalNodes; i++)
+        if (m_totalManagedSize > newManagedSize)
         {
-            m_nodes[i].offset = INVALID_ID_U64;
-            m_nodes[i].size   = INVALID_ID_U64;
+            ERROR_LOG("The new size: {} is smaller than the current size: {}.", newManagedSize, m_totalManagedSize);
+            return false;
         }
 
-        // Store our new head
-        m_head = &m_nodes[0];
-
-        // Copy over the nodes
-        Node* newListNode   = m_head;
-        const Node* oldNode = oldHead;
-        if (!oldHead)
+        // We need a node for every current free block and possibly one extra for the newly added memory at the end
+        if (newMemorySizeForNodes / sizeof(Node) < m_freeBlockCount + 1)
         {
-            // There is no head meaning the entire list was allocated
-            // We set the head to be the at the start of new memory
-            // and size equal to the difference in size between the new and the old block
-            m_head->offset = oldSize;
-            m_head->size   = sizeDifference;
-            m_head->next   = nullptr;
+            ERROR_LOG("The provided memory can't hold enough nodes for all: {} free blocks.", m_freeBlockCount);
+            return false;
         }
-        else
+
+        *outOldMemory       = m_nodes;
+        const auto oldNodes = m_nodes;
+        const auto oldRoot  = m_offsetRoot;
+        const auto oldSize  = m_totalManagedSize;
+        m_totalManagedSize  = newManagedSize;
+
+        // The old nodes are not touched by this so we can copy the free blocks over from the old tree afterwards
+        ResetNodes(newMemory, newMemorySizeForNodes);
+        CopyFreeBlocks(oldNodes, oldRoot);
+
+        // Finally we free the newly added memory (which automatically merges it with a free block that ends at our old size)
+        if (newManagedSize > oldSize)
         {
-            // Iterate over all nodes
-            while (oldNode)
-            {
-                // Get a new node, copy the offset/size, and set next to it
-                Node* newNode     = GetNode();
-                newNode->offset   = oldNode->offset;
-                newNode->size     = oldNode->size;
-                newNode->next     = nullptr;
-                newListNode->next = newNode;
-
-                if (oldNode->next)
-                {
-                    // There is another node, move on
-                    oldNode = oldNode->next;
-                }
-                else
-                {
-                    // We reached the end of the list
-                    if (oldNode->offset + oldNode->size == oldSize)
-                    {
-                        // The last node in the old list extends to the end of the list so we simply add the size
-                        // difference to it
-                        newNode->size += sizeDifference;
-                    }
-                    else
-                    {
-                        // The last node
-                        Node* newNodeEnd   = GetNode();
-                        newNodeEnd->offset = oldSize;
-                        newNodeEnd->size   = sizeDifference;
-                        newNodeEnd->next   = nullptr;
-                        newNode->next      = newNodeEnd;
-                    }
-
-                    break;
-                }
-            }
+            return FreeBlock(newManagedSize - oldSize, oldSize);
         }
-
         return true;
     }
 
     bool FreeList::Clear()
     {
-        std::memset(m_nodes, 0, m_nodesSize);
-        m_head         = &m_nodes[0];
-        m_head->size   = m_totalManagedSize;
-        m_head->offset = 0;
-        m_head->next   = nullptr;
+        ResetNodes(m_nodes, m_nodesSize);
+        AddFreeBlock(GetNode(0, m_totalManagedSize));
         return true;
     }
 
     bool FreeList::AllocateBlock(const u64 size, u64* outOffset) const
     {
-        // Keep track of our current and previous node
-        Node* prev = nullptr;
-        // We start at the head of our free_list
-        Node* current = m_head;
-
-        while (current)
+        if (!TryAllocateBlock(size, outOffset))
         {
-            if (current->size == size)
-            {
-                // We have an exact size match so our allocation fits nicely into this node
-                *outOffset = current->offset;
-
-                if (prev)
-                {
-                    // We have a previous so we can simply point it to the next node
-                    prev->next = current->next;
-                }
-                else if (current->next)
-                {
-                    // There is no previous node so our next node needs to become the head
-                    m_head = current->next;
-                }
-
-                // Invalidate this node since it is no longer needed
-                current->Invalidate();
-                return true;
-            }
+            ERROR_LOG("Failed to find a node with enough space for the allocation.");
+            throw std::bad_alloc();
+        }
+        return true;
+    }
 
-            if (current->size > size)
-            {
-                // We have more space than is required for our allocation
-                *outOffset = current->offset;
+    bool FreeList::TryAllocateBlock(const u64 size, u64* outOffset) const
+    {
+        const auto index = FindBestFit(size);
+        if (index == INVALID_ID) return false;
 
-                current->size -= size;
-                current->offset += size;
-                return true;
-            }
+        const auto& node = m_nodes[index];
+        *outOffset       = node.offset;
 
-            prev    = current;
-            current = current->next;
+        if (node.size == size)
+        {
+            // We have an exact size match so our allocation takes up the entire free block
+            RemoveFreeBlock(index);
+            ReleaseNode(index);
+        }
+        else
+        {
+            // We have more space than is required for our allocation so we shrink the free block from the front
+            ResizeFreeBlock(index, node.offset + size, node.size - size);
         }
 
-        ERROR_LOG("Failed to find a node with enough space for the allocation.");
-        throw std::bad_alloc();
+        return true;
     }
 
     bool FreeList::FreeBlock(const u64 size, const u64 offset) const
@@ -186,122 +110,345 @@ namespace C3D
         }
 #endif
 
-        Node* prev    = nullptr;
-        Node* current = m_head;
+        if (offset + size > m_totalManagedSize)
+        {
+            ERROR_LOG("The block at offset: {} with size: {} falls outside of the managed memory.", offset, size);
+            return false;
+        }
+
+        const auto prevIndex = FindPrevious(offset);
+        const auto nextIndex = FindNext(offset);
+        const auto prev      = prevIndex != INVALID_ID ? &m_nodes[prevIndex] : nullptr;
+        const auto next      = nextIndex != INVALID_ID ? &m_nodes[nextIndex] : nullptr;
+
+        if ((prev && prev->offset + prev->size > offset) || (next && offset + size > next->offset))
+        {
+            ERROR_LOG("The block at offset: {} with size: {} overlaps with memory that is already free.", offset, size);
+            return false;
+        }
+
+        const bool mergeWithPrev = prev && prev->offset + prev->size == offset;
+        const bool mergeWithNext = next && offset + size == next->offset;
+
+        if (mergeWithPrev && mergeWithNext)
+        {
+            // The block connects our previous and next free blocks so we merge all three into the previous block
+            const auto nextSize = next->size;
+            RemoveFreeBlock(nextIndex);
+            ReleaseNode(nextIndex);
+            ResizeFreeBlock(prevIndex, prev->offset, prev->size + size + nextSize);
+        }
+        else if (mergeWithPrev)
+        {
+            // We can append the block to the right of our previous free block
+            ResizeFreeBlock(prevIndex, prev->offset, prev->size + size);
+        }
+        else if (mergeWithNext)
+        {
+            // We can prepend the block to the left of our next free block
+            ResizeFreeBlock(nextIndex, offset, next->size + size);
+        }
+        else
+        {
+            // The block is not adjacent to any other free block so we need a new node for it
+            const auto node = GetNode(offset, size);
+            if (node == INVALID_ID) return false;
+            AddFreeBlock(node);
+        }
+
+        return true;
+    }
+
+    u64 FreeList::GetLargestFreeBlock() const
+    {
+        // The largest free block is the right-most node in our size tree
+        auto node = m_sizeRoot;
+        if (node == INVALID_ID) return 0;
+
+        while (m_nodes[node].sizeChildren[1] != INVALID_ID) node = m_nodes[node].sizeChildren[1];
+        return m_nodes[node].size;
+    }
+
+    void FreeList::GetFragmentationReport(FragmentationReport& outReport) const
+    {
+        outReport.freeSpace        = m_freeSpace;
+        outReport.largestFreeBlock = GetLargestFreeBlock();
+        outReport.freeBlockCount   = m_freeBlockCount;
+        std::memcpy(outReport.histogram, m_histogram, sizeof(m_histogram));
+    }
+
+    bool FreeList::AreExactlyAdjacent(const Node* first, const Node* second) { return first->offset + first->size == second->offset; }
+
+    void FreeList::ResetNodes(void* memory, const u64 memorySizeForNodes)
+    {
+        m_nodes      = static_cast<Node*>(memory);
+        m_nodesSize  = memorySizeForNodes;
+        m_totalNodes = memorySizeForNodes / sizeof(Node);
+        // NOTE: Our nodes are referred to by a u32 index and INVALID_ID is reserved to mark the absence of a node
+        if (m_totalNodes > INVALID_ID) m_totalNodes = INVALID_ID;
+
+        m_offsetRoot  = INVALID_ID;
+        m_sizeRoot    = INVALID_ID;
+        m_unusedNodes = INVALID_ID;
+
+        m_freeSpace      = 0;
+        m_freeBlockCount = 0;
+        std::memset(m_histogram, 0, sizeof(m_histogram));
+
+        std::memset(m_nodes, 0, m_nodesSize);
+
+        // Link all of our nodes into our list of unused nodes (in order so the first node is used first)
+        for (u64 i = m_totalNodes; i > 0; --i)
+        {
+            auto& node             = m_nodes[i - 1];
+            node.offset            = INVALID_ID_U64;
+            node.offsetChildren[0] = m_unusedNodes;
+            m_unusedNodes          = static_cast<u32>(i - 1);
+        }
+    }
+
+    void FreeList::CopyFreeBlocks(const Node* oldNodes, const u32 oldNode)
+    {
+        if (oldNode == INVALID_ID) return;
+
+        // Walk the old offset tree in order so our free blocks are added sorted by offset
+        const auto& node = oldNodes[oldNode];
+        CopyFreeBlocks(oldNodes, node.offsetChildren[0]);
+        AddFreeBlock(GetNode(node.offset, node.size));
+        CopyFreeBlocks(oldNodes, node.offsetChildren[1]);
+    }
+
+    u32 FreeList::GetNode(const u64 offset, const u64 size) const
+    {
+        if (m_unusedNodes == INVALID_ID)
+        {
+            FATAL_LOG("Unable to get a valid node.");
+            return INVALID_ID;
+        }
+
+        const auto index = m_unusedNodes;
+        auto& node       = m_nodes[index];
+        m_unusedNodes    = node.offsetChildren[0];
+
+        node.offset = offset;
+        node.size   = size;
+        return index;
+    }
+
+    void FreeList::ReleaseNode(const u32 node) const
+    {
+        auto& n             = m_nodes[node];
+        n.offset            = INVALID_ID_U64;
+        n.size              = 0;
+        n.offsetChildren[0] = m_unusedNodes;
+        n.offsetChildren[1] = INVALID_ID;
+        n.sizeChildren[0]   = INVALID_ID;
+        n.sizeChildren[1]   = INVALID_ID;
+        m_unusedNodes       = node;
+    }
+
+    void FreeList::AddFreeBlock(const u32 node) const
+    {
+        Insert<false>(m_offsetRoot, node);
+        Insert<true>(m_sizeRoot, node);
+        TrackFreeBlock(m_nodes[node].size, 1);
+    }
+
+    void FreeList::RemoveFreeBlock(const u32 node) const
+    {
+        Remove<false>(m_offsetRoot, node);
+        Remove<true>(m_sizeRoot, node);
+        TrackFreeBlock(m_nodes[node].size, -1);
+    }
+
+    void FreeList::ResizeFreeBlock(const u32 node, const u64 newOffset, const u64 newSize) const
+    {
+        // Only the key for our size tree changes so we only need to reinsert into that tree
+        Remove<true>(m_sizeRoot, node);
+        TrackFreeBlock(m_nodes[node].size, -1);
+
+        m_nodes[node].offset = newOffset;
+        m_nodes[node].size   = newSize;
+
+        Insert<true>(m_sizeRoot, node);
+        TrackFreeBlock(newSize, 1);
+    }
 
-        // Check the case where the entire freelist is allocated (which means we have no head node)
-        if (!current)
+    u32 FreeList::FindPrevious(const u64 offset) const
+    {
+        u32 result = INVALID_ID;
+        u32 node   = m_offsetRoot;
+        while (node != INVALID_ID)
+        {
+            if (m_nodes[node].offset < offset)
+            {
+                result = node;
+                node   = m_nodes[node].offsetChildren[1];
+            }
+            else
+            {
+                node = m_nodes[node].offsetChildren[0];
+            }
+        }
+        return result;
+    }
+
+    u32 FreeList::FindNext(const u64 offset) const
+    {
+        u32 result = INVALID_ID;
+        u32 node   = m_offsetRoot;
+        while (node != INVALID_ID)
         {
-            // In this case a new node is needed at the head
-            const auto newHead = GetNode();
-            newHead->offset    = offset;
-            newHead->size      = size;
-            newHead->next      = nullptr;
-            m_head             = newHead;
-            return true;
+            if (m_nodes[node].offset >= offset)
+            {
+                result = node;
+                node   = m_nodes[node].offsetChildren[0];
+            }
+            else
+            {
+                node = m_nodes[node].offsetChildren[1];
+            }
         }
+        return result;
+    }
 
-        while (current)
+    u32 FreeList::FindBestFit(const u64 size) const
+    {
+        u32 result = INVALID_ID;
+        u32 node   = m_sizeRoot;
+        while (node != INVALID_ID)
         {
-            if (current->offset + current->size == offset)
+            if (m_nodes[node].size >= size)
             {
-                // We can append the new free block to the right of the current block
-                current->size += size;
-
-                // Check if this then connects our current node to the next node
-                if (current->next && AreExactlyAdjacent(current, current->next))
-                {
-                    const auto next = current->next;
-
-                    // We add the size of the next node to our new node
-                    current->size += next->size;
-                    // And connect our new node to the next node's next node
-                    current->next = next->next;
-                    // Then we invalidate the next node
-                    next->Invalidate();
-                }
-
-                return true;
+                // This block fits but there might be a smaller one on the left
+                result = node;
+                node   = m_nodes[node].sizeChildren[0];
             }
-            if (current->offset > offset)
+            else
             {
-                // Our current node's offset is further into the memory block than where we want to free
-                const auto newNode = GetNode();
-                newNode->next      = current;
-                newNode->offset    = offset;
-                newNode->size      = size;
-
-                if (prev)
-                {
-                    // We have a previous node so we insert our new node in between prev and current
-                    prev->next = newNode;
-                }
-                else
-                {
-                    // We have no previous node so our new node becomes the new head
-                    m_head = newNode;
-                }
-
-                // If our new node is exactly adjacent to the next
-                if (newNode->next && AreExactlyAdjacent(newNode, newNode->next))
-                {
-                    const auto next = newNode->next;
-
-                    // We add the size of the next node to our new node
-                    newNode->size += next->size;
-                    // And connect our new node to the next node's next node
-                    newNode->next = next->next;
-                    // Then we invalidate the next node
-                    next->Invalidate();
-                }
-
-                // If our previous node is exactly adjacent to our new node
-                if (prev && AreExactlyAdjacent(prev, newNode))
-                {
-                    // We add the size of our new node to our prev node
-                    prev->size += newNode->size;
-                    // And connect our prev node to our new node's next node
-                    prev->next = newNode->next;
-                    // Then we invalidate our new node
-                    newNode->Invalidate();
-                }
-
-                return true;
+                node = m_nodes[node].sizeChildren[1];
             }
+        }
+        return result;
+    }
+
+    void FreeList::TrackFreeBlock(const u64 size, const i64 delta) const
+    {
+        // NOTE: Unsigned wrap-around makes adding negative deltas work as expected
+        m_freeSpace += size * static_cast<u64>(delta);
+        m_freeBlockCount += static_cast<u64>(delta);
+        m_histogram[FragmentationReport::GetBucket(size)] += static_cast<u64>(delta);
+    }
+
+    u64 FreeList::GetPriority(const u32 node)
+    {
+        // Use a SplitMix64 hash of the index since it's deterministic and spreads the bits well enough to keep our trees balanced
+        u64 hash = (static_cast<u64>(node) + 1) * 0x9E3779B97F4A7C15ull;
+        hash     = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ull;
+        hash     = (hash ^ (hash >> 27)) * 0x94D049BB133111EBull;
+        return hash ^ (hash >> 31);
+    }
+
+    template <bool BySize>
+    u32& FreeList::Child(const u32 node, const u32 direction) const
+    {
+        if constexpr (BySize) return m_nodes[node].sizeChildren[direction];
+        else return m_nodes[node].offsetChildren[direction];
+    }
+
+    template <bool BySize>
+    bool FreeList::IsLess(const u32 a, const u32 b) const
+    {
+        const auto& nodeA = m_nodes[a];
+        const auto& nodeB = m_nodes[b];
+
+        if constexpr (BySize)
+        {
+            // Sort by size first and by offset second so every key is unique
+            return nodeA.size < nodeB.size || (nodeA.size == nodeB.size && nodeA.offset < nodeB.offset);
+        }
+        else
+        {
+            return nodeA.offset < nodeB.offset;
+        }
+    }
+
+    template <bool BySize>
+    void FreeList::Insert(u32& root, const u32 node) const
+    {
+        if (root == INVALID_ID)
+        {
+            Child<BySize>(node, 0) = INVALID_ID;
+            Child<BySize>(node, 1) = INVALID_ID;
+            root                   = node;
+            return;
+        }
 
-            // If our current node's offset is smaller then the provided offset we simply move to the next node
-            prev    = current;
-            current = current->next;
+        if (GetPriority(node) > GetPriority(root))
+        {
+            // Our node should be above the current root so we split the current subtree around our node
+            Split<BySize>(root, node, Child<BySize>(node, 0), Child<BySize>(node, 1));
+            root = node;
+            return;
         }
 
-        FATAL_LOG("Failed. No node was found.");
-        return false;
+        Insert<BySize>(Child<BySize>(root, IsLess<BySize>(root, node) ? 1 : 0), node);
     }
 
-    u64 FreeList::FreeSpace() const
+    template <bool BySize>
+    void FreeList::Remove(u32& root, const u32 node) const
     {
-        u64 free            = 0;
-        const Node* current = m_head;
-        while (current)
+        if (root == INVALID_ID)
         {
-            free += current->size;
-            current = current->next;
+            ERROR_LOG("Tried to remove a node that is not in the tree.");
+            return;
         }
-        return free;
+
+        if (root == node)
+        {
+            root = Merge<BySize>(Child<BySize>(root, 0), Child<BySize>(root, 1));
+            return;
+        }
+
+        Remove<BySize>(Child<BySize>(root, IsLess<BySize>(root, node) ? 1 : 0), node);
     }
 
-    bool FreeList::AreExactlyAdjacent(const Node* first, const Node* second) { return first->offset + first->size == second->offset; }
+    template <bool BySize>
+    void FreeList::Split(const u32 root, const u32 key, u32& outLeft, u32& outRight) const
+    {
+        if (root == INVALID_ID)
+        {
+            outLeft  = INVALID_ID;
+            outRight = INVALID_ID;
+            return;
+        }
+
+        if (IsLess<BySize>(root, key))
+        {
+            Split<BySize>(Child<BySize>(root, 1), key, Child<BySize>(root, 1), outRight);
+            outLeft = root;
+        }
+        else
+        {
+            Split<BySize>(Child<BySize>(root, 0), key, outLeft, Child<BySize>(root, 0));
+            outRight = root;
+        }
+    }
 
-    FreeList::Node* FreeList::GetNode() const
+    template <bool BySize>
+    u32 FreeList::Merge(const u32 left, const u32 right) const
     {
-        for (u64 i = 0; i < m_totalNodes; i++)
+        if (left == INVALID_ID) return right;
+        if (right == INVALID_ID) return left;
+
+        // Every node in left is smaller than every node in right so we only need to respect the priorities
+        if (GetPriority(left) > GetPriority(right))
         {
-            if (m_nodes[i].offset == INVALID_ID_U64)
-            {
-                return &m_nodes[i];
-            }
+            Child<BySize>(left, 1) = Merge<BySize>(Child<BySize>(left, 1), right);
+            return left;
         }
-        FATAL_LOG("Unable to get a valid node.");
-        return nullptr;
+
+        Child<BySize>(right, 0) = Merge<BySize>(left, Child<BySize>(right, 0));
+        return right;
     }
 }  // namespace C3D
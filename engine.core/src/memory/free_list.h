@@ -1,24 +1,26 @@
-
 #pragma once
 #include "defines.h"
 #include "logger/logger.h"
+#include "metrics/types.h"
 
 namespace C3D
 {
+    /**
+     * @brief Keeps track of the free blocks in a range of memory [0, managedSize).
+     * The free blocks are indexed by two balanced trees (treaps) that share the same nodes. One is sorted by size, which allows for
+     * best-fit allocation in O(log n), and one is sorted by offset, which allows for finding (and merging with) neighbours in O(log n).
+     * Nodes refer to each other by their index so a node only takes up 32 bytes.
+     */
     class C3D_API FreeList
     {
         struct Node
         {
             u64 offset;
             u64 size;
-            Node* next;
-
-            void Invalidate()
-            {
-                offset = INVALID_ID_U64;
-                size   = 0;
-                next   = nullptr;
-            }
+            /** @brief The left and right child in the tree that is sorted by offset. Also used to link unused nodes together. */
+            u32 offsetChildren[2];
+            /** @brief The left and right child in the tree that is sorted by size (and by offset for blocks of equal size). */
+            u32 sizeChildren[2];
         };
 
     public:
@@ -27,13 +29,34 @@ namespace C3D
         bool Create(void* memory, u64 memorySizeForNodes, u64 smallestPossibleAllocation, u64 managedSize);
         void Destroy();
 
-        bool Resize(void* newMemory, u64 newSize, void** outOldMemory);
+        /**
+         * @brief Resizes the freelist to manage a larger range of memory. All current free blocks are copied to the new memory.
+         *
+         * @param newMemory The memory that will hold the nodes from now on
+         * @param newMemorySizeForNodes The size of the provided memory (see GetMemoryRequirement())
+         * @param newManagedSize The new amount of memory that this freelist manages (must be larger than the current size)
+         * @param outOldMemory A pointer to the memory that was used for the nodes before this call (the caller should free this)
+         * @return True if successful, false otherwise
+         */
+        bool Resize(void* newMemory, u64 newMemorySizeForNodes, u64 newManagedSize, void** outOldMemory);
         bool Clear();
 
+        /** @brief Allocates a block of the provided size from the smallest free block that fits it (best-fit). */
         bool AllocateBlock(u64 size, u64* outOffset) const;
+        /** @brief Same as AllocateBlock() but returns false instead of throwing when no free block is large enough. */
+        bool TryAllocateBlock(u64 size, u64* outOffset) const;
         bool FreeBlock(u64 size, u64 offset) const;
 
-        [[nodiscard]] u64 FreeSpace() const;
+        [[nodiscard]] u64 FreeSpace() const { return m_freeSpace; }
+
+        /** @brief Gets the amount of separate free blocks. */
+        [[nodiscard]] u64 GetFreeBlockCount() const { return m_freeBlockCount; }
+
+        /** @brief Gets the size of the largest free block. */
+        [[nodiscard]] u64 GetLargestFreeBlock() const;
+
+        /** @brief Fills out a report about the fragmentation of the free memory. */
+        void GetFragmentationReport(FragmentationReport& outReport) const;
 
         /** @brief Checks if memory block of first is exactly adjacent to second. */
         static bool AreExactlyAdjacent(const Node* first, const Node* second);
@@ -41,10 +64,58 @@ namespace C3D
         static constexpr u64 GetMemoryRequirement(u64 usableSize, u64 smallestPossibleAllocation);
 
     private:
-        [[nodiscard]] Node* GetNode() const;
+        /** @brief Starts using the provided memory for our nodes. All nodes are marked as unused and all free blocks are forgotten. */
+        void ResetNodes(void* memory, u64 memorySizeForNodes);
+        /** @brief Adds a copy of all the free blocks in the provided (old) offset tree. */
+        void CopyFreeBlocks(const Node* oldNodes, u32 oldNode);
+
+        [[nodiscard]] u32 GetNode(u64 offset, u64 size) const;
+        void ReleaseNode(u32 node) const;
+
+        /** @brief Adds the node to both trees. */
+        void AddFreeBlock(u32 node) const;
+        /** @brief Removes the node from both trees. */
+        void RemoveFreeBlock(u32 node) const;
+
+        /** @brief Changes the size (and possibly offset) of a free block while keeping it in the correct place in both trees.
+         * NOTE: The new range must not overlap any other free block so the node's position in the offset tree stays the same. */
+        void ResizeFreeBlock(u32 node, u64 newOffset, u64 newSize) const;
 
-        Node* m_nodes        = nullptr;
-        mutable Node* m_head = nullptr;
+        /** @brief Finds the free block with the largest offset that is smaller than the provided offset. */
+        [[nodiscard]] u32 FindPrevious(u64 offset) const;
+        /** @brief Finds the free block with the smallest offset that is larger than or equal to the provided offset. */
+        [[nodiscard]] u32 FindNext(u64 offset) const;
+        /** @brief Finds the smallest free block that can hold the provided size (the lowest offset wins for blocks of equal size). */
+        [[nodiscard]] u32 FindBestFit(u64 size) const;
+
+        void TrackFreeBlock(u64 size, i64 delta) const;
+
+        /** @brief Gets the random priority that keeps both trees balanced. Derived from the index so we never have to store it. */
+        static u64 GetPriority(u32 node);
+
+        template <bool BySize>
+        u32& Child(u32 node, u32 direction) const;
+        template <bool BySize>
+        bool IsLess(u32 a, u32 b) const;
+        template <bool BySize>
+        void Insert(u32& root, u32 node) const;
+        template <bool BySize>
+        void Remove(u32& root, u32 node) const;
+        template <bool BySize>
+        void Split(u32 root, u32 key, u32& outLeft, u32& outRight) const;
+        template <bool BySize>
+        u32 Merge(u32 left, u32 right) const;
+
+        /** @brief We reserve a node for every this many of the smallest possible allocations that fit in the managed memory. */
+        static constexpr u64 SMALLEST_ALLOCATIONS_PER_NODE = 24;
+
+        Node* m_nodes = nullptr;
+
+        /** @brief The roots of the tree sorted by offset and the tree sorted by size. */
+        mutable u32 m_offsetRoot = INVALID_ID;
+        mutable u32 m_sizeRoot   = INVALID_ID;
+        /** @brief A linked list (through offsetChildren[0]) of all the nodes that are currently not in use. */
+        mutable u32 m_unusedNodes = INVALID_ID;
 
         /** @brief Amount of nodes this list holds. */
         u64 m_totalNodes = 0;
@@ -54,11 +125,17 @@ namespace C3D
         u64 m_smallestPossibleAllocation = 0;
         /** @brief The amount of memory that this freelist is used for. */
         u64 m_totalManagedSize = 0;
+
+        /** @brief Stats about our free blocks that are kept up-to-date on every change so reporting on them is cheap. */
+        mutable u64 m_freeSpace                                  = 0;
+        mutable u64 m_freeBlockCount                             = 0;
+        mutable u64 m_histogram[FRAGMENTATION_HISTOGRAM_BUCKETS] = {};
     };
 
     constexpr u64 FreeList::GetMemoryRequirement(const u64 usableSize, const u64 smallestPossibleAllocation)
     {
-        auto elementCount = usableSize / (smallestPossibleAllocation * sizeof(Node));
+        // NOTE: The number of nodes only depends on how many allocations could fit, not on how large a node is
+        auto elementCount = usableSize / smallestPossibleAllocation / SMALLEST_ALLOCATIONS_PER_NODE;
         if (elementCount < 20) elementCount = 20;
         return elementCount * sizeof(Node);
     }
@@ -18,6 +18,8 @@ namespace C3D
 
         const auto globalAllocator = BaseAllocator<DynamicAllocator>::GetDefault();
         globalAllocator->Create(memoryBlock, memoryRequirement, config.totalAllocSize);
+        // Every thread gets it's own cache of small blocks so threads don't have to contend on the global allocator
+        globalAllocator->SetThreadCachesEnabled(true);
 
         const auto linearAllocator = BaseAllocator<LinearAllocator>::GetDefault();
         linearAllocator->Create("DefaultLinearAllocator", KibiBytes(8));
@@ -140,6 +140,8 @@ namespace C3D
 
     void MetricSystem::DestroyAllocator(const u8 allocatorId, bool printMissedAllocs)
     {
+        // Ensure all lazily counted allocations are included
+        Flush(allocatorId);
         // Print the memory usage for this allocator
         PrintMemoryUsage(allocatorId, true);
         // Clear out the metrics we have on this allocator
@@ -245,15 +247,82 @@ namespace C3D
         m_memoryStats[allocatorId].totalAvailableSpace = availableSpace;
     }
 
-    u64 MetricSystem::GetAllocCount(const u8 allocatorId) const { return m_memoryStats[allocatorId].allocCount; }
+    void MetricSystem::AllocateBatch(const u8 allocatorId, const MemoryType memoryType, const i64 countDelta, const i64 requestedDelta,
+                                     const i64 requiredDelta)
+    {
+        auto& stats  = m_memoryStats[allocatorId];
+        auto& tagged = stats.taggedAllocations[ToUnderlying(memoryType)];
+
+        // NOTE: Unsigned wrap-around makes adding negative deltas work as expected
+        stats.allocCount += static_cast<u64>(countDelta);
+        stats.totalRequested += static_cast<u64>(requestedDelta);
+        stats.totalRequired += static_cast<u64>(requiredDelta);
+
+        tagged.count += static_cast<u32>(countDelta);
+        tagged.requestedSize += static_cast<u64>(requestedDelta);
+        tagged.requiredSize += static_cast<u64>(requiredDelta);
+    }
+
+    void MetricSystem::SetFlushCallback(const u8 allocatorId, void (*callback)(const void* user), const void* user)
+    {
+        m_memoryStats[allocatorId].flushCallback = callback;
+        m_memoryStats[allocatorId].flushUser     = user;
+    }
+
+    void MetricSystem::SetFragmentationCallback(const u8 allocatorId, bool (*callback)(const void* user, FragmentationReport& report),
+                                                const void* user)
+    {
+        m_memoryStats[allocatorId].fragmentationCallback = callback;
+        m_memoryStats[allocatorId].fragmentationUser     = user;
+    }
+
+    bool MetricSystem::GetFragmentationReport(const u8 allocatorId, FragmentationReport& outReport) const
+    {
+        const auto& stats = m_memoryStats[allocatorId];
+        if (!stats.fragmentationCallback) return false;
+
+        outReport = FragmentationReport();
+        return stats.fragmentationCallback(stats.fragmentationUser, outReport);
+    }
+
+    void MetricSystem::SetThreadHighWaterMark(const u8 allocatorId, const u32 threadIndex, const u64 highWaterMark)
+    {
+        if (threadIndex >= MAX_METRICS_THREADS)
+        {
+            ERROR_LOG("ThreadIndex: {} falls outside of the range of threads that can be tracked.", threadIndex);
+            return;
+        }
+        m_memoryStats[allocatorId].threadHighWaterMarks[threadIndex] = highWaterMark;
+    }
+
+    u64 MetricSystem::GetThreadHighWaterMark(const u8 allocatorId, const u32 threadIndex) const
+    {
+        if (threadIndex >= MAX_METRICS_THREADS) return 0;
+        return m_memoryStats[allocatorId].threadHighWaterMarks[threadIndex];
+    }
+
+    void MetricSystem::Flush(const u8 allocatorId) const
+    {
+        const auto& stats = m_memoryStats[allocatorId];
+        if (stats.flushCallback) stats.flushCallback(stats.flushUser);
+    }
+
+    u64 MetricSystem::GetAllocCount(const u8 allocatorId) const
+    {
+        Flush(allocatorId);
+        return m_memoryStats[allocatorId].allocCount;
+    }
 
     u64 MetricSystem::GetAllocCount(MemoryType memoryType, u8 allocatorId) const
     {
+        Flush(allocatorId);
         return m_memoryStats[allocatorId].taggedAllocations[ToUnderlying(memoryType)].count;
     }
 
     u64 MetricSystem::GetMemoryUsage(const MemoryType memoryType, const u8 allocatorId) const
     {
+        Flush(allocatorId);
+
 #ifdef C3D_MEMORY_METRICS_POINTERS
         u64 requiredSize = 0;
         for (const auto& alloc : m_memoryStats[allocatorId].taggedAllocations[ToUnderlying(memoryType)].allocations)
@@ -268,6 +337,8 @@ namespace C3D
 
     u64 MetricSystem::GetRequestedMemoryUsage(const MemoryType memoryType, const u8 allocatorId) const
     {
+        Flush(allocatorId);
+
 #ifdef C3D_MEMORY_METRICS_POINTERS
         const auto tagged = m_memoryStats[allocatorId].taggedAllocations[ToUnderlying(memoryType)];
 
@@ -295,6 +366,8 @@ namespace C3D
     {
         char buffer[4096] = {};
 
+        Flush(allocatorId);
+
         const auto& memStats = m_memoryStats[allocatorId];
         if (memStats.type != AllocatorType::None)
         {
@@ -327,6 +400,39 @@ namespace C3D
                 snprintf(buffer + offset, 8192, "  %d total allocations using: %.2f %-3s of total: %.2f %-3s (%.2f%%)\n",
                          static_cast<int>(memStats.allocCount), requiredAmount, requiredUnit, totalAmount, totalUnit, percentage);
 
+            // Only append extra lines while they still fit in our buffer
+            const auto hasSpace = [&] { return bytesWritten > 0 && offset + bytesWritten < static_cast<i32>(sizeof(buffer)); };
+
+            FragmentationReport report;
+            if (hasSpace() && GetFragmentationReport(allocatorId, report))
+            {
+                offset += bytesWritten;
+
+                f64 freeAmount, largestAmount;
+                const char* freeUnit    = SizeToText(report.freeSpace, &freeAmount);
+                const char* largestUnit = SizeToText(report.largestFreeBlock, &largestAmount);
+
+                bytesWritten = snprintf(buffer + offset, sizeof(buffer) - offset,
+                                        "  %llu free blocks holding: %.2f %-3s largest free block: %.2f %-3s (fragmentation: %.2f%%)\n",
+                                        static_cast<unsigned long long>(report.freeBlockCount), freeAmount, freeUnit, largestAmount,
+                                        largestUnit, report.GetFragmentation() * 100.0f);
+            }
+
+            for (u32 thread = 0; thread < MAX_METRICS_THREADS; ++thread)
+            {
+                const auto highWaterMark = memStats.threadHighWaterMarks[thread];
+                if (highWaterMark == 0) continue;
+                if (!hasSpace()) break;
+
+                offset += bytesWritten;
+
+                f64 highWaterAmount;
+                const char* highWaterUnit = SizeToText(highWaterMark, &highWaterAmount);
+
+                bytesWritten = snprintf(buffer + offset, sizeof(buffer) - offset, "  Thread %u high-water mark: %.2f %-3s\n", thread,
+                                        highWaterAmount, highWaterUnit);
+            }
+
             Logger::Info(buffer);
         }
     }
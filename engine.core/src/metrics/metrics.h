@@ -28,7 +28,7 @@ namespace C3D
 #define MetricsFree(id, type, requested, required, ptr)
 #endif
 
-    constexpr auto METRICS_COUNT = 16;
+    constexpr auto METRICS_COUNT = 64;
 
     constexpr u8 DYNAMIC_ALLOCATOR_ID = 0;
     constexpr u8 GPU_ALLOCATOR_ID     = 1;
@@ -69,6 +69,35 @@ namespace C3D
 
         void SetAllocatorAvailableSpace(u8 allocatorId, u64 availableSpace);
 
+        /**
+         * @brief Adds a batch of allocations (or frees when the deltas are negative) of a single MemoryType to the provided allocator.
+         * Used by allocators that count allocations lazily instead of calling Allocate() and Free() for every allocation.
+         */
+        void AllocateBatch(u8 allocatorId, MemoryType memoryType, i64 countDelta, i64 requestedDelta, i64 requiredDelta);
+
+        /** @brief Sets a callback that is called before the stats of the provided allocator are read.
+         * Allocators that count allocations lazily use this to add their pending allocations (with AllocateBatch()). */
+        void SetFlushCallback(u8 allocatorId, void (*callback)(const void* user), const void* user);
+
+        /** @brief Sets a callback that fills out a FragmentationReport for the provided allocator.
+         * Allocators that manage their free memory in blocks (like the DynamicAllocator) use this to expose their fragmentation. */
+        void SetFragmentationCallback(u8 allocatorId, bool (*callback)(const void* user, FragmentationReport& report), const void* user);
+
+        /**
+         * @brief Gets a report about the fragmentation of the free memory of the provided allocator.
+         *
+         * @param allocatorId The id of the allocator that you want the report for
+         * @param outReport The report that will be filled out
+         * @return True if the allocator provides fragmentation reports, false otherwise
+         */
+        bool GetFragmentationReport(u8 allocatorId, FragmentationReport& outReport) const;
+
+        /** @brief Sets the most memory that the thread with the provided index has used at once in the provided allocator.
+         * Used by allocators that give every thread it's own region of memory (like the FrameAllocator). */
+        void SetThreadHighWaterMark(u8 allocatorId, u32 threadIndex, u64 highWaterMark);
+
+        [[nodiscard]] u64 GetThreadHighWaterMark(u8 allocatorId, u32 threadIndex) const;
+
         [[nodiscard]] u64 GetAllocCount(u8 allocatorId = 0) const;
 
         [[nodiscard]] u64 GetAllocCount(MemoryType memoryType, u8 allocatorId = 0) const;
@@ -89,6 +118,9 @@ namespace C3D
         [[nodiscard]] u16 GetFps() const { return m_fps; }
 
     private:
+        /** @brief Calls the flush callback of the provided allocator (if it has one) so it's stats are up-to-date. */
+        void Flush(u8 allocatorId) const;
+
         static const char* SizeToText(u64 size, f64* outAmount);
         static void SprintfAllocation(const MemoryAllocations& allocation, int index, char* buffer, int& bytesWritten, int offset,
                                       bool debugLines);
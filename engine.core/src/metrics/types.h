@@ -1,5 +1,7 @@
 
 #pragma once
+#include <algorithm>
+#include <bit>
 #include <vector>
 
 #include "containers/array.h"
@@ -76,6 +78,9 @@ namespace C3D
 
     constexpr auto MAX_MEMORY_TYPES = static_cast<u64>(MemoryType::MaxType);
 
+    /** @brief The maximum number of threads that an allocator can report separate high-water marks for. */
+    constexpr auto MAX_METRICS_THREADS = 64;
+
     struct Allocation
     {
 #ifdef C3D_MEMORY_METRICS_POINTERS
@@ -155,6 +160,39 @@ namespace C3D
 
     using TaggedAllocations = Array<MemoryAllocations, MAX_MEMORY_TYPES>;
 
+    /** @brief The number of buckets in the free block histogram of a FragmentationReport. */
+    constexpr auto FRAGMENTATION_HISTOGRAM_BUCKETS = 24;
+
+    /** @brief A snapshot of how fragmented the free memory of an allocator is. */
+    struct FragmentationReport
+    {
+        /** @brief The total amount of free memory. */
+        u64 freeSpace = 0;
+        /** @brief The size of the largest free block. This is the largest allocation that could currently succeed. */
+        u64 largestFreeBlock = 0;
+        /** @brief The amount of separate free blocks. */
+        u64 freeBlockCount = 0;
+        /**
+         * @brief The amount of free blocks per size range. Bucket 0 holds all blocks smaller than 16 bytes,
+         * bucket i holds all blocks in the range [2^(i + 3), 2^(i + 4)) and the last bucket also holds all blocks that are larger.
+         */
+        u64 histogram[FRAGMENTATION_HISTOGRAM_BUCKETS] = {};
+
+        /** @brief Gets the histogram bucket that a free block of the provided size belongs to. */
+        static constexpr u32 GetBucket(const u64 size)
+        {
+            const u32 width = static_cast<u32>(std::bit_width(size));
+            return width <= 4 ? 0 : std::min<u32>(width - 4, FRAGMENTATION_HISTOGRAM_BUCKETS - 1);
+        }
+
+        /** @brief Gets the fragmentation as a value between 0 (all free memory is one block) and 1 (the free memory is scattered). */
+        [[nodiscard]] f32 GetFragmentation() const
+        {
+            if (freeSpace == 0) return 0.0f;
+            return 1.0f - static_cast<f32>(static_cast<f64>(largestFreeBlock) / static_cast<f64>(freeSpace));
+        }
+    };
+
     struct MemoryStats
     {
         // The type of this allocator
@@ -171,5 +209,13 @@ namespace C3D
         u64 allocCount = 0;
         // An array of all the different types of allocations with stats about each
         TaggedAllocations taggedAllocations{};
+        // Optional callback that adds allocations which are counted lazily by the allocator (e.g. per thread) to these stats
+        void (*flushCallback)(const void* user) = nullptr;
+        const void* flushUser                   = nullptr;
+        // Optional callback that fills out a report about the fragmentation of the free memory of this allocator
+        bool (*fragmentationCallback)(const void* user, FragmentationReport& report) = nullptr;
+        const void* fragmentationUser                                                = nullptr;
+        // The most memory that a single thread has used at once (for allocators that hand out memory per thread)
+        u64 threadHighWaterMarks[MAX_METRICS_THREADS] = {};
     };
 }  // namespace C3D
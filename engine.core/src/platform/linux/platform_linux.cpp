@@ -353,6 +353,15 @@ namespace C3D
         return CopyFileCleanup(CopyFileStatus::Success, sourceFd, destFd);
     }
 
+    bool Platform::GetLastWriteTime(const String& path, u64& outTime)
+    {
+        struct stat info;
+        if (stat(path.Data(), &info) != 0) return false;
+
+        outTime = static_cast<u64>(info.st_mtim.tv_sec) * 1000000000ull + static_cast<u64>(info.st_mtim.tv_nsec);
+        return true;
+    }
+
     FileWatchId Platform::WatchFile(const char* filePath)
     {
         if (!filePath)
@@ -0,0 +1,129 @@
+#include "mapped_file.h"
+
+#include "logger/logger.h"
+
+#ifdef C3D_PLATFORM_WINDOWS
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace C3D
+{
+    MappedFile::~MappedFile() { Close(); }
+
+#ifdef C3D_PLATFORM_WINDOWS
+    bool MappedFile::Open(const String& path)
+    {
+        Close();
+
+        const auto file = CreateFileA(path.Data(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                      FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            ERROR_LOG("Failed to open file: '{}'.", path);
+            return false;
+        }
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size))
+        {
+            ERROR_LOG("Failed to get the size of file: '{}'.", path);
+            CloseHandle(file);
+            return false;
+        }
+
+        m_fileHandle = file;
+        m_size       = static_cast<u64>(size.QuadPart);
+        m_isOpen     = true;
+
+        // Empty files can't be mapped but they are still valid
+        if (m_size == 0) return true;
+
+        const auto mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping)
+        {
+            ERROR_LOG("Failed to create a file mapping for: '{}'.", path);
+            Close();
+            return false;
+        }
+        m_mappingHandle = mapping;
+
+        m_data = static_cast<const u8*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        if (!m_data)
+        {
+            ERROR_LOG("Failed to map a view of: '{}'.", path);
+            Close();
+            return false;
+        }
+
+        return true;
+    }
+
+    void MappedFile::Close()
+    {
+        if (m_data) UnmapViewOfFile(m_data);
+        if (m_mappingHandle) CloseHandle(m_mappingHandle);
+        if (m_fileHandle) CloseHandle(m_fileHandle);
+
+        m_data          = nullptr;
+        m_size          = 0;
+        m_isOpen        = false;
+        m_mappingHandle = nullptr;
+        m_fileHandle    = nullptr;
+    }
+#else
+    bool MappedFile::Open(const String& path)
+    {
+        Close();
+
+        const auto fd = open(path.Data(), O_RDONLY);
+        if (fd == -1)
+        {
+            ERROR_LOG("Failed to open file: '{}'.", path);
+            return false;
+        }
+
+        struct stat info;
+        if (fstat(fd, &info) == -1)
+        {
+            ERROR_LOG("Failed to get the size of file: '{}'.", path);
+            close(fd);
+            return false;
+        }
+
+        m_size   = static_cast<u64>(info.st_size);
+        m_isOpen = true;
+
+        // Empty files can't be mapped but they are still valid
+        if (m_size > 0)
+        {
+            const auto data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data == MAP_FAILED)
+            {
+                ERROR_LOG("Failed to map file: '{}'.", path);
+                close(fd);
+                Close();
+                return false;
+            }
+            m_data = static_cast<const u8*>(data);
+        }
+
+        // The mapping keeps a reference to the file so we can close our file descriptor right away
+        close(fd);
+        return true;
+    }
+
+    void MappedFile::Close()
+    {
+        if (m_data) munmap(const_cast<u8*>(m_data), m_size);
+
+        m_data   = nullptr;
+        m_size   = 0;
+        m_isOpen = false;
+    }
+#endif
+}  // namespace C3D
@@ -0,0 +1,52 @@
+#pragma once
+#include "defines.h"
+#include "string/string.h"
+
+namespace C3D
+{
+    /**
+     * @brief A read-only view of a file that is mapped into memory by the OS.
+     * The contents of the file are only paged in when they are accessed and they are never copied into our own memory,
+     * which makes this ideal for (large) binary files that can be used in place.
+     * The data remains valid until the MappedFile is closed (or destroyed).
+     */
+    class C3D_API MappedFile
+    {
+    public:
+        MappedFile() = default;
+        MappedFile(const MappedFile& other) = delete;
+        MappedFile(MappedFile&& other)      = delete;
+
+        MappedFile& operator=(const MappedFile& other) = delete;
+        MappedFile& operator=(MappedFile&& other)      = delete;
+
+        ~MappedFile();
+
+        /**
+         * @brief Maps the file at the provided path into memory. If this MappedFile was already open it will be closed first.
+         *
+         * @param path The path to the file you want to map
+         * @return True if successful; False otherwise
+         */
+        bool Open(const String& path);
+
+        /** @brief Unmaps the file. All pointers into the data of this file become invalid. */
+        void Close();
+
+        [[nodiscard]] bool IsValid() const { return m_isOpen; }
+
+        /** @brief Gets a pointer to the start of the mapped data. Will be nullptr for empty files. */
+        [[nodiscard]] const u8* GetData() const { return m_data; }
+        /** @brief Gets the size of the mapped file in bytes. */
+        [[nodiscard]] u64 GetSize() const { return m_size; }
+
+    private:
+        const u8* m_data = nullptr;
+        u64 m_size       = 0;
+        bool m_isOpen    = false;
+
+        /** @brief The OS specific handles for the file and it's mapping (only used on platforms that need them after mapping). */
+        void* m_fileHandle    = nullptr;
+        void* m_mappingHandle = nullptr;
+    };
+}  // namespace C3D
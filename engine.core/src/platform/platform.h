@@ -59,6 +59,16 @@ namespace C3D
          */
         C3D_API CopyFileStatus CopyFile(const String& source, const String& dest, bool overwriteIfExists);
 
+        /**
+         * @brief Gets the time at which the file at the provided path was last written to.
+         * The unit depends on the platform so the result should only be compared to other results of this function.
+         *
+         * @param path The path to the file
+         * @param outTime The time at which the file was last written to
+         * @return True if successful, false if the file does not exist (or could not be read)
+         */
+        C3D_API bool GetLastWriteTime(const String& path, u64& outTime);
+
         /**
          * @brief Starts watching the file at the provided filePath for changes.
          *
@@ -438,6 +438,15 @@ namespace C3D
         return CopyFileStatus::Success;
     }
 
+    bool Platform::GetLastWriteTime(const String& path, u64& outTime)
+    {
+        WIN32_FILE_ATTRIBUTE_DATA data;
+        if (!GetFileAttributesExA(path.Data(), GetFileExInfoStandard, &data)) return false;
+
+        outTime = (static_cast<u64>(data.ftLastWriteTime.dwHighDateTime) << 32) | data.ftLastWriteTime.dwLowDateTime;
+        return true;
+    }
+
     FileWatchId Platform::WatchFile(const char* filePath)
     {
         if (!filePath)
@@ -0,0 +1,306 @@
+
+#include "profiler.h"
+
+#include <cstring>
+
+#include "logger/logger.h"
+#include "math/c3d_math.h"
+#include "memory/global_memory_system.h"
+#include "platform/file_system.h"
+#include "platform/platform.h"
+
+namespace C3D
+{
+    /** @brief The buffer of the calling thread. Assigned the first time the thread records an event (or gets a name). */
+    static thread_local ProfileThreadBuffer* t_threadBuffer = nullptr;
+    /** @brief True if the calling thread tried to get a buffer but all slots were taken. */
+    static thread_local bool t_noThreadBuffer = false;
+    /** @brief The number of profiled scopes that the calling thread is currently in. */
+    static thread_local u32 t_profileDepth = 0;
+
+    CpuProfiler* CpuProfiler::s_instance;
+
+    CpuProfiler::CpuProfiler() = default;
+
+    void CpuProfiler::Shutdown()
+    {
+        m_capturing.store(false, std::memory_order_relaxed);
+        m_requestedFrames = 0;
+
+        const auto threadCount = Min(m_threadCount.load(std::memory_order_acquire), PROFILER_MAX_THREADS);
+        for (u32 i = 0; i < threadCount; ++i)
+        {
+            auto& buffer = m_threads[i];
+            if (buffer.ready.load(std::memory_order_acquire))
+            {
+                buffer.ready.store(false, std::memory_order_relaxed);
+                Memory.Free(buffer.events);
+                buffer.events = nullptr;
+            }
+        }
+
+        m_capturePath.Destroy();
+        m_frameStarts.Destroy();
+    }
+
+    bool CpuProfiler::RequestCapture(const u32 frameCount, const String& path)
+    {
+        if (IsCaptureRequested())
+        {
+            ERROR_LOG("A capture is already running.");
+            return false;
+        }
+
+        if (frameCount == 0 || frameCount > PROFILER_MAX_CAPTURE_FRAMES)
+        {
+            ERROR_LOG("FrameCount: {} must be in the range [1, {}].", frameCount, PROFILER_MAX_CAPTURE_FRAMES);
+            return false;
+        }
+
+        if (path.Empty())
+        {
+            ERROR_LOG("Requires a valid path to write the capture to.");
+            return false;
+        }
+
+        m_requestedFrames = frameCount;
+        m_capturePath     = path;
+        return true;
+    }
+
+    void CpuProfiler::BeginFrame()
+    {
+        // Nothing to do if no capture is requested
+        if (m_requestedFrames == 0) return;
+
+        if (!IsCapturing())
+        {
+            // Captures always start at the beginning of a frame
+            StartCapture();
+            m_frameStarts.PushBack(Platform::GetAbsoluteTime());
+            return;
+        }
+
+        // The start of this frame also marks the end of the previous frame
+        m_frameStarts.PushBack(Platform::GetAbsoluteTime());
+        if (m_frameStarts.Size() > m_requestedFrames)
+        {
+            StopCapture();
+        }
+    }
+
+    void CpuProfiler::SetThreadName(const char* name)
+    {
+        if (const auto buffer = GetThreadBuffer())
+        {
+            std::strncpy(buffer->name, name, sizeof(buffer->name) - 1);
+        }
+    }
+
+    void CpuProfiler::Record(const char* name, const f64 start, const f64 end, const u32 depth)
+    {
+        const auto buffer = GetThreadBuffer();
+        if (!buffer) return;
+
+        if (!buffer->events)
+        {
+            // We only allocate the events for threads that actually record something
+            const auto size = sizeof(ProfileEvent) * PROFILER_EVENTS_PER_THREAD;
+            buffer->events  = static_cast<ProfileEvent*>(Memory.AllocateBlock(MemoryType::Engine, size, alignof(ProfileEvent)));
+            buffer->ready.store(true, std::memory_order_release);
+        }
+
+        // Only this thread ever writes head so a relaxed load is enough
+        const auto head = buffer->head.load(std::memory_order_relaxed);
+
+        buffer->events[head & (PROFILER_EVENTS_PER_THREAD - 1)] = { name, start, end, depth };
+        // Publish the event to the capturing thread
+        buffer->head.store(head + 1, std::memory_order_release);
+    }
+
+    CpuProfiler& CpuProfiler::GetInstance()
+    {
+        if (!s_instance)
+        {
+            s_instance = new CpuProfiler();
+        }
+        return *s_instance;
+    }
+
+    ProfileThreadBuffer* CpuProfiler::GetThreadBuffer()
+    {
+        if (t_threadBuffer) return t_threadBuffer;
+        if (t_noThreadBuffer) return nullptr;
+
+        const auto slot = m_threadCount.fetch_add(1, std::memory_order_acq_rel);
+        if (slot >= PROFILER_MAX_THREADS)
+        {
+            WARN_LOG("All {} thread slots are taken. Events from this thread will not be recorded.", PROFILER_MAX_THREADS);
+            t_noThreadBuffer = true;
+            return nullptr;
+        }
+
+        auto& buffer    = m_threads[slot];
+        buffer.threadId = Platform::GetThreadId();
+        fmt::format_to_n(buffer.name, sizeof(buffer.name) - 1, "Thread {}", slot);
+
+        t_threadBuffer = &buffer;
+        return t_threadBuffer;
+    }
+
+    void CpuProfiler::StartCapture()
+    {
+        m_frameStarts.Clear();
+        m_frameStarts.Reserve(m_requestedFrames + 1);
+
+        // Remember where every thread was so we only export the events that were recorded during this capture
+        const auto threadCount = Min(m_threadCount.load(std::memory_order_acquire), PROFILER_MAX_THREADS);
+        for (u32 i = 0; i < threadCount; ++i)
+        {
+            m_threads[i].captureStart = m_threads[i].head.load(std::memory_order_acquire);
+        }
+
+        m_capturing.store(true, std::memory_order_release);
+
+        INFO_LOG("Started capturing {} frames.", m_requestedFrames);
+    }
+
+    void CpuProfiler::StopCapture()
+    {
+        m_capturing.store(false, std::memory_order_release);
+
+        // Remember where every thread was at the end of the capture. Events recorded after this are not part of the capture.
+        DynamicArray<u64> captureEnds(PROFILER_MAX_THREADS);
+        for (u32 i = 0; i < PROFILER_MAX_THREADS; ++i)
+        {
+            captureEnds.PushBack(m_threads[i].head.load(std::memory_order_acquire));
+        }
+
+        if (!WriteChromeTrace(captureEnds))
+        {
+            ERROR_LOG("Failed to write capture to: '{}'.", m_capturePath);
+        }
+
+        m_requestedFrames = 0;
+        m_frameStarts.Clear();
+    }
+
+    static void AppendEscaped(String& json, const char* str)
+    {
+        for (auto c = str; *c; ++c)
+        {
+            if (*c == '"' || *c == '\\') json.Append('\\');
+            json.Append(*c);
+        }
+    }
+
+    bool CpuProfiler::WriteChromeTrace(const DynamicArray<u64>& captureEnds) const
+    {
+        // All timestamps are relative to the start of the first frame and in microseconds (as Chrome traces expect)
+        const auto captureStart = m_frameStarts[0];
+
+        String json;
+        json.Reserve(MebiBytes(1));
+        json.Append(R"({"displayTimeUnit":"ms","traceEvents":[)");
+        json.Append(R"({"name":"thread_name","ph":"M","pid":1,"tid":0,"args":{"name":"Frames"}})");
+
+        // Add our frames on their own track so they are easy to find
+        f64 slowestFrame      = 0;
+        u32 slowestFrameIndex = 0;
+        for (u32 i = 0; i + 1 < m_frameStarts.Size(); ++i)
+        {
+            const auto duration = m_frameStarts[i + 1] - m_frameStarts[i];
+            if (duration > slowestFrame)
+            {
+                slowestFrame      = duration;
+                slowestFrameIndex = i;
+            }
+
+            json.Format(R"(,{{"name":"Frame {}","cat":"frame","ph":"X","pid":1,"tid":0,"ts":{:.3f},"dur":{:.3f}}})", i,
+                        (m_frameStarts[i] - captureStart) * SEC_TO_US_MULTIPLIER, duration * SEC_TO_US_MULTIPLIER);
+        }
+
+        u64 eventCount         = 0;
+        const auto threadCount = Min(m_threadCount.load(std::memory_order_acquire), PROFILER_MAX_THREADS);
+        for (u32 i = 0; i < threadCount; ++i)
+        {
+            const auto& buffer = m_threads[i];
+            // Tid 0 is used for our frames
+            const auto tid = i + 1;
+
+            json.Append(R"(,{"name":"thread_name","ph":"M","pid":1,"tid":)");
+            json.Format(R"({},"args":{{"name":")", tid);
+            AppendEscaped(json, buffer.name);
+            json.Append(R"("}})");
+
+            if (!buffer.ready.load(std::memory_order_acquire)) continue;
+
+            auto start     = buffer.captureStart;
+            const auto end = captureEnds[i];
+            if (end - start > PROFILER_EVENTS_PER_THREAD - PROFILER_RING_SAFETY_MARGIN)
+            {
+                // The ring buffer wrapped around during the capture so the oldest events have been overwritten
+                WARN_LOG("Thread: '{}' recorded {} events which does not fit. Only the newest events are exported.", buffer.name,
+                         end - start);
+                start = end - (PROFILER_EVENTS_PER_THREAD - PROFILER_RING_SAFETY_MARGIN);
+            }
+
+            for (auto e = start; e < end; ++e)
+            {
+                const auto& event = buffer.events[e & (PROFILER_EVENTS_PER_THREAD - 1)];
+
+                json.Append(R"(,{"name":")");
+                AppendEscaped(json, event.name);
+                json.Format(R"(","cat":"cpu","ph":"X","pid":1,"tid":{},"ts":{:.3f},"dur":{:.3f},"args":{{"depth":{}}}}})", tid,
+                            (event.start - captureStart) * SEC_TO_US_MULTIPLIER, (event.end - event.start) * SEC_TO_US_MULTIPLIER,
+                            event.depth);
+            }
+
+            eventCount += end - start;
+        }
+
+        json.Append("]}");
+
+        File file;
+        if (!file.Open(m_capturePath, FileModeWrite | FileModeBinary))
+        {
+            ERROR_LOG("Failed to open: '{}'.", m_capturePath);
+            return false;
+        }
+
+        u64 bytesWritten = 0;
+        if (!file.Write(json.Size(), json.Data(), &bytesWritten))
+        {
+            ERROR_LOG("Failed to write to: '{}'.", m_capturePath);
+            file.Close();
+            return false;
+        }
+
+        file.Close();
+
+        const auto frameCount   = m_frameStarts.Size() - 1;
+        const auto averageFrame = (m_frameStarts[frameCount] - captureStart) / static_cast<f64>(frameCount);
+        INFO_LOG("Captured {} frames with {} events to: '{}'. Average frame: {:.3f}ms, slowest frame: #{} with {:.3f}ms.", frameCount,
+                 eventCount, m_capturePath, averageFrame * SEC_TO_MS_MULTIPLIER, slowestFrameIndex, slowestFrame * SEC_TO_MS_MULTIPLIER);
+        return true;
+    }
+
+    ProfileScope::ProfileScope(const char* name) : m_name(name)
+    {
+        // We only record scopes that start while we are capturing
+        if (Profiler.IsCapturing())
+        {
+            m_start = Platform::GetAbsoluteTime();
+            t_profileDepth++;
+        }
+    }
+
+    ProfileScope::~ProfileScope()
+    {
+        if (m_start != 0)
+        {
+            t_profileDepth--;
+            Profiler.Record(m_name, m_start, Platform::GetAbsoluteTime(), t_profileDepth);
+        }
+    }
+}  // namespace C3D
@@ -0,0 +1,155 @@
+
+#pragma once
+#include <atomic>
+
+#include "containers/dynamic_array.h"
+#include "defines.h"
+#include "string/string.h"
+
+namespace C3D
+{
+#define Profiler C3D::CpuProfiler::GetInstance()
+
+#define C3D_PROFILE_CONCAT_INTERNAL(a, b) a##b
+#define C3D_PROFILE_CONCAT(a, b) C3D_PROFILE_CONCAT_INTERNAL(a, b)
+
+#ifdef C3D_PROFILING
+/** @brief Profiles the enclosing scope. The name must be a string literal (or otherwise outlive the capture). */
+#define C3D_PROFILE_SCOPE(name) C3D::ProfileScope C3D_PROFILE_CONCAT(profileScope, __LINE__)(name)
+/** @brief Profiles the enclosing function. */
+#define C3D_PROFILE_FUNCTION() C3D_PROFILE_SCOPE(__FUNCTION__)
+/** @brief Marks the start of a new frame. Should be called once per frame on the main thread. */
+#define C3D_PROFILE_FRAME() Profiler.BeginFrame()
+/** @brief Gives the calling thread a name that is shown in the captures. */
+#define C3D_PROFILE_THREAD(name) Profiler.SetThreadName(name)
+#else
+#define C3D_PROFILE_SCOPE(name)
+#define C3D_PROFILE_FUNCTION()
+#define C3D_PROFILE_FRAME()
+#define C3D_PROFILE_THREAD(name)
+#endif
+
+    /** @brief The maximum number of threads that can record profile events. Events from other threads are dropped. */
+    constexpr u32 PROFILER_MAX_THREADS = 64;
+    /** @brief The number of events that fit in the ring buffer of a single thread. Must be a power of 2. */
+    constexpr u64 PROFILER_EVENTS_PER_THREAD = 32768;
+    /** @brief The number of events at the start of a full ring buffer that we skip since they can be overwritten while we export. */
+    constexpr u64 PROFILER_RING_SAFETY_MARGIN = 256;
+    /** @brief The maximum number of frames that can be captured at once. */
+    constexpr u32 PROFILER_MAX_CAPTURE_FRAMES = 1024;
+
+    static_assert((PROFILER_EVENTS_PER_THREAD & (PROFILER_EVENTS_PER_THREAD - 1)) == 0, "Events per thread must be a power of 2.");
+
+    struct ProfileEvent
+    {
+        /** @brief The name of the profiled scope. */
+        const char* name;
+        /** @brief The time (in seconds) at which the scope started. */
+        f64 start;
+        /** @brief The time (in seconds) at which the scope ended. */
+        f64 end;
+        /** @brief The number of profiled scopes that this scope is nested in. */
+        u32 depth;
+    };
+
+    /**
+     * @brief A single producer ring buffer of ProfileEvents. Only the owning thread writes events (without any locks).
+     * The capturing thread only reads the events that were published (by the release store of head).
+     */
+    struct alignas(64) ProfileThreadBuffer
+    {
+        /** @brief The events recorded by this thread. */
+        ProfileEvent* events = nullptr;
+        /** @brief The total number of events that were ever written to this buffer. */
+        std::atomic<u64> head = 0;
+        /** @brief The value of head at the moment the current capture started. */
+        u64 captureStart = 0;
+        /** @brief The id of the thread that owns this buffer. */
+        u64 threadId = 0;
+        /** @brief The name of the thread that owns this buffer. */
+        char name[32] = {};
+        /** @brief Set once events has been allocated so other threads can safely read this buffer. */
+        std::atomic<bool> ready = false;
+    };
+
+    /**
+     * @brief A low-overhead, multi-threaded CPU profiler.
+     * Profiled scopes are only recorded while a capture is running. Every thread records into it's own ring buffer so recording never
+     * takes a lock. A capture starts at the next frame marker and runs for the requested number of frames after which it is written to a
+     * Chrome trace (JSON) file that can be opened in chrome://tracing or https://ui.perfetto.dev.
+     */
+    class C3D_API CpuProfiler
+    {
+        static CpuProfiler* s_instance;
+
+    public:
+        CpuProfiler();
+
+        void Shutdown();
+
+        /**
+         * @brief Requests a capture of the next frameCount frames.
+         *
+         * @param frameCount The number of frames that should be captured (at most PROFILER_MAX_CAPTURE_FRAMES)
+         * @param path The path of the Chrome trace file that the capture will be written to
+         * @return True if the capture was requested, False if a capture is already running or the arguments are invalid
+         */
+        bool RequestCapture(u32 frameCount, const String& path);
+
+        /** @brief Marks the start of a new frame. Starts and stops the requested captures. Must be called from the main thread. */
+        void BeginFrame();
+
+        /** @brief Gives the calling thread a name that is shown in the captures. */
+        void SetThreadName(const char* name);
+
+        /** @brief Records a profiled scope for the calling thread. */
+        void Record(const char* name, f64 start, f64 end, u32 depth);
+
+        [[nodiscard]] bool IsCapturing() const { return m_capturing.load(std::memory_order_relaxed); }
+        [[nodiscard]] bool IsCaptureRequested() const { return m_requestedFrames > 0; }
+
+        static CpuProfiler& GetInstance();
+
+    private:
+        /** @brief Gets the buffer of the calling thread. Creates it if this thread has never recorded before. */
+        ProfileThreadBuffer* GetThreadBuffer();
+
+        void StartCapture();
+        void StopCapture();
+
+        bool WriteChromeTrace(const DynamicArray<u64>& captureEnds) const;
+
+        /** @brief The ring buffers for every thread that has recorded an event. */
+        ProfileThreadBuffer m_threads[PROFILER_MAX_THREADS];
+        /** @brief The number of slots in m_threads that have been handed out. */
+        std::atomic<u32> m_threadCount = 0;
+
+        /** @brief True while a capture is running. */
+        std::atomic<bool> m_capturing = false;
+        /** @brief The number of frames that should be captured. 0 if no capture is requested or running. */
+        u32 m_requestedFrames = 0;
+        /** @brief The path that the current capture will be written to. */
+        String m_capturePath;
+        /** @brief The start times of every frame in the current capture. */
+        DynamicArray<f64> m_frameStarts;
+    };
+
+    /** @brief Records the time between it's construction and destruction (if a capture was running when it was constructed). */
+    class C3D_API ProfileScope
+    {
+    public:
+        explicit ProfileScope(const char* name);
+
+        ProfileScope(const ProfileScope&) = delete;
+        ProfileScope(ProfileScope&&)      = delete;
+
+        ProfileScope& operator=(const ProfileScope&) = delete;
+        ProfileScope& operator=(ProfileScope&&)      = delete;
+
+        ~ProfileScope();
+
+    private:
+        const char* m_name;
+        f64 m_start = 0;
+    };
+}  // namespace C3D
@@ -411,6 +411,9 @@ struct fmt::formatter<C3D::CString<CCapacity>>
 template <u64 CCapacity>
 struct std::hash<C3D::CString<CCapacity>>
 {
+    /** @brief Allows HashMaps that support it to lookup keys with a const char* without having to construct a temporary string. */
+    using is_transparent = void;
+
     size_t operator()(const C3D::CString<CCapacity>& key) const noexcept
     {
         size_t hash = 0;
@@ -421,4 +424,16 @@ struct std::hash<C3D::CString<CCapacity>>
         }
         return hash;
     }
+
+    /** @brief Hashes a null-terminated string. Gives the exact same hash as the string overload for the same characters. */
+    size_t operator()(const char* key) const noexcept
+    {
+        size_t hash = 0;
+        for (; *key; ++key)
+        {
+            hash ^= static_cast<size_t>(*key);
+            hash *= FNV_PRIME;
+        }
+        return hash;
+    }
 };
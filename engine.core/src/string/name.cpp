@@ -0,0 +1,193 @@
+#include "name.h"
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <shared_mutex>
+
+#include "containers/flat_hash_map.h"
+#include "memory/allocators/malloc_allocator.h"
+
+namespace C3D
+{
+    /** @brief The number of entries in a block is 2^NAME_TABLE_BLOCK_SHIFT. */
+    constexpr u32 NAME_TABLE_BLOCK_SHIFT = 12;
+    constexpr u32 NAME_TABLE_BLOCK_SIZE  = 1 << NAME_TABLE_BLOCK_SHIFT;
+    constexpr u32 NAME_TABLE_BLOCK_MASK  = NAME_TABLE_BLOCK_SIZE - 1;
+    /** @brief The maximum number of blocks (so we can store up to 4M unique names). */
+    constexpr u32 NAME_TABLE_MAX_BLOCKS = 1024;
+    /** @brief The size of the chunks of memory that we store the characters of our names in. */
+    constexpr u64 NAME_TABLE_CHUNK_SIZE = 64 * 1024;
+
+    struct NameEntry
+    {
+        /** @brief The hash of the characters of this name. */
+        u64 hash = 0;
+        /** @brief The (null-terminated) characters of this name. */
+        const char* str = nullptr;
+        /** @brief The number of characters (without the null-terminator). */
+        u32 length = 0;
+        /** @brief The id of the next entry with the same hash or 0 if there is none. */
+        u32 next = 0;
+    };
+
+    /**
+     * @brief The global table that stores all our interned names.
+     * Entries are stored in fixed size blocks that never move, which means that entries can be read without taking a lock
+     * (an id is only handed out once it's entry has been written). Only finding and adding names requires a lock.
+     * All memory comes from malloc so names can be used before the memory system is initialized and after it has been destroyed.
+     */
+    class NameTable
+    {
+    public:
+        NameTable() : m_hashToId(MallocAllocator::GetDefault())
+        {
+            m_hashToId.Create(NAME_TABLE_BLOCK_SIZE);
+            // The first entry is always the empty string
+            Add("", 0, HashName("", 0));
+        }
+
+        u32 Find(const char* str, const u32 length, const u64 hash) const
+        {
+            std::shared_lock lock(m_mutex);
+            return FindInternal(str, length, hash);
+        }
+
+        u32 Intern(const char* str, const u32 length, const u64 hash)
+        {
+            if (length == 0) return 0;
+
+            // Most of the time the name will already exist so we first try to find it while only holding a shared lock
+            if (const auto id = Find(str, length, hash)) return id;
+
+            std::unique_lock lock(m_mutex);
+            // Another thread could have added the same name in between releasing the shared lock and acquiring the unique lock
+            if (const auto id = FindInternal(str, length, hash)) return id;
+            return Add(str, length, hash);
+        }
+
+        const NameEntry& GetEntry(const u32 id) const { return m_blocks[id >> NAME_TABLE_BLOCK_SHIFT][id & NAME_TABLE_BLOCK_MASK]; }
+
+    private:
+        u32 FindInternal(const char* str, const u32 length, const u64 hash) const
+        {
+            const auto first = m_hashToId.Find(hash);
+            if (!first) return 0;
+
+            // Walk all the entries with the same hash until we find the one with our characters
+            for (u32 id = *first; id != 0; id = GetEntry(id).next)
+            {
+                const auto& entry = GetEntry(id);
+                if (entry.length == length && std::memcmp(entry.str, str, length) == 0) return id;
+            }
+            return 0;
+        }
+
+        u32 Add(const char* str, const u32 length, const u64 hash)
+        {
+            const auto id    = m_count;
+            const auto block = id >> NAME_TABLE_BLOCK_SHIFT;
+            if (block >= NAME_TABLE_MAX_BLOCKS)
+            {
+                FATAL_LOG("Exceeded the maximum of: {} unique names.", NAME_TABLE_MAX_BLOCKS * NAME_TABLE_BLOCK_SIZE);
+            }
+
+            if (!m_blocks[block])
+            {
+                m_blocks[block] = MallocAllocator::GetDefault()->Allocate<NameEntry>(MemoryType::String, NAME_TABLE_BLOCK_SIZE);
+            }
+
+            auto& entry  = m_blocks[block][id & NAME_TABLE_BLOCK_MASK];
+            entry.hash   = hash;
+            entry.str    = CopyCharacters(str, length);
+            entry.length = length;
+            entry.next   = 0;
+
+            // Names with the same hash are chained together (the newest entry is stored in the map and points to the older ones)
+            if (const auto existing = m_hashToId.Find(hash))
+            {
+                entry.next = *existing;
+                *existing  = id;
+            }
+            else if (id != 0)
+            {
+                m_hashToId.Set(hash, id);
+            }
+
+            m_count++;
+            return id;
+        }
+
+        const char* CopyCharacters(const char* str, const u32 length)
+        {
+            const u64 size = length + 1;
+            if (size > m_chunkRemaining)
+            {
+                // Names that don't fit in a chunk get a chunk of their own
+                const auto chunkSize = std::max(size, NAME_TABLE_CHUNK_SIZE);
+                m_chunk              = MallocAllocator::GetDefault()->Allocate<char>(MemoryType::String, chunkSize);
+                m_chunkRemaining     = chunkSize;
+            }
+
+            const auto result = m_chunk;
+            std::memcpy(result, str, length);
+            result[length] = '\0';
+
+            m_chunk += size;
+            m_chunkRemaining -= size;
+            return result;
+        }
+
+        /** @brief Blocks of entries. The id of a name is the index of it's entry (over all blocks). */
+        NameEntry* m_blocks[NAME_TABLE_MAX_BLOCKS] = {};
+        /** @brief The number of entries that are in use. */
+        u32 m_count = 0;
+
+        /** @brief The chunk that we are currently copying the characters of new names into. */
+        char* m_chunk = nullptr;
+        /** @brief The number of bytes that are still available in the current chunk. */
+        u64 m_chunkRemaining = 0;
+
+        /** @brief Maps the hash of a name to the id of the (newest) entry with that hash. */
+        FlatHashMap<u64, u32, std::hash<u64>, FLAT_HASH_MAP_DEFAULT_LOAD_FACTOR, MallocAllocator> m_hashToId;
+
+        mutable std::shared_mutex m_mutex;
+    };
+
+    static NameTable& GetNameTable()
+    {
+        // NOTE: The table is never destroyed since names must stay valid for the lifetime of the application
+        static auto table = new NameTable();
+        return *table;
+    }
+
+    Name::Name(const char* str) : Name(str, static_cast<u32>(std::strlen(str))) {}
+
+    Name::Name(const char* str, const u32 length) : m_id(GetNameTable().Intern(str, length, HashName(str, length))) {}
+
+    Name::Name(const String& str) : Name(str.Data(), static_cast<u32>(str.Size())) {}
+
+    Name::Name(const NameLiteral& literal) : m_id(GetNameTable().Intern(literal.str, literal.length, literal.hash)) {}
+
+    Name Name::Find(const char* str)
+    {
+        const auto length = static_cast<u32>(std::strlen(str));
+
+        Name name;
+        name.m_id = GetNameTable().Find(str, length, HashName(str, length));
+        return name;
+    }
+
+    Name Name::Find(const String& str)
+    {
+        Name name;
+        name.m_id = GetNameTable().Find(str.Data(), static_cast<u32>(str.Size()), HashName(str.Data(), str.Size()));
+        return name;
+    }
+
+    u64 Name::GetHash() const { return GetNameTable().GetEntry(m_id).hash; }
+
+    const char* Name::Data() const { return GetNameTable().GetEntry(m_id).str; }
+
+    u32 Name::Size() const { return GetNameTable().GetEntry(m_id).length; }
+}  // namespace C3D
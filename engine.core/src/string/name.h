@@ -0,0 +1,113 @@
+#pragma once
+#include <fmt/format.h>
+
+#include "defines.h"
+#include "string.h"
+
+namespace C3D
+{
+    /**
+     * @brief Hashes the provided characters. This is the same hash that std::hash<String> uses and it can be evaluated at compile time.
+     *
+     * @param str The characters you want to hash
+     * @param length The number of characters
+     * @return The hash of the characters
+     */
+    constexpr u64 HashName(const char* str, const u64 length)
+    {
+        u64 hash = 0;
+        for (u64 i = 0; i < length; ++i)
+        {
+            hash ^= static_cast<u64>(str[i]);
+            hash *= FNV_PRIME;
+        }
+        return hash;
+    }
+
+    /** @brief A string literal together with it's hash (calculated at compile time). Created by using the _name literal. */
+    struct NameLiteral
+    {
+        const char* str = nullptr;
+        u32 length      = 0;
+        u64 hash        = 0;
+    };
+
+    /** @brief Creates a NameLiteral for the provided string literal with it's hash calculated at compile time. */
+    consteval NameLiteral operator""_name(const char* str, const std::size_t length)
+    {
+        return NameLiteral{ str, static_cast<u32>(length), HashName(str, length) };
+    }
+
+    /**
+     * @brief An interned string. Every unique string is stored exactly once in a global (thread-safe) table and a Name is simply the
+     * 32-bit id of it's entry in that table. This makes copying and comparing Names as cheap as copying and comparing integers.
+     * The characters of a Name are stored for the lifetime of the application so it's id and Data() pointer remain valid forever.
+     * The default Name (id 0) is the empty string.
+     *
+     * Constructing a Name from a string requires a lookup in the global table so for per-frame lookups you should create the Name once
+     * (for example as a static) and reuse it. For literals the hash can be calculated at compile time by using: "MyName"_name.
+     */
+    class C3D_API Name
+    {
+    public:
+        constexpr Name() = default;
+
+        Name(const char* str);
+        Name(const char* str, u32 length);
+        Name(const String& str);
+        Name(const NameLiteral& literal);
+
+        /**
+         * @brief Finds the Name for the provided string without interning it.
+         *
+         * @param str The string you want to find the Name for
+         * @return The Name for the provided string or the empty Name if the string was never interned
+         */
+        static Name Find(const char* str);
+        static Name Find(const String& str);
+
+        /** @brief Gets the id of this Name. Ids are stable for the lifetime of the application. */
+        u32 GetId() const { return m_id; }
+        /** @brief Gets the (precomputed) hash of the characters of this Name. */
+        u64 GetHash() const;
+
+        /** @brief Gets a pointer to the (null-terminated) characters of this Name. */
+        const char* Data() const;
+        /** @brief Gets the number of characters in this Name (without the null-terminator). */
+        u32 Size() const;
+
+        bool Empty() const { return m_id == 0; }
+
+        bool operator==(const Name other) const { return m_id == other.m_id; }
+        bool operator!=(const Name other) const { return m_id != other.m_id; }
+
+    private:
+        u32 m_id = 0;
+    };
+}  // namespace C3D
+
+template <>
+struct fmt::formatter<C3D::Name>
+{
+    template <typename ParseContext>
+    constexpr auto parse(ParseContext& ctx)
+    {
+        return ctx.begin();
+    }
+
+    template <typename FormatContext>
+    auto format(const C3D::Name& name, FormatContext& ctx)
+    {
+        return fmt::format_to(ctx.out(), "{}", name.Data());
+    }
+};
+
+namespace std
+{
+    template <>
+    struct hash<C3D::Name>
+    {
+        /** @brief Names are unique so their id is a perfect hash (our HashMaps mix the bits of the hash themselves). */
+        std::size_t operator()(const C3D::Name& name) const { return name.GetId(); }
+    };
+}  // namespace std
@@ -1382,6 +1382,9 @@ struct fmt::formatter<C3D::BasicString<Allocator>>
 template <class Allocator>
 struct std::hash<C3D::BasicString<Allocator>>
 {
+    /** @brief Allows HashMaps that support it to lookup keys with a const char* without having to construct a temporary string. */
+    using is_transparent = void;
+
     size_t operator()(const C3D::BasicString<Allocator>& key) const noexcept
     {
         size_t hash = 0;
@@ -1392,4 +1395,16 @@ struct std::hash<C3D::BasicString<Allocator>>
         }
         return hash;
     }
+
+    /** @brief Hashes a null-terminated string. Gives the exact same hash as the string overload for the same characters. */
+    size_t operator()(const char* key) const noexcept
+    {
+        size_t hash = 0;
+        for (; *key; ++key)
+        {
+            hash ^= static_cast<size_t>(*key);
+            hash *= FNV_PRIME;
+        }
+        return hash;
+    }
 };
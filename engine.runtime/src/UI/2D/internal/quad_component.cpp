@@ -32,7 +32,7 @@ namespace C3D::UI_2D
         TextureMap* maps[1] = { &UI2D.GetAtlas() };
 
         ShaderInstanceUniformTextureConfig textureConfig;
-        textureConfig.uniformLocation = shader.GetUniformIndex("diffuseTexture");
+        textureConfig.uniformLocation = shader.GetUniformIndex("diffuseTexture"_name);
         textureConfig.textureMaps     = maps;
 
         ShaderInstanceResourceConfig instanceConfig;
@@ -65,7 +65,7 @@ namespace C3D::UI_2D
         TextureMap* maps[1] = { &Fonts.GetFontData(font).atlas };
 
         ShaderInstanceUniformTextureConfig textureConfig;
-        textureConfig.uniformLocation = shader.GetUniformIndex("diffuseTexture");
+        textureConfig.uniformLocation = shader.GetUniformIndex("diffuseTexture"_name);
         textureConfig.textureMaps     = maps;
 
         ShaderInstanceResourceConfig instanceConfig;
@@ -2,6 +2,7 @@
 #include "ui_pass.h"
 
 #include "UI/2D/component.h"
+#include "frame_data.h"
 #include "renderer/camera.h"
 #include "renderer/geometry.h"
 #include "renderer/renderer_frontend.h"
@@ -23,7 +24,7 @@ namespace C3D
 {
     UI2DPass::UI2DPass() : Renderpass("UI") {}
 
-    bool UI2DPass::Initialize(const C3D::LinearAllocator* frameAllocator)
+    bool UI2DPass::Initialize(const C3D::FrameAllocator* frameAllocator)
     {
         C3D::RenderpassConfig pass;
         pass.name       = "RenderPass.UI";
@@ -87,12 +88,28 @@ namespace C3D
         return true;
     }
 
-    void UI2DPass::Prepare(const Viewport& viewport, UI_2D::Component* components, u32 numberOfComponents)
+    void UI2DPass::Prepare(const FrameData& frameData, const Viewport& viewport, UI_2D::Component* components, u32 numberOfComponents)
     {
         m_viewport           = &viewport;
         m_pComponents        = components;
         m_numberOfComponents = numberOfComponents;
-        m_prepared           = true;
+
+        m_renderItems     = frameData.allocator->Allocate<RenderSortItem>(MemoryType::Array, static_cast<u64>(numberOfComponents) * 2);
+        m_renderItemCount = 0;
+
+        for (u32 i = 0; i < numberOfComponents; ++i)
+        {
+            const auto& component = components[i];
+            if (component.IsValid() && component.IsFlagSet(UI_2D::FlagVisible))
+            {
+                // We render without depth testing so the order of our components is the (painter's) order in which they must be rendered
+                m_renderItems[m_renderItemCount++] = { RenderSort::MakeOrderedKey(RenderSortPass::UI, i), i };
+            }
+        }
+
+        RenderSort::SortItems(m_renderItems, m_renderItems + numberOfComponents, m_renderItemCount);
+
+        m_prepared = true;
     }
 
     bool UI2DPass::Execute(const C3D::FrameData& frameData)
@@ -124,13 +141,10 @@ namespace C3D
         m_shader->frameNumber = frameData.frameNumber;
         m_shader->drawIndex   = frameData.drawIndex;
 
-        for (u32 i = 0; i < m_numberOfComponents; ++i)
+        for (u32 i = 0; i < m_renderItemCount; ++i)
         {
-            auto& component = m_pComponents[i];
-            if (component.IsValid() && component.IsFlagSet(UI_2D::FlagVisible))
-            {
-                component.onRender(component, frameData, m_locations);
-            }
+            auto& component = m_pComponents[m_renderItems[i].index];
+            component.onRender(component, frameData, m_locations);
         }
 
         End();
@@ -5,7 +5,8 @@
 #include "containers/dynamic_array.h"
 #include "containers/handle_table.h"
 #include "defines.h"
-#include "memory/allocators/linear_allocator.h"
+#include "memory/allocators/frame_allocator.h"
+#include "renderer/render_sort.h"
 #include "renderer/renderer_types.h"
 #include "renderer/rendergraph/renderpass.h"
 
@@ -18,8 +19,8 @@ namespace C3D
     public:
         UI2DPass();
 
-        bool Initialize(const LinearAllocator* frameAllocator) override;
-        void Prepare(const Viewport& viewport, UI_2D::Component* components, u32 numberOfComponents);
+        bool Initialize(const FrameAllocator* frameAllocator) override;
+        void Prepare(const FrameData& frameData, const Viewport& viewport, UI_2D::Component* components, u32 numberOfComponents);
         bool Execute(const FrameData& frameData) override;
 
     private:
@@ -28,5 +29,9 @@ namespace C3D
 
         UI_2D::Component* m_pComponents = nullptr;
         u32 m_numberOfComponents        = 0;
+
+        /** @brief The visible components in the order that they should be rendered. Allocated from the frame allocator. */
+        RenderSortItem* m_renderItems = nullptr;
+        u32 m_renderItemCount         = 0;
     };
 }  // namespace C3D
\ No newline at end of file
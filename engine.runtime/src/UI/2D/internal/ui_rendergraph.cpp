@@ -75,7 +75,7 @@ namespace C3D
             ERROR_LOG("Failed to prepare UI2D components for rendering.");
         }
 
-        m_uiPass.Prepare(viewport, UI2D.GetComponents(), UI2D.GetNumberOfComponents());
+        m_uiPass.Prepare(frameData, viewport, UI2D.GetComponents(), UI2D.GetNumberOfComponents());
 
         return true;
     }
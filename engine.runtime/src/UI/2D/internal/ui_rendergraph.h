@@ -7,7 +7,7 @@ namespace C3D
 {
     struct UI2DRendergraphConfig
     {
-        const LinearAllocator* pFrameAllocator = nullptr;
+        const FrameAllocator* pFrameAllocator = nullptr;
     };
 
     class C3D_API UI2DRendergraph : public Rendergraph<UI2DRendergraphConfig>
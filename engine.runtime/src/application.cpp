@@ -45,6 +45,21 @@ namespace C3D
         m_appConfig.windowConfigs.PushBack(windowConfig);
     }
 
+    void Application::ParseHeadlessConfig(const CSONObject& config)
+    {
+        for (const auto& prop : config.properties)
+        {
+            if (prop.name.IEquals("frames"))
+            {
+                m_appConfig.headlessFrameCount = static_cast<u32>(prop.GetI64());
+            }
+            else if (prop.name.IEquals("report"))
+            {
+                m_appConfig.headlessReportPath = prop.GetString();
+            }
+        }
+    }
+
     Application::Application(ApplicationState* state)
     {
         CSONReader reader;
@@ -72,6 +87,10 @@ namespace C3D
                     ParseWindowConfig(config.GetObject());
                 }
             }
+            else if (property.name.IEquals("headless"))
+            {
+                ParseHeadlessConfig(property.GetObject());
+            }
             else if (property.name.IEquals("systemconfigs"))
             {
                 const auto& systemConfigs = property.GetArray();
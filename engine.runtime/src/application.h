@@ -31,6 +31,10 @@ namespace C3D
         DynamicArray<WindowConfig> windowConfigs;
         /** @brief A Hashmap containing CSONObjects with the configuration for a system. Indexable by the name of the system. */
         HashMap<String, CSONObject> systemConfigs;
+        /** @brief The number of frames to run without user interaction before quitting. 0 means we run the normal (interactive) loop. */
+        u32 headlessFrameCount = 0;
+        /** @brief The path to the CSV file that will receive the per-frame timings of a headless run. */
+        String headlessReportPath;
     };
 
     /** @brief An empty struct to hold the ApplicationState that can be defined by the user. */
@@ -69,6 +73,7 @@ namespace C3D
 
     private:
         void ParseWindowConfig(const CSONObject& config);
+        void ParseHeadlessConfig(const CSONObject& config);
 
     protected:
         ApplicationConfig m_appConfig;
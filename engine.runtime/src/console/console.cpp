@@ -2,6 +2,7 @@
 #include "console.h"
 
 #include "platform/platform.h"
+#include "profiler/profiler.h"
 #include "string/string_utils.h"
 #include "systems/UI/2D/ui2d_system.h"
 #include "systems/cvars/cvar_system.h"
@@ -342,6 +343,35 @@ namespace C3D
             output += "Shutting down";
             return true;
         });
+        RegisterCommand("profile",
+                        [this](const DynamicArray<ArgName>& args, String& output) { return OnProfileCommand(args, output); });
         CVars.RegisterDefaultCommands(this);
     }
+
+    bool UIConsole::OnProfileCommand(const DynamicArray<ArgName>& args, String& output) const
+    {
+#ifdef C3D_PROFILING
+        // profile capture frameCount [ path ]
+        if (args.Size() < 3 || args.Size() > 4 || !(args[1] == "capture"))
+        {
+            output = "Usage: profile capture <frameCount> [path]";
+            return false;
+        }
+
+        const auto frameCount = args[2].ToU32();
+        const auto path       = args.Size() == 4 ? String(args[3].Data()) : String::FromFormat("profile_capture_{}.json", frameCount);
+
+        if (!Profiler.RequestCapture(frameCount, path))
+        {
+            output = String::FromFormat("Failed to start a capture of {} frames", frameCount);
+            return false;
+        }
+
+        output = String::FromFormat("Capturing the next {} frames to: '{}'", frameCount, path);
+        return true;
+#else
+        output = "Profiling is disabled in this build (compile with C3D_PROFILING)";
+        return false;
+#endif
+    }
 }  // namespace C3D
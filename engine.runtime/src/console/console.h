@@ -49,6 +49,8 @@ namespace C3D
 
         void RegisterDefaultCommands();
 
+        bool OnProfileCommand(const DynamicArray<ArgName>& args, String& output) const;
+
         void WriteLineInternal(const CString<256>& line);
 
         bool OnKeyDownEvent(u16 code, void* sender, const EventContext& context);
@@ -0,0 +1,135 @@
+#include "archetype.h"
+
+#include "memory/global_memory_system.h"
+
+namespace C3D
+{
+    void Archetype::Create(const ComponentMask& mask, const ComponentInfo* componentInfos)
+    {
+        m_mask           = mask;
+        m_componentInfos = componentInfos;
+
+        u64 rowSize = sizeof(Entity);
+        for (ComponentID id = 0; id < MAX_COMPONENTS_TYPES; ++id)
+        {
+            if (mask.test(id))
+            {
+                m_componentIds.PushBack(id);
+                rowSize += componentInfos[id].size;
+            }
+        }
+
+        // Fit as many entities in a chunk as possible (taking the alignment of every component array into account)
+        m_capacity = std::max<u32>(static_cast<u32>(ARCHETYPE_CHUNK_SIZE / rowSize), 1);
+        while (true)
+        {
+            u64 offset = sizeof(Entity) * m_capacity;
+            for (const auto id : m_componentIds)
+            {
+                offset        = GetAligned(offset, ARCHETYPE_CHUNK_ALIGNMENT);
+                m_offsets[id] = static_cast<u32>(offset);
+                offset += static_cast<u64>(componentInfos[id].size) * m_capacity;
+            }
+
+            if (offset <= ARCHETYPE_CHUNK_SIZE || m_capacity == 1)
+            {
+                // NOTE: If a single entity does not fit in a chunk we make our chunks larger
+                m_chunkSize = std::max(offset, ARCHETYPE_CHUNK_SIZE);
+                break;
+            }
+
+            m_capacity--;
+        }
+    }
+
+    void Archetype::Destroy()
+    {
+        for (u32 chunk = 0; chunk < m_chunkCount; ++chunk)
+        {
+            for (u32 row = 0; row < m_chunks[chunk].count; ++row)
+            {
+                DestructComponents(chunk, row);
+            }
+        }
+
+        for (auto& chunk : m_chunks)
+        {
+            Memory.Free(chunk.memory);
+        }
+
+        m_chunks.Destroy();
+        m_componentIds.Destroy();
+
+        m_chunkCount  = 0;
+        m_entityCount = 0;
+    }
+
+    u32 Archetype::AddEntity(const Entity entity, u32& outChunk)
+    {
+        if (m_chunkCount == 0 || m_chunks[m_chunkCount - 1].count == m_capacity)
+        {
+            // The last chunk is full so we start using a new one (reusing an empty chunk if we have one)
+            if (m_chunkCount == m_chunks.Size())
+            {
+                ArchetypeChunk chunk;
+                chunk.memory = static_cast<u8*>(Memory.AllocateBlock(MemoryType::ECS, m_chunkSize, ARCHETYPE_CHUNK_ALIGNMENT));
+                m_chunks.PushBack(chunk);
+            }
+            m_chunkCount++;
+        }
+
+        outChunk       = m_chunkCount - 1;
+        auto& chunk    = m_chunks[outChunk];
+        const auto row = chunk.count++;
+
+        GetEntities(outChunk)[row] = entity;
+        m_entityCount++;
+
+        return row;
+    }
+
+    Entity Archetype::RemoveEntity(const u32 chunk, const u32 row)
+    {
+        const auto lastChunk = m_chunkCount - 1;
+        const auto lastRow   = m_chunks[lastChunk].count - 1;
+
+        auto moved = Entity::Invalid();
+        if (chunk != lastChunk || row != lastRow)
+        {
+            // Move the last entity into the empty row to keep our chunks tightly packed
+            moved                   = GetEntities(lastChunk)[lastRow];
+            GetEntities(chunk)[row] = moved;
+
+            for (const auto id : m_componentIds)
+            {
+                m_componentInfos[id].move(GetComponent(chunk, row, id), GetComponent(lastChunk, lastRow, id));
+            }
+        }
+
+        m_chunks[lastChunk].count--;
+        if (m_chunks[lastChunk].count == 0)
+        {
+            // The last chunk is empty so we stop using it (we keep the memory around for reuse)
+            m_chunkCount--;
+        }
+
+        m_entityCount--;
+        return moved;
+    }
+
+    void Archetype::ConstructComponents(const u32 chunk, const u32 row) const
+    {
+        for (const auto id : m_componentIds)
+        {
+            m_componentInfos[id].construct(GetComponent(chunk, row, id));
+        }
+    }
+
+    void Archetype::DestructComponents(const u32 chunk, const u32 row) const
+    {
+        for (const auto id : m_componentIds)
+        {
+            m_componentInfos[id].destruct(GetComponent(chunk, row, id));
+        }
+    }
+}  // namespace C3D
@@ -0,0 +1,141 @@
+#pragma once
+#include "containers/dynamic_array.h"
+#include "ecs_types.h"
+#include "entity.h"
+
+namespace C3D
+{
+    /** @brief The size of the memory block of a single archetype chunk. */
+    constexpr u64 ARCHETYPE_CHUNK_SIZE = KibiBytes(16);
+    /** @brief The alignment of every component array inside of a chunk. Large enough for aligned SIMD loads. */
+    constexpr u64 ARCHETYPE_CHUNK_ALIGNMENT = 64;
+
+    /** @brief Type-erased information about a component type. Used by archetypes to construct, move and destroy components. */
+    struct ComponentInfo
+    {
+        u32 size      = 0;
+        u32 alignment = 0;
+
+        /** @brief Default constructs a component at the provided address. */
+        void (*construct)(void* component) = nullptr;
+        /** @brief Destroys the component at the provided address. */
+        void (*destruct)(void* component) = nullptr;
+        /** @brief Move constructs a component at dst from src and destroys src afterwards. */
+        void (*move)(void* dst, void* src) = nullptr;
+
+        [[nodiscard]] bool IsValid() const { return size != 0; }
+
+        template <typename Type>
+        static ComponentInfo Create()
+        {
+            ComponentInfo info;
+            info.size      = sizeof(Type);
+            info.alignment = alignof(Type);
+            info.construct = [](void* component) { new (component) Type(); };
+            info.destruct  = [](void* component) { static_cast<Type*>(component)->~Type(); };
+            info.move      = [](void* dst, void* src) {
+                new (dst) Type(std::move(*static_cast<Type*>(src)));
+                static_cast<Type*>(src)->~Type();
+            };
+            return info;
+        }
+    };
+
+    /** @brief A fixed-size block of memory that stores the entities and the components (as separate arrays) of a single archetype. */
+    struct ArchetypeChunk
+    {
+        u8* memory = nullptr;
+        /** @brief The number of entities that are currently stored in this chunk. */
+        u32 count = 0;
+    };
+
+    /**
+     * @brief Stores all the entities that have the exact same set of components.
+     * Entities are stored tightly packed in chunks. Every chunk contains an array of entities followed by an array
+     * for every component type (SoA). Only the last chunk can be partially filled.
+     */
+    class C3D_API Archetype
+    {
+    public:
+        /**
+         * @brief Creates the archetype.
+         *
+         * @param mask The mask of all the components that entities in this archetype have
+         * @param componentInfos An array with the info for every component type (indexed by component id)
+         */
+        void Create(const ComponentMask& mask, const ComponentInfo* componentInfos);
+        /** @brief Destroys all the components in this archetype and frees all chunks. */
+        void Destroy();
+
+        /**
+         * @brief Adds a row for the provided entity. The components in this row are NOT constructed.
+         *
+         * @param entity The entity that you want to add
+         * @param outChunk The index of the chunk that the entity was added to
+         * @return The row (inside of the chunk) that the entity was added to
+         */
+        u32 AddEntity(Entity entity, u32& outChunk);
+
+        /**
+         * @brief Removes the entity at the provided location. The last entity of this archetype is moved into the empty row.
+         * The components in the removed row must already be destroyed (or moved) by the caller.
+         *
+         * @param chunk The chunk that contains the entity
+         * @param row The row (inside of the chunk) of the entity
+         * @return The entity that was moved into the empty row or an invalid entity if no entity had to be moved
+         */
+        Entity RemoveEntity(u32 chunk, u32 row);
+
+        /** @brief Constructs all components in the provided row. */
+        void ConstructComponents(u32 chunk, u32 row) const;
+        /** @brief Destroys all components in the provided row. */
+        void DestructComponents(u32 chunk, u32 row) const;
+
+        [[nodiscard]] bool HasComponent(const ComponentID id) const { return m_mask.test(id); }
+
+        [[nodiscard]] void* GetComponent(const u32 chunk, const u32 row, const ComponentID id) const
+        {
+            return m_chunks[chunk].memory + m_offsets[id] + static_cast<u64>(row) * m_componentInfos[id].size;
+        }
+
+        template <typename Type>
+        [[nodiscard]] Type* GetComponents(const u32 chunk) const
+        {
+            return reinterpret_cast<Type*>(m_chunks[chunk].memory + m_offsets[Type::GetId()]);
+        }
+
+        [[nodiscard]] Entity* GetEntities(const u32 chunk) const { return reinterpret_cast<Entity*>(m_chunks[chunk].memory); }
+
+        [[nodiscard]] const ComponentMask& GetMask() const { return m_mask; }
+        [[nodiscard]] const DynamicArray<ComponentID>& GetComponentIds() const { return m_componentIds; }
+        [[nodiscard]] u32 GetChunkCount() const { return m_chunkCount; }
+        [[nodiscard]] u32 GetChunkSize(const u32 chunk) const { return m_chunks[chunk].count; }
+        [[nodiscard]] u32 GetChunkCapacity() const { return m_capacity; }
+        [[nodiscard]] u64 GetEntityCount() const { return m_entityCount; }
+
+        /** @brief Cached archetypes that we end up in when adding or removing a single component. Used to speed up transitions. */
+        Archetype* addEdges[MAX_COMPONENTS_TYPES]    = {};
+        Archetype* removeEdges[MAX_COMPONENTS_TYPES] = {};
+
+    private:
+        ComponentMask m_mask;
+        const ComponentInfo* m_componentInfos = nullptr;
+
+        /** @brief The ids of all components in this archetype. */
+        DynamicArray<ComponentID> m_componentIds;
+        /** @brief The offset (in bytes from the start of a chunk) of the array for every component. */
+        u32 m_offsets[MAX_COMPONENTS_TYPES] = {};
+
+        /** @brief The maximum number of entities that fit in a single chunk. */
+        u32 m_capacity = 0;
+        /** @brief The number of bytes that a single chunk occupies. */
+        u64 m_chunkSize = 0;
+
+        /** @brief All chunks that are in use, followed by empty chunks that are kept around for reuse. */
+        DynamicArray<ArchetypeChunk> m_chunks;
+        /** @brief The number of chunks that are in use (have at least one entity). */
+        u32 m_chunkCount = 0;
+
+        u64 m_entityCount = 0;
+    };
+}  // namespace C3D
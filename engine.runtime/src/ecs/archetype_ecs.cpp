@@ -0,0 +1,173 @@
+#include "archetype_ecs.h"
+
+#include "memory/global_memory_system.h"
+
+namespace C3D
+{
+    bool ArchetypeECS::Create()
+    {
+        // Create the archetype for entities without any components
+        GetOrCreateArchetype(ComponentMask());
+        return true;
+    }
+
+    void ArchetypeECS::Destroy()
+    {
+        for (auto archetype : m_archetypes)
+        {
+            archetype->Destroy();
+            Memory.Delete(archetype);
+        }
+
+        m_archetypes.Destroy();
+        m_entities.Destroy();
+        m_freeIndices.Destroy();
+    }
+
+    Entity ArchetypeECS::Register()
+    {
+        Entity entity;
+
+        if (!m_freeIndices.Empty())
+        {
+            // There are free indices available so let's use those instead
+            auto index = m_freeIndices.PopBack();
+            entity     = m_entities[index].entity;
+            entity.Reuse(index);
+        }
+        else
+        {
+            // No free indices so we append an entity to the end
+            entity = Entity(m_entities.Size());
+            m_entities.EmplaceBack();
+        }
+
+        auto& record     = m_entities[entity.GetIndex()];
+        record.entity    = entity;
+        record.archetype = m_archetypes[0];
+        record.row       = record.archetype->AddEntity(entity, record.chunk);
+
+        TRACE("Registered: {}.", entity);
+        return entity;
+    }
+
+    bool ArchetypeECS::Deactivate(const Entity entity)
+    {
+        if (!IsAlive(entity))
+        {
+            ERROR_LOG("Provided entity: {} is invalid.", entity);
+            return false;
+        }
+
+        auto& record = m_entities[entity.GetIndex()];
+
+        // Destroy all the components of this entity and remove it from it's archetype
+        record.archetype->DestructComponents(record.chunk, record.row);
+
+        const auto moved = record.archetype->RemoveEntity(record.chunk, record.row);
+        if (moved.IsValid())
+        {
+            auto& movedRecord = m_entities[moved.GetIndex()];
+            movedRecord.chunk = record.chunk;
+            movedRecord.row   = record.row;
+        }
+
+        // NOTE: We keep the version of the entity so it get's incremented when this index is reused
+        record.entity.Invalidate();
+        record.archetype = nullptr;
+
+        m_freeIndices.PushBack(entity.GetIndex());
+
+        TRACE("Deactivated: {}.", entity);
+        return true;
+    }
+
+    bool ArchetypeECS::IsAlive(const Entity entity) const
+    {
+        if (!entity.IsValid() || entity.GetIndex() >= m_entities.Size()) return false;
+
+        const auto& record = m_entities[entity.GetIndex()];
+        return record.archetype && record.entity == entity;
+    }
+
+    Archetype* ArchetypeECS::GetOrCreateArchetype(const ComponentMask& mask)
+    {
+        // NOTE: The amount of archetypes is usually small and transitions between them are cached so a linear search is fine here
+        for (auto archetype : m_archetypes)
+        {
+            if (archetype->GetMask() == mask) return archetype;
+        }
+
+        auto archetype = Memory.New<Archetype>(MemoryType::ECS);
+        archetype->Create(mask, m_componentInfos);
+        m_archetypes.PushBack(archetype);
+        return archetype;
+    }
+
+    Archetype* ArchetypeECS::GetAddTransition(Archetype* archetype, const ComponentID componentId)
+    {
+        if (!archetype->addEdges[componentId])
+        {
+            if (!m_componentInfos[componentId].IsValid())
+            {
+                FATAL_LOG("Component with id: {} was never registered. Please call AddComponentType() first.", componentId);
+            }
+
+            auto mask = archetype->GetMask();
+            mask.set(componentId);
+
+            auto target                      = GetOrCreateArchetype(mask);
+            archetype->addEdges[componentId] = target;
+            target->removeEdges[componentId] = archetype;
+        }
+        return archetype->addEdges[componentId];
+    }
+
+    Archetype* ArchetypeECS::GetRemoveTransition(Archetype* archetype, const ComponentID componentId)
+    {
+        if (!archetype->removeEdges[componentId])
+        {
+            auto mask = archetype->GetMask();
+            mask.reset(componentId);
+
+            auto target                         = GetOrCreateArchetype(mask);
+            archetype->removeEdges[componentId] = target;
+            target->addEdges[componentId]       = archetype;
+        }
+        return archetype->removeEdges[componentId];
+    }
+
+    void ArchetypeECS::MoveEntity(EntityRecord& record, Archetype* target)
+    {
+        auto source = record.archetype;
+
+        u32 chunk;
+        const auto row = target->AddEntity(record.entity, chunk);
+
+        for (const auto id : source->GetComponentIds())
+        {
+            const auto component = source->GetComponent(record.chunk, record.row, id);
+            if (target->HasComponent(id))
+            {
+                m_componentInfos[id].move(target->GetComponent(chunk, row, id), component);
+            }
+            else
+            {
+                m_componentInfos[id].destruct(component);
+            }
+        }
+
+        // Remove the entity from the old archetype which might move another entity into our old location
+        const auto moved = source->RemoveEntity(record.chunk, record.row);
+        if (moved.IsValid())
+        {
+            auto& movedRecord = m_entities[moved.GetIndex()];
+            movedRecord.chunk = record.chunk;
+            movedRecord.row   = record.row;
+        }
+
+        record.archetype = target;
+        record.chunk     = chunk;
+        record.row       = row;
+    }
+}  // namespace C3D
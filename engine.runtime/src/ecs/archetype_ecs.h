@@ -0,0 +1,143 @@
+#pragma once
+#include "archetype.h"
+#include "containers/dynamic_array.h"
+#include "ecs_types.h"
+#include "entity.h"
+
+namespace C3D
+{
+    /**
+     * @brief An ECS that stores entities grouped by their component signature (archetype).
+     * All entities with the exact same set of components are stored together in fixed-size SoA chunks.
+     * This makes iterating over entities with a specific set of components cache-linear (see ArchetypeView).
+     * Adding or removing a component moves the entity (and all of it's components) to a different archetype.
+     */
+    class C3D_API ArchetypeECS
+    {
+    public:
+        bool Create();
+        void Destroy();
+
+        /** @brief Registers a component type so it can be added to entities. The ComponentType must provide a static GetId() method. */
+        template <typename ComponentType>
+        bool AddComponentType()
+        {
+            auto componentId = ComponentType::GetId();
+            if (componentId >= MAX_COMPONENTS_TYPES)
+            {
+                ERROR_LOG("ComponentId: {} falls outside of the range of component types.", componentId);
+                return false;
+            }
+
+            m_componentInfos[componentId] = ComponentInfo::Create<ComponentType>();
+            return true;
+        }
+
+        Entity Register();
+
+        bool Deactivate(Entity entity);
+
+        /** @brief Checks if the provided entity is registered (and not deactivated). */
+        [[nodiscard]] bool IsAlive(Entity entity) const;
+
+        /**
+         * @brief Adds the component to the provided entity. If the entity already has the component the existing one is returned.
+         * NOTE: This moves the entity to a different archetype so references to other components of this entity are invalidated.
+         */
+        template <typename ComponentType>
+        ComponentType& AddComponent(Entity entity)
+        {
+            auto& record     = m_entities[entity.GetIndex()];
+            auto componentId = ComponentType::GetId();
+
+            if (!record.archetype->HasComponent(componentId))
+            {
+                MoveEntity(record, GetAddTransition(record.archetype, componentId));
+                auto component = record.archetype->GetComponent(record.chunk, record.row, componentId);
+                return *new (component) ComponentType();
+            }
+
+            return *static_cast<ComponentType*>(record.archetype->GetComponent(record.chunk, record.row, componentId));
+        }
+
+        /** @brief Removes the component from the provided entity (if it has it).
+         * NOTE: This moves the entity to a different archetype so references to other components of this entity are invalidated. */
+        template <typename ComponentType>
+        void RemoveComponent(Entity entity)
+        {
+            auto& record     = m_entities[entity.GetIndex()];
+            auto componentId = ComponentType::GetId();
+
+            if (record.archetype->HasComponent(componentId))
+            {
+                MoveEntity(record, GetRemoveTransition(record.archetype, componentId));
+            }
+        }
+
+        template <typename ComponentType>
+        ComponentType& GetComponent(Entity entity)
+        {
+            const auto& record = m_entities[entity.GetIndex()];
+            return *static_cast<ComponentType*>(record.archetype->GetComponent(record.chunk, record.row, ComponentType::GetId()));
+        }
+
+        template <typename ComponentType>
+        const ComponentType& GetComponent(Entity entity) const
+        {
+            const auto& record = m_entities[entity.GetIndex()];
+            return *static_cast<const ComponentType*>(record.archetype->GetComponent(record.chunk, record.row, ComponentType::GetId()));
+        }
+
+        /**
+         * @brief Gets the requested component. If the component does not yet exist on this entity it gets added first.
+         *
+         * @param entity The entity that you want to get/add the component from/to
+         * @return A reference to the component on the provided entity
+         */
+        template <typename ComponentType>
+        ComponentType& GetOrAddComponent(Entity entity)
+        {
+            return AddComponent<ComponentType>(entity);
+        }
+
+        template <typename ComponentType>
+        bool HasComponent(Entity entity) const
+        {
+            return m_entities[entity.GetIndex()].archetype->HasComponent(ComponentType::GetId());
+        }
+
+        /** @brief Gets the number of archetypes (unique component combinations) that currently exist. */
+        [[nodiscard]] u64 GetArchetypeCount() const { return m_archetypes.Size(); }
+
+    private:
+        struct EntityRecord
+        {
+            Entity entity;
+            /** @brief The archetype that stores this entity and the location of the entity inside of that archetype. */
+            Archetype* archetype = nullptr;
+            u32 chunk            = 0;
+            u32 row              = 0;
+        };
+
+        /** @brief Gets the archetype that matches the provided mask exactly. If it does not exist yet it's created. */
+        Archetype* GetOrCreateArchetype(const ComponentMask& mask);
+
+        Archetype* GetAddTransition(Archetype* archetype, ComponentID componentId);
+        Archetype* GetRemoveTransition(Archetype* archetype, ComponentID componentId);
+
+        /** @brief Moves the entity (and all components that exist in both archetypes) to the target archetype. Components that do not
+         * exist in the target archetype are destroyed. Components that only exist in the target archetype are NOT constructed. */
+        void MoveEntity(EntityRecord& record, Archetype* target);
+
+        ComponentInfo m_componentInfos[MAX_COMPONENTS_TYPES];
+
+        /** @brief All archetypes. The first archetype is always the archetype for entities without components. */
+        DynamicArray<Archetype*> m_archetypes;
+
+        DynamicArray<EntityRecord> m_entities;
+        DynamicArray<EntityIndex> m_freeIndices;
+
+        template <typename... ComponentTypes>
+        friend class ArchetypeView;
+    };
+}  // namespace C3D
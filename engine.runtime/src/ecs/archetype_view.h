@@ -0,0 +1,132 @@
+#pragma once
+#include <span>
+#include <tuple>
+
+#include "archetype_ecs.h"
+#include "systems/jobs/job_system.h"
+
+namespace C3D
+{
+    /** @brief A single chunk of entities that all have (at least) the provided component types.
+     * Provides direct access to the tightly packed component arrays so they can be processed linearly. */
+    template <typename... ComponentTypes>
+    class EntityChunk
+    {
+    public:
+        EntityChunk(const Archetype* archetype, const u32 chunk) : m_archetype(archetype), m_chunk(chunk) {}
+
+        /** @brief Gets the number of entities in this chunk. */
+        [[nodiscard]] u32 Size() const { return m_archetype->GetChunkSize(m_chunk); }
+
+        [[nodiscard]] std::span<const Entity> GetEntities() const { return { m_archetype->GetEntities(m_chunk), Size() }; }
+
+        /** @brief Gets the array of components of the provided type. Element i belongs to the entity at GetEntities()[i]. */
+        template <typename ComponentType>
+        [[nodiscard]] std::span<ComponentType> Get() const
+        {
+            static_assert((std::is_same_v<ComponentType, ComponentTypes> || ...), "ComponentType is not part of this view.");
+            return { m_archetype->GetComponents<ComponentType>(m_chunk), Size() };
+        }
+
+    private:
+        const Archetype* m_archetype;
+        u32 m_chunk;
+    };
+
+    /**
+     * @brief A view over all entities in an ArchetypeECS that have (at least) the provided component types.
+     * Only archetypes that contain all component types are visited, so no time is spent on entities that don't match.
+     */
+    template <typename... ComponentTypes>
+    class ArchetypeView
+    {
+    public:
+        explicit ArchetypeView(ArchetypeECS& ecs) : m_ecs(&ecs)
+        {
+            // Build our mask from all the provided component ids
+            (m_mask.set(ComponentTypes::GetId()), ...);
+        }
+
+        /** @brief Calls the provided function for every chunk that contains entities matching this view. */
+        template <typename Func>
+        void ForEachChunk(Func&& func) const
+        {
+            for (const auto archetype : m_ecs->m_archetypes)
+            {
+                if ((archetype->GetMask() & m_mask) != m_mask) continue;
+
+                for (u32 chunk = 0; chunk < archetype->GetChunkCount(); ++chunk)
+                {
+                    func(EntityChunk<ComponentTypes...>(archetype, chunk));
+                }
+            }
+        }
+
+        /**
+         * @brief Calls the provided function for every chunk that contains entities matching this view.
+         * The chunks are split over the job threads so the function may be called concurrently for different chunks.
+         * The calling thread helps out and only returns once every chunk has been processed.
+         * NOTE: Adding or removing entities or components is not allowed while this is running.
+         */
+        template <typename Func>
+        void ParallelForEachChunk(JobSystem& jobs, Func&& func) const
+        {
+            struct ChunkRef
+            {
+                const Archetype* archetype;
+                u32 chunk;
+            };
+
+            // Gather all matching chunks up front so every chunk can be handed to a job thread individually
+            DynamicArray<ChunkRef> chunks;
+            for (const auto archetype : m_ecs->m_archetypes)
+            {
+                if ((archetype->GetMask() & m_mask) != m_mask) continue;
+
+                for (u32 chunk = 0; chunk < archetype->GetChunkCount(); ++chunk)
+                {
+                    chunks.PushBack({ archetype, chunk });
+                }
+            }
+
+            jobs.ParallelFor(chunks.Size(), 1, [&chunks, &func](const u64 begin, const u64 end, LinearAllocator&) {
+                for (auto i = begin; i < end; ++i)
+                {
+                    func(EntityChunk<ComponentTypes...>(chunks[i].archetype, chunks[i].chunk));
+                }
+            });
+
+            chunks.Destroy();
+        }
+
+        /** @brief Calls the provided function with the entity and references to it's components for every entity matching this view. */
+        template <typename Func>
+        void ForEach(Func&& func) const
+        {
+            ForEachChunk([&func](const EntityChunk<ComponentTypes...>& chunk) {
+                const auto entities = chunk.GetEntities();
+                const auto arrays   = std::make_tuple(chunk.template Get<ComponentTypes>().data()...);
+
+                for (u32 i = 0; i < chunk.Size(); ++i)
+                {
+                    func(entities[i], std::get<ComponentTypes*>(arrays)[i]...);
+                }
+            });
+        }
+
+        /** @brief Gets the number of entities that match this view. */
+        [[nodiscard]] u64 Count() const
+        {
+            u64 count = 0;
+            for (const auto archetype : m_ecs->m_archetypes)
+            {
+                if ((archetype->GetMask() & m_mask) == m_mask) count += archetype->GetEntityCount();
+            }
+            return count;
+        }
+
+    private:
+        ComponentMask m_mask;
+        ArchetypeECS* m_ecs;
+    };
+}  // namespace C3D
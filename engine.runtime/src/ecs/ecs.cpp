@@ -72,7 +72,7 @@ namespace C3D
             auto index = m_freeIndices.PopBack();
             entity     = m_entities[index].Reuse(index);
 
-            INFO_LOG("Registered entity with reused Description: {}.", entity);
+            TRACE("Registered entity with reused Description: {}.", entity);
         }
         else
         {
@@ -80,7 +80,7 @@ namespace C3D
             entity = Entity(m_entities.Size());
             m_entities.EmplaceBack(entity);
 
-            INFO_LOG("Registered entity with new Description: {}.", entity);
+            TRACE("Registered entity with new Description: {}.", entity);
         }
 
         return entity;
@@ -118,7 +118,7 @@ namespace C3D
         // we start with the lowest indices first to ensure we minimize fragmentation
         std::sort(m_freeIndices.begin(), m_freeIndices.end(), std::greater<u32>());
 
-        INFO_LOG("Deactivated Entity with id: '{}'.", entity);
+        TRACE("Deactivated Entity with id: '{}'.", entity);
 
         return true;
     }
@@ -0,0 +1,85 @@
+#include "entity_system.h"
+
+#include <algorithm>
+
+#include "frame_data.h"
+#include "systems/jobs/job_system.h"
+#include "systems/jobs/task_group.h"
+
+namespace C3D
+{
+    void EntitySystemScheduler::AddSystem(EntitySystem* system)
+    {
+        // We need to run after every system we conflict with that was added before us
+        u32 level = 0;
+        for (const auto& scheduled : m_systems)
+        {
+            if (scheduled.system->ConflictsWith(*system))
+            {
+                level = std::max(level, scheduled.level + 1);
+            }
+        }
+
+        // Move the system in front of all systems in a later level to keep our array sorted by level
+        m_systems.PushBack({ system, level });
+        for (auto i = m_systems.Size() - 1; i > 0 && m_systems[i - 1].level > level; --i)
+        {
+            std::swap(m_systems[i - 1], m_systems[i]);
+        }
+
+        m_levelCount = std::max(m_levelCount, level + 1);
+
+        TRACE("Added system: '{}' at level: {}.", system->GetName(), level);
+    }
+
+    void EntitySystemScheduler::Run(ArchetypeECS& ecs, JobSystem& jobs, const FrameData& frameData)
+    {
+        struct RunContext
+        {
+            ArchetypeECS* ecs;
+            JobSystem* jobs;
+            const FrameData* frameData;
+        } context = { &ecs, &jobs, &frameData };
+
+        u64 first = 0;
+        while (first < m_systems.Size())
+        {
+            // Find all systems in the current level
+            const auto level = m_systems[first].level;
+            auto last        = first;
+            while (last + 1 < m_systems.Size() && m_systems[last + 1].level == level) last++;
+
+            {
+                // Run all but the last system as jobs and run the last one on the calling thread
+                TaskGroup group(jobs, JobPriority::High);
+                for (auto i = first; i < last; ++i)
+                {
+                    group.Run([system = m_systems[i].system, &context] {
+                        system->OnUpdate(*context.ecs, *context.jobs, *context.frameData);
+                        return true;
+                    });
+                }
+
+                m_systems[last].system->OnUpdate(ecs, jobs, frameData);
+                group.Wait();
+            }
+
+            first = last + 1;
+        }
+    }
+
+    void EntitySystemScheduler::Destroy()
+    {
+        m_systems.Destroy();
+        m_levelCount = 0;
+    }
+
+    u32 EntitySystemScheduler::GetLevel(const EntitySystem* system) const
+    {
+        for (const auto& scheduled : m_systems)
+        {
+            if (scheduled.system == system) return scheduled.level;
+        }
+        return INVALID_ID;
+    }
+}  // namespace C3D
@@ -0,0 +1,101 @@
+#pragma once
+#include "archetype_ecs.h"
+#include "containers/dynamic_array.h"
+#include "defines.h"
+#include "ecs_types.h"
+
+namespace C3D
+{
+    class JobSystem;
+    struct FrameData;
+
+    /**
+     * @brief A system that operates on the entities in an ArchetypeECS.
+     * Every system declares which component types it reads and writes (in it's constructor). The EntitySystemScheduler uses these
+     * declarations to run systems that don't conflict at the same time.
+     * NOTE: Systems may not add or remove entities or components during OnUpdate() since other systems could be running concurrently.
+     */
+    class C3D_API EntitySystem
+    {
+    public:
+        explicit EntitySystem(const char* name) : m_name(name) {}
+
+        EntitySystem(const EntitySystem&) = delete;
+        EntitySystem(EntitySystem&&)      = delete;
+
+        EntitySystem& operator=(const EntitySystem&) = delete;
+        EntitySystem& operator=(EntitySystem&&)      = delete;
+
+        virtual ~EntitySystem() = default;
+
+        /**
+         * @brief Called once per scheduler run. Use the provided JobSystem to split views over the job threads
+         * (see ArchetypeView::ParallelForEachChunk).
+         */
+        virtual void OnUpdate(ArchetypeECS& ecs, JobSystem& jobs, const FrameData& frameData) = 0;
+
+        /** @brief Checks if this system can't run at the same time as the provided system. This is the case if either system
+         * writes a component type that the other system reads or writes. */
+        [[nodiscard]] bool ConflictsWith(const EntitySystem& other) const
+        {
+            return (m_writes & (other.m_reads | other.m_writes)).any() || (other.m_writes & m_reads).any();
+        }
+
+        [[nodiscard]] const char* GetName() const { return m_name; }
+        [[nodiscard]] const ComponentMask& GetReads() const { return m_reads; }
+        [[nodiscard]] const ComponentMask& GetWrites() const { return m_writes; }
+
+    protected:
+        /** @brief Declares that this system reads the provided component types. */
+        template <typename... ComponentTypes>
+        void Reads()
+        {
+            (m_reads.set(ComponentTypes::GetId()), ...);
+        }
+
+        /** @brief Declares that this system writes (and possibly reads) the provided component types. */
+        template <typename... ComponentTypes>
+        void Writes()
+        {
+            (m_writes.set(ComponentTypes::GetId()), ...);
+        }
+
+    private:
+        const char* m_name;
+
+        ComponentMask m_reads;
+        ComponentMask m_writes;
+    };
+
+    /**
+     * @brief Runs a collection of EntitySystems. Systems are grouped into levels where no two systems in the same level conflict.
+     * A system is always placed in a later level than every conflicting system that was added before it, so conflicting systems
+     * always run in the order in which they were added. All systems in a level run concurrently on the job threads.
+     */
+    class C3D_API EntitySystemScheduler
+    {
+    public:
+        /** @brief Adds a system. The scheduler does not take ownership of the system. */
+        void AddSystem(EntitySystem* system);
+
+        /** @brief Runs all systems and returns once they have all finished. */
+        void Run(ArchetypeECS& ecs, JobSystem& jobs, const FrameData& frameData);
+
+        void Destroy();
+
+        /** @brief Gets the level in which the provided system runs (systems in the same level run concurrently). */
+        [[nodiscard]] u32 GetLevel(const EntitySystem* system) const;
+        [[nodiscard]] u32 GetLevelCount() const { return m_levelCount; }
+
+    private:
+        struct ScheduledSystem
+        {
+            EntitySystem* system = nullptr;
+            u32 level            = 0;
+        };
+
+        /** @brief All our systems sorted by level (and within a level by the order in which they were added). */
+        DynamicArray<ScheduledSystem> m_systems;
+        u32 m_levelCount = 0;
+    };
+}  // namespace C3D
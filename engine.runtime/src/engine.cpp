@@ -5,7 +5,9 @@
 #include "console/console_sink.h"
 #include "logger/logger.h"
 #include "metrics/metrics.h"
+#include "platform/file_system.h"
 #include "platform/platform.h"
+#include "profiler/profiler.h"
 #include "renderer/renderer_frontend.h"
 #include "string/string.h"
 #include "systems/UI/2D/ui2d_system.h"
@@ -58,9 +60,16 @@ namespace C3D
             return false;
         }
 
-        m_frameAllocator.Create("FRAME_ALLOCATOR", appConfig.frameAllocatorSize);
+        // NOTE: We keep 2 frames alive so data produced in frame N can still be read while frame N + 1 is being built
+        if (!m_frameAllocator.Create("FRAME_ALLOCATOR", appConfig.frameAllocatorSize, 2))
+        {
+            ERROR_LOG("Failed to create the frame allocator.");
+            return false;
+        }
         m_frameData.allocator = &m_frameAllocator;
 
+        C3D_PROFILE_THREAD("Main Thread");
+
         SystemManager::OnInit();
 
         Platform::SetOnQuitCallback([this]() { Quit(); });
@@ -137,8 +146,89 @@ namespace C3D
 
     void Engine::Run()
     {
+        const auto& appConfig = m_application->m_appConfig;
+        if (appConfig.headlessFrameCount > 0)
+        {
+            RunHeadless(appConfig.headlessFrameCount);
+            return;
+        }
+
         INFO_LOG("Started.");
 
+        OnRun();
+
+        while (m_state.running)
+        {
+            if (!Platform::PumpMessages())
+            {
+                m_state.running = false;
+            }
+
+            if (!m_state.suspended)
+            {
+                const f64 currentTime = Platform::GetAbsoluteTime();
+                const f64 delta       = currentTime - m_state.lastTime;
+
+                if (RunFrame(delta))
+                {
+                    m_state.lastTime = currentTime;
+                }
+            }
+        }
+
+        Shutdown();
+
+        INFO_LOG("Finished.");
+    }
+
+    void Engine::RunHeadless(const u32 frameCount)
+    {
+        INFO_LOG("Started headless run of {} frames.", frameCount);
+
+        // Always simulate a 60FPS frame so every run does exactly the same amount of work
+        constexpr f64 delta = 1.0 / 60.0;
+
+        OnRun();
+
+        DynamicArray<HeadlessFrameStats> frames;
+        frames.Reserve(frameCount);
+
+        while (m_state.running && frames.Size() < frameCount)
+        {
+            // We still pump our messages so the user can close the window to abort the run
+            if (!Platform::PumpMessages())
+            {
+                m_state.running = false;
+            }
+
+            if (RunFrame(delta))
+            {
+                HeadlessFrameStats stats;
+                stats.prepareFrameMs  = m_state.clocks.prepareFrame.GetElapsedMs();
+                stats.onUpdateMs      = m_state.clocks.onUpdate.GetElapsedMs();
+                stats.prepareRenderMs = m_state.clocks.prepareRender.GetElapsedMs();
+                stats.onRenderMs      = m_state.clocks.onRender.GetElapsedMs();
+                stats.presentMs       = m_state.clocks.present.GetElapsedMs();
+                stats.totalMs         = m_state.clocks.total.GetElapsedMs();
+                stats.rendererStats   = Renderer.GetStats();
+
+                stats.drawnMeshCount          = m_frameData.drawnMeshCount;
+                stats.meshDrawCallCount       = m_frameData.meshDrawCallCount;
+                stats.drawnShadowMeshCount    = m_frameData.drawnShadowMeshCount;
+                stats.shadowMeshDrawCallCount = m_frameData.shadowMeshDrawCallCount;
+                frames.PushBack(stats);
+            }
+        }
+
+        WriteHeadlessReport(frames);
+
+        Shutdown();
+
+        INFO_LOG("Finished.");
+    }
+
+    void Engine::OnRun()
+    {
         m_state.running  = true;
         m_state.lastTime = Platform::GetAbsoluteTime();
 
@@ -149,140 +239,192 @@ namespace C3D
         OnResize(m_state.windowWidth, m_state.windowHeight);
 
         Metrics.PrintMemoryUsage();
+    }
 
-        while (m_state.running)
+    bool Engine::RunFrame(const f64 delta)
+    {
+        C3D_PROFILE_FRAME();
+        C3D_PROFILE_SCOPE("Frame");
+
+        m_state.clocks.total.Begin();
+
+        m_frameData.timeData.total += delta;
+        m_frameData.timeData.delta = delta;
+
+        // Start a new frame in our frame allocator (reusing the memory of the oldest frame)
+        m_frameData.allocator->BeginFrame();
+
+        Jobs.OnUpdate(m_frameData);
+        Metrics.Update(m_frameData, m_state.clocks);
+        Platform::WatchFiles();
+
+        if (m_state.resizing)
         {
-            if (!Platform::PumpMessages())
+            m_state.framesSinceResize++;
+
+            if (m_state.framesSinceResize >= 5)
             {
-                m_state.running = false;
+                OnResize(m_state.windowWidth, m_state.windowHeight);
             }
-
-            if (!m_state.suspended)
+            else
             {
-                m_state.clocks.total.Begin();
+                // Simulate a 60FPS frame
+                Platform::SleepMs(16);
+            }
 
-                const f64 currentTime = Platform::GetAbsoluteTime();
-                const f64 delta       = currentTime - m_state.lastTime;
+            // No need to do other logic since we are still resizing
+            return false;
+        }
 
-                m_frameData.timeData.total += delta;
-                m_frameData.timeData.delta = delta;
+        m_state.clocks.prepareFrame.Begin();
 
-                // Reset our frame allocator (freeing all memory used previous frame)
-                m_frameData.allocator->FreeAll();
+        if (!Renderer.PrepareFrame(m_frameData))
+        {
+            // If we fail to prepare the frame we just skip this frame since we are propabably just done resizing
+            // or we just changed a renderer flag (like VSYNC) which will require resource recreation and will skip a frame.
+            // Notify our application of the resize
+            m_application->OnResize(m_state.windowWidth, m_state.windowHeight);
+            return false;
+        }
 
-                Jobs.OnUpdate(m_frameData);
-                Metrics.Update(m_frameData, m_state.clocks);
-                Platform::WatchFiles();
+        m_state.clocks.prepareFrame.End();
 
-                if (m_state.resizing)
-                {
-                    m_state.framesSinceResize++;
-
-                    if (m_state.framesSinceResize >= 5)
-                    {
-                        OnResize(m_state.windowWidth, m_state.windowHeight);
-                    }
-                    else
-                    {
-                        // Simulate a 60FPS frame
-                        Platform::SleepMs(16);
-                    }
-
-                    // No need to do other logic since we are still resizing
-                    continue;
-                }
+        m_state.clocks.onUpdate.Begin();
 
-                m_state.clocks.prepareFrame.Begin();
+        OnUpdate();
 
-                if (!Renderer.PrepareFrame(m_frameData))
-                {
-                    // If we fail to prepare the frame we just skip this frame since we are propabably just done resizing
-                    // or we just changed a renderer flag (like VSYNC) which will require resource recreation and will skip a frame.
-                    // Notify our application of the resize
-                    m_application->OnResize(m_state.windowWidth, m_state.windowHeight);
-                    continue;
-                }
+        m_state.clocks.onUpdate.End();
 
-                m_state.clocks.prepareFrame.End();
+        // Reset our drawn mesh count for the next frame
+        m_frameData.drawnMeshCount    = 0;
+        m_frameData.meshDrawCallCount = 0;
 
-                m_state.clocks.onUpdate.Begin();
+        if (!Renderer.Begin(m_frameData))
+        {
+            FATAL_LOG("Renderer.Begin() failed. Shutting down.");
+            m_state.running = false;
+            return false;
+        }
 
-                OnUpdate();
+        m_state.clocks.prepareRender.Begin();
 
-                m_state.clocks.onUpdate.End();
+        Renderer.BeginDebugLabel("PrepareRender", vec3(1.0f, 1.0f, 0.0f));
 
-                // Reset our drawn mesh count for the next frame
-                m_frameData.drawnMeshCount = 0;
+        SystemManager::OnPrepareRender(m_frameData);
 
-                if (!Renderer.Begin(m_frameData))
-                {
-                    FATAL_LOG("Renderer.Begin() failed. Shutting down.");
-                    m_state.running = false;
-                    break;
-                }
+        // Let the application prepare all the data for the next frame
+        bool prepareFrameResult = m_application->OnPrepareRender(m_frameData);
 
-                m_state.clocks.prepareRender.Begin();
+        Renderer.EndDebugLabel();
 
-                Renderer.BeginDebugLabel("PrepareRender", vec3(1.0f, 1.0f, 0.0f));
+        if (!prepareFrameResult)
+        {
+            // We skip this frame since we failed to prepare our render
+            return false;
+        }
 
-                SystemManager::OnPrepareRender(m_frameData);
+        m_state.clocks.prepareRender.End();
 
-                // Let the application prepare all the data for the next frame
-                bool prepareFrameResult = m_application->OnPrepareRender(m_frameData);
+        m_state.clocks.onRender.Begin();
 
-                Renderer.EndDebugLabel();
+        // Call the game's render routine
+        if (!m_application->OnRender(m_frameData))
+        {
+            FATAL_LOG("OnRender() failed. Shutting down.");
+            m_state.running = false;
+            return false;
+        }
 
-                if (!prepareFrameResult)
-                {
-                    // We skip this frame since we failed to prepare our render
-                    continue;
-                }
+        m_state.clocks.onRender.End();
 
-                m_state.clocks.prepareRender.End();
+        // End the frame
+        Renderer.End(m_frameData);
 
-                m_state.clocks.onRender.Begin();
+        m_state.clocks.present.Begin();
 
-                // Call the game's render routine
-                if (!m_application->OnRender(m_frameData))
-                {
-                    FATAL_LOG("OnRender() failed. Shutting down.");
-                    m_state.running = false;
-                    break;
-                }
+        // Present our frame
+        if (!Renderer.Present(m_frameData))
+        {
+            ERROR_LOG("Failed to present the Renderer.");
+            m_state.running = false;
+            return false;
+        }
 
-                m_state.clocks.onRender.End();
+        m_state.clocks.present.End();
 
-                // End the frame
-                Renderer.End(m_frameData);
+        Input.OnUpdate(m_frameData);
 
-                m_state.clocks.present.Begin();
+        m_state.clocks.total.End();
+        return true;
+    }
 
-                // Present our frame
-                if (!Renderer.Present(m_frameData))
-                {
-                    ERROR_LOG("Failed to present the Renderer.");
-                    m_state.running = false;
-                    break;
-                }
+    void Engine::WriteHeadlessReport(const DynamicArray<HeadlessFrameStats>& frames) const
+    {
+        if (frames.Empty())
+        {
+            WARN_LOG("No frames were rendered during the headless run.");
+            return;
+        }
 
-                m_state.clocks.present.End();
+        HeadlessFrameStats average;
+        for (const auto& frame : frames)
+        {
+            average.prepareFrameMs += frame.prepareFrameMs;
+            average.onUpdateMs += frame.onUpdateMs;
+            average.prepareRenderMs += frame.prepareRenderMs;
+            average.onRenderMs += frame.onRenderMs;
+            average.presentMs += frame.presentMs;
+            average.totalMs += frame.totalMs;
+        }
 
-                Input.OnUpdate(m_frameData);
+        const auto count = static_cast<f64>(frames.Size());
+        INFO_LOG(
+            "Headless run of {} frames finished. Average timings (ms): PrepareFrame: {:.3f}, OnUpdate: {:.3f}, PrepareRender: {:.3f}, "
+            "OnRender: {:.3f}, Present: {:.3f} and Total: {:.3f}.",
+            frames.Size(), average.prepareFrameMs / count, average.onUpdateMs / count, average.prepareRenderMs / count,
+            average.onRenderMs / count, average.presentMs / count, average.totalMs / count);
 
-                m_state.clocks.total.End();
-                m_state.lastTime = currentTime;
-            }
+        const auto& reportPath = m_application->m_appConfig.headlessReportPath;
+        if (reportPath.Empty())
+        {
+            // No report was requested so logging the averages is all we need to do
+            return;
         }
 
-        Shutdown();
+        File file;
+        if (!file.Open(reportPath, FileModeWrite))
+        {
+            ERROR_LOG("Failed to open: '{}' for writing the headless report.", reportPath);
+            return;
+        }
 
-        INFO_LOG("Finished.");
+        file.WriteLine(
+            "frame,prepareFrameMs,onUpdateMs,prepareRenderMs,onRenderMs,presentMs,totalMs,drawCount,drawnElementCount,uniformUploadCount,"
+            "uploadedBytes,renderpassCount,drawnMeshCount,meshDrawCallCount,drawnShadowMeshCount,shadowMeshDrawCallCount");
+
+        for (u32 i = 0; i < frames.Size(); ++i)
+        {
+            const auto& frame = frames[i];
+            const auto& stats = frame.rendererStats;
+
+            file.WriteLine(String::FromFormat("{},{:.4f},{:.4f},{:.4f},{:.4f},{:.4f},{:.4f},{},{},{},{},{},{},{},{},{}", i,
+                                              frame.prepareFrameMs, frame.onUpdateMs, frame.prepareRenderMs, frame.onRenderMs,
+                                              frame.presentMs, frame.totalMs, stats.drawCount, stats.drawnElementCount,
+                                              stats.uniformUploadCount, stats.uploadedBytes, stats.renderpassCount, frame.drawnMeshCount,
+                                              frame.meshDrawCallCount, frame.drawnShadowMeshCount, frame.shadowMeshDrawCallCount));
+        }
+
+        file.Close();
+
+        INFO_LOG("Wrote the timings of {} frames to: '{}'.", frames.Size(), reportPath);
     }
 
     void Engine::Quit() { m_state.running = false; }
 
     void Engine::OnUpdate()
     {
+        C3D_PROFILE_FUNCTION();
+
         m_console.OnUpdate();
         m_application->OnUpdate(m_frameData);
     }
@@ -326,6 +468,9 @@ namespace C3D
         // Finally our systems manager can be shut down
         SystemManager::OnShutdown();
 
+        // Free the events of all threads (which are all joined by now)
+        Profiler.Shutdown();
+
         m_state.initialized = false;
     }
 
@@ -4,6 +4,7 @@
 #include "console/console.h"
 #include "defines.h"
 #include "frame_data.h"
+#include "memory/allocators/frame_allocator.h"
 #include "renderer/renderer_types.h"
 #include "systems/fonts/font_system.h"
 #include "time/clock.h"
@@ -33,6 +34,24 @@ namespace C3D
         f64 lastTime = 0;
     };
 
+    /** @brief The timings (in milliseconds) and renderer stats of a single frame during a headless run. */
+    struct HeadlessFrameStats
+    {
+        f64 prepareFrameMs  = 0;
+        f64 onUpdateMs      = 0;
+        f64 prepareRenderMs = 0;
+        f64 onRenderMs      = 0;
+        f64 presentMs       = 0;
+        f64 totalMs         = 0;
+
+        RendererStats rendererStats;
+
+        u32 drawnMeshCount          = 0;
+        u32 meshDrawCallCount       = 0;
+        u32 drawnShadowMeshCount    = 0;
+        u32 shadowMeshDrawCallCount = 0;
+    };
+
     class C3D_API Engine
     {
     public:
@@ -41,6 +60,8 @@ namespace C3D
         bool Init();
 
         void Run();
+        /** @brief Runs exactly frameCount frames with a fixed delta time and writes the timings of every frame to a report. */
+        void RunHeadless(u32 frameCount);
         void Quit();
         void Shutdown();
 
@@ -52,18 +73,30 @@ namespace C3D
 
         void OnApplicationLibraryReload(Application* app);
 
-        const LinearAllocator* GetFrameAllocator() const { return &m_frameAllocator; };
+        const FrameAllocator* GetFrameAllocator() const { return &m_frameAllocator; };
 
     protected:
         Application* m_application;
 
     private:
+        void OnRun();
+
+        /**
+         * @brief Runs a single frame with the provided delta time.
+         *
+         * @param delta The time (in seconds) since the previous frame
+         * @return True if the frame was fully rendered; False if it was skipped (or failed in which case running is set to false)
+         */
+        bool RunFrame(f64 delta);
+
+        void WriteHeadlessReport(const DynamicArray<HeadlessFrameStats>& frames) const;
+
         bool OnResizeEvent(u16 width, u16 height);
 
         /** @brief The Engine's internal state. */
         EngineState m_state;
-        /** @brief Allocator used for allocating frame data. Gets cleared on every frame. */
-        LinearAllocator m_frameAllocator;
+        /** @brief Allocator used for allocating frame data. Memory stays valid for 2 frames and can be allocated from any thread. */
+        FrameAllocator m_frameAllocator;
         /** @brief The data that is relevant for every frame. */
         FrameData m_frameData;
         /** @brief The console instance. */
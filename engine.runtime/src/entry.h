@@ -8,6 +8,8 @@ int main(int argc, char** argv)
 {
     // Initialize our logger which we should do first to ensure we can log errors everywhere
     C3D::Logger::Init();
+    // Move formatting and writing of our log messages to a background thread so logging does not stall our hot paths
+    C3D::Logger::StartAsync();
 
     // Initialize the platform layer
     C3D::Platform::Init();
@@ -34,6 +36,9 @@ int main(int argc, char** argv)
         engine->Run();
     }
 
+    // Write all pending log messages and stop our logging thread since some of our sinks are owned by the engine
+    C3D::Logger::StopAsync();
+
     // Cleanup our engine
     Memory.Delete(engine);
 
@@ -1,6 +1,8 @@
 
 #include "hierarchy_graph.h"
 
+#include "math/c3d_math.h"
+#include "systems/jobs/job_system.h"
 #include "systems/system_manager.h"
 #include "systems/transforms/transform_system.h"
 
@@ -27,6 +29,14 @@ namespace C3D
         }
 
         m_nodes.Destroy();
+        m_flatNodes.Destroy();
+        m_levelOffsets.Destroy();
+        m_worlds.Destroy();
+        m_determinants.Destroy();
+        m_localGenerations.Destroy();
+        m_changed.Destroy();
+
+        m_needsFlatten = true;
     }
 
     Handle<HierarchyGraphNode> HierarchyGraph::AddNode(Handle<Transform> transform)
@@ -37,8 +47,8 @@ namespace C3D
         auto& node = m_nodes[index];
         // Set the user-provided transform
         node.transform = transform;
-        // By default a node is root
-        m_rootIndices.PushBack(index);
+        // The new node (which is a root by default) needs to be added to our flattened hierarchy
+        m_needsFlatten = true;
         // Return a handle to the node
         return Handle<HierarchyGraphNode>(index, node.uuid);
     }
@@ -57,28 +67,57 @@ namespace C3D
             return false;
         }
 
-        // Get a reference to the parent and child
-        auto& parent = m_nodes[parentHandle.index];
-        auto& child  = m_nodes[childHandle.index];
-        // Add this child to the children list of the parent
-        parent.children.PushBack(childHandle.index);
+        // Get a reference to the child
+        auto& child = m_nodes[childHandle.index];
         // Add the index of the parent to the child
         child.parent = parentHandle.index;
-        // Remove the child from the root indices list
-        m_rootIndices.Remove(childHandle.index);
+        // The child (and all it's descendants) have moved in the hierarchy so we need to flatten it again
+        m_needsFlatten = true;
         // Return success
         return true;
     }
 
     bool HierarchyGraph::Update()
     {
-        for (auto rootIndex : m_rootIndices)
+        if (m_needsFlatten)
+        {
+            if (!Flatten())
+            {
+                ERROR_LOG("Failed to flatten the hierarchy.");
+                return false;
+            }
+
+            // Nodes might have moved in the hierarchy so we need to recalculate all world matrices
+            m_needsFlatten = false;
+            m_forceUpdate  = true;
+        }
+
+        // Recalculate the local matrices of all dirty transforms in one batch. After this we only need to compare local generations
+        // which (unlike consuming the dirty flags one by one) is safe to do from multiple threads
+        Transforms.UpdateAllDirty();
+
+        // Update level by level so the world matrix of every parent is up-to-date before we get to it's children
+        for (u32 level = 0; level + 1 < m_levelOffsets.Size(); ++level)
         {
-            // Update the node with a identity matrix since the root nodes don't have a parent
-            auto identity = mat4(1.0f);
-            UpdateNode(rootIndex, identity, false);
+            const auto begin = m_levelOffsets[level];
+            const auto end   = m_levelOffsets[level + 1];
+            const auto count = end - begin;
+
+            if (count < HIERARCHY_GRAPH_PARALLEL_THRESHOLD)
+            {
+                UpdateRange(begin, end);
+            }
+            else
+            {
+                // The nodes in a level only depend on nodes in the previous level so they can be updated in parallel
+                Jobs.ParallelFor(count, HIERARCHY_GRAPH_GRAIN_SIZE,
+                                 [this, begin](const u64 chunkBegin, const u64 chunkEnd, LinearAllocator&) {
+                                     UpdateRange(begin + static_cast<u32>(chunkBegin), begin + static_cast<u32>(chunkEnd));
+                                 });
+            }
         }
 
+        m_forceUpdate = false;
         return true;
     }
 
@@ -103,6 +142,17 @@ namespace C3D
         auto& node = m_nodes[handle.index];
         // Invalidate the node
         node.uuid.Invalidate();
+        node.parent = INVALID_ID;
+        // The children of this node become root nodes
+        for (auto& other : m_nodes)
+        {
+            if (other.parent == handle.index)
+            {
+                other.parent = INVALID_ID;
+            }
+        }
+        // The node needs to be removed from our flattened hierarchy
+        m_needsFlatten = true;
 
         if (releaseTransform)
         {
@@ -123,7 +173,8 @@ namespace C3D
             auto& node = m_nodes[i];
             if (!node.uuid)
             {
-                // This node is invalid (empty)
+                // This node is invalid (empty) so we reset it
+                node = HierarchyGraphNode();
                 // Generate a uuid
                 node.uuid.Generate();
                 // Return the index to this node
@@ -144,44 +195,141 @@ namespace C3D
         return index;
     }
 
-    void HierarchyGraph::UpdateNode(u32 nodeIndex, mat4& parentWorld, bool worldNeedsUpdate)
+    bool HierarchyGraph::Flatten()
     {
-        // Get the node
-        auto& node = m_nodes[nodeIndex];
-        // Stop at invalid nodes
-        if (!node.uuid) return;
-        // Check if this node has a transform
-        if (!node.transform)
-        {
-            // We can immediatly update this node's children since this node has no transform
-            for (auto index : node.children)
+        const auto nodeCount = static_cast<u32>(m_nodes.Size());
+
+        // First we determine the depth of every valid node (invalid nodes keep a depth of INVALID_ID)
+        DynamicArray<u32> depths(nodeCount);
+        for (u32 i = 0; i < nodeCount; ++i) depths.PushBack(INVALID_ID);
+
+        u32 levelCount = 0;
+        for (u32 i = 0; i < nodeCount; ++i)
+        {
+            if (!m_nodes[i].uuid) continue;
+
+            // Walk up the hierarchy until we find a root or a node for which we already know the depth
+            u32 current = i;
+            u32 steps   = 0;
+            while (depths[current] == INVALID_ID && m_nodes[current].parent != INVALID_ID)
             {
-                // The world matrix remains unchanged for it's children
-                UpdateNode(index, parentWorld, worldNeedsUpdate);
+                current = m_nodes[current].parent;
+                if (++steps > nodeCount)
+                {
+                    ERROR_LOG("The hierarchy contains a cycle.");
+                    return false;
+                }
             }
+
+            // Then walk the same path again and store the depth for every node on it
+            u32 depth  = (depths[current] == INVALID_ID ? 0 : depths[current]) + steps;
+            levelCount = Max(levelCount, depth + 1);
+
+            for (current = i; depths[current] == INVALID_ID; current = m_nodes[current].parent)
+            {
+                depths[current] = depth--;
+                if (m_nodes[current].parent == INVALID_ID) break;
+            }
+        }
+
+        // Count the amount of nodes in every level so we know where every level starts
+        m_levelOffsets.Clear();
+        for (u32 level = 0; level <= levelCount; ++level) m_levelOffsets.PushBack(0);
+
+        for (u32 i = 0; i < nodeCount; ++i)
+        {
+            if (depths[i] != INVALID_ID) m_levelOffsets[depths[i] + 1]++;
+        }
+        for (u32 level = 0; level < levelCount; ++level)
+        {
+            m_levelOffsets[level + 1] += m_levelOffsets[level];
+        }
+
+        const auto flatCount = m_levelOffsets[levelCount];
+
+        // Then place every node in it's level (nodes in the same level keep their relative order)
+        DynamicArray<u32> cursors(levelCount);
+        for (u32 level = 0; level < levelCount; ++level) cursors.PushBack(m_levelOffsets[level]);
+
+        DynamicArray<u32> flatIndices(nodeCount);
+        for (u32 i = 0; i < nodeCount; ++i) flatIndices.PushBack(INVALID_ID);
+
+        m_flatNodes.Clear();
+        m_flatNodes.Resize(flatCount);
+        for (u32 i = 0; i < nodeCount; ++i)
+        {
+            if (depths[i] == INVALID_ID) continue;
+
+            const auto flatIndex = cursors[depths[i]]++;
+            flatIndices[i]       = flatIndex;
+
+            m_flatNodes[flatIndex].node = i;
+        }
+
+        // Now that every node has a place we can store the flat index of it's parent
+        for (auto& flatNode : m_flatNodes)
+        {
+            const auto parent = m_nodes[flatNode.node].parent;
+            flatNode.parent   = parent == INVALID_ID ? INVALID_ID : flatIndices[parent];
         }
-        else
+
+        m_worlds.Clear();
+        m_determinants.Clear();
+        m_localGenerations.Clear();
+        m_changed.Clear();
+        m_worlds.Reserve(flatCount);
+        m_determinants.Reserve(flatCount);
+        m_localGenerations.Reserve(flatCount);
+        m_changed.Reserve(flatCount);
+        for (u32 i = 0; i < flatCount; ++i)
         {
-            // Update the node's local matrix if needed
-            if (Transforms.UpdateLocal(node.transform) || worldNeedsUpdate)
+            m_worlds.PushBack(mat4(1.0f));
+            m_determinants.PushBack(1.0f);
+            m_localGenerations.PushBack(INVALID_ID);
+            m_changed.PushBack(0);
+        }
+
+        return true;
+    }
+
+    void HierarchyGraph::UpdateRange(const u32 begin, const u32 end)
+    {
+        for (u32 i = begin; i < end; ++i)
+        {
+            const auto& flatNode = m_flatNodes[i];
+            const auto& node     = m_nodes[flatNode.node];
+            const bool isRoot    = flatNode.parent == INVALID_ID;
+
+            // The world of this node needs to be recalculated if the world of it's parent changed during this update
+            bool changed = m_forceUpdate || (!isRoot && m_changed[flatNode.parent]);
+
+            if (node.transform)
             {
-                // If any local changed then all children need to update their world matrix
-                worldNeedsUpdate = true;
-                // Get the local matrix
-                const auto& local = Transforms.GetLocal(node.transform);
-                // Calculate this node's world
-                parentWorld *= local;
-                // Set this node's world
-                Transforms.SetWorld(node.transform, parentWorld);
-            }
+                // The local matrix was already recalculated by Transforms.UpdateAllDirty() so we only check if it changed
+                const auto localGeneration = Transforms.GetLocalGeneration(node.transform);
+                if (localGeneration != m_localGenerations[i] || changed)
+                {
+                    m_localGenerations[i] = localGeneration;
 
-            // Also update all this node's children
-            for (auto index : node.children)
+                    // Calculate this node's world. NOTE: We write into our own slot so siblings all start from the same parent world
+                    const auto& local   = Transforms.GetLocal(node.transform);
+                    const auto localDet = Transforms.GetLocalDeterminant(node.transform);
+                    m_worlds[i]         = isRoot ? local : m_worlds[flatNode.parent] * local;
+                    m_determinants[i]   = isRoot ? localDet : m_determinants[flatNode.parent] * localDet;
+                    // Set this node's world (the determinant of a product is the product of the determinants)
+                    Transforms.SetWorld(node.transform, m_worlds[i], m_determinants[i]);
+                    // All this node's children need to update their world matrix
+                    changed = true;
+                }
+            }
+            else if (changed)
             {
-                // This world matrix is now updated
-                UpdateNode(index, parentWorld, worldNeedsUpdate);
+                // Nodes without a transform simply pass the world matrix of their parent on to their children
+                m_worlds[i]       = isRoot ? mat4(1.0f) : m_worlds[flatNode.parent];
+                m_determinants[i] = isRoot ? 1.0f : m_determinants[flatNode.parent];
             }
+
+            m_changed[i] = changed;
         }
     }
-
 }  // namespace C3D
\ No newline at end of file
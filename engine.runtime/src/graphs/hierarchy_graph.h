@@ -1,4 +1,3 @@
-
 #pragma once
 #include "containers/dynamic_array.h"
 #include "defines.h"
@@ -9,6 +8,11 @@ namespace C3D
 {
     struct Transform;
 
+    /** @brief Levels with at least this many nodes are updated in parallel on the job system. Smaller levels are updated inline. */
+    constexpr u32 HIERARCHY_GRAPH_PARALLEL_THRESHOLD = 1024;
+    /** @brief The number of nodes that a single job updates when a level is updated in parallel. */
+    constexpr u32 HIERARCHY_GRAPH_GRAIN_SIZE = 256;
+
     struct HierarchyGraphNode
     {
         /** @brief The unique id for this node. Will be invalid when this node is not acquired. */
@@ -17,10 +21,14 @@ namespace C3D
         Handle<Transform> transform;
         /** @brief The index to the parent of this node. Is set to INVALID_ID when this is a root node. */
         u32 parent = INVALID_ID;
-        /** @brief An array of indices to the children of this node. */
-        DynamicArray<u32> children;
     };
 
+    /**
+     * @brief A hierarchy of nodes (with optional transforms) where every node's world matrix is relative to it's parent.
+     * Internally the nodes are kept in a flat array sorted by depth (rebuilt whenever the hierarchy changes) so world matrices can be
+     * calculated level by level with every node only needing the (already calculated) world matrix of it's parent.
+     * Large levels are split into chunks that are updated in parallel on the job system.
+     */
     class C3D_API HierarchyGraph
     {
     public:
@@ -30,20 +38,50 @@ namespace C3D
         Handle<HierarchyGraphNode> AddNode(Handle<Transform> transform = Handle<Transform>());
         bool AddChild(Handle<HierarchyGraphNode> parentHandle, Handle<HierarchyGraphNode> childHandle);
 
+        /** @brief Updates the world matrices of all nodes whose local matrix (or the world matrix of one of it's ancestors) changed. */
         bool Update();
 
         Handle<Transform> GetTransform(Handle<HierarchyGraphNode> node) const;
 
+        /** @brief Releases the node. The children of a released node become root nodes. */
         bool Release(Handle<HierarchyGraphNode> handle, bool releaseTransform);
 
     private:
+        struct FlatNode
+        {
+            /** @brief The index of the node in m_nodes. */
+            u32 node = INVALID_ID;
+            /** @brief The index of the parent in the flat array. INVALID_ID for root nodes. */
+            u32 parent = INVALID_ID;
+        };
+
         u32 CreateNode();
 
-        void UpdateNode(u32 nodeIndex, mat4& world, bool worldNeedsUpdate);
+        /** @brief Rebuilds the depth sorted flat array from the parent indices of all our nodes. */
+        bool Flatten();
 
-        /** @brief An array of indices to root nodes. */
-        DynamicArray<u32> m_rootIndices;
-        /** @brief An array of the nodes that are part of this graph. */
+        /** @brief Updates the nodes in the range [begin, end) of the flat array. All nodes in the range must have the same depth. */
+        void UpdateRange(u32 begin, u32 end);
+
+        /** @brief An array of the nodes that are part of this graph. Handles index into this array. */
         DynamicArray<HierarchyGraphNode> m_nodes;
+
+        /** @brief All valid nodes sorted by depth. Every parent is always stored before all of it's children. */
+        DynamicArray<FlatNode> m_flatNodes;
+        /** @brief The index into m_flatNodes where every level starts (with one extra entry marking the end of the last level). */
+        DynamicArray<u32> m_levelOffsets;
+        /** @brief The world matrix of every node in m_flatNodes (nodes without a transform inherit the world of their parent). */
+        DynamicArray<mat4> m_worlds;
+        /** @brief The determinant of every world matrix in m_worlds. */
+        DynamicArray<f32> m_determinants;
+        /** @brief The local generation of the transform of every node in m_flatNodes the last time that we calculated it's world. */
+        DynamicArray<u32> m_localGenerations;
+        /** @brief For every node in m_flatNodes, a flag to indicate that it's world matrix changed during the current update. */
+        DynamicArray<u8> m_changed;
+
+        /** @brief True if nodes have been added, removed or moved since the last time that we flattened the hierarchy. */
+        bool m_needsFlatten = true;
+        /** @brief True if all world matrices need to be recalculated (since the flat array was rebuilt). */
+        bool m_forceUpdate = true;
     };
-}  // namespace C3D
\ No newline at end of file
+}  // namespace C3D
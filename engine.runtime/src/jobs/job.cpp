@@ -1,15 +1,42 @@
-
 #include "job.h"
 
+#include "string/string.h"
+
 namespace C3D
 {
-    void JobThread::SetInfo(JobInfo&& info)
+    /** @brief The amount of jobs each of the job thread's queues can hold before they need to grow. */
+    constexpr auto INITIAL_JOB_QUEUE_CAPACITY = 64;
+
+    void JobThread::Create(const u8 threadIndex, const u32 threadTypeMask, const u64 scratchSize)
     {
-        m_info = std::move(info);
-        m_info.inUse = true;
+        index    = threadIndex;
+        typeMask = threadTypeMask;
+
+        for (auto& queue : m_queues)
+        {
+            queue.Create(INITIAL_JOB_QUEUE_CAPACITY);
+        }
+
+        const auto name = String::FromFormat("JOB_THREAD_{}_SCRATCH_ALLOCATOR", threadIndex);
+        scratchAllocator.Create(name.Data(), scratchSize);
     }
 
-    void JobThread::ClearInfo() { m_info.inUse = false; }
+    void JobThread::Destroy()
+    {
+        for (auto& queue : m_queues)
+        {
+            queue.Destroy();
+        }
+
+        if (scratchAllocator.GetMemory())
+        {
+            scratchAllocator.Destroy();
+        }
+    }
 
-    bool JobThread::IsFree() const { return !m_info.inUse; }
-}  // namespace C3D
\ No newline at end of file
+    JobQueue& JobThread::GetQueue(const JobPriority priority)
+    {
+        // Our queues are ordered from highest to lowest priority
+        return m_queues[ToUnderlying(JobPriority::High) - ToUnderlying(priority)];
+    }
+}  // namespace C3D
@@ -1,9 +1,12 @@
-
 #pragma once
+#include <atomic>
 #include <mutex>
 #include <thread>
 
+#include "containers/dynamic_array.h"
+#include "job_queue.h"
 #include "job_types.h"
+#include "memory/allocators/linear_allocator.h"
 #include "memory/global_memory_system.h"
 #include "systems/system_manager.h"
 
@@ -11,16 +14,16 @@ namespace C3D
 {
     struct JobInfo
     {
-        bool inUse = false;
-
         /** @brief The handle for this job. */
         JobHandle handle = INVALID_ID_U16;
         /** @brief The type of this job. */
         JobType type = JobTypeGeneral;
         /** @brief The priority for this job. */
         JobPriority priority = JobPriority::Normal;
+        /** @brief The name that is used when profiling this job. Must be a string literal (or otherwise outlive the job). */
+        const char* name = "Job";
         /** @brief An array of dependencies for this job. These should be finished before this job starts. */
-        u16 dependencies[MAX_JOB_DEPENDENCIES];
+        JobHandle dependencies[MAX_JOB_DEPENDENCIES];
         /** @brief The number of dependencies for this job. */
         u8 numberOfDependencies = 0;
         /** @brief The entry point of the job. Gets called when the job starts. */
@@ -31,31 +34,47 @@ namespace C3D
         StackFunction<void(), 24> onFailure;
     };
 
+    /** @brief Keeps track of the state of a submitted job. A slot is reused once it's job has finished. */
+    struct JobSlot
+    {
+        /** @brief The handle of the job that is currently (or was most recently) using this slot. */
+        std::atomic<JobHandle> handle = INVALID_ID_U16;
+        /** @brief True once the entry point of the job has finished executing. */
+        std::atomic<bool> finished = true;
+        /** @brief The number of dependencies that still need to finish before this job can be queued. */
+        std::atomic<u32> remainingDependencies = 0;
+        /** @brief The job itself. Kept here until all of it's dependencies have finished. */
+        JobInfo info;
+        /** @brief The handles of the jobs that depend on this job. These get queued when their last dependency finishes. */
+        DynamicArray<JobHandle> continuations;
+        /** @brief Protects finished and continuations so a job can't finish while a continuation is being added. */
+        std::mutex mutex;
+    };
+
     class JobThread
     {
     public:
         JobThread() = default;
 
-        /** @brief Sets the thread's info. Thread should be locked before calling this! */
-        void SetInfo(JobInfo&& info);
-
-        /** @brief Get the thread's info. Thread should be locked before calling this! */
-        JobInfo GetInfo() const { return m_info; }
-
-        /** @brief Clears the thread's info. Thread should be locked before calling this! */
-        void ClearInfo();
+        /** @brief Creates the queues and the scratch allocator for this thread. */
+        void Create(u8 threadIndex, u32 threadTypeMask, u64 scratchSize);
+        /** @brief Destroys the queues (including all the jobs that are still queued) and the scratch allocator for this thread. */
+        void Destroy();
 
-        /** @brief Checks if the thread currently has any work assigned. Thread should be locked before calling this! */
-        [[nodiscard]] bool IsFree() const;
+        /** @brief Gets the queue that holds the jobs for the provided priority. */
+        JobQueue& GetQueue(JobPriority priority);
 
         u8 index = 0;
         std::thread thread;
-        std::mutex mutex;
 
         /** @brief The types of jobs this thread can handle. */
         u32 typeMask = 0;
 
+        /** @brief Scratch memory that can only be used by this thread. It is reset once the thread finishes it's outermost job. */
+        LinearAllocator scratchAllocator;
+
     private:
-        JobInfo m_info;
+        /** @brief A queue for every job priority (High, Normal and Low). Other threads can steal jobs from these queues. */
+        JobQueue m_queues[JOB_PRIORITY_COUNT];
     };
 }  // namespace C3D
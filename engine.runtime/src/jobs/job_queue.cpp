@@ -0,0 +1,120 @@
+#include "job_queue.h"
+
+#include "job.h"
+
+namespace C3D
+{
+    void JobQueue::Create(const u32 initialCapacity)
+    {
+        std::lock_guard queueLock(m_mutex);
+
+        m_jobs.Resize(initialCapacity);
+        m_head  = 0;
+        m_count = 0;
+    }
+
+    void JobQueue::Destroy()
+    {
+        std::lock_guard queueLock(m_mutex);
+
+        m_jobs.Destroy();
+        m_head  = 0;
+        m_count = 0;
+    }
+
+    void JobQueue::Push(const JobInfo& info)
+    {
+        std::lock_guard queueLock(m_mutex);
+
+        if (m_count == m_jobs.Size())
+        {
+            // We have run out of space so we grow the queue
+            Grow();
+        }
+
+        At(m_count) = info;
+        m_count++;
+    }
+
+    bool JobQueue::Pop(const u32 typeMask, JobInfo& outInfo)
+    {
+        std::lock_guard queueLock(m_mutex);
+
+        // Search from the back to the front for the most recently added job that we can execute
+        for (u64 i = m_count; i > 0; --i)
+        {
+            auto& job = At(i - 1);
+            if (job.type & typeMask)
+            {
+                outInfo = job;
+                RemoveAt(i - 1);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool JobQueue::Steal(const u32 typeMask, JobInfo& outInfo)
+    {
+        std::lock_guard queueLock(m_mutex);
+
+        // Search from the front to the back for the oldest job that we can execute
+        for (u64 i = 0; i < m_count; ++i)
+        {
+            auto& job = At(i);
+            if (job.type & typeMask)
+            {
+                outInfo = job;
+                RemoveAt(i);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    u64 JobQueue::Count() const
+    {
+        std::lock_guard queueLock(m_mutex);
+        return m_count;
+    }
+
+    void JobQueue::Grow()
+    {
+        const auto oldCapacity = m_jobs.Size();
+        const auto newCapacity = oldCapacity == 0 ? 16 : oldCapacity * 2;
+
+        // Copy all our jobs into a new array (starting at index 0) so our ring buffer is no longer wrapped around
+        DynamicArray<JobInfo> jobs;
+        jobs.Resize(newCapacity);
+        for (u64 i = 0; i < m_count; ++i)
+        {
+            jobs[i] = At(i);
+        }
+
+        m_jobs = std::move(jobs);
+        m_head = 0;
+    }
+
+    void JobQueue::RemoveAt(const u64 position)
+    {
+        if (position == 0)
+        {
+            // Removing from the front so we can simply move our head
+            At(0) = JobInfo();
+            m_head = (m_head + 1) % m_jobs.Size();
+        }
+        else
+        {
+            // Shift all the jobs after this position one spot to the front
+            for (u64 i = position; i + 1 < m_count; ++i)
+            {
+                At(i) = At(i + 1);
+            }
+            At(m_count - 1) = JobInfo();
+        }
+
+        m_count--;
+    }
+}  // namespace C3D
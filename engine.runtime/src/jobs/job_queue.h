@@ -0,0 +1,79 @@
+#pragma once
+#include <mutex>
+
+#include "containers/dynamic_array.h"
+#include "defines.h"
+#include "job_types.h"
+
+namespace C3D
+{
+    struct JobInfo;
+
+    /**
+     * @brief A double-ended queue of jobs that is owned by a single job thread.
+     * The owning thread pushes and pops jobs at the back (LIFO) while other threads steal jobs from the front (FIFO).
+     * Every operation only holds the lock of this specific queue so threads only contend when they touch the same queue.
+     */
+    class JobQueue
+    {
+    public:
+        JobQueue() = default;
+
+        JobQueue(const JobQueue&) = delete;
+        JobQueue(JobQueue&&)      = delete;
+
+        JobQueue& operator=(const JobQueue&) = delete;
+        JobQueue& operator=(JobQueue&&)      = delete;
+
+        ~JobQueue() { Destroy(); }
+
+        /** @brief Creates the queue with enough space for the provided amount of jobs. The queue grows when it runs out of space. */
+        void Create(u32 initialCapacity);
+        /** @brief Destroys the queue and all jobs that are still in it. */
+        void Destroy();
+
+        /** @brief Adds a job to the back of the queue. Should be called by the owner of this queue (or when submitting a new job). */
+        void Push(const JobInfo& info);
+
+        /**
+         * @brief Takes the most recently added job (from the back of the queue) that matches the provided type mask.
+         * Should only be called by the thread that owns this queue.
+         *
+         * @param typeMask The types of jobs that the calling thread can execute
+         * @param outInfo The job that was taken from the queue
+         * @return True if a job was found; False otherwise
+         */
+        bool Pop(u32 typeMask, JobInfo& outInfo);
+
+        /**
+         * @brief Steals the oldest job (from the front of the queue) that matches the provided type mask.
+         * This is called by threads that have run out of work in their own queues.
+         *
+         * @param typeMask The types of jobs that the calling thread can execute
+         * @param outInfo The job that was stolen from the queue
+         * @return True if a job was found; False otherwise
+         */
+        bool Steal(u32 typeMask, JobInfo& outInfo);
+
+        /** @brief Gets the amount of jobs that are currently in the queue. */
+        [[nodiscard]] u64 Count() const;
+
+    private:
+        /** @brief Doubles the capacity of the queue. Should only be called while holding the lock. */
+        void Grow();
+        /** @brief Removes the job at the provided position (relative to the front of the queue). Should only be called while holding the
+         * lock. */
+        void RemoveAt(u64 position);
+
+        JobInfo& At(u64 position) { return m_jobs[(m_head + position) % m_jobs.Size()]; }
+
+        /** @brief The storage for our jobs. Used as a ring buffer. */
+        DynamicArray<JobInfo> m_jobs;
+        /** @brief The index into m_jobs where the front of the queue is located. */
+        u64 m_head = 0;
+        /** @brief The amount of jobs currently in the queue. */
+        u64 m_count = 0;
+
+        mutable std::mutex m_mutex;
+    };
+}  // namespace C3D
@@ -7,6 +7,13 @@ namespace C3D
 {
     /** @brief The maximum number of dependencies a single job can have. */
     constexpr auto MAX_JOB_DEPENDENCIES = 16;
+    /** @brief The number of different job types (excluding JobTypeNone). */
+    constexpr auto JOB_TYPE_COUNT = 3;
+    /** @brief The number of different job priorities (excluding JobPriority::None). */
+    constexpr auto JOB_PRIORITY_COUNT = 3;
+    /** @brief The maximum number of jobs that can be in flight (submitted but not yet finished) at the same time.
+     * Submitting more jobs will make the submitting thread help out with pending work until a job slot frees up. */
+    constexpr auto MAX_ACTIVE_JOBS = 1024;
 
     using JobHandle = u16;
 
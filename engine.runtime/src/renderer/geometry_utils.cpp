@@ -1,9 +1,12 @@
 
 #include "geometry_utils.h"
 
+#include <algorithm>
+#include <bit>
 #include <glm/gtc/epsilon.hpp>
 #include <glm/gtx/hash.hpp>
 
+#include "containers/flat_hash_map.h"
 #include "math/c3d_math.h"
 #include "systems/system_manager.h"
 
@@ -87,68 +90,427 @@ namespace C3D::GeometryUtils
         }
     }
 
-    bool Vertex3DEqual(const Vertex3D& vert0, const Vertex3D& vert1)
+    /** @brief A vertex used as key for de-duplication. Unlike Vertex3D it compares exactly (not with an epsilon) to match it's hash. */
+    struct UniqueVertex
     {
-        return EpsilonEqual(vert0.position, vert1.position, F32_EPSILON) && EpsilonEqual(vert0.normal, vert1.normal, F32_EPSILON) &&
-               EpsilonEqual(vert0.texture, vert1.texture, F32_EPSILON) && EpsilonEqual(vert0.color, vert1.color, F32_EPSILON) &&
-               EpsilonEqual(vert0.tangent, vert1.tangent, F32_EPSILON);
-    }
+        Vertex3D vertex;
 
-    void ReassignIndex(const DynamicArray<u32>& indices, const u32 from, const u32 to)
+        bool operator==(const UniqueVertex& other) const
+        {
+            return vertex.position == other.vertex.position && vertex.normal == other.vertex.normal &&
+                   vertex.texture == other.vertex.texture && vertex.color == other.vertex.color && vertex.tangent == other.vertex.tangent;
+        }
+    };
+
+    struct UniqueVertexHash
     {
-        for (auto& index : indices)
+        size_t operator()(const UniqueVertex& unique) const noexcept
         {
-            if (index == from)
+            const auto& v      = unique.vertex;
+            const f32 values[] = { v.position.x, v.position.y, v.position.z, v.normal.x, v.normal.y, v.normal.z,  v.texture.x, v.texture.y,
+                                   v.color.r,    v.color.g,    v.color.b,    v.color.a,  v.tangent.x, v.tangent.y, v.tangent.z };
+
+            // FNV-1a over the bits of every value. Adding 0 turns -0.0f into 0.0f so both hash the same since they also compare equal
+            u64 hash = 14695981039346656037ull;
+            for (const auto value : values)
             {
-                index = to;
+                hash ^= std::bit_cast<u32>(value + 0.0f);
+                hash *= 1099511628211ull;
             }
-            else if (index > from)
+            return hash;
+        }
+    };
+
+    void DeduplicateVertices(GeometryConfig& config)
+    {
+        const u64 oldVertexCount = config.vertices.Size();
+
+        // Maps every vertex to the index of the first vertex that is equal to it
+        FlatHashMap<UniqueVertex, u32, UniqueVertexHash> uniqueIndices;
+        uniqueIndices.Create(oldVertexCount);
+
+        // For every old vertex the index of it's unique counterpart
+        DynamicArray<u32> remap;
+        remap.Resize(oldVertexCount);
+
+        DynamicArray<Vertex3D> uniqueVertices(oldVertexCount);
+        for (u64 v = 0; v < oldVertexCount; v++)
+        {
+            const UniqueVertex key = { config.vertices[v] };
+            if (const auto index = uniqueIndices.Find(key))
             {
-                // All indices higher than 'from' need to be decremented by 1
-                index--;
+                remap[v] = *index;
+                continue;
             }
+
+            const auto index = static_cast<u32>(uniqueVertices.Size());
+            uniqueVertices.PushBack(key.vertex);
+            uniqueIndices.Set(key, index);
+            remap[v] = index;
+        }
+
+        // Point all indices to the unique vertices
+        for (auto& index : config.indices)
+        {
+            index = remap[index];
         }
+
+        // Move the unique vertices into the old vertices array
+        config.vertices = std::move(uniqueVertices);
+
+        const u64 uniqueVertexCount = config.vertices.Size();
+        INFO_LOG("Removed {} vertices, Originally: {} | Now: {}", oldVertexCount - uniqueVertexCount, oldVertexCount, uniqueVertexCount);
     }
 
-    void DeduplicateVertices(GeometryConfig& config)
+    f32 CalculateACMR(const DynamicArray<u32>& indices, const u64 vertexCount, const u32 cacheSize)
     {
-        // Store the unique vertex count
-        u64 uniqueVertexCount = 0;
-        // Store the current vertex count
-        const u64 oldVertexCount = config.vertices.Size();
-        // Create dynamic array with enough memory for the worst case where every vertex is unique
-        auto uniqueVertices = DynamicArray<Vertex3D>();
-        uniqueVertices.Resize(oldVertexCount);
+        const auto triangleCount = indices.Size() / 3;
+        if (triangleCount == 0) return 0.0f;
 
-        u32 foundCount = 0;
-        for (u32 v = 0; v < oldVertexCount; v++)
+        // Simulate a FIFO cache. A vertex is still in the cache if less than cacheSize misses happened since it was added.
+        DynamicArray<u32> timestamps;
+        timestamps.Resize(vertexCount);
+
+        u32 timestamp = cacheSize + 1;
+        u64 misses    = 0;
+        for (const auto index : indices)
         {
-            bool found = false;
-            for (u32 u = 0; u < uniqueVertexCount; u++)
+            if (timestamp - timestamps[index] > cacheSize)
             {
-                if (Vertex3DEqual(config.vertices[v], uniqueVertices[u]))
+                timestamps[index] = timestamp++;
+                misses++;
+            }
+        }
+
+        return static_cast<f32>(misses) / static_cast<f32>(triangleCount);
+    }
+
+    /** @brief The size of the LRU cache that is simulated while reordering (as proposed by Forsyth). */
+    constexpr u32 FORSYTH_CACHE_SIZE     = 32;
+    constexpr f32 FORSYTH_CACHE_DECAY    = 1.5f;
+    constexpr f32 FORSYTH_LAST_TRI_SCORE = 0.75f;
+    constexpr f32 FORSYTH_VALENCE_SCALE  = 2.0f;
+    constexpr f32 FORSYTH_VALENCE_POWER  = 0.5f;
+    /** @brief Vertices with more remaining triangles than this all get the same valence score. */
+    constexpr u32 FORSYTH_MAX_VALENCE = 32;
+
+    /** @brief Lookup tables for the scores that Forsyth's algorithm gives vertices based on their cache position and valence. */
+    struct ForsythScores
+    {
+        ForsythScores()
+        {
+            for (u32 i = 0; i < FORSYTH_CACHE_SIZE; i++)
+            {
+                if (i < 3)
                 {
-                    // We have found a match so we simply use the indices and we do not copy over the vertex
-                    ReassignIndex(config.indices, v - foundCount, u);
-                    found = true;
-                    foundCount++;
-                    break;
+                    // The vertices of the last triangle get a fixed score, so we don't prefer using the same triangle edge again
+                    cache[i] = FORSYTH_LAST_TRI_SCORE;
+                }
+                else
+                {
+                    const f32 scaler = 1.0f / (FORSYTH_CACHE_SIZE - 3);
+                    cache[i]         = std::pow(1.0f - static_cast<f32>(i - 3) * scaler, FORSYTH_CACHE_DECAY);
                 }
             }
 
-            // We have not found a match so we copy the vertex over
-            if (!found)
+            valence[0] = 0.0f;
+            for (u32 i = 1; i <= FORSYTH_MAX_VALENCE; i++)
             {
-                uniqueVertices[uniqueVertexCount] = config.vertices[v];
-                uniqueVertexCount++;
+                // Boost vertices with few remaining triangles so we get rid of lone triangles as quickly as possible
+                valence[i] = FORSYTH_VALENCE_SCALE * std::pow(static_cast<f32>(i), -FORSYTH_VALENCE_POWER);
             }
         }
 
-        // Move the unique vertices into the old vertices array
-        config.vertices = std::move(uniqueVertices);
+        [[nodiscard]] f32 Get(const i32 cachePosition, const u32 remainingTriangles) const
+        {
+            // Vertices without any remaining triangles are never used again
+            if (remainingTriangles == 0) return -1.0f;
+
+            const f32 cacheScore = cachePosition >= 0 ? cache[cachePosition] : 0.0f;
+            return cacheScore + valence[std::min(remainingTriangles, FORSYTH_MAX_VALENCE)];
+        }
+
+        f32 cache[FORSYTH_CACHE_SIZE];
+        f32 valence[FORSYTH_MAX_VALENCE + 1];
+    };
+
+    void OptimizeVertexCache(DynamicArray<u32>& indices, const u64 vertexCount)
+    {
+        static const ForsythScores scores;
+
+        const auto triangleCount = indices.Size() / 3;
+        if (triangleCount == 0) return;
+
+        // Build the list of triangles that use every vertex (in a single array with an offset per vertex)
+        DynamicArray<u32> remainingTriangles;
+        remainingTriangles.Resize(vertexCount);
+        for (const auto index : indices) remainingTriangles[index]++;
+
+        DynamicArray<u32> offsets;
+        offsets.Resize(vertexCount);
+        u32 offset = 0;
+        for (u64 v = 0; v < vertexCount; v++)
+        {
+            offsets[v] = offset;
+            offset += remainingTriangles[v];
+        }
+
+        DynamicArray<u32> vertexTriangles;
+        vertexTriangles.Resize(indices.Size());
+
+        DynamicArray<u32> filled;
+        filled.Resize(vertexCount);
+        for (u32 t = 0; t < triangleCount; t++)
+        {
+            for (u32 i = 0; i < 3; i++)
+            {
+                const auto v                              = indices[t * 3 + i];
+                vertexTriangles[offsets[v] + filled[v]++] = t;
+            }
+        }
+
+        DynamicArray<f32> vertexScores;
+        vertexScores.Resize(vertexCount);
+        for (u64 v = 0; v < vertexCount; v++)
+        {
+            vertexScores[v] = scores.Get(-1, remainingTriangles[v]);
+        }
+
+        const auto TriangleScore = [&](const u32 t) {
+            return vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+        };
+
+        DynamicArray<bool> emitted;
+        emitted.Resize(triangleCount);
+
+        // The simulated cache holds the vertices of the last triangle (which are added at the front) on top of the cache size
+        u32 cache[FORSYTH_CACHE_SIZE + 3];
+        u32 newCache[FORSYTH_CACHE_SIZE + 3];
+        u32 cacheCount = 0;
+
+        DynamicArray<u32> output(indices.Size());
+
+        // The first triangle is simply the one with the best score. After that we only search the triangles of the vertices in our cache.
+        u32 bestTriangle = 0;
+        f32 bestScore    = TriangleScore(0);
+        for (u32 t = 1; t < triangleCount; t++)
+        {
+            const auto score = TriangleScore(t);
+            if (score > bestScore)
+            {
+                bestScore    = score;
+                bestTriangle = t;
+            }
+        }
+
+        // Where we continue searching for triangles that are not emitted yet when nothing in the cache is usable
+        u32 searchCursor = 0;
+
+        for (u64 emittedCount = 0; emittedCount < triangleCount; emittedCount++)
+        {
+            if (bestTriangle == INVALID_ID)
+            {
+                // Our cache did not contain any usable triangles so we start again with the next triangle that was not emitted yet
+                while (emitted[searchCursor]) searchCursor++;
+                bestTriangle = searchCursor;
+            }
+
+            const auto triangle   = indices.GetData() + static_cast<u64>(bestTriangle) * 3;
+            emitted[bestTriangle] = true;
+            output.PushBack(triangle[0]);
+            output.PushBack(triangle[1]);
+            output.PushBack(triangle[2]);
+
+            // The vertices of the new triangle go to the front of our cache followed by everything that was in there already
+            u32 newCacheCount = 0;
+            for (u32 i = 0; i < 3; i++)
+            {
+                const auto v              = triangle[i];
+                newCache[newCacheCount++] = v;
+
+                // Remove the triangle from the triangles of this vertex
+                auto vertexTriangleList = vertexTriangles.GetData() + offsets[v];
+                auto& remaining         = remainingTriangles[v];
+                for (u32 j = 0; j < remaining; j++)
+                {
+                    if (vertexTriangleList[j] == bestTriangle)
+                    {
+                        vertexTriangleList[j] = vertexTriangleList[remaining - 1];
+                        break;
+                    }
+                }
+                remaining--;
+            }
+
+            for (u32 i = 0; i < cacheCount; i++)
+            {
+                const auto v = cache[i];
+                if (v != triangle[0] && v != triangle[1] && v != triangle[2]) newCache[newCacheCount++] = v;
+            }
+
+            // Update the scores of every vertex that is (or was) in the cache
+            for (u32 i = 0; i < newCacheCount; i++)
+            {
+                const auto v       = newCache[i];
+                const i32 position = i < FORSYTH_CACHE_SIZE ? static_cast<i32>(i) : -1;
+                vertexScores[v]    = scores.Get(position, remainingTriangles[v]);
+            }
+
+            // Recalculate the scores of the triangles that use the vertices in our cache and pick the best one as our next triangle
+            bestTriangle = INVALID_ID;
+            bestScore    = -1.0f;
+            for (u32 i = 0; i < newCacheCount; i++)
+            {
+                const auto v                  = newCache[i];
+                const auto vertexTriangleList = vertexTriangles.GetData() + offsets[v];
+                for (u32 j = 0; j < remainingTriangles[v]; j++)
+                {
+                    const auto t     = vertexTriangleList[j];
+                    const auto score = TriangleScore(t);
+                    if (score > bestScore)
+                    {
+                        bestScore    = score;
+                        bestTriangle = t;
+                    }
+                }
+            }
+
+            // Vertices that were pushed out of the cache are no longer tracked
+            cacheCount = std::min(newCacheCount, FORSYTH_CACHE_SIZE);
+            std::copy_n(newCache, cacheCount, cache);
+        }
+
+        indices = std::move(output);
+    }
+
+    void OptimizeOverdraw(DynamicArray<u32>& indices, const DynamicArray<Vertex3D>& vertices, const f32 threshold)
+    {
+        const auto triangleCount = static_cast<u32>(indices.Size() / 3);
+        if (triangleCount == 0) return;
+
+        // Split the triangles into clusters. A new cluster starts where the cache is flushed (all 3 vertices of a triangle miss the
+        // cache) or as soon as the cluster by itself has a cache miss ratio that is close enough to that of the entire mesh. Reordering
+        // clusters (instead of triangles) keeps most of the vertex cache efficiency.
+        const f32 meshACMR = CalculateACMR(indices, vertices.Size(), GEOMETRY_VERTEX_CACHE_SIZE);
+
+        DynamicArray<u32> timestamps;
+        timestamps.Resize(vertices.Size());
+        u32 timestamp = GEOMETRY_VERTEX_CACHE_SIZE + 1;
+
+        DynamicArray<u32> clusterStarts;
+        clusterStarts.PushBack(0);
+        u32 clusterMisses = 0;
+        for (u32 t = 0; t < triangleCount; t++)
+        {
+            u32 misses = 0;
+            for (u32 i = 0; i < 3; i++)
+            {
+                const auto v = indices[t * 3 + i];
+                if (timestamp - timestamps[v] > GEOMETRY_VERTEX_CACHE_SIZE)
+                {
+                    timestamps[v] = timestamp++;
+                    misses++;
+                }
+            }
+
+            const auto clusterStart = clusterStarts[clusterStarts.Size() - 1];
+            if (t > clusterStart && misses == 3)
+            {
+                // Hard boundary
+                clusterStarts.PushBack(t);
+                clusterMisses = misses;
+                continue;
+            }
+
+            clusterMisses += misses;
+            const auto clusterTriangles = t + 1 - clusterStart;
+            if (static_cast<f32>(clusterMisses) / static_cast<f32>(clusterTriangles) <= meshACMR * threshold && t + 1 < triangleCount)
+            {
+                // Soft boundary
+                clusterStarts.PushBack(t + 1);
+                clusterMisses = 0;
+            }
+        }
+
+        const auto clusterCount = static_cast<u32>(clusterStarts.Size());
+        if (clusterCount == 1) return;
+
+        // Calculate the (area weighted) centroid and normal of every cluster and of the entire mesh
+        struct Cluster
+        {
+            u32 start = 0;
+            u32 end   = 0;
+            vec3 centroid;
+            vec3 normal;
+            f32 sortKey = 0.0f;
+        };
+
+        DynamicArray<Cluster> clusters(clusterCount);
+        vec3 meshCentroid(0.0f);
+        f32 meshArea = 0.0f;
+        for (u32 c = 0; c < clusterCount; c++)
+        {
+            auto& cluster = clusters.EmplaceBack();
+            cluster.start = clusterStarts[c];
+            cluster.end   = c + 1 < clusterCount ? clusterStarts[c + 1] : triangleCount;
+
+            vec3 centroid(0.0f);
+            vec3 normal(0.0f);
+            f32 area = 0.0f;
+            for (u32 t = cluster.start; t < cluster.end; t++)
+            {
+                const auto& p0 = vertices[indices[t * 3 + 0]].position;
+                const auto& p1 = vertices[indices[t * 3 + 1]].position;
+                const auto& p2 = vertices[indices[t * 3 + 2]].position;
+
+                // The length of the cross product is twice the area of the triangle
+                const vec3 n         = cross(p1 - p0, p2 - p0);
+                const f32 doubleArea = length(n);
+
+                centroid += (p0 + p1 + p2) * (doubleArea / 3.0f);
+                normal += n;
+                area += doubleArea;
+            }
+
+            meshCentroid += centroid;
+            meshArea += area;
+
+            cluster.centroid = area > 0.0f ? centroid / area : vertices[indices[cluster.start * 3]].position;
+            cluster.normal   = length(normal) > 0.0f ? normalize(normal) : vec3(0.0f);
+        }
+
+        if (meshArea > 0.0f) meshCentroid /= meshArea;
+
+        // Clusters that face away from the center of the mesh are likely in front of the clusters that face towards it,
+        // so drawing them first means more of the pixels of the other clusters will be rejected by the depth test
+        for (auto& cluster : clusters)
+        {
+            cluster.sortKey = dot(cluster.centroid - meshCentroid, cluster.normal);
+        }
+
+        std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster& a, const Cluster& b) { return a.sortKey > b.sortKey; });
+
+        DynamicArray<u32> output(indices.Size());
+        for (const auto& cluster : clusters)
+        {
+            for (u64 i = cluster.start * 3ull; i < cluster.end * 3ull; i++)
+            {
+                output.PushBack(indices[i]);
+            }
+        }
+
+        indices = std::move(output);
+    }
+
+    void OptimizeGeometry(GeometryConfig& config)
+    {
+        const f32 before = CalculateACMR(config.indices, config.vertices.Size());
+
+        OptimizeVertexCache(config.indices, config.vertices.Size());
+        OptimizeOverdraw(config.indices, config.vertices);
 
-        u64 removedCount = oldVertexCount - uniqueVertexCount;
-        INFO_LOG("Removed {} vertices, Originally: {} | Now: {}", removedCount, oldVertexCount, uniqueVertexCount);
+        const f32 after = CalculateACMR(config.indices, config.vertices.Size());
+        INFO_LOG("Optimized geometry: '{}'. ACMR went from: {:.3f} to: {:.3f}.", config.name, before, after);
     }
 
     UIGeometryConfig GenerateUIQuadConfig(const char* name, const u16vec2& size, const u16vec2& atlasSize, const u16vec2& atlasMin,
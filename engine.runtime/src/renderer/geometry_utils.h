@@ -30,8 +30,30 @@ namespace C3D::GeometryUtils
     void GenerateTangents(DynamicArray<Vertex3D>& vertices, const DynamicArray<u32>& indices);
     void GenerateTerrainTangents(DynamicArray<TerrainVertex>& vertices, const DynamicArray<u32>& indices, u32 indexCount);
 
+    /** @brief The size of the (FIFO) post-transform vertex cache that we assume GPUs have when calculating the ACMR. */
+    constexpr u32 GEOMETRY_VERTEX_CACHE_SIZE = 16;
+
+    /** @brief Merges all vertices that are exactly equal and updates the indices to match. Runs in O(n) by hashing the vertices. */
     void DeduplicateVertices(GeometryConfig& config);
 
+    /**
+     * @brief Calculates the average cache miss ratio (the number of vertices that need to be transformed per triangle).
+     * The result is between 0.5 (for a very large regular grid) and 3.0 (no vertex is ever reused).
+     */
+    f32 CalculateACMR(const DynamicArray<u32>& indices, u64 vertexCount, u32 cacheSize = GEOMETRY_VERTEX_CACHE_SIZE);
+
+    /** @brief Reorders the triangles for better post-transform vertex cache reuse using Forsyth's linear-speed algorithm. */
+    void OptimizeVertexCache(DynamicArray<u32>& indices, u64 vertexCount);
+
+    /**
+     * @brief Reorders clusters of triangles so the triangles that are most likely to occlude others are drawn first (like Tipsify).
+     * Should run after OptimizeVertexCache(). Clusters are formed such that the ACMR gets at most threshold times worse.
+     */
+    void OptimizeOverdraw(DynamicArray<u32>& indices, const DynamicArray<Vertex3D>& vertices, f32 threshold = 1.05f);
+
+    /** @brief Runs both OptimizeVertexCache() and OptimizeOverdraw() on the provided geometry. */
+    void OptimizeGeometry(GeometryConfig& config);
+
     UIGeometryConfig GenerateUIQuadConfig(const char* name, const u16vec2& size, const u16vec2& atlasSize, const u16vec2& atlasMin,
                                           const u16vec2& atlasMax);
 
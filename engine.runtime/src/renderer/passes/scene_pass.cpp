@@ -36,7 +36,7 @@ namespace C3D
 
     ScenePass::ScenePass() : Renderpass("SCENE") {}
 
-    bool ScenePass::Initialize(const C3D::LinearAllocator* frameAllocator)
+    bool ScenePass::Initialize(const C3D::FrameAllocator* frameAllocator)
     {
         C3D::RenderpassConfig pass;
         pass.name       = "Renderpass.Scene";
@@ -104,6 +104,7 @@ namespace C3D
         m_debugLocations.model      = m_colorShader->GetUniformIndex("model");
 
         m_geometries.SetAllocator(frameAllocator);
+        m_geometryBatches.SetAllocator(frameAllocator);
         m_terrains.SetAllocator(frameAllocator);
         m_debugGeometries.SetAllocator(frameAllocator);
         m_directionalLights.SetAllocator(frameAllocator);
@@ -151,6 +152,7 @@ namespace C3D
                             ShadowMapCascadeData* cascadeData)
     {
         m_geometries.Reset();
+        m_geometryBatches.Reset();
         m_terrains.Reset();
         m_debugGeometries.Reset();
         m_directionalLights.Reset();
@@ -186,6 +188,20 @@ namespace C3D
         scene.QueryMeshes(frameData, frustum, cameraPos, m_geometries);
         frameData.drawnMeshCount = m_geometries.Size();
 
+        // Merge meshes that share their geometry and material into instanced draws and upload all their model matrices at once
+        if (!m_geometries.Empty())
+        {
+            const auto models = frameData.allocator->Allocate<mat4>(MemoryType::Array, m_geometries.Size());
+            RenderBatch::Build(m_geometries, m_geometryBatches, models);
+
+            if (!Renderer.UploadInstanceData(frameData, models, m_geometries.Size(), m_geometryInstanceOffset))
+            {
+                ERROR_LOG("Failed to upload the instance data for: {} meshes. Skipping them this frame.", m_geometries.Size());
+                m_geometryBatches.Reset();
+            }
+        }
+        frameData.meshDrawCallCount = m_geometryBatches.Size();
+
         // Get all terrains in our current frustum from the scene
         scene.QueryTerrains(frameData, frustum, cameraPos, m_terrains);
         frameData.drawnTerrainCount = m_terrains.Size();
@@ -277,7 +293,7 @@ namespace C3D
         }
 
         // Static geometry
-        if (!m_geometries.Empty())
+        if (!m_geometryBatches.Empty())
         {
             if (!Shaders.UseById(m_pbrShader->id))
             {
@@ -296,8 +312,9 @@ namespace C3D
 
             u32 currentMaterialId = INVALID_ID;
 
-            for (const auto& data : m_geometries)
+            for (const auto& batch : m_geometryBatches)
             {
+                const auto& data = m_geometries[batch.first];
                 C3D::Material* m = data.material ? data.material : Materials.GetDefault();
 
                 if (m->id != currentMaterialId)
@@ -316,11 +333,9 @@ namespace C3D
                     currentMaterialId = m->id;
                 }
 
-                // Apply the locals
-                Materials.ApplyLocal(frameData, m, &data.model);
-
-                // Draw the static geometry
-                Renderer.DrawGeometry(data);
+                // Draw all instances of this geometry at once. The model matrices come from the instance buffer so there are no locals
+                const u64 instanceOffset = m_geometryInstanceOffset + (static_cast<u64>(batch.first) * GEOMETRY_INSTANCE_STRIDE);
+                Renderer.DrawGeometryInstanced(frameData, data, instanceOffset, batch.count);
             }
         }
 
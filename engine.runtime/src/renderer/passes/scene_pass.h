@@ -2,8 +2,9 @@
 #pragma once
 #include "containers/dynamic_array.h"
 #include "defines.h"
-#include "memory/allocators/linear_allocator.h"
+#include "memory/allocators/frame_allocator.h"
 #include "renderer/passes/shadow_map_pass.h"
+#include "renderer/render_batch.h"
 #include "renderer/renderer_types.h"
 #include "renderer/rendergraph/renderpass.h"
 #include "resources/debug/debug_types.h"
@@ -24,7 +25,7 @@ namespace C3D
     public:
         ScenePass();
 
-        bool Initialize(const LinearAllocator* frameAllocator) override;
+        bool Initialize(const FrameAllocator* frameAllocator) override;
         bool LoadResources() override;
         bool Prepare(const Viewport& viewport, Camera* camera, FrameData& frameData, Scene& scene, u32 renderMode,
                      const DynamicArray<DebugLine3D>& debugLines, const DynamicArray<DebugBox3D>& debugBoxes,
@@ -42,11 +43,15 @@ namespace C3D
 
         vec4 m_cascadeSplits;
 
-        DynamicArray<GeometryRenderData, LinearAllocator> m_geometries;
-        DynamicArray<GeometryRenderData, LinearAllocator> m_terrains;
-        DynamicArray<GeometryRenderData, LinearAllocator> m_debugGeometries;
-        DynamicArray<PointLightData, LinearAllocator> m_pointLights;
-        DynamicArray<DirectionalLightData, LinearAllocator> m_directionalLights;
+        DynamicArray<GeometryRenderData, FrameAllocator> m_geometries;
+        /** @brief Runs of geometries that share their geometry and material which we draw with a single instanced draw. */
+        DynamicArray<GeometryInstanceBatch, FrameAllocator> m_geometryBatches;
+        /** @brief The offset in this frame's instance buffer of the model matrix of the first geometry. */
+        u64 m_geometryInstanceOffset = 0;
+        DynamicArray<GeometryRenderData, FrameAllocator> m_terrains;
+        DynamicArray<GeometryRenderData, FrameAllocator> m_debugGeometries;
+        DynamicArray<PointLightData, FrameAllocator> m_pointLights;
+        DynamicArray<DirectionalLightData, FrameAllocator> m_directionalLights;
 
         TextureHandle m_irradianceCubeTexture = INVALID_ID;
 
@@ -27,7 +27,7 @@ namespace C3D
 
     ShadowMapPass::ShadowMapPass(const C3D::String& name, const ShadowMapPassConfig& config) : Renderpass(name), m_config(config) {}
 
-    bool ShadowMapPass::Initialize(const C3D::LinearAllocator* frameAllocator)
+    bool ShadowMapPass::Initialize(const C3D::FrameAllocator* frameAllocator)
     {
         u8 frameCount = Renderer.GetWindowAttachmentCount();
 
@@ -123,7 +123,6 @@ namespace C3D
 
         m_locations.projections  = m_shader->GetUniformIndex("projections");
         m_locations.views        = m_shader->GetUniformIndex("views");
-        m_locations.model        = m_shader->GetUniformIndex("model");
         m_locations.cascadeIndex = m_shader->GetUniformIndex("cascadeIndex");
         m_locations.colorMap     = m_shader->GetUniformIndex("colorMap");
 
@@ -135,6 +134,7 @@ namespace C3D
 
         m_cullingData.geometries.SetAllocator(frameAllocator);
         m_cullingData.terrains.SetAllocator(frameAllocator);
+        m_geometryBatches.SetAllocator(frameAllocator);
 
         return true;
     }
@@ -257,8 +257,9 @@ namespace C3D
     {
         m_cullingData.geometries.Reset();
         m_cullingData.terrains.Reset();
+        m_geometryBatches.Reset();
 
-        DynamicArray<DirectionalLightData, LinearAllocator> lights(frameData.allocator);
+        DynamicArray<DirectionalLightData, FrameAllocator> lights(frameData.allocator);
         scene.QueryDirectionalLights(frameData, lights);
 
         auto dirLight = lights.Empty() ? nullptr : &lights[0];
@@ -389,6 +390,30 @@ namespace C3D
         return true;
     }
 
+    bool ShadowMapPass::PrepareBatches(FrameData& frameData)
+    {
+        m_geometryBatches.Reset();
+
+        auto& geometries = m_cullingData.geometries;
+        if (!geometries.Empty())
+        {
+            // Every cascade draws the same geometries so we only need to upload their model matrices once
+            const auto models = frameData.allocator->Allocate<mat4>(MemoryType::Array, geometries.Size());
+            RenderBatch::Build(geometries, m_geometryBatches, models);
+
+            if (!Renderer.UploadInstanceData(frameData, models, geometries.Size(), m_geometryInstanceOffset))
+            {
+                ERROR_LOG("Failed to upload the instance data for: {} shadow casters.", geometries.Size());
+                m_geometryBatches.Reset();
+                frameData.shadowMeshDrawCallCount = 0;
+                return false;
+            }
+        }
+
+        frameData.shadowMeshDrawCallCount = m_geometryBatches.Size();
+        return true;
+    }
+
     bool ShadowMapPass::Execute(const C3D::FrameData& frameData)
     {
         Renderer.SetActiveViewport(&m_viewport);
@@ -474,8 +499,17 @@ namespace C3D
             }
 
             // Static geometries
-            for (auto& geometry : m_cullingData.geometries)
+            if (!m_geometryBatches.Empty())
+            {
+                // Apply the locals. The model matrices come from the instance buffer so we only need to set them once per cascade
+                Shaders.BindLocal();
+                Shaders.SetUniformByIndex(m_locations.cascadeIndex, &c);
+                Shaders.ApplyLocal(frameData);
+            }
+
+            for (const auto& batch : m_geometryBatches)
             {
+                const auto& geometry     = m_cullingData.geometries[batch.first];
                 u32 bindId               = INVALID_ID;
                 C3D::TextureMap* bindMap = nullptr;
                 u64* renderNumber        = nullptr;
@@ -519,13 +553,9 @@ namespace C3D
                 *renderNumber = frameData.frameNumber;
                 *drawIndex    = frameData.drawIndex;
 
-                // Apply the locals
-                Shaders.BindLocal();
-                Shaders.SetUniformByIndex(m_locations.model, &geometry.model);
-                Shaders.SetUniformByIndex(m_locations.cascadeIndex, &c);
-                Shaders.ApplyLocal(frameData);
-
-                Renderer.DrawGeometry(geometry);
+                // Draw all instances of this geometry at once
+                const u64 instanceOffset = m_geometryInstanceOffset + (static_cast<u64>(batch.first) * GEOMETRY_INSTANCE_STRIDE);
+                Renderer.DrawGeometryInstanced(frameData, geometry, instanceOffset, batch.count);
             }
 
             // Terrain
@@ -3,7 +3,8 @@
 #include "containers/dynamic_array.h"
 #include "defines.h"
 #include "frame_data.h"
-#include "memory/allocators/linear_allocator.h"
+#include "memory/allocators/frame_allocator.h"
+#include "renderer/render_batch.h"
 #include "renderer/renderer_types.h"
 #include "renderer/rendergraph/renderpass.h"
 #include "renderer/viewport.h"
@@ -62,8 +63,8 @@ namespace C3D
         f32 radius;
 
         // The meshes and terrains visible in our shadow passes
-        DynamicArray<GeometryRenderData, LinearAllocator> geometries;
-        DynamicArray<GeometryRenderData, LinearAllocator> terrains;
+        DynamicArray<GeometryRenderData, FrameAllocator> geometries;
+        DynamicArray<GeometryRenderData, FrameAllocator> terrains;
     };
 
     class C3D_API ShadowMapPass : public Renderpass
@@ -72,9 +73,11 @@ namespace C3D
         ShadowMapPass();
         ShadowMapPass(const String& name, const ShadowMapPassConfig& config);
 
-        bool Initialize(const LinearAllocator* frameAllocator) override;
+        bool Initialize(const FrameAllocator* frameAllocator) override;
         bool LoadResources() override;
         bool Prepare(FrameData& frameData, const Viewport& viewport, Camera* camera, Scene& scene);
+        /** @brief Merges the shadow casters into instanced draws. Should be called once the culling data has been filled. */
+        bool PrepareBatches(FrameData& frameData);
         bool Execute(const FrameData& frameData) override;
         void Destroy() override;
 
@@ -107,6 +110,11 @@ namespace C3D
         // Data to be used for culling
         CullingData m_cullingData;
 
+        // Runs of shadow casters that share their geometry and material which we draw with a single instanced draw
+        DynamicArray<GeometryInstanceBatch, FrameAllocator> m_geometryBatches;
+        // The offset in this frame's instance buffer of the model matrix of the first shadow caster
+        u64 m_geometryInstanceOffset = 0;
+
         // Track instance updates per frame
         C3D::DynamicArray<ShadowShaderInstanceData> m_instances;
         // Number of instances
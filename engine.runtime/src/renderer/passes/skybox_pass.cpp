@@ -17,7 +17,7 @@ namespace C3D
 
     SkyboxPass::SkyboxPass() : Renderpass("SKYBOX") {}
 
-    bool SkyboxPass::Initialize(const LinearAllocator* frameAllocator)
+    bool SkyboxPass::Initialize(const FrameAllocator* frameAllocator)
     {
         RenderpassConfig pass = {};
         pass.name             = "Renderpass.Skybox";
@@ -23,7 +23,7 @@ namespace C3D
     public:
         SkyboxPass();
 
-        bool Initialize(const LinearAllocator* frameAllocator) override;
+        bool Initialize(const FrameAllocator* frameAllocator) override;
         bool Prepare(const Viewport& viewport, Camera* camera, Skybox& skybox);
         bool Execute(const FrameData& frameData) override;
 
@@ -0,0 +1,31 @@
+#include "render_batch.h"
+
+#include "profiler/profiler.h"
+
+namespace C3D::RenderBatch
+{
+    void Build(const DynamicArray<GeometryRenderData, FrameAllocator>& data,
+               DynamicArray<GeometryInstanceBatch, FrameAllocator>& outBatches, mat4* outModels)
+    {
+        C3D_PROFILE_FUNCTION();
+
+        outBatches.Reset();
+
+        const auto count = static_cast<u32>(data.Size());
+        for (u32 i = 0; i < count; ++i)
+        {
+            const auto& item = data[i];
+            outModels[i]     = item.model;
+
+            if (!outBatches.Empty() && CanMerge(data[outBatches.Back().first], item))
+            {
+                // This item uses the same geometry and material as the current batch so it becomes another instance of it
+                outBatches.Back().count++;
+            }
+            else
+            {
+                outBatches.PushBack({ i, 1 });
+            }
+        }
+    }
+}  // namespace C3D::RenderBatch
@@ -0,0 +1,43 @@
+#pragma once
+#include "containers/dynamic_array.h"
+#include "defines.h"
+#include "memory/allocators/frame_allocator.h"
+#include "renderer_types.h"
+
+namespace C3D
+{
+    /** @brief A run of consecutive items in a render list that can be drawn with a single instanced draw. */
+    struct GeometryInstanceBatch
+    {
+        /** @brief The index of the first item of this batch in the render list. */
+        u32 first = 0;
+        /** @brief The number of items (and therefore instances) in this batch. */
+        u32 count = 0;
+    };
+
+    /**
+     * @brief Merges render data that shares it's geometry and material into instanced draws.
+     * Relies on the render list being sorted (see RenderSort) so all items that can be merged are next to each other.
+     */
+    namespace RenderBatch
+    {
+        /** @brief Checks if both items can be drawn by the same instanced draw (same geometry, material and winding). */
+        inline bool CanMerge(const GeometryRenderData& a, const GeometryRenderData& b)
+        {
+            return a.vertexBufferOffset == b.vertexBufferOffset && a.vertexCount == b.vertexCount &&
+                   a.indexBufferOffset == b.indexBufferOffset && a.indexCount == b.indexCount && a.material == b.material &&
+                   a.windingInverted == b.windingInverted;
+        }
+
+        /**
+         * @brief Splits the render data into batches of consecutive items that can be drawn with a single instanced draw.
+         *
+         * @param data The (sorted) render data
+         * @param outBatches The batches. Every item ends up in exactly one batch and the batches are in the order of the render data
+         * @param outModels Memory for at least data.Size() matrices which receives the model matrix of every item (in order). So the
+         * model matrices of a batch start at outModels + batch.first
+         */
+        C3D_API void Build(const DynamicArray<GeometryRenderData, FrameAllocator>& data,
+                           DynamicArray<GeometryInstanceBatch, FrameAllocator>& outBatches, mat4* outModels);
+    }  // namespace RenderBatch
+}  // namespace C3D
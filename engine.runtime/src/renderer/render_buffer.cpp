@@ -6,8 +6,9 @@
 
 namespace C3D
 {
-    // TODO: Setting SMALLEST_POSSIBLE_FREELIST_ALLOCATION here to 8 could cause problems potentially.
-    constexpr static auto SMALLEST_POSSIBLE_FREELIST_ALLOCATION = 8;
+    // NOTE: This only determines how many nodes our freelist reserves. Our allocations are entire geometries (a single vertex already
+    // takes 60 bytes) so 16 bytes still gives us far more nodes than we will ever have free blocks, at half the memory cost of 8 bytes.
+    constexpr static auto SMALLEST_POSSIBLE_FREELIST_ALLOCATION = 16;
 
     RenderBuffer::RenderBuffer(const String& name) : m_name(name) {}
 
@@ -78,7 +79,7 @@ namespace C3D
             // A pointer to our old memory block (which will get populated by the resize method)
             void* oldMemory = nullptr;
             // Resize our freelist
-            if (!m_freeList.Resize(newMemory, newMemoryRequirement, &oldMemory))
+            if (!m_freeList.Resize(newMemory, newMemoryRequirement, newTotalSize, &oldMemory))
             {
                 // Our resize failed
                 ERROR_LOG("Failed to resize internal freelist.");
@@ -110,6 +111,12 @@ namespace C3D
         }
         else if (m_trackType == RenderBufferTrackType::Linear)
         {
+            if (m_offset + size > totalSize)
+            {
+                ERROR_LOG("Not enough space left in: '{}' to allocate: {} bytes.", m_name, size);
+                return false;
+            }
+
             outOffset = m_offset;
             m_offset += size;
             return true;
@@ -137,6 +144,14 @@ namespace C3D
         return true;
     }
 
+    bool RenderBuffer::GetFragmentationReport(FragmentationReport& outReport) const
+    {
+        if (m_trackType != RenderBufferTrackType::FreeList) return false;
+
+        m_freeList.GetFragmentationReport(outReport);
+        return true;
+    }
+
     bool RenderBuffer::Clear(bool zeroMemory)
     {
         if (zeroMemory)
@@ -14,6 +14,8 @@ namespace C3D
         Vertex,
         /** @brief Buffer used for index data. */
         Index,
+        /** @brief Buffer used for per-instance vertex data. Host visible since it's rewritten every frame. */
+        Instance,
         /** @brief Buffer used for uniform data. */
         Uniform,
         /** @brief Buffer used for staging  (i.e. host-visible to device-local memory). */
@@ -59,6 +61,9 @@ namespace C3D
         virtual bool Free(u64 size, u64 offset);
         virtual bool Clear(bool zeroMemory);
 
+        /** @brief Fills out a report about the fragmentation of this buffer. Only available for buffers that use a FreeList. */
+        bool GetFragmentationReport(FragmentationReport& outReport) const;
+
         virtual bool Read(u64 offset, u64 size, void** outMemory);
         virtual bool LoadRange(u64 offset, u64 size, const void* data, bool includeInFrameWorkload);
         virtual bool CopyRange(u64 srcOffset, RenderBuffer* dest, u64 dstOffset, u64 size, bool includeInFrameWorkload);
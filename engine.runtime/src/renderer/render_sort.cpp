@@ -0,0 +1,121 @@
+#include "render_sort.h"
+
+#include <cstring>
+#include <utility>
+
+#include "profiler/profiler.h"
+
+namespace C3D::RenderSort
+{
+    constexpr u32 RADIX_BITS    = 8;
+    constexpr u32 RADIX_BUCKETS = 1 << RADIX_BITS;
+    constexpr u32 RADIX_PASSES  = 64 / RADIX_BITS;
+
+    void SortItems(RenderSortItem* items, RenderSortItem* scratch, const u64 count)
+    {
+        if (count < 2) return;
+
+        // Lists that are already in order (like the UI which is always drawn in submission order) don't need any work
+        bool sorted = true;
+        for (u64 i = 1; i < count && sorted; ++i)
+        {
+            sorted = items[i - 1].key <= items[i].key;
+        }
+        if (sorted) return;
+
+        // Build the histograms for all digits in a single pass over our keys
+        u64 histograms[RADIX_PASSES][RADIX_BUCKETS] = {};
+        for (u64 i = 0; i < count; ++i)
+        {
+            const auto key = items[i].key;
+            for (u32 pass = 0; pass < RADIX_PASSES; ++pass)
+            {
+                histograms[pass][(key >> (pass * RADIX_BITS)) & (RADIX_BUCKETS - 1)]++;
+            }
+        }
+
+        auto src = items;
+        auto dst = scratch;
+
+        for (u32 pass = 0; pass < RADIX_PASSES; ++pass)
+        {
+            auto& histogram  = histograms[pass];
+            const auto shift = pass * RADIX_BITS;
+
+            // If all keys have the same digit this pass would not change the order so we can skip it
+            if (histogram[(src[0].key >> shift) & (RADIX_BUCKETS - 1)] == count) continue;
+
+            // Turn our histogram into the offset of every bucket
+            u64 offset = 0;
+            for (auto& bucket : histogram)
+            {
+                const auto size = bucket;
+                bucket          = offset;
+                offset += size;
+            }
+
+            for (u64 i = 0; i < count; ++i)
+            {
+                const auto& item = src[i];
+                dst[histogram[(item.key >> shift) & (RADIX_BUCKETS - 1)]++] = item;
+            }
+
+            std::swap(src, dst);
+        }
+
+        // After an odd number of passes our result is in the scratch memory
+        if (src != items)
+        {
+            std::memcpy(items, src, sizeof(RenderSortItem) * count);
+        }
+    }
+
+    void Sort(const FrameAllocator* allocator, DynamicArray<GeometryRenderData, FrameAllocator>& data)
+    {
+        C3D_PROFILE_FUNCTION();
+
+        const auto count = data.Size();
+        if (count < 2) return;
+
+        // Lists that are already in order (for example static scenes viewed from the same position) don't need any work
+        // NOTE: We check this here as well so we don't need to allocate our scratch memory for these lists
+        bool sorted = true;
+        for (u64 i = 1; i < count && sorted; ++i)
+        {
+            sorted = data[i - 1].sortKey <= data[i].sortKey;
+        }
+        if (sorted) return;
+
+        // We only sort the (small) keys and indices and move the (large) render data once afterwards
+        const auto items   = allocator->Allocate<RenderSortItem>(MemoryType::Array, count * 2);
+        const auto scratch = items + count;
+
+        for (u64 i = 0; i < count; ++i)
+        {
+            items[i] = { data[i].sortKey, static_cast<u32>(i) };
+        }
+
+        SortItems(items, scratch, count);
+
+        // Apply the permutation in place by following it's cycles. Every visited item is marked by pointing it to itself.
+        for (u64 i = 0; i < count; ++i)
+        {
+            if (items[i].index == i) continue;
+
+            GeometryRenderData temp = data[i];
+
+            auto current = i;
+            while (true)
+            {
+                const auto next      = items[current].index;
+                items[current].index = static_cast<u32>(current);
+                if (next == i) break;
+
+                data[current] = data[next];
+                current       = next;
+            }
+
+            data[current] = temp;
+        }
+    }
+}  // namespace C3D::RenderSort
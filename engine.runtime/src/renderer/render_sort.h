@@ -0,0 +1,112 @@
+#pragma once
+#include <bit>
+
+#include "containers/dynamic_array.h"
+#include "defines.h"
+#include "memory/allocators/frame_allocator.h"
+#include "renderer_types.h"
+
+namespace C3D
+{
+    /** @brief The pass that a render item belongs to. Stored in the most significant bits of the sort key. */
+    enum class RenderSortPass : u8
+    {
+        Shadow = 0,
+        Scene  = 1,
+        UI     = 2,
+    };
+
+    struct RenderSortItem
+    {
+        /** @brief The packed sort key of the item. */
+        u64 key;
+        /** @brief The index of the item in the list that is being sorted. */
+        u32 index;
+    };
+
+    /**
+     * @brief Builds packed 64-bit sort keys for render items and sorts render lists by them.
+     * Keys are laid out (from the most to the least significant bit) as:
+     *  - Opaque:      pass (4) | translucent = 0 (1) | shader (8) | material (16) | geometry (19) | depth (16, front to back)
+     *  - Translucent: pass (4) | translucent = 1 (1) | depth (16, back to front) | shader (8) | material (16) | geometry (19)
+     * So opaque items are grouped by state (with all items that share a geometry next to each other so they can be drawn instanced, see
+     * RenderBatch) and translucent items are drawn back to front after all opaque items of the same pass.
+     */
+    namespace RenderSort
+    {
+        constexpr u32 PASS_BITS        = 4;
+        constexpr u32 TRANSLUCENT_BITS = 1;
+        constexpr u32 SHADER_BITS      = 8;
+        constexpr u32 MATERIAL_BITS    = 16;
+        constexpr u32 DEPTH_BITS       = 16;
+        constexpr u32 GEOMETRY_BITS    = 19;
+
+        static_assert(PASS_BITS + TRANSLUCENT_BITS + SHADER_BITS + MATERIAL_BITS + DEPTH_BITS + GEOMETRY_BITS == 64,
+                      "Sort key fields must add up to 64 bits.");
+
+        constexpr u64 Field(const u64 value, const u32 bits, const u32 shift) { return (value & ((1ull << bits) - 1)) << shift; }
+
+        /**
+         * @brief Quantizes a distance into a depth bucket. Uses the upper bits of the (positive) float so the order is preserved and
+         * buckets get coarser further away from the camera, without needing to know the far clip.
+         */
+        inline u16 QuantizeDepth(const f32 distance)
+        {
+            // NOTE: Negative (and NaN) distances are treated as 0. For positive floats the bit pattern increases with the value.
+            const auto bits = std::bit_cast<u32>(distance > 0.0f ? distance : 0.0f);
+            return static_cast<u16>(bits >> (32 - DEPTH_BITS - 1));
+        }
+
+        inline u64 MakeOpaqueKey(const RenderSortPass pass, const u32 shaderId, const u32 materialId, const f32 distance,
+                                 const u32 geometryId)
+        {
+            constexpr u32 depthShift    = 0;
+            constexpr u32 geometryShift = depthShift + DEPTH_BITS;
+            constexpr u32 materialShift = geometryShift + GEOMETRY_BITS;
+            constexpr u32 shaderShift   = materialShift + MATERIAL_BITS;
+            constexpr u32 passShift     = 64 - PASS_BITS;
+
+            return Field(static_cast<u64>(pass), PASS_BITS, passShift) | Field(shaderId, SHADER_BITS, shaderShift) |
+                   Field(materialId, MATERIAL_BITS, materialShift) | Field(QuantizeDepth(distance), DEPTH_BITS, depthShift) |
+                   Field(geometryId, GEOMETRY_BITS, geometryShift);
+        }
+
+        inline u64 MakeTranslucentKey(const RenderSortPass pass, const u32 shaderId, const u32 materialId, const f32 distance,
+                                      const u32 geometryId)
+        {
+            constexpr u32 geometryShift    = 0;
+            constexpr u32 materialShift    = geometryShift + GEOMETRY_BITS;
+            constexpr u32 shaderShift      = materialShift + MATERIAL_BITS;
+            constexpr u32 depthShift       = shaderShift + SHADER_BITS;
+            constexpr u32 translucentShift = depthShift + DEPTH_BITS;
+            constexpr u32 passShift        = 64 - PASS_BITS;
+
+            // Invert the depth so the items that are furthest away are drawn first
+            const u16 depth = ~QuantizeDepth(distance);
+
+            return Field(static_cast<u64>(pass), PASS_BITS, passShift) | Field(1, TRANSLUCENT_BITS, translucentShift) |
+                   Field(depth, DEPTH_BITS, depthShift) | Field(shaderId, SHADER_BITS, shaderShift) |
+                   Field(materialId, MATERIAL_BITS, materialShift) | Field(geometryId, GEOMETRY_BITS, geometryShift);
+        }
+
+        /** @brief Builds a key for passes that have to be drawn in the order they were submitted (like the painter's order of the UI). */
+        inline u64 MakeOrderedKey(const RenderSortPass pass, const u32 order)
+        {
+            return Field(static_cast<u64>(pass), PASS_BITS, 64 - PASS_BITS) | Field(1, TRANSLUCENT_BITS, 64 - PASS_BITS - 1) |
+                   Field(order, 32, 0);
+        }
+
+        /**
+         * @brief Sorts the items by their key with a (stable) LSD radix sort that uses 8 bits per pass.
+         * Passes where every key has the same digit are skipped so keys that only use a few bits are sorted in only a couple of passes.
+         *
+         * @param items The items that should be sorted. Will contain the sorted items afterwards.
+         * @param scratch Memory for at least count items that is used as the second buffer of the sort
+         * @param count The number of items
+         */
+        C3D_API void SortItems(RenderSortItem* items, RenderSortItem* scratch, u64 count);
+
+        /** @brief Sorts the provided render data by their sortKey. The scratch memory is taken from the provided frame allocator. */
+        C3D_API void Sort(const FrameAllocator* allocator, DynamicArray<GeometryRenderData, FrameAllocator>& data);
+    }  // namespace RenderSort
+}  // namespace C3D
@@ -5,6 +5,7 @@
 #include "geometry.h"
 #include "logger/logger.h"
 #include "platform/platform.h"
+#include "profiler/profiler.h"
 #include "renderer_utils.h"
 #include "resources/managers/text_manager.h"
 #include "resources/shaders/shader.h"
@@ -81,6 +82,23 @@ namespace C3D
         }
         m_geometryIndexBuffer->Bind(0);
 
+        // Instance data is rewritten every frame so every window render target gets it's own buffer to avoid overwriting data in flight
+        constexpr u64 instanceBufferSize = GEOMETRY_INSTANCE_STRIDE * 65536;
+        m_instanceBuffers.Reserve(m_windowRenderTargetCount);
+        for (u8 i = 0; i < m_windowRenderTargetCount; ++i)
+        {
+            const auto name     = String::FromFormat("GEOMETRY_INSTANCE_BUFFER_{}", i);
+            const auto instance = m_backendPlugin->CreateRenderBuffer(name, RenderBufferType::Instance, instanceBufferSize,
+                                                                      RenderBufferTrackType::Linear);
+            if (!instance)
+            {
+                ERROR_LOG("Error creating instance buffer.");
+                return false;
+            }
+            instance->Bind(0);
+            m_instanceBuffers.PushBack(instance);
+        }
+
         auto& vSync = CVars.Get("vsync");
         vSync.AddOnChangeCallback([this](const CVar& cvar) { SetFlagEnabled(FlagVSyncEnabled, cvar.GetValue<bool>()); });
 
@@ -98,6 +116,11 @@ namespace C3D
         // Destroy our render buffers
         m_backendPlugin->DestroyRenderBuffer(m_geometryVertexBuffer);
         m_backendPlugin->DestroyRenderBuffer(m_geometryIndexBuffer);
+        for (const auto buffer : m_instanceBuffers)
+        {
+            m_backendPlugin->DestroyRenderBuffer(buffer);
+        }
+        m_instanceBuffers.Destroy();
         // Shutdown our plugin
         m_backendPlugin->Shutdown();
         // Delete the plugin
@@ -118,11 +141,14 @@ namespace C3D
 
     bool RenderSystem::PrepareFrame(FrameData& frameData)
     {
+        C3D_PROFILE_FUNCTION();
+
         // Increment our frame number
         m_backendPlugin->frameNumber++;
 
-        // Reset the draw index for this frame
+        // Reset the draw index and stats for this frame
         m_backendPlugin->drawIndex = 0;
+        m_backendPlugin->stats     = {};
 
         bool result = m_backendPlugin->PrepareFrame(frameData);
 
@@ -131,6 +157,12 @@ namespace C3D
         frameData.drawIndex         = m_backendPlugin->drawIndex;
         frameData.renderTargetIndex = m_backendPlugin->GetWindowAttachmentIndex();
 
+        if (result)
+        {
+            // The previous frame that used this render target is done so we can start filling it's instance buffer from the start again
+            m_instanceBuffers[frameData.renderTargetIndex]->Clear(false);
+        }
+
         return result;
     }
 
@@ -138,6 +170,8 @@ namespace C3D
 
     bool RenderSystem::End(FrameData& frameData) const
     {
+        C3D_PROFILE_FUNCTION();
+
         bool result = m_backendPlugin->End(frameData);
         // Increment the draw index for this frame
         m_backendPlugin->drawIndex++;
@@ -148,6 +182,8 @@ namespace C3D
 
     bool RenderSystem::Present(const FrameData& frameData) const
     {
+        C3D_PROFILE_FUNCTION();
+
         if (!m_backendPlugin->Present(frameData))
         {
             ERROR_LOG("Failed to present. Application is shutting down.");
@@ -351,13 +387,7 @@ namespace C3D
 
     void RenderSystem::DrawGeometry(const GeometryRenderData& data) const
     {
-        static bool currentWindingInverted = data.windingInverted;
-
-        if (currentWindingInverted != data.windingInverted)
-        {
-            currentWindingInverted = data.windingInverted;
-            m_backendPlugin->SetWinding(currentWindingInverted ? RendererWinding::Clockwise : RendererWinding::CounterClockwise);
-        }
+        SetGeometryWinding(data.windingInverted);
 
         bool includesIndexData = data.indexCount > 0;
 
@@ -376,6 +406,45 @@ namespace C3D
         }
     }
 
+    bool RenderSystem::UploadInstanceData(const FrameData& frameData, const mat4* models, const u32 count, u64& outOffset)
+    {
+        const auto buffer = m_instanceBuffers[frameData.renderTargetIndex];
+        const u64 size    = static_cast<u64>(count) * GEOMETRY_INSTANCE_STRIDE;
+
+        if (!buffer->Allocate(size, outOffset))
+        {
+            ERROR_LOG("Failed to allocate space for: {} instances in the instance buffer.", count);
+            return false;
+        }
+
+        if (!buffer->LoadRange(outOffset, size, models, false))
+        {
+            ERROR_LOG("Failed to load: {} instances into the instance buffer.", count);
+            return false;
+        }
+        return true;
+    }
+
+    void RenderSystem::DrawGeometryInstanced(const FrameData& frameData, const GeometryRenderData& data, const u64 instanceOffset,
+                                             const u32 instanceCount) const
+    {
+        SetGeometryWinding(data.windingInverted);
+
+        m_backendPlugin->DrawGeometryInstanced(data, *m_geometryVertexBuffer, *m_geometryIndexBuffer,
+                                               *m_instanceBuffers[frameData.renderTargetIndex], instanceOffset, instanceCount);
+    }
+
+    void RenderSystem::SetGeometryWinding(const bool windingInverted) const
+    {
+        static bool currentWindingInverted = windingInverted;
+
+        if (currentWindingInverted != windingInverted)
+        {
+            currentWindingInverted = windingInverted;
+            m_backendPlugin->SetWinding(currentWindingInverted ? RendererWinding::Clockwise : RendererWinding::CounterClockwise);
+        }
+    }
+
     void RenderSystem::BeginRenderpass(void* pass, const RenderTarget& target) const
     {
         m_backendPlugin->BeginRenderpass(pass, GetActiveViewport(), target);
@@ -407,7 +476,7 @@ namespace C3D
                     {
                         shader.globalUniformSamplerCount++;
 
-                        auto index = shader.uniformNameToIndexMap.Get(uniform.name);
+                        auto index = shader.uniformNameToIndexMap.Get(Name(uniform.name));
                         shader.globalSamplers.PushBack(index);
                     }
                     else
@@ -420,7 +489,7 @@ namespace C3D
                     {
                         shader.instanceUniformSamplerCount++;
 
-                        auto index = shader.uniformNameToIndexMap.Get(uniform.name);
+                        auto index = shader.uniformNameToIndexMap.Get(Name(uniform.name));
                         shader.instanceSamplers.PushBack(index);
                     }
                     else
@@ -597,6 +666,8 @@ namespace C3D
 
     u8 RenderSystem::GetWindowAttachmentCount() const { return m_backendPlugin->GetWindowAttachmentCount(); }
 
+    const RendererStats& RenderSystem::GetStats() const { return m_backendPlugin->stats; }
+
     RenderBuffer* RenderSystem::CreateRenderBuffer(const String& name, const RenderBufferType type, const u64 totalSize,
                                                    RenderBufferTrackType trackType) const
     {
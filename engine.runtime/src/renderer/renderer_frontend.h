@@ -1,5 +1,6 @@
 
 #pragma once
+#include "containers/dynamic_array.h"
 #include "defines.h"
 #include "dynamic_library/dynamic_library.h"
 #include "render_buffer.h"
@@ -145,6 +146,29 @@ namespace C3D
 
         void DrawGeometry(const GeometryRenderData& data) const;
 
+        /**
+         * @brief Copies the provided model matrices into the instance buffer of the current frame.
+         *
+         * @param frameData The frame data associated with this frame.
+         * @param models The model matrices that should be uploaded
+         * @param count The number of model matrices
+         * @param outOffset The offset that should be passed to DrawGeometryInstanced() to draw (a part of) these instances
+         * @return True if successful, false if the instance buffer of the current frame is full
+         */
+        bool UploadInstanceData(const FrameData& frameData, const mat4* models, u32 count, u64& outOffset);
+
+        /**
+         * @brief Draws instanceCount instances of the provided geometry with a single draw call.
+         * The model matrices are read from the instance buffer of the current frame starting at instanceOffset.
+         * NOTE: The currently bound shader must use instancing (see ShaderFlagInstancing)
+         *
+         * @param frameData The frame data associated with this frame.
+         * @param data The geometry that should be drawn
+         * @param instanceOffset The offset (in bytes) of the model matrix of the first instance in the instance buffer
+         * @param instanceCount The number of instances that should be drawn
+         */
+        void DrawGeometryInstanced(const FrameData& frameData, const GeometryRenderData& data, u64 instanceOffset, u32 instanceCount) const;
+
         void BeginRenderpass(void* pass, const RenderTarget& target) const;
         void EndRenderpass(void* pass) const;
 
@@ -232,12 +256,19 @@ namespace C3D
         [[nodiscard]] u8 GetWindowAttachmentIndex() const;
         [[nodiscard]] u8 GetWindowAttachmentCount() const;
 
+        /** @brief Gets the counters for the work that was submitted to the backend in the current frame. */
+        [[nodiscard]] const RendererStats& GetStats() const;
+
     private:
+        void SetGeometryWinding(bool windingInverted) const;
+
         u8 m_windowRenderTargetCount = 0;
         u32 m_frameBufferWidth = 1280, m_frameBufferHeight = 720;
 
         RenderBuffer* m_geometryVertexBuffer;
         RenderBuffer* m_geometryIndexBuffer;
+        /** @brief The per-instance data for instanced draws. One per window render target since it's rewritten every frame. */
+        DynamicArray<RenderBuffer*> m_instanceBuffers;
 
         DynamicLibrary m_backendDynamicLibrary;
         RendererPlugin* m_backendPlugin = nullptr;
@@ -147,6 +147,14 @@ namespace C3D
                                                  RenderBufferTrackType trackType) = 0;
         virtual bool DestroyRenderBuffer(RenderBuffer* buffer)                    = 0;
 
+        /**
+         * @brief Draws instanceCount instances of the provided geometry with a single draw call.
+         * Instance i reads it's model matrix from the instance buffer at instanceOffset + (i * GEOMETRY_INSTANCE_STRIDE).
+         * Only valid for shaders that use instancing (see ShaderFlagInstancing).
+         */
+        virtual void DrawGeometryInstanced(const GeometryRenderData& data, RenderBuffer& vertexBuffer, RenderBuffer& indexBuffer,
+                                           RenderBuffer& instanceBuffer, u64 instanceOffset, u32 instanceCount) = 0;
+
         virtual void WaitForIdle() = 0;
 
         /** @brief Begins a debug label with the provided text and color. */
@@ -168,6 +176,8 @@ namespace C3D
         RendererPluginType type = RendererPluginType::Unknown;
         u64 frameNumber         = INVALID_ID_U64;
         u8 drawIndex            = INVALID_ID_U8;
+        /** @brief Counters for the current frame. These are reset every frame but only backends that track them will fill them in. */
+        RendererStats stats;
 
     protected:
         RendererPluginConfig m_config;
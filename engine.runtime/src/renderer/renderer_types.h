@@ -18,6 +18,8 @@ namespace C3D
         Vulkan,
         OpenGl,
         DirectX,
+        /** @brief Headless renderer that does no GPU work at all. Used to benchmark the CPU side of a frame. */
+        Null,
     };
 
     enum RendererViewMode : u8
@@ -41,6 +43,21 @@ namespace C3D
 
     typedef u8 RendererConfigFlags;
 
+    /** @brief Counters for the work that was submitted to the renderer plugin in the current frame. */
+    struct RendererStats
+    {
+        /** @brief The number of draw calls. */
+        u32 drawCount = 0;
+        /** @brief The total number of vertices and indices that were drawn. */
+        u64 drawnElementCount = 0;
+        /** @brief The number of uniforms that were set. */
+        u32 uniformUploadCount = 0;
+        /** @brief The number of bytes that were uploaded to uniforms, buffers and textures. */
+        u64 uploadedBytes = 0;
+        /** @brief The number of renderpasses that were started. */
+        u32 renderpassCount = 0;
+    };
+
     struct RendererPluginConfig
     {
         const char* applicationName;
@@ -176,8 +193,14 @@ namespace C3D
         bool windingInverted = false;
         // TODO: Replace this with a material handle
         Material* material = nullptr;
+
+        /** @brief The packed key that render lists are sorted by (see RenderSort). Built while culling. */
+        u64 sortKey = 0;
     };
 
+    /** @brief The size of the per-instance data (the model matrix) that instanced draws read from the instance buffer. */
+    constexpr u32 GEOMETRY_INSTANCE_STRIDE = sizeof(mat4);
+
     struct UIProperties
     {
         vec4 diffuseColor;
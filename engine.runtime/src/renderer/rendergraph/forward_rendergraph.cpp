@@ -1,7 +1,7 @@
 
 #include "forward_rendergraph.h"
 
-#include "memory/allocators/linear_allocator.h"
+#include "memory/allocators/frame_allocator.h"
 #include "resources/scenes/scene.h"
 
 namespace C3D
@@ -141,6 +141,9 @@ namespace C3D
             // Keep track of how many meshes are being used in our shadow pass
             frameData.drawnShadowMeshCount = cullingData.geometries.Size();
 
+            // Merge the meshes that share their geometry and material into instanced draws
+            m_shadowMapPass.PrepareBatches(frameData);
+
             // Get all the relevant terrains from the scene
             scene.QueryTerrains(frameData, cullingData.lightDirection, cullingData.center, cullingData.radius, cullingData.terrains);
 
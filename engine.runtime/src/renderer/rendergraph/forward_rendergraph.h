@@ -7,12 +7,12 @@
 
 namespace C3D
 {
-    class LinearAllocator;
+    class FrameAllocator;
 
     struct ForwardRendergraphConfig
     {
         u16 shadowMapResolution                = 4096;
-        const LinearAllocator* pFrameAllocator = nullptr;
+        const FrameAllocator* pFrameAllocator = nullptr;
     };
 
     class C3D_API ForwardRendergraph : public Rendergraph<ForwardRendergraphConfig>
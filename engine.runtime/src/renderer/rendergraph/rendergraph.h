@@ -1,5 +1,6 @@
 
 #pragma once
+#include "profiler/profiler.h"
 #include "renderer/render_target.h"
 #include "renderer/renderer_frontend.h"
 #include "rendergraph_types.h"
@@ -185,7 +186,7 @@ namespace C3D
             return Link("", sourceName, sinkPassName, sinkName);
         }
 
-        bool Finalize(const C3D::LinearAllocator* frameAllocator)
+        bool Finalize(const C3D::FrameAllocator* frameAllocator)
         {
             // Get global texture references for the global sources and hook them up
             for (auto& globalSource : m_globalSources)
@@ -312,6 +313,9 @@ namespace C3D
                     continue;
                 }
 
+                // NOTE: The name of the pass lives as long as the pass so it's safe to use in our profile scope
+                C3D_PROFILE_SCOPE(pass->GetName().Data());
+
                 if (!pass->Execute(frameData))
                 {
                     ERROR_LOG("Failed to Execute pass: '{}'.", pass->GetName());
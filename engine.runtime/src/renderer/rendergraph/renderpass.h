@@ -20,7 +20,7 @@ namespace C3D
         void Begin(const FrameData& frameData) const;
         void End() const;
 
-        virtual bool Initialize(const LinearAllocator* frameAllocator) = 0;
+        virtual bool Initialize(const FrameAllocator* frameAllocator) = 0;
         virtual bool LoadResources();
         virtual bool Execute(const FrameData& frameData) = 0;
         virtual void Destroy();
@@ -0,0 +1,136 @@
+
+#include "csm_file.h"
+
+#include "math/c3d_math.h"
+
+namespace C3D::CSM
+{
+    /** @brief Checks if the string at the provided offset (including it's length and null-terminator) fits within size. */
+    static bool IsValidString(const u8* data, const u64 size, const u64 offset)
+    {
+        if (offset % alignof(u32) != 0 || offset + sizeof(u32) > size) return false;
+
+        const auto length = *reinterpret_cast<const u32*>(data + offset);
+        const auto end    = offset + sizeof(u32) + length;
+        return end < size && data[end] == '\0';
+    }
+
+    /** @brief Checks if a blob of count elements of elementSize is properly aligned and fits within size. */
+    static bool IsValidBlob(const u64 size, const u64 offset, const u64 count, const u64 elementSize)
+    {
+        if (offset % CSM_BLOB_ALIGNMENT != 0 || offset > size) return false;
+        // Divide instead of multiply so a corrupt count can't overflow
+        return count <= (size - offset) / elementSize;
+    }
+
+    u16 GetVersion(const u8* data, const u64 size)
+    {
+        if (!data || size < sizeof(u16)) return 0;
+
+        u16 version = 0;
+        std::memcpy(&version, data, sizeof(u16));
+        return version;
+    }
+
+    bool Validate(const u8* data, const u64 size, const u64 vertexSize, const u64 indexSize)
+    {
+        if (!data || size < sizeof(CSMHeader))
+        {
+            ERROR_LOG("The data is too small to contain a CSM header.");
+            return false;
+        }
+
+        const auto header = reinterpret_cast<const CSMHeader*>(data);
+        if (header->version != CSM_VERSION_2 || header->magic != CSM_MAGIC)
+        {
+            ERROR_LOG("Expected CSM version: {} but found: {}.", CSM_VERSION_2, header->version);
+            return false;
+        }
+
+        if (header->size > size)
+        {
+            ERROR_LOG("The CSM header specifies a size of: {} bytes but only {} bytes are available.", header->size, size);
+            return false;
+        }
+
+        if (header->vertexSize != vertexSize || header->indexSize != indexSize)
+        {
+            ERROR_LOG("The CSM data has a vertex size of: {} and index size of: {} but expected: {} and {}.", header->vertexSize,
+                      header->indexSize, vertexSize, indexSize);
+            return false;
+        }
+
+        const auto tocEnd = sizeof(CSMHeader) + sizeof(CSMGeometryEntry) * static_cast<u64>(header->geometryCount);
+        if (tocEnd > header->size)
+        {
+            ERROR_LOG("The CSM table of contents for: {} geometries does not fit in the data.", header->geometryCount);
+            return false;
+        }
+
+        if (!IsValidString(data, header->size, header->name))
+        {
+            ERROR_LOG("The CSM data contains an invalid mesh name.");
+            return false;
+        }
+
+        const auto entries = reinterpret_cast<const CSMGeometryEntry*>(data + sizeof(CSMHeader));
+        for (u32 i = 0; i < header->geometryCount; i++)
+        {
+            const auto& entry = entries[i];
+            if (!IsValidString(data, header->size, entry.name) || !IsValidString(data, header->size, entry.materialName))
+            {
+                ERROR_LOG("Geometry: {} in the CSM data contains an invalid name or material name.", i);
+                return false;
+            }
+
+            if (!IsValidBlob(header->size, entry.vertexOffset, entry.vertexCount, vertexSize) ||
+                !IsValidBlob(header->size, entry.indexOffset, entry.indexCount, indexSize))
+            {
+                ERROR_LOG("Geometry: {} in the CSM data contains invalid vertex or index data.", i);
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    const char* GetString(const u8* data, const u32 offset) { return reinterpret_cast<const char*>(data + offset + sizeof(u32)); }
+
+    u64 AppendBytes(DynamicArray<u8>& output, const void* data, const u64 size)
+    {
+        const auto offset = output.Size();
+        const auto needed = offset + size;
+        // Resize() only reserves exactly what we ask for so we grow geometrically ourselves
+        if (needed > output.Capacity()) output.Reserve(Max(needed, output.Capacity() * 2));
+        output.Resize(needed);
+        if (data)
+        {
+            std::memcpy(output.GetData() + offset, data, size);
+        }
+        else
+        {
+            std::memset(output.GetData() + offset, 0, size);
+        }
+        return offset;
+    }
+
+    u32 AppendString(DynamicArray<u8>& output, const char* str, const u64 length)
+    {
+        AlignTo(output, alignof(u32));
+
+        const auto size   = static_cast<u32>(length);
+        const auto offset = AppendBytes(output, &size, sizeof(u32));
+        AppendBytes(output, str, length);
+
+        constexpr char terminator = '\0';
+        AppendBytes(output, &terminator, 1);
+
+        return static_cast<u32>(offset);
+    }
+
+    void AlignTo(DynamicArray<u8>& output, const u64 alignment)
+    {
+        const auto padding = (alignment - output.Size() % alignment) % alignment;
+        if (padding > 0) AppendBytes(output, nullptr, padding);
+    }
+}  // namespace C3D::CSM
@@ -0,0 +1,269 @@
+
+#pragma once
+#include "containers/dynamic_array.h"
+#include "defines.h"
+#include "logger/logger.h"
+#include "platform/file_system.h"
+#include "resources/geometry_config.h"
+
+namespace C3D::CSM
+{
+    /*
+     * CSM v2 layout (all values are little-endian and every offset is relative to the start of the file):
+     *
+     * CSMHeader
+     * Table of contents: A CSMGeometryEntry for every geometry.
+     * String pool:       The name of the mesh and the name and material name of every geometry. Every string is stored as a u32 length
+     *                    followed by the characters and a null-terminator and starts on a 4 byte boundary.
+     * Blobs:             The vertices and indices of every geometry. Every blob starts on a 16 byte boundary so a memory-mapped file
+     *                    can be handed to the renderer as-is.
+     */
+
+    /** @brief The original CSM format which stores every field sequentially and has to be read field by field. */
+    constexpr u16 CSM_VERSION_1 = 0x0001u;
+    /** @brief The current CSM format with a table of contents and aligned blobs that can be used in place. */
+    constexpr u16 CSM_VERSION_2 = 0x0002u;
+    /** @brief The magic number that follows the version in CSM v2 files ("CSM2"). */
+    constexpr u32 CSM_MAGIC = 0x324D5343;
+    /** @brief The alignment of every vertex and index blob in a CSM v2 file. */
+    constexpr u64 CSM_BLOB_ALIGNMENT = 16;
+
+    struct CSMHeader
+    {
+        /** @brief The version comes first since v1 files also start with a u16 version. */
+        u16 version  = CSM_VERSION_2;
+        u16 reserved = 0;
+        u32 magic    = CSM_MAGIC;
+        /** @brief The total size of the file in bytes (including this header). */
+        u64 size = 0;
+        /** @brief The size of a single vertex and index so we can verify that the file matches the types we load it with. */
+        u32 vertexSize    = 0;
+        u32 indexSize     = 0;
+        u32 geometryCount = 0;
+        /** @brief The offset of the name of the mesh in the string pool. */
+        u32 name = 0;
+    };
+
+    struct CSMGeometryEntry
+    {
+        u64 vertexOffset = 0;
+        u64 vertexCount  = 0;
+        u64 indexOffset  = 0;
+        u64 indexCount   = 0;
+        /** @brief The offsets of the name and material name in the string pool. */
+        u32 name         = 0;
+        u32 materialName = 0;
+
+        vec3 center;
+        vec3 minExtents;
+        vec3 maxExtents;
+
+        u32 reserved = 0;
+    };
+
+    static_assert(sizeof(CSMHeader) == 32);
+    static_assert(sizeof(CSMGeometryEntry) == 80);
+
+    /**
+     * @brief Gets the version of the CSM data.
+     *
+     * @param data A pointer to the start of the CSM data
+     * @param size The size of the data in bytes
+     * @return The version of the CSM data or 0 if the data is too small to contain a version
+     */
+    C3D_API u16 GetVersion(const u8* data, u64 size);
+
+    /** @brief Checks the header and table of contents of CSM v2 data. Errors are logged. */
+    C3D_API bool Validate(const u8* data, u64 size, u64 vertexSize, u64 indexSize);
+
+    /** @brief Gets the string at the provided offset in the string pool of (validated) CSM v2 data. */
+    C3D_API const char* GetString(const u8* data, u32 offset);
+
+    C3D_API u64 AppendBytes(DynamicArray<u8>& output, const void* data, u64 size);
+    C3D_API u32 AppendString(DynamicArray<u8>& output, const char* str, u64 length);
+    C3D_API void AlignTo(DynamicArray<u8>& output, u64 alignment);
+
+    /**
+     * @brief Serializes the provided geometries into the CSM v2 format.
+     *
+     * @param name The name of the mesh
+     * @param geometries The geometries that should be serialized
+     * @param output The array that the CSM data will be written to (any previous contents are cleared)
+     */
+    template <typename VertexType, typename IndexType>
+    void Serialize(const char* name, const DynamicArray<IGeometryConfig<VertexType, IndexType>>& geometries, DynamicArray<u8>& output)
+    {
+        output.Clear();
+
+        // Reserve space for the header and the table of contents which are filled in once we know all the offsets
+        AppendBytes(output, nullptr, sizeof(CSMHeader) + sizeof(CSMGeometryEntry) * geometries.Size());
+
+        CSMHeader header;
+        header.vertexSize    = sizeof(VertexType);
+        header.indexSize     = sizeof(IndexType);
+        header.geometryCount = static_cast<u32>(geometries.Size());
+        header.name          = AppendString(output, name, std::strlen(name));
+
+        DynamicArray<CSMGeometryEntry> entries(geometries.Size());
+        for (const auto& geometry : geometries)
+        {
+            auto& entry        = entries.EmplaceBack();
+            entry.name         = AppendString(output, geometry.name.Data(), geometry.name.Size());
+            entry.materialName = AppendString(output, geometry.materialName.Data(), geometry.materialName.Size());
+            entry.center       = geometry.center;
+            entry.minExtents   = geometry.minExtents;
+            entry.maxExtents   = geometry.maxExtents;
+        }
+
+        u32 i = 0;
+        for (const auto& geometry : geometries)
+        {
+            auto& entry = entries[i++];
+
+            AlignTo(output, CSM_BLOB_ALIGNMENT);
+            entry.vertexCount  = geometry.GetVertexCount();
+            entry.vertexOffset = AppendBytes(output, geometry.GetVertices(), sizeof(VertexType) * entry.vertexCount);
+
+            AlignTo(output, CSM_BLOB_ALIGNMENT);
+            entry.indexCount  = geometry.GetIndexCount();
+            entry.indexOffset = AppendBytes(output, geometry.GetIndices(), sizeof(IndexType) * entry.indexCount);
+        }
+
+        AlignTo(output, CSM_BLOB_ALIGNMENT);
+        header.size = output.Size();
+
+        std::memcpy(output.GetData(), &header, sizeof(CSMHeader));
+        if (!entries.Empty())
+        {
+            std::memcpy(output.GetData() + sizeof(CSMHeader), entries.GetData(), sizeof(CSMGeometryEntry) * entries.Size());
+        }
+    }
+
+    /**
+     * @brief Loads the geometries from CSM v2 data without copying any vertices or indices.
+     * The geometry configs point directly into the data so it must remain valid (e.g. by keeping the file mapped)
+     * until the geometries have been created. The data must be 16 byte aligned.
+     *
+     * @param data A pointer to the start of the CSM data
+     * @param size The size of the data in bytes
+     * @param outGeometries The array that the geometry configs will be added to
+     * @return True if successful; False otherwise
+     */
+    template <typename VertexType, typename IndexType>
+    bool Load(const u8* data, u64 size, DynamicArray<IGeometryConfig<VertexType, IndexType>>& outGeometries)
+    {
+        if (reinterpret_cast<uintptr_t>(data) % CSM_BLOB_ALIGNMENT != 0)
+        {
+            ERROR_LOG("CSM data must be aligned to {} bytes.", CSM_BLOB_ALIGNMENT);
+            return false;
+        }
+
+        if (!Validate(data, size, sizeof(VertexType), sizeof(IndexType))) return false;
+
+        const auto header  = reinterpret_cast<const CSMHeader*>(data);
+        const auto entries = reinterpret_cast<const CSMGeometryEntry*>(data + sizeof(CSMHeader));
+
+        outGeometries.Reserve(outGeometries.Size() + header->geometryCount);
+        for (u32 i = 0; i < header->geometryCount; i++)
+        {
+            const auto& entry = entries[i];
+            auto& geometry    = outGeometries.EmplaceBack();
+
+            geometry.externalVertices    = reinterpret_cast<const VertexType*>(data + entry.vertexOffset);
+            geometry.externalVertexCount = entry.vertexCount;
+            geometry.externalIndices     = reinterpret_cast<const IndexType*>(data + entry.indexOffset);
+            geometry.externalIndexCount  = entry.indexCount;
+
+            geometry.name         = GetString(data, entry.name);
+            geometry.materialName = GetString(data, entry.materialName);
+            geometry.center       = entry.center;
+            geometry.minExtents   = entry.minExtents;
+            geometry.maxExtents   = entry.maxExtents;
+        }
+
+        return true;
+    }
+
+    /**
+     * @brief Loads the geometries from a CSM v1 file. Every field is read (and copied) separately so this is only used
+     * to load older files which are then converted to v2.
+     *
+     * @param file A file that was opened in binary mode
+     * @param outGeometries The array that the geometry configs will be added to
+     * @return True if successful; False otherwise
+     */
+    template <typename VertexType, typename IndexType>
+    bool LoadVersion1(File& file, DynamicArray<IGeometryConfig<VertexType, IndexType>>& outGeometries)
+    {
+        // Version
+        u16 version = 0;
+        file.Read(&version);
+        if (version != CSM_VERSION_1)
+        {
+            ERROR_LOG("Expected CSM version: {} but found: {}.", CSM_VERSION_1, version);
+            return false;
+        }
+
+        // Name Length
+        u64 nameLength = 0;
+        file.Read(&nameLength);
+        if (nameLength > GEOMETRY_NAME_MAX_LENGTH)
+        {
+            ERROR_LOG("Name length: {} exceeds the maximum of: {}.", nameLength, GEOMETRY_NAME_MAX_LENGTH);
+            return false;
+        }
+
+        // Name + null terminator
+        char name[GEOMETRY_NAME_MAX_LENGTH];
+        file.Read(name, nameLength);
+
+        // Geometry count
+        u64 geometryCount = 0;
+        file.Read(&geometryCount);
+
+        // Reserve enough space for the geometries
+        outGeometries.Reserve(outGeometries.Size() + geometryCount);
+        // For Each geometry
+        for (u64 i = 0; i < geometryCount; i++)
+        {
+            IGeometryConfig<VertexType, IndexType> g = {};
+
+            // Vertices (size / count / array)
+            u64 vertexSize  = 0;
+            u64 vertexCount = 0;
+
+            file.Read(&vertexSize);
+            file.Read(&vertexCount);
+            // Resize so we have enough space and our count is correct
+            g.vertices.Resize(vertexCount);
+            file.Read(g.vertices.GetData(), vertexCount);
+
+            // Indices (size / count / array)
+            u64 indexSize  = 0;
+            u64 indexCount = 0;
+
+            file.Read(&indexSize);
+            file.Read(&indexCount);
+            // Resize so we have enough space and our count is correct
+            g.indices.Resize(indexCount);
+            file.Read(g.indices.GetData(), indexCount);
+
+            // Name
+            file.Read(g.name);
+
+            // Material Name
+            file.Read(g.materialName);
+
+            // Center
+            file.Read(&g.center);
+
+            // Extents (min / max)
+            file.Read(&g.minExtents);
+            file.Read(&g.maxExtents);
+
+            outGeometries.PushBack(g);
+        }
+
+        return true;
+    }
+}  // namespace C3D::CSM
@@ -12,6 +12,16 @@ namespace C3D
         DynamicArray<VertexType> vertices;
         DynamicArray<IndexType> indices;
 
+        /**
+         * @brief Optional views of vertex and index data that is owned by someone else (e.g. a memory-mapped CSM file).
+         * When set they are used instead of the vertices and indices arrays so the data never has to be copied.
+         * The memory they point to must remain valid until the geometry has been created.
+         */
+        const VertexType* externalVertices = nullptr;
+        u64 externalVertexCount            = 0;
+        const IndexType* externalIndices   = nullptr;
+        u64 externalIndexCount             = 0;
+
         vec3 center;
         vec3 minExtents;
         vec3 maxExtents;
@@ -19,6 +29,12 @@ namespace C3D
         String name;
         String materialName;
 
+        [[nodiscard]] const VertexType* GetVertices() const { return externalVertices ? externalVertices : vertices.GetData(); }
+        [[nodiscard]] u64 GetVertexCount() const { return externalVertices ? externalVertexCount : vertices.Size(); }
+
+        [[nodiscard]] const IndexType* GetIndices() const { return externalIndices ? externalIndices : indices.GetData(); }
+        [[nodiscard]] u64 GetIndexCount() const { return externalIndices ? externalIndexCount : indices.Size(); }
+
         constexpr static u64 GetVertexSize() { return sizeof(VertexType); }
         constexpr static u64 GetIndexSize() { return sizeof(IndexType); }
     };
@@ -5,8 +5,10 @@
 #include "platform/file_system.h"
 #include "renderer/geometry_utils.h"
 #include "renderer/vertex.h"
+#include "resources/obj_importer.h"
 #include "string/string_utils.h"
 #include "systems/geometry/geometry_system.h"
+#include "systems/jobs/job_system.h"
 #include "systems/resources/resource_system.h"
 
 namespace C3D
@@ -69,11 +71,13 @@ namespace C3D
         switch (type)
         {
             case MeshFileType::Obj:
-                result = ImportObjFile(file, String::FromFormat("{}/{}/{}.csm", Resources.GetBasePath(), typePath, name),
+                // The importer maps the file itself
+                file.Close();
+                result = ImportObjFile(fullPath, String::FromFormat("{}/{}/{}.csm", Resources.GetBasePath(), typePath, name),
                                        resource.geometryConfigs);
                 break;
             case MeshFileType::Csm:
-                result = LoadCsmFile(file, resource.geometryConfigs);
+                result = LoadCsmFile(file, resource);
                 break;
             case MeshFileType::NotFound:
                 ERROR_LOG("Unsupported mesh type for file '{}'.", name);
@@ -99,313 +103,91 @@ namespace C3D
         }
 
         resource.geometryConfigs.Destroy();
+
+        if (resource.mappedFile)
+        {
+            // The geometry configs are no longer used so the mapping can be closed
+            Memory.Delete(resource.mappedFile);
+            resource.mappedFile = nullptr;
+        }
+
         resource.name.Destroy();
         resource.fullPath.Destroy();
     }
 
-    bool ResourceManager<MeshResource>::ImportObjFile(File& file, const String& outCsmFileName,
-                                                      DynamicArray<GeometryConfig>& outGeometries) const
+    bool ResourceManager<MeshResource>::LoadCsmFile(File& file, MeshResource& resource) const
     {
-        // Allocate dynamic arrays with lots of space reserved for our data
-        DynamicArray<vec3> positions(16384);
-        DynamicArray<vec3> normals(16384);
-        DynamicArray<vec2> texCoords(16384);
-        DynamicArray<MeshGroupData> groups(4);
-
-        char materialFileName[512] = {};
-        char name[512]             = {};
+        auto timer = ScopedTimer("LoadCsmFile");
 
-        u8 currentMaterialNameCount = 0;
-        char materialNames[32][64];
-
-        String line(512);  // Reserve enough space so we don't have to reallocate this every time
-        while (file.ReadLine(line))
+        resource.mappedFile = Memory.New<MappedFile>(MemoryType::Resource);
+        if (!resource.mappedFile->Open(resource.fullPath))
         {
-            // Skip blank lines
-            if (line.Empty()) continue;
-
-            switch (line[0])
-            {
-                case '#':  // Comment so we skip this line
-                    continue;
-                case 'v':  // Line starts with 'v' meaning it will contain vertex data
-                    ObjParseVertexLine(line, positions, normals, texCoords);
-                    break;
-                case 's':
-                    // Ignore for now
-                    break;
-                case 'f':
-                    ObjParseFaceLine(line, normals.Size(), texCoords.Size(), groups);
-                    break;
-                case 'm':
-                    // Material library file
-                    char substr[7];
-                    sscanf(line.Data(), "%s %s", substr, materialFileName);
-
-                    // If found, save off the material file name
-                    if (StringUtils::IEquals(substr, "mtllib", 6))
-                    {
-                        // TODO: verification
-                    }
-                    break;
-                case 'u':
-                {
-                    // Anytime there is a usemtl, assume a new group
-                    // New named group or smoothing group, all faces coming after should be added to it
-                    MeshGroupData newGroup;
-                    newGroup.faces.Reserve(16384);  // Ensure that there is enough space
-                    groups.PushBack(newGroup);
-
-                    char t[8];
-                    sscanf(line.Data(), "%s %s", t, materialNames[currentMaterialNameCount]);
-                    currentMaterialNameCount++;
-                    break;
-                }
-                case 'o':
-                {
-                    // TODO: Improve this by alot :)
-                    char t[3];
-                    sscanf(line.Data(), "%s %s", t, &name);
-                    break;
-                }
-                case 'g':
-                    for (u64 i = 0; i < groups.Size(); i++)
-                    {
-                        GeometryConfig newData = {};
-                        newData.name           = name;
-
-                        if (i > 0)
-                        {
-                            newData.name += i;
-                        }
-
-                        newData.materialName = materialNames[i];
-                        ProcessSubObject(positions, normals, texCoords, groups[i].faces, &newData);
-
-                        outGeometries.PushBack(newData);
-                        groups[i].faces.Destroy();
-                        std::memset(materialNames[i], 0, 64);
-                    }
-
-                    currentMaterialNameCount = 0;
-                    groups.Clear();
-                    std::memset(name, 0, 512);
-
-                    char t[2];
-                    sscanf(line.Data(), "%s %s", t, name);
-                    break;
-                default:
-                    WARN_LOG("Unknown character found: '{}' in line: '{}'.", line[0], line);
-                    break;
-            }
-        }
-
-        for (u64 i = 0; i < groups.Size(); i++)
-        {
-            GeometryConfig newData = {};
-            newData.name           = name;
-
-            if (i > 0)
-            {
-                newData.name += i;
-            }
-            newData.materialName = materialNames[i];
-
-            ProcessSubObject(positions, normals, texCoords, groups[i].faces, &newData);
-
-            outGeometries.PushBack(newData);
-            groups[i].faces.Destroy();
+            ERROR_LOG("Failed to map CSM file: '{}'.", resource.fullPath);
+            return false;
         }
 
-        if (std::strlen(materialFileName) > 0)
-        {
-            // Load up the material file
-            String fullMtlPath = FileSystem::DirectoryFromPath(outCsmFileName.Data());
-            fullMtlPath += materialFileName;
+        const auto data = resource.mappedFile->GetData();
+        const auto size = resource.mappedFile->GetSize();
 
-            if (!ImportObjMaterialLibraryFile(fullMtlPath))
-            {
-                ERROR_LOG("Error reading obj mtl file: '{}'.", fullMtlPath);
-            }
-        }
-
-        // De-duplicate geometry
-        for (auto& geometry : outGeometries)
+        const auto version = CSM::GetVersion(data, size);
+        if (version == CSM::CSM_VERSION_2)
         {
-            INFO_LOG("Geometry de-duplication started on geometry object: '{}'.", geometry.name);
-            GeometryUtils::DeduplicateVertices(geometry);
-            GeometryUtils::GenerateTangents(geometry.vertices, geometry.indices);
+            // The geometry configs point directly into the mapping so nothing is copied until the renderer uploads the geometry
+            return CSM::Load(data, size, resource.geometryConfigs);
         }
 
-        return WriteCsmFile(outCsmFileName, name, outGeometries);
-    }
+        // Older files don't have to stay mapped since they are read field by field
+        Memory.Delete(resource.mappedFile);
+        resource.mappedFile = nullptr;
 
-    void ResourceManager<MeshResource>::ObjParseVertexLine(const String& line, DynamicArray<vec3>& positions, DynamicArray<vec3>& normals,
-                                                           DynamicArray<vec2>& texCoords) const
-    {
-        switch (line[1])
+        if (version != CSM::CSM_VERSION_1)
         {
-            case ' ':  // Only 'v' so this line contains position
-            {
-                vec3 pos;
-                char tp[3];
-                sscanf(line.Data(), "%s %f %f %f", tp, &pos.x, &pos.y, &pos.z);
-                positions.PushBack(pos);
-                break;
-            }
-            case 'n':  // 'vn' so this line contains normal
-            {
-                vec3 norm;
-                char tn[3];
-                sscanf(line.Data(), "%s %f %f %f", tn, &norm.x, &norm.y, &norm.z);
-                normals.PushBack(norm);
-                break;
-            }
-            case 't':  // 'vt' so this line contains texture coords
-            {
-                vec2 tex;
-                char tx[3];
-                sscanf(line.Data(), "%s %f %f", tx, &tex.x, &tex.y);
-                texCoords.PushBack(tex);
-                break;
-            }
-            default:
-                WARN_LOG("Unexpected character after 'v' found: '{}'.", line[1]);
-                break;
+            ERROR_LOG("Unsupported CSM version: {} in file: '{}'.", version, resource.fullPath);
+            return false;
         }
-    }
 
-    void ResourceManager<MeshResource>::ObjParseFaceLine(const String& line, const u64 normalCount, const u64 texCoordinateCount,
-                                                         DynamicArray<MeshGroupData>& groups)
-    {
-        MeshFaceData face{};
-        char t[2];
+        if (!CSM::LoadVersion1(file, resource.geometryConfigs)) return false;
+        file.Close();
 
-        if (normalCount == 0 || texCoordinateCount == 0)
-        {
-            sscanf(line.Data(), "%s %d %d %d", t, &face.vertices[0].positionIndex, &face.vertices[1].positionIndex,
-                   &face.vertices[2].positionIndex);
-        }
-        else
+        // Upgrade the file to the current version so it can be mapped the next time it's loaded
+        INFO_LOG("Converting CSM file: '{}' to version: {}.", resource.fullPath, CSM::CSM_VERSION_2);
+        if (!WriteCsmFile(resource.fullPath, resource.name.Data(), resource.geometryConfigs))
         {
-            sscanf(line.Data(), "%s %d/%d/%d %d/%d/%d %d/%d/%d", t, &face.vertices[0].positionIndex, &face.vertices[0].texCoordinateIndex,
-                   &face.vertices[0].normalIndex, &face.vertices[1].positionIndex, &face.vertices[1].texCoordinateIndex,
-                   &face.vertices[1].normalIndex, &face.vertices[2].positionIndex, &face.vertices[2].texCoordinateIndex,
-                   &face.vertices[2].normalIndex);
+            WARN_LOG("Failed to convert CSM file: '{}'.", resource.fullPath);
         }
-
-        const u64 groupIndex = groups.Size() - 1;
-        groups[groupIndex].faces.PushBack(face);
+        return true;
     }
 
-    void ResourceManager<MeshResource>::ProcessSubObject(DynamicArray<vec3>& positions, DynamicArray<vec3>& normals,
-                                                         DynamicArray<vec2>& texCoords, DynamicArray<MeshFaceData>& faces,
-                                                         GeometryConfig* outData) const
+    bool ResourceManager<MeshResource>::ImportObjFile(const String& path, const String& outCsmFileName,
+                                                      DynamicArray<GeometryConfig>& outGeometries) const
     {
-        auto indices  = DynamicArray<u32>(32768);
-        auto vertices = DynamicArray<Vertex3D>(32768);
-
-        bool extentSet      = false;
-        outData->minExtents = vec3(0);
-        outData->maxExtents = vec3(0);
+        auto timer = ScopedTimer("ImportObjFile");
 
-        u64 faceCount          = faces.Size();
-        u64 normalCount        = normals.Size();
-        u64 texCoordinateCount = texCoords.Size();
-
-        bool skipNormals            = false;
-        bool skipTextureCoordinates = false;
-
-        if (normalCount == 0)
+        ObjImporter importer(Jobs);
+        if (!importer.Import(path, outGeometries))
         {
-            WARN_LOG("No normals are present in this model.");
-            skipNormals = true;
-        }
-
-        if (texCoordinateCount == 0)
-        {
-            WARN_LOG("No texture coordinates are present in this model.");
-            skipTextureCoordinates = true;
+            ERROR_LOG("Failed to import obj file: '{}'.", path);
+            return false;
         }
 
-        for (u64 f = 0; f < faceCount; f++)
+        if (!importer.GetMaterialLibrary().Empty())
         {
-            const auto& face = faces[f];
+            // Load up the material file
+            String fullMtlPath = FileSystem::DirectoryFromPath(outCsmFileName.Data());
+            fullMtlPath += importer.GetMaterialLibrary();
 
-            // For each Vertex
-            for (u64 i = 0; i < 3; i++)
+            if (!ImportObjMaterialLibraryFile(fullMtlPath))
             {
-                auto& indexData = face.vertices[i];
-                indices.PushBack(static_cast<u32>(i + f * 3));
-
-                Vertex3D vertex{};
-
-                vec3 pos        = positions[indexData.positionIndex - 1];
-                vertex.position = pos;
-
-                // Check extents - min
-                if (pos.x < outData->minExtents.x || !extentSet)
-                {
-                    outData->minExtents.x = pos.x;
-                }
-                if (pos.y < outData->minExtents.y || !extentSet)
-                {
-                    outData->minExtents.y = pos.y;
-                }
-                if (pos.z < outData->minExtents.z || !extentSet)
-                {
-                    outData->minExtents.z = pos.z;
-                }
-
-                // Check extents - max
-                if (pos.x > outData->maxExtents.x || !extentSet)
-                {
-                    outData->maxExtents.x = pos.x;
-                }
-                if (pos.y > outData->maxExtents.y || !extentSet)
-                {
-                    outData->maxExtents.y = pos.y;
-                }
-                if (pos.z > outData->maxExtents.z || !extentSet)
-                {
-                    outData->maxExtents.z = pos.z;
-                }
-
-                extentSet = true;
-
-                if (skipNormals)
-                {
-                    vertex.normal = vec3(0, 0, 1);
-                }
-                else
-                {
-                    vertex.normal = normals[indexData.normalIndex - 1];
-                }
-
-                if (skipTextureCoordinates)
-                {
-                    vertex.texture = vec2(0, 0);
-                }
-                else
-                {
-                    vertex.texture = texCoords[indexData.texCoordinateIndex - 1];
-                }
-
-                // TODO: color. Currently hardcoded to white
-                vertex.color = vec4(1);
-
-                vertices.PushBack(vertex);
+                ERROR_LOG("Error reading obj mtl file: '{}'.", fullMtlPath);
             }
         }
 
-        // Calculate the center based on extents
-        for (u8 i = 0; i < 3; i++)
-        {
-            outData->center[i] = (outData->minExtents[i] + outData->maxExtents[i]) / 2.0f;
-        }
+        // The CSM file is what we load from now on so this is the moment to spend some time on making the geometry faster to render
+        Jobs.ParallelFor(outGeometries.Size(), 1, [&outGeometries](const u64 begin, const u64 end, LinearAllocator&) {
+            for (u64 i = begin; i < end; i++) GeometryUtils::OptimizeGeometry(outGeometries[i]);
+        });
 
-        outData->vertices = vertices;
-        outData->indices  = indices;
+        return WriteCsmFile(outCsmFileName, importer.GetName().Data(), outGeometries);
     }
 
     bool ResourceManager<MeshResource>::ImportObjMaterialLibraryFile(const String& mtlFilePath) const
@@ -1,8 +1,10 @@
 
 #include "scene_manager.h"
 
+#include "cson/cson_binary_reader.h"
 #include "exceptions.h"
 #include "platform/file_system.h"
+#include "platform/platform.h"
 #include "systems/resources/resource_system.h"
 #include "systems/system_manager.h"
 #include "systems/transforms/transform_system.h"
@@ -22,57 +24,105 @@ namespace C3D
         }
 
         auto fullPath = String::FromFormat("{}/{}/{}.{}", Resources.GetBasePath(), typePath, name, FILE_EXTENSION);
-        auto fileName = String::FromFormat("{}.{}", name, FILE_EXTENSION);
-
-        auto object = m_reader.ReadFromFile(fullPath);
 
         // TODO: Make this not hardcoded!
         resource.version     = 1;
-        resource.fullPath    = fullPath;
         resource.name        = name;
         resource.description = "";
 
-        for (const auto& prop : object.properties)
+        // We read the scene straight from the file contents so we never have to build a CSONObject for it
+        CSONPullReader reader;
+        CSONBinaryReader binaryReader;
+        String input;
+
+        // Prefer the binary version of the scene if it has been converted since it can be read without parsing. We only use it if it's
+        // at least as new as the text version though, otherwise the text file was edited afterwards and the binary is stale.
+        // NOTE: Write() always writes the binary after the text so an equal time still means both were written by the same save.
+        auto binaryPath = String::FromFormat("{}/{}/{}.{}", Resources.GetBasePath(), typePath, name, CSON_BINARY_FILE_EXTENSION);
+
+        u64 binaryTime       = 0, textTime = 0;
+        bool binaryIsCurrent = Platform::GetLastWriteTime(binaryPath, binaryTime);
+        if (binaryIsCurrent && Platform::GetLastWriteTime(fullPath, textTime) && binaryTime < textTime)
+        {
+            WARN_LOG("Binary scene: '{}' is older than: '{}'. Reading the text version instead.", binaryPath, fullPath);
+            binaryIsCurrent = false;
+        }
+
+        if (binaryIsCurrent && binaryReader.Open(binaryPath))
+        {
+            fullPath = binaryPath;
+            reader.Reset(binaryReader.GetRoot());
+        }
+        else
+        {
+            File file;
+            if (!file.Open(fullPath, FileModeRead) || !file.ReadAll(input))
+            {
+                ERROR_LOG("Failed to read scene file: '{}'.", fullPath);
+                return false;
+            }
+            reader.Reset(input.Data(), input.Size());
+        }
+
+        resource.fullPath = fullPath;
+
+        CSONEvent event;
+        if (!reader.Next(event) || !event.IsObject())
+        {
+            ERROR_LOG("Scene file: '{}' does not contain an object.", fullPath);
+            return false;
+        }
+
+        while (reader.NextMember(event))
         {
-            if (prop.name.IEquals("name"))
+            if (event.name.IEquals("name"))
             {
-                resource.name = prop.GetString();
+                resource.name = event.GetString().ToString();
             }
-            else if (prop.name.IEquals("description"))
+            else if (event.name.IEquals("description"))
             {
-                resource.description = prop.GetString();
+                resource.description = event.GetString().ToString();
             }
-            else if (prop.name.IEquals("skyboxes"))
+            else if (event.name.IEquals("skyboxes") && event.IsArray())
             {
-                const auto& skyboxes = prop.GetArray();
-                ParseSkyboxes(resource, skyboxes);
+                ParseSkyboxes(resource, reader);
             }
-            else if (prop.name.IEquals("directionalLights"))
+            else if (event.name.IEquals("directionalLights") && event.IsArray())
             {
-                const auto& directionalLights = prop.GetArray();
-                ParseDirectionalLights(resource, directionalLights);
+                ParseDirectionalLights(resource, reader);
             }
-            else if (prop.name.IEquals("pointLights"))
+            else if (event.name.IEquals("pointLights") && event.IsArray())
             {
-                const auto& pointLights = prop.GetArray();
-                ParsePointLights(resource, pointLights);
+                ParsePointLights(resource, reader);
             }
-            else if (prop.name.IEquals("meshes"))
+            else if (event.name.IEquals("meshes") && event.IsArray())
             {
-                const auto& meshes = prop.GetArray();
-                if (!ParseMeshes(resource, meshes))
+                if (!ParseMeshes(resource, reader))
                 {
                     ERROR_LOG("Failed to parse meshes.");
                     return false;
                 }
             }
-            else if (prop.name.IEquals("terrains"))
+            else if (event.name.IEquals("terrains") && event.IsArray())
+            {
+                if (!ParseTerrains(resource, reader))
+                {
+                    ERROR_LOG("Failed to parse terrains.");
+                    return false;
+                }
+            }
+            else
             {
-                const auto& terrains = prop.GetArray();
-                ParseTerrains(resource, terrains);
+                reader.Skip(event);
             }
         }
 
+        if (reader.HasError())
+        {
+            ERROR_LOG("Failed to parse scene file: '{}'.", fullPath);
+            return false;
+        }
+
         return true;
     }
 
@@ -147,6 +197,14 @@ namespace C3D
             return false;
         }
 
+        // Read() prefers the binary version of the scene so if it has been converted we must regenerate it or it would shadow this save
+        auto binaryPath = String::FromFormat("{}/{}/{}.{}", Resources.GetBasePath(), typePath, resource.name, CSON_BINARY_FILE_EXTENSION);
+        if (File::Exists(binaryPath) && !m_writer.WriteBinaryToFile(object, binaryPath))
+        {
+            ERROR_LOG("Failed to write: '{}' scene to a binary file.", resource.name);
+            return false;
+        }
+
         return true;
     }
 
@@ -159,43 +217,61 @@ namespace C3D
         resource.meshes.Destroy();
     }
 
-    void ResourceManager<SceneConfig>::ParseSkyboxes(SceneConfig& resource, const CSONArray& skyboxes)
+    void ResourceManager<SceneConfig>::ParseSkyboxes(SceneConfig& resource, CSONPullReader& reader)
     {
-        for (const auto& skyboxProp : skyboxes.properties)
+        CSONEvent skybox;
+        while (reader.NextMember(skybox))
         {
-            const auto& skyboxObj = skyboxProp.GetObject();
-            for (const auto& prop : skyboxObj.properties)
+            if (!skybox.IsObject())
+            {
+                reader.Skip(skybox);
+                continue;
+            }
+
+            CSONEvent prop;
+            while (reader.NextMember(prop))
             {
                 if (prop.name.IEquals("name"))
                 {
-                    resource.skyboxConfig.name = prop.GetString();
+                    resource.skyboxConfig.name = prop.GetString().ToString();
                 }
                 else if (prop.name.IEquals("cubemapname"))
                 {
-                    resource.skyboxConfig.cubemapName = prop.GetString();
+                    resource.skyboxConfig.cubemapName = prop.GetString().ToString();
+                }
+                else
+                {
+                    reader.Skip(prop);
                 }
             }
         }
     }
 
-    void ResourceManager<SceneConfig>::ParseDirectionalLights(SceneConfig& resource, const CSONArray& lights)
+    void ResourceManager<SceneConfig>::ParseDirectionalLights(SceneConfig& resource, CSONPullReader& reader)
     {
-        for (const auto& lightProp : lights.properties)
+        CSONEvent light;
+        while (reader.NextMember(light))
         {
-            const auto& lightObj = lightProp.GetObject();
-            for (const auto& prop : lightObj.properties)
+            if (!light.IsObject())
+            {
+                reader.Skip(light);
+                continue;
+            }
+
+            CSONEvent prop;
+            while (reader.NextMember(prop))
             {
                 if (prop.name.IEquals("name"))
                 {
-                    resource.directionalLightConfig.name = prop.GetString();
+                    resource.directionalLightConfig.name = prop.GetString().ToString();
                 }
                 else if (prop.name.IEquals("color"))
                 {
-                    resource.directionalLightConfig.color = prop.GetVec4();
+                    reader.ReadVec4(prop, resource.directionalLightConfig.color);
                 }
                 else if (prop.name.IEquals("direction"))
                 {
-                    resource.directionalLightConfig.direction = prop.GetVec4();
+                    reader.ReadVec4(prop, resource.directionalLightConfig.direction);
                 }
                 else if (prop.name.IEquals("shadowDistance"))
                 {
@@ -209,31 +285,41 @@ namespace C3D
                 {
                     resource.directionalLightConfig.shadowSplitMultiplier = prop.GetF64();
                 }
+                else
+                {
+                    reader.Skip(prop);
+                }
             }
         }
     }
 
-    void ResourceManager<SceneConfig>::ParsePointLights(SceneConfig& resource, const CSONArray& lights)
+    void ResourceManager<SceneConfig>::ParsePointLights(SceneConfig& resource, CSONPullReader& reader)
     {
-        for (const auto& lightProp : lights.properties)
+        CSONEvent light;
+        while (reader.NextMember(light))
         {
-            const auto& lightObj = lightProp.GetObject();
+            if (!light.IsObject())
+            {
+                reader.Skip(light);
+                continue;
+            }
 
             auto pointLight = ScenePointLightConfig();
 
-            for (const auto& prop : lightObj.properties)
+            CSONEvent prop;
+            while (reader.NextMember(prop))
             {
                 if (prop.name.IEquals("name"))
                 {
-                    pointLight.name = prop.GetString();
+                    pointLight.name = prop.GetString().ToString();
                 }
                 else if (prop.name.IEquals("color"))
                 {
-                    pointLight.color = prop.GetVec4();
+                    reader.ReadVec4(prop, pointLight.color);
                 }
                 else if (prop.name.IEquals("position"))
                 {
-                    pointLight.position = prop.GetVec4();
+                    reader.ReadVec4(prop, pointLight.position);
                 }
                 else if (prop.name.IEquals("constant"))
                 {
@@ -247,97 +333,115 @@ namespace C3D
                 {
                     pointLight.quadratic = prop.GetF64();
                 }
+                else
+                {
+                    reader.Skip(prop);
+                }
             }
 
             resource.pointLights.PushBack(pointLight);
         }
     }
 
-    bool ResourceManager<SceneConfig>::ParseMeshes(SceneConfig& resource, const CSONArray& meshes)
+    bool ResourceManager<SceneConfig>::ParseTransform(CSONPullReader& reader, const CSONEvent& event, const String& name,
+                                                      Handle<Transform>& transform)
+    {
+        f32 values[10];
+        if (!reader.ReadF32Array(event, values, 10))
+        {
+            ERROR_LOG("Transform for: '{}' does not contain 10 floats.", name);
+            return false;
+        }
+
+        vec3 pos   = { values[0], values[1], values[2] };
+        quat rot   = { values[6], values[3], values[4], values[5] };
+        vec3 scale = { values[7], values[8], values[9] };
+
+        transform = Transforms.Acquire(pos, rot, scale);
+        return true;
+    }
+
+    bool ResourceManager<SceneConfig>::ParseMeshes(SceneConfig& resource, CSONPullReader& reader)
     {
-        for (const auto& meshProp : meshes.properties)
+        CSONEvent meshEvent;
+        while (reader.NextMember(meshEvent))
         {
-            const auto& meshObj = meshProp.GetObject();
+            if (!meshEvent.IsObject())
+            {
+                reader.Skip(meshEvent);
+                continue;
+            }
 
             auto mesh = SceneMeshConfig();
 
-            for (const auto& prop : meshObj.properties)
+            CSONEvent prop;
+            while (reader.NextMember(prop))
             {
                 if (prop.name.IEquals("name"))
                 {
-                    mesh.name = prop.GetString();
+                    mesh.name = prop.GetString().ToString();
                 }
                 else if (prop.name.IEquals("resourceName"))
                 {
-                    mesh.resourceName = prop.GetString();
+                    mesh.resourceName = prop.GetString().ToString();
                 }
                 else if (prop.name.IEquals("parent"))
                 {
-                    mesh.parentName = prop.GetString();
+                    mesh.parentName = prop.GetString().ToString();
                 }
                 else if (prop.name.IEquals("transform"))
                 {
-                    const auto& transform = prop.GetArray();
-                    const auto& props     = transform.properties;
-                    if (props.Size() != 10)
-                    {
-                        ERROR_LOG("Transform for: '{}' does not contain 10 floats.", mesh.name);
-                        return false;
-                    }
-
-                    vec3 pos   = { props[0].GetF32(), props[1].GetF32(), props[2].GetF32() };
-                    quat rot   = { props[6].GetF32(), props[3].GetF32(), props[4].GetF32(), props[5].GetF32() };
-                    vec3 scale = { props[7].GetF32(), props[8].GetF32(), props[9].GetF32() };
-
-                    mesh.transform = Transforms.Acquire(pos, rot, scale);
+                    if (!ParseTransform(reader, prop, mesh.name, mesh.transform)) return false;
+                }
+                else
+                {
+                    reader.Skip(prop);
                 }
             }
 
             resource.meshes.PushBack(mesh);
         }
 
-        return true;
+        return !reader.HasError();
     }
 
-    bool ResourceManager<SceneConfig>::ParseTerrains(SceneConfig& resource, const CSONArray& terrains)
+    bool ResourceManager<SceneConfig>::ParseTerrains(SceneConfig& resource, CSONPullReader& reader)
     {
-        for (const auto& terrainProp : terrains.properties)
+        CSONEvent terrainEvent;
+        while (reader.NextMember(terrainEvent))
         {
-            const auto& terrainObj = terrainProp.GetObject();
+            if (!terrainEvent.IsObject())
+            {
+                reader.Skip(terrainEvent);
+                continue;
+            }
 
             auto terrain = SceneTerrainConfig();
 
-            for (const auto& prop : terrainObj.properties)
+            CSONEvent prop;
+            while (reader.NextMember(prop))
             {
                 if (prop.name.IEquals("name"))
                 {
-                    terrain.name = prop.GetString();
+                    terrain.name = prop.GetString().ToString();
                 }
                 else if (prop.name.IEquals("resourceName"))
                 {
-                    terrain.resourceName = prop.GetString();
+                    terrain.resourceName = prop.GetString().ToString();
                 }
                 else if (prop.name.IEquals("transform"))
                 {
-                    const auto& transform = prop.GetArray();
-                    const auto& props     = transform.properties;
-                    if (props.Size() != 10)
-                    {
-                        ERROR_LOG("Transform for: '{}' does not contain 10 floats.", terrain.name);
-                        return false;
-                    }
-
-                    vec3 pos   = { props[0].GetF32(), props[1].GetF32(), props[2].GetF32() };
-                    quat rot   = { props[6].GetF32(), props[3].GetF32(), props[4].GetF32(), props[5].GetF32() };
-                    vec3 scale = { props[7].GetF32(), props[8].GetF32(), props[9].GetF32() };
-
-                    terrain.transform = Transforms.Acquire(pos, rot, scale);
+                    if (!ParseTransform(reader, prop, terrain.name, terrain.transform)) return false;
+                }
+                else
+                {
+                    reader.Skip(prop);
                 }
             }
 
             resource.terrains.PushBack(terrain);
         }
 
-        return true;
+        return !reader.HasError();
     }
 }  // namespace C3D
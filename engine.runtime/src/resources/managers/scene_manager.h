@@ -1,6 +1,6 @@
 
 #pragma once
-#include "cson/cson_reader.h"
+#include "cson/cson_pull_reader.h"
 #include "cson/cson_writer.h"
 #include "resource_manager.h"
 #include "resources/scenes/scene_config.h"
@@ -30,13 +30,13 @@ namespace C3D
         void Cleanup(SceneConfig& resource) const;
 
     private:
-        void ParseSkyboxes(SceneConfig& resource, const CSONArray& skyboxes);
-        void ParseDirectionalLights(SceneConfig& resource, const CSONArray& lights);
-        void ParsePointLights(SceneConfig& resource, const CSONArray& lights);
-        bool ParseMeshes(SceneConfig& resource, const CSONArray& meshes);
-        bool ParseTerrains(SceneConfig& resource, const CSONArray& terrains);
+        void ParseSkyboxes(SceneConfig& resource, CSONPullReader& reader);
+        void ParseDirectionalLights(SceneConfig& resource, CSONPullReader& reader);
+        void ParsePointLights(SceneConfig& resource, CSONPullReader& reader);
+        bool ParseTransform(CSONPullReader& reader, const CSONEvent& event, const String& name, Handle<Transform>& transform);
+        bool ParseMeshes(SceneConfig& resource, CSONPullReader& reader);
+        bool ParseTerrains(SceneConfig& resource, CSONPullReader& reader);
 
-        CSONReader m_reader;
         CSONWriter m_writer;
     };
 }  // namespace C3D
\ No newline at end of file
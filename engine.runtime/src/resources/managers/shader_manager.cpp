@@ -219,6 +219,10 @@ namespace C3D
         {
             if (value.ToBool()) resource.flags |= ShaderFlagWireframe;
         }
+        else if (name.IEquals("instancing"))
+        {
+            if (value.ToBool()) resource.flags |= ShaderFlagInstancing;
+        }
         else if (name.IEquals("topology"))
         {
             // Reset our topology types
@@ -150,9 +150,11 @@ namespace C3D
 
                 Extents3D& local = g->extents;
 
-                for (u32 v = 0; v < c.vertices.Size(); v++)
+                const auto vertices    = c.GetVertices();
+                const auto vertexCount = c.GetVertexCount();
+                for (u64 v = 0; v < vertexCount; v++)
                 {
-                    auto& vert = c.vertices[v];
+                    auto& vert = vertices[v];
 
                     // Min
                     if (vert.position.x < local.min.x)
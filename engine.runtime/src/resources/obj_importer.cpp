@@ -0,0 +1,470 @@
+#include "obj_importer.h"
+
+#include <atomic>
+#include <charconv>
+#include <string_view>
+
+#include "containers/flat_hash_map.h"
+#include "logger/logger.h"
+#include "math/c3d_math.h"
+#include "platform/mapped_file.h"
+#include "renderer/geometry_utils.h"
+#include "systems/jobs/job_system.h"
+
+namespace C3D
+{
+    /** @brief The maximum number of vertices a single face (polygon) may have. */
+    constexpr u32 OBJ_MAX_FACE_VERTICES = 64;
+
+    struct ObjFaceVertexHash
+    {
+        size_t operator()(const ObjFaceVertex& v) const noexcept
+        {
+            // Combine the indices and mix the bits (SplitMix64 finalizer) so both the low and high bits of the hash are usable
+            u64 hash = (static_cast<u64>(v.position) << 32) ^ (static_cast<u64>(v.texCoord) << 16) ^ static_cast<u64>(v.normal);
+            hash ^= hash >> 30;
+            hash *= 0xBF58476D1CE4E5B9ull;
+            hash ^= hash >> 27;
+            hash *= 0x94D049BB133111EBull;
+            hash ^= hash >> 31;
+            return hash;
+        }
+    };
+
+    static bool IsSpace(const char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+    static const char* SkipSpaces(const char* pos, const char* end)
+    {
+        while (pos < end && IsSpace(*pos)) pos++;
+        return pos;
+    }
+
+    /** @brief Parses up to count floats. Values that are missing are left untouched. */
+    static void ParseFloats(const char* pos, const char* end, f32* values, const u32 count)
+    {
+        for (u32 i = 0; i < count; i++)
+        {
+            pos = SkipSpaces(pos, end);
+            // from_chars does not accept a leading '+'
+            if (pos < end && *pos == '+') pos++;
+
+            const auto [ptr, ec] = std::from_chars(pos, end, values[i]);
+            if (ec != std::errc()) return;
+            pos = ptr;
+        }
+    }
+
+    /** @brief Parses a (1-based) index. Returns false for relative (negative) indices which are not supported. */
+    static bool ParseIndex(const char*& pos, const char* end, u32& index)
+    {
+        i64 value            = 0;
+        const auto [ptr, ec] = std::from_chars(pos, end, value);
+        if (ec != std::errc() || value <= 0 || value > INVALID_ID) return false;
+
+        index = static_cast<u32>(value);
+        pos   = ptr;
+        return true;
+    }
+
+    static String TrimmedString(const char* pos, const char* end)
+    {
+        pos = SkipSpaces(pos, end);
+        while (end > pos && IsSpace(end[-1])) end--;
+        return String(pos, static_cast<u64>(end - pos));
+    }
+
+    ObjImporter::ObjImporter(JobSystem& jobSystem, const u64 chunkSize) : m_jobSystem(&jobSystem), m_chunkSize(Max<u64>(chunkSize, 1)) {}
+
+    bool ObjImporter::Import(const String& path, DynamicArray<GeometryConfig>& outGeometries)
+    {
+        MappedFile file;
+        if (!file.Open(path))
+        {
+            ERROR_LOG("Failed to open OBJ file: '{}'.", path);
+            return false;
+        }
+
+        // The geometries own all their data so the file can be unmapped once we are done
+        return Import(reinterpret_cast<const char*>(file.GetData()), file.GetSize(), outGeometries);
+    }
+
+    bool ObjImporter::Import(const char* data, const u64 size, DynamicArray<GeometryConfig>& outGeometries)
+    {
+        Reset();
+        m_name.Clear();
+        m_materialLibrary.Clear();
+
+        if (!data || size == 0)
+        {
+            ERROR_LOG("No OBJ data was provided.");
+            return false;
+        }
+
+        SplitIntoChunks(data, size);
+
+        // Parse all chunks in parallel
+        m_jobSystem->ParallelFor(m_chunks.Size(), 1, [this](const u64 begin, const u64 end, LinearAllocator&) {
+            for (u64 i = begin; i < end; i++) ParseChunk(m_chunks[i]);
+        });
+
+        MergeChunks();
+        BuildGroups();
+
+        if (m_groups.Empty())
+        {
+            ERROR_LOG("The OBJ data does not contain any faces.");
+            Reset();
+            return false;
+        }
+
+        // Build every geometry in parallel, directly into it's slot in the output
+        const auto first = outGeometries.Size();
+        outGeometries.Resize(first + m_groups.Size());
+
+        struct BuildState
+        {
+            GeometryConfig* configs   = nullptr;
+            std::atomic<bool> success = true;
+        } state;
+        state.configs = outGeometries.GetData() + first;
+
+        m_jobSystem->ParallelFor(m_groups.Size(), 1, [this, &state](const u64 begin, const u64 end, LinearAllocator&) {
+            for (u64 i = begin; i < end; i++)
+            {
+                if (!BuildGeometry(m_groups[i], state.configs[i])) state.success = false;
+            }
+        });
+
+        INFO_LOG("Imported {} geometries from {} chunks.", m_groups.Size(), m_chunks.Size());
+
+        Reset();
+        return state.success;
+    }
+
+    void ObjImporter::SplitIntoChunks(const char* data, const u64 size)
+    {
+        m_chunks.Reserve(size / m_chunkSize + 1);
+
+        const char* pos = data;
+        const char* end = data + size;
+        while (pos < end)
+        {
+            const char* chunkEnd = pos + Min(m_chunkSize, static_cast<u64>(end - pos));
+            if (chunkEnd < end)
+            {
+                // Extend the chunk to the end of the line so every line is parsed by exactly one chunk
+                const auto newLine = static_cast<const char*>(std::memchr(chunkEnd, '\n', end - chunkEnd));
+                chunkEnd           = newLine ? newLine + 1 : end;
+            }
+
+            auto& chunk = m_chunks.EmplaceBack();
+            chunk.begin = pos;
+            chunk.end   = chunkEnd;
+            pos         = chunkEnd;
+        }
+    }
+
+    void ObjImporter::ParseChunk(ObjChunk& chunk)
+    {
+        const char* pos = chunk.begin;
+        while (pos < chunk.end)
+        {
+            const auto newLine = static_cast<const char*>(std::memchr(pos, '\n', chunk.end - pos));
+            const auto lineEnd = newLine ? newLine : chunk.end;
+
+            ParseLine(chunk, pos, lineEnd);
+            pos = lineEnd + 1;
+        }
+    }
+
+    void ObjImporter::ParseLine(ObjChunk& chunk, const char* pos, const char* end)
+    {
+        pos = SkipSpaces(pos, end);
+        // Skip blank lines and comments
+        if (pos == end || *pos == '#') return;
+
+        const char* keywordEnd = pos;
+        while (keywordEnd < end && !IsSpace(*keywordEnd)) keywordEnd++;
+
+        const auto keyword = std::string_view(pos, keywordEnd - pos);
+        // Ordered by how often they occur
+        if (keyword == "v")
+        {
+            vec3 position(0.0f);
+            ParseFloats(keywordEnd, end, &position.x, 3);
+            chunk.positions.PushBack(position);
+        }
+        else if (keyword == "vt")
+        {
+            vec2 texCoord(0.0f);
+            ParseFloats(keywordEnd, end, &texCoord.x, 2);
+            chunk.texCoords.PushBack(texCoord);
+        }
+        else if (keyword == "vn")
+        {
+            vec3 normal(0.0f);
+            ParseFloats(keywordEnd, end, &normal.x, 3);
+            chunk.normals.PushBack(normal);
+        }
+        else if (keyword == "f")
+        {
+            ParseFace(chunk, keywordEnd, end);
+        }
+        else if (keyword == "usemtl")
+        {
+            chunk.commands.EmplaceBack(ObjCommandType::UseMaterial, chunk.faceVertices.Size(), TrimmedString(keywordEnd, end));
+        }
+        else if (keyword == "mtllib")
+        {
+            chunk.commands.EmplaceBack(ObjCommandType::MaterialLibrary, chunk.faceVertices.Size(), TrimmedString(keywordEnd, end));
+        }
+        else if (keyword == "o")
+        {
+            chunk.commands.EmplaceBack(ObjCommandType::Object, chunk.faceVertices.Size(), TrimmedString(keywordEnd, end));
+        }
+        else if (keyword == "g")
+        {
+            chunk.commands.EmplaceBack(ObjCommandType::Group, chunk.faceVertices.Size(), TrimmedString(keywordEnd, end));
+        }
+        else if (keyword != "s")
+        {
+            // Smoothing groups are ignored for now
+            WARN_LOG("Unknown statement found on line: '{}'.", String(pos, static_cast<u64>(end - pos)));
+        }
+    }
+
+    void ObjImporter::ParseFace(ObjChunk& chunk, const char* pos, const char* end)
+    {
+        ObjFaceVertex vertices[OBJ_MAX_FACE_VERTICES];
+        u32 count = 0;
+
+        while (true)
+        {
+            pos = SkipSpaces(pos, end);
+            if (pos >= end) break;
+
+            if (count == OBJ_MAX_FACE_VERTICES)
+            {
+                WARN_LOG("Skipping face with more than {} vertices.", OBJ_MAX_FACE_VERTICES);
+                return;
+            }
+
+            // A vertex is formatted as: position, position/texCoord, position//normal or position/texCoord/normal
+            auto& vertex = vertices[count++];
+            if (!ParseIndex(pos, end, vertex.position))
+            {
+                WARN_LOG("Skipping face with an invalid (or relative) index: '{}'.", String(pos, static_cast<u64>(end - pos)));
+                return;
+            }
+
+            if (pos < end && *pos == '/')
+            {
+                pos++;
+                if (pos < end && *pos != '/' && !ParseIndex(pos, end, vertex.texCoord))
+                {
+                    WARN_LOG("Skipping face with an invalid texture coordinate index.");
+                    return;
+                }
+
+                if (pos < end && *pos == '/')
+                {
+                    pos++;
+                    if (!ParseIndex(pos, end, vertex.normal))
+                    {
+                        WARN_LOG("Skipping face with an invalid normal index.");
+                        return;
+                    }
+                }
+            }
+        }
+
+        if (count < 3)
+        {
+            WARN_LOG("Skipping face with only {} vertices.", count);
+            return;
+        }
+
+        // Triangulate the polygon as a fan around the first vertex
+        for (u32 i = 2; i < count; i++)
+        {
+            chunk.faceVertices.PushBack(vertices[0]);
+            chunk.faceVertices.PushBack(vertices[i - 1]);
+            chunk.faceVertices.PushBack(vertices[i]);
+        }
+    }
+
+    void ObjImporter::MergeChunks()
+    {
+        // Indices in an OBJ file are global so the data of every chunk goes right after the data of the chunks before it
+        u64 positionCount = 0, normalCount = 0, texCoordCount = 0;
+        for (auto& chunk : m_chunks)
+        {
+            chunk.positionOffset = positionCount;
+            chunk.normalOffset   = normalCount;
+            chunk.texCoordOffset = texCoordCount;
+
+            positionCount += chunk.positions.Size();
+            normalCount += chunk.normals.Size();
+            texCoordCount += chunk.texCoords.Size();
+        }
+
+        m_positions.Resize(positionCount);
+        m_normals.Resize(normalCount);
+        m_texCoords.Resize(texCoordCount);
+
+        m_jobSystem->ParallelFor(m_chunks.Size(), 1, [this](const u64 begin, const u64 end, LinearAllocator&) {
+            for (u64 i = begin; i < end; i++)
+            {
+                const auto& chunk = m_chunks[i];
+                std::copy(chunk.positions.begin(), chunk.positions.end(), m_positions.begin() + chunk.positionOffset);
+                std::copy(chunk.normals.begin(), chunk.normals.end(), m_normals.begin() + chunk.normalOffset);
+                std::copy(chunk.texCoords.begin(), chunk.texCoords.end(), m_texCoords.begin() + chunk.texCoordOffset);
+            }
+        });
+    }
+
+    void ObjImporter::BuildGroups()
+    {
+        for (u32 c = 0; c < m_chunks.Size(); c++)
+        {
+            const auto& chunk = m_chunks[c];
+
+            u64 cursor = 0;
+            for (const auto& command : chunk.commands)
+            {
+                // All faces up to this command belong to the current group
+                AddFaces(c, cursor, command.faceVertexIndex);
+                cursor = command.faceVertexIndex;
+
+                switch (command.type)
+                {
+                    case ObjCommandType::UseMaterial:
+                    {
+                        // Anytime there is a usemtl, assume a new group
+                        auto& group        = m_currentGroups.EmplaceBack();
+                        group.materialName = command.name;
+                        break;
+                    }
+                    case ObjCommandType::MaterialLibrary:
+                        m_materialLibrary = command.name;
+                        break;
+                    case ObjCommandType::Object:
+                        m_name = command.name;
+                        break;
+                    case ObjCommandType::Group:
+                        // A new group finishes all the groups we have so far
+                        FlushGroups();
+                        m_name = command.name;
+                        break;
+                }
+            }
+
+            AddFaces(c, cursor, chunk.faceVertices.Size());
+        }
+
+        FlushGroups();
+    }
+
+    void ObjImporter::AddFaces(const u32 chunk, const u64 begin, const u64 end)
+    {
+        if (begin == end) return;
+
+        // Faces without a preceding usemtl get a group without a material
+        if (m_currentGroups.Empty()) m_currentGroups.EmplaceBack();
+
+        m_currentGroups[m_currentGroups.Size() - 1].ranges.EmplaceBack(chunk, begin, end);
+    }
+
+    void ObjImporter::FlushGroups()
+    {
+        for (u64 i = 0; i < m_currentGroups.Size(); i++)
+        {
+            auto& group = m_currentGroups[i];
+            // Groups without any faces would result in empty geometry
+            if (group.ranges.Empty()) continue;
+
+            group.name = m_name;
+            if (i > 0)
+            {
+                group.name += i;
+            }
+
+            m_groups.PushBack(group);
+        }
+
+        m_currentGroups.Clear();
+    }
+
+    bool ObjImporter::BuildGeometry(const ObjGroup& group, GeometryConfig& config) const
+    {
+        config.name         = group.name;
+        config.materialName = group.materialName;
+
+        u64 indexCount = 0;
+        for (const auto& range : group.ranges) indexCount += range.end - range.begin;
+
+        // Faces that share the same position, texture coordinate and normal share the same vertex
+        FlatHashMap<ObjFaceVertex, u32, ObjFaceVertexHash> uniqueVertices;
+        uniqueVertices.Create(indexCount);
+
+        config.indices.Reserve(indexCount);
+        config.vertices.Reserve(indexCount / 2);
+
+        for (const auto& range : group.ranges)
+        {
+            const auto& faceVertices = m_chunks[range.chunk].faceVertices;
+            for (u64 i = range.begin; i < range.end; i++)
+            {
+                const auto& faceVertex = faceVertices[i];
+                if (const auto index = uniqueVertices.Find(faceVertex))
+                {
+                    config.indices.PushBack(*index);
+                    continue;
+                }
+
+                if (faceVertex.position > m_positions.Size() || faceVertex.normal > m_normals.Size() ||
+                    faceVertex.texCoord > m_texCoords.Size())
+                {
+                    ERROR_LOG("Geometry: '{}' references a vertex attribute that does not exist.", group.name);
+                    return false;
+                }
+
+                Vertex3D vertex;
+                vertex.position = m_positions[faceVertex.position - 1];
+                vertex.normal   = faceVertex.normal ? m_normals[faceVertex.normal - 1] : vec3(0, 0, 1);
+                vertex.texture  = faceVertex.texCoord ? m_texCoords[faceVertex.texCoord - 1] : vec2(0, 0);
+                // TODO: color. Currently hardcoded to white
+                vertex.color   = vec4(1);
+                vertex.tangent = vec3(0);
+
+                const auto index = static_cast<u32>(config.vertices.Size());
+                config.vertices.PushBack(vertex);
+                config.indices.PushBack(index);
+                uniqueVertices.Set(faceVertex, index);
+            }
+        }
+
+        // Calculate the extents and the center
+        config.minExtents = config.vertices[0].position;
+        config.maxExtents = config.vertices[0].position;
+        for (const auto& vertex : config.vertices)
+        {
+            config.minExtents = glm::min(config.minExtents, vertex.position);
+            config.maxExtents = glm::max(config.maxExtents, vertex.position);
+        }
+        config.center = (config.minExtents + config.maxExtents) * 0.5f;
+
+        GeometryUtils::GenerateTangents(config.vertices, config.indices);
+        return true;
+    }
+
+    void ObjImporter::Reset()
+    {
+        m_chunks.Destroy();
+        m_positions.Destroy();
+        m_normals.Destroy();
+        m_texCoords.Destroy();
+        m_currentGroups.Destroy();
+        m_groups.Destroy();
+    }
+}  // namespace C3D
@@ -0,0 +1,142 @@
+#pragma once
+#include "containers/dynamic_array.h"
+#include "defines.h"
+#include "resources/geometry_config.h"
+#include "string/string.h"
+
+namespace C3D
+{
+    class JobSystem;
+
+    /** @brief The default (approximate) size of the chunks that an OBJ file is split into. Every chunk is parsed by a single job. */
+    constexpr u64 OBJ_IMPORTER_DEFAULT_CHUNK_SIZE = MebiBytes(1);
+
+    /** @brief A single vertex of a face in an OBJ file. Indices are 1-based and 0 means that the attribute is not present. */
+    struct ObjFaceVertex
+    {
+        u32 position = 0;
+        u32 texCoord = 0;
+        u32 normal   = 0;
+
+        bool operator==(const ObjFaceVertex& other) const
+        {
+            return position == other.position && texCoord == other.texCoord && normal == other.normal;
+        }
+    };
+
+    enum class ObjCommandType : u8
+    {
+        UseMaterial,
+        MaterialLibrary,
+        Object,
+        Group,
+    };
+
+    /** @brief A statement (usemtl, mtllib, o or g) that changes how the faces that follow it are grouped into geometries. */
+    struct ObjCommand
+    {
+        ObjCommandType type;
+        /** @brief The index of the first face vertex (in the chunk) that comes after this command. */
+        u64 faceVertexIndex = 0;
+        String name;
+    };
+
+    /** @brief Everything that was parsed from a single (line-aligned) chunk of an OBJ file. */
+    struct ObjChunk
+    {
+        const char* begin = nullptr;
+        const char* end   = nullptr;
+
+        DynamicArray<vec3> positions;
+        DynamicArray<vec3> normals;
+        DynamicArray<vec2> texCoords;
+        /** @brief The vertices of all faces in this chunk. Faces are triangulated so every 3 vertices make up a triangle. */
+        DynamicArray<ObjFaceVertex> faceVertices;
+        DynamicArray<ObjCommand> commands;
+
+        /** @brief Where the positions, normals and texture coordinates of this chunk start in the merged arrays. */
+        u64 positionOffset = 0;
+        u64 normalOffset   = 0;
+        u64 texCoordOffset = 0;
+    };
+
+    /** @brief A range of face vertices [begin, end) in a chunk. */
+    struct ObjFaceRange
+    {
+        u32 chunk = 0;
+        u64 begin = 0;
+        u64 end   = 0;
+    };
+
+    /** @brief The faces (spread over possibly many chunks) that make up a single geometry. */
+    struct ObjGroup
+    {
+        String name;
+        String materialName;
+        DynamicArray<ObjFaceRange> ranges;
+    };
+
+    /**
+     * @brief Imports OBJ files into geometry configs using all threads of the job system.
+     * The file is memory-mapped and split into line-aligned chunks which are parsed in parallel. Afterwards the statements
+     * that group faces are replayed in order and every geometry is built (and de-duplicated) in parallel.
+     */
+    class C3D_API ObjImporter
+    {
+    public:
+        explicit ObjImporter(JobSystem& jobSystem, u64 chunkSize = OBJ_IMPORTER_DEFAULT_CHUNK_SIZE);
+
+        /**
+         * @brief Imports the OBJ file at the provided path.
+         *
+         * @param path The path to the OBJ file
+         * @param outGeometries The array that the imported geometries are added to
+         * @return True if successful; False otherwise
+         */
+        bool Import(const String& path, DynamicArray<GeometryConfig>& outGeometries);
+
+        /** @brief Imports OBJ data that is already in memory. */
+        bool Import(const char* data, u64 size, DynamicArray<GeometryConfig>& outGeometries);
+
+        /** @brief Gets the name of the last object (or group) in the file. Used as the name of the mesh. */
+        [[nodiscard]] const String& GetName() const { return m_name; }
+        /** @brief Gets the name of the material library (.mtl file) referenced by the file or an empty string if there is none. */
+        [[nodiscard]] const String& GetMaterialLibrary() const { return m_materialLibrary; }
+
+    private:
+        void SplitIntoChunks(const char* data, u64 size);
+
+        static void ParseChunk(ObjChunk& chunk);
+        static void ParseLine(ObjChunk& chunk, const char* pos, const char* end);
+        static void ParseFace(ObjChunk& chunk, const char* pos, const char* end);
+
+        /** @brief Concatenates the positions, normals and texture coordinates of all chunks. */
+        void MergeChunks();
+        /** @brief Replays the commands of all chunks in order to determine which faces belong to which geometry. */
+        void BuildGroups();
+        void AddFaces(u32 chunk, u64 begin, u64 end);
+        void FlushGroups();
+
+        bool BuildGeometry(const ObjGroup& group, GeometryConfig& config) const;
+
+        /** @brief Frees all the intermediate data. */
+        void Reset();
+
+        JobSystem* m_jobSystem = nullptr;
+        u64 m_chunkSize        = OBJ_IMPORTER_DEFAULT_CHUNK_SIZE;
+
+        DynamicArray<ObjChunk> m_chunks;
+
+        DynamicArray<vec3> m_positions;
+        DynamicArray<vec3> m_normals;
+        DynamicArray<vec2> m_texCoords;
+
+        /** @brief The groups that have been started (by usemtl) but not yet finished (by g or the end of the file). */
+        DynamicArray<ObjGroup> m_currentGroups;
+        /** @brief The groups that will become geometries. */
+        DynamicArray<ObjGroup> m_groups;
+
+        String m_name;
+        String m_materialLibrary;
+    };
+}  // namespace C3D
@@ -2,8 +2,11 @@
 #include "scene.h"
 
 #include "frame_data.h"
+#include "math/aabb_list.h"
 #include "math/frustum.h"
 #include "math/ray.h"
+#include "memory/allocators/frame_allocator.h"
+#include "renderer/render_sort.h"
 #include "renderer/renderer_types.h"
 #include "renderer/viewport.h"
 #include "resources/debug/debug_box_3d.h"
@@ -26,16 +29,44 @@ namespace C3D
         DebugBox3D box;
     };
 
-    struct GeometryDistance
+    struct MeshCullingCandidate
     {
-        /** @brief The geometry render data. */
-        GeometryRenderData g;
-        /** @brief The distance from the camera. */
-        f32 distance;
+        /** @brief The id of the mesh that this geometry belongs to. */
+        UUID uuid;
+        /** @brief The world matrix of the mesh. */
+        const mat4* model;
+        /** @brief The geometry that needs to be tested. */
+        const Geometry* geometry;
+        bool windingInverted;
+    };
+
+    struct TerrainCullingCandidate
+    {
+        /** @brief The terrain that this chunk belongs to. */
+        const Terrain* terrain;
+        /** @brief The world matrix of the terrain. */
+        const mat4* model;
+        /** @brief The chunk that needs to be tested. */
+        const TerrainChunk* chunk;
+        bool windingInverted;
     };
 
     static u32 global_scene_id = 0;
 
+    /** @brief Builds the sort key for a geometry of a mesh. Geometries with transparency are sorted back to front after opaque ones. */
+    static u64 MakeMeshSortKey(const RenderSortPass pass, const Geometry* geometry, const f32 distance)
+    {
+        const auto material   = geometry->material;
+        const auto shaderId   = material ? material->shaderId : INVALID_ID;
+        const auto materialId = material ? material->internalId : INVALID_ID;
+
+        if (material && !material->maps.Empty() && Textures.HasTransparency(material->maps[0].texture))
+        {
+            return RenderSort::MakeTranslucentKey(pass, shaderId, materialId, distance, geometry->id);
+        }
+        return RenderSort::MakeOpaqueKey(pass, shaderId, materialId, distance, geometry->id);
+    }
+
     Scene::Scene() : m_name("NO_NAME"), m_description("NO_DESCRIPTION") {}
 
     bool Scene::Create() { return Create({}); }
@@ -62,6 +93,12 @@ namespace C3D
             return false;
         }
 
+        if (!m_bvh.Create())
+        {
+            ERROR_LOG("Failed to create BVH.");
+            return false;
+        }
+
         return true;
     }
 
@@ -297,6 +334,9 @@ namespace C3D
             return false;
         }
 
+        // Now that all world matrices are up-to-date we can update the bounds in our BVH
+        UpdateBVH();
+
         for (const auto& object : m_objects)
         {
             if (object.id == INVALID_ID) continue;
@@ -410,266 +450,215 @@ namespace C3D
     }
 
     void Scene::QueryMeshes(FrameData& frameData, const Frustum& frustum, const vec3& cameraPosition,
-                            DynamicArray<GeometryRenderData, LinearAllocator>& meshData) const
+                            DynamicArray<GeometryRenderData, FrameAllocator>& meshData) const
     {
-        DynamicArray<GeometryDistance, LinearAllocator> transparentGeometries(32, frameData.allocator);
+        DynamicArray<MeshCullingCandidate, FrameAllocator> candidates(256, frameData.allocator);
+        AABBList<FrameAllocator> aabbs(256, frameData.allocator);
 
-        for (const auto& object : m_objects)
-        {
-            if (object.id == INVALID_ID) continue;
-            if (object.type != SceneObjectType::Mesh) continue;
+        // Gather the world-space AABBs of the geometries of all meshes that the BVH finds in our frustum so we can test them in batches
+        m_bvh.QueryFrustum(frustum, [&](const u32 objectIndex) {
+            const auto& object = m_objects[objectIndex];
+            if (object.type != SceneObjectType::Mesh) return;
 
             const auto& mesh = m_meshes[object.resourceIndex];
             if (mesh.generation != INVALID_ID_U8)
             {
                 auto transform       = m_graph.GetTransform(object.node);
-                mat4 model           = Transforms.GetWorld(transform);
+                const auto& model    = Transforms.GetWorld(transform);
                 bool windingInverted = Transforms.GetDeterminant(transform) < 0;
 
                 for (const auto geometry : mesh.geometries)
                 {
-                    // AABB Calculation
-                    const vec3 extentsMax = model * vec4(geometry->extents.max, 1.0f);
-                    const vec3 center     = model * vec4(geometry->center, 1.0f);
-
-                    const vec3 halfExtents = {
-                        Abs(extentsMax.x - center.x),
-                        Abs(extentsMax.y - center.y),
-                        Abs(extentsMax.z - center.z),
-                    };
-
-                    if (frustum.IntersectsWithAABB({ center, halfExtents }))
-                    {
-                        GeometryRenderData data(mesh.GetId(), model, geometry, windingInverted);
-
-                        // Check if transparent. If so, put into a separate, temp array to be
-                        // sorted by distance from the camera. Otherwise, we can just directly insert into the geometries dynamic array
-                        if (Textures.HasTransparency(geometry->material->maps[0].texture))
-                        {
-                            // For meshes _with_ transparency, add them to a separate list to be sorted by distance later.
-                            // Get the center, extract the global position from the model matrix and add it to the center,
-                            // then calculate the distance between it and the camera, and finally save it to a list to be sorted.
-                            // NOTE: This isn't perfect for translucent meshes that intersect, but is enough for our purposes now.
-                            f32 distance = glm::distance(center, cameraPosition);
-
-                            transparentGeometries.EmplaceBack(data, distance);
-                        }
-                        else
-                        {
-                            meshData.PushBack(data);
-                        }
-                    }
+                    aabbs.PushBack(TransformAABB(model, geometry->center, geometry->extents.max - geometry->center));
+                    candidates.EmplaceBack(mesh.GetId(), &model, geometry, windingInverted);
                 }
             }
-        }
-
-        // Sort opaque geometries by material.
-        std::sort(meshData.begin(), meshData.end(),
-                  [](const GeometryRenderData& a, const GeometryRenderData& b) { return a.material->internalId < b.material->internalId; });
+        });
 
-        // Sort transparent geometries
-        std::sort(transparentGeometries.begin(), transparentGeometries.end(),
-                  [](const GeometryDistance& a, const GeometryDistance& b) { return a.distance > b.distance; });
+        auto visibility = frameData.allocator->Allocate<u64>(MemoryType::Array, GetVisibilityMaskSize(aabbs.Size()));
+        frustum.IntersectsWithAABBs(aabbs.GetArrays(), visibility);
 
-        // Then add them to the end of our meshData
-        for (auto& tg : transparentGeometries)
+        for (u64 i = 0; i < candidates.Size(); ++i)
         {
-            meshData.PushBack(tg.g);
+            if (!IsVisible(visibility, i)) continue;
+
+            const auto& candidate = candidates[i];
+            auto& data            = meshData.EmplaceBack(candidate.uuid, *candidate.model, candidate.geometry, candidate.windingInverted);
+
+            // We use the distance between the (world-space) center of the geometry and the camera
+            // NOTE: This isn't perfect for translucent meshes that intersect, but is enough for our purposes now.
+            const f32 distance = glm::distance(aabbs.Get(i).center, cameraPosition);
+            data.sortKey       = MakeMeshSortKey(RenderSortPass::Scene, candidate.geometry, distance);
         }
+
+        // Sort by state for opaque geometries and back to front for transparent geometries (which end up after the opaque ones)
+        RenderSort::Sort(frameData.allocator, meshData);
     }
 
     void Scene::QueryMeshes(FrameData& frameData, const vec3& direction, const vec3& center, f32 radius,
-                            DynamicArray<GeometryRenderData, LinearAllocator>& meshData) const
+                            DynamicArray<GeometryRenderData, FrameAllocator>& meshData) const
 
     {
-        DynamicArray<GeometryDistance, LinearAllocator> transparentGeometries(32, frameData.allocator);
+        // Only consider the meshes that the BVH finds within radius of our line
+        m_bvh.QueryLine(center, direction, radius, [&](const u32 objectIndex) {
+            const auto& object = m_objects[objectIndex];
+            if (object.type != SceneObjectType::Mesh) return;
 
-        for (const auto& object : m_objects)
-        {
-            if (object.id == INVALID_ID) continue;
-            if (object.type == SceneObjectType::Mesh)
+            const auto& mesh = m_meshes[object.resourceIndex];
+            if (mesh.generation == INVALID_ID_U8) return;
+
+            auto transform       = m_graph.GetTransform(object.node);
+            mat4 model           = Transforms.GetWorld(transform);
+            bool windingInverted = Transforms.GetDeterminant(transform) < 0;
+
+            for (const auto geometry : mesh.geometries)
             {
-                const auto& mesh = m_meshes[object.resourceIndex];
-                if (mesh.generation != INVALID_ID_U8)
+                // Translate/scale the extents
+                const vec3 extentsMin = model * vec4(geometry->extents.min, 1.0f);
+                const vec3 extentsMax = model * vec4(geometry->extents.max, 1.0f);
+                // Translate/scale the center
+                const vec3 transformedCenter = model * vec4(geometry->center, 1.0f);
+                // Find the one furthest from the center
+                f32 meshRadius = Max(glm::distance(extentsMin, transformedCenter), glm::distance(extentsMax, transformedCenter));
+                // Distance to the line
+                f32 distToLine = DistancePointToLine(transformedCenter, center, direction);
+
+                // If it's within the distance we include it
+                if ((distToLine - meshRadius) <= radius)
                 {
-                    auto transform       = m_graph.GetTransform(object.node);
-                    mat4 model           = Transforms.GetWorld(transform);
-                    bool windingInverted = Transforms.GetDeterminant(transform) < 0;
+                    auto& data = meshData.EmplaceBack(mesh.GetId(), model, geometry, windingInverted);
 
-                    for (const auto geometry : mesh.geometries)
-                    {
-                        // Translate/scale the extents
-                        const vec3 extentsMin = model * vec4(geometry->extents.min, 1.0f);
-                        const vec3 extentsMax = model * vec4(geometry->extents.max, 1.0f);
-                        // Translate/scale the center
-                        const vec3 transformedCenter = model * vec4(geometry->center, 1.0f);
-                        // Find the one furthest from the center
-                        f32 meshRadius = Max(glm::distance(extentsMin, transformedCenter), glm::distance(extentsMax, transformedCenter));
-                        // Distance to the line
-                        f32 distToLine = DistancePointToLine(transformedCenter, center, direction);
-
-                        // If it's within the distance we include it
-                        if ((distToLine - meshRadius) <= radius)
-                        {
-                            GeometryRenderData data(mesh.GetId(), model, geometry, windingInverted);
-
-                            // Check if transparent. If so, put into a separate, temp array to be
-                            // sorted by distance from the camera. Otherwise, we can just directly insert into the geometries dynamic
-                            // array
-                            if (Textures.HasTransparency(geometry->material->maps[0].texture))
-                            {
-                                // For meshes _with_ transparency, add them to a separate list to be sorted by distance later.
-                                // Get the center, extract the global position from the model matrix and add it to the center,
-                                // then calculate the distance between it and the camera, and finally save it to a list to be sorted.
-                                // NOTE: This isn't perfect for translucent meshes that intersect, but is enough for our purposes now.
-                                f32 distance = glm::distance(transformedCenter, center);
-                                transparentGeometries.EmplaceBack(data, distance);
-                            }
-                            else
-                            {
-                                meshData.PushBack(data);
-                            }
-                        }
-                    }
+                    // NOTE: This isn't perfect for translucent meshes that intersect, but is enough for our purposes now.
+                    const f32 distance = glm::distance(transformedCenter, center);
+                    data.sortKey       = MakeMeshSortKey(RenderSortPass::Shadow, geometry, distance);
                 }
             }
-        }
-
-        // Sort opaque geometries by material.
-        std::sort(meshData.begin(), meshData.end(), [](const GeometryRenderData& a, const GeometryRenderData& b) {
-            if (!a.material || !b.material) return false;
-            return a.material->internalId < b.material->internalId;
         });
 
-        // Sort transparent geometries
-        std::sort(transparentGeometries.begin(), transparentGeometries.end(),
-                  [](const GeometryDistance& a, const GeometryDistance& b) { return a.distance > b.distance; });
-
-        // Then add them to the end of our meshData
-        for (auto& tg : transparentGeometries)
-        {
-            meshData.PushBack(tg.g);
-        }
+        // Sort by state for opaque geometries and back to front for transparent geometries (which end up after the opaque ones)
+        RenderSort::Sort(frameData.allocator, meshData);
     }
 
     void Scene::QueryTerrains(FrameData& frameData, const Frustum& frustum, const vec3& cameraPosition,
-                              DynamicArray<GeometryRenderData, LinearAllocator>& terrainData) const
+                              DynamicArray<GeometryRenderData, FrameAllocator>& terrainData) const
     {
-        for (const auto& object : m_objects)
-        {
-            if (object.id == INVALID_ID) continue;
-            if (object.type != SceneObjectType::Terrain) continue;
+        DynamicArray<TerrainCullingCandidate, FrameAllocator> candidates(256, frameData.allocator);
+        AABBList<FrameAllocator> aabbs(256, frameData.allocator);
+
+        // Gather the world-space AABBs of the chunks of all terrains that the BVH finds in our frustum so we can test them in batches
+        m_bvh.QueryFrustum(frustum, [&](const u32 objectIndex) {
+            const auto& object = m_objects[objectIndex];
+            if (object.type != SceneObjectType::Terrain) return;
 
             auto& terrain = m_terrains[object.resourceIndex];
             if (terrain.GetId())
             {
                 auto transform       = m_graph.GetTransform(object.node);
-                mat4 model           = Transforms.GetWorld(transform);
+                const auto& model    = Transforms.GetWorld(transform);
                 bool windingInverted = Transforms.GetDeterminant(transform) < 0;
 
                 for (const auto& chunk : terrain.GetChunks())
                 {
                     if (chunk.generation != INVALID_ID_U8)
                     {
-                        // AABB Calculation
                         const auto& extents = chunk.GetExtents();
+                        const auto& center  = chunk.GetCenter();
+
+                        aabbs.PushBack(TransformAABB(model, center, extents.max - center));
+                        candidates.EmplaceBack(&terrain, &model, &chunk, windingInverted);
+                    }
+                }
+            }
+        });
 
-                        const vec3 extentsMax = model * vec4(extents.max, 1.0f);
-                        const vec3 center     = model * vec4(chunk.GetCenter(), 1.0f);
+        auto visibility = frameData.allocator->Allocate<u64>(MemoryType::Array, GetVisibilityMaskSize(aabbs.Size()));
+        frustum.IntersectsWithAABBs(aabbs.GetArrays(), visibility);
 
-                        const vec3 halfExtents = {
-                            Abs(extentsMax.x - center.x),
-                            Abs(extentsMax.y - center.y),
-                            Abs(extentsMax.z - center.z),
-                        };
+        for (u64 i = 0; i < candidates.Size(); ++i)
+        {
+            if (!IsVisible(visibility, i)) continue;
 
-                        if (frustum.IntersectsWithAABB({ center, halfExtents }))
-                        {
-                            GeometryRenderData data;
-                            data.uuid            = terrain.GetId();
-                            data.material        = terrain.GetMaterial();
-                            data.windingInverted = windingInverted;
-                            data.model           = model;
+            const auto& candidate = candidates[i];
+            const auto& chunk     = *candidate.chunk;
 
-                            data.vertexCount        = chunk.GetVertexCount();
-                            data.vertexSize         = chunk.GetVertexSize();
-                            data.vertexBufferOffset = chunk.GetVertexBufferOffset();
+            GeometryRenderData data;
+            data.uuid            = candidate.terrain->GetId();
+            data.material        = candidate.terrain->GetMaterial();
+            data.windingInverted = candidate.windingInverted;
+            data.model           = *candidate.model;
 
-                            data.indexCount        = chunk.GetIndexCount();
-                            data.indexSize         = chunk.GetIndexSize();
-                            data.indexBufferOffset = chunk.GetIndexBufferOffset();
+            data.vertexCount        = chunk.GetVertexCount();
+            data.vertexSize         = chunk.GetVertexSize();
+            data.vertexBufferOffset = chunk.GetVertexBufferOffset();
 
-                            terrainData.PushBack(data);
-                        }
-                    }
-                }
-            }
+            data.indexCount        = chunk.GetIndexCount();
+            data.indexSize         = chunk.GetIndexSize();
+            data.indexBufferOffset = chunk.GetIndexBufferOffset();
+
+            terrainData.PushBack(data);
         }
     }
 
     void Scene::QueryTerrains(FrameData& frameData, const vec3& direction, const vec3& center, f32 radius,
-                              DynamicArray<GeometryRenderData, LinearAllocator>& terrainData) const
+                              DynamicArray<GeometryRenderData, FrameAllocator>& terrainData) const
     {
-        for (const auto& object : m_objects)
-        {
-            if (object.id == INVALID_ID) continue;
-            if (object.type != SceneObjectType::Terrain) continue;
+        // Only consider the terrains that the BVH finds within radius of our line
+        m_bvh.QueryLine(center, direction, radius, [&](const u32 objectIndex) {
+            const auto& object = m_objects[objectIndex];
+            if (object.type != SceneObjectType::Terrain) return;
 
             auto& terrain = m_terrains[object.resourceIndex];
-            if (terrain.GetId())
-            {
-                auto transform       = m_graph.GetTransform(object.node);
-                mat4 model           = Transforms.GetWorld(transform);
-                bool windingInverted = Transforms.GetDeterminant(transform) < 0;
+            if (!terrain.GetId()) return;
 
-                for (const auto& chunk : terrain.GetChunks())
+            auto transform       = m_graph.GetTransform(object.node);
+            mat4 model           = Transforms.GetWorld(transform);
+            bool windingInverted = Transforms.GetDeterminant(transform) < 0;
+
+            for (const auto& chunk : terrain.GetChunks())
+            {
+                if (chunk.generation != INVALID_ID_U8)
                 {
-                    if (chunk.generation != INVALID_ID_U8)
-                    {
-                        // Translate/scale the extents
-                        const auto& extents = chunk.GetExtents();
+                    // Translate/scale the extents
+                    const auto& extents = chunk.GetExtents();
 
-                        const vec3 extentsMin = model * vec4(extents.min, 1.0f);
-                        const vec3 extentsMax = model * vec4(extents.max, 1.0f);
+                    const vec3 extentsMin = model * vec4(extents.min, 1.0f);
+                    const vec3 extentsMax = model * vec4(extents.max, 1.0f);
 
-                        // Translate/scale the center
-                        const vec3 transformedCenter = model * vec4(chunk.GetCenter(), 1.0f);
+                    // Translate/scale the center
+                    const vec3 transformedCenter = model * vec4(chunk.GetCenter(), 1.0f);
 
-                        // Find the one furthest from the center
-                        f32 chunkRadius = Max(glm::distance(extentsMin, transformedCenter), glm::distance(extentsMax, transformedCenter));
+                    // Find the one furthest from the center
+                    f32 chunkRadius = Max(glm::distance(extentsMin, transformedCenter), glm::distance(extentsMax, transformedCenter));
 
-                        // Distance to the line
-                        f32 distToLine = DistancePointToLine(transformedCenter, center, direction);
+                    // Distance to the line
+                    f32 distToLine = DistancePointToLine(transformedCenter, center, direction);
 
-                        // If it's within the distance we include it
-                        if ((distToLine - chunkRadius) <= radius)
-                        {
-                            GeometryRenderData data;
-                            data.uuid            = terrain.GetId();
-                            data.material        = terrain.GetMaterial();
-                            data.windingInverted = windingInverted;
-                            data.model           = model;
+                    // If it's within the distance we include it
+                    if ((distToLine - chunkRadius) <= radius)
+                    {
+                        GeometryRenderData data;
+                        data.uuid            = terrain.GetId();
+                        data.material        = terrain.GetMaterial();
+                        data.windingInverted = windingInverted;
+                        data.model           = model;
 
-                            data.vertexCount        = chunk.GetVertexCount();
-                            data.vertexSize         = chunk.GetVertexSize();
-                            data.vertexBufferOffset = chunk.GetVertexBufferOffset();
+                        data.vertexCount        = chunk.GetVertexCount();
+                        data.vertexSize         = chunk.GetVertexSize();
+                        data.vertexBufferOffset = chunk.GetVertexBufferOffset();
 
-                            data.indexCount        = chunk.GetIndexCount();
-                            data.indexSize         = chunk.GetIndexSize();
-                            data.indexBufferOffset = chunk.GetIndexBufferOffset();
+                        data.indexCount        = chunk.GetIndexCount();
+                        data.indexSize         = chunk.GetIndexSize();
+                        data.indexBufferOffset = chunk.GetIndexBufferOffset();
 
-                            terrainData.PushBack(data);
-                        }
+                        terrainData.PushBack(data);
                     }
                 }
             }
-        }
+        });
     }
 
-    void Scene::QueryMeshes(FrameData& frameData, DynamicArray<GeometryRenderData, LinearAllocator>& meshData) const
+    void Scene::QueryMeshes(FrameData& frameData, DynamicArray<GeometryRenderData, FrameAllocator>& meshData) const
     {
-        C3D::DynamicArray<GeometryDistance, LinearAllocator> transparentGeometries(32, frameData.allocator);
-
         for (const auto& object : m_objects)
         {
             if (object.id == INVALID_ID) continue;
@@ -684,28 +673,18 @@ namespace C3D
 
                     for (const auto geometry : mesh.geometries)
                     {
-                        meshData.EmplaceBack(mesh.GetId(), model, geometry, windingInverted);
+                        auto& data = meshData.EmplaceBack(mesh.GetId(), model, geometry, windingInverted);
+                        // Without a camera we have no distance so we only sort by state
+                        data.sortKey = MakeMeshSortKey(RenderSortPass::Scene, geometry, 0.0f);
                     }
                 }
             }
         }
 
-        // Sort opaque geometries by material.
-        std::sort(meshData.begin(), meshData.end(),
-                  [](const GeometryRenderData& a, const GeometryRenderData& b) { return a.material->internalId < b.material->internalId; });
-
-        // Sort transparent geometries
-        std::sort(transparentGeometries.begin(), transparentGeometries.end(),
-                  [](const GeometryDistance& a, const GeometryDistance& b) { return a.distance > b.distance; });
-
-        // Then add them to the end of our meshData
-        for (auto& tg : transparentGeometries)
-        {
-            meshData.PushBack(tg.g);
-        }
+        RenderSort::Sort(frameData.allocator, meshData);
     }
 
-    void Scene::QueryTerrains(FrameData& frameData, DynamicArray<GeometryRenderData, LinearAllocator>& terrainData) const
+    void Scene::QueryTerrains(FrameData& frameData, DynamicArray<GeometryRenderData, FrameAllocator>& terrainData) const
     {
         for (const auto& object : m_objects)
         {
@@ -741,7 +720,7 @@ namespace C3D
         }
     }
 
-    void Scene::QueryDebugGeometry(FrameData& frameData, DynamicArray<GeometryRenderData, LinearAllocator>& debugData) const
+    void Scene::QueryDebugGeometry(FrameData& frameData, DynamicArray<GeometryRenderData, FrameAllocator>& debugData) const
     {
         // Grid
         constexpr auto identity = mat4(1.0f);
@@ -787,7 +766,7 @@ namespace C3D
         }
     }
 
-    void Scene::QueryDirectionalLights(FrameData& frameData, DynamicArray<DirectionalLightData, LinearAllocator>& lightData) const
+    void Scene::QueryDirectionalLights(FrameData& frameData, DynamicArray<DirectionalLightData, FrameAllocator>& lightData) const
     {
         for (const auto& object : m_objects)
         {
@@ -799,7 +778,7 @@ namespace C3D
         }
     }
 
-    void Scene::QueryPointLights(FrameData& frameData, DynamicArray<PointLightData, LinearAllocator>& lightData) const
+    void Scene::QueryPointLights(FrameData& frameData, DynamicArray<PointLightData, FrameAllocator>& lightData) const
     {
         for (const auto& object : m_objects)
         {
@@ -1233,6 +1212,11 @@ namespace C3D
                 {
                     ERROR_LOG("Failed to destroy Mesh: '{}'.", name);
                 }
+                // Remove it from our BVH
+                if (object.bvhProxy != INVALID_ID)
+                {
+                    m_bvh.Remove(object.bvhProxy);
+                }
                 // Destroy the object
                 object.Destroy();
                 return true;
@@ -1334,6 +1318,11 @@ namespace C3D
                 // Get the terrain and unload it
                 auto& terrain = m_terrains[object.resourceIndex];
                 terrain.Destroy();
+                // Remove it from our BVH
+                if (object.bvhProxy != INVALID_ID)
+                {
+                    m_bvh.Remove(object.bvhProxy);
+                }
                 // Destroy the object
                 object.Destroy();
                 return true;
@@ -1351,29 +1340,45 @@ namespace C3D
             return false;
         }
 
-        // TODO: Optimize to not check every mesh (with Spatial partitioning) to ensure we remain performant with many meshes
-        for (auto& object : m_objects)
-        {
+        // The BVH gives us only the objects whose world bounds are hit by the ray. We then do the exact test against their OBB
+        m_bvh.QueryRay(ray, F32_MAX, [&](const u32 objectIndex, f32) {
+            const auto& object = m_objects[objectIndex];
             // We only care about interactions with meshes
-            if (object.type == SceneObjectType::Mesh)
-            {
-                f32 distance;
+            if (object.type != SceneObjectType::Mesh) return;
 
-                auto& mesh = m_meshes[object.resourceIndex];
+            f32 distance;
 
-                auto transform = m_graph.GetTransform(object.node);
-                if (ray.TestAgainstExtents(mesh.GetExtents(), Transforms.GetWorld(transform), distance))
-                {
-                    // We have a hit
-                    vec3 position = ray.origin + (ray.direction * distance);
-                    result.hits.EmplaceBack(RAY_CAST_HIT_TYPE_OBB, object.id, position, distance);
-                }
+            auto& mesh = m_meshes[object.resourceIndex];
+
+            auto transform = m_graph.GetTransform(object.node);
+            if (ray.TestAgainstExtents(mesh.GetExtents(), Transforms.GetWorld(transform), distance))
+            {
+                // We have a hit
+                vec3 position = ray.origin + (ray.direction * distance);
+                result.hits.EmplaceBack(RAY_CAST_HIT_TYPE_OBB, object.id, position, distance);
             }
-        }
+        });
 
         return !result.hits.Empty();
     }
 
+    void Scene::QueryObjects(const Sphere& sphere, DynamicArray<u32>& objectIds) const
+    {
+        m_bvh.QuerySphere(sphere, [&](const u32 objectIndex) {
+            const auto& object = m_objects[objectIndex];
+
+            // The BVH stores fattened bounds so we still need to test against the actual bounds of the object
+            Extents3D extents;
+            if (!GetWorldExtents(object, extents)) return;
+
+            const vec3 closestPoint = glm::clamp(sphere.center, extents.min, extents.max);
+            if (glm::distance(closestPoint, sphere.center) <= sphere.radius)
+            {
+                objectIds.PushBack(object.id);
+            }
+        });
+    }
+
     Handle<Transform> Scene::GetTransformById(u32 id)
     {
         for (auto& object : m_objects)
@@ -1389,6 +1394,103 @@ namespace C3D
         return Handle<Transform>();
     }
 
+    void Scene::UpdateBVH()
+    {
+        for (u32 i = 0; i < m_objects.Size(); ++i)
+        {
+            auto& object = m_objects[i];
+
+            if (object.id == INVALID_ID) continue;
+            if (object.type != SceneObjectType::Mesh && object.type != SceneObjectType::Terrain) continue;
+
+            const auto worldGeneration = Transforms.GetWorldGeneration(m_graph.GetTransform(object.node));
+            if (object.type == SceneObjectType::Mesh)
+            {
+                // Meshes only need to be updated when their transform has changed or when their geometry has (finished) loading
+                const auto& mesh = m_meshes[object.resourceIndex];
+                if (object.bvhProxy != INVALID_ID && object.worldGeneration == worldGeneration &&
+                    object.resourceGeneration == mesh.generation)
+                {
+                    continue;
+                }
+                object.resourceGeneration = mesh.generation;
+            }
+            // NOTE: Terrains load their chunks over time (and there are only a few of them) so we simply update them every frame.
+            // This is cheap since the BVH only changes when the bounds move outside of the fattened bounds of the leaf.
+            object.worldGeneration = worldGeneration;
+
+            Extents3D extents;
+            if (!GetWorldExtents(object, extents))
+            {
+                // The object has no bounds (anymore) so it should not be found by any queries
+                if (object.bvhProxy != INVALID_ID)
+                {
+                    m_bvh.Remove(object.bvhProxy);
+                    object.bvhProxy = INVALID_ID;
+                }
+                continue;
+            }
+
+            if (object.bvhProxy == INVALID_ID)
+            {
+                object.bvhProxy = m_bvh.Insert(extents, i);
+            }
+            else
+            {
+                m_bvh.Update(object.bvhProxy, extents);
+            }
+        }
+    }
+
+    bool Scene::GetWorldExtents(const SceneObject& object, Extents3D& outExtents) const
+    {
+        const auto& model = Transforms.GetWorld(m_graph.GetTransform(object.node));
+
+        if (object.type == SceneObjectType::Mesh)
+        {
+            const auto& mesh = m_meshes[object.resourceIndex];
+            if (mesh.generation == INVALID_ID_U8) return false;
+
+            const auto& extents = mesh.GetExtents();
+            const auto center   = (extents.min + extents.max) * 0.5f;
+            const auto aabb     = TransformAABB(model, center, extents.max - center);
+
+            outExtents = { aabb.center - aabb.extents, aabb.center + aabb.extents };
+            return true;
+        }
+
+        if (object.type == SceneObjectType::Terrain)
+        {
+            const auto& terrain = m_terrains[object.resourceIndex];
+            if (!terrain.GetId()) return false;
+
+            // The bounds of a terrain are the combined bounds of all it's loaded chunks
+            bool hasBounds = false;
+            for (const auto& chunk : terrain.GetChunks())
+            {
+                if (chunk.generation == INVALID_ID_U8) continue;
+
+                const auto& extents = chunk.GetExtents();
+                const auto& center  = chunk.GetCenter();
+                const auto aabb     = TransformAABB(model, center, extents.max - center);
+
+                if (hasBounds)
+                {
+                    outExtents.min = glm::min(outExtents.min, aabb.center - aabb.extents);
+                    outExtents.max = glm::max(outExtents.max, aabb.center + aabb.extents);
+                }
+                else
+                {
+                    outExtents = { aabb.center - aabb.extents, aabb.center + aabb.extents };
+                    hasBounds  = true;
+                }
+            }
+            return hasBounds;
+        }
+
+        return false;
+    }
+
     void Scene::UnloadInternal()
     {
         for (auto& object : m_objects)
@@ -1429,6 +1531,13 @@ namespace C3D
         m_meshes.Destroy();
         m_terrains.Destroy();
 
+        // All our objects are gone so we no longer need our BVH
+        m_bvh.Destroy();
+        for (auto& object : m_objects)
+        {
+            object.bvhProxy = INVALID_ID;
+        }
+
         m_enabled = false;
 
         m_state = SceneState::Uninitialized;
@@ -5,6 +5,7 @@
 #include "defines.h"
 #include "graphs/hierarchy_graph.h"
 #include "identifiers/uuid.h"
+#include "math/bvh.h"
 #include "math/frustum.h"
 #include "renderer/camera.h"
 #include "renderer/vertex.h"
@@ -74,13 +75,22 @@ namespace C3D
         u32 resourceIndex = INVALID_ID;
         /** @brief An index into the metadata array. */
         u32 metadataIndex = INVALID_ID;
+        /** @brief The proxy of this object in the scene's BVH. Will be INVALID_ID for objects that are not (yet) in the BVH. */
+        u32 bvhProxy = INVALID_ID;
+        /** @brief The world generation of the transform at the time that this object's bounds were last updated in the BVH. */
+        u32 worldGeneration = INVALID_ID;
+        /** @brief The generation of the resource at the time that this object's bounds were last updated in the BVH. */
+        u8 resourceGeneration = INVALID_ID_U8;
 
         void Destroy()
         {
-            type          = SceneObjectType::None;
-            id            = INVALID_ID;
-            resourceIndex = INVALID_ID;
-            metadataIndex = INVALID_ID;
+            type               = SceneObjectType::None;
+            id                 = INVALID_ID;
+            resourceIndex      = INVALID_ID;
+            metadataIndex      = INVALID_ID;
+            bvhProxy           = INVALID_ID;
+            worldGeneration    = INVALID_ID;
+            resourceGeneration = INVALID_ID_U8;
         }
     };
 
@@ -142,25 +152,30 @@ namespace C3D
 
         void UpdateLodFromViewPosition(FrameData& frameData, const vec3& viewPosition, f32 nearClip, f32 farClip);
 
+        /** @brief Gets the meshes in the frustum, sorted by their (scene pass) sort keys. */
         void QueryMeshes(FrameData& frameData, const Frustum& frustum, const vec3& cameraPosition,
-                         DynamicArray<GeometryRenderData, LinearAllocator>& meshData) const;
+                         DynamicArray<GeometryRenderData, FrameAllocator>& meshData) const;
+        /** @brief Gets the meshes within radius of the line, sorted by their (shadow pass) sort keys. */
         void QueryMeshes(FrameData& frameData, const vec3& direction, const vec3& center, f32 radius,
-                         DynamicArray<GeometryRenderData, LinearAllocator>& meshData) const;
+                         DynamicArray<GeometryRenderData, FrameAllocator>& meshData) const;
 
         void QueryTerrains(FrameData& frameData, const Frustum& frustum, const vec3& cameraPosition,
-                           DynamicArray<GeometryRenderData, LinearAllocator>& terrainData) const;
+                           DynamicArray<GeometryRenderData, FrameAllocator>& terrainData) const;
         void QueryTerrains(FrameData& frameData, const vec3& direction, const vec3& center, f32 radius,
-                           DynamicArray<GeometryRenderData, LinearAllocator>& terrainData) const;
+                           DynamicArray<GeometryRenderData, FrameAllocator>& terrainData) const;
 
-        void QueryMeshes(FrameData& frameData, DynamicArray<GeometryRenderData, LinearAllocator>& meshData) const;
-        void QueryTerrains(FrameData& frameData, DynamicArray<GeometryRenderData, LinearAllocator>& terrainData) const;
-        void QueryDebugGeometry(FrameData& frameData, DynamicArray<GeometryRenderData, LinearAllocator>& debugData) const;
+        void QueryMeshes(FrameData& frameData, DynamicArray<GeometryRenderData, FrameAllocator>& meshData) const;
+        void QueryTerrains(FrameData& frameData, DynamicArray<GeometryRenderData, FrameAllocator>& terrainData) const;
+        void QueryDebugGeometry(FrameData& frameData, DynamicArray<GeometryRenderData, FrameAllocator>& debugData) const;
 
-        void QueryDirectionalLights(FrameData& frameData, DynamicArray<DirectionalLightData, LinearAllocator>& lightData) const;
-        void QueryPointLights(FrameData& frameData, DynamicArray<PointLightData, LinearAllocator>& lightData) const;
+        void QueryDirectionalLights(FrameData& frameData, DynamicArray<DirectionalLightData, FrameAllocator>& lightData) const;
+        void QueryPointLights(FrameData& frameData, DynamicArray<PointLightData, FrameAllocator>& lightData) const;
 
         bool RayCast(const Ray& ray, RayCastResult& result);
 
+        /** @brief Fills objectIds with the ids of all meshes and terrains whose world bounds intersect with the provided sphere. */
+        void QueryObjects(const Sphere& sphere, DynamicArray<u32>& objectIds) const;
+
         Handle<Transform> GetTransformById(u32 id);
 
         [[nodiscard]] u32 GetId() const { return m_id; }
@@ -188,6 +203,11 @@ namespace C3D
         bool AddTerrain(const SceneTerrainConfig& config);
         bool RemoveTerrain(const String& name);
 
+        /** @brief Inserts, updates or removes the objects in our BVH based on the state of their resources and transforms. */
+        void UpdateBVH();
+        /** @brief Calculates the world-space bounds of the provided object. Returns false if the object has no bounds (yet). */
+        bool GetWorldExtents(const SceneObject& object, Extents3D& outExtents) const;
+
         /** @brief Unloads the scene. Deallocates the resources for the scene.
          * After calling this method the scene is in an unloaded state ready to be destroyed.*/
         void UnloadInternal();
@@ -203,6 +223,8 @@ namespace C3D
         HierarchyGraph m_graph;
 
         DynamicArray<SceneObject> m_objects;
+        /** @brief A BVH containing the world bounds of all our meshes and terrains. The user data is the index into m_objects. */
+        BVH m_bvh;
 
         DynamicArray<Skybox> m_skyboxes;
         DynamicArray<DirectionalLight> m_directionalLights;
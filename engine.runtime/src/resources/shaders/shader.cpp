@@ -3,7 +3,7 @@
 
 namespace C3D
 {
-    u16 Shader::GetUniformIndex(const String& uniformName) const
+    u16 Shader::GetUniformIndex(const Name uniformName) const
     {
         if (id == INVALID_ID)
         {
@@ -11,12 +11,13 @@ namespace C3D
             return INVALID_ID_U16;
         }
 
-        if (!uniformNameToIndexMap.Has(uniformName))
+        const auto index = uniformNameToIndexMap.Find(uniformName);
+        if (!index)
         {
             INFO_LOG("No uniform named: '{}' is registered in this shader ('{}').", uniformName, name);
             return INVALID_ID_U16;
         }
 
-        return static_cast<u16>(uniformNameToIndexMap.Get(uniformName));
+        return static_cast<u16>(*index);
     }
 }  // namespace C3D
\ No newline at end of file
@@ -1,10 +1,11 @@
 
 #pragma once
 #include "containers/dynamic_array.h"
-#include "containers/hash_map.h"
+#include "containers/flat_hash_map.h"
 #include "containers/hash_table.h"
 #include "platform/platform_types.h"
 #include "shader_types.h"
+#include "string/name.h"
 #include "string/string.h"
 
 namespace C3D
@@ -15,7 +16,7 @@ namespace C3D
     class C3D_API Shader
     {
     public:
-        u16 GetUniformIndex(const String& uniformName) const;
+        u16 GetUniformIndex(Name uniformName) const;
 
         /** @brief The id for this shader. */
         u32 id = INVALID_ID;
@@ -62,7 +63,7 @@ namespace C3D
         /** @brief The currently bound instance's UBO offset. */
         u32 boundUboOffset = 0;
         /** @brief A HashMap that maps the name of a uniform to it's index in the uniform array. */
-        HashMap<String, u64> uniformNameToIndexMap;
+        FlatHashMap<Name, u64> uniformNameToIndexMap;
         /** @brief An array of our Shader's actual uniforms. */
         DynamicArray<ShaderUniform> uniforms;
 
@@ -148,6 +148,8 @@ namespace C3D
         ShaderFlagStencilTest  = 0x04,
         ShaderFlagStencilWrite = 0x08,
         ShaderFlagWireframe    = 0x10,
+        /** @brief The model matrix is read per instance (as a mat4 at the locations directly after the vertex attributes). */
+        ShaderFlagInstancing   = 0x20,
     };
     typedef u32 ShaderFlagBits;
 
@@ -49,11 +49,11 @@ namespace C3D
 
         // Get our builtin skybox shader
         // TODO: Allow configurable shader here
-        const auto shader   = Shaders.Get("Shader.Builtin.Skybox");
+        const auto shader   = Shaders.Get("Shader.Builtin.Skybox"_name);
         TextureMap* maps[1] = { &cubeMap };
 
         ShaderInstanceUniformTextureConfig textureConfig;
-        textureConfig.uniformLocation = shader->GetUniformIndex("cubeTexture");
+        textureConfig.uniformLocation = shader->GetUniformIndex("cubeTexture"_name);
         textureConfig.textureMaps     = maps;
 
         ShaderInstanceResourceConfig instanceConfig;
@@ -73,7 +73,7 @@ namespace C3D
     bool Skybox::Unload()
     {
         // TODO: Allow configurable shader here
-        const auto shader = Shaders.Get("Shader.Builtin.Skybox");
+        const auto shader = Shaders.Get("Shader.Builtin.Skybox"_name);
 
         Renderer.ReleaseShaderInstanceResources(*shader, instanceId);
         instanceId = INVALID_ID;
@@ -1,9 +1,8 @@
 
 #include "loading_texture.h"
 
-#include <future>
-
 #include "renderer/renderer_frontend.h"
+#include "systems/jobs/job_system.h"
 #include "systems/resources/resource_system.h"
 #include "systems/system_manager.h"
 #include "time/scoped_timer.h"
@@ -117,16 +116,19 @@ namespace C3D
         u32 layerCount       = m_names.Size();
 
         // Load the resources in parallel
-        std::future<AsyncResult> results[12];
+        DynamicArray<AsyncResult> results;
+        results.Resize(layerCount);
 
-        for (u32 i = 0; i < layerCount; ++i)
-        {
-            results[i] = std::async(LoadLayeredTextureLayer, m_names[i].Data());
-        }
+        Jobs.ParallelFor(layerCount, 1, [this, &results](const u64 begin, const u64 end, LinearAllocator&) {
+            for (u64 i = begin; i < end; ++i)
+            {
+                results[i] = LoadLayeredTextureLayer(m_names[i].Data());
+            }
+        });
 
         for (u32 layer = 0; layer < layerCount; ++layer)
         {
-            auto result = results[layer].get();
+            auto& result = results[layer];
             if (!result.success)
             {
                 // Returning false here will cause Cleanup() to be called by the JobSystem
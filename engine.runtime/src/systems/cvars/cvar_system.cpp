@@ -42,11 +42,12 @@ namespace C3D
 
     CVar& CVarSystem::Get(const CVarName& name)
     {
-        if (!Exists(name))
+        const auto cVar = m_cVars.Find(name);
+        if (!cVar)
         {
             FATAL_LOG("Failed to find a CVar with the name: '{}'.", name);
         }
-        return m_cVars.Get(name);
+        return *cVar;
     }
 
     void CVarSystem::OnShutdown()
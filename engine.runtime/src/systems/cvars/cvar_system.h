@@ -2,7 +2,7 @@
 #pragma once
 #include "console/console.h"
 #include "containers/dynamic_array.h"
-#include "containers/hash_map.h"
+#include "containers/flat_hash_map.h"
 #include "cvars/cvar.h"
 #include "string/string.h"
 #include "systems/system.h"
@@ -77,6 +77,6 @@ namespace C3D
     private:
         bool OnCVarCommand(const DynamicArray<ArgName>& args, String& output);
 
-        HashMap<CVarName, CVar> m_cVars;
+        FlatHashMap<CVarName, CVar> m_cVars;
     };
 }  // namespace C3D
\ No newline at end of file
@@ -52,6 +52,11 @@ namespace C3D
             config.materialName.Destroy();
             config.vertices.Destroy();
             config.indices.Destroy();
+
+            config.externalVertices    = nullptr;
+            config.externalVertexCount = 0;
+            config.externalIndices     = nullptr;
+            config.externalIndexCount  = 0;
         }
 
         void Release(const Geometry* geometry) const;
@@ -121,8 +126,8 @@ namespace C3D
         }
 
         // Send the geometry off to the renderer to be uploaded to the gpu
-        if (!Renderer.CreateGeometry(*g, sizeof(VertexType), config.vertices.Size(), config.vertices.GetData(), sizeof(IndexType),
-                                     config.indices.Size(), config.indices.GetData()))
+        if (!Renderer.CreateGeometry(*g, sizeof(VertexType), config.GetVertexCount(), config.GetVertices(), sizeof(IndexType),
+                                     config.GetIndexCount(), config.GetIndices()))
         {
             ERROR_LOG("Creating geometry failed during the Renderer's CreateGeometry.");
             m_registeredGeometries[g->id].referenceCount = 0;
@@ -1,14 +1,65 @@
-
 #include "job_system.h"
 
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <thread>
+
 #include "cson/cson_types.h"
 #include "formatters.h"
 #include "frame_data.h"
 #include "platform/platform.h"
+#include "profiler/profiler.h"
 #include "renderer/renderer_frontend.h"
 
 namespace C3D
 {
+    /** @brief The index of the job thread that is running on the current thread. INVALID_ID_U8 for non-job threads. */
+    static thread_local u8 t_jobThreadIndex = INVALID_ID_U8;
+    /** @brief The scratch allocator of the current thread. Only set for job threads and the main thread. */
+    static thread_local LinearAllocator* t_scratchAllocator = nullptr;
+    /** @brief The number of (nested) jobs the current thread is executing. Scratch memory is reset when this drops back to 0. */
+    static thread_local u32 t_jobDepth = 0;
+
+    struct ParallelForState
+    {
+        const ParallelForFunction* func = nullptr;
+        u64 count                       = 0;
+        u64 grainSize                   = 0;
+        u64 chunkCount                  = 0;
+        /** @brief The next chunk that needs to be executed. Threads keep taking chunks until there are none left. */
+        std::atomic<u64> nextChunk = 0;
+    };
+
+    static void BeginScratchScope() { t_jobDepth++; }
+
+    static void EndScratchScope()
+    {
+        t_jobDepth--;
+        if (t_jobDepth == 0 && t_scratchAllocator && t_scratchAllocator->GetAllocated() > 0)
+        {
+            t_scratchAllocator->FreeAll();
+        }
+    }
+
+    static void RunParallelForChunks(ParallelForState& state)
+    {
+        BeginScratchScope();
+
+        u64 chunk;
+        while ((chunk = state.nextChunk++) < state.chunkCount)
+        {
+            const auto begin = chunk * state.grainSize;
+            const auto end   = std::min(begin + state.grainSize, state.count);
+            (*state.func)(begin, end, *t_scratchAllocator);
+        }
+
+        EndScratchScope();
+    }
+
+    /** @brief Converts a job type (which is a single bit) into an index. */
+    static u32 JobTypeIndex(const JobType type) { return std::countr_zero(static_cast<u32>(type)) - 1; }
+
     bool JobSystem::OnInit(const CSONObject& config)
     {
         INFO_LOG("Initializing.");
@@ -20,6 +71,10 @@ namespace C3D
             {
                 m_config.threadCount = prop.GetI64();
             }
+            else if (prop.name.IEquals("scratchSize"))
+            {
+                m_config.scratchSize = prop.GetI64();
+            }
         }
 
         if (m_config.threadCount == 0)
@@ -37,15 +92,19 @@ namespace C3D
         m_threadCount = m_config.threadCount;
 
         m_pendingResults.Reserve(100);
+        m_processingResults.Reserve(100);
 
         INFO_LOG("Main thread id is: {}.", Platform::GetThreadId());
         INFO_LOG("Spawning {} job threads.", m_threadCount);
 
         // Prepare the job thread types
-        u32 jobThreadTypes[15];
+        u32 jobThreadTypes[MAX_JOB_THREADS];
         for (u32& jobThreadType : jobThreadTypes) jobThreadType = JobTypeGeneral;
 
-        if (m_config.threadCount == 1 || !Renderer.IsMultiThreaded())
+        // NOTE: The RenderSystem is not available when the JobSystem is used without a renderer (in the tests for example)
+        const auto multiThreadedRenderer = SystemManager::GetSystem(RenderSystemType) && Renderer.IsMultiThreaded();
+
+        if (m_config.threadCount == 1 || !multiThreadedRenderer)
         {
             jobThreadTypes[0] |= (JobTypeGpuResource | JobTypeResourceLoad);
         }
@@ -60,16 +119,26 @@ namespace C3D
             jobThreadTypes[1] = JobTypeResourceLoad;
         }
 
+        // Allocate a slot for every job that can be in flight
+        m_jobSlots = Memory.NewArray<JobSlot>(MemoryType::Job, MAX_ACTIVE_JOBS);
+
         // Set the system to running
         m_running = true;
 
+        // Create the queues for all threads before any thread starts running since threads can steal from each other
+        for (u8 i = 0; i < m_threadCount; i++)
+        {
+            m_jobThreads[i].Create(i, jobThreadTypes[i], m_config.scratchSize);
+        }
+
+        // The main thread also executes jobs (when waiting or during a ParallelFor) so it also needs a scratch allocator
+        m_mainThreadScratchAllocator.Create("MAIN_THREAD_JOB_SCRATCH_ALLOCATOR", m_config.scratchSize);
+        t_scratchAllocator = &m_mainThreadScratchAllocator;
+
         // Spawn and start running all threads
         for (u8 i = 0; i < m_threadCount; i++)
         {
-            m_jobThreads[i].index    = i;
-            m_jobThreads[i].typeMask = jobThreadTypes[i];
-            m_jobThreads[i].thread   = std::thread([this, i] { Runner(i); });
-            m_jobThreads[i].ClearInfo();
+            m_jobThreads[i].thread = std::thread([this, i] { Runner(i); });
         }
 
         return true;
@@ -79,225 +148,435 @@ namespace C3D
     {
         INFO_LOG("Joining all job threads.");
 
-        m_running = false;
+        {
+            // Take the lock to ensure no thread misses the fact that we stopped running
+            std::lock_guard wakeLock(m_wakeMutex);
+            m_running = false;
+        }
+        m_wakeCondition.notify_all();
 
         for (auto& jobThread : m_jobThreads)
         {
             if (jobThread.thread.joinable()) jobThread.thread.join();
         }
 
-        // Destroy our queues
-        m_lowPriorityQueue.Clear();
-        m_normalPriorityQueue.Clear();
-        m_highPriorityQueue.Clear();
+        // Destroy our queues (and all the jobs that never got to run)
+        for (u8 i = 0; i < m_threadCount; i++)
+        {
+            m_jobThreads[i].Destroy();
+        }
+
+        for (auto& queued : m_queuedJobs)
+        {
+            queued = 0;
+        }
+
+        if (t_scratchAllocator == &m_mainThreadScratchAllocator)
+        {
+            t_scratchAllocator = nullptr;
+        }
+
+        if (m_mainThreadScratchAllocator.GetMemory())
+        {
+            m_mainThreadScratchAllocator.Destroy();
+        }
+
+        if (m_jobSlots)
+        {
+            Memory.DeleteArray(m_jobSlots, MAX_ACTIVE_JOBS);
+            m_jobSlots = nullptr;
+        }
+
+        m_pendingResults.Destroy();
+        m_processingResults.Destroy();
     }
 
     bool JobSystem::OnUpdate(const FrameData& frameData)
     {
-        // Process all our queues
-        ProcessQueue(m_highPriorityQueue, m_highPriorityMutex);
-        ProcessQueue(m_normalPriorityQueue, m_normalPriorityMutex);
-        ProcessQueue(m_lowPriorityQueue, m_lowPriorityMutex);
-
-        // Process all pending results
-        for (i64 i = m_pendingResults.SSize() - 1; i >= 0; --i)
         {
-            JobResultEntry entry;
-            {
-                // Lock our result so we can take a copy of our pointer and remove it from our array
-                std::lock_guard resultLock(m_resultMutex);
-                entry = m_pendingResults[i];
-            }
+            // Take all the pending results so job threads can keep adding results while we execute the callbacks
+            std::lock_guard resultLock(m_resultMutex);
+            std::swap(m_pendingResults, m_processingResults);
+        }
 
-            // Execute our callback
+        // Execute our callbacks (on the main thread)
+        for (const auto& entry : m_processingResults)
+        {
             entry.callback();
-
-            {
-                // Lock our results array again so we can clear this pending result
-                std::lock_guard resultLock(m_resultMutex);
-                m_pendingResults.Erase(i);
-            }
         }
 
+        m_processingResults.Clear();
         return true;
     }
 
     JobHandle JobSystem::Submit(const StackFunction<bool(), 24>& entry, const StackFunction<void(), 24>& onSuccess,
-                                const StackFunction<void(), 24>& onFailure, JobType type, JobPriority priority, u8* dependencies,
-                                u8 numberOfDependencies)
+                                const StackFunction<void(), 24>& onFailure, JobType type, JobPriority priority,
+                                const JobHandle* dependencies, u8 numberOfDependencies, const char* name)
     {
+        if (priority == JobPriority::None)
+        {
+            ERROR_LOG("Failed to submit job since it has priority type NONE.");
+            return INVALID_ID_U16;
+        }
+
+        if (numberOfDependencies > MAX_JOB_DEPENDENCIES)
+        {
+            ERROR_LOG("Failed to submit job since it has: {} dependencies while the max is: {}.", numberOfDependencies,
+                      MAX_JOB_DEPENDENCIES);
+            return INVALID_ID_U16;
+        }
+
+        bool hasThreadForType = false;
+        for (u32 i = 0; i < m_threadCount; ++i)
+        {
+            if (m_jobThreads[i].typeMask & type)
+            {
+                hasThreadForType = true;
+                break;
+            }
+        }
+
+        if (!hasThreadForType)
+        {
+            ERROR_LOG("Failed to submit job since there is no thread that can execute jobs of type: '{}'.", ToUnderlying(type));
+            return INVALID_ID_U16;
+        }
+
         JobInfo info;
         // Copy over the type
         info.type = type;
         // Copy over the priority
         info.priority = priority;
+        // Copy over the name
+        info.name = name;
         // Copy over the entry, onSuccess and onFailure functions
         info.entryPoint = entry;
         info.onSuccess  = onSuccess;
         info.onFailure  = onFailure;
         // Copy over the number of dependencies
         info.numberOfDependencies = numberOfDependencies;
-        // copy over the dependencies
-        std::memcpy(info.dependencies, dependencies, numberOfDependencies);
-
-        // Linearly keep track of the next handle we will hand out
-        static u16 nextHandle = 0;
-        // Keep track off and increment the handle
-        u16 handle = nextHandle++;
-        // Store the handle on the JobInfo
-        info.handle = nextHandle++;
+        // Copy over the dependencies
+        if (numberOfDependencies > 0)
+        {
+            std::memcpy(info.dependencies, dependencies, sizeof(JobHandle) * numberOfDependencies);
+        }
+        // Get a handle for this job and store it on the JobInfo
+        const auto handle = NextHandle();
+        info.handle       = handle;
 
-        // If the job priority is high (and has no dependencies), we try to start it immediately
-        if (info.priority == JobPriority::High && info.numberOfDependencies == 0)
+        auto& slot = GetSlot(handle);
+        while (true)
         {
-            for (auto& thread : m_jobThreads)
             {
-                if (thread.typeMask & info.type)
+                std::lock_guard slotLock(slot.mutex);
+                if (slot.finished)
                 {
-                    std::lock_guard threadLock(thread.mutex);
-                    if (thread.IsFree())
-                    {
-                        TRACE("Job: '{}' immediately submitted on thread '{}' since it has HIGH priority.", handle, thread.index);
-                        thread.SetInfo(std::move(info));
-                        return handle;
-                    }
+                    // The previous job in this slot has finished so we can take it over
+                    slot.handle   = handle;
+                    slot.finished = false;
+                    slot.info     = info;
+                    slot.continuations.Clear();
+                    // We add one extra dependency so our job can't be queued while we are still adding the real dependencies
+                    slot.remainingDependencies = 1;
+                    break;
                 }
             }
+
+            // There are too many jobs in flight so we help out until our slot frees up
+            RunPendingJob();
         }
 
-        // We need to lock our queue in case the job is submitted from another job/thread
-        switch (info.priority)
+        for (u8 i = 0; i < numberOfDependencies; ++i)
         {
-            case JobPriority::High:
-            {
-                std::lock_guard queueLock(m_highPriorityMutex);
-                m_highPriorityQueue.Enqueue(info);
-                break;
-            }
-            case JobPriority::Normal:
-            {
-                std::lock_guard queueLock(m_normalPriorityMutex);
-                m_normalPriorityQueue.Enqueue(info);
-                break;
-            }
-            case JobPriority::Low:
+            const auto dependency = info.dependencies[i];
+            if (dependency == INVALID_ID_U16 || dependency == handle) continue;
+
+            auto& dependencySlot = GetSlot(dependency);
+
+            std::lock_guard dependencyLock(dependencySlot.mutex);
+            if (dependencySlot.handle == dependency && !dependencySlot.finished)
             {
-                std::lock_guard queueLock(m_lowPriorityMutex);
-                m_lowPriorityQueue.Enqueue(info);
-                break;
+                // The dependency is still running so we let it queue our job once it finishes
+                slot.remainingDependencies++;
+                dependencySlot.continuations.PushBack(handle);
             }
-            default:
-            case JobPriority::None:
-                ERROR_LOG("Failed to submit job since it has priority type NONE.");
-                break;
         }
 
-        TRACE("Job: '{}' has been queued.", handle);
+        // Remove our extra dependency. If all our dependencies have already finished we can queue the job ourselves
+        if (--slot.remainingDependencies == 0)
+        {
+            Enqueue(slot.info);
+        }
+
         return handle;
     }
 
+    JobHandle JobSystem::Continue(JobHandle parent, const StackFunction<bool(), 24>& entry, const StackFunction<void(), 24>& onSuccess,
+                                  const StackFunction<void(), 24>& onFailure, JobType type, JobPriority priority, const char* name)
+    {
+        return Submit(entry, onSuccess, onFailure, type, priority, &parent, 1, name);
+    }
+
+    void JobSystem::Wait(const JobHandle handle)
+    {
+        while (!IsFinished(handle))
+        {
+            RunPendingJob();
+        }
+    }
+
+    void JobSystem::WaitAll(const std::span<const JobHandle> handles)
+    {
+        for (const auto handle : handles)
+        {
+            Wait(handle);
+        }
+    }
+
+    void JobSystem::ParallelFor(const u64 count, const u64 grainSize, const ParallelForFunction& func, const char* name)
+    {
+        if (count == 0) return;
+
+        ParallelForState state;
+        state.func       = &func;
+        state.count      = count;
+        state.grainSize  = std::max<u64>(grainSize, 1);
+        state.chunkCount = (count + state.grainSize - 1) / state.grainSize;
+
+        // The calling thread also executes chunks (if it has a scratch allocator) so we need one less job
+        const auto callerHelps = t_scratchAllocator != nullptr;
+        const auto jobCount    = std::min<u64>(state.chunkCount - (callerHelps ? 1 : 0), m_threadCount);
+
+        // Every job keeps taking chunks until there are none left so we never need more jobs than threads
+        JobHandle handles[MAX_JOB_THREADS];
+        for (u64 i = 0; i < jobCount; ++i)
+        {
+            handles[i] = Submit(
+                [&state] {
+                    RunParallelForChunks(state);
+                    return true;
+                },
+                {}, {}, JobTypeGeneral, JobPriority::High, nullptr, 0, name);
+        }
+
+        if (callerHelps)
+        {
+            RunParallelForChunks(state);
+        }
+
+        WaitAll(std::span(handles, jobCount));
+    }
+
+    LinearAllocator* JobSystem::GetScratchAllocator() const
+    {
+        // Scratch memory is reset once the outermost job finishes so outside of a job there is nothing that would ever reset it
+        // (and memory that was handed out on the main thread would be freed under it's user as soon as it helps with a job)
+        return t_jobDepth > 0 ? t_scratchAllocator : nullptr;
+    }
+
+    bool JobSystem::IsFinished(const JobHandle handle) const
+    {
+        if (handle == INVALID_ID_U16) return true;
+
+        // If the slot is used by a different job our job must have finished before that job was submitted
+        const auto& slot = GetSlot(handle);
+        return slot.handle != handle || slot.finished;
+    }
+
     void JobSystem::Runner(const u32 index)
     {
         auto& currentThread = m_jobThreads[index];
         auto threadId       = currentThread.thread.get_id();
 
+        t_jobThreadIndex   = static_cast<u8>(index);
+        t_scratchAllocator = &currentThread.scratchAllocator;
+
         TRACE("Starting job thread #{} (id={}, type={}).", index, threadId, currentThread.typeMask);
 
+        C3D_PROFILE_THREAD(String::FromFormat("Job Thread {}", index).Data());
+
         // Keep running, waiting for jobs
-        while (true)
+        while (m_running)
         {
-            if (!m_running) break;
-
-            // Grab a copy of our info
             JobInfo info;
+            if (TryGetJob(currentThread.typeMask, info))
             {
-                std::lock_guard threadLock(currentThread.mutex);
-                info = currentThread.GetInfo();
+                TRACE("Executing job on thread #{}.", index);
+                Execute(info);
+                continue;
             }
 
-            if (info.inUse)
-            {
-                // Call our entry point and do the work and store the result of the work
-                // if the user has provided a onSuccess callback (in the case of success)
-                // or if the user has provided a onFailure callback (in the case of a failure)
-                TRACE("Executing job on thread #{}.", index);
+            // There is no work for us so we sleep until new jobs are submitted (or the system is shutting down)
+            std::unique_lock wakeLock(m_wakeMutex);
+            m_sleepingThreads++;
+            m_wakeCondition.wait(wakeLock, [this, &currentThread] { return !m_running || HasQueuedJobs(currentThread.typeMask); });
+            m_sleepingThreads--;
+        }
 
-                static u16 resultId = 0;
+        t_jobThreadIndex   = INVALID_ID_U8;
+        t_scratchAllocator = nullptr;
 
-                if (info.entryPoint())
-                {
-                    if (info.onSuccess)
-                    {
-                        std::lock_guard resultLock(m_resultMutex);
-                        m_pendingResults.EmplaceBack(resultId++, info.onSuccess);
-                    }
-                }
-                else
-                {
-                    if (info.onFailure)
-                    {
-                        std::lock_guard resultLock(m_resultMutex);
-                        m_pendingResults.EmplaceBack(resultId++, info.onFailure);
-                    }
-                }
+        TRACE("Stopping job thread #{} (id={}, type={}).", index, threadId, currentThread.typeMask);
+    }
 
-                // Clear out our current thread's info
-                {
-                    std::lock_guard threadLock(currentThread.mutex);
-                    currentThread.ClearInfo();
-                }
+    bool JobSystem::TryGetJob(const u32 typeMask, JobInfo& outInfo)
+    {
+        const auto index = t_jobThreadIndex;
+        // Job threads start stealing from their neighbour (so not every thread hits the same victim), other threads start at the first
+        const u32 start = index == INVALID_ID_U8 ? 0 : index + 1;
+
+        for (const auto priority : { JobPriority::High, JobPriority::Normal, JobPriority::Low })
+        {
+            // First we try our own queue
+            auto found = index != INVALID_ID_U8 && m_jobThreads[index].GetQueue(priority).Pop(typeMask, outInfo);
+
+            // Then we try to steal from the other threads
+            for (u32 i = 0; !found && i < m_threadCount; ++i)
+            {
+                const auto victim = (start + i) % m_threadCount;
+                if (victim == index) continue;
+
+                found = m_jobThreads[victim].GetQueue(priority).Steal(typeMask, outInfo);
             }
 
-            if (m_running)
+            if (found)
             {
-                // TODO: This needs to be improved. Maybe sleeping until a request comes through for a new job?
-                Platform::SleepMs(10);
+                m_queuedJobs[JobTypeIndex(outInfo.type)]--;
+                return true;
             }
         }
 
-        TRACE("Stopping job thread #{} (id={}, type={}).", index, threadId, currentThread.typeMask);
+        return false;
+    }
+
+    void JobSystem::Execute(const JobInfo& info)
+    {
+        C3D_PROFILE_SCOPE(info.name);
+
+        BeginScratchScope();
+
+        // Call our entry point and do the work and store the result of the work
+        // if the user has provided a onSuccess callback (in the case of success)
+        // or if the user has provided a onFailure callback (in the case of a failure)
+        const auto success = info.entryPoint();
+
+        EndScratchScope();
+
+        if (success)
+        {
+            if (info.onSuccess)
+            {
+                std::lock_guard resultLock(m_resultMutex);
+                m_pendingResults.EmplaceBack(info.handle, info.onSuccess);
+            }
+        }
+        else
+        {
+            if (info.onFailure)
+            {
+                std::lock_guard resultLock(m_resultMutex);
+                m_pendingResults.EmplaceBack(info.handle, info.onFailure);
+            }
+        }
+
+        auto& slot = GetSlot(info.handle);
+
+        std::lock_guard slotLock(slot.mutex);
+        slot.finished = true;
+
+        // Queue all the jobs for which we were the last dependency
+        for (const auto continuation : slot.continuations)
+        {
+            auto& continuationSlot = GetSlot(continuation);
+            if (--continuationSlot.remainingDependencies == 0)
+            {
+                Enqueue(continuationSlot.info);
+            }
+        }
+        slot.continuations.Clear();
     }
 
-    void JobSystem::ProcessQueue(RingQueue<JobInfo, 128>& queue, std::mutex& queueMutex)
+    void JobSystem::RunPendingJob()
     {
-        while (!queue.Empty())
+        // Job threads can help with all the jobs they can normally execute.
+        // The main thread only helps with general jobs since the other types are bound to specific job threads.
+        // Other threads don't help since they have no scratch allocator that jobs can use.
+        const auto typeMask = t_jobThreadIndex == INVALID_ID_U8 ? JobTypeGeneral : m_jobThreads[t_jobThreadIndex].typeMask;
+
+        JobInfo info;
+        if (t_scratchAllocator && TryGetJob(typeMask, info))
+        {
+            Execute(info);
+        }
+        else
         {
-            const auto jobInfo = queue.Peek();
+            std::this_thread::yield();
+        }
+    }
 
-            // Find a thread that matches the type of job and that is not currently doing any work.
-            bool threadFound = false;
-            for (auto& thread : m_jobThreads)
+    void JobSystem::Enqueue(const JobInfo& info)
+    {
+        // If we are submitting from a job thread that can execute this job we put it in our own queue (since it's data is likely hot).
+        // Otherwise we distribute the jobs over all threads that can execute it. Idle threads will steal from busy threads.
+        JobThread* target = nullptr;
+        if (t_jobThreadIndex != INVALID_ID_U8 && (m_jobThreads[t_jobThreadIndex].typeMask & info.type))
+        {
+            target = &m_jobThreads[t_jobThreadIndex];
+        }
+        else
+        {
+            const auto start = m_nextThreadIndex.fetch_add(1, std::memory_order_relaxed);
+            for (u32 i = 0; i < m_threadCount; ++i)
             {
-                // Skip threads that don't match the type of job
-                if ((thread.typeMask & jobInfo.type) == 0) continue;
+                auto& thread = m_jobThreads[(start + i) % m_threadCount];
+                if (thread.typeMask & info.type)
                 {
-                    // Lock our thread so we can access it
-                    std::lock_guard threadLock(thread.mutex);
-
-                    // If the thread is free (not doing any work) we queue this job
-                    if (thread.IsFree())
-                    {
-                        JobInfo nextJobInfo;
-                        // Lock the queue
-                        {
-                            std::lock_guard queueLock(queueMutex);
-                            nextJobInfo = queue.Dequeue();
-                        }
-
-                        thread.SetInfo(std::move(nextJobInfo));
-                        TRACE("Assigning job to thread: #{}.", thread.index);
-
-                        threadFound = true;
-                    }
+                    target = &thread;
+                    break;
                 }
-
-                // If we have queued the job we can break out of loop
-                if (threadFound) break;
             }
+        }
+
+        TRACE("Job: '{}' is being queued on thread: #{}.", info.handle, target->index);
+
+        // NOTE: We increment our queued jobs before pushing so the count can never drop below the actual amount of queued jobs
+        m_queuedJobs[JobTypeIndex(info.type)]++;
+        target->GetQueue(info.priority).Push(info);
 
-            // This means all the thread are currently busy handling jobs.
-            // So wait until the next update and try again.
-            if (!threadFound) break;
+        WakeThreads();
+    }
+
+    JobHandle JobSystem::NextHandle()
+    {
+        JobHandle handle;
+        do
+        {
+            handle = m_nextHandle++;
+        } while (handle == INVALID_ID_U16);
+        return handle;
+    }
+
+    bool JobSystem::HasQueuedJobs(const u32 typeMask) const
+    {
+        for (u32 i = 0; i < JOB_TYPE_COUNT; ++i)
+        {
+            const auto type = JobTypeGeneral << i;
+            if ((typeMask & type) && m_queuedJobs[i] > 0) return true;
+        }
+        return false;
+    }
+
+    void JobSystem::WakeThreads()
+    {
+        // No need to take the lock if every thread is busy. Busy threads will check the queues before going to sleep.
+        if (m_sleepingThreads == 0) return;
+
+        {
+            // Take the lock so a thread that is just about to go to sleep can't miss this wake up
+            std::lock_guard wakeLock(m_wakeMutex);
         }
+        // We don't know which threads can execute the submitted job so we wake all of them.
+        // Threads that can't execute the job will go back to sleep immediately.
+        m_wakeCondition.notify_all();
     }
 }  // namespace C3D
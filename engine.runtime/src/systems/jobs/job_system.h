@@ -1,9 +1,12 @@
-
 #pragma once
+#include <atomic>
+#include <condition_variable>
+#include <span>
+
 #include "containers/dynamic_array.h"
-#include "containers/ring_queue.h"
 #include "defines.h"
 #include "jobs/job.h"
+#include "memory/allocators/linear_allocator.h"
 #include "systems/system.h"
 
 namespace C3D
@@ -13,6 +16,8 @@ namespace C3D
     constexpr auto MAX_JOB_THREADS = 32;
     /** @brief The maximum amount of job results that can be stored at once (per frame). */
     constexpr auto MAX_JOB_RESULTS = 512;
+    /** @brief The default size of the scratch allocator that every job thread (and the main thread) gets. */
+    constexpr auto DEFAULT_JOB_SCRATCH_SIZE = KibiBytes(256);
 
     struct JobSystemConfig
     {
@@ -20,9 +25,15 @@ namespace C3D
         u8 threadCount;
         /** @brief A collection of type masks for each job thread. The amount of elements must match maxJobThreads. */
         u32* typeMasks;
+        /** @brief The size (in bytes) of the scratch allocator of every job thread (and the main thread). */
+        u64 scratchSize = DEFAULT_JOB_SCRATCH_SIZE;
     };
 
-    class JobSystem final : public SystemWithConfig<JobSystemConfig>
+    /** @brief Function that is called for every chunk of a ParallelFor with the [begin, end) range of the chunk
+     * and the scratch allocator of the thread that executes the chunk. */
+    using ParallelForFunction = StackFunction<void(u64, u64, LinearAllocator&), 24>;
+
+    class C3D_API JobSystem final : public SystemWithConfig<JobSystemConfig>
     {
     public:
         bool OnInit(const CSONObject& config) override;
@@ -30,33 +41,123 @@ namespace C3D
 
         bool OnUpdate(const FrameData& frameData) override;
 
-        C3D_API JobHandle Submit(const StackFunction<bool(), 24>& entry, const StackFunction<void(), 24>& onSuccess,
-                                 const StackFunction<void(), 24>& onFailure, JobType type = JobTypeGeneral,
-                                 JobPriority priority = JobPriority::Normal, u8* dependencies = nullptr, u8 numberOfDependencies = 0);
+        /**
+         * @brief Submits a job to the job system.
+         *
+         * @param entry The entry point of the job. Should return true on success and false on failure
+         * @param onSuccess Optional callback that is called on the main thread (during OnUpdate) when the job succeeded
+         * @param onFailure Optional callback that is called on the main thread (during OnUpdate) when the job failed
+         * @param type The type of the job. Only threads that can handle this type will execute it
+         * @param priority The priority of the job
+         * @param dependencies Handles of jobs that need to finish before this job is allowed to start
+         * @param numberOfDependencies The number of handles in dependencies (at most MAX_JOB_DEPENDENCIES)
+         * @param name The name that is used when profiling the job. Defaults to the name of the function that submits the job
+         * @return The handle of the submitted job. INVALID_ID_U16 if the job could not be submitted
+         */
+        JobHandle Submit(const StackFunction<bool(), 24>& entry, const StackFunction<void(), 24>& onSuccess,
+                         const StackFunction<void(), 24>& onFailure, JobType type = JobTypeGeneral,
+                         JobPriority priority = JobPriority::Normal, const JobHandle* dependencies = nullptr, u8 numberOfDependencies = 0,
+                         const char* name = __builtin_FUNCTION());
+
+        /** @brief Submits a job that starts as soon as the job with the provided handle has finished. */
+        JobHandle Continue(JobHandle parent, const StackFunction<bool(), 24>& entry, const StackFunction<void(), 24>& onSuccess,
+                           const StackFunction<void(), 24>& onFailure, JobType type = JobTypeGeneral,
+                           JobPriority priority = JobPriority::Normal, const char* name = __builtin_FUNCTION());
+
+        /**
+         * @brief Waits until the job with the provided handle has finished.
+         * Instead of blocking, the calling thread executes other pending jobs while it waits.
+         * Job threads help with jobs matching their type, the main thread only helps with general jobs and other threads simply yield.
+         * NOTE: The onSuccess and onFailure callbacks are still called during OnUpdate.
+         */
+        void Wait(JobHandle handle);
+        /** @brief Waits until all jobs with the provided handles have finished. See Wait() for more details. */
+        void WaitAll(std::span<const JobHandle> handles);
+
+        /**
+         * @brief Splits the range [0, count) into chunks of grainSize elements and executes the provided function for every chunk.
+         * The chunks are executed by the job threads and the calling thread. This method returns once all chunks have been executed.
+         *
+         * @param count The number of elements in the range
+         * @param grainSize The (maximum) number of elements per chunk
+         * @param func The function that is called for every chunk
+         * @param name The name that is used when profiling the jobs. Defaults to the name of the calling function
+         */
+        void ParallelFor(u64 count, u64 grainSize, const ParallelForFunction& func, const char* name = __builtin_FUNCTION());
+
+        /**
+         * @brief Gets the scratch allocator of the calling thread. Only job threads and the main thread have a scratch allocator and it
+         * can only be used from inside a job (or ParallelFor). The memory is reset once the thread finishes the outermost job (or
+         * ParallelFor) that it is executing.
+         *
+         * @return A pointer to the scratch allocator of the calling thread or nullptr if the calling thread has no scratch allocator or
+         * is not executing a job
+         */
+        [[nodiscard]] LinearAllocator* GetScratchAllocator() const;
+
+        /** @brief Checks if the job with the provided handle has finished (or is no longer known to the system). */
+        [[nodiscard]] bool IsFinished(JobHandle handle) const;
+
+        /** @brief Gets the amount of job threads that are currently running. */
+        [[nodiscard]] u8 GetThreadCount() const { return m_threadCount; }
 
     private:
         void Runner(u32 index);
 
-        void ProcessQueue(RingQueue<JobInfo, 128>& queue, std::mutex& queueMutex);
+        /** @brief Tries to get a job for the calling thread that matches the provided type mask. Job threads first try their own queues.
+         * Afterwards jobs are stolen from other threads. Higher priority jobs are always taken before lower priority ones. */
+        bool TryGetJob(u32 typeMask, JobInfo& outInfo);
 
-        bool m_running   = false;
-        u8 m_threadCount = 0;
+        /** @brief Executes the provided job, stores the onSuccess or onFailure callback so it can be called on the main thread
+         * and queues all the jobs that were only waiting for this job to finish. */
+        void Execute(const JobInfo& info);
+
+        /** @brief Executes a single pending job on the calling thread. Yields the thread if there is no work available (or if the
+         * calling thread has no scratch allocator). */
+        void RunPendingJob();
+
+        /** @brief Puts the job in the queue of a thread that can execute it. */
+        void Enqueue(const JobInfo& info);
+
+        /** @brief Gets the next free job handle. */
+        JobHandle NextHandle();
+
+        JobSlot& GetSlot(const JobHandle handle) { return m_jobSlots[handle % MAX_ACTIVE_JOBS]; }
+        const JobSlot& GetSlot(const JobHandle handle) const { return m_jobSlots[handle % MAX_ACTIVE_JOBS]; }
+
+        /** @brief Checks if there are any jobs queued that can be executed by a thread with the provided type mask. */
+        [[nodiscard]] bool HasQueuedJobs(u32 typeMask) const;
+
+        /** @brief Wakes up sleeping job threads. */
+        void WakeThreads();
+
+        std::atomic<bool> m_running = false;
+        u8 m_threadCount            = 0;
 
         JobThread m_jobThreads[MAX_JOB_THREADS] = {};
+        /** @brief The scratch allocator for the main thread (which executes jobs while waiting and in a ParallelFor). */
+        LinearAllocator m_mainThreadScratchAllocator;
 
-        RingQueue<JobInfo, 128> m_lowPriorityQueue;
-        RingQueue<JobInfo, 128> m_normalPriorityQueue;
-        RingQueue<JobInfo, 128> m_highPriorityQueue;
+        /** @brief The number of queued (not yet started) jobs per job type. Used by idle threads to decide if they should sleep. */
+        std::atomic<u32> m_queuedJobs[JOB_TYPE_COUNT] = {};
+        /** @brief The number of job threads that are currently waiting for work. */
+        std::atomic<u32> m_sleepingThreads = 0;
+        /** @brief A slot for every job that can be in flight. A job's slot is found by taking it's handle modulo MAX_ACTIVE_JOBS. */
+        JobSlot* m_jobSlots = nullptr;
+        /** @brief The handle that will be given to the next submitted job. */
+        std::atomic<JobHandle> m_nextHandle = 0;
 
-        DynamicArray<JobResultEntry> m_pendingResults;
+        /** @brief The index of the thread that we try to submit the next job to (when submitting from a non-job thread). */
+        std::atomic<u32> m_nextThreadIndex = 0;
 
-        RingQueue<bool, 1024> m_jobStatus;
+        /** @brief Mutex and condition used to let idle job threads sleep until new work is submitted. */
+        std::mutex m_wakeMutex;
+        std::condition_variable m_wakeCondition;
 
-        std::mutex m_lowPriorityMutex;
-        std::mutex m_normalPriorityMutex;
-        std::mutex m_highPriorityMutex;
+        DynamicArray<JobResultEntry> m_pendingResults;
+        /** @brief The results that are being processed during the current OnUpdate(). Swapped with m_pendingResults every update. */
+        DynamicArray<JobResultEntry> m_processingResults;
 
         std::mutex m_resultMutex;
-        std::mutex m_jobStatusMutex;
     };
 }  // namespace C3D
@@ -0,0 +1,39 @@
+#include "task_group.h"
+
+#include "job_system.h"
+
+namespace C3D
+{
+    TaskGroup::TaskGroup(JobSystem& jobSystem, const JobPriority priority) : m_jobSystem(jobSystem), m_priority(priority) {}
+
+    TaskGroup::~TaskGroup()
+    {
+        // Ensure no job is still running that could reference data owned by the creator of this group
+        Wait();
+        m_handles.Destroy();
+    }
+
+    void TaskGroup::Run(const StackFunction<bool(), 24>& func, const char* name)
+    {
+        const auto handle = m_jobSystem.Submit(func, {}, {}, JobTypeGeneral, m_priority, nullptr, 0, name);
+        if (handle != INVALID_ID_U16)
+        {
+            m_handles.PushBack(handle);
+        }
+    }
+
+    void TaskGroup::Wait()
+    {
+        m_jobSystem.WaitAll(std::span(m_handles.GetData(), m_handles.Size()));
+        m_handles.Clear();
+    }
+
+    bool TaskGroup::IsFinished() const
+    {
+        for (const auto handle : m_handles)
+        {
+            if (!m_jobSystem.IsFinished(handle)) return false;
+        }
+        return true;
+    }
+}  // namespace C3D
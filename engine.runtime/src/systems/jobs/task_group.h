@@ -0,0 +1,43 @@
+#pragma once
+#include "containers/dynamic_array.h"
+#include "defines.h"
+#include "jobs/job_types.h"
+
+namespace C3D
+{
+    class JobSystem;
+
+    /**
+     * @brief A group of jobs that can be waited on together.
+     * Jobs are submitted to the JobSystem as soon as they are added to the group. Destroying the group waits for all of it's jobs.
+     */
+    class C3D_API TaskGroup
+    {
+    public:
+        explicit TaskGroup(JobSystem& jobSystem, JobPriority priority = JobPriority::Normal);
+
+        TaskGroup(const TaskGroup&) = delete;
+        TaskGroup(TaskGroup&&)      = delete;
+
+        TaskGroup& operator=(const TaskGroup&) = delete;
+        TaskGroup& operator=(TaskGroup&&)      = delete;
+
+        ~TaskGroup();
+
+        /** @brief Submits a general job that is part of this group. The job's scratch memory can be obtained with
+         * JobSystem::GetScratchAllocator(). The name is used when profiling the job and defaults to the name of the calling function. */
+        void Run(const StackFunction<bool(), 24>& func, const char* name = __builtin_FUNCTION());
+
+        /** @brief Waits until all jobs in this group have finished. The calling thread executes pending jobs while waiting. */
+        void Wait();
+
+        /** @brief Checks if all the jobs in this group have finished. */
+        [[nodiscard]] bool IsFinished() const;
+
+    private:
+        JobSystem& m_jobSystem;
+        JobPriority m_priority;
+
+        DynamicArray<JobHandle> m_handles;
+    };
+}  // namespace C3D
@@ -57,7 +57,6 @@ namespace C3D
         m_pbrLocations.iblCubeTexture   = Shaders.GetUniformIndex(shader, "iblCubeTexture");
         m_pbrLocations.materialTextures = Shaders.GetUniformIndex(shader, "materialTextures");
         m_pbrLocations.shadowTextures   = Shaders.GetUniformIndex(shader, "shadowTextures");
-        m_pbrLocations.model            = Shaders.GetUniformIndex(shader, "model");
         m_pbrLocations.renderMode       = Shaders.GetUniformIndex(shader, "mode");
         m_pbrLocations.dirLight         = Shaders.GetUniformIndex(shader, "dirLight");
         m_pbrLocations.pLights          = Shaders.GetUniformIndex(shader, "pLights");
@@ -132,13 +131,12 @@ namespace C3D
         DestroyMaterial(m_defaultPbrMaterial);
     }
 
-    Material* MaterialSystem::Acquire(const String& name)
+    Material* MaterialSystem::Acquire(const Name name)
     {
-        if (m_nameToMaterialIndexMap.Has(name))
+        if (const auto index = m_nameToMaterialIndexMap.Find(name))
         {
             // The material already exists
-            auto index             = m_nameToMaterialIndexMap.Get(name);
-            MaterialReference& ref = m_materials[index];
+            MaterialReference& ref = m_materials[*index];
             ref.referenceCount++;
 
             TRACE("Material: '{}' already exists. The refCount is now: {}.", name, ref.referenceCount);
@@ -147,7 +145,7 @@ namespace C3D
         }
 
         MaterialConfig materialConfig;
-        if (!Resources.Read(name, materialConfig))
+        if (!Resources.Read(name.Data(), materialConfig))
         {
             ERROR_LOG("Failed to load material resource: '{}'. Returning nullptr.", name);
             return nullptr;
@@ -163,13 +161,12 @@ namespace C3D
         return m;
     }
 
-    Material& MaterialSystem::AcquireReference(const String& name, bool autoRelease, bool& needsCreation)
+    Material& MaterialSystem::AcquireReference(const Name name, bool autoRelease, bool& needsCreation)
     {
-        if (m_nameToMaterialIndexMap.Has(name))
+        if (const auto index = m_nameToMaterialIndexMap.Find(name))
         {
             // The material already exists
-            auto index             = m_nameToMaterialIndexMap.Get(name);
-            MaterialReference& ref = m_materials[index];
+            MaterialReference& ref = m_materials[*index];
             ref.referenceCount++;
 
             TRACE("Material: '{}' already exists. The refCount is now: {}.", name, ref.referenceCount);
@@ -254,7 +251,7 @@ namespace C3D
             // Create a new Terrain Material that will hold all these internal materials
             mat.name = name;
 
-            Shader* shader = Shaders.Get("Shader.Builtin.Terrain");
+            Shader* shader = Shaders.Get("Shader.Builtin.Terrain"_name);
             mat.shaderId   = shader->id;
             mat.type       = MaterialType::Terrain;
 
@@ -428,13 +425,15 @@ namespace C3D
             return;
         }
 
-        if (!m_nameToMaterialIndexMap.Has(name))
+        const auto materialName = Name::Find(name);
+        const auto indexPtr     = m_nameToMaterialIndexMap.Find(materialName);
+        if (!indexPtr)
         {
             WARN_LOG("Tried to release a material that does not exist: '{}'.", name);
             return;
         }
 
-        auto index             = m_nameToMaterialIndexMap.Get(name);
+        const auto index       = *indexPtr;
         MaterialReference& ref = m_materials[index];
         ref.referenceCount--;
 
@@ -452,7 +451,7 @@ namespace C3D
             // Remove the material reference
             m_materials[index].material.id = INVALID_ID;
             // Also remove it from our name to index HashMap
-            m_nameToMaterialIndexMap.Delete(nameCopy);
+            m_nameToMaterialIndexMap.Delete(materialName);
 
             TRACE("The Material: '{}' was released. The texture was unloaded because refCount = 0 and autoRelease = true.", nameCopy);
         }
@@ -574,7 +573,7 @@ namespace C3D
         return true;
     }
 
-    bool MaterialSystem::ApplyPointLights(Material* material, const DynamicArray<PointLightData, LinearAllocator>& pointLights,
+    bool MaterialSystem::ApplyPointLights(Material* material, const DynamicArray<PointLightData, FrameAllocator>& pointLights,
                                           u16 pLightsLoc, u16 numPLightsLoc) const
     {
         const auto numPLights = pointLights.Size();
@@ -586,7 +585,7 @@ namespace C3D
     }
 
     bool MaterialSystem::ApplyInstance(Material* material, const DirectionalLightData& dirLight,
-                                       const DynamicArray<PointLightData, LinearAllocator>& pointLights, const FrameData& frameData,
+                                       const DynamicArray<PointLightData, FrameAllocator>& pointLights, const FrameData& frameData,
                                        const bool needsUpdate) const
     {
         MATERIAL_APPLY_OR_FAIL(Shaders.BindInstance(material->internalId))
@@ -666,10 +665,7 @@ namespace C3D
     {
         Shaders.BindLocal();
         bool result = false;
-        if (material->shaderId == m_pbrShaderId)
-        {
-            result = Shaders.SetUniformByIndex(m_pbrLocations.model, model);
-        }
+        // NOTE: The PBR shader reads it's model matrix per instance so it has no locals (see RenderSystem::DrawGeometryInstanced())
         if (material->shaderId == m_terrainShaderId)
         {
             result = Shaders.SetUniformByIndex(m_terrainLocations.model, model);
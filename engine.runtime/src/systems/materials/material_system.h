@@ -1,11 +1,12 @@
 
 #pragma once
-#include "containers/hash_map.h"
+#include "containers/flat_hash_map.h"
 #include "containers/hash_table.h"
 #include "defines.h"
 #include "logger/logger.h"
 #include "resources/materials/material.h"
 #include "resources/resource_types.h"
+#include "string/name.h"
 #include "systems/system.h"
 
 namespace C3D
@@ -81,7 +82,6 @@ namespace C3D
         u16 shadowTextures   = INVALID_ID_U16;
         u16 iblCubeTexture   = INVALID_ID_U16;
         u16 lightSpaces      = INVALID_ID_U16;
-        u16 model            = INVALID_ID_U16;
         u16 renderMode       = INVALID_ID_U16;
         u16 usePCF           = INVALID_ID_U16;
         u16 bias             = INVALID_ID_U16;
@@ -97,7 +97,7 @@ namespace C3D
 
         void OnShutdown() override;
 
-        Material* Acquire(const String& name);
+        Material* Acquire(Name name);
         Material* AcquireTerrain(const String& name, const DynamicArray<String>& materialNames, bool autoRelease);
         Material* AcquireFromConfig(const MaterialConfig& config);
 
@@ -134,7 +134,7 @@ namespace C3D
         bool ApplyGlobal(u32 shaderId, const FrameData& frameData, const DirectionalLightData& dirLight, const mat4* projection,
                          const mat4* view, const vec4* cascadeSplits, const vec3* viewPosition, u32 renderMode) const;
         bool ApplyInstance(Material* material, const DirectionalLightData& dirLight,
-                           const DynamicArray<PointLightData, LinearAllocator>& pointLights, const FrameData& frameData,
+                           const DynamicArray<PointLightData, FrameAllocator>& pointLights, const FrameData& frameData,
                            bool needsUpdate) const;
         bool ApplyLocal(const FrameData& frameData, Material* material, const mat4* model) const;
 
@@ -146,10 +146,10 @@ namespace C3D
         bool CreateDefaultTerrainMaterial();
         bool CreateDefaultPbrMaterial();
 
-        Material& AcquireReference(const String& name, bool autoRelease, bool& needsCreation);
+        Material& AcquireReference(Name name, bool autoRelease, bool& needsCreation);
 
         bool AssignMap(TextureMap& map, const MaterialConfigMap& config, TextureHandle defaultTexture) const;
-        bool ApplyPointLights(Material* material, const DynamicArray<PointLightData, LinearAllocator>& pointLights, u16 pLightsLoc,
+        bool ApplyPointLights(Material* material, const DynamicArray<PointLightData, FrameAllocator>& pointLights, u16 pLightsLoc,
                               u16 numPLightsLoc) const;
 
         bool LoadMaterial(const MaterialConfig& config, Material& mat) const;
@@ -159,7 +159,7 @@ namespace C3D
         Material m_defaultTerrainMaterial, m_defaultPbrMaterial;
 
         /** @brief HashMap to map names to material-references */
-        HashMap<String, u32> m_nameToMaterialIndexMap;
+        FlatHashMap<Name, u32> m_nameToMaterialIndexMap;
         /** @brief An array used to store our MaterialReferences */
         DynamicArray<MaterialReference> m_materials;
 
@@ -78,7 +78,7 @@ namespace C3D
 
     bool ShaderSystem::Create(void* pass, const ShaderConfig& config)
     {
-        if (m_shaderNameToIndexMap.Has(config.name))
+        if (m_shaderNameToIndexMap.Has(Name(config.name)))
         {
             INFO_LOG("A shader with the name: '{}' already exists.", config.name);
             return true;
@@ -181,17 +181,18 @@ namespace C3D
 
     bool ShaderSystem::Reload(Shader& shader) { return Renderer.ReloadShader(shader); }
 
-    u32 ShaderSystem::GetId(const String& name) const
+    u32 ShaderSystem::GetId(const Name name) const
     {
-        if (!m_shaderNameToIndexMap.Has(name))
+        const auto id = m_shaderNameToIndexMap.Find(name);
+        if (!id)
         {
             ERROR_LOG("There is no shader registered with name: '{}'.", name);
             return INVALID_ID;
         }
-        return static_cast<u32>(m_shaderNameToIndexMap.Get(name));
+        return *id;
     }
 
-    Shader* ShaderSystem::Get(const String& name)
+    Shader* ShaderSystem::Get(const Name name)
     {
         u32 id = GetId(name);
         if (id != INVALID_ID)
@@ -207,14 +208,7 @@ namespace C3D
         return &m_shaders[shaderId];
     }
 
-    bool ShaderSystem::Use(const char* name)
-    {
-        const u32 shaderId = GetId(name);
-        if (shaderId == INVALID_ID) return false;
-        return UseById(shaderId);
-    }
-
-    bool ShaderSystem::Use(const String& name)
+    bool ShaderSystem::Use(const Name name)
     {
         const u32 shaderId = GetId(name);
         if (shaderId == INVALID_ID) return false;
@@ -253,7 +247,7 @@ namespace C3D
         return true;
     }
 
-    u16 ShaderSystem::GetUniformIndex(Shader* shader, const char* name) const
+    u16 ShaderSystem::GetUniformIndex(Shader* shader, const Name name) const
     {
         if (!shader || shader->id == INVALID_ID)
         {
@@ -261,20 +255,21 @@ namespace C3D
             return INVALID_ID_U16;
         }
 
-        if (!shader->uniformNameToIndexMap.Has(name))
+        const auto index = shader->uniformNameToIndexMap.Find(name);
+        if (!index)
         {
             ERROR_LOG("Shader: '{}' does not a have a registered uniform named '{}'.", shader->name, name);
             return INVALID_ID_U16;
         }
 
-        return static_cast<u16>(shader->uniformNameToIndexMap.Get(name));
+        return static_cast<u16>(*index);
     }
 
-    bool ShaderSystem::SetUniform(const char* name, const void* value) { return SetArrayUniform(name, 0, value); }
+    bool ShaderSystem::SetUniform(const Name name, const void* value) { return SetArrayUniform(name, 0, value); }
 
     bool ShaderSystem::SetUniformByIndex(const u16 index, const void* value) { return SetArrayUniformByIndex(index, 0, value); }
 
-    bool ShaderSystem::SetArrayUniform(const char* name, u32 arrayIndex, const void* value)
+    bool ShaderSystem::SetArrayUniform(const Name name, u32 arrayIndex, const void* value)
     {
         if (m_currentShaderId == INVALID_ID)
         {
@@ -310,11 +305,11 @@ namespace C3D
         return Renderer.SetUniform(shader, uniform, arrayIndex, value);
     }
 
-    bool ShaderSystem::SetSampler(const char* name, const Texture* t) { return SetArraySampler(name, 0, t); }
+    bool ShaderSystem::SetSampler(const Name name, const Texture* t) { return SetArraySampler(name, 0, t); }
 
     bool ShaderSystem::SetSamplerByIndex(const u16 index, const Texture* t) { return SetArraySamlerByIndex(index, 0, t); }
 
-    bool ShaderSystem::SetArraySampler(const char* name, u32 arrayIndex, const Texture* t) { return SetArrayUniform(name, arrayIndex, t); }
+    bool ShaderSystem::SetArraySampler(const Name name, u32 arrayIndex, const Texture* t) { return SetArrayUniform(name, arrayIndex, t); }
 
     bool ShaderSystem::SetArraySamlerByIndex(u16 index, u32 arrayIndex, const Texture* t)
     {
@@ -614,7 +609,7 @@ namespace C3D
             ERROR_LOG("Uniform name does is empty.");
             return false;
         }
-        if (shader.uniformNameToIndexMap.Has(name))
+        if (shader.uniformNameToIndexMap.Has(Name(name)))
         {
             ERROR_LOG("Shader: '{}' already contains a uniform named '{}'.", shader.name, name);
             return false;
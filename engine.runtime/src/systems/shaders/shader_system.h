@@ -1,6 +1,6 @@
 
 #pragma once
-#include "containers/hash_map.h"
+#include "containers/flat_hash_map.h"
 #include "resources/shaders/shader.h"
 #include "systems/events/event_system.h"
 #include "systems/system.h"
@@ -33,13 +33,13 @@ namespace C3D
         bool Create(void* pass, const ShaderConfig& config);
         bool Reload(Shader& shader);
 
-        u32 GetId(const String& name) const;
+        /** @brief Gets the id of the shader with the provided name. Keep the Name around so repeated lookups are integer compares. */
+        u32 GetId(Name name) const;
 
-        Shader* Get(const String& name);
+        Shader* Get(Name name);
         Shader* GetById(u32 shaderId);
 
-        bool Use(const char* name);
-        bool Use(const String& name);
+        bool Use(Name name);
 
         /**
          * @brief Enables or disables wireframe mode for the provided shader.
@@ -52,18 +52,18 @@ namespace C3D
 
         bool UseById(u32 shaderId);
 
-        u16 GetUniformIndex(Shader* shader, const char* name) const;
+        u16 GetUniformIndex(Shader* shader, Name name) const;
 
-        bool SetUniform(const char* name, const void* value);
+        bool SetUniform(Name name, const void* value);
         bool SetUniformByIndex(u16 index, const void* value);
 
-        bool SetArrayUniform(const char* name, u32 arrayIndex, const void* value);
+        bool SetArrayUniform(Name name, u32 arrayIndex, const void* value);
         bool SetArrayUniformByIndex(u16 index, u32 arrayIndex, const void* value);
 
-        bool SetSampler(const char* name, const Texture* t);
+        bool SetSampler(Name name, const Texture* t);
         bool SetSamplerByIndex(u16 index, const Texture* t);
 
-        bool SetArraySampler(const char* name, u32 arrayIndex, const Texture* t);
+        bool SetArraySampler(Name name, u32 arrayIndex, const Texture* t);
         bool SetArraySamlerByIndex(u16 index, u32 arrayIndex, const Texture* t);
 
         bool ApplyGlobal(const FrameData& frameData, bool needsUpdate);
@@ -91,7 +91,7 @@ namespace C3D
         /** @brief An array of shaders managed by our Shader System. */
         DynamicArray<Shader> m_shaders;
         /** @brief A HashMap that maps names of Shaders to their index into our internal Shader array. */
-        HashMap<String, u32> m_shaderNameToIndexMap;
+        FlatHashMap<Name, u32> m_shaderNameToIndexMap;
 
         RegisteredEventCallback m_fileWatchCallback;
     };
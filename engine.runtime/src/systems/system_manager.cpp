@@ -2,6 +2,7 @@
 #include "system_manager.h"
 
 #include "logger/logger.h"
+#include "profiler/profiler.h"
 
 namespace C3D
 {
@@ -13,6 +14,13 @@ namespace C3D
 
     static SystemManagerState state;
 
+    /** @brief The names that are used when profiling our systems (indexed by SystemType). */
+    static constexpr const char* SYSTEM_NAMES[] = { "UI2DSystem",     "FontSystem",     "LightSystem",    "CameraSystem",
+                                                    "GeometrySystem", "MaterialSystem", "TextureSystem",  "ShaderSystem",
+                                                    "RenderSystem",   "AudioSystem",    "ResourceSystem", "InputSystem",
+                                                    "EventSystem",    "JobSystem",      "CVarSystem",     "TransformSystem" };
+    static_assert(sizeof(SYSTEM_NAMES) / sizeof(SYSTEM_NAMES[0]) == MaxKnownSystemType, "Every SystemType should have a name.");
+
     bool SystemManager::OnInit()
     {
         INFO_LOG("Initializing Systems Manager.");
@@ -32,9 +40,13 @@ namespace C3D
 
     bool SystemManager::OnPrepareRender(FrameData& frameData)
     {
-        for (const auto system : state.systems)
+        C3D_PROFILE_FUNCTION();
+
+        for (u16 type = 0; type < MaxKnownSystemType; ++type)
         {
-            if (!system->OnPrepareRender(frameData))
+            C3D_PROFILE_SCOPE(SYSTEM_NAMES[type]);
+
+            if (!state.systems[type]->OnPrepareRender(frameData))
             {
                 return false;
             }
@@ -62,12 +62,12 @@ namespace C3D
         m_nameToTextureIndexMap.Destroy();
     }
 
-    TextureHandle TextureSystem::Acquire(const String& name, bool autoRelease)
+    TextureHandle TextureSystem::Acquire(const Name name, bool autoRelease)
     {
-        if (TextureReferenceExists(name))
+        if (const auto index = m_nameToTextureIndexMap.Find(name))
         {
             // We already have this texture
-            auto& ref = GetTextureReference(name);
+            auto& ref = m_textures[*index];
             // Increment our reference count
             ref.referenceCount++;
             // And return the Texture id which is used as handle
@@ -172,15 +172,18 @@ namespace C3D
 
     void TextureSystem::Release(const String& name)
     {
-        if (!m_nameToTextureIndexMap.Has(name))
+        // NOTE: We only look for the name (instead of interning it) since every texture's name was interned when it was acquired
+        const auto textureName = Name::Find(name);
+        const auto indexPtr    = m_nameToTextureIndexMap.Find(textureName);
+        if (!indexPtr)
         {
             WARN_LOG("Tried to release a non-existant texture: '{}'.", name);
             return;
         }
 
         // Get our index and reference
-        auto index = m_nameToTextureIndexMap.Get(name);
-        auto& ref  = m_textures[index];
+        const auto index = *indexPtr;
+        auto& ref        = m_textures[index];
         // Decrement the reference count
         ref.referenceCount--;
 
@@ -189,7 +192,7 @@ namespace C3D
             INFO_LOG("Texture: '{}' was released because autoRelease == true and referenceCount == 0.", name);
 
             // Delete the reference
-            m_nameToTextureIndexMap.Delete(name);
+            m_nameToTextureIndexMap.Delete(textureName);
             // Destroy the texture
             DestroyTexture(ref.texture);
             // And mark this slot as unoccupied
@@ -214,7 +217,7 @@ namespace C3D
         if (ref.autoRelease && ref.referenceCount == 0)
         {
             // Delete the reference
-            m_nameToTextureIndexMap.Delete(ref.texture.name);
+            m_nameToTextureIndexMap.Delete(Name::Find(ref.texture.name));
             // Destroy the texture
             DestroyTexture(ref.texture);
             // And mark this slot as unoccupied
@@ -632,9 +635,9 @@ namespace C3D
         }
     }
 
-    bool TextureSystem::TextureReferenceExists(const String& name) const { return m_nameToTextureIndexMap.Has(name); }
+    bool TextureSystem::TextureReferenceExists(const Name name) const { return m_nameToTextureIndexMap.Has(name); }
 
-    TextureReference& TextureSystem::CreateTextureReference(const String& name, bool autoRelease)
+    TextureReference& TextureSystem::CreateTextureReference(const Name name, bool autoRelease)
     {
 #ifdef _DEBUG
         if (m_nameToTextureIndexMap.Has(name))
@@ -672,18 +675,18 @@ namespace C3D
         // Set the id
         ref.texture.handle = index;
         // Set the name
-        ref.texture.name = name;
+        ref.texture.name = name.Data();
         // and finally return the reference
         return ref;
     }
 
-    TextureReference& TextureSystem::GetTextureReference(const String& name)
+    TextureReference& TextureSystem::GetTextureReference(const Name name)
     {
         auto index = m_nameToTextureIndexMap.Get(name);
         return m_textures[index];
     }
 
-    void TextureSystem::DeleteTextureReference(const String& name)
+    void TextureSystem::DeleteTextureReference(const Name name)
     {
 #ifdef _DEBUG
         if (!m_nameToTextureIndexMap.Has(name))
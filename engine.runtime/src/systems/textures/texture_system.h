@@ -2,11 +2,12 @@
 #pragma once
 #include <array>
 
-#include "containers/hash_map.h"
+#include "containers/flat_hash_map.h"
 #include "defines.h"
 #include "logger/logger.h"
 #include "resources/managers/image_manager.h"
 #include "resources/textures/texture.h"
+#include "string/name.h"
 #include "string/string.h"
 #include "systems/system.h"
 
@@ -47,11 +48,11 @@ namespace C3D
         /**
          * @brief Acquire a texture with the provided name.
          *
-         * @param name The name of the texture
+         * @param name The name of the texture (an interned Name so repeated lookups don't need to hash or compare the string again)
          * @param autoRelease A boolean indicating if we should automatically release the texture when there are no more references to it
          * @return A handle to the Texture
          */
-        TextureHandle Acquire(const String& name, bool autoRelease);
+        TextureHandle Acquire(Name name, bool autoRelease);
 
         /**
          * @brief Acquire an Array Texture (multi-layer texture) with the provided name.
@@ -200,12 +201,12 @@ namespace C3D
         TextureHandle CreateArrayWritable(const String& name, TextureType type, u32 width, u32 height, u8 channelCount, u16 arraySize,
                                           TextureFlagBits flags);
 
-        bool TextureReferenceExists(const String& name) const;
+        bool TextureReferenceExists(Name name) const;
 
-        TextureReference& CreateTextureReference(const String& name, bool autoRelease);
-        TextureReference& GetTextureReference(const String& name);
+        TextureReference& CreateTextureReference(Name name, bool autoRelease);
+        TextureReference& GetTextureReference(Name name);
 
-        void DeleteTextureReference(const String& name);
+        void DeleteTextureReference(Name name);
 
         void DestroyTexture(Texture& texture) const;
 
@@ -221,6 +222,6 @@ namespace C3D
         TextureHandle m_defaultTerrainTexture;
 
         DynamicArray<TextureReference> m_textures;
-        HashMap<String, u32> m_nameToTextureIndexMap;
+        FlatHashMap<Name, u32> m_nameToTextureIndexMap;
     };
 }  // namespace C3D
@@ -1,11 +1,82 @@
 
 #include "transform_system.h"
 
+#include <bit>
+
+#if defined(C3D_SIMD_AVX)
+#include <immintrin.h>
+#elif defined(C3D_SIMD_SSE)
+#include <emmintrin.h>
+#endif
+
 #include "cson/cson_reader.h"
 #include "memory/global_memory_system.h"
 
 namespace C3D
 {
+    /**
+     * @brief Calculates translate(position) * mat4_cast(rotation) * scale(scale) directly from the components (and the determinant of
+     * the result). Uses the exact same operations as the SIMD path in UpdateLocals().
+     */
+    static void ComposeLocal(const vec3& p, const quat& q, const vec3& s, mat4& out, f32& determinant)
+    {
+        const f32 xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+        const f32 xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+        const f32 wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+
+        // The columns of the rotation matrix scaled by the matching scale component
+        const vec3 c0 = vec3(1.0f - 2.0f * (yy + zz), 2.0f * (xy + wz), 2.0f * (xz - wy)) * s.x;
+        const vec3 c1 = vec3(2.0f * (xy - wz), 1.0f - 2.0f * (xx + zz), 2.0f * (yz + wx)) * s.y;
+        const vec3 c2 = vec3(2.0f * (xz + wy), 2.0f * (yz - wx), 1.0f - 2.0f * (xx + yy)) * s.z;
+
+        out[0] = vec4(c0, 0.0f);
+        out[1] = vec4(c1, 0.0f);
+        out[2] = vec4(c2, 0.0f);
+        out[3] = vec4(p, 1.0f);
+
+        // The translation does not influence the determinant so we only need the upper 3x3 part: c0 . (c1 x c2)
+        const f32 crossX = c1.y * c2.z - c1.z * c2.y;
+        const f32 crossY = c1.z * c2.x - c1.x * c2.z;
+        const f32 crossZ = c1.x * c2.y - c1.y * c2.x;
+        determinant      = c0.x * crossX + c0.y * crossY + c0.z * crossZ;
+    }
+
+#if defined(C3D_SIMD_AVX)
+    /** @brief Transposes the provided x, y, z and w components of one column for 8 transforms and stores them in their matrices. */
+    static void StoreColumns(mat4* matrices, const u32* indices, u32 column, __m256 x, __m256 y, __m256 z, __m256 w)
+    {
+        // Transpose every 128-bit lane separately (lane 0 holds transforms 0-3, lane 1 holds transforms 4-7)
+        const auto t0 = _mm256_unpacklo_ps(x, y);
+        const auto t1 = _mm256_unpackhi_ps(x, y);
+        const auto t2 = _mm256_unpacklo_ps(z, w);
+        const auto t3 = _mm256_unpackhi_ps(z, w);
+
+        const __m256 r[4] = {
+            _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0)),
+            _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2)),
+            _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0)),
+            _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2)),
+        };
+
+        for (u32 k = 0; k < 4; ++k)
+        {
+            _mm_storeu_ps(&matrices[indices[k]][column][0], _mm256_castps256_ps128(r[k]));
+            _mm_storeu_ps(&matrices[indices[k + 4]][column][0], _mm256_extractf128_ps(r[k], 1));
+        }
+    }
+#elif defined(C3D_SIMD_SSE)
+    /** @brief Transposes the provided x, y, z and w components of one column for 4 transforms and stores them in their matrices. */
+    static void StoreColumns(mat4* matrices, const u32* indices, u32 column, __m128 x, __m128 y, __m128 z, __m128 w)
+    {
+        _MM_TRANSPOSE4_PS(x, y, z, w);
+
+        _mm_storeu_ps(&matrices[indices[0]][column][0], x);
+        _mm_storeu_ps(&matrices[indices[1]][column][0], y);
+        _mm_storeu_ps(&matrices[indices[2]][column][0], z);
+        _mm_storeu_ps(&matrices[indices[3]][column][0], w);
+    }
+#endif
+
     bool TransformSystem::OnInit(const CSONObject& config)
     {
         INFO_LOG("Initializing.");
@@ -43,11 +114,16 @@ namespace C3D
             Memory.Free(m_scales);
             Memory.Free(m_rotations);
             Memory.Free(m_determinants);
+            Memory.Free(m_localDeterminants);
             Memory.Free(m_localMatrices);
             Memory.Free(m_worldMatrices);
             Memory.Free(m_uuids);
-            Memory.Free(m_isDirtyFlags);
+            Memory.Free(m_localGenerations);
+            Memory.Free(m_worldGenerations);
+            Memory.Free(m_dirtyBits);
         }
+
+        m_dirtyIndices.Destroy();
     }
 
     Handle<Transform> TransformSystem::Acquire()
@@ -61,6 +137,8 @@ namespace C3D
         m_localMatrices[i] = mat4(1.0f);
         m_worldMatrices[i] = mat4(1.0f);
 
+        m_localDeterminants[i] = 1.0f;
+
         // NOTE: We don't add the isDirty flag since with everything defaulted our matrices evaluate to identity matrices
 
         return handle;
@@ -77,7 +155,7 @@ namespace C3D
         m_localMatrices[i] = mat4(1.0f);
         m_worldMatrices[i] = mat4(1.0f);
         // Mark as dirty since we have to calculate local matrix
-        m_isDirtyFlags[i] = true;
+        SetDirty(i);
 
         return handle;
     }
@@ -93,7 +171,7 @@ namespace C3D
         m_localMatrices[i] = mat4(1.0f);
         m_worldMatrices[i] = mat4(1.0f);
         // Mark as dirty since we have to calculate local matrix
-        m_isDirtyFlags[i] = true;
+        SetDirty(i);
 
         return handle;
     }
@@ -109,7 +187,7 @@ namespace C3D
         m_localMatrices[i] = mat4(1.0f);
         m_worldMatrices[i] = mat4(1.0f);
         // Mark as dirty since we have to calculate local matrix
-        m_isDirtyFlags[i] = true;
+        SetDirty(i);
 
         return handle;
     }
@@ -125,7 +203,7 @@ namespace C3D
         m_localMatrices[i] = mat4(1.0f);
         m_worldMatrices[i] = mat4(1.0f);
         // Mark as dirty since we have to calculate local matrix
-        m_isDirtyFlags[i] = true;
+        SetDirty(i);
 
         return handle;
     }
@@ -139,7 +217,7 @@ namespace C3D
         }
 
         m_positions[handle.index] += translation;
-        m_isDirtyFlags[handle.index] = true;
+        SetDirty(handle.index);
 
         return true;
     }
@@ -153,7 +231,7 @@ namespace C3D
         }
 
         m_scales[handle.index] *= scale;
-        m_isDirtyFlags[handle.index] = true;
+        SetDirty(handle.index);
 
         return true;
     }
@@ -167,7 +245,7 @@ namespace C3D
         }
 
         m_rotations[handle.index] *= rotation;
-        m_isDirtyFlags[handle.index] = true;
+        SetDirty(handle.index);
 
         return true;
     }
@@ -196,9 +274,38 @@ namespace C3D
         {
             m_worldMatrices[handle.index] = world;
             m_determinants[handle.index]  = glm::determinant(world);
+            m_worldGenerations[handle.index]++;
+        }
+    }
+
+    void TransformSystem::SetWorld(Handle<Transform> handle, const mat4& world, f32 determinant)
+    {
+        if (handle.IsValid())
+        {
+            m_worldMatrices[handle.index] = world;
+            m_determinants[handle.index]  = determinant;
+            m_worldGenerations[handle.index]++;
         }
     }
 
+    u32 TransformSystem::GetLocalGeneration(Handle<Transform> handle) const
+    {
+        if (!handle.IsValid())
+        {
+            FATAL_LOG("Provided handle is invalid.");
+        }
+        return m_localGenerations[handle.index];
+    }
+
+    u32 TransformSystem::GetWorldGeneration(Handle<Transform> handle) const
+    {
+        if (!handle.IsValid())
+        {
+            FATAL_LOG("Provided handle is invalid.");
+        }
+        return m_worldGenerations[handle.index];
+    }
+
     f32 TransformSystem::GetDeterminant(Handle<Transform> handle) const
     {
         if (!handle.IsValid())
@@ -208,6 +315,15 @@ namespace C3D
         return m_determinants[handle.index];
     }
 
+    f32 TransformSystem::GetLocalDeterminant(Handle<Transform> handle) const
+    {
+        if (!handle.IsValid())
+        {
+            FATAL_LOG("Provided handle is invalid.");
+        }
+        return m_localDeterminants[handle.index];
+    }
+
     const vec3& TransformSystem::GetPosition(Handle<Transform> handle) const
     {
         if (!handle.IsValid())
@@ -225,8 +341,8 @@ namespace C3D
             return false;
         }
 
-        m_positions[handle.index]    = position;
-        m_isDirtyFlags[handle.index] = true;
+        m_positions[handle.index] = position;
+        SetDirty(handle.index);
 
         return true;
     }
@@ -239,8 +355,8 @@ namespace C3D
             return false;
         }
 
-        m_positions[handle.index].x  = x;
-        m_isDirtyFlags[handle.index] = true;
+        m_positions[handle.index].x = x;
+        SetDirty(handle.index);
 
         return true;
     }
@@ -253,8 +369,8 @@ namespace C3D
             return false;
         }
 
-        m_positions[handle.index].y  = y;
-        m_isDirtyFlags[handle.index] = true;
+        m_positions[handle.index].y = y;
+        SetDirty(handle.index);
 
         return true;
     }
@@ -267,8 +383,8 @@ namespace C3D
             return false;
         }
 
-        m_positions[handle.index].z  = z;
-        m_isDirtyFlags[handle.index] = true;
+        m_positions[handle.index].z = z;
+        SetDirty(handle.index);
 
         return true;
     }
@@ -290,8 +406,8 @@ namespace C3D
             return false;
         }
 
-        m_rotations[handle.index]    = rotation;
-        m_isDirtyFlags[handle.index] = true;
+        m_rotations[handle.index] = rotation;
+        SetDirty(handle.index);
 
         return true;
     }
@@ -303,7 +419,7 @@ namespace C3D
             ERROR_LOG("Provided handle is invalid. Nothing was done.");
             return false;
         }
-        return m_isDirtyFlags[handle.index];
+        return m_dirtyBits[handle.index / 64] & (1ull << (handle.index % 64));
     }
 
     bool TransformSystem::UpdateLocal(Handle<Transform> handle)
@@ -314,20 +430,161 @@ namespace C3D
             return false;
         }
 
-        if (m_isDirtyFlags[handle.index])
+        if (IsDirty(handle))
         {
-            mat4 t = glm::translate(m_positions[handle.index]);
-            mat4 r = glm::mat4_cast(m_rotations[handle.index]);
-            mat4 s = glm::scale(m_scales[handle.index]);
-
-            m_isDirtyFlags[handle.index]  = false;
-            m_localMatrices[handle.index] = t * r * s;
+            const u32 index = handle.index;
+            UpdateLocals(&index, 1);
+            ClearDirty(index);
             return true;
         }
 
         return false;
     }
 
+    u32 TransformSystem::UpdateAllDirty()
+    {
+        // Collect the indices of all dirty transforms (clearing the dirty bits as we go)
+        m_dirtyIndices.Clear();
+
+        const u64 wordCount = (m_numberOfTransforms + 63) / 64;
+        for (u64 w = 0; w < wordCount; ++w)
+        {
+            u64 word = m_dirtyBits[w];
+            if (word == 0) continue;
+
+            m_dirtyBits[w] = 0;
+            while (word)
+            {
+                m_dirtyIndices.PushBack(static_cast<u32>(w * 64 + std::countr_zero(word)));
+                // Clear the lowest set bit
+                word &= word - 1;
+            }
+        }
+
+        const auto count = static_cast<u32>(m_dirtyIndices.Size());
+        UpdateLocals(m_dirtyIndices.GetData(), count);
+        return count;
+    }
+
+    void TransformSystem::UpdateLocals(const u32* indices, const u32 count)
+    {
+        u32 i = 0;
+
+#if defined(C3D_SIMD_AVX) || defined(C3D_SIMD_SSE)
+#if defined(C3D_SIMD_AVX)
+        constexpr u32 batchSize = 8;
+
+#define C3D_SET1(x) _mm256_set1_ps(x)
+#define C3D_LOAD(p) _mm256_load_ps(p)
+#define C3D_STORE(p, a) _mm256_storeu_ps(p, a)
+#define C3D_MUL(a, b) _mm256_mul_ps(a, b)
+#define C3D_ADD(a, b) _mm256_add_ps(a, b)
+#define C3D_SUB(a, b) _mm256_sub_ps(a, b)
+#else
+        constexpr u32 batchSize = 4;
+
+#define C3D_SET1(x) _mm_set1_ps(x)
+#define C3D_LOAD(p) _mm_load_ps(p)
+#define C3D_STORE(p, a) _mm_storeu_ps(p, a)
+#define C3D_MUL(a, b) _mm_mul_ps(a, b)
+#define C3D_ADD(a, b) _mm_add_ps(a, b)
+#define C3D_SUB(a, b) _mm_sub_ps(a, b)
+#endif
+
+        const auto zero = C3D_SET1(0.0f);
+        const auto one  = C3D_SET1(1.0f);
+        const auto two  = C3D_SET1(2.0f);
+
+        // The components of the current batch (transposed from our array of structs into a struct of arrays)
+        alignas(32) f32 px[batchSize], py[batchSize], pz[batchSize];
+        alignas(32) f32 qx[batchSize], qy[batchSize], qz[batchSize], qw[batchSize];
+        alignas(32) f32 sx[batchSize], sy[batchSize], sz[batchSize];
+        alignas(32) f32 determinants[batchSize];
+
+        for (; i + batchSize <= count; i += batchSize)
+        {
+            const u32* batch = indices + i;
+
+            for (u32 k = 0; k < batchSize; ++k)
+            {
+                const auto index = batch[k];
+                const auto& p    = m_positions[index];
+                const auto& q    = m_rotations[index];
+                const auto& s    = m_scales[index];
+
+                px[k] = p.x;
+                py[k] = p.y;
+                pz[k] = p.z;
+                qx[k] = q.x;
+                qy[k] = q.y;
+                qz[k] = q.z;
+                qw[k] = q.w;
+                sx[k] = s.x;
+                sy[k] = s.y;
+                sz[k] = s.z;
+            }
+
+            const auto x = C3D_LOAD(qx);
+            const auto y = C3D_LOAD(qy);
+            const auto z = C3D_LOAD(qz);
+            const auto w = C3D_LOAD(qw);
+
+            const auto xx = C3D_MUL(x, x), yy = C3D_MUL(y, y), zz = C3D_MUL(z, z);
+            const auto xy = C3D_MUL(x, y), xz = C3D_MUL(x, z), yz = C3D_MUL(y, z);
+            const auto wx = C3D_MUL(w, x), wy = C3D_MUL(w, y), wz = C3D_MUL(w, z);
+
+            const auto scaleX = C3D_LOAD(sx);
+            const auto scaleY = C3D_LOAD(sy);
+            const auto scaleZ = C3D_LOAD(sz);
+
+            // The columns of the rotation matrix scaled by the matching scale component
+            const auto c0x = C3D_MUL(C3D_SUB(one, C3D_MUL(two, C3D_ADD(yy, zz))), scaleX);
+            const auto c0y = C3D_MUL(C3D_MUL(two, C3D_ADD(xy, wz)), scaleX);
+            const auto c0z = C3D_MUL(C3D_MUL(two, C3D_SUB(xz, wy)), scaleX);
+
+            const auto c1x = C3D_MUL(C3D_MUL(two, C3D_SUB(xy, wz)), scaleY);
+            const auto c1y = C3D_MUL(C3D_SUB(one, C3D_MUL(two, C3D_ADD(xx, zz))), scaleY);
+            const auto c1z = C3D_MUL(C3D_MUL(two, C3D_ADD(yz, wx)), scaleY);
+
+            const auto c2x = C3D_MUL(C3D_MUL(two, C3D_ADD(xz, wy)), scaleZ);
+            const auto c2y = C3D_MUL(C3D_MUL(two, C3D_SUB(yz, wx)), scaleZ);
+            const auto c2z = C3D_MUL(C3D_SUB(one, C3D_MUL(two, C3D_ADD(xx, yy))), scaleZ);
+
+            StoreColumns(m_localMatrices, batch, 0, c0x, c0y, c0z, zero);
+            StoreColumns(m_localMatrices, batch, 1, c1x, c1y, c1z, zero);
+            StoreColumns(m_localMatrices, batch, 2, c2x, c2y, c2z, zero);
+            StoreColumns(m_localMatrices, batch, 3, C3D_LOAD(px), C3D_LOAD(py), C3D_LOAD(pz), one);
+
+            // The determinant of the upper 3x3 part: c0 . (c1 x c2)
+            const auto crossX = C3D_SUB(C3D_MUL(c1y, c2z), C3D_MUL(c1z, c2y));
+            const auto crossY = C3D_SUB(C3D_MUL(c1z, c2x), C3D_MUL(c1x, c2z));
+            const auto crossZ = C3D_SUB(C3D_MUL(c1x, c2y), C3D_MUL(c1y, c2x));
+            C3D_STORE(determinants, C3D_ADD(C3D_ADD(C3D_MUL(c0x, crossX), C3D_MUL(c0y, crossY)), C3D_MUL(c0z, crossZ)));
+
+            for (u32 k = 0; k < batchSize; ++k)
+            {
+                m_localDeterminants[batch[k]] = determinants[k];
+                m_localGenerations[batch[k]]++;
+            }
+        }
+
+#undef C3D_SET1
+#undef C3D_LOAD
+#undef C3D_STORE
+#undef C3D_MUL
+#undef C3D_ADD
+#undef C3D_SUB
+#endif
+
+        // Update the remaining transforms (or all of them if we don't have SIMD support) one at a time
+        for (; i < count; ++i)
+        {
+            const auto index = indices[i];
+            ComposeLocal(m_positions[index], m_rotations[index], m_scales[index], m_localMatrices[index], m_localDeterminants[index]);
+            m_localGenerations[index]++;
+        }
+    }
+
     bool TransformSystem::Release(Handle<Transform>& handle)
     {
         if (!handle.IsValid())
@@ -338,6 +595,8 @@ namespace C3D
 
         // Invalidate the UUID at the handle's index
         m_uuids[handle.index].Invalidate();
+        // Make sure we don't update the local matrix of a transform that no longer exists
+        ClearDirty(handle.index);
         // Invalidate the handle itself
         handle.Invalidate();
 
@@ -433,14 +692,51 @@ namespace C3D
             }
 
             {
-                // Allocate new is dirty flags
-                auto newIsDirtyFlags = Memory.Allocate<bool>(MemoryType::Transform, newNumberOfTransforms);
+                // Allocate new local determinants
+                auto newLocalDeterminants = Memory.Allocate<f32>(MemoryType::Transform, newNumberOfTransforms);
+                // Copy over the old ones
+                std::copy_n(m_localDeterminants, m_numberOfTransforms, newLocalDeterminants);
+                // Free the old ones
+                Memory.Free(m_localDeterminants);
+                // Take over the new pointer
+                m_localDeterminants = newLocalDeterminants;
+            }
+
+            {
+                // Allocate new local generations
+                auto newLocalGenerations = Memory.Allocate<u32>(MemoryType::Transform, newNumberOfTransforms);
+                // Copy over the old ones
+                std::copy_n(m_localGenerations, m_numberOfTransforms, newLocalGenerations);
+                // Free the old ones
+                Memory.Free(m_localGenerations);
+                // Take over the new pointer
+                m_localGenerations = newLocalGenerations;
+            }
+
+            {
+                // Allocate new dirty bits (one bit per transform)
+                const auto oldWordCount = (m_numberOfTransforms + 63) / 64;
+                const auto newWordCount = (newNumberOfTransforms + 63) / 64;
+
+                auto newDirtyBits = Memory.Allocate<u64>(MemoryType::Transform, newWordCount);
+                // Copy over the old ones and make sure the new ones start out cleared
+                std::copy_n(m_dirtyBits, oldWordCount, newDirtyBits);
+                std::fill(newDirtyBits + oldWordCount, newDirtyBits + newWordCount, 0);
+                // Free the old ones
+                Memory.Free(m_dirtyBits);
+                // Take over the new pointer
+                m_dirtyBits = newDirtyBits;
+            }
+
+            {
+                // Allocate new world generations
+                auto newWorldGenerations = Memory.Allocate<u32>(MemoryType::Transform, newNumberOfTransforms);
                 // Copy over the old ones
-                std::copy_n(m_isDirtyFlags, m_numberOfTransforms, newIsDirtyFlags);
+                std::copy_n(m_worldGenerations, m_numberOfTransforms, newWorldGenerations);
                 // Free the old ones
-                Memory.Free(m_isDirtyFlags);
+                Memory.Free(m_worldGenerations);
                 // Take over the new pointer
-                m_isDirtyFlags = newIsDirtyFlags;
+                m_worldGenerations = newWorldGenerations;
             }
         }
         else
@@ -453,7 +749,17 @@ namespace C3D
             m_localMatrices = Memory.Allocate<mat4>(MemoryType::Transform, newNumberOfTransforms);
             m_worldMatrices = Memory.Allocate<mat4>(MemoryType::Transform, newNumberOfTransforms);
             m_uuids         = Memory.Allocate<UUID>(MemoryType::Transform, newNumberOfTransforms);
-            m_isDirtyFlags  = Memory.Allocate<bool>(MemoryType::Transform, newNumberOfTransforms);
+
+            m_localDeterminants = Memory.Allocate<f32>(MemoryType::Transform, newNumberOfTransforms);
+            m_localGenerations  = Memory.Allocate<u32>(MemoryType::Transform, newNumberOfTransforms);
+            m_worldGenerations  = Memory.Allocate<u32>(MemoryType::Transform, newNumberOfTransforms);
+
+            const auto wordCount = (newNumberOfTransforms + 63) / 64;
+            m_dirtyBits          = Memory.Allocate<u64>(MemoryType::Transform, wordCount);
+            std::fill(m_dirtyBits, m_dirtyBits + wordCount, 0);
+
+            // Reserve enough space to be able to store every transform as dirty
+            m_dirtyIndices.Reserve(newNumberOfTransforms);
 
             // Invalidate all initial entries
             for (u32 i = 0; i < newNumberOfTransforms; ++i)
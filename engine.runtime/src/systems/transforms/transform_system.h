@@ -1,5 +1,6 @@
 
 #pragma once
+#include "containers/dynamic_array.h"
 #include "defines.h"
 #include "identifiers/handle.h"
 #include "math/math_types.h"
@@ -38,7 +39,19 @@ namespace C3D
         const mat4& GetWorld(Handle<Transform> handle) const;
         void SetWorld(Handle<Transform> handle, const mat4& world);
 
+        /** @brief Gets a counter that is incremented every time the world matrix of this transform changes.
+         * Can be used to cheaply check if anything that depends on the world matrix needs to be updated. */
+        u32 GetWorldGeneration(Handle<Transform> handle) const;
+
+        /** @brief Sets the world matrix with an already known determinant (saves calculating the determinant of the full 4x4 matrix). */
+        void SetWorld(Handle<Transform> handle, const mat4& world, f32 determinant);
+
+        /** @brief Gets a counter that is incremented every time the local matrix of this transform is recalculated.
+         * Can be used to check for local changes without consuming the dirty flag (which is shared by all users of this transform). */
+        u32 GetLocalGeneration(Handle<Transform> handle) const;
+
         f32 GetDeterminant(Handle<Transform> handle) const;
+        f32 GetLocalDeterminant(Handle<Transform> handle) const;
 
         const vec3& GetPosition(Handle<Transform> handle) const;
         bool SetPosition(Handle<Transform> handle, const vec3& position);
@@ -54,6 +67,14 @@ namespace C3D
 
         bool UpdateLocal(Handle<Transform> handle);
 
+        /**
+         * @brief Recalculates the local matrix (and it's determinant) of every dirty transform in one batched pass.
+         * The dirty transforms are collected from the dirty bitset first and then processed 4 (SSE) or 8 (AVX) at a time.
+         *
+         * @return The number of local matrices that were recalculated
+         */
+        u32 UpdateAllDirty();
+
         bool Release(Handle<Transform>& handle);
 
     private:
@@ -61,17 +82,30 @@ namespace C3D
 
         Handle<Transform> CreateHandle();
 
+        /** @brief Recalculates the local matrices for the transforms at the provided indices. */
+        void UpdateLocals(const u32* indices, u32 count);
+
+        void SetDirty(u64 index) { m_dirtyBits[index / 64] |= 1ull << (index % 64); }
+        void ClearDirty(u64 index) { m_dirtyBits[index / 64] &= ~(1ull << (index % 64)); }
+
         vec3* m_positions = nullptr;
         vec3* m_scales    = nullptr;
         quat* m_rotations = nullptr;
 
-        f32* m_determinants = nullptr;
+        f32* m_determinants      = nullptr;
+        f32* m_localDeterminants = nullptr;
 
         mat4* m_localMatrices = nullptr;
         mat4* m_worldMatrices = nullptr;
 
-        UUID* m_uuids        = nullptr;
-        bool* m_isDirtyFlags = nullptr;
+        UUID* m_uuids           = nullptr;
+        u32* m_localGenerations = nullptr;
+        u32* m_worldGenerations = nullptr;
+
+        /** @brief One bit per transform that is set when the transform's local matrix needs to be recalculated. */
+        u64* m_dirtyBits = nullptr;
+        /** @brief Scratch array with the indices of all dirty transforms (kept around to avoid allocating every frame). */
+        DynamicArray<u32> m_dirtyIndices;
 
         u64 m_numberOfTransforms = 0;
     };
@@ -0,0 +1,145 @@
+
+#include "null_buffer.h"
+
+#include <logger/logger.h>
+#include <memory/global_memory_system.h>
+
+namespace C3D
+{
+    NullBuffer::NullBuffer(RendererStats* stats, const String& name) : RenderBuffer(name), m_stats(stats) {}
+
+    bool NullBuffer::Create(const RenderBufferType bufferType, const u64 size, const RenderBufferTrackType trackType)
+    {
+        if (!RenderBuffer::Create(bufferType, size, trackType)) return false;
+
+        switch (bufferType)
+        {
+            case RenderBufferType::Vertex:
+            case RenderBufferType::Index:
+                // Device local so we don't need any CPU side memory
+                break;
+            case RenderBufferType::Instance:
+            case RenderBufferType::Uniform:
+            case RenderBufferType::Staging:
+            case RenderBufferType::Read:
+                m_memory = static_cast<u8*>(Memory.AllocateBlock(MemoryType::RenderSystem, size, 16));
+                break;
+            case RenderBufferType::Storage:
+                ERROR_LOG("RenderBufferType::Storage is not yet supported.");
+                return false;
+            case RenderBufferType::Unknown:
+                ERROR_LOG("Unsupported buffer type: '{}'.", ToUnderlying(bufferType));
+                return false;
+        }
+
+        return true;
+    }
+
+    void NullBuffer::Destroy()
+    {
+        RenderBuffer::Destroy();
+
+        if (m_memory)
+        {
+            Memory.Free(m_memory);
+            m_memory = nullptr;
+        }
+
+        totalSize = 0;
+    }
+
+    void* NullBuffer::MapMemory(const u64 offset, u64 size)
+    {
+        if (!m_memory)
+        {
+            ERROR_LOG("Tried to map memory of: '{}' which is not host visible.", m_name);
+            return nullptr;
+        }
+        return m_memory + offset;
+    }
+
+    bool NullBuffer::Resize(const u64 newSize)
+    {
+        if (!RenderBuffer::Resize(newSize)) return false;
+
+        if (m_memory)
+        {
+            const auto newMemory = static_cast<u8*>(Memory.AllocateBlock(MemoryType::RenderSystem, newSize, 16));
+            std::memcpy(newMemory, m_memory, totalSize);
+            Memory.Free(m_memory);
+            m_memory = newMemory;
+        }
+
+        totalSize = newSize;
+        return true;
+    }
+
+    bool NullBuffer::Read(const u64 offset, const u64 size, void** outMemory)
+    {
+        if (!outMemory)
+        {
+            ERROR_LOG("Requires a valid pointer to outMemory pointer.");
+            return false;
+        }
+
+        if (m_memory)
+        {
+            std::memcpy(*outMemory, m_memory + offset, size);
+        }
+        else
+        {
+            // We never keep the contents of device local buffers so there is nothing meaningful to read
+            std::memset(*outMemory, 0, size);
+        }
+        return true;
+    }
+
+    bool NullBuffer::LoadRange(const u64 offset, const u64 size, const void* data, bool includeInFrameWorkload)
+    {
+        if (!data)
+        {
+            ERROR_LOG("Requires valid data to load.");
+            return false;
+        }
+
+        if (m_memory)
+        {
+            std::memcpy(m_memory + offset, data, size);
+        }
+
+        m_stats->uploadedBytes += size;
+        return true;
+    }
+
+    bool NullBuffer::CopyRange(const u64 srcOffset, RenderBuffer* dest, const u64 dstOffset, const u64 size, bool includeInFrameWorkload)
+    {
+        if (!dest || size == 0)
+        {
+            ERROR_LOG("Requires a valid destination and a nonzero size.");
+            return false;
+        }
+
+        const auto nullDest = static_cast<NullBuffer*>(dest);
+        if (m_memory && nullDest->m_memory)
+        {
+            std::memcpy(nullDest->m_memory + dstOffset, m_memory + srcOffset, size);
+        }
+        return true;
+    }
+
+    bool NullBuffer::Draw(const u64 offset, const u32 elementCount, const bool bindOnly)
+    {
+        if (type != RenderBufferType::Vertex && type != RenderBufferType::Index)
+        {
+            ERROR_LOG("Cannot draw a buffer of type: '{}'.", ToUnderlying(type));
+            return false;
+        }
+
+        if (!bindOnly)
+        {
+            m_stats->drawCount++;
+            m_stats->drawnElementCount += elementCount;
+        }
+        return true;
+    }
+}  // namespace C3D
@@ -0,0 +1,40 @@
+
+#pragma once
+#include <defines.h>
+#include <renderer/render_buffer.h>
+#include <renderer/renderer_types.h>
+
+namespace C3D
+{
+    /**
+     * @brief A RenderBuffer that lives entirely in CPU memory.
+     * Only buffers that the CPU can access on a real GPU (Uniform, Staging and Read) get actual memory. Vertex and Index buffers are
+     * usually huge and device local so for those we only track the allocated ranges and count the uploaded bytes and draws.
+     */
+    class NullBuffer final : public RenderBuffer
+    {
+    public:
+        NullBuffer(RendererStats* stats, const String& name);
+
+        bool Create(RenderBufferType bufferType, u64 size, RenderBufferTrackType trackType) override;
+        void Destroy() override;
+
+        void* MapMemory(u64 offset, u64 size) override;
+
+        bool Resize(u64 newSize) override;
+
+        bool Read(u64 offset, u64 size, void** outMemory) override;
+        bool LoadRange(u64 offset, u64 size, const void* data, bool includeInFrameWorkload) override;
+        bool CopyRange(u64 srcOffset, RenderBuffer* dest, u64 dstOffset, u64 size, bool includeInFrameWorkload) override;
+
+        bool Draw(u64 offset, u32 elementCount, bool bindOnly) override;
+
+        [[nodiscard]] bool IsHostVisible() const { return m_memory != nullptr; }
+
+    private:
+        /** @brief The CPU side memory for this buffer. Nullptr for buffers that are not host visible. */
+        u8* m_memory = nullptr;
+
+        RendererStats* m_stats = nullptr;
+    };
+}  // namespace C3D
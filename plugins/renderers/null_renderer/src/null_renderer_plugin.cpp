@@ -0,0 +1,548 @@
+
+#include "null_renderer_plugin.h"
+
+#include <logger/logger.h>
+#include <math/c3d_math.h>
+#include <memory/global_memory_system.h>
+#include <renderer/render_target.h>
+#include <renderer/renderer_utils.h>
+#include <renderer/rendergraph/rendergraph_types.h>
+#include <resources/shaders/shader.h>
+#include <resources/textures/texture_map.h>
+#include <systems/system_manager.h>
+#include <systems/textures/texture_system.h>
+
+namespace C3D
+{
+    NullRendererPlugin::NullRendererPlugin() {}
+
+    bool NullRendererPlugin::Init(const RendererPluginConfig& config, u8* outWindowRenderTargetCount)
+    {
+        INFO_LOG("Initializing.");
+
+        type     = RendererPluginType::Null;
+        m_config = config;
+
+        // Wrap a texture for every window render target (and it's depth attachment) so our rendergraph can use them like normal
+        for (u32 i = 0; i < NULL_RENDERER_FRAME_COUNT; i++)
+        {
+            const auto renderTextureName = String::FromFormat("__internal_null_window_image_{}__", i);
+            m_renderTextures[i] = Textures.WrapInternal(renderTextureName.Data(), m_frameBufferWidth, m_frameBufferHeight, 4,
+                                                        Memory.New<NullImage>(MemoryType::Texture));
+
+            const auto depthTextureName = String::FromFormat("__C3D_DEFAULT_DEPTH_STENCIL_TEXTURE_{}", i);
+            m_depthTextures[i] = Textures.WrapInternal(depthTextureName.Data(), m_frameBufferWidth, m_frameBufferHeight, 4,
+                                                       Memory.New<NullImage>(MemoryType::Texture));
+        }
+
+        *outWindowRenderTargetCount = NULL_RENDERER_FRAME_COUNT;
+
+        INFO_LOG("Successfully Initialized.");
+        return true;
+    }
+
+    void NullRendererPlugin::Shutdown()
+    {
+        INFO_LOG("Shutting down.");
+
+        if (m_samplerCount > 0)
+        {
+            WARN_LOG(
+                "{} Sampler(s) not released before Shutdown is called. This indicates that you are missing a ReleaseTextureMapResources "
+                "call somewhere.",
+                m_samplerCount);
+        }
+
+        for (u32 i = 0; i < NULL_RENDERER_FRAME_COUNT; i++)
+        {
+            DestroyTexture(m_renderTextures[i]);
+            Textures.ReleaseInternal(m_renderTextures[i]);
+
+            DestroyTexture(m_depthTextures[i]);
+            Textures.ReleaseInternal(m_depthTextures[i]);
+        }
+
+        INFO_LOG("Complete.");
+    }
+
+    void NullRendererPlugin::OnResize(const u32 width, const u32 height)
+    {
+        m_frameBufferWidth  = width;
+        m_frameBufferHeight = height;
+
+        INFO_LOG("Width: {} and Height: {}.", width, height);
+    }
+
+    bool NullRendererPlugin::PrepareFrame(const FrameData& frameData)
+    {
+        // Cycle through our window render targets just like a swapchain would
+        m_imageIndex = (m_imageIndex + 1) % NULL_RENDERER_FRAME_COUNT;
+        return true;
+    }
+
+    bool NullRendererPlugin::Begin(const FrameData& frameData) { return true; }
+
+    bool NullRendererPlugin::End(const FrameData& frameData) { return true; }
+
+    bool NullRendererPlugin::Present(const FrameData& frameData) { return true; }
+
+    void NullRendererPlugin::SetViewport(const vec4& rect) {}
+
+    void NullRendererPlugin::ResetViewport() {}
+
+    void NullRendererPlugin::SetScissor(const ivec4& rect) {}
+
+    void NullRendererPlugin::ResetScissor() {}
+
+    void NullRendererPlugin::SetWinding(RendererWinding winding) {}
+
+    void NullRendererPlugin::SetStencilTestingEnabled(bool enabled) {}
+
+    void NullRendererPlugin::SetStencilReference(u32 reference) {}
+
+    void NullRendererPlugin::SetStencilCompareMask(u32 compareMask) {}
+
+    void NullRendererPlugin::SetStencilWriteMask(u32 writeMask) {}
+
+    void NullRendererPlugin::SetStencilOperation(StencilOperation failOp, StencilOperation passOp, StencilOperation depthFailOp,
+                                                 CompareOperation compareOp)
+    {}
+
+    void NullRendererPlugin::SetDepthTestingEnabled(bool enabled) {}
+
+    void NullRendererPlugin::BeginRenderpass(void* pass, const Viewport* viewport, const RenderTarget& target) { stats.renderpassCount++; }
+
+    void NullRendererPlugin::EndRenderpass(void* pass) {}
+
+    void NullRendererPlugin::CreateImage(Texture& texture) const
+    {
+        texture.internalData = Memory.New<NullImage>(MemoryType::Texture);
+
+        const auto image = static_cast<NullImage*>(texture.internalData);
+        image->size      = static_cast<u64>(texture.width) * texture.height * texture.channelCount * texture.arraySize;
+
+        // Only writable textures can be read back so only those need to keep their pixels around
+        if (texture.IsWritable())
+        {
+            image->pixels = static_cast<u8*>(Memory.AllocateBlock(MemoryType::Texture, image->size));
+        }
+    }
+
+    void NullRendererPlugin::CreateTexture(Texture& texture, const u8* pixels)
+    {
+        CreateImage(texture);
+
+        // Load the data
+        const auto image = static_cast<NullImage*>(texture.internalData);
+        WriteDataToTexture(texture, 0, static_cast<u32>(image->size), pixels, false);
+        // Increment the generation since we made changes
+        texture.generation++;
+    }
+
+    void NullRendererPlugin::CreateWritableTexture(Texture& texture)
+    {
+        CreateImage(texture);
+        // Increment the generation since we made changes
+        texture.generation++;
+    }
+
+    void NullRendererPlugin::WriteDataToTexture(Texture& texture, const u32 offset, const u32 size, const u8* pixels,
+                                                bool includeInFrameWorkload)
+    {
+        const auto image = static_cast<NullImage*>(texture.internalData);
+        if (image->pixels && pixels)
+        {
+            std::memcpy(image->pixels + offset, pixels, Min(static_cast<u64>(size), image->size - offset));
+        }
+
+        stats.uploadedBytes += size;
+        // Increment the generation since we made changes
+        texture.generation++;
+    }
+
+    void NullRendererPlugin::ResizeTexture(Texture& texture, const u32 newWidth, const u32 newHeight)
+    {
+        if (texture.internalData)
+        {
+            DestroyTexture(texture);
+
+            // Recalculate our mip levels
+            if (texture.mipLevels > 1)
+            {
+                // Take the base-2 log from the largest dimension floor it and add 1 for the base mip level.
+                texture.mipLevels = Floor(Log2(Max(newWidth, newHeight))) + 1;
+            }
+
+            texture.width  = newWidth;
+            texture.height = newHeight;
+            CreateImage(texture);
+
+            // Increment the generation since we have changed the texture
+            texture.generation++;
+        }
+    }
+
+    void NullRendererPlugin::ReadDataFromTexture(Texture& texture, const u32 offset, const u32 size, void** outMemory)
+    {
+        const auto image = static_cast<NullImage*>(texture.internalData);
+        if (!image || !image->pixels || offset + size > image->size)
+        {
+            // Nothing was ever rendered into this texture so we just return zeroes
+            std::memset(*outMemory, 0, size);
+            return;
+        }
+
+        std::memcpy(*outMemory, image->pixels + offset, size);
+    }
+
+    void NullRendererPlugin::ReadPixelFromTexture(Texture& texture, const u32 x, const u32 y, u8** outRgba)
+    {
+        const auto image = static_cast<NullImage*>(texture.internalData);
+        // RGBA is 4 * sizeof a unsigned 8bit integer
+        constexpr auto size = sizeof(u8) * 4;
+
+        const u64 offset = (static_cast<u64>(y) * texture.width + x) * texture.channelCount;
+        if (!image || !image->pixels || texture.channelCount != 4 || offset + size > image->size)
+        {
+            std::memset(*outRgba, 0, size);
+            return;
+        }
+
+        std::memcpy(*outRgba, image->pixels + offset, size);
+    }
+
+    void NullRendererPlugin::DestroyTexture(Texture& texture)
+    {
+        if (const auto image = static_cast<NullImage*>(texture.internalData))
+        {
+            if (image->pixels)
+            {
+                Memory.Free(image->pixels);
+            }
+            Memory.Delete(image);
+            texture.internalData = nullptr;
+        }
+    }
+
+    bool NullRendererPlugin::CreateShader(Shader& shader, const ShaderConfig& config, void* pass) const
+    {
+        // NOTE: We need to cast away the const since our uniform buffer needs to update the stats (which are a member of this plugin)
+        const auto mutableStats = const_cast<RendererStats*>(&stats);
+
+        const auto nullShader    = Memory.New<NullShader>(MemoryType::Shader, mutableStats, String::FromFormat("{}_UBO", shader.name));
+        nullShader->maxInstances = config.maxInstances;
+
+        // Invalidate all instance states
+        nullShader->instanceStates.Resize(nullShader->maxInstances);
+        for (auto& instanceState : nullShader->instanceStates)
+        {
+            instanceState.id = INVALID_ID;
+        }
+
+        shader.apiSpecificData = nullShader;
+        // Keep a copy of the toplogy types used
+        shader.topologyTypes = config.topologyTypes;
+
+        return true;
+    }
+
+    bool NullRendererPlugin::ReloadShader(Shader& shader) { return true; }
+
+    void NullRendererPlugin::DestroyShader(Shader& shader)
+    {
+        // Make sure there is something to destroy
+        if (shader.apiSpecificData)
+        {
+            const auto nullShader = static_cast<NullShader*>(shader.apiSpecificData);
+
+            nullShader->instanceStates.Destroy();
+
+            nullShader->mappedUniformBufferBlock = nullptr;
+            nullShader->uniformBuffer.Destroy();
+
+            Memory.Delete(nullShader);
+            shader.apiSpecificData = nullptr;
+        }
+    }
+
+    bool NullRendererPlugin::InitializeShader(Shader& shader)
+    {
+        const auto nullShader = static_cast<NullShader*>(shader.apiSpecificData);
+
+        // Use the same alignment as a real GPU would so our UBO layout matches
+        shader.requiredUboAlignment = NULL_RENDERER_UBO_ALIGNMENT;
+
+        // Make sure the UBO is aligned according to our requirements
+        shader.globalUboStride = GetAligned(shader.globalUboSize, shader.requiredUboAlignment);
+        shader.uboStride       = GetAligned(shader.uboSize, shader.requiredUboAlignment);
+
+        // Uniform buffer
+        const u64 totalBufferSize = shader.globalUboStride + (shader.uboStride * nullShader->maxInstances);
+        if (totalBufferSize == 0)
+        {
+            // This shader has no (global or instance) uniforms at all so we don't need a buffer
+            return true;
+        }
+
+        if (!nullShader->uniformBuffer.Create(RenderBufferType::Uniform, totalBufferSize, RenderBufferTrackType::FreeList))
+        {
+            ERROR_LOG("Failed to create uniform buffer.");
+            return false;
+        }
+
+        nullShader->mappedUniformBufferBlock = static_cast<u8*>(nullShader->uniformBuffer.MapMemory(0, totalBufferSize));
+
+        // We only allocate space for the global UBO if needed
+        if (shader.globalUboSize > 0 && shader.globalUboStride > 0)
+        {
+            // Allocate space for the global UBO, which should occupy the stride space and not the actual size needed
+            if (!nullShader->uniformBuffer.Allocate(shader.globalUboStride, shader.globalUboOffset))
+            {
+                ERROR_LOG("Failed to allocate space for the uniform buffer.");
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool NullRendererPlugin::UseShader(const Shader& shader) { return true; }
+
+    bool NullRendererPlugin::BindShaderGlobals(Shader& shader)
+    {
+        shader.boundUboOffset = static_cast<u32>(shader.globalUboOffset);
+        return true;
+    }
+
+    bool NullRendererPlugin::BindShaderInstance(Shader& shader, const u32 instanceId)
+    {
+        const auto nullShader = static_cast<NullShader*>(shader.apiSpecificData);
+        shader.boundUboOffset = static_cast<u32>(nullShader->instanceStates[instanceId].offset);
+        return true;
+    }
+
+    bool NullRendererPlugin::BindShaderLocal(Shader& shader) { return true; }
+
+    bool NullRendererPlugin::ShaderApplyGlobals(const FrameData& frameData, const Shader& shader, bool needsUpdate) { return true; }
+
+    bool NullRendererPlugin::ShaderApplyInstance(const FrameData& frameData, const Shader& shader, bool needsUpdate) { return true; }
+
+    bool NullRendererPlugin::ShaderApplyLocal(const FrameData& frameData, const Shader& shader) { return true; }
+
+    bool NullRendererPlugin::ShaderSupportsWireframe(const Shader& shader) { return shader.flags & ShaderFlagWireframe; }
+
+    bool NullRendererPlugin::AcquireShaderInstanceResources(const Shader& shader, const ShaderInstanceResourceConfig& config,
+                                                            u32& outInstanceId)
+    {
+        const auto nullShader = static_cast<NullShader*>(shader.apiSpecificData);
+
+        outInstanceId = INVALID_ID;
+        for (u32 i = 0; i < nullShader->maxInstances; i++)
+        {
+            if (nullShader->instanceStates[i].id == INVALID_ID)
+            {
+                nullShader->instanceStates[i].id = i;
+                outInstanceId                    = i;
+                break;
+            }
+        }
+
+        if (outInstanceId == INVALID_ID)
+        {
+            ERROR_LOG("Failed to acquire new instance id.");
+            return false;
+        }
+
+        // Allocate some space in the UBO - by the stride, not the size
+        auto& instanceState = nullShader->instanceStates[outInstanceId];
+        if (shader.uboStride > 0)
+        {
+            if (!nullShader->uniformBuffer.Allocate(shader.uboStride, instanceState.offset))
+            {
+                ERROR_LOG("Failed to acquire UBO space.");
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool NullRendererPlugin::ReleaseShaderInstanceResources(const Shader& shader, const u32 instanceId)
+    {
+        const auto nullShader = static_cast<NullShader*>(shader.apiSpecificData);
+        auto& instanceState   = nullShader->instanceStates[instanceId];
+
+        if (shader.uboStride != 0)
+        {
+            if (!nullShader->uniformBuffer.Free(shader.uboStride, instanceState.offset))
+            {
+                ERROR_LOG("Failed to free range from renderbuffer.");
+            }
+        }
+
+        instanceState.offset = INVALID_ID_U64;
+        instanceState.id     = INVALID_ID;
+
+        return true;
+    }
+
+    bool NullRendererPlugin::AcquireTextureMapResources(TextureMap& map)
+    {
+        // We have no samplers but we hand out an id so the texture map looks acquired to the rest of the engine
+        map.internalId = m_samplerCount++;
+        return true;
+    }
+
+    void NullRendererPlugin::ReleaseTextureMapResources(TextureMap& map)
+    {
+        if (map.internalId != INVALID_ID)
+        {
+            m_samplerCount--;
+            map.internalId = INVALID_ID;
+        }
+    }
+
+    bool NullRendererPlugin::RefreshTextureMapResources(TextureMap& map) { return true; }
+
+    bool NullRendererPlugin::SetUniform(Shader& shader, const ShaderUniform& uniform, u32 arrayIndex, const void* value)
+    {
+        const auto nullShader = static_cast<NullShader*>(shader.apiSpecificData);
+
+        stats.uniformUploadCount++;
+
+        if (UniformTypeIsASampler(uniform.type))
+        {
+            // Samplers only need to point to the right texture map which we don't need
+            if (uniform.arrayLength > 1 && arrayIndex >= uniform.arrayLength)
+            {
+                ERROR_LOG("ArrayIndex of: {} is out of range (0-{}).", arrayIndex, uniform.arrayLength);
+                return false;
+            }
+            return true;
+        }
+
+        u8* address = nullptr;
+        if (uniform.scope == ShaderScope::Local)
+        {
+            address = nullShader->localUniformBlock + uniform.offset + (uniform.size * arrayIndex);
+        }
+        else
+        {
+            address = nullShader->mappedUniformBufferBlock + shader.boundUboOffset + uniform.offset + (uniform.size * arrayIndex);
+        }
+
+        std::memcpy(address, value, uniform.size);
+        stats.uploadedBytes += uniform.size;
+        return true;
+    }
+
+    void NullRendererPlugin::CreateRenderTarget(void* pass, RenderTarget& target, u16 layerIndex, const u32 width, const u32 height)
+    {
+        const auto frameBuffer     = Memory.New<NullFrameBuffer>(MemoryType::RenderSystem);
+        frameBuffer->width         = width;
+        frameBuffer->height        = height;
+        target.internalFrameBuffer = frameBuffer;
+    }
+
+    void NullRendererPlugin::DestroyRenderTarget(RenderTarget& target, const bool freeInternalMemory)
+    {
+        if (target.internalFrameBuffer)
+        {
+            Memory.Delete(static_cast<NullFrameBuffer*>(target.internalFrameBuffer));
+            target.internalFrameBuffer = nullptr;
+
+            if (freeInternalMemory)
+            {
+                target.attachments.Destroy();
+            }
+        }
+    }
+
+    bool NullRendererPlugin::CreateRenderpassInternals(const RenderpassConfig& config, void** internalData)
+    {
+        const auto pass = Memory.New<NullRenderpass>(MemoryType::RenderSystem);
+        pass->name      = config.name;
+
+        *internalData = pass;
+        return true;
+    }
+
+    void NullRendererPlugin::DestroyRenderpassInternals(void* internalData)
+    {
+        const auto pass = static_cast<NullRenderpass*>(internalData);
+        pass->name.Destroy();
+        Memory.Delete(pass);
+    }
+
+    RenderBuffer* NullRendererPlugin::CreateRenderBuffer(const String& name, const RenderBufferType bufferType, const u64 totalSize,
+                                                         RenderBufferTrackType trackType)
+    {
+        const auto buffer = Memory.New<NullBuffer>(MemoryType::RenderSystem, &stats, name);
+        if (!buffer->Create(bufferType, totalSize, trackType))
+        {
+            Memory.Delete(buffer);
+            return nullptr;
+        }
+        return buffer;
+    }
+
+    bool NullRendererPlugin::DestroyRenderBuffer(RenderBuffer* buffer)
+    {
+        buffer->Destroy();
+        Memory.Delete(buffer);
+        return true;
+    }
+
+    void NullRendererPlugin::DrawGeometryInstanced(const GeometryRenderData& data, RenderBuffer& vertexBuffer, RenderBuffer& indexBuffer,
+                                                   RenderBuffer& instanceBuffer, const u64 instanceOffset, const u32 instanceCount)
+    {
+        const u64 elementCount = data.indexCount > 0 ? data.indexCount : data.vertexCount;
+
+        stats.drawCount++;
+        stats.drawnElementCount += elementCount * instanceCount;
+    }
+
+    void NullRendererPlugin::WaitForIdle() {}
+
+    void NullRendererPlugin::BeginDebugLabel(const String& text, const vec3& color) {}
+
+    void NullRendererPlugin::EndDebugLabel() {}
+
+    TextureHandle NullRendererPlugin::GetWindowAttachment(const u8 index)
+    {
+        if (index >= NULL_RENDERER_FRAME_COUNT)
+        {
+            FATAL_LOG("Attempting to get attachment index that is out of range: '{}'. Attachment count is: '{}'.", index,
+                      NULL_RENDERER_FRAME_COUNT);
+        }
+        return m_renderTextures[index].handle;
+    }
+
+    TextureHandle NullRendererPlugin::GetDepthAttachment(const u8 index)
+    {
+        if (index >= NULL_RENDERER_FRAME_COUNT)
+        {
+            FATAL_LOG("Attempting to get attachment index that is out of range: '{}'. Attachment count is: '{}'.", index,
+                      NULL_RENDERER_FRAME_COUNT);
+        }
+        return m_depthTextures[index].handle;
+    }
+
+    u8 NullRendererPlugin::GetWindowAttachmentIndex() { return static_cast<u8>(m_imageIndex); }
+
+    u8 NullRendererPlugin::GetWindowAttachmentCount() { return NULL_RENDERER_FRAME_COUNT; }
+
+    bool NullRendererPlugin::IsMultiThreaded() const { return false; }
+
+    void NullRendererPlugin::SetFlagEnabled(const RendererConfigFlag flag, const bool enabled)
+    {
+        m_config.flags = enabled ? (m_config.flags | flag) : (m_config.flags & ~flag);
+    }
+
+    bool NullRendererPlugin::IsFlagEnabled(const RendererConfigFlag flag) const { return m_config.flags & flag; }
+
+    RendererPlugin* CreatePlugin() { return Memory.New<NullRendererPlugin>(MemoryType::RenderSystem); }
+
+    void DeletePlugin(RendererPlugin* plugin) { Memory.Delete(plugin); }
+
+}  // namespace C3D
@@ -0,0 +1,62 @@
+
+#pragma once
+#include <containers/dynamic_array.h>
+#include <defines.h>
+#include <string/string.h>
+
+#include "null_buffer.h"
+
+namespace C3D
+{
+    /** @brief The number of window render targets we pretend to have (the same as a triple buffered swapchain). */
+    constexpr auto NULL_RENDERER_FRAME_COUNT = 3;
+    /** @brief The UBO alignment we report. 256 is the largest minimum alignment that (desktop) GPUs require. */
+    constexpr auto NULL_RENDERER_UBO_ALIGNMENT = 256;
+    /** @brief The size of the block that holds our local uniforms (the guaranteed push constant size in Vulkan). */
+    constexpr auto NULL_RENDERER_LOCAL_UNIFORM_BLOCK_SIZE = 128;
+
+    /** @brief The CPU side data for a texture. Only writable textures (which can be read back) keep their pixels. */
+    struct NullImage
+    {
+        /** @brief The pixel data or nullptr if this texture is not writable. */
+        u8* pixels = nullptr;
+        /** @brief The size of the texture in bytes. */
+        u64 size = 0;
+    };
+
+    struct NullShaderInstanceState
+    {
+        /** @brief Instance id. INVALID_ID if not used. */
+        u32 id = INVALID_ID;
+        /** @brief The offset in bytes in the instance uniform buffer. */
+        u64 offset = 0;
+    };
+
+    struct NullShader
+    {
+        NullShader(RendererStats* stats, const String& name) : uniformBuffer(stats, name) {}
+
+        /** @brief The uniform buffer that holds the global UBO followed by the UBO of every instance. */
+        NullBuffer uniformBuffer;
+        /** @brief A pointer to the start of the uniform buffer's memory. */
+        u8* mappedUniformBufferBlock = nullptr;
+        /** @brief The memory for our local uniforms. */
+        u8 localUniformBlock[NULL_RENDERER_LOCAL_UNIFORM_BLOCK_SIZE] = {};
+
+        /** @brief The maximum number of instances that this shader supports. */
+        u32 maxInstances = 0;
+        /** @brief The state of every instance. */
+        DynamicArray<NullShaderInstanceState> instanceStates;
+    };
+
+    struct NullRenderpass
+    {
+        String name;
+    };
+
+    struct NullFrameBuffer
+    {
+        u32 width  = 0;
+        u32 height = 0;
+    };
+}  // namespace C3D
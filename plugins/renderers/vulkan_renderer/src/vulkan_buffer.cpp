@@ -31,6 +31,17 @@ namespace C3D
                                                              VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
                 m_memoryPropertyFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
                 break;
+            case RenderBufferType::Instance:
+            {
+                u32 deviceLocalBits = m_context->device.HasSupportFor(VULKAN_DEVICE_SUPPORT_FLAG_DEVICE_LOCAL_HOST_VISIBILE_MEMORY)
+                                          ? VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+                                          : 0;
+
+                // Written directly from the CPU every frame so we avoid the staging buffer (and it's queue wait) entirely
+                m_usage               = static_cast<VkBufferUsageFlagBits>(VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+                m_memoryPropertyFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT | deviceLocalBits;
+            }
+            break;
             case RenderBufferType::Uniform:
             {
                 u32 deviceLocalBits = m_context->device.HasSupportFor(VULKAN_DEVICE_SUPPORT_FLAG_DEVICE_LOCAL_HOST_VISIBILE_MEMORY)
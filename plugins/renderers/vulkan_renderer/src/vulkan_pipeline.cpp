@@ -163,15 +163,20 @@ namespace C3D
         dynamicStateCreateInfo.pDynamicStates                   = dynamicStates.GetData();
 
         // Vertex Input
-        VkVertexInputBindingDescription bindingDescription;
-        bindingDescription.binding   = 0;
-        bindingDescription.stride    = config.stride;
-        bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+        VkVertexInputBindingDescription bindingDescriptions[2];
+        bindingDescriptions[0].binding   = 0;
+        bindingDescriptions[0].stride    = config.stride;
+        bindingDescriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+        // Instanced pipelines read their per-instance data from a second buffer
+        bindingDescriptions[1].binding   = 1;
+        bindingDescriptions[1].stride    = config.instanceStride;
+        bindingDescriptions[1].inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
 
         // Attributes
         VkPipelineVertexInputStateCreateInfo vertexInputCreateInfo = { VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO };
-        vertexInputCreateInfo.vertexBindingDescriptionCount        = 1;
-        vertexInputCreateInfo.pVertexBindingDescriptions           = &bindingDescription;
+        vertexInputCreateInfo.vertexBindingDescriptionCount        = config.instanceStride > 0 ? 2 : 1;
+        vertexInputCreateInfo.pVertexBindingDescriptions           = bindingDescriptions;
         vertexInputCreateInfo.vertexAttributeDescriptionCount      = config.attributes.Size();
         vertexInputCreateInfo.pVertexAttributeDescriptions         = config.attributes.GetData();
 
@@ -11,6 +11,8 @@ namespace C3D
     {
         VulkanRenderpass* renderpass;
         u32 stride;
+        /** @brief The stride of the per-instance data (read from binding 1). 0 if this pipeline does not use instancing. */
+        u32 instanceStride = 0;
 
         /** @brief Array of Vertex Input Attribute descriptions that are part of this pipeline. */
         DynamicArray<VkVertexInputAttributeDescription> attributes;
@@ -660,6 +660,32 @@ namespace C3D
         return true;
     }
 
+    void VulkanRendererPlugin::DrawGeometryInstanced(const GeometryRenderData& data, RenderBuffer& vertexBuffer,
+                                                     RenderBuffer& indexBuffer, RenderBuffer& instanceBuffer, const u64 instanceOffset,
+                                                     const u32 instanceCount)
+    {
+        const auto commandBuffer = &m_context.graphicsCommandBuffers[m_context.imageIndex];
+
+        // Bind the geometry to binding 0 and the per-instance data to binding 1
+        const auto& vulkanVertexBuffer   = static_cast<VulkanBuffer&>(vertexBuffer);
+        const auto& vulkanInstanceBuffer = static_cast<VulkanBuffer&>(instanceBuffer);
+
+        const VkBuffer buffers[2]     = { vulkanVertexBuffer.handle, vulkanInstanceBuffer.handle };
+        const VkDeviceSize offsets[2] = { data.vertexBufferOffset, instanceOffset };
+        vkCmdBindVertexBuffers(commandBuffer->handle, 0, 2, buffers, offsets);
+
+        if (data.indexCount > 0)
+        {
+            vkCmdBindIndexBuffer(commandBuffer->handle, static_cast<VulkanBuffer&>(indexBuffer).handle, data.indexBufferOffset,
+                                 VK_INDEX_TYPE_UINT32);
+            vkCmdDrawIndexed(commandBuffer->handle, data.indexCount, instanceCount, 0, 0, 0);
+        }
+        else
+        {
+            vkCmdDraw(commandBuffer->handle, data.vertexCount, instanceCount, 0, 0);
+        }
+    }
+
     void VulkanRendererPlugin::WaitForIdle()
     {
         auto result = m_context.device.WaitIdle();
@@ -1291,6 +1317,28 @@ namespace C3D
             vulkanShader->attributes[i] = attribute;
             offset += shader.attributes[i].size;
         }
+        vulkanShader->attributeCount = shader.attributes.Size();
+
+        if (shader.flags & ShaderFlagInstancing)
+        {
+            // The per-instance model matrix is read from binding 1 as 4 consecutive vec4 columns (since a mat4 uses 4 locations)
+            if (vulkanShader->attributeCount + 4 > VULKAN_SHADER_MAX_ATTRIBUTES)
+            {
+                ERROR_LOG("Shader: '{}' has too many attributes to also support instancing.", shader.name);
+                return false;
+            }
+
+            for (u32 column = 0; column < 4; column++)
+            {
+                VkVertexInputAttributeDescription attribute{};
+                attribute.location = vulkanShader->attributeCount;
+                attribute.binding  = 1;
+                attribute.offset   = column * sizeof(vec4);
+                attribute.format   = VK_FORMAT_R32G32B32A32_SFLOAT;
+
+                vulkanShader->attributes[vulkanShader->attributeCount++] = attribute;
+            }
+        }
 
         // Define the descriptor pool creation info
         VkDescriptorPoolCreateInfo poolInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO };
@@ -2293,7 +2341,8 @@ namespace C3D
             VulkanPipelineConfig config = {};
             config.renderpass           = vulkanShader->renderpass;
             config.stride               = shader.attributeStride;
-            config.attributes.Copy(vulkanShader->attributes, shader.attributes.Size());
+            config.instanceStride       = (shader.flags & ShaderFlagInstancing) ? GEOMETRY_INSTANCE_STRIDE : 0;
+            config.attributes.Copy(vulkanShader->attributes, vulkanShader->attributeCount);
             config.descriptorSetLayouts.Copy(vulkanShader->descriptorSetLayouts, vulkanShader->descriptorSetCount);
             config.stages.Copy(stageCreateInfos, vulkanShader->stageCount);
             config.viewport = viewport;
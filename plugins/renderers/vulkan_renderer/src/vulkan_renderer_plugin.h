@@ -93,6 +93,9 @@ namespace C3D
                                          RenderBufferTrackType trackType) override;
         bool DestroyRenderBuffer(RenderBuffer* buffer) override;
 
+        void DrawGeometryInstanced(const GeometryRenderData& data, RenderBuffer& vertexBuffer, RenderBuffer& indexBuffer,
+                                   RenderBuffer& instanceBuffer, u64 instanceOffset, u32 instanceCount) override;
+
         void WaitForIdle() override;
 
         void BeginDebugLabel(const String& text, const vec3& color) override;
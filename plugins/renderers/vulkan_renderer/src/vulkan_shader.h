@@ -106,6 +106,8 @@ namespace C3D
         VulkanDescriptorSetConfig descriptorSets[2];
         /** @brief An array of attribute descriptions for this shader. */
         VkVertexInputAttributeDescription attributes[VULKAN_SHADER_MAX_ATTRIBUTES];
+        /** @brief The number of attribute descriptions (including the per-instance ones for shaders that use instancing). */
+        u32 attributeCount = 0;
         /** @brief The face culling mode used by this shader. */
         FaceCullMode cullMode;
         /** @brief The maximum number of instances supported by this shader. */
@@ -6,6 +6,8 @@ layout(location = 1) in vec3 inNormal;
 layout(location = 2) in vec2 inTexCoord;
 layout(location = 3) in vec4 inColor;
 layout(location = 4) in vec3 inTangent;
+// Per-instance model matrix (takes up locations 5 through 8)
+layout(location = 5) in mat4 inModel;
 
 const int MAX_SHADOW_CASCADES = 4;
 
@@ -22,12 +24,6 @@ layout(set = 0, binding = 0) uniform globalUniformObject
 	vec2 padding;
 } globalUbo;
 
-// Push constants are only guaranteed to be a total of 128 bytes.
-layout(push_constant) uniform PushConstants 
-{
-	mat4 model; // 64 bytes
-} uPushConstants;
-
 layout(location = 0) out int outMode;
 layout(location = 1) out int usePCF;
 
@@ -60,17 +56,17 @@ void main()
 	outDto.color = inColor;
 	
 	// Fragment position in world space
-	outDto.fragPosition = vec3(uPushConstants.model * vec4(inPosition, 1.0));
+	outDto.fragPosition = vec3(inModel * vec4(inPosition, 1.0));
 
 	// Calculate mat3 version of our model
-	mat3 m3Model = mat3(uPushConstants.model);
+	mat3 m3Model = mat3(inModel);
 	// Convert local normal to "world space"
 	outDto.normal = normalize(m3Model * inNormal);
 	outDto.tangent = normalize(m3Model * inTangent);
 	outDto.cascadeSplits = globalUbo.cascadeSplits;
 	outDto.viewPosition = globalUbo.viewPosition;
 	
-	gl_Position = globalUbo.projection * globalUbo.view * uPushConstants.model * vec4(inPosition, 1.0);
+	gl_Position = globalUbo.projection * globalUbo.view * inModel * vec4(inPosition, 1.0);
 
 	for (int i = 0; i < MAX_SHADOW_CASCADES; ++i)
     {
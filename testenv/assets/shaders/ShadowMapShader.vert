@@ -5,6 +5,8 @@ layout(location = 1) in vec3 inNormal;
 layout(location = 2) in vec2 inTexCoord;
 layout(location = 3) in vec4 inColor;
 layout(location = 4) in vec4 inTangent;
+// Per-instance model matrix (takes up locations 5 through 8)
+layout(location = 5) in mat4 inModel;
 
 #define MAX_CASCADES 4
 
@@ -17,7 +19,6 @@ layout(set = 0, binding = 0) uniform globalUniformObject
 // Push constants are only guaranteed to be a total of 128 bytes.
 layout(push_constant) uniform PushConstants 
 {
-	mat4 model; // 64 bytes
     uint cascadeIndex;
 } localUbo;
 
@@ -29,5 +30,5 @@ layout(location = 1) out struct dto
 void main()
 {
     outDto.texCoord = inTexCoord;
-    gl_Position = globalUbo.projections[localUbo.cascadeIndex] * globalUbo.views[localUbo.cascadeIndex] * localUbo.model * vec4(inPosition, 1.0);
+    gl_Position = globalUbo.projections[localUbo.cascadeIndex] * globalUbo.views[localUbo.cascadeIndex] * inModel * vec4(inPosition, 1.0);
 }
\ No newline at end of file
@@ -92,10 +92,15 @@ void EditorGizmo::OnPrepareRender(C3D::FrameData& frameData)
 
 void EditorGizmo::Update()
 {
-    if (Transforms.UpdateLocal(m_transform))
+    // NOTE: The local matrix might have already been updated by a batched update so we check the generation instead
+    Transforms.UpdateLocal(m_transform);
+
+    const auto generation = Transforms.GetLocalGeneration(m_transform);
+    if (generation != m_localGeneration)
     {
         const auto& local = Transforms.GetLocal(m_transform);
-        Transforms.SetWorld(m_transform, local);
+        Transforms.SetWorld(m_transform, local, Transforms.GetLocalDeterminant(m_transform));
+        m_localGeneration = generation;
     }
 }
 
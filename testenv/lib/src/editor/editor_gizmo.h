@@ -99,6 +99,8 @@ private:
 
     C3D::Handle<C3D::Transform> m_transform;
     C3D::Handle<C3D::Transform> m_selectedObjectTransform;
+    /** @brief The local generation of our transform the last time we updated it's world matrix. */
+    u32 m_localGeneration = INVALID_ID;
 
     /** @brief Used to keep the gizmo a consistent size on the screen despite camera distance. */
     f32 m_scale = 0.0f;
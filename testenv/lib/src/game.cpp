@@ -364,13 +364,14 @@ void TestEnv::OnUpdate(C3D::FrameData& frameData)
     buffer.FromFormat(
         "{:<10} : Pos({:.3f}, {:.3f}, {:.3f}) Rot({:.3f}, {:.3f}, {:.3f})\n"
         "{:<10} : Pos({:.2f}, {:.2f}) Buttons({}, {}, {}) Hovered: {}\n"
-        "{:<10} : DrawCount: (Mesh: {}, Terrain: {}, ShadowMap: {}) FPS: {} VSync: {}\n"
+        "{:<10} : DrawCount: (Mesh: {} in {} calls, Terrain: {}, ShadowMap: {} in {} calls) FPS: {} VSync: {}\n"
         "{:<10} : Prepare: {:.4f} Render: {:.4f} Present: {:.4f} Update: {:.4f} Total: {:.4f}",
         "Cam", pos.x, pos.y, pos.z, C3D::RadToDeg(rot.x), C3D::RadToDeg(rot.y), C3D::RadToDeg(rot.z), "Mouse", mouseNdcX, mouseNdcY,
-        leftButton, middleButton, rightButton, hoveredBuffer, "Renderer", frameData.drawnMeshCount, frameData.drawnTerrainCount,
-        frameData.drawnShadowMeshCount, Metrics.GetFps(), Renderer.IsFlagEnabled(C3D::FlagVSyncEnabled) ? "Yes" : "No", "Timings",
-        frameData.timeData.avgPrepareFrameTimeMs, frameData.timeData.avgRenderTimeMs, frameData.timeData.avgPresentTimeMs,
-        frameData.timeData.avgUpdateTimeMs, frameData.timeData.avgRunTimeMs);
+        leftButton, middleButton, rightButton, hoveredBuffer, "Renderer", frameData.drawnMeshCount, frameData.meshDrawCallCount,
+        frameData.drawnTerrainCount, frameData.drawnShadowMeshCount, frameData.shadowMeshDrawCallCount, Metrics.GetFps(),
+        Renderer.IsFlagEnabled(C3D::FlagVSyncEnabled) ? "Yes" : "No", "Timings", frameData.timeData.avgPrepareFrameTimeMs,
+        frameData.timeData.avgRenderTimeMs, frameData.timeData.avgPresentTimeMs, frameData.timeData.avgUpdateTimeMs,
+        frameData.timeData.avgRunTimeMs);
 
     UI2D.SetText(m_state->debugInfoLabel, buffer.Data());
 
@@ -8,13 +8,13 @@ using namespace C3D;
 
 namespace C3D
 {
-    class LinearAllocator;
+    class FrameAllocator;
     class Scene;
 }  // namespace C3D
 
 struct EditorRendergraphConfig
 {
-    const LinearAllocator* pFrameAllocator = nullptr;
+    const FrameAllocator* pFrameAllocator = nullptr;
 };
 
 class EditorRendergraph : public Rendergraph<EditorRendergraphConfig>
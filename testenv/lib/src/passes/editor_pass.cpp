@@ -12,7 +12,7 @@ constexpr const char* SHADER_NAME = "Shader.Builtin.Color3D";
 
 EditorPass::EditorPass() : Renderpass("EDITOR") {}
 
-bool EditorPass::Initialize(const C3D::LinearAllocator* frameAllocator)
+bool EditorPass::Initialize(const C3D::FrameAllocator* frameAllocator)
 {
     C3D::RenderpassConfig pass = {};
     pass.name                  = "Renderpass.Editor";
@@ -2,7 +2,7 @@
 #pragma once
 #include <containers/dynamic_array.h>
 #include <defines.h>
-#include <memory/allocators/linear_allocator.h>
+#include <memory/allocators/frame_allocator.h>
 #include <renderer/renderer_types.h>
 #include <renderer/rendergraph/renderpass.h>
 #include <resources/debug/debug_types.h>
@@ -20,14 +20,14 @@ class EditorPass : public C3D::Renderpass
 public:
     EditorPass();
 
-    bool Initialize(const C3D::LinearAllocator* frameAllocator) override;
+    bool Initialize(const C3D::FrameAllocator* frameAllocator) override;
     bool Prepare(const C3D::Viewport& viewport, C3D::Camera* camera, EditorGizmo* gizmo);
     bool Execute(const C3D::FrameData& frameData) override;
 
 private:
     C3D::Shader* m_shader = nullptr;
 
-    C3D::DynamicArray<C3D::GeometryRenderData, C3D::LinearAllocator> m_geometries;
+    C3D::DynamicArray<C3D::GeometryRenderData, C3D::FrameAllocator> m_geometries;
 
     C3D::DebugColorShaderLocations m_locations;
 };
\ No newline at end of file
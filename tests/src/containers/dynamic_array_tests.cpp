@@ -199,6 +199,24 @@ namespace DynamicArray
         ExpectEqual(0, TEST_OBJECT_COUNTER);
     }
 
+    TEST(DynamicArrayShouldGrowFromASmallCapacity)
+    {
+        C3D::DynamicArray<u64> array;
+        array.Reserve(1);
+
+        // A capacity of 1 grown by the resize factor would round down to 1 again
+        for (u64 i = 0; i < 8; ++i)
+        {
+            array.PushBack(i);
+            ExpectTrue(array.Capacity() >= array.Size());
+        }
+
+        for (u64 i = 0; i < 8; ++i)
+        {
+            ExpectEqual(i, array[i]);
+        }
+    }
+
     TEST(DynamicArrayShouldIterate)
     {
         C3D::DynamicArray<int> array;
@@ -584,6 +602,7 @@ namespace DynamicArray
                       "least 1 element is added");
         REGISTER_TEST(DynamicArrayShouldReallocate,
                       "Dynamic array should reallocate whenever there is not enough space and also cleanup the old memory.");
+        REGISTER_TEST(DynamicArrayShouldGrowFromASmallCapacity, "Dynamic array should grow when PushBack() is called at a capacity of 1");
         REGISTER_TEST(DynamicArrayShouldIterate, "Dynamic array should iterate over all it's elements in a foreach loop");
         REGISTER_TEST(DynamicArrayShouldDestroyWhenLeavingScope,
                       "Dynamic array should be automatically destroyed and cleaned up after leaving scope");
@@ -0,0 +1,348 @@
+#include "flat_hash_map_tests.h"
+
+#include <containers/dynamic_array.h>
+#include <containers/flat_hash_map.h>
+#include <containers/hash_map.h>
+#include <defines.h>
+#include <metrics/metrics.h>
+#include <platform/platform.h>
+#include <random/random.h>
+#include <string/cstring.h>
+#include <string/string.h>
+
+#include <unordered_map>
+
+#include "../expect.h"
+#include "../utilities/non_trivial_destructor_object.h"
+
+namespace FlatHashMap
+{
+    TEST(FlatHashMapShouldCreateAndDestroy)
+    {
+        C3D::FlatHashMap<C3D::String, u32> hashMap;
+        hashMap.Create();
+
+        ExpectEqual(C3D::FLAT_HASH_MAP_DEFAULT_CAPACITY, hashMap.Capacity());
+        // One control byte and one slot for every element
+        ExpectEqual(C3D::FLAT_HASH_MAP_DEFAULT_CAPACITY * (1 + sizeof(C3D::FlatHashMap<C3D::String, u32>::Slot)),
+                    Metrics.GetRequestedMemoryUsage(C3D::MemoryType::HashMap));
+        ExpectEqual(C3D::FLAT_HASH_MAP_DEFAULT_LOAD_FACTOR, hashMap.LoadFactor());
+
+        hashMap.Destroy();
+
+        ExpectEqual(0, Metrics.GetMemoryUsage(C3D::MemoryType::HashMap));
+    }
+
+    TEST(FlatHashMapShouldSetGetAndFind)
+    {
+        C3D::FlatHashMap<C3D::String, u32> hashMap;
+        hashMap.Create();
+
+        hashMap.Set("Test", 5);
+        ExpectEqual(5, hashMap.Get("Test"));
+
+        auto& test = hashMap.Get("Test");
+        test       = 12;
+        ExpectEqual(12, hashMap.Get("Test"));
+
+        ExpectTrue(hashMap.Find("Test") != nullptr);
+        ExpectEqual(12, *hashMap.Find("Test"));
+        ExpectTrue(hashMap.Find("Test1234") == nullptr);
+        ExpectFalse(hashMap.Has("Test1234"));
+    }
+
+    TEST(FlatHashMapShouldSupportHeterogeneousLookup)
+    {
+        C3D::FlatHashMap<C3D::String, u32> stringMap;
+        stringMap.Create();
+
+        C3D::FlatHashMap<C3D::CString<128>, u32> cStringMap;
+        cStringMap.Create();
+
+        for (u32 i = 0; i < 100; ++i)
+        {
+            const auto name = C3D::String::FromFormat("Texture.Name.That.Is.Quite.Long.{}", i);
+            stringMap.Set(name, i);
+            cStringMap.Set(name.Data(), i);
+        }
+
+        for (u32 i = 0; i < 100; ++i)
+        {
+            const auto name = C3D::String::FromFormat("Texture.Name.That.Is.Quite.Long.{}", i);
+            const char* key = name.Data();
+
+            // The hash of a const char* must match the hash of the string with the same characters
+            ExpectEqual(std::hash<C3D::String>()(name), std::hash<C3D::String>()(key));
+            ExpectEqual(std::hash<C3D::CString<128>>()(key), std::hash<C3D::String>()(key));
+
+            ExpectTrue(stringMap.Has(key));
+            ExpectEqual(i, stringMap.Get(key));
+            ExpectEqual(i, *cStringMap.Find(key));
+        }
+
+        ExpectFalse(stringMap.Has("Texture.Name.That.Is.Quite.Long.100"));
+
+        stringMap.Delete("Texture.Name.That.Is.Quite.Long.42");
+        ExpectFalse(stringMap.Has("Texture.Name.That.Is.Quite.Long.42"));
+        ExpectEqual(99, stringMap.Count());
+    }
+
+    TEST(FlatHashMapShouldIterate)
+    {
+        C3D::FlatHashMap<C3D::String, u32> hashMap;
+        hashMap.Create();
+
+        // Enough items to span multiple groups
+        for (u32 i = 0; i < 100; ++i)
+        {
+            hashMap.Set(C3D::String::FromFormat("item{}", i), i);
+        }
+
+        C3D::DynamicArray<u32> seen(100);
+        for (u32 i = 0; i < 100; ++i) seen.PushBack(0);
+
+        for (auto it = hashMap.begin(); it != hashMap.end(); ++it)
+        {
+            const auto value = *it;
+            ExpectTrue(value < 100);
+            ExpectTrue(it.GetKey() == C3D::String::FromFormat("item{}", value));
+            seen[value]++;
+        }
+
+        // Every item should be seen exactly once
+        for (const auto count : seen)
+        {
+            ExpectEqual(1, count);
+        }
+    }
+
+    TEST(FlatHashMapShouldGrowWhenLoadFactorIsReached)
+    {
+        C3D::FlatHashMap<C3D::String, u32> hashMap;
+        hashMap.Create();
+
+        // Our default capacity of 32 with a load factor of 0.875 fits 28 items before we need to grow
+        for (u32 i = 0; i < 28; ++i)
+        {
+            hashMap.Insert(C3D::String::FromFormat("Test{}", i), i);
+        }
+        ExpectEqual(C3D::FLAT_HASH_MAP_DEFAULT_CAPACITY, hashMap.Capacity());
+
+        hashMap.Insert("Test28", 28);
+        ExpectEqual(C3D::FLAT_HASH_MAP_DEFAULT_CAPACITY * 2, hashMap.Capacity());
+
+        for (u32 i = 0; i < 29; ++i)
+        {
+            ExpectEqual(i, hashMap.Get(C3D::String::FromFormat("Test{}", i)));
+        }
+    }
+
+    TEST(FlatHashMapShouldNotGrowWhenReplacingDeletedElements)
+    {
+        C3D::FlatHashMap<u64, u64> hashMap;
+        hashMap.Create();
+
+        // Keep inserting and deleting so we fill up our map with deleted slots. These should be cleaned up without growing.
+        for (u64 i = 0; i < 10000; ++i)
+        {
+            hashMap.Insert(i, i * 2);
+            if (i >= 10) hashMap.Delete(i - 10);
+        }
+
+        ExpectEqual(10, hashMap.Count());
+        ExpectEqual(C3D::FLAT_HASH_MAP_DEFAULT_CAPACITY, hashMap.Capacity());
+
+        for (u64 i = 9990; i < 10000; ++i)
+        {
+            ExpectEqual(i * 2, hashMap.Get(i));
+        }
+    }
+
+    TEST(FlatHashMapShouldCopy)
+    {
+        C3D::FlatHashMap<C3D::String, u32> hashMap;
+        hashMap.Create();
+
+        for (u32 i = 0; i < 50; ++i) hashMap.Set(C3D::String::FromFormat("Copy{}", i), i);
+
+        C3D::FlatHashMap<C3D::String, u32> copy = hashMap;
+        hashMap.Destroy();
+
+        ExpectEqual(50, copy.Count());
+        for (u32 i = 0; i < 50; ++i)
+        {
+            ExpectEqual(i, copy.Get(C3D::String::FromFormat("Copy{}", i)));
+        }
+    }
+
+    TEST(FlatHashMapShouldNotLeakMemory)
+    {
+        using namespace C3D::Tests;
+
+        {
+            C3D::FlatHashMap<C3D::String, NonTrivialDestructorObject> hashMap;
+            hashMap.Create();
+
+            // Ensure that the HashMap must grow in size at least once and also delete some items
+            for (u32 i = 1; i <= 64; ++i)
+            {
+                auto obj = NonTrivialDestructorObject();
+                hashMap.Insert(C3D::String::FromFormat("test{}", i), obj);
+            }
+
+            for (u32 i = 1; i <= 64; i += 3)
+            {
+                hashMap.Delete(C3D::String::FromFormat("test{}", i));
+            }
+        }
+
+        // We expect all HashMap memory to be cleaned up
+        ExpectEqual(0, Metrics.GetMemoryUsage(C3D::MemoryType::HashMap));
+        // We also expect all internal Key (string) memory to be cleaned up
+        ExpectEqual(0, Metrics.GetMemoryUsage(C3D::MemoryType::String));
+        // and also our Value memory to be cleaned up
+        ExpectEqual(0, Metrics.GetMemoryUsage(C3D::MemoryType::Test));
+    }
+
+    TEST(FlatHashMapShouldMatchStdUnorderedMap)
+    {
+        C3D::FlatHashMap<u32, u32> hashMap;
+        hashMap.Create();
+
+        std::unordered_map<u32, u32> reference;
+
+        // Random inserts, overwrites and deletes on a small key range so we hit every path (including lots of deleted slots)
+        for (u32 i = 0; i < 50000; ++i)
+        {
+            const u32 key = C3D::Random.Generate(0, 2000);
+            if (C3D::Random.Generate(0, 2) == 0)
+            {
+                hashMap.Delete(key);
+                reference.erase(key);
+            }
+            else
+            {
+                hashMap.Insert(key, i);
+                reference[key] = i;
+            }
+        }
+
+        ExpectEqual(reference.size(), hashMap.Count());
+        for (u32 key = 0; key <= 2000; ++key)
+        {
+            const auto it    = reference.find(key);
+            const auto value = hashMap.Find(key);
+            ExpectEqual(it != reference.end(), value != nullptr);
+            if (value) ExpectEqual(it->second, *value);
+        }
+    }
+
+    TEST(FlatHashMapBenchmark)
+    {
+        constexpr u32 counts[] = { 100, 1000, 10000, 100000 };
+        constexpr u32 lookups  = 200000;
+
+        for (const auto count : counts)
+        {
+            C3D::DynamicArray<C3D::String> keys(count);
+            C3D::DynamicArray<C3D::String> missingKeys(count);
+            for (u32 i = 0; i < count; ++i)
+            {
+                // Names similar to the ones we use for our textures, materials and shaders
+                keys.PushBack(C3D::String::FromFormat("Resource.Name.{}.{}", C3D::Random.GenerateString(4, 12), i));
+                missingKeys.PushBack(C3D::String::FromFormat("Missing.Name.{}.{}", C3D::Random.GenerateString(4, 12), i));
+            }
+
+            C3D::HashMap<C3D::String, u32> robinHood;
+            C3D::FlatHashMap<C3D::String, u32> flat;
+            robinHood.Create();
+            flat.Create();
+
+            // Insertion
+            auto start = C3D::Platform::GetAbsoluteTime();
+            for (u32 i = 0; i < count; ++i) robinHood.Insert(keys[i], i);
+            const auto robinHoodInsert = C3D::Platform::GetAbsoluteTime() - start;
+
+            start = C3D::Platform::GetAbsoluteTime();
+            for (u32 i = 0; i < count; ++i) flat.Insert(keys[i], i);
+            const auto flatInsert = C3D::Platform::GetAbsoluteTime() - start;
+
+            // Lookups of existing keys
+            u64 sum = 0;
+            start   = C3D::Platform::GetAbsoluteTime();
+            for (u32 i = 0; i < lookups; ++i) sum += robinHood.Get(keys[i % count]);
+            const auto robinHoodHit = C3D::Platform::GetAbsoluteTime() - start;
+
+            start = C3D::Platform::GetAbsoluteTime();
+            for (u32 i = 0; i < lookups; ++i) sum -= flat.Get(keys[i % count]);
+            const auto flatHit = C3D::Platform::GetAbsoluteTime() - start;
+            ExpectEqual(0, sum);
+
+            // Lookups of existing keys with a const char* (the old map has to construct a String for every lookup)
+            start = C3D::Platform::GetAbsoluteTime();
+            for (u32 i = 0; i < lookups; ++i) sum += robinHood.Get(keys[i % count].Data());
+            const auto robinHoodCharHit = C3D::Platform::GetAbsoluteTime() - start;
+
+            start = C3D::Platform::GetAbsoluteTime();
+            for (u32 i = 0; i < lookups; ++i) sum -= flat.Get(keys[i % count].Data());
+            const auto flatCharHit = C3D::Platform::GetAbsoluteTime() - start;
+            ExpectEqual(0, sum);
+
+            // Lookups of keys that do not exist
+            u32 found = 0;
+            start     = C3D::Platform::GetAbsoluteTime();
+            for (u32 i = 0; i < lookups; ++i) found += robinHood.Has(missingKeys[i % count]);
+            const auto robinHoodMiss = C3D::Platform::GetAbsoluteTime() - start;
+
+            start = C3D::Platform::GetAbsoluteTime();
+            for (u32 i = 0; i < lookups; ++i) found += flat.Has(missingKeys[i % count]);
+            const auto flatMiss = C3D::Platform::GetAbsoluteTime() - start;
+            ExpectEqual(0, found);
+
+            // Iteration
+            start = C3D::Platform::GetAbsoluteTime();
+            for (const auto value : robinHood) sum += value;
+            const auto robinHoodIterate = C3D::Platform::GetAbsoluteTime() - start;
+
+            start = C3D::Platform::GetAbsoluteTime();
+            for (const auto value : flat) sum -= value;
+            const auto flatIterate = C3D::Platform::GetAbsoluteTime() - start;
+            ExpectEqual(0, sum);
+
+            constexpr auto ms = 1000.0;
+            C3D::Logger::Info("HashMap vs FlatHashMap with {:>6} items ({} lookups):", count, lookups);
+            C3D::Logger::Info("    Insert:       {:.3f}ms vs {:.3f}ms ({:.1f}x).", robinHoodInsert * ms, flatInsert * ms,
+                              robinHoodInsert / flatInsert);
+            C3D::Logger::Info("    Hit:          {:.3f}ms vs {:.3f}ms ({:.1f}x).", robinHoodHit * ms, flatHit * ms, robinHoodHit / flatHit);
+            C3D::Logger::Info("    Hit (char*):  {:.3f}ms vs {:.3f}ms ({:.1f}x).", robinHoodCharHit * ms, flatCharHit * ms,
+                              robinHoodCharHit / flatCharHit);
+            C3D::Logger::Info("    Miss:         {:.3f}ms vs {:.3f}ms ({:.1f}x).", robinHoodMiss * ms, flatMiss * ms,
+                              robinHoodMiss / flatMiss);
+            C3D::Logger::Info("    Iterate:      {:.3f}ms vs {:.3f}ms ({:.1f}x).", robinHoodIterate * ms, flatIterate * ms,
+                              robinHoodIterate / flatIterate);
+
+            robinHood.Destroy();
+            flat.Destroy();
+            keys.Destroy();
+            missingKeys.Destroy();
+        }
+    }
+
+    void RegisterTests(TestManager& manager)
+    {
+        manager.StartType("FlatHashMap");
+
+        REGISTER_TEST(FlatHashMapShouldCreateAndDestroy, "FlatHashMap should create and destroy correctly.");
+        REGISTER_TEST(FlatHashMapShouldSetGetAndFind, "You should be able to set an entry by key and get or find it with the same key.");
+        REGISTER_TEST(FlatHashMapShouldSupportHeterogeneousLookup, "String keys should be able to be found with a const char*.");
+        REGISTER_TEST(FlatHashMapShouldIterate, "You should be able to iterate over all existing elements exactly once.");
+        REGISTER_TEST(FlatHashMapShouldGrowWhenLoadFactorIsReached, "A FlatHashMap should grow when it reaches the load factor.");
+        REGISTER_TEST(FlatHashMapShouldNotGrowWhenReplacingDeletedElements,
+                      "A FlatHashMap should clean up deleted slots instead of growing when the number of elements stays the same.");
+        REGISTER_TEST(FlatHashMapShouldCopy, "A copied FlatHashMap should contain all elements of the original.");
+        REGISTER_TEST(FlatHashMapShouldNotLeakMemory, "The FlatHashMap should not leak memory.");
+        REGISTER_TEST(FlatHashMapShouldMatchStdUnorderedMap,
+                      "Random inserts and deletes should give the same result as std::unordered_map.");
+        REGISTER_BENCHMARK(FlatHashMapBenchmark, "Benchmark the FlatHashMap against the Robin Hood HashMap.");
+    }
+}  // namespace FlatHashMap
@@ -0,0 +1,365 @@
+#include "cson_binary_tests.h"
+
+#include <containers/dynamic_array.h>
+#include <cson/cson_binary.h>
+#include <cson/cson_binary_reader.h>
+#include <cson/cson_reader.h>
+#include <cson/cson_writer.h>
+#include <logger/logger.h>
+#include <platform/platform.h>
+#include <string/string.h>
+
+#include <cstring>
+
+#include "../expect.h"
+
+namespace CSONBinary
+{
+    /** @brief The reader expects 8 byte aligned data so we copy the written bytes into a buffer of u64s. */
+    C3D::DynamicArray<u64> MakeAligned(const C3D::DynamicArray<u8>& bytes)
+    {
+        C3D::DynamicArray<u64> aligned;
+        aligned.Resize((bytes.Size() + sizeof(u64) - 1) / sizeof(u64));
+        std::memcpy(aligned.GetData(), bytes.GetData(), bytes.Size());
+        return aligned;
+    }
+
+    bool Open(C3D::CSONBinaryReader& reader, const C3D::DynamicArray<u64>& aligned, const u64 size)
+    {
+        return reader.Open(reinterpret_cast<const u8*>(aligned.GetData()), size);
+    }
+
+    C3D::CSONObject CreateTestObject()
+    {
+        C3D::CSONObject object(C3D::CSONObjectType::Object);
+        object.properties.EmplaceBack("name", C3D::String("test_scene"));
+        object.properties.EmplaceBack("description", C3D::String("A description that does not fit in the small string buffer."));
+        object.properties.EmplaceBack("version", 3);
+        object.properties.EmplaceBack("offset", -42);
+        object.properties.EmplaceBack("scale", 0.25);
+        object.properties.EmplaceBack("enabled", true);
+        object.properties.EmplaceBack("hidden", false);
+        object.properties.EmplaceBack("empty", C3D::String(""));
+        object.properties.EmplaceBack("color", vec4(0.1f, 0.2f, 0.3f, 1.0f));
+
+        C3D::CSONObject nested(C3D::CSONObjectType::Object);
+        nested.properties.EmplaceBack("name", C3D::String("child"));
+        nested.properties.EmplaceBack("parent", C3D::String("test_scene"));
+
+        C3D::CSONArray children(C3D::CSONObjectType::Array);
+        children.properties.EmplaceBack(nested);
+        children.properties.EmplaceBack(nested);
+        object.properties.EmplaceBack("children", children);
+
+        C3D::CSONArray empty(C3D::CSONObjectType::Array);
+        object.properties.EmplaceBack("emptyArray", empty);
+        return object;
+    }
+
+    C3D::CSONObject GenerateScene(const u32 meshCount)
+    {
+        C3D::CSONObject scene(C3D::CSONObjectType::Object);
+        scene.properties.EmplaceBack("name", C3D::String("generated_scene"));
+        scene.properties.EmplaceBack("description", C3D::String("A large generated scene used for benchmarking."));
+
+        C3D::CSONArray meshes(C3D::CSONObjectType::Array);
+        meshes.properties.Reserve(meshCount);
+        for (u32 i = 0; i < meshCount; ++i)
+        {
+            C3D::CSONObject mesh(C3D::CSONObjectType::Object);
+            mesh.properties.EmplaceBack("name", C3D::String::FromFormat("generated_mesh_{}", i));
+            mesh.properties.EmplaceBack("resourceName", C3D::String::FromFormat("Models/Generated_{}", i % 16));
+            if (i > 0) mesh.properties.EmplaceBack("parent", C3D::String::FromFormat("generated_mesh_{}", i - 1));
+            mesh.properties.EmplaceBack("castsShadows", i % 2 == 0);
+            mesh.properties.EmplaceBack("lod", i % 4);
+
+            C3D::CSONArray transform(C3D::CSONObjectType::Array);
+            for (u32 j = 0; j < 10; ++j) transform.properties.EmplaceBack(static_cast<f64>(i) + j * 0.5 + 0.25);
+            mesh.properties.EmplaceBack("transform", transform);
+
+            meshes.properties.EmplaceBack(mesh);
+        }
+        scene.properties.EmplaceBack("meshes", meshes);
+        return scene;
+    }
+
+    /** @brief Sums all the transform values of the meshes in a generated scene (to make sure all data is actually read). */
+    f64 SumTransforms(const C3D::CSONObject& scene)
+    {
+        f64 sum = 0;
+        for (const auto& prop : scene.properties)
+        {
+            if (!prop.name.IEquals("meshes")) continue;
+
+            for (const auto& mesh : prop.GetArray().properties)
+            {
+                for (const auto& meshProp : mesh.GetObject().properties)
+                {
+                    if (meshProp.name.IEquals("transform"))
+                    {
+                        for (const auto& value : meshProp.GetArray().properties) sum += value.GetF64();
+                    }
+                    else if (meshProp.name.IEquals("name"))
+                    {
+                        sum += meshProp.GetString().Size();
+                    }
+                }
+            }
+        }
+        return sum;
+    }
+
+    f64 SumTransforms(const C3D::CSONObjectView& scene)
+    {
+        f64 sum = 0;
+        for (const auto prop : scene)
+        {
+            if (!prop.GetName().IEquals("meshes")) continue;
+
+            for (const auto mesh : prop.GetArray())
+            {
+                for (const auto meshProp : mesh.GetObject())
+                {
+                    if (meshProp.GetName().IEquals("transform"))
+                    {
+                        for (const auto value : meshProp.GetArray()) sum += value.GetF64();
+                    }
+                    else if (meshProp.GetName().IEquals("name"))
+                    {
+                        sum += meshProp.GetString().Size();
+                    }
+                }
+            }
+        }
+        return sum;
+    }
+
+    TEST(BinaryCSONShouldRoundTripObjects)
+    {
+        const auto object = CreateTestObject();
+
+        C3D::CSONWriter writer;
+        C3D::DynamicArray<u8> bytes;
+        writer.WriteBinary(object, bytes);
+
+        const auto aligned = MakeAligned(bytes);
+        C3D::CSONBinaryReader reader;
+        ExpectTrue(Open(reader, aligned, bytes.Size()));
+
+        const auto root = reader.GetRoot();
+        ExpectTrue(root.IsValid());
+        ExpectFalse(root.IsArray());
+        ExpectEqual(object.properties.Size(), root.Size());
+
+        ExpectTrue(root[0].GetName() == "name");
+        ExpectTrue(root[0].GetString() == "test_scene");
+        ExpectTrue(root[1].GetString() == "A description that does not fit in the small string buffer.");
+        ExpectEqual(3, root[2].GetI64());
+        ExpectEqual(-42, root[3].GetI64());
+        ExpectFloatEqual(0.25, root[4].GetF64());
+        ExpectTrue(root[5].GetBool());
+        ExpectFalse(root[6].GetBool());
+        ExpectTrue(root[7].GetString().Empty());
+
+        const auto children = root[9].GetArray();
+        ExpectTrue(children.IsArray());
+        ExpectEqual(2, children.Size());
+        ExpectTrue(children[1].GetName().Empty());
+        ExpectTrue(children[1].GetObject()[1].GetString() == "test_scene");
+        ExpectTrue(root[10].GetArray().IsEmpty());
+
+        // Converting back into a CSONObject should give us exactly the same object
+        C3D::String expected, actual;
+        writer.Write(object, expected);
+        writer.Write(root.ToObject(), actual);
+        ExpectEqual(expected, actual);
+    }
+
+    TEST(BinaryCSONShouldFindProperties)
+    {
+        C3D::CSONWriter writer;
+        C3D::DynamicArray<u8> bytes;
+        writer.WriteBinary(CreateTestObject(), bytes);
+
+        const auto aligned = MakeAligned(bytes);
+        C3D::CSONBinaryReader reader;
+        ExpectTrue(Open(reader, aligned, bytes.Size()));
+
+        const auto root = reader.GetRoot();
+        ExpectTrue(root.Has("enabled"));
+        ExpectFalse(root.Has("enable"));
+        ExpectFalse(root.Has("enabledd"));
+
+        C3D::CSONPropertyView color;
+        ExpectTrue(root.Find("color", color));
+        const auto c = color.GetVec4();
+        ExpectFloatEqual(0.1f, c.x);
+        ExpectFloatEqual(0.2f, c.y);
+        ExpectFloatEqual(0.3f, c.z);
+        ExpectFloatEqual(1.0f, c.w);
+
+        C3D::CSONPropertyView missing;
+        ExpectFalse(root.Find("missing", missing));
+        ExpectFalse(missing.IsValid());
+    }
+
+    TEST(BinaryCSONShouldStoreEveryStringOnce)
+    {
+        C3D::CSONWriter writer;
+        C3D::DynamicArray<u8> bytes;
+        writer.WriteBinary(CreateTestObject(), bytes);
+
+        C3D::CSONBinaryHeader header;
+        std::memcpy(&header, bytes.GetData(), sizeof(C3D::CSONBinaryHeader));
+        ExpectEqual(bytes.Size(), header.size);
+
+        // 11 unique names in the root, "parent" in the child objects and 4 unique string values (including the empty string)
+        ExpectEqual(16, header.stringCount);
+
+        const auto aligned = MakeAligned(bytes);
+        C3D::CSONBinaryReader reader;
+        ExpectTrue(Open(reader, aligned, bytes.Size()));
+
+        // Both the name of the scene and the parent of the children point to the same characters
+        const auto root = reader.GetRoot();
+        const auto child = root[9].GetArray()[0].GetObject();
+        ExpectTrue(root[0].GetString().Data() == child[1].GetString().Data());
+        ExpectTrue(root[0].GetName().Data() == child[0].GetName().Data());
+    }
+
+    TEST(BinaryCSONShouldSupportRootArrays)
+    {
+        C3D::CSONArray array(C3D::CSONObjectType::Array);
+        array.properties.EmplaceBack(1);
+        array.properties.EmplaceBack(2.5);
+        array.properties.EmplaceBack(C3D::String("three"));
+
+        C3D::CSONWriter writer;
+        C3D::DynamicArray<u8> bytes;
+        writer.WriteBinary(array, bytes);
+
+        const auto aligned = MakeAligned(bytes);
+        C3D::CSONBinaryReader reader;
+        ExpectTrue(Open(reader, aligned, bytes.Size()));
+
+        const auto root = reader.GetRoot();
+        ExpectTrue(root.IsArray());
+        ExpectEqual(3, root.Size());
+        ExpectEqual(1, root[0].GetI64());
+        ExpectFloatEqual(2.5, root[1].GetF64());
+        ExpectTrue(root[2].GetString() == "three");
+    }
+
+    TEST(BinaryCSONReaderShouldRejectInvalidData)
+    {
+        C3D::CSONWriter writer;
+        C3D::DynamicArray<u8> bytes;
+        writer.WriteBinary(CreateTestObject(), bytes);
+
+        C3D::CSONBinaryReader reader;
+
+        // Text CSON is not binary CSON
+        constexpr auto text = "{ \"name\": \"test\" }";
+        ExpectFalse(C3D::CSONBinaryReader::IsBinary(reinterpret_cast<const u8*>(text), std::strlen(text)));
+
+        // Truncated data
+        auto aligned = MakeAligned(bytes);
+        ExpectFalse(Open(reader, aligned, bytes.Size() - 8));
+        ExpectFalse(reader.GetRoot().IsValid());
+
+        // Wrong version
+        C3D::CSONBinaryHeader header;
+        std::memcpy(&header, bytes.GetData(), sizeof(C3D::CSONBinaryHeader));
+        header.version = C3D::CSON_BINARY_VERSION + 1;
+        std::memcpy(aligned.GetData(), &header, sizeof(C3D::CSONBinaryHeader));
+        ExpectFalse(Open(reader, aligned, bytes.Size()));
+
+        // Root offset outside of the data
+        header.version = C3D::CSON_BINARY_VERSION;
+        header.root    = static_cast<u32>(bytes.Size());
+        std::memcpy(aligned.GetData(), &header, sizeof(C3D::CSONBinaryHeader));
+        ExpectFalse(Open(reader, aligned, bytes.Size()));
+
+        // Property pointing to an object outside of the data
+        aligned = MakeAligned(bytes);
+        std::memcpy(&header, bytes.GetData(), sizeof(C3D::CSONBinaryHeader));
+        const auto children = reinterpret_cast<u8*>(aligned.GetData()) + header.root + sizeof(C3D::CSONBinaryObject) +
+                              9 * sizeof(C3D::CSONBinaryProperty);
+        const u64 invalidOffset = bytes.Size() + 64;
+        std::memcpy(children + offsetof(C3D::CSONBinaryProperty, value), &invalidOffset, sizeof(u64));
+        ExpectFalse(Open(reader, aligned, bytes.Size()));
+
+        // The original data should still be valid
+        aligned = MakeAligned(bytes);
+        ExpectTrue(Open(reader, aligned, bytes.Size()));
+    }
+
+    TEST(BinaryCSONShouldRoundTripThroughFiles)
+    {
+        const auto object = CreateTestObject();
+
+        C3D::CSONWriter writer;
+        ExpectTrue(writer.WriteBinaryToFile(object, "binary_round_trip.csonb"));
+
+        // Mapping the file and reading in place
+        C3D::CSONBinaryReader binaryReader;
+        ExpectTrue(binaryReader.Open("binary_round_trip.csonb"));
+        ExpectTrue(binaryReader.GetRoot()[0].GetString() == "test_scene");
+
+        // The regular reader should detect that the file is binary
+        C3D::CSONReader reader;
+        const auto read = reader.ReadFromFile("binary_round_trip.csonb");
+
+        C3D::String expected, actual;
+        writer.Write(object, expected);
+        writer.Write(read, actual);
+        ExpectEqual(expected, actual);
+    }
+
+    TEST(BinaryCSONParseBenchmark)
+    {
+        constexpr u32 meshCount = 20000;
+
+        const auto scene = GenerateScene(meshCount);
+        const auto sum   = SumTransforms(scene);
+
+        C3D::CSONWriter writer;
+        ExpectTrue(writer.WriteToFile(scene, "generated_scene.cson"));
+        ExpectTrue(writer.WriteBinaryToFile(scene, "generated_scene.csonb"));
+
+        // Parsing the text version into a CSONObject
+        C3D::CSONReader reader;
+        auto start      = C3D::Platform::GetAbsoluteTime();
+        const auto text = reader.ReadFromFile("generated_scene.cson");
+        ExpectFloatEqual(sum, SumTransforms(text));
+        const auto textTime = C3D::Platform::GetAbsoluteTime() - start;
+
+        // Mapping the binary version and reading everything in place
+        start = C3D::Platform::GetAbsoluteTime();
+        C3D::CSONBinaryReader binaryReader;
+        ExpectTrue(binaryReader.Open("generated_scene.csonb"));
+        ExpectFloatEqual(sum, SumTransforms(binaryReader.GetRoot()));
+        const auto viewTime = C3D::Platform::GetAbsoluteTime() - start;
+
+        // Reading the binary version into a CSONObject (for code that still needs one)
+        start             = C3D::Platform::GetAbsoluteTime();
+        const auto binary = reader.ReadFromFile("generated_scene.csonb");
+        ExpectFloatEqual(sum, SumTransforms(binary));
+        const auto objectTime = C3D::Platform::GetAbsoluteTime() - start;
+
+        C3D::Logger::Info("Scene with {} meshes: text {:.3f}ms, binary views {:.3f}ms ({:.1f}x faster), binary to CSONObject {:.3f}ms.",
+                          meshCount, textTime * 1000.0, viewTime * 1000.0, textTime / viewTime, objectTime * 1000.0);
+    }
+
+    void RegisterTests(TestManager& manager)
+    {
+        manager.StartType("CSONBinary");
+        REGISTER_TEST(BinaryCSONShouldRoundTripObjects, "Objects written as binary CSON should be read back the same.");
+        REGISTER_TEST(BinaryCSONShouldFindProperties, "Binary CSON object views should find properties by name.");
+        REGISTER_TEST(BinaryCSONShouldStoreEveryStringOnce, "Binary CSON should store every unique string only once.");
+        REGISTER_TEST(BinaryCSONShouldSupportRootArrays, "Binary CSON should support arrays as the root.");
+        REGISTER_TEST(BinaryCSONReaderShouldRejectInvalidData, "The binary CSON reader should reject invalid or corrupted data.");
+        REGISTER_TEST(BinaryCSONShouldRoundTripThroughFiles, "Binary CSON files should be readable by both readers.");
+        REGISTER_BENCHMARK(BinaryCSONParseBenchmark, "Benchmark reading a large scene as text CSON against binary CSON.");
+    }
+}  // namespace CSONBinary
\ No newline at end of file
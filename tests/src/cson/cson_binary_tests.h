@@ -0,0 +1,7 @@
+#pragma once
+#include "../test_manager.h"
+
+namespace CSONBinary
+{
+    void RegisterTests(TestManager& manager);
+}
\ No newline at end of file
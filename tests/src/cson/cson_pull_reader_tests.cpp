@@ -0,0 +1,352 @@
+#include "cson_pull_reader_tests.h"
+
+#include <containers/dynamic_array.h>
+#include <cson/cson_binary_reader.h>
+#include <cson/cson_pull_reader.h>
+#include <cson/cson_reader.h>
+#include <cson/cson_writer.h>
+#include <logger/logger.h>
+#include <platform/platform.h>
+#include <string/string.h>
+
+#include <cstring>
+
+#include "../expect.h"
+
+namespace CSONPullReader
+{
+    using C3D::CSONEventType;
+
+    constexpr auto testInput =
+        "# A comment before the root object\r\n"
+        "{\r\n"
+        "\t\"name\": \"test\",  # A comment after a value\n"
+        "    \"count\": -12,\n"
+        "    \"scale\": 2.5,\n"
+        "    \"visible\": True,\n"
+        "    \"color\": [ 0.5, 1, -0.25, 1.0 ],\n"
+        "    \"child\": { \"empty\": {}, \"list\": [] },\n"
+        "    \"objects\": [\n"
+        "        { \"id\": 1 },\n"
+        "        { \"id\": 2 },\n"
+        "    ],\n"
+        "}\n";
+
+    void ExpectEvent(C3D::CSONPullReader& reader, const CSONEventType type, const char* name = "")
+    {
+        C3D::CSONEvent event;
+        reader.Next(event);
+        ExpectTrue(event.type == type);
+        ExpectTrue(event.name == name);
+    }
+
+    TEST(PullReaderShouldReadAllEventsInOrder)
+    {
+        C3D::CSONPullReader reader(testInput, std::strlen(testInput));
+        C3D::CSONEvent event;
+
+        ExpectEvent(reader, CSONEventType::StartObject);
+
+        ExpectTrue(reader.Next(event));
+        ExpectTrue(event.type == CSONEventType::String);
+        ExpectTrue(event.name == "name");
+        ExpectTrue(event.GetString() == "test");
+
+        ExpectTrue(reader.Next(event));
+        ExpectTrue(event.name == "count");
+        ExpectEqual(-12, event.GetI64());
+
+        ExpectTrue(reader.Next(event));
+        ExpectTrue(event.type == CSONEventType::F64);
+        ExpectFloatEqual(2.5, event.GetF64());
+
+        ExpectTrue(reader.Next(event));
+        ExpectTrue(event.name == "visible");
+        ExpectTrue(event.GetBool());
+
+        ExpectTrue(reader.Next(event));
+        ExpectTrue(event.IsArray());
+        ExpectEqual(2, reader.GetDepth());
+        ExpectTrue(reader.Next(event));
+        ExpectFloatEqual(0.5, event.GetF64());
+        ExpectTrue(reader.Next(event));
+        // Whole numbers are integers but can be read as floats
+        ExpectTrue(event.type == CSONEventType::I64);
+        ExpectFloatEqual(1.0, event.GetF64());
+        ExpectTrue(reader.Next(event));
+        ExpectFloatEqual(-0.25, event.GetF64());
+        ExpectTrue(reader.Next(event));
+        ExpectFloatEqual(1.0, event.GetF64());
+        ExpectEvent(reader, CSONEventType::EndArray);
+
+        ExpectEvent(reader, CSONEventType::StartObject, "child");
+        ExpectEvent(reader, CSONEventType::StartObject, "empty");
+        ExpectEvent(reader, CSONEventType::EndObject);
+        ExpectEvent(reader, CSONEventType::StartArray, "list");
+        ExpectEvent(reader, CSONEventType::EndArray);
+        ExpectEvent(reader, CSONEventType::EndObject);
+
+        // Trailing commas are allowed
+        ExpectEvent(reader, CSONEventType::StartArray, "objects");
+        ExpectEvent(reader, CSONEventType::StartObject);
+        ExpectEvent(reader, CSONEventType::I64, "id");
+        ExpectEvent(reader, CSONEventType::EndObject);
+        ExpectEvent(reader, CSONEventType::StartObject);
+        ExpectEvent(reader, CSONEventType::I64, "id");
+        ExpectEvent(reader, CSONEventType::EndObject);
+        ExpectEvent(reader, CSONEventType::EndArray);
+
+        ExpectEvent(reader, CSONEventType::EndObject);
+        ExpectEqual(0, reader.GetDepth());
+
+        ExpectFalse(reader.Next(event));
+        ExpectTrue(event.type == CSONEventType::EndOfFile);
+        ExpectFalse(reader.HasError());
+        ExpectEqual(14, reader.GetLine());
+    }
+
+    TEST(PullReaderShouldSkipObjectsAndReadMembers)
+    {
+        C3D::CSONPullReader reader(testInput, std::strlen(testInput));
+        C3D::CSONEvent event;
+        ExpectTrue(reader.Next(event));
+
+        vec4 color;
+        i64 idSum = 0;
+
+        while (reader.NextMember(event))
+        {
+            if (event.name.IEquals("COLOR"))
+            {
+                ExpectTrue(reader.ReadVec4(event, color));
+            }
+            else if (event.name == "objects")
+            {
+                C3D::CSONEvent object;
+                while (reader.NextMember(object))
+                {
+                    C3D::CSONEvent prop;
+                    while (reader.NextMember(prop)) idSum += prop.GetI64();
+                }
+            }
+            else
+            {
+                ExpectTrue(reader.Skip(event));
+            }
+        }
+
+        ExpectFalse(reader.HasError());
+        ExpectEqual(0, reader.GetDepth());
+        ExpectFloatEqual(0.5f, color.x);
+        ExpectFloatEqual(1.0f, color.y);
+        ExpectFloatEqual(-0.25f, color.z);
+        ExpectFloatEqual(1.0f, color.w);
+        ExpectEqual(3, idSum);
+    }
+
+    TEST(PullReaderReadF32ArrayShouldRejectWrongArrays)
+    {
+        constexpr auto input = "{ \"short\": [ 1, 2, 3 ], \"strings\": [ 1, \"2\", 3, 4 ], \"value\": 5, \"last\": true }";
+
+        C3D::CSONPullReader reader(input, std::strlen(input));
+        C3D::CSONEvent event;
+        ExpectTrue(reader.Next(event));
+
+        vec4 value;
+        ExpectTrue(reader.NextMember(event));
+        ExpectFalse(reader.ReadVec4(event, value));
+        ExpectTrue(reader.NextMember(event));
+        ExpectFalse(reader.ReadVec4(event, value));
+        ExpectTrue(reader.NextMember(event));
+        ExpectFalse(reader.ReadVec4(event, value));
+
+        // The reader should still be at the right place after failing to read the arrays
+        ExpectTrue(reader.NextMember(event));
+        ExpectTrue(event.name == "last");
+        ExpectFalse(reader.NextMember(event));
+        ExpectFalse(reader.HasError());
+    }
+
+    TEST(PullReaderShouldReportErrors)
+    {
+        const char* invalidInputs[] = {
+            "{ \"name\" \"missing colon\" }",
+            "{ \"name\": \"unterminated }",
+            "{ \"a\": 1 \"b\": 2 }",
+            "{ \"a\": 1 ]",
+            "{ \"a\": nope }",
+            "{ \"a\": 1 } trailing",
+            "{ \"a\": [ 1, 2 }",
+            "{ \"a\": 1.2.3 }",
+            "{ \"a\": 1",
+            "\"root\"",
+        };
+
+        for (const auto input : invalidInputs)
+        {
+            C3D::CSONPullReader reader(input, std::strlen(input));
+            ExpectFalse(reader.Visit([](const C3D::CSONEvent&) { return true; }));
+            ExpectTrue(reader.HasError());
+
+            // Once an error occurred the reader should only return errors
+            C3D::CSONEvent event;
+            ExpectFalse(reader.Next(event));
+            ExpectTrue(event.type == CSONEventType::Error);
+        }
+
+        // Errors should report the line they occurred on (also after long runs of whitespace that are skipped with SIMD)
+        const auto input = C3D::String("{\n") + C3D::String::Repeat(' ', 40) + "\n\n" + C3D::String::Repeat(' ', 40) + "\n  \"a\" 1 }";
+        C3D::CSONPullReader reader(input);
+        ExpectFalse(reader.Visit([](const C3D::CSONEvent&) { return true; }));
+        ExpectEqual(5, reader.GetLine());
+    }
+
+    TEST(PullReaderShouldReadBinaryCSON)
+    {
+        C3D::CSONReader textReader;
+        const auto object = textReader.Read(testInput);
+
+        C3D::CSONWriter writer;
+        C3D::DynamicArray<u8> bytes;
+        writer.WriteBinary(object, bytes);
+
+        C3D::DynamicArray<u64> aligned;
+        aligned.Resize((bytes.Size() + 7) / 8);
+        std::memcpy(aligned.GetData(), bytes.GetData(), bytes.Size());
+
+        C3D::CSONBinaryReader binaryReader;
+        ExpectTrue(binaryReader.Open(reinterpret_cast<const u8*>(aligned.GetData()), bytes.Size()));
+
+        // Reading the binary data should produce exactly the same events as reading the text
+        C3D::CSONPullReader text(testInput, std::strlen(testInput));
+        C3D::CSONPullReader binary(binaryReader.GetRoot());
+
+        C3D::CSONEvent expected, actual;
+        u32 count = 0;
+        while (text.Next(expected))
+        {
+            ExpectTrue(binary.Next(actual));
+            ExpectTrue(expected.type == actual.type);
+            ExpectTrue(expected.name == actual.name.ToString().Data());
+            if (expected.type == CSONEventType::String) ExpectTrue(expected.GetString() == actual.GetString().Data());
+            if (expected.IsNumber()) ExpectFloatEqual(expected.GetF64(), actual.GetF64());
+            count++;
+        }
+        ExpectFalse(binary.Next(actual));
+        ExpectTrue(actual.type == CSONEventType::EndOfFile);
+        ExpectEqual(26, count);
+    }
+
+    TEST(CSONReaderShouldBuildObjectsInASinglePass)
+    {
+        C3D::CSONReader reader;
+        const auto object = reader.Read(testInput);
+
+        ExpectTrue(object.type == C3D::CSONObjectType::Object);
+        ExpectEqual(7, object.properties.Size());
+        ExpectEqual(C3D::String("test"), object.properties[0].GetString());
+        ExpectEqual(-12, object.properties[1].GetI64());
+        ExpectFloatEqual(2.5, object.properties[2].GetF64());
+        ExpectTrue(object.properties[3].GetBool());
+
+        const auto& color = object.properties[4].GetArray();
+        ExpectTrue(color.type == C3D::CSONObjectType::Array);
+        ExpectEqual(4, color.properties.Size());
+        ExpectTrue(color.properties[0].name.Empty());
+
+        const auto& child = object.properties[5].GetObject();
+        ExpectEqual(C3D::String("child"), object.properties[5].name);
+        ExpectTrue(child.properties[0].GetObject().IsEmpty());
+        ExpectTrue(child.properties[1].GetArray().IsEmpty());
+
+        const auto& objects = object.properties[6].GetArray();
+        ExpectEqual(2, objects.properties.Size());
+        ExpectEqual(2, objects.properties[1].GetObject().properties[0].GetI64());
+
+        // Arrays are supported as the root
+        const auto array = reader.Read("[ 1, \"two\", [ 3 ] ]");
+        ExpectTrue(array.type == C3D::CSONObjectType::Array);
+        ExpectEqual(3, array.properties.Size());
+        ExpectEqual(3, array.properties[2].GetArray().properties[0].GetI64());
+    }
+
+    TEST(PullReaderParseBenchmark)
+    {
+        constexpr u32 meshCount = 20000;
+
+        // Generate a large scene in the same format that the SceneManager reads
+        C3D::String input = "{\n    \"name\": \"generated_scene\",\n    \"meshes\": [\n";
+        for (u32 i = 0; i < meshCount; ++i)
+        {
+            input += C3D::String::FromFormat(
+                "        {{\n            \"name\": \"generated_mesh_{}\",\n            \"resourceName\": \"Models/Generated_{}\",\n"
+                "            \"transform\": [ {}.25, 1.5, -2.75, 0, 0, 0, 1, 1, 1, 1 ]\n        }},\n",
+                i, i % 16, i);
+        }
+        input += "    ]\n}\n";
+
+        // Building the CSONObject tree
+        C3D::CSONReader reader;
+        auto start        = C3D::Platform::GetAbsoluteTime();
+        const auto object = reader.Read(input);
+        f64 treeSum       = 0;
+        for (const auto& mesh : object.properties[1].GetArray().properties)
+        {
+            treeSum += mesh.GetObject().properties[2].GetArray().properties[0].GetF64();
+        }
+        const auto treeTime = C3D::Platform::GetAbsoluteTime() - start;
+
+        // Pulling the values directly from the input
+        start          = C3D::Platform::GetAbsoluteTime();
+        f64 pullSum    = 0;
+        u32 meshesRead = 0;
+
+        C3D::CSONPullReader pullReader(input);
+        C3D::CSONEvent event;
+        pullReader.Next(event);
+        while (pullReader.NextMember(event))
+        {
+            if (!event.name.IEquals("meshes"))
+            {
+                pullReader.Skip(event);
+                continue;
+            }
+
+            C3D::CSONEvent mesh;
+            while (pullReader.NextMember(mesh))
+            {
+                C3D::CSONEvent prop;
+                while (pullReader.NextMember(prop))
+                {
+                    if (prop.name.IEquals("transform"))
+                    {
+                        f32 transform[10];
+                        ExpectTrue(pullReader.ReadF32Array(prop, transform, 10));
+                        pullSum += transform[0];
+                    }
+                }
+                meshesRead++;
+            }
+        }
+        const auto pullTime = C3D::Platform::GetAbsoluteTime() - start;
+
+        ExpectFalse(pullReader.HasError());
+        ExpectEqual(meshCount, meshesRead);
+        ExpectFloatEqual(treeSum, pullSum);
+
+        C3D::Logger::Info("Scene with {} meshes ({:.2f} MB): CSONObject tree {:.3f}ms, pull reader {:.3f}ms ({:.1f}x faster).", meshCount,
+                          input.Size() / (1024.0 * 1024.0), treeTime * 1000.0, pullTime * 1000.0, treeTime / pullTime);
+    }
+
+    void RegisterTests(TestManager& manager)
+    {
+        manager.StartType("CSONPullReader");
+        REGISTER_TEST(PullReaderShouldReadAllEventsInOrder, "The pull reader should produce every event of the input in order.");
+        REGISTER_TEST(PullReaderShouldSkipObjectsAndReadMembers, "The pull reader should be able to skip values and read members.");
+        REGISTER_TEST(PullReaderReadF32ArrayShouldRejectWrongArrays, "ReadF32Array() should reject arrays with the wrong size or types.");
+        REGISTER_TEST(PullReaderShouldReportErrors, "The pull reader should report errors for invalid input.");
+        REGISTER_TEST(PullReaderShouldReadBinaryCSON, "The pull reader should produce the same events for binary CSON.");
+        REGISTER_TEST(CSONReaderShouldBuildObjectsInASinglePass, "The CSONReader should build correct objects using the pull reader.");
+        REGISTER_BENCHMARK(PullReaderParseBenchmark, "Benchmark pulling values from a large scene against building a CSONObject tree.");
+    }
+}  // namespace CSONPullReader
\ No newline at end of file
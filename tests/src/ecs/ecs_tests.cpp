@@ -0,0 +1,578 @@
+#include "ecs_tests.h"
+
+#include <cson/cson_types.h>
+#include <defines.h>
+#include <ecs/archetype_ecs.h>
+#include <ecs/archetype_view.h>
+#include <ecs/ecs.h>
+#include <ecs/entity_system.h>
+#include <ecs/entity_view.h>
+#include <frame_data.h>
+#include <logger/logger.h>
+#include <platform/platform.h>
+#include <string/string.h>
+#include <systems/jobs/job_system.h>
+
+#include <atomic>
+#include <thread>
+
+#include "../expect.h"
+
+namespace ECS
+{
+    struct Position
+    {
+        f32 x = 0.0f, y = 0.0f, z = 0.0f;
+
+        static C3D::ComponentID GetId() { return 0; }
+    };
+
+    struct Velocity
+    {
+        f32 x = 1.0f, y = 2.0f, z = 3.0f;
+
+        static C3D::ComponentID GetId() { return 1; }
+    };
+
+    struct Health
+    {
+        f32 value = 100.0f;
+
+        static C3D::ComponentID GetId() { return 2; }
+    };
+
+    static i32 NAME_COMPONENT_COUNTER = 0;
+
+    /** @brief A component with a non-trivial constructor, move and destructor that keeps track of the amount of live instances. */
+    struct Name
+    {
+        Name() { NAME_COMPONENT_COUNTER++; }
+        Name(Name&& other) noexcept : name(std::move(other.name)) { NAME_COMPONENT_COUNTER++; }
+        ~Name() { NAME_COMPONENT_COUNTER--; }
+
+        C3D::String name = "A name that is long enough to not fit in the small string buffer";
+
+        static C3D::ComponentID GetId() { return 3; }
+    };
+
+    static void CreateArchetypeECS(C3D::ArchetypeECS& ecs)
+    {
+        ecs.Create();
+        ecs.AddComponentType<Position>();
+        ecs.AddComponentType<Velocity>();
+        ecs.AddComponentType<Health>();
+        ecs.AddComponentType<Name>();
+    }
+
+    TEST(ArchetypeECSShouldAddAndGetComponents)
+    {
+        C3D::ArchetypeECS ecs;
+        CreateArchetypeECS(ecs);
+
+        auto entity = ecs.Register();
+        ExpectTrue(ecs.IsAlive(entity));
+        ExpectFalse(ecs.HasComponent<Position>(entity));
+
+        auto& position = ecs.AddComponent<Position>(entity);
+        position.x     = 5.0f;
+
+        ecs.AddComponent<Velocity>(entity);
+
+        ExpectTrue(ecs.HasComponent<Position>(entity));
+        ExpectTrue(ecs.HasComponent<Velocity>(entity));
+        ExpectFalse(ecs.HasComponent<Health>(entity));
+
+        // Adding velocity moves the entity to a different archetype so the position should have been moved along
+        ExpectEqual(5.0f, ecs.GetComponent<Position>(entity).x);
+        ExpectEqual(2.0f, ecs.GetComponent<Velocity>(entity).y);
+
+        // Empty, Position and Position + Velocity
+        ExpectEqual(3, ecs.GetArchetypeCount());
+
+        ecs.Destroy();
+    }
+
+    TEST(ArchetypeECSRemoveComponentShouldKeepOtherEntitiesIntact)
+    {
+        C3D::ArchetypeECS ecs;
+        CreateArchetypeECS(ecs);
+
+        constexpr u32 count = 5000;
+
+        C3D::DynamicArray<C3D::Entity> entities;
+        for (u32 i = 0; i < count; ++i)
+        {
+            auto entity                            = ecs.Register();
+            ecs.AddComponent<Position>(entity).x   = static_cast<f32>(i);
+            ecs.AddComponent<Health>(entity).value = static_cast<f32>(i * 2);
+            entities.PushBack(entity);
+        }
+
+        // Remove the health from every other entity (which moves entities around inside of the archetypes)
+        for (u32 i = 0; i < count; i += 2)
+        {
+            ecs.RemoveComponent<Health>(entities[i]);
+        }
+
+        for (u32 i = 0; i < count; ++i)
+        {
+            ExpectEqual(static_cast<f32>(i), ecs.GetComponent<Position>(entities[i]).x);
+            if (i % 2 == 0)
+            {
+                ExpectFalse(ecs.HasComponent<Health>(entities[i]));
+            }
+            else
+            {
+                ExpectEqual(static_cast<f32>(i * 2), ecs.GetComponent<Health>(entities[i]).value);
+            }
+        }
+
+        entities.Destroy();
+        ecs.Destroy();
+    }
+
+    TEST(ArchetypeECSDeactivateShouldInvalidateTheEntity)
+    {
+        C3D::ArchetypeECS ecs;
+        CreateArchetypeECS(ecs);
+
+        auto first  = ecs.Register();
+        auto second = ecs.Register();
+        ecs.AddComponent<Position>(first).x  = 1.0f;
+        ecs.AddComponent<Position>(second).x = 2.0f;
+
+        ExpectTrue(ecs.Deactivate(first));
+        ExpectFalse(ecs.IsAlive(first));
+        ExpectFalse(ecs.Deactivate(first));
+
+        // The second entity should have been moved into the location of the first entity
+        ExpectEqual(2.0f, ecs.GetComponent<Position>(second).x);
+
+        // Reusing the index should give us a new version of the entity
+        auto third = ecs.Register();
+        ExpectEqual(first.GetIndex(), third.GetIndex());
+        ExpectNotEqual(first.GetVersion(), third.GetVersion());
+        ExpectTrue(ecs.IsAlive(third));
+        ExpectFalse(ecs.IsAlive(first));
+        ExpectFalse(ecs.HasComponent<Position>(third));
+
+        ecs.Destroy();
+    }
+
+    TEST(ArchetypeECSShouldConstructAndDestroyComponents)
+    {
+        {
+            C3D::ArchetypeECS ecs;
+            CreateArchetypeECS(ecs);
+
+            C3D::DynamicArray<C3D::Entity> entities;
+            for (u32 i = 0; i < 100; ++i)
+            {
+                auto entity = ecs.Register();
+                ecs.AddComponent<Name>(entity);
+                entities.PushBack(entity);
+            }
+            ExpectEqual(100, NAME_COMPONENT_COUNTER);
+
+            // Moving between archetypes should not create or destroy any names
+            for (auto entity : entities)
+            {
+                ecs.AddComponent<Position>(entity);
+            }
+            ExpectEqual(100, NAME_COMPONENT_COUNTER);
+            ExpectTrue(ecs.GetComponent<Name>(entities[50]).name.StartsWith("A name"));
+
+            ecs.RemoveComponent<Name>(entities[0]);
+            ecs.Deactivate(entities[1]);
+            ExpectEqual(98, NAME_COMPONENT_COUNTER);
+
+            entities.Destroy();
+            ecs.Destroy();
+        }
+
+        ExpectEqual(0, NAME_COMPONENT_COUNTER);
+    }
+
+    TEST(ArchetypeViewShouldOnlyVisitMatchingEntities)
+    {
+        C3D::ArchetypeECS ecs;
+        CreateArchetypeECS(ecs);
+
+        for (u32 i = 0; i < 1000; ++i)
+        {
+            auto entity = ecs.Register();
+            ecs.AddComponent<Position>(entity);
+            if (i % 4 == 0) ecs.AddComponent<Velocity>(entity);
+            if (i % 3 == 0) ecs.AddComponent<Health>(entity);
+        }
+
+        C3D::ArchetypeView<Position, Velocity> view(ecs);
+        ExpectEqual(250, view.Count());
+
+        u64 visited = 0;
+        view.ForEachChunk([&visited](const C3D::EntityChunk<Position, Velocity>& chunk) {
+            auto positions  = chunk.Get<Position>();
+            auto velocities = chunk.Get<Velocity>();
+            for (u32 i = 0; i < chunk.Size(); ++i)
+            {
+                positions[i].x += velocities[i].x;
+            }
+            visited += chunk.Size();
+        });
+        ExpectEqual(250, visited);
+
+        u64 moved = 0;
+        view.ForEach([&moved](C3D::Entity, const Position& position, const Velocity&) {
+            if (position.x == 1.0f) moved++;
+        });
+        ExpectEqual(250, moved);
+
+        C3D::ArchetypeView<Position> positionView(ecs);
+        ExpectEqual(1000, positionView.Count());
+
+        ecs.Destroy();
+    }
+
+    static C3D::CSONObject MakeJobSystemConfig(u8 threadCount)
+    {
+        C3D::CSONObject config(C3D::CSONObjectType::Object);
+        config.properties.EmplaceBack("threadCount", static_cast<i64>(threadCount));
+        return config;
+    }
+
+    /** @brief A system that moves every entity with a Position by it's Velocity. */
+    class MovementSystem final : public C3D::EntitySystem
+    {
+    public:
+        MovementSystem() : EntitySystem("MovementSystem")
+        {
+            Reads<Velocity>();
+            Writes<Position>();
+        }
+
+        void OnUpdate(C3D::ArchetypeECS& ecs, C3D::JobSystem& jobs, const C3D::FrameData&) override
+        {
+            C3D::ArchetypeView<Position, Velocity> view(ecs);
+            view.ParallelForEachChunk(jobs, [](const C3D::EntityChunk<Position, Velocity>& chunk) {
+                auto positions  = chunk.Get<Position>();
+                auto velocities = chunk.Get<Velocity>();
+                for (u32 i = 0; i < chunk.Size(); ++i)
+                {
+                    positions[i].x += velocities[i].x;
+                }
+            });
+        }
+    };
+
+    /**
+     * @brief A system that signals it has started and then waits (with a timeout) until the other system has started as well.
+     * Both systems can only see eachother if they are running at the same time.
+     */
+    class RendezvousSystem final : public C3D::EntitySystem
+    {
+    public:
+        RendezvousSystem(std::atomic<u32>& started, bool writeHealth) : EntitySystem("RendezvousSystem"), m_started(started)
+        {
+            if (writeHealth)
+            {
+                Writes<Health>();
+            }
+            else
+            {
+                Reads<Velocity>();
+            }
+        }
+
+        void OnUpdate(C3D::ArchetypeECS&, C3D::JobSystem&, const C3D::FrameData&) override
+        {
+            m_started++;
+
+            const auto start = C3D::Platform::GetAbsoluteTime();
+            while (m_started < 2 && C3D::Platform::GetAbsoluteTime() - start < 5.0)
+            {
+                std::this_thread::yield();
+            }
+            sawOther = m_started >= 2;
+        }
+
+        bool sawOther = false;
+
+    private:
+        std::atomic<u32>& m_started;
+    };
+
+    /** @brief A system that writes Position and records the order in which it was run. */
+    class OrderSystem final : public C3D::EntitySystem
+    {
+    public:
+        OrderSystem(std::atomic<u32>& counter) : EntitySystem("OrderSystem"), m_counter(counter) { Writes<Position>(); }
+
+        void OnUpdate(C3D::ArchetypeECS&, C3D::JobSystem&, const C3D::FrameData&) override { order = m_counter++; }
+
+        u32 order = 0;
+
+    private:
+        std::atomic<u32>& m_counter;
+    };
+
+    TEST(EntitySystemsShouldDetectConflicts)
+    {
+        std::atomic<u32> started = 0;
+        std::atomic<u32> counter = 0;
+
+        MovementSystem movement;
+        RendezvousSystem healthWriter(started, true);
+        RendezvousSystem velocityReader(started, false);
+        OrderSystem positionWriter(counter);
+
+        // Writing a component conflicts with reading or writing the same component
+        ExpectTrue(movement.ConflictsWith(positionWriter));
+        ExpectTrue(positionWriter.ConflictsWith(movement));
+        // Reading the same component does not conflict
+        ExpectFalse(movement.ConflictsWith(velocityReader));
+        // Disjoint components do not conflict
+        ExpectFalse(movement.ConflictsWith(healthWriter));
+        ExpectFalse(healthWriter.ConflictsWith(velocityReader));
+
+        C3D::EntitySystemScheduler scheduler;
+        scheduler.AddSystem(&movement);
+        scheduler.AddSystem(&healthWriter);
+        scheduler.AddSystem(&positionWriter);
+        scheduler.AddSystem(&velocityReader);
+
+        ExpectEqual(2, scheduler.GetLevelCount());
+        ExpectEqual(0, scheduler.GetLevel(&movement));
+        ExpectEqual(0, scheduler.GetLevel(&healthWriter));
+        ExpectEqual(1, scheduler.GetLevel(&positionWriter));
+        ExpectEqual(0, scheduler.GetLevel(&velocityReader));
+
+        scheduler.Destroy();
+    }
+
+    TEST(EntitySystemSchedulerShouldRunNonConflictingSystemsConcurrently)
+    {
+        C3D::JobSystem jobs;
+        ExpectTrue(jobs.OnInit(MakeJobSystemConfig(4)));
+
+        C3D::ArchetypeECS ecs;
+        CreateArchetypeECS(ecs);
+
+        std::atomic<u32> started = 0;
+        RendezvousSystem first(started, true);
+        RendezvousSystem second(started, false);
+
+        C3D::EntitySystemScheduler scheduler;
+        scheduler.AddSystem(&first);
+        scheduler.AddSystem(&second);
+        ExpectEqual(1, scheduler.GetLevelCount());
+
+        C3D::FrameData frameData;
+        scheduler.Run(ecs, jobs, frameData);
+
+        ExpectTrue(first.sawOther);
+        ExpectTrue(second.sawOther);
+
+        scheduler.Destroy();
+        ecs.Destroy();
+        jobs.OnShutdown();
+    }
+
+    TEST(EntitySystemSchedulerShouldRunConflictingSystemsInOrder)
+    {
+        C3D::JobSystem jobs;
+        ExpectTrue(jobs.OnInit(MakeJobSystemConfig(4)));
+
+        C3D::ArchetypeECS ecs;
+        CreateArchetypeECS(ecs);
+
+        std::atomic<u32> counter = 0;
+        OrderSystem systems[4] = { OrderSystem(counter), OrderSystem(counter), OrderSystem(counter), OrderSystem(counter) };
+
+        C3D::EntitySystemScheduler scheduler;
+        for (auto& system : systems) scheduler.AddSystem(&system);
+        ExpectEqual(4, scheduler.GetLevelCount());
+
+        C3D::FrameData frameData;
+        for (u32 run = 0; run < 10; ++run)
+        {
+            counter = 0;
+            scheduler.Run(ecs, jobs, frameData);
+
+            for (u32 i = 0; i < 4; ++i)
+            {
+                ExpectEqual(i, systems[i].order);
+            }
+        }
+
+        scheduler.Destroy();
+        ecs.Destroy();
+        jobs.OnShutdown();
+    }
+
+    TEST(ArchetypeViewParallelForEachChunkShouldVisitEveryEntityOnce)
+    {
+        C3D::JobSystem jobs;
+        ExpectTrue(jobs.OnInit(MakeJobSystemConfig(4)));
+
+        C3D::ArchetypeECS ecs;
+        CreateArchetypeECS(ecs);
+
+        constexpr u32 entityCount = 50000;
+        for (u32 i = 0; i < entityCount; ++i)
+        {
+            auto entity = ecs.Register();
+            ecs.AddComponent<Position>(entity);
+            ecs.AddComponent<Velocity>(entity);
+            // Spread our entities over a couple of archetypes
+            if (i % 3 == 0) ecs.AddComponent<Health>(entity);
+        }
+
+        MovementSystem movement;
+        C3D::EntitySystemScheduler scheduler;
+        scheduler.AddSystem(&movement);
+
+        C3D::FrameData frameData;
+        scheduler.Run(ecs, jobs, frameData);
+        scheduler.Run(ecs, jobs, frameData);
+
+        // Every entity should have been moved exactly twice
+        u64 correct = 0;
+        C3D::ArchetypeView<Position, Velocity> view(ecs);
+        view.ForEach([&correct](C3D::Entity, const Position& position, const Velocity&) {
+            if (position.x == 2.0f) correct++;
+        });
+        ExpectEqual(entityCount, correct);
+
+        scheduler.Destroy();
+        ecs.Destroy();
+        jobs.OnShutdown();
+    }
+
+    TEST(ECSBenchmark)
+    {
+        constexpr u32 entityCounts[] = { 10000, 100000, 1000000 };
+        constexpr u32 iterations     = 10;
+
+        for (const auto count : entityCounts)
+        {
+            // The current ECS
+            {
+                C3D::ECS ecs;
+                const auto memorySize =
+                    std::max(MebiBytes(8), count * (sizeof(Position) + sizeof(Velocity) + sizeof(Health)) + MebiBytes(1));
+                ecs.Create(memorySize, 3, count);
+                ecs.AddComponentPool<Position>("Position");
+                ecs.AddComponentPool<Velocity>("Velocity");
+                ecs.AddComponentPool<Health>("Health");
+
+                C3D::DynamicArray<C3D::Entity> entities;
+                entities.Reserve(count);
+
+                for (u32 i = 0; i < count; ++i)
+                {
+                    auto entity = ecs.Register();
+                    ecs.AddComponent<Position>(entity);
+                    // Only half of our entities move
+                    if (i % 2 == 0) ecs.AddComponent<Velocity>(entity);
+                    entities.PushBack(entity);
+                }
+
+                auto start = C3D::Platform::GetAbsoluteTime();
+                for (u32 i = 0; i < iterations; ++i)
+                {
+                    C3D::EntityView<Position, Velocity> view(ecs);
+                    for (auto entity : view)
+                    {
+                        auto& position       = ecs.GetComponent<Position>(entity);
+                        const auto& velocity = ecs.GetComponent<Velocity>(entity);
+                        position.x += velocity.x;
+                        position.y += velocity.y;
+                        position.z += velocity.z;
+                    }
+                }
+                const auto iterateTime = (C3D::Platform::GetAbsoluteTime() - start) / iterations;
+
+                start = C3D::Platform::GetAbsoluteTime();
+                for (auto entity : entities) ecs.AddComponent<Health>(entity);
+                for (auto entity : entities) ecs.RemoveComponent<Health>(entity);
+                const auto addRemoveTime = C3D::Platform::GetAbsoluteTime() - start;
+
+                C3D::Logger::Info("ECS          {:>7} entities: iterate {:>8.3f}ms, add + remove {:>8.3f}ms.", count, iterateTime * 1000.0,
+                                  addRemoveTime * 1000.0);
+
+                entities.Destroy();
+                ecs.Destroy();
+            }
+
+            // The archetype based ECS
+            {
+                C3D::ArchetypeECS ecs;
+                CreateArchetypeECS(ecs);
+
+                C3D::DynamicArray<C3D::Entity> entities;
+                entities.Reserve(count);
+
+                for (u32 i = 0; i < count; ++i)
+                {
+                    auto entity = ecs.Register();
+                    ecs.AddComponent<Position>(entity);
+                    // Only half of our entities move
+                    if (i % 2 == 0) ecs.AddComponent<Velocity>(entity);
+                    entities.PushBack(entity);
+                }
+
+                auto start = C3D::Platform::GetAbsoluteTime();
+                for (u32 i = 0; i < iterations; ++i)
+                {
+                    C3D::ArchetypeView<Position, Velocity> view(ecs);
+                    view.ForEachChunk([](const C3D::EntityChunk<Position, Velocity>& chunk) {
+                        auto positions  = chunk.Get<Position>();
+                        auto velocities = chunk.Get<Velocity>();
+                        for (u32 j = 0; j < chunk.Size(); ++j)
+                        {
+                            positions[j].x += velocities[j].x;
+                            positions[j].y += velocities[j].y;
+                            positions[j].z += velocities[j].z;
+                        }
+                    });
+                }
+                const auto iterateTime = (C3D::Platform::GetAbsoluteTime() - start) / iterations;
+
+                start = C3D::Platform::GetAbsoluteTime();
+                for (auto entity : entities) ecs.AddComponent<Health>(entity);
+                for (auto entity : entities) ecs.RemoveComponent<Health>(entity);
+                const auto addRemoveTime = C3D::Platform::GetAbsoluteTime() - start;
+
+                C3D::Logger::Info("ArchetypeECS {:>7} entities: iterate {:>8.3f}ms, add + remove {:>8.3f}ms.", count, iterateTime * 1000.0,
+                                  addRemoveTime * 1000.0);
+
+                entities.Destroy();
+                ecs.Destroy();
+            }
+        }
+    }
+
+    void RegisterTests(TestManager& manager)
+    {
+        manager.StartType("ECS");
+        REGISTER_TEST(ArchetypeECSShouldAddAndGetComponents, "The ArchetypeECS should be able to add and get components.");
+        REGISTER_TEST(ArchetypeECSRemoveComponentShouldKeepOtherEntitiesIntact,
+                      "Removing components should not change the components of other entities.");
+        REGISTER_TEST(ArchetypeECSDeactivateShouldInvalidateTheEntity,
+                      "Deactivating an entity should invalidate it and allow reuse of it's index.");
+        REGISTER_TEST(ArchetypeECSShouldConstructAndDestroyComponents,
+                      "The ArchetypeECS should properly construct, move and destroy components.");
+        REGISTER_TEST(ArchetypeViewShouldOnlyVisitMatchingEntities,
+                      "An ArchetypeView should only visit entities that have all it's components.");
+        REGISTER_TEST(EntitySystemsShouldDetectConflicts,
+                      "Entity systems should only conflict if one of them writes a component the other uses.");
+        REGISTER_TEST(EntitySystemSchedulerShouldRunNonConflictingSystemsConcurrently,
+                      "The EntitySystemScheduler should run systems that don't conflict at the same time.");
+        REGISTER_TEST(EntitySystemSchedulerShouldRunConflictingSystemsInOrder,
+                      "The EntitySystemScheduler should run conflicting systems in the order they were added.");
+        REGISTER_TEST(ArchetypeViewParallelForEachChunkShouldVisitEveryEntityOnce,
+                      "ParallelForEachChunk should visit every matching entity exactly once.");
+        REGISTER_BENCHMARK(ECSBenchmark,
+                           "Benchmark iteration and add/remove throughput of the ECS and ArchetypeECS for 10k, 100k and 1M entities.");
+    }
+}  // namespace ECS
@@ -0,0 +1,237 @@
+#include "hierarchy_graph_tests.h"
+
+#include <containers/dynamic_array.h>
+#include <cson/cson_types.h>
+#include <graphs/hierarchy_graph.h>
+#include <logger/logger.h>
+#include <math/c3d_math.h>
+#include <systems/jobs/job_system.h>
+#include <systems/system_manager.h>
+#include <systems/transforms/transform_system.h>
+
+#include "../expect.h"
+
+namespace HierarchyGraph
+{
+    /** @brief The HierarchyGraph uses the global Transforms and Jobs so we register our own instances for the duration of a test. */
+    struct GraphSystems
+    {
+        GraphSystems()
+        {
+            C3D::CSONObject jobConfig(C3D::CSONObjectType::Object);
+            jobConfig.properties.EmplaceBack("threadCount", static_cast<i64>(4));
+
+            transforms.OnInit(C3D::CSONObject(C3D::CSONObjectType::Object));
+            jobs.OnInit(jobConfig);
+
+            C3D::SystemManager::RegisterSystem(C3D::TransformSystemType, &transforms);
+            C3D::SystemManager::RegisterSystem(C3D::JobSystemType, &jobs);
+        }
+
+        ~GraphSystems()
+        {
+            C3D::SystemManager::RegisterSystem(C3D::TransformSystemType, nullptr);
+            C3D::SystemManager::RegisterSystem(C3D::JobSystemType, nullptr);
+
+            jobs.OnShutdown();
+            transforms.OnShutdown();
+        }
+
+        C3D::TransformSystem transforms;
+        C3D::JobSystem jobs;
+    };
+
+    static void ExpectMatricesEqual(const mat4& expected, const mat4& actual)
+    {
+        for (u32 c = 0; c < 4; ++c)
+        {
+            for (u32 r = 0; r < 4; ++r)
+            {
+                ExpectFloatEqual(expected[c][r], actual[c][r]);
+            }
+        }
+    }
+
+    /** @brief Checks that the world matrix of the node is the product of it's own local matrix and the local matrices of it's ancestors
+     * (which are provided from the root down). */
+    static void ExpectWorld(C3D::TransformSystem& transforms, std::initializer_list<C3D::Handle<C3D::Transform>> path)
+    {
+        mat4 expected(1.0f);
+        for (const auto handle : path) expected = expected * transforms.GetLocal(handle);
+
+        ExpectMatricesEqual(expected, transforms.GetWorld(*(path.end() - 1)));
+    }
+
+    TEST(HierarchyGraphShouldCalculateTheWorldOfSiblings)
+    {
+        GraphSystems systems;
+        auto& transforms = systems.transforms;
+
+        C3D::HierarchyGraph graph;
+        ExpectTrue(graph.Create(8));
+
+        const auto parent = transforms.Acquire(vec3(10.0f, 0.0f, 0.0f), glm::angleAxis(C3D::PI * 0.5f, C3D::VEC3_UP), vec3(2.0f));
+        const auto first  = transforms.Acquire(vec3(1.0f, 0.0f, 0.0f));
+        const auto second = transforms.Acquire(vec3(0.0f, 2.0f, 3.0f), glm::angleAxis(C3D::PI * 0.25f, C3D::VEC3_UP), vec3(0.5f));
+
+        const auto parentNode = graph.AddNode(parent);
+        ExpectTrue(graph.AddChild(parentNode, graph.AddNode(first)));
+        ExpectTrue(graph.AddChild(parentNode, graph.AddNode(second)));
+
+        ExpectTrue(graph.Update());
+
+        // Both siblings should start from the world of their shared parent (and not from each other's world)
+        ExpectWorld(transforms, { parent });
+        ExpectWorld(transforms, { parent, first });
+        ExpectWorld(transforms, { parent, second });
+
+        graph.Destroy();
+    }
+
+    TEST(HierarchyGraphShouldUpdateChildrenOfACleanParent)
+    {
+        GraphSystems systems;
+        auto& transforms = systems.transforms;
+
+        C3D::HierarchyGraph graph;
+        ExpectTrue(graph.Create(8));
+
+        const auto parent  = transforms.Acquire(vec3(5.0f, 1.0f, 0.0f), glm::angleAxis(C3D::PI * 0.5f, C3D::VEC3_UP));
+        const auto child   = transforms.Acquire(vec3(1.0f, 0.0f, 0.0f));
+        const auto sibling = transforms.Acquire(vec3(0.0f, 0.0f, 1.0f));
+
+        const auto parentNode = graph.AddNode(parent);
+        ExpectTrue(graph.AddChild(parentNode, graph.AddNode(child)));
+        ExpectTrue(graph.AddChild(parentNode, graph.AddNode(sibling)));
+        ExpectTrue(graph.Update());
+
+        const auto parentGeneration  = transforms.GetWorldGeneration(parent);
+        const auto siblingGeneration = transforms.GetWorldGeneration(sibling);
+
+        // Only the child changes so the parent (and the sibling) should be left alone
+        transforms.Translate(child, vec3(0.0f, 3.0f, 0.0f));
+        ExpectTrue(graph.Update());
+
+        ExpectWorld(transforms, { parent, child });
+        ExpectWorld(transforms, { parent, sibling });
+        ExpectEqual(parentGeneration, transforms.GetWorldGeneration(parent));
+        ExpectEqual(siblingGeneration, transforms.GetWorldGeneration(sibling));
+
+        graph.Destroy();
+    }
+
+    TEST(HierarchyGraphShouldReparentAndRelease)
+    {
+        GraphSystems systems;
+        auto& transforms = systems.transforms;
+
+        C3D::HierarchyGraph graph;
+        ExpectTrue(graph.Create(8));
+
+        const auto first  = transforms.Acquire(vec3(10.0f, 0.0f, 0.0f));
+        const auto second = transforms.Acquire(vec3(0.0f, 0.0f, -10.0f), glm::angleAxis(C3D::PI, C3D::VEC3_UP), vec3(3.0f));
+        const auto child  = transforms.Acquire(vec3(1.0f, 2.0f, 3.0f));
+
+        const auto firstNode  = graph.AddNode(first);
+        const auto secondNode = graph.AddNode(second);
+        const auto childNode  = graph.AddNode(child);
+
+        ExpectTrue(graph.AddChild(firstNode, childNode));
+        ExpectTrue(graph.Update());
+        ExpectWorld(transforms, { first, child });
+
+        // Moving the child to another parent should give it the world of it's new parent
+        ExpectTrue(graph.AddChild(secondNode, childNode));
+        ExpectTrue(graph.Update());
+        ExpectWorld(transforms, { second, child });
+
+        // Releasing the parent should turn the child into a root
+        ExpectTrue(graph.Release(secondNode, true));
+        ExpectTrue(graph.Update());
+        ExpectWorld(transforms, { child });
+        ExpectWorld(transforms, { first });
+
+        graph.Destroy();
+    }
+
+    TEST(HierarchyGraphShouldRejectCycles)
+    {
+        GraphSystems systems;
+        auto& transforms = systems.transforms;
+
+        C3D::HierarchyGraph graph;
+        ExpectTrue(graph.Create(8));
+
+        const auto first  = graph.AddNode(transforms.Acquire());
+        const auto second = graph.AddNode(transforms.Acquire());
+        const auto third  = graph.AddNode(transforms.Acquire());
+
+        ExpectTrue(graph.AddChild(first, second));
+        ExpectTrue(graph.AddChild(second, third));
+        ExpectTrue(graph.Update());
+
+        // Making the root a child of it's own grandchild creates a cycle which can't be flattened
+        ExpectTrue(graph.AddChild(third, first));
+        ExpectFalse(graph.Update());
+
+        graph.Destroy();
+    }
+
+    TEST(HierarchyGraphShouldUpdateLargeLevelsInParallel)
+    {
+        GraphSystems systems;
+        auto& transforms = systems.transforms;
+
+        // Both levels below the root are large enough to be split into chunks on the job system
+        constexpr u32 count = C3D::HIERARCHY_GRAPH_PARALLEL_THRESHOLD * 2 + 7;
+
+        C3D::HierarchyGraph graph;
+        ExpectTrue(graph.Create(count * 2 + 1));
+
+        const auto root     = transforms.Acquire(vec3(0.0f, 5.0f, 0.0f), glm::angleAxis(C3D::PI * 0.5f, C3D::VEC3_UP), vec3(2.0f));
+        const auto rootNode = graph.AddNode(root);
+
+        C3D::DynamicArray<C3D::Handle<C3D::Transform>> children(count);
+        C3D::DynamicArray<C3D::Handle<C3D::Transform>> grandChildren(count);
+        for (u32 i = 0; i < count; ++i)
+        {
+            const auto angle = static_cast<f32>(i) * 0.01f;
+            children.PushBack(transforms.Acquire(vec3(static_cast<f32>(i % 100), 0.0f, 1.0f), glm::angleAxis(angle, C3D::VEC3_UP)));
+            grandChildren.PushBack(transforms.Acquire(vec3(1.0f, static_cast<f32>(i % 10), 0.0f)));
+
+            const auto childNode = graph.AddNode(children[i]);
+            ExpectTrue(graph.AddChild(rootNode, childNode));
+            ExpectTrue(graph.AddChild(childNode, graph.AddNode(grandChildren[i])));
+        }
+
+        ExpectTrue(graph.Update());
+        for (u32 i = 0; i < count; ++i)
+        {
+            ExpectWorld(transforms, { root, children[i] });
+            ExpectWorld(transforms, { root, children[i], grandChildren[i] });
+        }
+
+        // Changing the root should propagate through both parallel levels
+        transforms.Translate(root, vec3(1.0f, 0.0f, 0.0f));
+        ExpectTrue(graph.Update());
+        for (u32 i = 0; i < count; ++i)
+        {
+            ExpectWorld(transforms, { root, children[i], grandChildren[i] });
+        }
+
+        children.Destroy();
+        grandChildren.Destroy();
+        graph.Destroy();
+    }
+
+    void RegisterTests(TestManager& manager)
+    {
+        manager.StartType("HierarchyGraph");
+        REGISTER_TEST(HierarchyGraphShouldCalculateTheWorldOfSiblings, "HierarchyGraph should calculate the world of siblings.");
+        REGISTER_TEST(HierarchyGraphShouldUpdateChildrenOfACleanParent,
+                      "HierarchyGraph should update the children of a parent that did not change.");
+        REGISTER_TEST(HierarchyGraphShouldReparentAndRelease, "HierarchyGraph should handle reparenting and releasing a parent.");
+        REGISTER_TEST(HierarchyGraphShouldRejectCycles, "HierarchyGraph should fail to update a hierarchy that contains a cycle.");
+        REGISTER_TEST(HierarchyGraphShouldUpdateLargeLevelsInParallel, "HierarchyGraph should update large levels on the job system.");
+    }
+}  // namespace HierarchyGraph
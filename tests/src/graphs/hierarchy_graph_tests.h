@@ -0,0 +1,7 @@
+#pragma once
+#include "../test_manager.h"
+
+namespace HierarchyGraph
+{
+	void RegisterTests(TestManager& manager);
+}
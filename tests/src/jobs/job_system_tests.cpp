@@ -0,0 +1,565 @@
+#include "job_system_tests.h"
+
+#include <containers/dynamic_array.h>
+#include <cson/cson_types.h>
+#include <defines.h>
+#include <frame_data.h>
+#include <logger/logger.h>
+#include <platform/platform.h>
+#include <systems/jobs/job_system.h>
+#include <systems/jobs/task_group.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+#include "../expect.h"
+
+namespace JobSystem
+{
+    /** @brief The maximum amount of time we wait for our submitted jobs to finish before we consider the test failed. */
+    constexpr f64 JOB_TIMEOUT = 10.0;
+
+    struct JobStats
+    {
+        std::atomic<u64> completed = 0;
+        /** @brief The sum and max of the time between submitting a job and the job completing (in nanoseconds). */
+        std::atomic<u64> totalLatency = 0;
+        std::atomic<u64> maxLatency   = 0;
+    };
+
+    static C3D::CSONObject MakeConfig(u8 threadCount)
+    {
+        C3D::CSONObject config(C3D::CSONObjectType::Object);
+        config.properties.EmplaceBack("threadCount", static_cast<i64>(threadCount));
+        return config;
+    }
+
+    static bool WaitForCompletion(const JobStats& stats, u64 count)
+    {
+        const auto start = C3D::Platform::GetAbsoluteTime();
+        while (stats.completed < count)
+        {
+            if (C3D::Platform::GetAbsoluteTime() - start > JOB_TIMEOUT) return false;
+            std::this_thread::yield();
+        }
+        return true;
+    }
+
+    TEST(JobSystemShouldExecuteAllJobs)
+    {
+        C3D::JobSystem jobs;
+        ExpectTrue(jobs.OnInit(MakeConfig(4)));
+
+        JobStats stats;
+        constexpr u64 count = 1000;
+        for (u64 i = 0; i < count; ++i)
+        {
+            auto handle = jobs.Submit(
+                [&stats] {
+                    stats.completed++;
+                    return true;
+                },
+                {}, {});
+            ExpectNotEqual(INVALID_ID_U16, handle);
+        }
+
+        ExpectTrue(WaitForCompletion(stats, count));
+        ExpectEqual(count, stats.completed.load());
+
+        jobs.OnShutdown();
+    }
+
+    TEST(JobSystemShouldExecuteJobsSubmittedByJobs)
+    {
+        C3D::JobSystem jobs;
+        ExpectTrue(jobs.OnInit(MakeConfig(4)));
+
+        JobStats stats;
+        constexpr u64 count = 100;
+        for (u64 i = 0; i < count; ++i)
+        {
+            jobs.Submit(
+                [&stats, &jobs] {
+                    // Every job submits another job from inside the job thread
+                    jobs.Submit(
+                        [&stats] {
+                            stats.completed++;
+                            return true;
+                        },
+                        {}, {});
+                    stats.completed++;
+                    return true;
+                },
+                {}, {});
+        }
+
+        ExpectTrue(WaitForCompletion(stats, count * 2));
+        ExpectEqual(count * 2, stats.completed.load());
+
+        jobs.OnShutdown();
+    }
+
+    TEST(JobSystemShouldCallResultCallbacksOnUpdate)
+    {
+        C3D::JobSystem jobs;
+        ExpectTrue(jobs.OnInit(MakeConfig(2)));
+
+        JobStats stats;
+        u32 successes = 0;
+        u32 failures  = 0;
+
+        jobs.Submit(
+            [&stats] {
+                stats.completed++;
+                return true;
+            },
+            [&successes] { successes++; }, [&failures] { failures++; });
+        jobs.Submit(
+            [&stats] {
+                stats.completed++;
+                return false;
+            },
+            [&successes] { successes++; }, [&failures] { failures++; });
+
+        ExpectTrue(WaitForCompletion(stats, 2));
+
+        // The callbacks should only be called by the thread that calls OnUpdate
+        ExpectEqual(0, successes);
+        ExpectEqual(0, failures);
+
+        // The callback is stored after the entry point has returned so we keep updating until we have seen both callbacks
+        C3D::FrameData frameData;
+        const auto start = C3D::Platform::GetAbsoluteTime();
+        while (successes + failures < 2 && C3D::Platform::GetAbsoluteTime() - start < JOB_TIMEOUT)
+        {
+            jobs.OnUpdate(frameData);
+        }
+
+        ExpectEqual(1, successes);
+        ExpectEqual(1, failures);
+
+        jobs.OnShutdown();
+    }
+
+    TEST(JobSystemShouldOnlyRunJobsOnThreadsWithMatchingType)
+    {
+        C3D::JobSystem jobs;
+        ExpectTrue(jobs.OnInit(MakeConfig(4)));
+
+        // Without a (multithreaded) renderer only the first job thread can run GPU and ResourceLoad jobs
+        struct ThreadStats
+        {
+            JobStats stats;
+            std::thread::id firstThreadId;
+            std::atomic<u32> wrongThread = 0;
+        } threadStats;
+
+        jobs.Submit(
+            [&threadStats] {
+                threadStats.firstThreadId = std::this_thread::get_id();
+                threadStats.stats.completed++;
+                return true;
+            },
+            {}, {}, C3D::JobTypeGpuResource);
+        ExpectTrue(WaitForCompletion(threadStats.stats, 1));
+
+        constexpr u64 count = 100;
+        for (u64 i = 0; i < count; ++i)
+        {
+            jobs.Submit(
+                [&threadStats] {
+                    if (std::this_thread::get_id() != threadStats.firstThreadId) threadStats.wrongThread++;
+                    threadStats.stats.completed++;
+                    return true;
+                },
+                {}, {}, C3D::JobTypeResourceLoad);
+        }
+
+        ExpectTrue(WaitForCompletion(threadStats.stats, count + 1));
+        ExpectEqual(0, threadStats.wrongThread.load());
+
+        jobs.OnShutdown();
+    }
+
+    TEST(JobSystemWaitShouldWaitForTheSubmittedJob)
+    {
+        C3D::JobSystem jobs;
+        ExpectTrue(jobs.OnInit(MakeConfig(4)));
+
+        std::atomic<bool> done = false;
+
+        const auto handle = jobs.Submit(
+            [&done] {
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                done = true;
+                return true;
+            },
+            {}, {});
+
+        jobs.Wait(handle);
+
+        ExpectTrue(done.load());
+        ExpectTrue(jobs.IsFinished(handle));
+
+        jobs.OnShutdown();
+    }
+
+    TEST(JobSystemShouldRunJobsAfterTheirDependencies)
+    {
+        C3D::JobSystem jobs;
+        ExpectTrue(jobs.OnInit(MakeConfig(4)));
+
+        struct DependencyStats
+        {
+            std::atomic<u32> finishedParents = 0;
+            u32 parentsSeenByChild           = 0;
+        } stats;
+
+        constexpr u8 parentCount = C3D::MAX_JOB_DEPENDENCIES;
+
+        C3D::JobHandle parents[parentCount];
+        for (auto& parent : parents)
+        {
+            parent = jobs.Submit(
+                [&stats] {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                    stats.finishedParents++;
+                    return true;
+                },
+                {}, {});
+        }
+
+        const auto child = jobs.Submit(
+            [&stats] {
+                stats.parentsSeenByChild = stats.finishedParents;
+                return true;
+            },
+            {}, {}, C3D::JobTypeGeneral, C3D::JobPriority::High, parents, parentCount);
+
+        jobs.Wait(child);
+
+        ExpectEqual(parentCount, stats.parentsSeenByChild);
+
+        jobs.OnShutdown();
+    }
+
+    TEST(JobSystemContinueShouldRunAfterTheParent)
+    {
+        C3D::JobSystem jobs;
+        ExpectTrue(jobs.OnInit(MakeConfig(4)));
+
+        // Build a chain of continuations where every job appends it's index
+        struct ChainStats
+        {
+            u32 order[64] = {};
+            std::atomic<u32> count = 0;
+        } stats;
+
+        auto handle = jobs.Submit(
+            [&stats] {
+                stats.order[stats.count++] = 0;
+                return true;
+            },
+            {}, {});
+
+        for (u32 i = 1; i < 64; ++i)
+        {
+            handle = jobs.Continue(
+                handle,
+                [&stats, i] {
+                    stats.order[stats.count++] = i;
+                    return true;
+                },
+                {}, {});
+        }
+
+        jobs.Wait(handle);
+
+        ExpectEqual(64, stats.count.load());
+        for (u32 i = 0; i < 64; ++i)
+        {
+            ExpectEqual(i, stats.order[i]);
+        }
+
+        jobs.OnShutdown();
+    }
+
+    TEST(JobSystemWaitAllShouldWaitForAllJobs)
+    {
+        C3D::JobSystem jobs;
+        ExpectTrue(jobs.OnInit(MakeConfig(2)));
+
+        // Submit more jobs than can be in flight at once so the slots get reused
+        constexpr u64 count = C3D::MAX_ACTIVE_JOBS * 4;
+
+        JobStats stats;
+        C3D::DynamicArray<C3D::JobHandle> handles;
+        handles.Reserve(count);
+
+        for (u64 i = 0; i < count; ++i)
+        {
+            handles.PushBack(jobs.Submit(
+                [&stats] {
+                    stats.completed++;
+                    return true;
+                },
+                {}, {}));
+        }
+
+        jobs.WaitAll(std::span(handles.GetData(), handles.Size()));
+
+        ExpectEqual(count, stats.completed.load());
+
+        jobs.OnShutdown();
+    }
+
+    TEST(JobSystemWaitShouldRunPendingJobsOnTheWaitingThread)
+    {
+        // With a single job thread that is blocked, the waiting (main) thread has to execute the job itself
+        C3D::JobSystem jobs;
+        ExpectTrue(jobs.OnInit(MakeConfig(1)));
+
+        std::atomic<bool> release = false;
+        std::thread::id executedBy;
+
+        const auto blocker = jobs.Submit(
+            [&release] {
+                while (!release) std::this_thread::yield();
+                return true;
+            },
+            {}, {});
+
+        // Give the job thread the chance to start executing the blocking job
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+        const auto handle = jobs.Submit(
+            [&executedBy] {
+                executedBy = std::this_thread::get_id();
+                return true;
+            },
+            {}, {});
+
+        jobs.Wait(handle);
+        ExpectTrue(executedBy == std::this_thread::get_id());
+
+        release = true;
+        jobs.Wait(blocker);
+
+        jobs.OnShutdown();
+    }
+
+    TEST(ParallelForShouldVisitEveryElementOnce)
+    {
+        C3D::JobSystem jobs;
+        ExpectTrue(jobs.OnInit(MakeConfig(4)));
+
+        constexpr u64 count = 100000;
+
+        C3D::DynamicArray<u32> visits;
+        visits.Resize(count);
+
+        jobs.ParallelFor(count, 1000, [&visits](const u64 begin, const u64 end, C3D::LinearAllocator&) {
+            for (u64 i = begin; i < end; ++i)
+            {
+                std::atomic_ref(visits[i])++;
+            }
+        });
+
+        u64 visitedOnce = 0;
+        for (const auto& visit : visits)
+        {
+            if (visit == 1) visitedOnce++;
+        }
+        ExpectEqual(count, visitedOnce);
+
+        // A count that is not a multiple of the grain size and a grain size of 0 should also work
+        std::atomic<u64> total = 0;
+        jobs.ParallelFor(1001, 0, [&total](const u64 begin, const u64 end, C3D::LinearAllocator&) { total += end - begin; });
+        ExpectEqual(1001, total.load());
+
+        jobs.OnShutdown();
+    }
+
+    TEST(ParallelForShouldProvideAScratchAllocatorPerThread)
+    {
+        C3D::JobSystem jobs;
+        ExpectTrue(jobs.OnInit(MakeConfig(4)));
+
+        struct ScratchStats
+        {
+            std::atomic<u32> sharedAllocators = 0;
+            std::atomic<u32> wrongAllocators  = 0;
+            std::atomic<u64> chunks           = 0;
+        } stats;
+
+        jobs.ParallelFor(256, 1, [&jobs, &stats](const u64 begin, const u64, C3D::LinearAllocator& scratch) {
+            // Inside of a chunk the scratch allocator of the thread should be available
+            if (jobs.GetScratchAllocator() != &scratch) stats.wrongAllocators++;
+
+            // Write our chunk index into scratch memory, if another thread uses the same allocator it will overwrite our values
+            auto values = scratch.Allocate<u64>(C3D::MemoryType::Array, 64);
+            for (u32 i = 0; i < 64; ++i) values[i] = begin;
+
+            std::this_thread::yield();
+
+            for (u32 i = 0; i < 64; ++i)
+            {
+                if (values[i] != begin) stats.sharedAllocators++;
+            }
+            stats.chunks++;
+        });
+
+        ExpectEqual(256, stats.chunks.load());
+        ExpectEqual(0, stats.sharedAllocators.load());
+        ExpectEqual(0, stats.wrongAllocators.load());
+
+        // Outside of a job there is no scratch memory since nothing would ever reset it
+        ExpectTrue(jobs.GetScratchAllocator() == nullptr);
+
+        // After the ParallelFor has finished the scratch memory of every thread should be reset
+        std::atomic<u32> dirtyAllocators = 0;
+        jobs.ParallelFor(8, 1, [&dirtyAllocators](const u64, const u64, C3D::LinearAllocator& scratch) {
+            if (scratch.GetAllocated() != 0) dirtyAllocators++;
+        });
+        ExpectEqual(0, dirtyAllocators.load());
+
+        jobs.OnShutdown();
+    }
+
+    TEST(TaskGroupShouldWaitForAllTasks)
+    {
+        C3D::JobSystem jobs;
+        ExpectTrue(jobs.OnInit(MakeConfig(4)));
+
+        JobStats stats;
+
+        {
+            C3D::TaskGroup group(jobs);
+            for (u32 i = 0; i < 100; ++i)
+            {
+                group.Run([&stats] {
+                    std::this_thread::sleep_for(std::chrono::microseconds(100));
+                    stats.completed++;
+                    return true;
+                });
+            }
+
+            group.Wait();
+            ExpectTrue(group.IsFinished());
+            ExpectEqual(100, stats.completed.load());
+
+            // Destroying the group should also wait for all the tasks that are still running
+            group.Run([&stats] {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                stats.completed++;
+                return true;
+            });
+        }
+
+        ExpectEqual(101, stats.completed.load());
+
+        jobs.OnShutdown();
+    }
+
+    TEST(ParallelForBenchmark)
+    {
+        constexpr u64 count = 1000000;
+
+        C3D::DynamicArray<f32> values;
+        values.Resize(count);
+
+        constexpr u8 threadCounts[] = { 1, 2, 4, 8, 16, 32 };
+        for (const auto threadCount : threadCounts)
+        {
+            C3D::JobSystem jobs;
+            ExpectTrue(jobs.OnInit(MakeConfig(threadCount)));
+
+            const auto start = C3D::Platform::GetAbsoluteTime();
+            jobs.ParallelFor(count, 4096, [&values](const u64 begin, const u64 end, C3D::LinearAllocator&) {
+                for (u64 i = begin; i < end; ++i)
+                {
+                    values[i] = std::sqrt(static_cast<f32>(i)) * 0.5f;
+                }
+            });
+            const auto elapsed = C3D::Platform::GetAbsoluteTime() - start;
+
+            jobs.OnShutdown();
+
+            C3D::Logger::Info("ParallelFor with {:>2} threads: {} elements in {:.3f}ms.", threadCount, count, elapsed * 1000.0);
+        }
+    }
+
+    TEST(JobSystemBenchmark)
+    {
+        constexpr u64 count         = 100000;
+        constexpr u8 threadCounts[] = { 1, 2, 4, 8, 16, 32 };
+
+        for (const auto threadCount : threadCounts)
+        {
+            C3D::JobSystem jobs;
+            ExpectTrue(jobs.OnInit(MakeConfig(threadCount)));
+
+            JobStats stats;
+
+            const auto start = C3D::Platform::GetAbsoluteTime();
+            for (u64 i = 0; i < count; ++i)
+            {
+                const auto submitTime = C3D::Platform::GetAbsoluteTime();
+                jobs.Submit(
+                    [&stats, submitTime] {
+                        const auto latency = static_cast<u64>((C3D::Platform::GetAbsoluteTime() - submitTime) * 1'000'000'000.0);
+                        stats.totalLatency += latency;
+
+                        auto currentMax = stats.maxLatency.load();
+                        while (latency > currentMax && !stats.maxLatency.compare_exchange_weak(currentMax, latency))
+                        {
+                        }
+
+                        stats.completed++;
+                        return true;
+                    },
+                    {}, {});
+            }
+
+            ExpectTrue(WaitForCompletion(stats, count));
+            const auto elapsed = C3D::Platform::GetAbsoluteTime() - start;
+
+            jobs.OnShutdown();
+
+            const auto averageLatency = static_cast<f64>(stats.totalLatency) / static_cast<f64>(count) / 1000.0;
+            const auto maxLatency     = static_cast<f64>(stats.maxLatency) / 1000.0;
+            const auto throughput     = static_cast<f64>(count) / elapsed;
+
+            C3D::Logger::Info("JobSystem with {:>2} threads: {} jobs in {:.3f}ms ({:.0f} jobs/s), latency avg {:.2f}us max {:.2f}us.",
+                              threadCount, count, elapsed * 1000.0, throughput, averageLatency, maxLatency);
+        }
+    }
+
+    void RegisterTests(TestManager& manager)
+    {
+        manager.StartType("JobSystem");
+        REGISTER_TEST(JobSystemShouldExecuteAllJobs, "The JobSystem should execute all submitted jobs.");
+        REGISTER_TEST(JobSystemShouldExecuteJobsSubmittedByJobs, "The JobSystem should execute jobs that are submitted from inside a job.");
+        REGISTER_TEST(JobSystemShouldCallResultCallbacksOnUpdate,
+                      "The JobSystem should call the onSuccess and onFailure callbacks on update.");
+        REGISTER_TEST(JobSystemShouldOnlyRunJobsOnThreadsWithMatchingType,
+                      "The JobSystem should only run jobs on threads that can execute the job's type.");
+        REGISTER_TEST(JobSystemWaitShouldWaitForTheSubmittedJob, "Jobs.Wait() should only return after the job has finished.");
+        REGISTER_TEST(JobSystemShouldRunJobsAfterTheirDependencies,
+                      "The JobSystem should only start a job after all it's dependencies finished.");
+        REGISTER_TEST(JobSystemContinueShouldRunAfterTheParent, "Continuations should run in order after their parent job.");
+        REGISTER_TEST(JobSystemWaitAllShouldWaitForAllJobs, "Jobs.WaitAll() should only return after all jobs have finished.");
+        REGISTER_TEST(JobSystemWaitShouldRunPendingJobsOnTheWaitingThread,
+                      "Jobs.Wait() should execute pending jobs on the waiting thread.");
+        REGISTER_TEST(ParallelForShouldVisitEveryElementOnce,
+                      "Jobs.ParallelFor() should call the function exactly once for every element.");
+        REGISTER_TEST(ParallelForShouldProvideAScratchAllocatorPerThread,
+                      "Jobs.ParallelFor() should provide every thread with it's own scratch allocator.");
+        REGISTER_TEST(TaskGroupShouldWaitForAllTasks, "A TaskGroup should wait for all of it's tasks to finish.");
+        REGISTER_BENCHMARK(ParallelForBenchmark, "Benchmark Jobs.ParallelFor() for 1 to 32 threads.");
+        REGISTER_BENCHMARK(JobSystemBenchmark, "Benchmark submit to complete latency and throughput of the JobSystem for 1 to 32 threads.");
+    }
+}  // namespace JobSystem
@@ -0,0 +1,229 @@
+#include "logger_tests.h"
+
+#include <logger/logger.h>
+#include <platform/platform.h>
+#include <spdlog/sinks/base_sink.h>
+#include <string/string.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../expect.h"
+
+namespace AsyncLogger
+{
+    /** @brief A sink that stores every message it receives so we can check them. */
+    class TestSink final : public spdlog::sinks::base_sink<std::mutex>
+    {
+    public:
+        std::vector<std::string> messages;
+
+    protected:
+        void sink_it_(const spdlog::details::log_msg& msg) override { messages.emplace_back(msg.payload.data(), msg.payload.size()); }
+        void flush_() override {}
+    };
+
+    std::shared_ptr<spdlog::logger> CreateTestLogger(const std::shared_ptr<TestSink>& sink)
+    {
+        auto logger = std::make_shared<spdlog::logger>("async_test", sink);
+        logger->set_level(spdlog::level::trace);
+        return logger;
+    }
+
+    TEST(AsyncLoggerShouldFormatAfterArgumentsAreDestroyed)
+    {
+        const auto sink = std::make_shared<TestSink>();
+        C3D::Logger::AddSink(sink);
+
+        ExpectTrue(C3D::Logger::StartAsync());
+        ExpectTrue(C3D::Logger::IsAsync());
+        // Starting twice should fail
+        ExpectFalse(C3D::Logger::StartAsync());
+
+        {
+            // All of these arguments are destroyed (or changed) long before the background thread formats them
+            std::string str    = "std::string";
+            C3D::String cStr   = "C3D::String";
+            char buffer[32]    = "runtime message";
+            const char* cChars = "const char*";
+
+            C3D::Logger::Info("{} {} {} {} {:.2f}", str, cStr, cChars, 42, 1.5f);
+            C3D::Logger::Info(buffer);
+
+            str = "changed";
+            cStr.Destroy();
+            std::strcpy(buffer, "changed");
+        }
+
+        C3D::Logger::StopAsync();
+        ExpectFalse(C3D::Logger::IsAsync());
+
+        C3D::Logger::RemoveSink(sink);
+
+        ExpectEqual(2, sink->messages.size());
+        ExpectTrue(sink->messages[0] == "std::string C3D::String const char* 42 1.50");
+        ExpectTrue(sink->messages[1] == "runtime message");
+    }
+
+    TEST(AsyncLoggerShouldPreserveOrderOfEveryThread)
+    {
+        constexpr u32 threadCount       = 4;
+        constexpr u32 messagesPerThread = 5000;
+
+        const auto sink = std::make_shared<TestSink>();
+        {
+            // Use a small buffer so our threads will regularly have to wait for the background thread
+            C3D::AsyncLoggerConfig config;
+            config.threadBufferSize = KibiBytes(1);
+            config.overflowPolicy   = C3D::LogOverflowPolicy::Block;
+
+            C3D::AsyncLogger logger(config, CreateTestLogger(sink));
+
+            std::vector<std::thread> threads;
+            for (u32 t = 0; t < threadCount; ++t)
+            {
+                threads.emplace_back([&logger, t] {
+                    for (u32 i = 0; i < messagesPerThread; ++i)
+                    {
+                        logger.Enqueue(spdlog::level::info, "{} {} {}", t, i, std::string("payload"));
+                    }
+                });
+            }
+
+            for (auto& thread : threads)
+            {
+                thread.join();
+            }
+
+            ExpectEqual(0, logger.GetDroppedCount());
+        }
+
+        // Nothing should be lost and the messages of every thread should arrive in the order they were logged
+        ExpectEqual(threadCount * messagesPerThread, sink->messages.size());
+
+        i64 lastIndex[threadCount];
+        std::fill_n(lastIndex, threadCount, -1);
+
+        for (const auto& message : sink->messages)
+        {
+            u32 thread = 0, index = 0;
+            ExpectEqual(2, std::sscanf(message.data(), "%u %u", &thread, &index));
+            ExpectTrue(thread < threadCount);
+            ExpectEqual(lastIndex[thread] + 1, static_cast<i64>(index));
+            lastIndex[thread] = index;
+        }
+    }
+
+    TEST(AsyncLoggerShouldCountDroppedMessages)
+    {
+        constexpr u32 messageCount = 20000;
+
+        const auto sink = std::make_shared<TestSink>();
+        u64 dropped     = 0;
+        {
+            C3D::AsyncLoggerConfig config;
+            config.threadBufferSize = KibiBytes(1);
+            config.overflowPolicy   = C3D::LogOverflowPolicy::Drop;
+
+            C3D::AsyncLogger logger(config, CreateTestLogger(sink));
+            for (u32 i = 0; i < messageCount; ++i)
+            {
+                logger.Enqueue(spdlog::level::info, "Message {}", i);
+            }
+
+            logger.Flush();
+            dropped = logger.GetDroppedCount();
+        }
+
+        // Every message should either be written or counted as dropped
+        u64 written = 0;
+        for (const auto& message : sink->messages)
+        {
+            if (message.starts_with("Message ")) written++;
+        }
+        ExpectEqual(static_cast<u64>(messageCount), written + dropped);
+    }
+
+    TEST(AsyncLoggerShouldWrapRecordsOfAnySize)
+    {
+        constexpr u32 messageCount = 5000;
+
+        const auto sink = std::make_shared<TestSink>();
+        {
+            // Records of different sizes (that don't divide the buffer size) leave every possible tail before the ring buffer wraps,
+            // including tails that are too small to hold a padding header
+            C3D::AsyncLoggerConfig config;
+            config.threadBufferSize = KibiBytes(1);
+            config.overflowPolicy   = C3D::LogOverflowPolicy::Block;
+
+            C3D::AsyncLogger logger(config, CreateTestLogger(sink));
+            for (u32 i = 0; i < messageCount; ++i)
+            {
+                logger.Enqueue(spdlog::level::info, "{} {}", i, std::string(i % 61, 'x'));
+            }
+        }
+
+        ExpectEqual(messageCount, sink->messages.size());
+        for (u32 i = 0; i < messageCount; ++i)
+        {
+            ExpectTrue(sink->messages[i] == fmt::format("{} {}", i, std::string(i % 61, 'x')));
+        }
+    }
+
+    TEST(AsyncLoggerBenchmark)
+    {
+        constexpr u32 messageCount = 100000;
+
+        const auto syncSink   = std::make_shared<TestSink>();
+        const auto syncLogger = CreateTestLogger(syncSink);
+        syncSink->messages.reserve(messageCount);
+
+        auto start = C3D::Platform::GetAbsoluteTime();
+        for (u32 i = 0; i < messageCount; ++i)
+        {
+            syncLogger->log(spdlog::level::info, fmt::format("Frame {} took {:.3f}ms for: '{}'", i, 16.6f, "benchmark"));
+        }
+        const auto sync = C3D::Platform::GetAbsoluteTime() - start;
+
+        const auto asyncSink = std::make_shared<TestSink>();
+        asyncSink->messages.reserve(messageCount);
+
+        f64 async = 0;
+        {
+            // Give the calling thread enough room so we measure the cost of logging and not of waiting for the background thread
+            C3D::AsyncLoggerConfig config;
+            config.threadBufferSize = MebiBytes(16);
+
+            C3D::AsyncLogger logger(config, CreateTestLogger(asyncSink));
+
+            start = C3D::Platform::GetAbsoluteTime();
+            for (u32 i = 0; i < messageCount; ++i)
+            {
+                logger.Enqueue(spdlog::level::info, "Frame {} took {:.3f}ms for: '{}'", i, 16.6f, "benchmark");
+            }
+            async = C3D::Platform::GetAbsoluteTime() - start;
+        }
+
+        ExpectEqual(syncSink->messages.size(), asyncSink->messages.size());
+        ExpectTrue(syncSink->messages.back() == asyncSink->messages.back());
+
+        INFO_LOG("{} messages took {:.3f}ms synchronously ({:.1f}ns per message) and {:.3f}ms asynchronously ({:.1f}ns per message).",
+                 messageCount, sync * C3D::SEC_TO_MS_MULTIPLIER, (sync / messageCount) * C3D::SEC_TO_US_MULTIPLIER * 1000.0,
+                 async * C3D::SEC_TO_MS_MULTIPLIER, (async / messageCount) * C3D::SEC_TO_US_MULTIPLIER * 1000.0);
+    }
+
+    void RegisterTests(TestManager& manager)
+    {
+        manager.StartType("AsyncLogger");
+        REGISTER_TEST(AsyncLoggerShouldFormatAfterArgumentsAreDestroyed, "Async logger should copy arguments before they are destroyed.");
+        REGISTER_TEST(AsyncLoggerShouldPreserveOrderOfEveryThread, "Async logger should not lose or reorder messages of a thread.");
+        REGISTER_TEST(AsyncLoggerShouldCountDroppedMessages, "Async logger should count every message that it drops.");
+        REGISTER_TEST(AsyncLoggerShouldWrapRecordsOfAnySize, "Async logger should wrap records that don't divide the buffer size.");
+        REGISTER_BENCHMARK(AsyncLoggerBenchmark, "Benchmark the cost of logging on the calling thread (sync vs async).");
+    }
+}  // namespace AsyncLogger
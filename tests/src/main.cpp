@@ -3,29 +3,53 @@
 
 #include "containers/array_tests.h"
 #include "containers/dynamic_array_tests.h"
+#include "containers/flat_hash_map_tests.h"
 #include "containers/hash_map_tests.h"
 #include "containers/hash_table_tests.h"
 #include "containers/queue_tests.h"
 #include "containers/ring_queue_tests.h"
 #include "containers/stack_tests.h"
+#include "cson/cson_binary_tests.h"
+#include "cson/cson_pull_reader_tests.h"
 #include "cson/cson_reader_tests.h"
 #include "cson/cson_writer_tests.h"
+#include "ecs/ecs_tests.h"
 #include "function/stack_function_tests.h"
+#include "graphs/hierarchy_graph_tests.h"
+#include "jobs/job_system_tests.h"
+#include "logger/logger_tests.h"
+#include "math/bvh_tests.h"
+#include "math/frustum_tests.h"
 #include "memory/dynamic_allocator_tests.h"
+#include "memory/frame_allocator_tests.h"
+#include "memory/free_list_tests.h"
 #include "memory/linear_allocator_tests.h"
 #include "memory/stack_allocator_tests.h"
 #include "platform/file_system.h"
+#include "profiler/profiler_tests.h"
+#include "renderer/geometry_utils_tests.h"
+#include "renderer/render_batch_tests.h"
+#include "renderer/render_sort_tests.h"
+#include "resources/csm_file_tests.h"
+#include "resources/obj_importer_tests.h"
 #include "string/cstring_tests.h"
+#include "string/name_tests.h"
 #include "string/string_tests.h"
 #include "test_manager.h"
+#include "transforms/transform_system_tests.h"
 
 int main(int argc, char** argv)
 {
+    // Benchmarks are opt-in since they take long to run. When they do run we need more memory (the ECS benchmarks use 1M entities)
+    const auto runBenchmarks = TestManager::ShouldRunBenchmarks(argc, argv);
+
     // Run our tests with 32MiB
-    TestManager manager(MebiBytes(32));
+    TestManager manager(runBenchmarks ? MebiBytes(256) : MebiBytes(32), runBenchmarks);
 
     LinearAllocator::RegisterTests(manager);
     DynamicAllocator::RegisterTests(manager);
+    FreeList::RegisterTests(manager);
+    FrameAllocator::RegisterTests(manager);
     StackAllocator::RegisterTests(manager);
 
     StackFunction::RegisterTests(manager);
@@ -37,17 +61,39 @@ int main(int argc, char** argv)
 
     String::RegisterTests(manager);
     CString::RegisterTests(manager);
+    Name::RegisterTests(manager);
 
     HashTable::RegisterTests(manager);
     HashMap::RegisterTests(manager);
+    FlatHashMap::RegisterTests(manager);
 
     RingQueue::RegisterTests(manager);
     Queue::RegisterTests(manager);
 
     FileSystem::RegisterTests(manager);
 
+    Frustum::RegisterTests(manager);
+    BVH::RegisterTests(manager);
+
     CSONReader::RegisterTests(manager);
     CSONWriter::RegisterTests(manager);
+    CSONBinary::RegisterTests(manager);
+    CSONPullReader::RegisterTests(manager);
+
+    CSMFile::RegisterTests(manager);
+    ObjImporter::RegisterTests(manager);
+    GeometryUtils::RegisterTests(manager);
+    RenderSort::RegisterTests(manager);
+    RenderBatch::RegisterTests(manager);
+
+    CpuProfiler::RegisterTests(manager);
+    AsyncLogger::RegisterTests(manager);
+
+    JobSystem::RegisterTests(manager);
+    TransformSystem::RegisterTests(manager);
+    HierarchyGraph::RegisterTests(manager);
+
+    ECS::RegisterTests(manager);
 
     C3D::Logger::Debug("------ Starting tests... ------");
     manager.RunTests();
@@ -0,0 +1,428 @@
+#include "bvh_tests.h"
+
+#include <containers/dynamic_array.h>
+#include <logger/logger.h>
+#include <math/bvh.h>
+#include <math/c3d_math.h>
+#include <math/frustum.h>
+#include <math/ray.h>
+#include <platform/platform.h>
+#include <random/random.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include "../expect.h"
+
+static vec3 GenerateRandomWholeVector(const i32 low, const i32 high)
+{
+    return vec3(static_cast<f32>(C3D::Random.Generate(low, high)), static_cast<f32>(C3D::Random.Generate(low, high)),
+                static_cast<f32>(C3D::Random.Generate(low, high)));
+}
+
+static C3D::Extents3D GenerateRandomBounds(const i32 worldSize)
+{
+    // NOTE: We use whole numbers so the center and extents can be reconstructed exactly from the min and max
+    const vec3 center  = GenerateRandomWholeVector(-worldSize, worldSize);
+    const vec3 extents = GenerateRandomWholeVector(1, 8);
+    return { center - extents, center + extents };
+}
+
+static void FillRandomBounds(C3D::DynamicArray<C3D::Extents3D>& bounds, C3D::DynamicArray<u32>& userData, const u32 count,
+                             const i32 worldSize)
+{
+    bounds.Clear();
+    userData.Clear();
+
+    for (u32 i = 0; i < count; ++i)
+    {
+        bounds.PushBack(GenerateRandomBounds(worldSize));
+        userData.PushBack(i);
+    }
+}
+
+static C3D::Ray GenerateRandomRay(const i32 worldSize)
+{
+    const auto size = static_cast<f32>(worldSize);
+
+    const vec3 origin    = { C3D::Random.Generate(-size, size), C3D::Random.Generate(-size, size), C3D::Random.Generate(-size, size) };
+    const vec3 direction = { C3D::Random.Generate(-1.0f, 1.0f), C3D::Random.Generate(-1.0f, 1.0f), C3D::Random.Generate(-1.0f, 1.0f) };
+    return C3D::Ray(origin, glm::normalize(direction));
+}
+
+static bool BruteForceRay(const C3D::Ray& ray, const C3D::Extents3D& bounds)
+{
+    const vec3 inverseDirection = 1.0f / ray.direction;
+
+    const vec3 t0   = (bounds.min - ray.origin) * inverseDirection;
+    const vec3 t1   = (bounds.max - ray.origin) * inverseDirection;
+    const vec3 tMin = glm::min(t0, t1);
+    const vec3 tMax = glm::max(t0, t1);
+
+    const f32 enter = C3D::Max(C3D::Max(tMin.x, tMin.y), C3D::Max(tMin.z, 0.0f));
+    const f32 exit  = C3D::Min(C3D::Min(tMax.x, tMax.y), C3D::Min(tMax.z, C3D::F32_MAX));
+    return enter <= exit;
+}
+
+static bool BruteForceSphere(const C3D::Sphere& sphere, const C3D::Extents3D& bounds)
+{
+    const vec3 closest = glm::min(glm::max(sphere.center, bounds.min), bounds.max);
+    const vec3 offset  = closest - sphere.center;
+    return glm::dot(offset, offset) <= sphere.radius * sphere.radius;
+}
+
+static bool BruteForceLine(const vec3& point, const vec3& direction, const f32 radius, const C3D::Extents3D& bounds)
+{
+    const vec3 inverseDirection = 1.0f / direction;
+
+    const vec3 t0   = (bounds.min - radius - point) * inverseDirection;
+    const vec3 t1   = (bounds.max + radius - point) * inverseDirection;
+    const vec3 tMin = glm::min(t0, t1);
+    const vec3 tMax = glm::max(t0, t1);
+
+    return C3D::Max(C3D::Max(tMin.x, tMin.y), tMin.z) <= C3D::Min(C3D::Min(tMax.x, tMax.y), tMax.z);
+}
+
+static bool BruteForceFrustum(const C3D::Frustum& frustum, const C3D::Extents3D& bounds)
+{
+    const vec3 center = (bounds.min + bounds.max) * 0.5f;
+    return frustum.IntersectsWithAABB({ center, bounds.max - center });
+}
+
+/** @brief Checks that the BVH found exactly the objects that are marked in expected (and found every object at most once). */
+static void ExpectSameHits(const C3D::DynamicArray<u8>& expected, const C3D::DynamicArray<u8>& found)
+{
+    for (u32 i = 0; i < expected.Size(); ++i)
+    {
+        ExpectTrue(found[i] <= 1);
+        ExpectEqual(expected[i], found[i]);
+    }
+}
+
+TEST(BVHShouldStayValidWhenInsertingAndRemoving)
+{
+    C3D::BVH bvh;
+    bvh.Create();
+
+    C3D::DynamicArray<u32> proxies;
+    for (u32 i = 0; i < 1000; ++i)
+    {
+        proxies.PushBack(bvh.Insert(GenerateRandomBounds(500), i));
+    }
+
+    ExpectTrue(bvh.Validate());
+    ExpectEqual(1000, bvh.GetLeafCount());
+    // A balanced tree with 1000 leaves should not be much higher than log2(1000) ~= 10
+    ExpectTrue(bvh.GetHeight() <= 20);
+
+    for (u32 i = 0; i < proxies.Size(); i += 2)
+    {
+        ExpectEqual(i, bvh.GetUserData(proxies[i]));
+        bvh.Remove(proxies[i]);
+    }
+
+    ExpectTrue(bvh.Validate());
+    ExpectEqual(500, bvh.GetLeafCount());
+
+    for (u32 i = 1; i < proxies.Size(); i += 2)
+    {
+        ExpectEqual(i, bvh.GetUserData(proxies[i]));
+        bvh.Remove(proxies[i]);
+    }
+
+    ExpectTrue(bvh.Validate());
+    ExpectEqual(0, bvh.GetLeafCount());
+    ExpectEqual(0, bvh.GetHeight());
+
+    bvh.Destroy();
+}
+
+TEST(BVHUpdateShouldOnlyChangeTheTreeWhenLeavingTheFatBounds)
+{
+    C3D::BVH bvh;
+    bvh.Create(16, 1.0f);
+
+    C3D::DynamicArray<u32> proxies;
+    for (u32 i = 0; i < 100; ++i)
+    {
+        proxies.PushBack(bvh.Insert(GenerateRandomBounds(100), i));
+    }
+
+    // Moving an object slightly should fit inside of the fat bounds
+    const auto fatBounds = bvh.GetFatBounds(proxies[0]);
+    ExpectFalse(bvh.Update(proxies[0], { fatBounds.min + 1.5f, fatBounds.max - 0.5f }));
+
+    // Moving an object far away should reinsert it
+    ExpectTrue(bvh.Update(proxies[0], { vec3(1000.0f), vec3(1001.0f) }));
+    ExpectTrue(bvh.Validate());
+
+    // The fat bounds should contain the new bounds
+    const auto& newBounds = bvh.GetFatBounds(proxies[0]);
+    ExpectTrue(newBounds.min.x <= 1000.0f && newBounds.max.x >= 1001.0f);
+
+    bvh.Destroy();
+}
+
+TEST(BVHQueriesShouldMatchBruteForce)
+{
+    constexpr u32 count     = 2000;
+    constexpr i32 worldSize = 500;
+
+    C3D::DynamicArray<C3D::Extents3D> bounds;
+    C3D::DynamicArray<u32> userData;
+    C3D::DynamicArray<u32> proxies(count);
+    FillRandomBounds(bounds, userData, count, worldSize);
+    proxies.Resize(count);
+
+    // We use no margin so the bounds in the BVH exactly match our bounds
+    C3D::BVH bvh;
+    bvh.Create(count, 0.0f);
+    bvh.Build(bounds.GetData(), userData.GetData(), count, proxies.GetData());
+
+    ExpectTrue(bvh.Validate());
+    ExpectEqual(count, bvh.GetLeafCount());
+
+    C3D::DynamicArray<u8> expected(count);
+    C3D::DynamicArray<u8> found(count);
+    expected.Resize(count);
+    found.Resize(count);
+
+    const auto reset = [&] {
+        std::fill(expected.begin(), expected.end(), 0);
+        std::fill(found.begin(), found.end(), 0);
+    };
+
+    for (u32 run = 0; run < 25; ++run)
+    {
+        // Ray
+        reset();
+        const auto ray = GenerateRandomRay(worldSize);
+        for (u32 i = 0; i < count; ++i) expected[i] = BruteForceRay(ray, bounds[i]);
+        bvh.QueryRay(ray, C3D::F32_MAX, [&](const u32 index, f32) { found[index]++; });
+        ExpectSameHits(expected, found);
+
+        // Sphere
+        reset();
+        const C3D::Sphere sphere = { ray.origin, C3D::Random.Generate(1.0f, 150.0f) };
+        for (u32 i = 0; i < count; ++i) expected[i] = BruteForceSphere(sphere, bounds[i]);
+        bvh.QuerySphere(sphere, [&](const u32 index) { found[index]++; });
+        ExpectSameHits(expected, found);
+
+        // Line
+        reset();
+        const f32 radius = C3D::Random.Generate(1.0f, 50.0f);
+        for (u32 i = 0; i < count; ++i) expected[i] = BruteForceLine(ray.origin, ray.direction, radius, bounds[i]);
+        bvh.QueryLine(ray.origin, ray.direction, radius, [&](const u32 index) { found[index]++; });
+        ExpectSameHits(expected, found);
+
+        // Frustum
+        reset();
+        const vec3 right   = glm::normalize(glm::cross(ray.direction, C3D::VEC3_UP));
+        const vec3 up      = glm::cross(right, ray.direction);
+        const auto frustum = C3D::Frustum(ray.origin, ray.direction, right, up, 0.1f, 400.0f, C3D::DegToRad(60.0f), 16.0f / 9.0f);
+        for (u32 i = 0; i < count; ++i) expected[i] = BruteForceFrustum(frustum, bounds[i]);
+        bvh.QueryFrustum(frustum, [&](const u32 index) { found[index]++; });
+        ExpectSameHits(expected, found);
+    }
+
+    bvh.Destroy();
+    bounds.Destroy();
+    userData.Destroy();
+    proxies.Destroy();
+    expected.Destroy();
+    found.Destroy();
+}
+
+TEST(BVHShouldFindAllObjectsAfterRefitting)
+{
+    constexpr u32 count     = 1000;
+    constexpr i32 worldSize = 250;
+
+    C3D::DynamicArray<C3D::Extents3D> bounds;
+    C3D::DynamicArray<u32> userData;
+    C3D::DynamicArray<u32> proxies(count);
+    FillRandomBounds(bounds, userData, count, worldSize);
+    proxies.Resize(count);
+
+    C3D::BVH bvh;
+    bvh.Create(count, 0.5f);
+    bvh.Build(bounds.GetData(), userData.GetData(), count, proxies.GetData());
+
+    C3D::DynamicArray<u8> found(count);
+    found.Resize(count);
+
+    for (u32 frame = 0; frame < 20; ++frame)
+    {
+        // Move a quarter of our objects around (some will stay within their fat bounds, others will need to be reinserted)
+        for (u32 i = 0; i < count / 4; ++i)
+        {
+            const auto index = C3D::Random.Generate(0u, count - 1);
+            const auto delta = GenerateRandomWholeVector(-2, 2);
+
+            bounds[index].min += delta;
+            bounds[index].max += delta;
+            bvh.Update(proxies[index], bounds[index]);
+        }
+
+        ExpectTrue(bvh.Validate());
+
+        // Every object should still be found by a query for it's own bounds
+        std::fill(found.begin(), found.end(), 0);
+        bvh.QueryBounds({ vec3(-worldSize - 100), vec3(worldSize + 100) }, [&](const u32 index) { found[index]++; });
+        for (u32 i = 0; i < count; ++i)
+        {
+            ExpectEqual(1, found[i]);
+        }
+
+        // And a sphere query should never miss an object (the fat bounds can only cause extra results)
+        const C3D::Sphere sphere = { vec3(0.0f), 100.0f };
+        std::fill(found.begin(), found.end(), 0);
+        bvh.QuerySphere(sphere, [&](const u32 index) { found[index]++; });
+        for (u32 i = 0; i < count; ++i)
+        {
+            if (BruteForceSphere(sphere, bounds[i])) ExpectEqual(1, found[i]);
+        }
+    }
+
+    // Rebuilding should give us a tree that is at least as good as the one we got from refitting
+    const auto costBefore = bvh.GetCost();
+    bvh.Rebuild();
+    ExpectTrue(bvh.Validate());
+    ExpectTrue(bvh.GetCost() <= costBefore * 1.05f);
+
+    bvh.Destroy();
+    bounds.Destroy();
+    userData.Destroy();
+    proxies.Destroy();
+    found.Destroy();
+}
+
+TEST(BVHBenchmark)
+{
+    constexpr u32 counts[] = { 1000, 10000, 100000 };
+    constexpr u32 queries  = 200;
+
+    C3D::DynamicArray<C3D::Extents3D> bounds;
+    C3D::DynamicArray<u32> userData;
+    C3D::DynamicArray<u32> proxies;
+    C3D::DynamicArray<C3D::Ray> rays(queries);
+
+    for (const auto count : counts)
+    {
+        // Keep the density of objects the same for every count
+        const auto worldSize = static_cast<i32>(50.0f * std::cbrt(static_cast<f32>(count)));
+
+        FillRandomBounds(bounds, userData, count, worldSize);
+        proxies.Resize(count);
+
+        rays.Clear();
+        for (u32 i = 0; i < queries; ++i) rays.PushBack(GenerateRandomRay(worldSize));
+
+        C3D::BVH bvh;
+        bvh.Create(count);
+
+        // SAH build
+        auto start = C3D::Platform::GetAbsoluteTime();
+        bvh.Build(bounds.GetData(), userData.GetData(), count, proxies.GetData());
+        const auto buildTime = C3D::Platform::GetAbsoluteTime() - start;
+        const auto buildCost = bvh.GetCost();
+
+        // Incremental insertion
+        C3D::BVH incremental;
+        incremental.Create(count);
+        start = C3D::Platform::GetAbsoluteTime();
+        for (u32 i = 0; i < count; ++i) incremental.Insert(bounds[i], i);
+        const auto insertTime = C3D::Platform::GetAbsoluteTime() - start;
+        const auto insertCost = incremental.GetCost();
+        incremental.Destroy();
+
+        // Refit after moving 10% of our objects
+        start = C3D::Platform::GetAbsoluteTime();
+        for (u32 i = 0; i < count; i += 10)
+        {
+            const auto delta = vec3(C3D::Random.Generate(-1.0f, 1.0f), 0.0f, C3D::Random.Generate(-1.0f, 1.0f));
+            bvh.Update(proxies[i], { bounds[i].min + delta, bounds[i].max + delta });
+        }
+        const auto updateTime = C3D::Platform::GetAbsoluteTime() - start;
+
+        // Ray queries
+        u64 bruteForceHits = 0, bvhHits = 0;
+
+        start = C3D::Platform::GetAbsoluteTime();
+        for (const auto& ray : rays)
+        {
+            for (const auto& b : bounds) bruteForceHits += BruteForceRay(ray, b);
+        }
+        const auto bruteForceRayTime = (C3D::Platform::GetAbsoluteTime() - start) / queries;
+
+        start = C3D::Platform::GetAbsoluteTime();
+        for (const auto& ray : rays)
+        {
+            bvh.QueryRay(ray, C3D::F32_MAX, [&](u32, f32) { bvhHits++; });
+        }
+        const auto bvhRayTime = (C3D::Platform::GetAbsoluteTime() - start) / queries;
+
+        // Sphere queries
+        start = C3D::Platform::GetAbsoluteTime();
+        for (const auto& ray : rays)
+        {
+            const C3D::Sphere sphere = { ray.origin, 25.0f };
+            for (const auto& b : bounds) bruteForceHits += BruteForceSphere(sphere, b);
+        }
+        const auto bruteForceSphereTime = (C3D::Platform::GetAbsoluteTime() - start) / queries;
+
+        start = C3D::Platform::GetAbsoluteTime();
+        for (const auto& ray : rays)
+        {
+            bvh.QuerySphere({ ray.origin, 25.0f }, [&](u32) { bvhHits++; });
+        }
+        const auto bvhSphereTime = (C3D::Platform::GetAbsoluteTime() - start) / queries;
+
+        // Frustum queries
+        start = C3D::Platform::GetAbsoluteTime();
+        for (const auto& ray : rays)
+        {
+            const vec3 right   = glm::normalize(glm::cross(ray.direction, C3D::VEC3_UP));
+            const auto frustum = C3D::Frustum(ray.origin, ray.direction, right, glm::cross(right, ray.direction), 0.1f, 250.0f,
+                                              C3D::DegToRad(60.0f), 16.0f / 9.0f);
+            for (const auto& b : bounds) bruteForceHits += BruteForceFrustum(frustum, b);
+        }
+        const auto bruteForceFrustumTime = (C3D::Platform::GetAbsoluteTime() - start) / queries;
+
+        start = C3D::Platform::GetAbsoluteTime();
+        for (const auto& ray : rays)
+        {
+            const vec3 right   = glm::normalize(glm::cross(ray.direction, C3D::VEC3_UP));
+            const auto frustum = C3D::Frustum(ray.origin, ray.direction, right, glm::cross(right, ray.direction), 0.1f, 250.0f,
+                                              C3D::DegToRad(60.0f), 16.0f / 9.0f);
+            bvh.QueryFrustum(frustum, [&](u32) { bvhHits++; });
+        }
+        const auto bvhFrustumTime = (C3D::Platform::GetAbsoluteTime() - start) / queries;
+
+        C3D::Logger::Info("BVH with {:>6} objects: build {:.2f}ms (cost {:.1f}), insert {:.2f}ms (cost {:.1f}), refit 10% {:.3f}ms.",
+                          count, buildTime * 1000.0, buildCost, insertTime * 1000.0, insertCost, updateTime * 1000.0);
+        C3D::Logger::Info("    Ray:     brute force {:.4f}ms, BVH {:.4f}ms ({:.1f}x).", bruteForceRayTime * 1000.0, bvhRayTime * 1000.0,
+                          bruteForceRayTime / bvhRayTime);
+        C3D::Logger::Info("    Sphere:  brute force {:.4f}ms, BVH {:.4f}ms ({:.1f}x).", bruteForceSphereTime * 1000.0,
+                          bvhSphereTime * 1000.0, bruteForceSphereTime / bvhSphereTime);
+        C3D::Logger::Info("    Frustum: brute force {:.4f}ms, BVH {:.4f}ms ({:.1f}x). Hits: {} vs {}.", bruteForceFrustumTime * 1000.0,
+                          bvhFrustumTime * 1000.0, bruteForceFrustumTime / bvhFrustumTime, bruteForceHits, bvhHits);
+
+        bvh.Destroy();
+    }
+
+    bounds.Destroy();
+    userData.Destroy();
+    proxies.Destroy();
+    rays.Destroy();
+}
+
+void BVH::RegisterTests(TestManager& manager)
+{
+    manager.StartType("BVH");
+    REGISTER_TEST(BVHShouldStayValidWhenInsertingAndRemoving, "The BVH should stay valid when inserting and removing objects.");
+    REGISTER_TEST(BVHUpdateShouldOnlyChangeTheTreeWhenLeavingTheFatBounds, "The BVH should only change when objects leave their bounds.");
+    REGISTER_TEST(BVHQueriesShouldMatchBruteForce, "Ray, sphere, line and frustum queries should give the same results as brute force.");
+    REGISTER_TEST(BVHShouldFindAllObjectsAfterRefitting, "The BVH should find all objects after they have been moved around.");
+    REGISTER_BENCHMARK(BVHBenchmark, "Benchmark building and querying a BVH with 1K to 100K objects.");
+}
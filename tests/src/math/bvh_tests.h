@@ -0,0 +1,7 @@
+#pragma once
+#include "../test_manager.h"
+
+namespace BVH
+{
+	void RegisterTests(TestManager& manager);
+}
@@ -0,0 +1,176 @@
+#include "frustum_tests.h"
+
+#include <containers/dynamic_array.h>
+#include <logger/logger.h>
+#include <math/aabb_list.h>
+#include <math/c3d_math.h>
+#include <math/frustum.h>
+#include <platform/platform.h>
+#include <random/random.h>
+
+#include <bit>
+
+#include "../expect.h"
+
+static C3D::Frustum CreateTestFrustum()
+{
+    // A camera at the origin looking down the -z axis with a 90 degree fov
+    return C3D::Frustum(vec3(0.0f), C3D::VEC3_FORWARD, C3D::VEC3_RIGHT, C3D::VEC3_UP, 0.1f, 1000.0f, C3D::DegToRad(90.0f), 16.0f / 9.0f);
+}
+
+static void FillRandomAABBs(C3D::AABBList<>& aabbs, const u64 count)
+{
+    aabbs.Clear();
+    aabbs.Reserve(count);
+
+    for (u64 i = 0; i < count; ++i)
+    {
+        const vec3 center  = { C3D::Random.Generate(-1500.0f, 1500.0f), C3D::Random.Generate(-1500.0f, 1500.0f),
+                               C3D::Random.Generate(-1500.0f, 1500.0f) };
+        const vec3 extents = { C3D::Random.Generate(0.1f, 25.0f), C3D::Random.Generate(0.1f, 25.0f), C3D::Random.Generate(0.1f, 25.0f) };
+        aabbs.PushBack({ center, extents });
+    }
+}
+
+TEST(FrustumShouldCullAABBs)
+{
+    const auto frustum = CreateTestFrustum();
+
+    C3D::AABBList<> aabbs;
+    // In front of the camera
+    aabbs.PushBack({ vec3(0.0f, 0.0f, -10.0f), vec3(1.0f) });
+    // Behind the camera
+    aabbs.PushBack({ vec3(0.0f, 0.0f, 10.0f), vec3(1.0f) });
+    // Far to the right of the camera
+    aabbs.PushBack({ vec3(500.0f, 0.0f, -10.0f), vec3(1.0f) });
+    // Beyond the far clip plane
+    aabbs.PushBack({ vec3(0.0f, 0.0f, -2000.0f), vec3(1.0f) });
+    // Center is outside of the frustum but the extents overlap with it
+    aabbs.PushBack({ vec3(0.0f, 0.0f, 5.0f), vec3(10.0f) });
+
+    u64 visibility = 0;
+    frustum.IntersectsWithAABBs(aabbs.GetArrays(), &visibility);
+
+    ExpectTrue(C3D::IsVisible(&visibility, 0));
+    ExpectFalse(C3D::IsVisible(&visibility, 1));
+    ExpectFalse(C3D::IsVisible(&visibility, 2));
+    ExpectFalse(C3D::IsVisible(&visibility, 3));
+    ExpectTrue(C3D::IsVisible(&visibility, 4));
+
+    // No bits should be set for AABBs that don't exist
+    ExpectEqual(0, visibility >> 5);
+
+    aabbs.Destroy();
+}
+
+TEST(FrustumBatchedCullingShouldMatchScalarCulling)
+{
+    const auto frustum = CreateTestFrustum();
+
+    // Test a bunch of counts that are (not) a multiple of the batch size to ensure the remainder is handled correctly
+    constexpr u64 counts[] = { 0, 1, 3, 4, 7, 8, 9, 63, 64, 65, 127, 1000, 4099 };
+
+    C3D::AABBList<> aabbs;
+    C3D::DynamicArray<u64> batched;
+    C3D::DynamicArray<u64> scalar;
+
+    for (const auto count : counts)
+    {
+        FillRandomAABBs(aabbs, count);
+
+        const auto maskSize = C3D::GetVisibilityMaskSize(count);
+        batched.Resize(maskSize + 1);
+        scalar.Resize(maskSize + 1);
+
+        // Our sentinel value should not be touched
+        batched[maskSize] = 0xDEADBEEF;
+
+        frustum.IntersectsWithAABBsScalar(aabbs.GetArrays(), scalar.GetData());
+        frustum.IntersectsWithAABBs(aabbs.GetArrays(), batched.GetData());
+
+        for (u64 i = 0; i < maskSize; ++i)
+        {
+            ExpectEqual(scalar[i], batched[i]);
+        }
+        ExpectEqual(0xDEADBEEF, batched[maskSize]);
+
+        // And both should match the single AABB test
+        for (u64 i = 0; i < count; ++i)
+        {
+            ExpectEqual(frustum.IntersectsWithAABB(aabbs.Get(i)), C3D::IsVisible(batched.GetData(), i));
+        }
+    }
+
+    aabbs.Destroy();
+}
+
+TEST(TransformedAABBShouldContainAllCorners)
+{
+    const vec3 center  = { 1.0f, 2.0f, 3.0f };
+    const vec3 extents = { 4.0f, 1.0f, 0.5f };
+
+    const mat4 translation = glm::translate(vec3(10.0f, -5.0f, 2.0f));
+    const mat4 rotation    = glm::rotate(C3D::DegToRad(45.0f), glm::normalize(vec3(1.0f, 1.0f, 0.0f)));
+    const mat4 model       = translation * rotation * glm::scale(vec3(2.0f, 1.0f, 3.0f));
+
+    const auto aabb = C3D::TransformAABB(model, center, extents);
+
+    for (u32 i = 0; i < 8; ++i)
+    {
+        const vec3 corner = center + vec3(i & 1 ? extents.x : -extents.x, i & 2 ? extents.y : -extents.y, i & 4 ? extents.z : -extents.z);
+        const vec3 world  = model * vec4(corner, 1.0f);
+        const vec3 offset = world - aabb.center;
+
+        ExpectTrue(C3D::Abs(offset.x) <= aabb.extents.x + 0.001f);
+        ExpectTrue(C3D::Abs(offset.y) <= aabb.extents.y + 0.001f);
+        ExpectTrue(C3D::Abs(offset.z) <= aabb.extents.z + 0.001f);
+    }
+}
+
+TEST(FrustumCullingBenchmark)
+{
+    constexpr u64 counts[] = { 10000, 100000, 1000000 };
+    constexpr u32 runs     = 10;
+
+    const auto frustum = CreateTestFrustum();
+
+    C3D::AABBList<> aabbs;
+    C3D::DynamicArray<u64> visibility;
+
+    for (const auto count : counts)
+    {
+        FillRandomAABBs(aabbs, count);
+        visibility.Resize(C3D::GetVisibilityMaskSize(count));
+
+        auto start = C3D::Platform::GetAbsoluteTime();
+        for (u32 run = 0; run < runs; ++run)
+        {
+            frustum.IntersectsWithAABBsScalar(aabbs.GetArrays(), visibility.GetData());
+        }
+        const auto scalarTime = (C3D::Platform::GetAbsoluteTime() - start) / runs;
+
+        start = C3D::Platform::GetAbsoluteTime();
+        for (u32 run = 0; run < runs; ++run)
+        {
+            frustum.IntersectsWithAABBs(aabbs.GetArrays(), visibility.GetData());
+        }
+        const auto batchedTime = (C3D::Platform::GetAbsoluteTime() - start) / runs;
+
+        u64 visible = 0;
+        for (const auto word : visibility) visible += std::popcount(word);
+
+        C3D::Logger::Info("Culling {:>7} AABBs ({} visible): scalar {:.3f}ms, batched {:.3f}ms ({:.2f}x).", count, visible,
+                          scalarTime * 1000.0, batchedTime * 1000.0, scalarTime / batchedTime);
+    }
+
+    aabbs.Destroy();
+}
+
+void Frustum::RegisterTests(TestManager& manager)
+{
+    manager.StartType("Frustum");
+    REGISTER_TEST(FrustumShouldCullAABBs, "Frustum should only mark AABBs that intersect with it as visible.");
+    REGISTER_TEST(FrustumBatchedCullingShouldMatchScalarCulling, "Batched frustum culling should give the same results as scalar culling.");
+    REGISTER_TEST(TransformedAABBShouldContainAllCorners, "A transformed AABB should contain all transformed corners of the original.");
+    REGISTER_BENCHMARK(FrustumCullingBenchmark, "Benchmark frustum culling of 10K to 1M AABBs.");
+}
@@ -3,12 +3,17 @@
 
 #include <defines.h>
 #include <memory/allocators/dynamic_allocator.h>
+#include <logger/logger.h>
 #include <memory/global_memory_system.h>
 #include <metrics/metrics.h>
+#include <platform/platform.h>
 #include <random/random.h>
 
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <thread>
+#include <vector>
 
 #include "../expect.h"
 
@@ -81,7 +86,7 @@ void MakeAllocations(std::array<AllocStruct, Size>& data, C3D::DynamicAllocator&
 
         // Check if the allocated alignment matches our requested alignment
         u16 allocatedAlignment = 0;
-        Memory.GetAlignment(allocation.dataPtr, &allocatedAlignment);
+        allocator.GetAlignment(allocation.dataPtr, &allocatedAlignment);
         ExpectEqual(alignment, allocatedAlignment);
 
         // Fill our entire array with our randomly generated char for the entire size of our dataPtr
@@ -132,7 +137,7 @@ TEST(DynamicAllocatorShouldDoRandomSmallAllocationsAndFrees)
 }
 
 template <u64 Size>
-void IsDataCorrect(const std::array<AllocStruct, Size>& data)
+void IsDataCorrect(const std::array<AllocStruct, Size>& data, const C3D::DynamicAllocator& allocator)
 {
     // Verify that all our data is still correct
     for (const auto& d : data)
@@ -141,7 +146,7 @@ void IsDataCorrect(const std::array<AllocStruct, Size>& data)
 
         // Check if the allocated alignment matches our expected alignment
         u16 allocatedAlignment = 0;
-        Memory.GetAlignment(d.dataPtr, &allocatedAlignment);
+        allocator.GetAlignment(d.dataPtr, &allocatedAlignment);
         ExpectEqual(d.alignment, allocatedAlignment);
 
         for (u64 i = 0; i < d.size; i++)
@@ -169,7 +174,7 @@ TEST(DynamicAllocatorShouldHaveNoDataCorruption)
     MakeAllocations(allocations, allocator);
 
     // Verify that all our data is still correct
-    IsDataCorrect(allocations);
+    IsDataCorrect(allocations, allocator);
 
     // Cleanup our data
     CleanupAllocations(allocations, allocator);
@@ -216,19 +221,19 @@ TEST(DynamicAllocatorShouldHaveNoDataCorruptionWithFrees)
     MakeAllocations(allocations, allocator);
 
     // Verify our memory
-    IsDataCorrect(allocations);
+    IsDataCorrect(allocations, allocator);
 
     // Free ~800 random allocations
     FreeRandomAllocations(allocations, allocator, 800);
 
     // Verify our memory again
-    IsDataCorrect(allocations);
+    IsDataCorrect(allocations, allocator);
 
     // Make some allocations
     MakeAllocations(allocations, allocator);
 
     // Verify our memory again
-    IsDataCorrect(allocations);
+    IsDataCorrect(allocations, allocator);
 
     // Cleanup our data
     CleanupAllocations(allocations, allocator);
@@ -237,6 +242,438 @@ TEST(DynamicAllocatorShouldHaveNoDataCorruptionWithFrees)
     Memory.Free(memoryBlock);
 }
 
+TEST(DynamicAllocatorShouldServeSmallAllocationsFromSlabs)
+{
+    constexpr u64 usableMemory = MebiBytes(16);
+    constexpr u64 neededMemory = C3D::DynamicAllocator::GetMemoryRequirements(usableMemory);
+
+    const auto memoryBlock = Memory.AllocateBlock(C3D::MemoryType::DynamicAllocator, neededMemory);
+
+    C3D::DynamicAllocator allocator;
+    allocator.Create(memoryBlock, neededMemory, usableMemory);
+    ExpectTrue(allocator.AreSlabsEnabled());
+
+    constexpr u64 sizes[]      = { 1, 16, 17, 100, 512, 1000, 4096, 4097, 10000 };
+    constexpr u16 alignments[] = { 1, 8, 64, 256 };
+
+    std::vector<void*> blocks;
+    for (const auto size : sizes)
+    {
+        for (const auto alignment : alignments)
+        {
+            const auto block = allocator.AllocateBlock(C3D::MemoryType::Test, size, alignment);
+            ExpectNotEqual(nullptr, block);
+            ExpectEqual(0, reinterpret_cast<u64>(block) % alignment);
+
+            // Memory should always be zeroed
+            const auto bytes = static_cast<u8*>(block);
+            for (u64 i = 0; i < size; ++i)
+            {
+                ExpectEqual(0, bytes[i]);
+            }
+            std::memset(block, 0xFF, size);
+
+            u64 allocatedSize      = 0;
+            u16 allocatedAlignment = 0;
+            ExpectTrue(allocator.GetSizeAlignment(block, &allocatedSize, &allocatedAlignment));
+            ExpectEqual(size, allocatedSize);
+            ExpectEqual(alignment, allocatedAlignment);
+
+            blocks.push_back(block);
+        }
+    }
+
+    // Every allocation should be tracked for it's memory type
+    ExpectEqual(blocks.size(), Metrics.GetAllocCount(C3D::MemoryType::Test, allocator.GetId()));
+    ExpectNotEqual(0, Metrics.GetRequestedMemoryUsage(C3D::MemoryType::Test, allocator.GetId()));
+
+    for (const auto block : blocks)
+    {
+        allocator.Free(block);
+    }
+
+    ExpectEqual(0, Metrics.GetAllocCount(C3D::MemoryType::Test, allocator.GetId()));
+    ExpectEqual(0, Metrics.GetRequestedMemoryUsage(C3D::MemoryType::Test, allocator.GetId()));
+    ExpectEqual(0, Metrics.GetMemoryUsage(C3D::MemoryType::Test, allocator.GetId()));
+
+    // All slabs are empty again so all memory should be available
+    ExpectEqual(usableMemory, allocator.FreeSpace());
+
+    allocator.Destroy();
+    Memory.Free(memoryBlock);
+}
+
+TEST(DynamicAllocatorShouldReuseSlabSlots)
+{
+    constexpr u64 usableMemory = MebiBytes(16);
+    constexpr u64 neededMemory = C3D::DynamicAllocator::GetMemoryRequirements(usableMemory);
+
+    const auto memoryBlock = Memory.AllocateBlock(C3D::MemoryType::DynamicAllocator, neededMemory);
+
+    C3D::DynamicAllocator allocator;
+    allocator.Create(memoryBlock, neededMemory, usableMemory);
+
+    // Fill multiple slabs completely so we also hit the full slab paths
+    std::vector<void*> blocks;
+    for (u32 i = 0; i < 10000; ++i)
+    {
+        blocks.push_back(allocator.AllocateBlock(C3D::MemoryType::Test, 24, 8));
+    }
+
+    // Free every other block and allocate them again which should give us the same slots back
+    for (u32 i = 0; i < blocks.size(); i += 2)
+    {
+        allocator.Free(blocks[i]);
+    }
+
+    const auto freeSpace = allocator.FreeSpace();
+    for (u32 i = 0; i < blocks.size(); i += 2)
+    {
+        blocks[i] = allocator.AllocateBlock(C3D::MemoryType::Test, 24, 8);
+    }
+    ExpectEqual(freeSpace, allocator.FreeSpace());
+
+    std::sort(blocks.begin(), blocks.end());
+    ExpectTrue(std::adjacent_find(blocks.begin(), blocks.end()) == blocks.end());
+
+    for (const auto block : blocks)
+    {
+        allocator.Free(block);
+    }
+
+    ExpectEqual(usableMemory, allocator.FreeSpace());
+
+    allocator.Destroy();
+    Memory.Free(memoryBlock);
+}
+
+/** @brief Small and fast random number generator so every thread can generate it's own random sizes. */
+struct XorShift
+{
+    u32 Next()
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    u32 Range(const u32 min, const u32 max) { return min + Next() % (max - min + 1); }
+
+    u32 state;
+};
+
+TEST(DynamicAllocatorShouldBeThreadSafe)
+{
+    constexpr u64 usableMemory = MebiBytes(16);
+    constexpr u64 neededMemory = C3D::DynamicAllocator::GetMemoryRequirements(usableMemory);
+    constexpr u32 threadCount  = 4;
+
+    const auto memoryBlock = Memory.AllocateBlock(C3D::MemoryType::DynamicAllocator, neededMemory);
+
+    C3D::DynamicAllocator allocator;
+    allocator.Create(memoryBlock, neededMemory, usableMemory);
+
+    std::atomic<u32> corruptions = 0;
+
+    std::vector<std::thread> threads;
+    for (u32 t = 0; t < threadCount; ++t)
+    {
+        threads.emplace_back([&allocator, &corruptions, t] {
+            XorShift random{ t + 1 };
+
+            struct Block
+            {
+                u8* ptr  = nullptr;
+                u32 size = 0;
+                u8 value = 0;
+            };
+            Block blocks[128];
+
+            for (u32 i = 0; i < 20000; ++i)
+            {
+                auto& block = blocks[random.Next() % 128];
+                if (block.ptr)
+                {
+                    for (u32 j = 0; j < block.size; ++j)
+                    {
+                        if (block.ptr[j] != block.value) corruptions++;
+                    }
+                    allocator.Free(block.ptr);
+                }
+
+                block.size  = random.Range(1, i % 10 == 0 ? KibiBytes(16) : 512);
+                block.value = static_cast<u8>(random.Next());
+                block.ptr   = static_cast<u8*>(allocator.AllocateBlock(C3D::MemoryType::Test, block.size, 8));
+                std::memset(block.ptr, block.value, block.size);
+            }
+
+            for (auto& block : blocks)
+            {
+                if (block.ptr) allocator.Free(block.ptr);
+            }
+        });
+    }
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    ExpectEqual(0, corruptions.load());
+    ExpectEqual(0, Metrics.GetAllocCount(C3D::MemoryType::Test, allocator.GetId()));
+
+    allocator.Destroy();
+    Memory.Free(memoryBlock);
+}
+
+enum class AllocationWorkload
+{
+    /** @brief Only small allocations (16 - 256 bytes) with a small working set. */
+    Small,
+    /** @brief Mostly small allocations with some larger ones (4 - 64 KiB) mixed in. */
+    Mixed,
+    /** @brief Allocates a lot of blocks of random sizes, frees every other one and then allocates differently sized blocks. */
+    Fragmenting,
+};
+
+static void RunAllocationWorkload(const C3D::DynamicAllocator& allocator, const AllocationWorkload workload, const u32 seed,
+                                  const u64 operations)
+{
+    XorShift random{ seed };
+
+    constexpr u32 workingSetSize     = 256;
+    void* workingSet[workingSetSize] = {};
+
+    u64 done = 0;
+    while (done < operations)
+    {
+        switch (workload)
+        {
+            case AllocationWorkload::Small:
+            case AllocationWorkload::Mixed:
+            {
+                auto& block = workingSet[random.Next() % workingSetSize];
+                if (block) allocator.Free(block);
+
+                u32 size;
+                if (workload == AllocationWorkload::Mixed && random.Next() % 10 == 0)
+                {
+                    size = random.Range(KibiBytes(4), KibiBytes(64));
+                }
+                else
+                {
+                    size = random.Range(16, workload == AllocationWorkload::Small ? 256 : 1024);
+                }
+
+                block = allocator.AllocateBlock(C3D::MemoryType::Test, size, 8);
+                done++;
+                break;
+            }
+            case AllocationWorkload::Fragmenting:
+            {
+                for (auto& block : workingSet)
+                {
+                    block = allocator.AllocateBlock(C3D::MemoryType::Test, random.Range(16, KibiBytes(8)), 8);
+                }
+                for (u32 i = 0; i < workingSetSize; i += 2)
+                {
+                    allocator.Free(workingSet[i]);
+                    workingSet[i] = allocator.AllocateBlock(C3D::MemoryType::Test, random.Range(16, KibiBytes(8)), 8);
+                }
+                for (auto& block : workingSet)
+                {
+                    allocator.Free(block);
+                    block = nullptr;
+                }
+                done += workingSetSize * 2 + workingSetSize / 2;
+                break;
+            }
+        }
+    }
+
+    for (const auto block : workingSet)
+    {
+        if (block) allocator.Free(block);
+    }
+}
+
+TEST(DynamicAllocatorBenchmark)
+{
+    constexpr u64 usableMemory    = MebiBytes(96);
+    constexpr u64 neededMemory    = C3D::DynamicAllocator::GetMemoryRequirements(usableMemory);
+    constexpr u64 operations      = 100000;
+    constexpr u32 threadCounts[]  = { 1, 2, 4, 8, 16 };
+    constexpr const char* names[] = { "Small", "Mixed", "Fragmenting" };
+    constexpr const char* modes[] = { "freelist", "slabs", "caches" };
+
+    const auto memoryBlock = Memory.AllocateBlock(C3D::MemoryType::DynamicAllocator, neededMemory);
+
+    for (u32 w = 0; w < 3; ++w)
+    {
+        const auto workload = static_cast<AllocationWorkload>(w);
+
+        for (u32 mode = 0; mode < 3; ++mode)
+        {
+            for (const auto threadCount : threadCounts)
+            {
+                C3D::DynamicAllocator allocator;
+                allocator.Create(memoryBlock, neededMemory, usableMemory);
+                allocator.SetSlabsEnabled(mode > 0);
+                allocator.SetThreadCachesEnabled(mode > 1);
+
+                const auto start = C3D::Platform::GetAbsoluteTime();
+
+                std::vector<std::thread> threads;
+                for (u32 t = 0; t < threadCount; ++t)
+                {
+                    threads.emplace_back([&allocator, workload, t, threadCount] {
+                        RunAllocationWorkload(allocator, workload, t + 1, operations / threadCount);
+                    });
+                }
+                for (auto& thread : threads)
+                {
+                    thread.join();
+                }
+
+                const auto elapsed = C3D::Platform::GetAbsoluteTime() - start;
+
+                C3D::Logger::Info("DynamicAllocator ({:<8}) {:<11} workload with {:>2} threads: {} operations in {:.3f}ms ({:.0f} ops/s).",
+                                  modes[mode], names[w], threadCount, operations, elapsed * 1000.0,
+                                  static_cast<f64>(operations) / elapsed);
+
+                ExpectEqual(0, Metrics.GetAllocCount(C3D::MemoryType::Test, allocator.GetId()));
+                allocator.Destroy();
+            }
+        }
+    }
+
+    Memory.Free(memoryBlock);
+}
+
+TEST(DynamicAllocatorThreadCachesShouldKeepExactMetrics)
+{
+    constexpr u64 usableMemory    = MebiBytes(16);
+    constexpr u64 neededMemory    = C3D::DynamicAllocator::GetMemoryRequirements(usableMemory);
+    constexpr u32 threadCount     = 4;
+    constexpr u32 blocksPerThread = 1000;
+
+    const auto memoryBlock = Memory.AllocateBlock(C3D::MemoryType::DynamicAllocator, neededMemory);
+
+    C3D::DynamicAllocator allocator;
+    allocator.Create(memoryBlock, neededMemory, usableMemory);
+    ExpectTrue(allocator.SetThreadCachesEnabled(true));
+
+    std::vector<void*> blocks[threadCount];
+    std::atomic<u32> allocated = 0;
+    std::atomic<bool> exit     = false;
+
+    std::vector<std::thread> threads;
+    for (u32 t = 0; t < threadCount; ++t)
+    {
+        threads.emplace_back([&allocator, &blocks, &allocated, &exit, t] {
+            for (u32 i = 0; i < blocksPerThread; ++i)
+            {
+                // Allocate and free some extra blocks so the thread's cache has to refill and flush
+                const auto temp = allocator.AllocateBlock(C3D::MemoryType::Array, 64);
+                blocks[t].push_back(allocator.AllocateBlock(C3D::MemoryType::Test, 10 + i % 100, 8));
+                allocator.Free(temp);
+            }
+
+            allocated++;
+            // Keep the thread (and therefore it's cache) alive until the main thread has checked the metrics
+            while (!exit) std::this_thread::yield();
+        });
+    }
+
+    while (allocated < threadCount) std::this_thread::yield();
+
+    // The allocations are only counted by the thread caches so far, the MetricSystem should still report them exactly
+    u64 requested = 0;
+    for (u32 t = 0; t < threadCount; ++t)
+    {
+        for (u32 i = 0; i < blocksPerThread; ++i) requested += 10 + i % 100;
+    }
+
+    ExpectEqual(threadCount * blocksPerThread, Metrics.GetAllocCount(C3D::MemoryType::Test, allocator.GetId()));
+    ExpectEqual(requested, Metrics.GetRequestedMemoryUsage(C3D::MemoryType::Test, allocator.GetId()));
+    ExpectEqual(0, Metrics.GetAllocCount(C3D::MemoryType::Array, allocator.GetId()));
+
+    // Free all blocks from the main thread while their threads are still alive
+    for (auto& threadBlocks : blocks)
+    {
+        for (const auto block : threadBlocks)
+        {
+            u64 size      = 0;
+            u16 alignment = 0;
+            allocator.GetSizeAlignment(block, &size, &alignment);
+            ExpectEqual(8, alignment);
+            allocator.Free(block);
+        }
+    }
+
+    ExpectEqual(0, Metrics.GetAllocCount(C3D::MemoryType::Test, allocator.GetId()));
+    ExpectEqual(0, Metrics.GetRequestedMemoryUsage(C3D::MemoryType::Test, allocator.GetId()));
+    ExpectEqual(0, Metrics.GetAllocCount(allocator.GetId()));
+
+    exit = true;
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    // The exited threads have given their slots back so once we flush our own cache all memory should be available again
+    allocator.FlushThreadCache();
+    ExpectEqual(usableMemory, allocator.FreeSpace());
+
+    allocator.Destroy();
+    Memory.Free(memoryBlock);
+}
+
+TEST(DynamicAllocatorThreadCachesShouldHandleRunningOutOfMemory)
+{
+    constexpr u64 usableMemory = C3D::SLAB_MIN_ALLOCATOR_SIZE;
+    constexpr u64 neededMemory = C3D::DynamicAllocator::GetMemoryRequirements(usableMemory);
+
+    const auto memoryBlock = Memory.AllocateBlock(C3D::MemoryType::DynamicAllocator, neededMemory);
+
+    C3D::DynamicAllocator allocator;
+    allocator.Create(memoryBlock, neededMemory, usableMemory);
+    ExpectTrue(allocator.AreSlabsEnabled());
+    ExpectTrue(allocator.SetThreadCachesEnabled(true));
+
+    // Keep allocating slots from the largest size class until we can't create any more slabs
+    std::vector<void*> blocks;
+    while (true)
+    {
+        try
+        {
+            blocks.push_back(allocator.AllocateBlock(C3D::MemoryType::Test, C3D::SLAB_MAX_SIZE_CLASS));
+        }
+        catch (const std::bad_alloc&)
+        {
+            break;
+        }
+    }
+    ExpectNotEqual(0, blocks.size());
+    ExpectThrow(std::bad_alloc, [&allocator] { allocator.AllocateBlock(C3D::MemoryType::Test, C3D::SLAB_MAX_SIZE_CLASS); });
+
+    // Every slot that was taken from the slabs should have ended up in our cache (and therefore with us)
+    ExpectEqual(blocks.size(), Metrics.GetAllocCount(C3D::MemoryType::Test, allocator.GetId()));
+
+    for (const auto block : blocks)
+    {
+        allocator.Free(block);
+    }
+
+    // If a slot was lost while refilling our cache it's slab could never become empty and the memory would be gone for good
+    allocator.FlushThreadCache();
+    ExpectEqual(usableMemory, allocator.FreeSpace());
+
+    allocator.Destroy();
+    Memory.Free(memoryBlock);
+}
+
 void DynamicAllocator::RegisterTests(TestManager& manager)
 {
     manager.StartType("Dynamic Allocator");
@@ -246,4 +683,16 @@ void DynamicAllocator::RegisterTests(TestManager& manager)
     REGISTER_TEST(DynamicAllocatorShouldHaveNoDataCorruption, "Dynamic Allocator should always allocate without data corruption");
     REGISTER_TEST(DynamicAllocatorShouldHaveNoDataCorruptionWithFrees,
                   "Dynamic Allocator should always allocate and free without data corruption");
+    REGISTER_TEST(DynamicAllocatorShouldServeSmallAllocationsFromSlabs,
+                  "Dynamic Allocator should serve small allocations from slabs with the correct size, alignment and metrics.");
+    REGISTER_TEST(DynamicAllocatorShouldReuseSlabSlots, "Dynamic Allocator should reuse freed slab slots and give empty slabs back.");
+    REGISTER_TEST(DynamicAllocatorShouldBeThreadSafe,
+                  "Dynamic Allocator should allocate and free from multiple threads without corruption.");
+    REGISTER_TEST(DynamicAllocatorThreadCachesShouldKeepExactMetrics,
+                  "Dynamic Allocator thread caches should keep exact metrics and allow blocks to be freed by other threads.");
+    REGISTER_TEST(DynamicAllocatorThreadCachesShouldHandleRunningOutOfMemory,
+                  "Dynamic Allocator thread caches should keep every slot they got when the allocator runs out of memory.");
+    REGISTER_BENCHMARK(DynamicAllocatorBenchmark,
+                       "Benchmark the Dynamic Allocator with the freelist, slabs and thread caches for small, mixed and fragmenting "
+                       "workloads on 1 to 16 threads.");
 }
@@ -0,0 +1,242 @@
+#include "frame_allocator_tests.h"
+
+#include <defines.h>
+#include <logger/logger.h>
+#include <memory/allocators/frame_allocator.h>
+#include <metrics/metrics.h>
+#include <platform/platform.h>
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include "../expect.h"
+
+TEST(FrameAllocatorShouldCreate)
+{
+    C3D::FrameAllocator allocator;
+    ExpectTrue(allocator.Create("Test Frame Allocator", MebiBytes(1), 2));
+
+    ExpectEqual(MebiBytes(1), allocator.GetFrameSize());
+    ExpectEqual(2, allocator.GetFrameCount());
+    ExpectEqual(MebiBytes(2), allocator.GetTotalSize());
+    ExpectNotEqual(nullptr, allocator.GetMemory());
+
+    allocator.Destroy();
+
+    // Invalid frame counts should be rejected
+    C3D::FrameAllocator invalid;
+    ExpectFalse(invalid.Create("Invalid Frame Allocator", MebiBytes(1), C3D::FRAME_ALLOCATOR_MAX_FRAMES + 1));
+}
+
+TEST(FrameAllocatorShouldAlignAndZeroAllocations)
+{
+    C3D::FrameAllocator allocator;
+    allocator.Create("Test Frame Allocator", MebiBytes(1), 1);
+
+    for (u16 alignment = 1; alignment <= 256; alignment *= 2)
+    {
+        auto block = static_cast<u8*>(allocator.AllocateBlock(C3D::MemoryType::Test, 24, alignment));
+        ExpectEqual(0, reinterpret_cast<u64>(block) % alignment);
+
+        for (u32 i = 0; i < 24; ++i)
+        {
+            ExpectEqual(0, block[i]);
+        }
+        std::memset(block, 0xFF, 24);
+    }
+
+    // Large allocations bypass the thread regions but should be aligned just the same
+    const auto large = allocator.AllocateBlock(C3D::MemoryType::Test, C3D::FRAME_ALLOCATOR_MAX_REGION_ALLOCATION * 2, 64);
+    ExpectEqual(0, reinterpret_cast<u64>(large) % 64);
+
+    // After the frame is reused all memory we hand out should be zeroed again
+    allocator.BeginFrame();
+    auto block = static_cast<u8*>(allocator.AllocateBlock(C3D::MemoryType::Test, 24, 1));
+    for (u32 i = 0; i < 24; ++i)
+    {
+        ExpectEqual(0, block[i]);
+    }
+
+    allocator.Destroy();
+}
+
+TEST(FrameAllocatorShouldKeepPreviousFramesAlive)
+{
+    C3D::FrameAllocator allocator;
+    allocator.Create("Test Frame Allocator", MebiBytes(1), 2);
+
+    // Frame N
+    auto frameN = allocator.Allocate<u32>(C3D::MemoryType::Test, 64);
+    for (u32 i = 0; i < 64; ++i) frameN[i] = i;
+
+    // Frame N + 1 should not touch the memory of frame N
+    allocator.BeginFrame();
+    auto frameN1 = allocator.Allocate<u32>(C3D::MemoryType::Test, 64);
+    for (u32 i = 0; i < 64; ++i) frameN1[i] = 1000 + i;
+
+    ExpectTrue(frameN1 != frameN);
+    for (u32 i = 0; i < 64; ++i)
+    {
+        ExpectEqual(i, frameN[i]);
+    }
+
+    // Frame N + 2 reuses the memory of frame N
+    allocator.BeginFrame();
+    auto frameN2 = allocator.Allocate<u32>(C3D::MemoryType::Test, 64);
+    ExpectTrue(frameN2 == frameN);
+    for (u32 i = 0; i < 64; ++i)
+    {
+        ExpectEqual(1000 + i, frameN1[i]);
+    }
+
+    allocator.Destroy();
+}
+
+TEST(FrameAllocatorShouldThrowWhenFrameIsFull)
+{
+    C3D::FrameAllocator allocator;
+    allocator.Create("Test Frame Allocator", KibiBytes(256), 2);
+
+    ExpectThrow(std::bad_alloc, [&] { allocator.AllocateBlock(C3D::MemoryType::Test, KibiBytes(512)); });
+
+    // Small allocations should be able to use up (almost) the entire frame
+    u64 allocated = 0;
+    ExpectThrow(std::bad_alloc, [&] {
+        while (true)
+        {
+            allocator.AllocateBlock(C3D::MemoryType::Test, KibiBytes(8));
+            allocated += KibiBytes(8);
+        }
+    });
+    ExpectTrue(allocated >= KibiBytes(256) - C3D::FRAME_ALLOCATOR_THREAD_REGION_SIZE);
+
+    // A new frame has all memory available again
+    allocator.BeginFrame();
+    ExpectNotEqual(nullptr, allocator.AllocateBlock(C3D::MemoryType::Test, KibiBytes(128)));
+
+    allocator.Destroy();
+}
+
+TEST(FrameAllocatorShouldBeThreadSafe)
+{
+    constexpr u32 threadCount          = 8;
+    constexpr u32 allocationsPerThread = 3000;
+
+    struct Block
+    {
+        u8* data;
+        u64 size;
+    };
+
+    C3D::FrameAllocator allocator;
+    allocator.Create("Test Frame Allocator", MebiBytes(8), 2);
+
+    std::vector<std::vector<Block>> blocks(threadCount);
+    std::vector<u32> slots(threadCount);
+    std::vector<std::thread> threads;
+
+    for (u32 t = 0; t < threadCount; ++t)
+    {
+        threads.emplace_back([&allocator, &blocks, &slots, t] {
+            slots[t] = C3D::FrameAllocator::GetThreadSlot();
+
+            for (u32 i = 0; i < allocationsPerThread; ++i)
+            {
+                // Mostly small allocations with the occasional large one that bypasses the thread's region
+                const u64 size = i % 500 == 0 ? KibiBytes(32) : 8 + (i * 7 + t) % 256;
+                auto data      = static_cast<u8*>(allocator.AllocateBlock(C3D::MemoryType::Test, size, 8));
+                std::memset(data, static_cast<u8>(t + 1), size);
+                blocks[t].push_back({ data, size });
+            }
+        });
+    }
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    // No thread should have overwritten the memory of another thread
+    std::vector<Block> all;
+    for (u32 t = 0; t < threadCount; ++t)
+    {
+        for (const auto& block : blocks[t])
+        {
+            for (u64 i = 0; i < block.size; ++i)
+            {
+                if (block.data[i] != t + 1) AssertFail("Memory was overwritten by another thread.");
+            }
+            all.push_back(block);
+        }
+    }
+
+    // And no blocks should overlap
+    std::sort(all.begin(), all.end(), [](const Block& a, const Block& b) { return a.data < b.data; });
+    for (u64 i = 1; i < all.size(); ++i)
+    {
+        ExpectTrue(all[i - 1].data + all[i - 1].size <= all[i].data);
+    }
+
+    // Every thread should have a high-water mark that matches the amount of memory it allocated
+    allocator.BeginFrame();
+    for (u32 t = 0; t < threadCount; ++t)
+    {
+        u64 allocated = 0;
+        for (const auto& block : blocks[t]) allocated += block.size;
+
+        if (slots[t] != INVALID_ID)
+        {
+            ExpectEqual(allocated, allocator.GetThreadHighWaterMark(slots[t]));
+            ExpectEqual(allocated, Metrics.GetThreadHighWaterMark(allocator.GetId(), slots[t]));
+        }
+    }
+
+    allocator.Destroy();
+}
+
+TEST(FrameAllocatorBenchmark)
+{
+    constexpr u32 threadCounts[] = { 1, 2, 4, 8 };
+    constexpr u32 allocations    = 250000;
+
+    for (const auto threadCount : threadCounts)
+    {
+        C3D::FrameAllocator allocator;
+        allocator.Create("Benchmark Frame Allocator", MebiBytes(32), 2);
+
+        const auto start = C3D::Platform::GetAbsoluteTime();
+
+        std::vector<std::thread> threads;
+        for (u32 t = 0; t < threadCount; ++t)
+        {
+            threads.emplace_back([&allocator, threadCount] {
+                for (u32 i = 0; i < allocations / threadCount; ++i)
+                {
+                    allocator.AllocateBlock(C3D::MemoryType::Test, 16 + (i % 8) * 16, 16);
+                }
+            });
+        }
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        const auto elapsed = C3D::Platform::GetAbsoluteTime() - start;
+        C3D::Logger::Info("FrameAllocator with {} threads: {} allocations in {:.3f}ms ({:.0f} allocations/s). Frame usage: {} bytes.",
+                          threadCount, allocations, elapsed * 1000.0, allocations / elapsed, allocator.GetAllocated());
+
+        allocator.Destroy();
+    }
+}
+
+void FrameAllocator::RegisterTests(TestManager& manager)
+{
+    manager.StartType("Frame Allocator");
+    REGISTER_TEST(FrameAllocatorShouldCreate, "Frame Allocator should correctly create and destroy.");
+    REGISTER_TEST(FrameAllocatorShouldAlignAndZeroAllocations, "Frame Allocator should align and zero every allocation.");
+    REGISTER_TEST(FrameAllocatorShouldKeepPreviousFramesAlive, "Frame Allocator should keep the memory of previous frames alive.");
+    REGISTER_TEST(FrameAllocatorShouldThrowWhenFrameIsFull, "Frame Allocator should throw if a frame runs out of memory.");
+    REGISTER_TEST(FrameAllocatorShouldBeThreadSafe, "Frame Allocator should be usable from multiple threads at once.");
+    REGISTER_BENCHMARK(FrameAllocatorBenchmark, "Benchmark the Frame Allocator with 1 to 8 threads.");
+}
@@ -0,0 +1,448 @@
+#include "free_list_tests.h"
+
+#include <defines.h>
+#include <logger/logger.h>
+#include <memory/allocators/dynamic_allocator.h>
+#include <memory/free_list.h>
+#include <memory/global_memory_system.h>
+#include <metrics/metrics.h>
+#include <platform/platform.h>
+#include <random/random.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "../expect.h"
+
+/** @brief A FreeList together with the memory for it's nodes. */
+struct TestFreeList
+{
+    TestFreeList(const u64 managedSize, const u64 smallestAllocation = 8)
+    {
+        nodesSize = C3D::FreeList::GetMemoryRequirement(managedSize, smallestAllocation);
+        nodes     = Memory.AllocateBlock(C3D::MemoryType::FreeList, nodesSize);
+        list.Create(nodes, nodesSize, smallestAllocation, managedSize);
+    }
+
+    ~TestFreeList()
+    {
+        list.Destroy();
+        Memory.Free(nodes);
+    }
+
+    C3D::FreeList list;
+    void* nodes   = nullptr;
+    u64 nodesSize = 0;
+};
+
+struct FreeListBlock
+{
+    u64 offset;
+    u64 size;
+};
+
+/** @brief Checks that none of the provided (allocated) blocks overlap and that they, together with the free space, add up to the total. */
+static bool AreBlocksValid(std::vector<FreeListBlock> blocks, const C3D::FreeList& list, const u64 managedSize)
+{
+    std::sort(blocks.begin(), blocks.end(), [](const FreeListBlock& a, const FreeListBlock& b) { return a.offset < b.offset; });
+
+    u64 allocated = 0;
+    for (u64 i = 0; i < blocks.size(); ++i)
+    {
+        if (blocks[i].offset + blocks[i].size > managedSize) return false;
+        if (i > 0 && blocks[i - 1].offset + blocks[i - 1].size > blocks[i].offset) return false;
+        allocated += blocks[i].size;
+    }
+    return allocated + list.FreeSpace() == managedSize;
+}
+
+TEST(FreeListShouldAllocateAndFree)
+{
+    TestFreeList freeList(KibiBytes(4));
+    auto& list = freeList.list;
+
+    ExpectEqual(KibiBytes(4), list.FreeSpace());
+    ExpectEqual(1, list.GetFreeBlockCount());
+
+    u64 a, b;
+    ExpectTrue(list.AllocateBlock(256, &a));
+    ExpectTrue(list.AllocateBlock(512, &b));
+    ExpectEqual(0, a);
+    ExpectEqual(256, b);
+    ExpectEqual(KibiBytes(4) - 768, list.FreeSpace());
+
+    ExpectTrue(list.FreeBlock(256, a));
+    ExpectTrue(list.FreeBlock(512, b));
+    ExpectEqual(KibiBytes(4), list.FreeSpace());
+    ExpectEqual(1, list.GetFreeBlockCount());
+
+    // The entire range should be allocatable again
+    u64 all;
+    ExpectTrue(list.AllocateBlock(KibiBytes(4), &all));
+    ExpectEqual(0, all);
+    ExpectEqual(0, list.FreeSpace());
+    ExpectEqual(0, list.GetFreeBlockCount());
+
+    ExpectThrow(std::bad_alloc, [&] { list.AllocateBlock(8, &all); });
+
+    ExpectTrue(list.FreeBlock(KibiBytes(4), all));
+    ExpectEqual(KibiBytes(4), list.FreeSpace());
+}
+
+TEST(FreeListShouldHoldAsManyFreeBlocksAsRequired)
+{
+    constexpr u64 managedSize = KibiBytes(96);
+    constexpr u64 blockCount  = 1024;
+    constexpr u64 blockSize   = managedSize / blockCount;
+
+    // The memory requirement should give us a node for every 24 of the smallest possible allocations, regardless of the size of a node
+    TestFreeList freeList(managedSize, 8);
+    auto& list = freeList.list;
+
+    std::vector<u64> offsets(blockCount);
+    for (auto& offset : offsets)
+    {
+        ExpectTrue(list.AllocateBlock(blockSize, &offset));
+    }
+
+    // Freeing every other block leaves 512 free blocks that can't be merged, which all need their own node
+    for (u64 i = 0; i < blockCount; i += 2)
+    {
+        ExpectTrue(list.FreeBlock(blockSize, offsets[i]));
+    }
+    ExpectEqual(blockCount / 2, list.GetFreeBlockCount());
+
+    for (u64 i = 1; i < blockCount; i += 2)
+    {
+        ExpectTrue(list.FreeBlock(blockSize, offsets[i]));
+    }
+    ExpectEqual(1, list.GetFreeBlockCount());
+    ExpectEqual(managedSize, list.FreeSpace());
+}
+
+TEST(FreeListMemoryRequirementShouldStayCloseToBaseline)
+{
+    // Before the free blocks were indexed by two trees a node took 24 bytes and we reserved one for every 24 smallest allocations
+    constexpr auto baseline = [](const u64 usableSize, const u64 smallest) { return usableSize / (smallest * 24) * 24; };
+
+    // The sizes used by the RenderBuffer (vertex and index buffer) and by our global DynamicAllocator
+    constexpr u64 sizes[]     = { sizeof(f32) * 15 * 4096 * 4096, sizeof(u32) * 8192 * 8192, GibiBytes(1) };
+    constexpr u64 smallests[] = { 8, 64 };
+
+    for (const auto size : sizes)
+    {
+        for (const auto smallest : smallests)
+        {
+            // The nodes now take 32 bytes instead of 24 so we allow for at most a third more memory
+            const auto requirement = C3D::FreeList::GetMemoryRequirement(size, smallest);
+            ExpectTrue(requirement <= baseline(size, smallest) * 4 / 3 + 32);
+        }
+    }
+}
+
+TEST(FreeListShouldUseBestFit)
+{
+    TestFreeList freeList(KibiBytes(4));
+    auto& list = freeList.list;
+
+    u64 offsets[6];
+    constexpr u64 sizes[6] = { 128, 64, 64, 32, 64, 256 };
+    for (u32 i = 0; i < 6; ++i)
+    {
+        list.AllocateBlock(sizes[i], &offsets[i]);
+    }
+
+    // Create a hole of 128 bytes, a hole of 32 bytes and a hole of 64 bytes
+    list.FreeBlock(sizes[0], offsets[0]);
+    list.FreeBlock(sizes[3], offsets[3]);
+    list.FreeBlock(sizes[5], offsets[5]);
+
+    // The smallest hole that fits should be used even though larger holes exist at lower offsets
+    u64 offset;
+    list.AllocateBlock(32, &offset);
+    ExpectEqual(offsets[3], offset);
+
+    list.AllocateBlock(100, &offset);
+    ExpectEqual(offsets[0], offset);
+
+    // The hole left over by the previous allocation (28 bytes) is now the best fit
+    list.AllocateBlock(16, &offset);
+    ExpectEqual(offsets[0] + 100, offset);
+}
+
+TEST(FreeListShouldCoalesceNeighbours)
+{
+    TestFreeList freeList(KibiBytes(1));
+    auto& list = freeList.list;
+
+    u64 offsets[4];
+    for (auto& offset : offsets)
+    {
+        list.AllocateBlock(256, &offset);
+    }
+    ExpectEqual(0, list.GetFreeBlockCount());
+
+    list.FreeBlock(256, offsets[0]);
+    list.FreeBlock(256, offsets[2]);
+    ExpectEqual(2, list.GetFreeBlockCount());
+    ExpectEqual(256, list.GetLargestFreeBlock());
+
+    // Freeing the block in between should merge all three blocks into one
+    list.FreeBlock(256, offsets[1]);
+    ExpectEqual(1, list.GetFreeBlockCount());
+    ExpectEqual(768, list.GetLargestFreeBlock());
+
+    list.FreeBlock(256, offsets[3]);
+    ExpectEqual(1, list.GetFreeBlockCount());
+    ExpectEqual(KibiBytes(1), list.GetLargestFreeBlock());
+}
+
+TEST(FreeListShouldRejectInvalidFrees)
+{
+    TestFreeList freeList(KibiBytes(1));
+    auto& list = freeList.list;
+
+    u64 offset;
+    list.AllocateBlock(256, &offset);
+
+    // Freeing memory that is already free or falls outside of the managed range should fail without corrupting the list
+    ExpectFalse(list.FreeBlock(64, 512));
+    ExpectFalse(list.FreeBlock(512, 0));
+    ExpectFalse(list.FreeBlock(64, KibiBytes(1)));
+
+    ExpectTrue(list.FreeBlock(256, offset));
+    ExpectEqual(1, list.GetFreeBlockCount());
+    ExpectEqual(KibiBytes(1), list.FreeSpace());
+}
+
+TEST(FreeListShouldResize)
+{
+    TestFreeList freeList(KibiBytes(1));
+    auto& list = freeList.list;
+
+    u64 a, b, c;
+    list.AllocateBlock(256, &a);
+    list.AllocateBlock(256, &b);
+    list.AllocateBlock(512, &c);
+    list.FreeBlock(256, a);
+
+    const auto newNodesSize = C3D::FreeList::GetMemoryRequirement(KibiBytes(2), 8);
+    const auto newNodes     = Memory.AllocateBlock(C3D::MemoryType::FreeList, newNodesSize);
+
+    void* oldNodes = nullptr;
+    ExpectTrue(list.Resize(newNodes, newNodesSize, KibiBytes(2), &oldNodes));
+    ExpectEqual(freeList.nodes, oldNodes);
+    Memory.Free(oldNodes);
+    freeList.nodes = newNodes;
+
+    // The free block at the start should be kept and the new memory should be added as a separate free block
+    ExpectEqual(KibiBytes(1) + 256, list.FreeSpace());
+    ExpectEqual(2, list.GetFreeBlockCount());
+
+    // Freeing the block at the end of the old range should merge it with the new memory
+    list.FreeBlock(512, c);
+    ExpectEqual(2, list.GetFreeBlockCount());
+    ExpectEqual(KibiBytes(1) + 512, list.GetLargestFreeBlock());
+
+    list.FreeBlock(256, b);
+    ExpectEqual(1, list.GetFreeBlockCount());
+    ExpectEqual(KibiBytes(2), list.FreeSpace());
+}
+
+TEST(FreeListShouldStayConsistentUnderRandomWorkload)
+{
+    constexpr u64 managedSize = MebiBytes(1);
+
+    TestFreeList freeList(managedSize);
+    auto& list = freeList.list;
+
+    std::vector<FreeListBlock> blocks;
+    for (u32 i = 0; i < 20000; ++i)
+    {
+        if (blocks.empty() || C3D::Random.Generate(0, 99) < 55)
+        {
+            const u64 size = C3D::Random.Generate<u64>(8, 2048);
+            if (size > list.GetLargestFreeBlock()) continue;
+
+            u64 offset;
+            list.AllocateBlock(size, &offset);
+            blocks.push_back({ offset, size });
+        }
+        else
+        {
+            const auto index = C3D::Random.Generate<u64>(0, blocks.size() - 1);
+            ExpectTrue(list.FreeBlock(blocks[index].size, blocks[index].offset));
+            blocks[index] = blocks.back();
+            blocks.pop_back();
+        }
+
+        if (i % 1000 == 0)
+        {
+            ExpectTrue(AreBlocksValid(blocks, list, managedSize));
+        }
+    }
+
+    ExpectTrue(AreBlocksValid(blocks, list, managedSize));
+
+    for (const auto& block : blocks)
+    {
+        ExpectTrue(list.FreeBlock(block.size, block.offset));
+    }
+
+    // Once everything is freed all free blocks should have been merged back into a single block
+    ExpectEqual(managedSize, list.FreeSpace());
+    ExpectEqual(1, list.GetFreeBlockCount());
+    ExpectEqual(managedSize, list.GetLargestFreeBlock());
+}
+
+TEST(FreeListShouldReportFragmentation)
+{
+    TestFreeList freeList(KibiBytes(64));
+    auto& list = freeList.list;
+
+    // Allocate 64 blocks of 1KiB and free every other one to create 32 holes of 1KiB
+    u64 offsets[64];
+    for (auto& offset : offsets)
+    {
+        list.AllocateBlock(KibiBytes(1), &offset);
+    }
+    for (u32 i = 0; i < 64; i += 2)
+    {
+        list.FreeBlock(KibiBytes(1), offsets[i]);
+    }
+
+    C3D::FragmentationReport report;
+    list.GetFragmentationReport(report);
+
+    ExpectEqual(KibiBytes(32), report.freeSpace);
+    ExpectEqual(KibiBytes(1), report.largestFreeBlock);
+    ExpectEqual(32, report.freeBlockCount);
+    ExpectEqual(32, report.histogram[C3D::FragmentationReport::GetBucket(KibiBytes(1))]);
+    ExpectTrue(report.GetFragmentation() > 0.9f);
+
+    u64 total = 0;
+    for (const auto count : report.histogram) total += count;
+    ExpectEqual(report.freeBlockCount, total);
+}
+
+TEST(FreeListFragmentationShouldBeExposedThroughMetrics)
+{
+    constexpr u64 usableMemory = MebiBytes(1);
+    constexpr u64 neededMemory = C3D::DynamicAllocator::GetMemoryRequirements(usableMemory);
+
+    const auto memoryBlock = Memory.AllocateBlock(C3D::MemoryType::DynamicAllocator, neededMemory);
+
+    C3D::DynamicAllocator allocator;
+    allocator.Create(memoryBlock, neededMemory, usableMemory);
+
+    C3D::FragmentationReport report;
+    ExpectTrue(Metrics.GetFragmentationReport(allocator.GetId(), report));
+    ExpectEqual(1, report.freeBlockCount);
+    ExpectEqual(report.freeSpace, report.largestFreeBlock);
+
+    // Allocations that are too large for slabs come from the FreeList so freeing every other one leaves holes behind
+    void* blocks[16];
+    for (auto& block : blocks)
+    {
+        block = allocator.AllocateBlock(C3D::MemoryType::Test, KibiBytes(16));
+    }
+    for (u32 i = 0; i < 16; i += 2)
+    {
+        allocator.Free(blocks[i]);
+    }
+
+    ExpectTrue(Metrics.GetFragmentationReport(allocator.GetId(), report));
+    ExpectEqual(9, report.freeBlockCount);
+    ExpectTrue(report.largestFreeBlock < report.freeSpace);
+
+    for (u32 i = 1; i < 16; i += 2)
+    {
+        allocator.Free(blocks[i]);
+    }
+
+    const auto id = allocator.GetId();
+    allocator.Destroy();
+    ExpectFalse(Metrics.GetFragmentationReport(id, report));
+
+    Memory.Free(memoryBlock);
+}
+
+TEST(FreeListBenchmark)
+{
+    constexpr u64 managedSize       = MebiBytes(64);
+    constexpr u64 operations        = 200000;
+    constexpr u64 freeBlockCounts[] = { 100, 1000, 10000, 50000 };
+
+    for (const auto targetFreeBlocks : freeBlockCounts)
+    {
+        TestFreeList freeList(managedSize);
+        auto& list = freeList.list;
+
+        // Fragment the list by allocating a lot of small blocks and freeing every other one
+        std::vector<FreeListBlock> blocks;
+        for (u64 i = 0; i < targetFreeBlocks * 2; ++i)
+        {
+            const u64 size = C3D::Random.Generate<u64>(16, 512);
+            u64 offset;
+            list.AllocateBlock(size, &offset);
+            blocks.push_back({ offset, size });
+        }
+
+        std::vector<FreeListBlock> live;
+        for (u64 i = 0; i < blocks.size(); ++i)
+        {
+            if (i % 2 == 0)
+                list.FreeBlock(blocks[i].size, blocks[i].offset);
+            else
+                live.push_back(blocks[i]);
+        }
+
+        const auto start = C3D::Platform::GetAbsoluteTime();
+
+        for (u64 i = 0; i < operations; ++i)
+        {
+            // Alternate between allocating and freeing random blocks so the amount of fragmentation stays roughly the same
+            if (i % 2 == 0)
+            {
+                const u64 size = C3D::Random.Generate<u64>(16, 512);
+                u64 offset;
+                list.AllocateBlock(size, &offset);
+                live.push_back({ offset, size });
+            }
+            else
+            {
+                const auto index = C3D::Random.Generate<u64>(0, live.size() - 1);
+                list.FreeBlock(live[index].size, live[index].offset);
+                live[index] = live.back();
+                live.pop_back();
+            }
+        }
+
+        const auto elapsed = C3D::Platform::GetAbsoluteTime() - start;
+
+        C3D::FragmentationReport report;
+        list.GetFragmentationReport(report);
+
+        C3D::Logger::Info("FreeList with ~{:>5} free blocks: {} operations in {:.3f}ms ({:.0f} ops/s). Ended with {} free blocks.",
+                          targetFreeBlocks, operations, elapsed * 1000.0, operations / elapsed, report.freeBlockCount);
+
+        ExpectTrue(AreBlocksValid(live, list, managedSize));
+    }
+}
+
+void FreeList::RegisterTests(TestManager& manager)
+{
+    manager.StartType("FreeList");
+    REGISTER_TEST(FreeListShouldAllocateAndFree, "FreeList should allocate and free blocks.");
+    REGISTER_TEST(FreeListShouldHoldAsManyFreeBlocksAsRequired, "FreeList should get enough nodes from GetMemoryRequirement().");
+    REGISTER_TEST(FreeListMemoryRequirementShouldStayCloseToBaseline, "FreeList should not need much more memory for nodes than before.");
+    REGISTER_TEST(FreeListShouldUseBestFit, "FreeList should allocate from the smallest free block that fits.");
+    REGISTER_TEST(FreeListShouldCoalesceNeighbours, "FreeList should merge freed blocks with their free neighbours.");
+    REGISTER_TEST(FreeListShouldRejectInvalidFrees, "FreeList should reject frees of memory that is already free or out of range.");
+    REGISTER_TEST(FreeListShouldResize, "FreeList should keep it's free blocks when resized.");
+    REGISTER_TEST(FreeListShouldStayConsistentUnderRandomWorkload, "FreeList should stay consistent under a random workload.");
+    REGISTER_TEST(FreeListShouldReportFragmentation, "FreeList should report it's fragmentation.");
+    REGISTER_TEST(FreeListFragmentationShouldBeExposedThroughMetrics,
+                  "The fragmentation of the DynamicAllocator's FreeList should be available through the MetricSystem.");
+    REGISTER_BENCHMARK(FreeListBenchmark, "Benchmark the FreeList with an increasing amount of free blocks.");
+}
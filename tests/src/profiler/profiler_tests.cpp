@@ -0,0 +1,150 @@
+#include "profiler_tests.h"
+
+#include <logger/logger.h>
+#include <platform/file_system.h>
+#include <platform/platform.h>
+#include <profiler/profiler.h>
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "../expect.h"
+
+namespace CpuProfiler
+{
+    void DoProfiledWork(const u32 iterations)
+    {
+        C3D::ProfileScope outer("Outer");
+        for (u32 i = 0; i < iterations; ++i)
+        {
+            C3D::ProfileScope inner("Inner \"quoted\"");
+        }
+    }
+
+    TEST(ProfilerShouldRejectInvalidCaptures)
+    {
+        ExpectFalse(Profiler.RequestCapture(0, "invalid_capture.json"));
+        ExpectFalse(Profiler.RequestCapture(C3D::PROFILER_MAX_CAPTURE_FRAMES + 1, "invalid_capture.json"));
+        ExpectFalse(Profiler.RequestCapture(2, ""));
+        ExpectFalse(Profiler.IsCaptureRequested());
+    }
+
+    TEST(ProfilerShouldOnlyRecordWhileCapturing)
+    {
+        // Scopes outside of a capture should not be recorded
+        ExpectFalse(Profiler.IsCapturing());
+        DoProfiledWork(16);
+
+        ExpectTrue(Profiler.RequestCapture(2, "profiler_capture.json"));
+        ExpectTrue(Profiler.IsCaptureRequested());
+        // A second capture can't be requested while the first one is not done
+        ExpectFalse(Profiler.RequestCapture(2, "profiler_capture_2.json"));
+        // The capture only starts at the next frame
+        ExpectFalse(Profiler.IsCapturing());
+
+        Profiler.BeginFrame();
+        ExpectTrue(Profiler.IsCapturing());
+
+        Profiler.BeginFrame();
+        ExpectTrue(Profiler.IsCapturing());
+
+        // After 2 full frames the capture should be done
+        Profiler.BeginFrame();
+        ExpectFalse(Profiler.IsCapturing());
+        ExpectFalse(Profiler.IsCaptureRequested());
+    }
+
+    TEST(ProfilerShouldCaptureScopesFromMultipleThreads)
+    {
+        constexpr u32 threadCount = 4;
+
+        ExpectTrue(Profiler.RequestCapture(1, "profiler_threads_capture.json"));
+        Profiler.BeginFrame();
+
+        std::vector<std::thread> threads;
+        for (u32 t = 0; t < threadCount; ++t)
+        {
+            threads.emplace_back([t] {
+                Profiler.SetThreadName(C3D::String::FromFormat("Test Thread {}", t).Data());
+                DoProfiledWork(8);
+            });
+        }
+
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        DoProfiledWork(8);
+
+        // End the capture which writes it to disk
+        Profiler.BeginFrame();
+        ExpectFalse(Profiler.IsCapturing());
+
+        C3D::File file;
+        ExpectTrue(file.Open("profiler_threads_capture.json", C3D::FileModeRead | C3D::FileModeBinary));
+
+        C3D::String json;
+        ExpectTrue(file.ReadAll(json));
+        file.Close();
+
+        ExpectTrue(std::strstr(json.Data(), R"({"displayTimeUnit":"ms","traceEvents":[)") == json.Data());
+        ExpectTrue(json.Size() >= 2 && json[json.Size() - 2] == ']' && json[json.Size() - 1] == '}');
+        ExpectTrue(std::strstr(json.Data(), R"("name":"Frame 0")") != nullptr);
+        ExpectTrue(std::strstr(json.Data(), R"("name":"Outer")") != nullptr);
+        // Names should be escaped
+        ExpectTrue(std::strstr(json.Data(), R"("name":"Inner \"quoted\"")") != nullptr);
+
+        for (u32 t = 0; t < threadCount; ++t)
+        {
+            const auto threadName = C3D::String::FromFormat(R"("args":{{"name":"Test Thread {}"}})", t);
+            ExpectTrue(std::strstr(json.Data(), threadName.Data()) != nullptr);
+        }
+
+        // Every thread (including the main thread) did 1 outer and 8 inner scopes
+        u32 outerCount = 0, innerCount = 0;
+        for (auto p = std::strstr(json.Data(), R"("name":"Outer")"); p; p = std::strstr(p + 1, R"("name":"Outer")")) outerCount++;
+        for (auto p = std::strstr(json.Data(), R"("depth":1)"); p; p = std::strstr(p + 1, R"("depth":1)")) innerCount++;
+
+        ExpectEqual(threadCount + 1, outerCount);
+        ExpectEqual((threadCount + 1) * 8, innerCount);
+    }
+
+    TEST(ProfilerBenchmark)
+    {
+        constexpr u32 scopeCount = 10000;
+
+        auto start = C3D::Platform::GetAbsoluteTime();
+        for (u32 i = 0; i < scopeCount; ++i)
+        {
+            C3D::ProfileScope scope("Benchmark");
+        }
+        const auto notCapturing = C3D::Platform::GetAbsoluteTime() - start;
+
+        ExpectTrue(Profiler.RequestCapture(1, "profiler_benchmark_capture.json"));
+        Profiler.BeginFrame();
+
+        start = C3D::Platform::GetAbsoluteTime();
+        for (u32 i = 0; i < scopeCount; ++i)
+        {
+            C3D::ProfileScope scope("Benchmark");
+        }
+        const auto capturing = C3D::Platform::GetAbsoluteTime() - start;
+
+        Profiler.BeginFrame();
+
+        INFO_LOG("{} scopes took {:.3f}ms when not capturing and {:.3f}ms while capturing ({:.1f}ns per scope).", scopeCount,
+                 notCapturing * C3D::SEC_TO_MS_MULTIPLIER, capturing * C3D::SEC_TO_MS_MULTIPLIER,
+                 (capturing / scopeCount) * C3D::SEC_TO_US_MULTIPLIER * 1000.0);
+    }
+
+    void RegisterTests(TestManager& manager)
+    {
+        manager.StartType("Profiler");
+        REGISTER_TEST(ProfilerShouldRejectInvalidCaptures, "Profiler should reject invalid capture requests.");
+        REGISTER_TEST(ProfilerShouldOnlyRecordWhileCapturing, "Profiler should only capture the requested number of frames.");
+        REGISTER_TEST(ProfilerShouldCaptureScopesFromMultipleThreads, "Profiler should write the scopes of all threads to a Chrome trace.");
+        REGISTER_BENCHMARK(ProfilerBenchmark, "Benchmark the overhead of a profiled scope.");
+    }
+}  // namespace CpuProfiler
@@ -0,0 +1,189 @@
+#include "geometry_utils_tests.h"
+
+#include <containers/dynamic_array.h>
+#include <logger/logger.h>
+#include <platform/platform.h>
+#include <random/random.h>
+#include <renderer/geometry_utils.h>
+
+#include <algorithm>
+
+#include "../expect.h"
+
+namespace GeometryUtils
+{
+    /** @brief Generates a grid of size x size quads where every triangle has it's own 3 vertices (like a naive importer would). */
+    static C3D::GeometryConfig GenerateTriangleSoupGrid(const u32 size)
+    {
+        C3D::GeometryConfig config;
+        config.vertices.Reserve(static_cast<u64>(size) * size * 6);
+        config.indices.Reserve(static_cast<u64>(size) * size * 6);
+
+        const auto AddVertex = [&](const u32 x, const u32 y) {
+            C3D::Vertex3D vertex;
+            vertex.position = vec3(static_cast<f32>(x), 0.0f, static_cast<f32>(y));
+            vertex.normal   = vec3(0.0f, 1.0f, 0.0f);
+            vertex.texture  = vec2(static_cast<f32>(x) / size, static_cast<f32>(y) / size);
+            vertex.color    = vec4(1.0f);
+            vertex.tangent  = vec3(1.0f, 0.0f, 0.0f);
+
+            config.indices.PushBack(static_cast<u32>(config.vertices.Size()));
+            config.vertices.PushBack(vertex);
+        };
+
+        for (u32 y = 0; y < size; y++)
+        {
+            for (u32 x = 0; x < size; x++)
+            {
+                AddVertex(x, y);
+                AddVertex(x, y + 1);
+                AddVertex(x + 1, y + 1);
+
+                AddVertex(x, y);
+                AddVertex(x + 1, y + 1);
+                AddVertex(x + 1, y);
+            }
+        }
+        return config;
+    }
+
+    static void ShuffleTriangles(C3D::DynamicArray<u32>& indices)
+    {
+        const auto triangleCount = static_cast<u32>(indices.Size() / 3);
+        for (u32 t = triangleCount - 1; t > 0; t--)
+        {
+            const auto other = C3D::Random.Generate(0u, t);
+            for (u32 i = 0; i < 3; i++) std::swap(indices[t * 3 + i], indices[other * 3 + i]);
+        }
+    }
+
+    /** @brief Returns every triangle (rotated so it starts with it's smallest index to keep the winding) as a sorted list of keys. */
+    static C3D::DynamicArray<u64> GetSortedTriangles(const C3D::DynamicArray<u32>& indices)
+    {
+        C3D::DynamicArray<u64> triangles(indices.Size() / 3);
+        for (u64 i = 0; i < indices.Size(); i += 3)
+        {
+            u32 a = indices[i], b = indices[i + 1], c = indices[i + 2];
+            while (a > b || a > c)
+            {
+                const auto first = a;
+                a                = b;
+                b                = c;
+                c                = first;
+            }
+            triangles.PushBack((static_cast<u64>(a) << 42) | (static_cast<u64>(b) << 21) | c);
+        }
+        std::sort(triangles.begin(), triangles.end());
+        return triangles;
+    }
+
+    static bool ContainSameTriangles(const C3D::DynamicArray<u32>& a, const C3D::DynamicArray<u32>& b)
+    {
+        const auto trianglesA = GetSortedTriangles(a);
+        const auto trianglesB = GetSortedTriangles(b);
+        return trianglesA.Size() == trianglesB.Size() && std::equal(trianglesA.begin(), trianglesA.end(), trianglesB.begin());
+    }
+
+    TEST(DeduplicateVerticesShouldMergeEqualVertices)
+    {
+        auto config         = GenerateTriangleSoupGrid(8);
+        const auto original = config;
+
+        C3D::GeometryUtils::DeduplicateVertices(config);
+
+        // Only the (8 + 1)^2 corners of the grid are unique
+        ExpectEqual(81, config.vertices.Size());
+        ExpectEqual(original.indices.Size(), config.indices.Size());
+
+        // Every index should still point to the same vertex data
+        for (u64 i = 0; i < config.indices.Size(); i++)
+        {
+            ExpectTrue(config.vertices[config.indices[i]] == original.vertices[original.indices[i]]);
+        }
+    }
+
+    TEST(OptimizeVertexCacheShouldKeepAllTriangles)
+    {
+        auto config = GenerateTriangleSoupGrid(32);
+        C3D::GeometryUtils::DeduplicateVertices(config);
+        ShuffleTriangles(config.indices);
+
+        const auto original = config.indices;
+        const auto before   = C3D::GeometryUtils::CalculateACMR(config.indices, config.vertices.Size());
+
+        C3D::GeometryUtils::OptimizeVertexCache(config.indices, config.vertices.Size());
+
+        ExpectTrue(ContainSameTriangles(original, config.indices));
+        ExpectTrue(C3D::GeometryUtils::CalculateACMR(config.indices, config.vertices.Size()) < before);
+    }
+
+    TEST(OptimizeOverdrawShouldKeepAllTriangles)
+    {
+        auto config = GenerateTriangleSoupGrid(32);
+        C3D::GeometryUtils::DeduplicateVertices(config);
+        ShuffleTriangles(config.indices);
+
+        C3D::GeometryUtils::OptimizeVertexCache(config.indices, config.vertices.Size());
+        const auto original = config.indices;
+        const auto before   = C3D::GeometryUtils::CalculateACMR(config.indices, config.vertices.Size());
+
+        C3D::GeometryUtils::OptimizeOverdraw(config.indices, config.vertices, 1.05f);
+
+        ExpectTrue(ContainSameTriangles(original, config.indices));
+        // Clusters are reordered as a whole so the ACMR may only get slightly worse
+        ExpectTrue(C3D::GeometryUtils::CalculateACMR(config.indices, config.vertices.Size()) <= before * 1.1f);
+    }
+
+    TEST(CalculateACMRShouldCountCacheMisses)
+    {
+        // Two triangles that share an edge need 4 vertices
+        const C3D::DynamicArray<u32> quad = { 0, 1, 2, 2, 1, 3 };
+        ExpectFloatEqual(2.0f, C3D::GeometryUtils::CalculateACMR(quad, 4));
+
+        // With a cache of 3 vertices the shared edge is already gone by the time we need it again
+        const C3D::DynamicArray<u32> strip = { 0, 1, 2, 3, 4, 5, 0, 1, 2 };
+        ExpectFloatEqual(3.0f, C3D::GeometryUtils::CalculateACMR(strip, 6, 3));
+    }
+
+    TEST(GeometryOptimizationBenchmark)
+    {
+        // Roughly the triangle count of one of the larger Sponza geometries
+        auto config = GenerateTriangleSoupGrid(256);
+        const auto soupVertexCount = config.vertices.Size();
+
+        auto start = C3D::Platform::GetAbsoluteTime();
+        C3D::GeometryUtils::DeduplicateVertices(config);
+        const auto deduplicateTime = C3D::Platform::GetAbsoluteTime() - start;
+
+        // Importers rarely give us triangles in a nice order so we shuffle them
+        ShuffleTriangles(config.indices);
+        const auto vertexCount  = config.vertices.Size();
+        const auto shuffledACMR = C3D::GeometryUtils::CalculateACMR(config.indices, vertexCount);
+
+        start = C3D::Platform::GetAbsoluteTime();
+        C3D::GeometryUtils::OptimizeVertexCache(config.indices, vertexCount);
+        const auto vertexCacheTime = C3D::Platform::GetAbsoluteTime() - start;
+        const auto vertexCacheACMR = C3D::GeometryUtils::CalculateACMR(config.indices, vertexCount);
+
+        start = C3D::Platform::GetAbsoluteTime();
+        C3D::GeometryUtils::OptimizeOverdraw(config.indices, config.vertices);
+        const auto overdrawTime = C3D::Platform::GetAbsoluteTime() - start;
+        const auto overdrawACMR = C3D::GeometryUtils::CalculateACMR(config.indices, vertexCount);
+
+        ExpectTrue(vertexCacheACMR < shuffledACMR);
+
+        INFO_LOG("De-duplicated {} vertices into {} in {:.3f}ms.", soupVertexCount, vertexCount, deduplicateTime * 1000.0);
+        INFO_LOG("ACMR of {} triangles: shuffled {:.3f}, vertex cache optimized {:.3f} ({:.3f}ms), overdraw optimized {:.3f} ({:.3f}ms).",
+                 config.indices.Size() / 3, shuffledACMR, vertexCacheACMR, vertexCacheTime * 1000.0, overdrawACMR, overdrawTime * 1000.0);
+    }
+
+    void RegisterTests(TestManager& manager)
+    {
+        manager.StartType("GeometryUtils");
+        REGISTER_TEST(DeduplicateVerticesShouldMergeEqualVertices, "Vertices that are exactly equal should be merged.");
+        REGISTER_TEST(OptimizeVertexCacheShouldKeepAllTriangles, "Optimizing for the vertex cache should only change the triangle order.");
+        REGISTER_TEST(OptimizeOverdrawShouldKeepAllTriangles, "Optimizing for overdraw should only change the triangle order.");
+        REGISTER_TEST(CalculateACMRShouldCountCacheMisses, "The ACMR should be the number of cache misses per triangle.");
+        REGISTER_BENCHMARK(GeometryOptimizationBenchmark, "Benchmark de-duplication and reordering of a large grid and report the ACMR.");
+    }
+}  // namespace GeometryUtils
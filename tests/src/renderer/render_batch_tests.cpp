@@ -0,0 +1,79 @@
+#include "render_batch_tests.h"
+
+#include <memory/allocators/frame_allocator.h>
+#include <renderer/render_batch.h>
+#include <resources/materials/material.h>
+
+#include <iterator>
+
+#include "../expect.h"
+
+namespace RenderBatch
+{
+    static C3D::GeometryRenderData MakeRenderData(const u64 vertexBufferOffset, C3D::Material* material, const f32 x,
+                                                  const bool windingInverted = false)
+    {
+        const auto model = glm::translate(vec3(x, 0.0f, 0.0f));
+        return C3D::GeometryRenderData(C3D::UUID(), model, 24, 32, vertexBufferOffset, 36, 4, vertexBufferOffset / 2, material,
+                                       windingInverted);
+    }
+
+    TEST(RenderBatchShouldMergeIdenticalItems)
+    {
+        C3D::FrameAllocator allocator;
+        ExpectTrue(allocator.Create("Render Batch Test Allocator", MebiBytes(8), 1));
+
+        {
+            C3D::Material brick, stone;
+
+            C3D::DynamicArray<C3D::GeometryRenderData, C3D::FrameAllocator> data(16, &allocator);
+            // Three instances of the same geometry and material
+            data.PushBack(MakeRenderData(0, &brick, 0.0f));
+            data.PushBack(MakeRenderData(0, &brick, 1.0f));
+            data.PushBack(MakeRenderData(0, &brick, 2.0f));
+            // Same geometry but a different material
+            data.PushBack(MakeRenderData(0, &stone, 3.0f));
+            // Same material but inverted winding
+            data.PushBack(MakeRenderData(0, &stone, 4.0f, true));
+            // A different geometry
+            data.PushBack(MakeRenderData(1024, &stone, 5.0f, true));
+            data.PushBack(MakeRenderData(1024, &stone, 6.0f, true));
+            // Identical to the first items but not adjacent so it should not be merged with them
+            data.PushBack(MakeRenderData(0, &brick, 7.0f));
+
+            C3D::DynamicArray<C3D::GeometryInstanceBatch, C3D::FrameAllocator> batches(16, &allocator);
+            const auto models = allocator.Allocate<mat4>(C3D::MemoryType::Array, data.Size());
+
+            C3D::RenderBatch::Build(data, batches, models);
+
+            constexpr C3D::GeometryInstanceBatch expected[] = { { 0, 3 }, { 3, 1 }, { 4, 1 }, { 5, 2 }, { 7, 1 } };
+
+            ExpectEqual(std::size(expected), batches.Size());
+            for (u32 i = 0; i < batches.Size(); ++i)
+            {
+                ExpectEqual(expected[i].first, batches[i].first);
+                ExpectEqual(expected[i].count, batches[i].count);
+            }
+
+            // The model matrices should be written in the order of the render data
+            for (u32 i = 0; i < data.Size(); ++i)
+            {
+                ExpectTrue(models[i] == data[i].model);
+                ExpectEqual(static_cast<f32>(i), models[i][3][0]);
+            }
+
+            // Building again should start from scratch
+            data.Reset();
+            C3D::RenderBatch::Build(data, batches, models);
+            ExpectTrue(batches.Empty());
+        }
+
+        allocator.Destroy();
+    }
+
+    void RegisterTests(TestManager& manager)
+    {
+        manager.StartType("RenderBatch");
+        REGISTER_TEST(RenderBatchShouldMergeIdenticalItems, "Consecutive items with the same geometry and material should be merged.");
+    }
+}  // namespace RenderBatch
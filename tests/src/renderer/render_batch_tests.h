@@ -0,0 +1,7 @@
+#pragma once
+#include "../test_manager.h"
+
+namespace RenderBatch
+{
+	void RegisterTests(TestManager& manager);
+}
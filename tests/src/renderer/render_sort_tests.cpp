@@ -0,0 +1,158 @@
+#include "render_sort_tests.h"
+
+#include <logger/logger.h>
+#include <memory/allocators/frame_allocator.h>
+#include <platform/platform.h>
+#include <random/random.h>
+#include <renderer/render_sort.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "../expect.h"
+
+namespace RenderSort
+{
+    /** @brief Generates keys like a scene would: a couple of shaders, many materials and geometries at random depths. */
+    static std::vector<C3D::RenderSortItem> GenerateItems(const u32 count)
+    {
+        std::vector<C3D::RenderSortItem> items(count);
+        for (u32 i = 0; i < count; ++i)
+        {
+            const auto shader   = C3D::Random.Generate(0u, 3u);
+            const auto material = C3D::Random.Generate(0u, 511u);
+            const auto geometry = C3D::Random.Generate(0u, 4095u);
+            const auto distance = C3D::Random.Generate(0.1f, 1000.0f);
+
+            if (C3D::Random.Generate(0u, 9u) == 0)
+            {
+                items[i].key = C3D::RenderSort::MakeTranslucentKey(C3D::RenderSortPass::Scene, shader, material, distance, geometry);
+            }
+            else
+            {
+                items[i].key = C3D::RenderSort::MakeOpaqueKey(C3D::RenderSortPass::Scene, shader, material, distance, geometry);
+            }
+            items[i].index = i;
+        }
+        return items;
+    }
+
+    TEST(RenderSortKeysShouldOrderItems)
+    {
+        using namespace C3D::RenderSort;
+        using C3D::RenderSortPass;
+
+        // Passes come first
+        ExpectTrue(MakeTranslucentKey(RenderSortPass::Shadow, 255, 0xFFFF, 0.0f, 0) < MakeOpaqueKey(RenderSortPass::Scene, 0, 0, 0.0f, 0));
+        ExpectTrue(MakeOrderedKey(RenderSortPass::Scene, 0xFFFFFFFF) < MakeOpaqueKey(RenderSortPass::UI, 0, 0, 0.0f, 0));
+        // Translucent items come after all opaque items of the same pass
+        ExpectTrue(MakeOpaqueKey(RenderSortPass::Scene, 255, 0xFFFF, 1000.0f, 0) <
+                   MakeTranslucentKey(RenderSortPass::Scene, 0, 0, 0.0f, 0));
+
+        // Opaque items are sorted by shader, then material, then geometry (so they can be instanced) and then front to back
+        ExpectTrue(MakeOpaqueKey(RenderSortPass::Scene, 0, 5, 100.0f, 0) < MakeOpaqueKey(RenderSortPass::Scene, 1, 0, 1.0f, 0));
+        ExpectTrue(MakeOpaqueKey(RenderSortPass::Scene, 0, 0, 100.0f, 0) < MakeOpaqueKey(RenderSortPass::Scene, 0, 1, 1.0f, 0));
+        ExpectTrue(MakeOpaqueKey(RenderSortPass::Scene, 0, 0, 100.0f, 1) < MakeOpaqueKey(RenderSortPass::Scene, 0, 0, 1.0f, 2));
+        ExpectTrue(MakeOpaqueKey(RenderSortPass::Scene, 0, 0, 1.0f, 0) < MakeOpaqueKey(RenderSortPass::Scene, 0, 0, 1.5f, 0));
+
+        // Translucent items are sorted back to front, regardless of their state
+        ExpectTrue(MakeTranslucentKey(RenderSortPass::Scene, 3, 3, 10.0f, 0) < MakeTranslucentKey(RenderSortPass::Scene, 0, 0, 5.0f, 0));
+
+        // Depth buckets preserve the order of distances and treat negative distances as 0
+        ExpectTrue(QuantizeDepth(0.0f) < QuantizeDepth(0.01f));
+        ExpectTrue(QuantizeDepth(10.0f) < QuantizeDepth(10.5f));
+        ExpectTrue(QuantizeDepth(999.0f) < QuantizeDepth(1000.0f));
+        ExpectEqual(QuantizeDepth(0.0f), QuantizeDepth(-5.0f));
+    }
+
+    TEST(RenderSortShouldMatchStableSort)
+    {
+        for (const u32 count : { 0u, 1u, 2u, 17u, 1000u, 50000u })
+        {
+            auto items    = GenerateItems(count);
+            auto expected = items;
+            std::ranges::stable_sort(expected, {}, &C3D::RenderSortItem::key);
+
+            std::vector<C3D::RenderSortItem> scratch(count);
+            C3D::RenderSort::SortItems(items.data(), scratch.data(), count);
+
+            // The radix sort is stable so even items with equal keys should be in the same order
+            for (u32 i = 0; i < count; ++i)
+            {
+                ExpectEqual(expected[i].key, items[i].key);
+                ExpectEqual(expected[i].index, items[i].index);
+            }
+        }
+    }
+
+    TEST(RenderSortShouldSortRenderData)
+    {
+        constexpr u32 count = 10000;
+
+        C3D::FrameAllocator allocator;
+        ExpectTrue(allocator.Create("Render Sort Test Allocator", MebiBytes(8), 1));
+
+        {
+            const auto items = GenerateItems(count);
+
+            C3D::DynamicArray<C3D::GeometryRenderData, C3D::FrameAllocator> data(count, &allocator);
+            for (u32 i = 0; i < count; ++i)
+            {
+                auto& renderData       = data.EmplaceBack();
+                renderData.sortKey     = items[i].key;
+                renderData.vertexCount = i;
+            }
+
+            auto expected = items;
+            std::ranges::stable_sort(expected, {}, &C3D::RenderSortItem::key);
+
+            C3D::RenderSort::Sort(&allocator, data);
+
+            // Every item should have moved together with it's key
+            ExpectEqual(count, data.Size());
+            for (u32 i = 0; i < count; ++i)
+            {
+                ExpectEqual(expected[i].key, data[i].sortKey);
+                ExpectEqual(expected[i].index, data[i].vertexCount);
+            }
+        }
+
+        allocator.Destroy();
+    }
+
+    TEST(RenderSortBenchmark)
+    {
+        for (const u32 count : { 10000u, 100000u, 500000u })
+        {
+            const auto items = GenerateItems(count);
+
+            auto comparisonItems = items;
+            auto start           = C3D::Platform::GetAbsoluteTime();
+            std::ranges::sort(comparisonItems, {}, &C3D::RenderSortItem::key);
+            const auto comparison = C3D::Platform::GetAbsoluteTime() - start;
+
+            auto radixItems = items;
+            std::vector<C3D::RenderSortItem> scratch(count);
+            start = C3D::Platform::GetAbsoluteTime();
+            C3D::RenderSort::SortItems(radixItems.data(), scratch.data(), count);
+            const auto radix = C3D::Platform::GetAbsoluteTime() - start;
+
+            for (u32 i = 0; i < count; ++i)
+            {
+                ExpectEqual(comparisonItems[i].key, radixItems[i].key);
+            }
+
+            INFO_LOG("{} items: std::sort took {:.3f}ms and the radix sort took {:.3f}ms ({:.2f}x).", count,
+                     comparison * C3D::SEC_TO_MS_MULTIPLIER, radix * C3D::SEC_TO_MS_MULTIPLIER, comparison / radix);
+        }
+    }
+
+    void RegisterTests(TestManager& manager)
+    {
+        manager.StartType("RenderSort");
+        REGISTER_TEST(RenderSortKeysShouldOrderItems, "Sort keys should order passes, translucency, state and depth correctly.");
+        REGISTER_TEST(RenderSortShouldMatchStableSort, "The radix sort should give the same result as a stable sort.");
+        REGISTER_TEST(RenderSortShouldSortRenderData, "Sorting render data should move every item together with it's key.");
+        REGISTER_BENCHMARK(RenderSortBenchmark, "Benchmark the radix sort against std::sort for 10k to 500k items.");
+    }
+}  // namespace RenderSort
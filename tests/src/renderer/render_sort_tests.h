@@ -0,0 +1,7 @@
+#pragma once
+#include "../test_manager.h"
+
+namespace RenderSort
+{
+	void RegisterTests(TestManager& manager);
+}
@@ -0,0 +1,302 @@
+#include "csm_file_tests.h"
+
+#include <containers/dynamic_array.h>
+#include <logger/logger.h>
+#include <platform/file_system.h>
+#include <platform/mapped_file.h>
+#include <platform/platform.h>
+#include <resources/csm_file.h>
+
+#include <cstring>
+
+#include "../expect.h"
+
+namespace CSMFile
+{
+    /** @brief CSM v2 data must be 16 byte aligned so we copy the serialized bytes into a buffer of vec4s. */
+    C3D::DynamicArray<vec4> MakeAligned(const C3D::DynamicArray<u8>& bytes)
+    {
+        C3D::DynamicArray<vec4> aligned;
+        aligned.Resize((bytes.Size() + sizeof(vec4) - 1) / sizeof(vec4));
+        std::memcpy(aligned.GetData(), bytes.GetData(), bytes.Size());
+        return aligned;
+    }
+
+    const u8* GetBytes(const C3D::DynamicArray<vec4>& aligned) { return reinterpret_cast<const u8*>(aligned.GetData()); }
+
+    C3D::GeometryConfig CreateGeometry(const u32 index, const u32 vertexCount)
+    {
+        C3D::GeometryConfig config;
+        config.name         = C3D::String::FromFormat("geometry_{}", index);
+        config.materialName = C3D::String::FromFormat("material_{}", index % 8);
+        config.center       = vec3(static_cast<f32>(index), 0.5f, -1.0f);
+        config.minExtents   = vec3(-1.0f);
+        config.maxExtents   = vec3(static_cast<f32>(index) + 1.0f);
+
+        config.vertices.Resize(vertexCount);
+        for (u32 v = 0; v < vertexCount; v++)
+        {
+            auto& vertex    = config.vertices[v];
+            vertex.position = vec3(static_cast<f32>(v), static_cast<f32>(index), 0.25f);
+            vertex.normal   = vec3(0.0f, 0.0f, 1.0f);
+            vertex.texture  = vec2(0.5f, static_cast<f32>(v) / static_cast<f32>(vertexCount));
+            vertex.color    = vec4(1.0f);
+            vertex.tangent  = vec3(1.0f, 0.0f, 0.0f);
+        }
+
+        // Three indices per vertex to roughly match the ratio of real meshes
+        config.indices.Resize(vertexCount * 3);
+        for (u32 i = 0; i < vertexCount * 3; i++)
+        {
+            config.indices[i] = (i * 7) % vertexCount;
+        }
+        return config;
+    }
+
+    C3D::DynamicArray<C3D::GeometryConfig> CreateGeometries(const u32 geometryCount, const u32 vertexCount)
+    {
+        C3D::DynamicArray<C3D::GeometryConfig> geometries(geometryCount);
+        for (u32 i = 0; i < geometryCount; i++)
+        {
+            geometries.PushBack(CreateGeometry(i, vertexCount + i));
+        }
+        return geometries;
+    }
+
+    /** @brief Sums the positions and indices of every geometry (like an upload would) so every byte is actually read. */
+    f64 Checksum(const C3D::DynamicArray<C3D::GeometryConfig>& geometries)
+    {
+        f64 sum = 0.0;
+        for (const auto& geometry : geometries)
+        {
+            const auto vertices = geometry.GetVertices();
+            for (u64 v = 0; v < geometry.GetVertexCount(); v++)
+            {
+                sum += vertices[v].position.x + vertices[v].position.y;
+            }
+
+            const auto indices = geometry.GetIndices();
+            for (u64 i = 0; i < geometry.GetIndexCount(); i++)
+            {
+                sum += indices[i];
+            }
+        }
+        return sum;
+    }
+
+    /** @brief Writes the geometries in the original (v1) CSM format which is read field by field. */
+    bool WriteVersion1(const C3D::String& path, const char* name, const C3D::DynamicArray<C3D::GeometryConfig>& geometries)
+    {
+        C3D::File file;
+        if (!file.Open(path, C3D::FileModeWrite | C3D::FileModeBinary)) return false;
+
+        file.Write(&C3D::CSM::CSM_VERSION_1);
+
+        const u64 nameLength = std::strlen(name) + 1;
+        file.Write(&nameLength);
+        file.Write(name, nameLength);
+
+        const u64 geometryCount = geometries.Size();
+        file.Write(&geometryCount);
+
+        for (const auto& geometry : geometries)
+        {
+            constexpr u64 vertexSize = sizeof(C3D::Vertex3D);
+            const u64 vertexCount    = geometry.vertices.Size();
+            file.Write(&vertexSize);
+            file.Write(&vertexCount);
+            file.Write(geometry.vertices.GetData(), vertexCount);
+
+            constexpr u64 indexSize = sizeof(u32);
+            const u64 indexCount    = geometry.indices.Size();
+            file.Write(&indexSize);
+            file.Write(&indexCount);
+            file.Write(geometry.indices.GetData(), indexCount);
+
+            file.Write(geometry.name);
+            file.Write(geometry.materialName);
+            file.Write(&geometry.center);
+            file.Write(&geometry.minExtents);
+            file.Write(&geometry.maxExtents);
+        }
+
+        file.Close();
+        return true;
+    }
+
+    TEST(CSMShouldRoundTripGeometries)
+    {
+        const auto geometries = CreateGeometries(3, 10);
+
+        C3D::DynamicArray<u8> bytes;
+        C3D::CSM::Serialize("test_mesh", geometries, bytes);
+        const auto aligned = MakeAligned(bytes);
+
+        ExpectEqual(C3D::CSM::CSM_VERSION_2, C3D::CSM::GetVersion(GetBytes(aligned), bytes.Size()));
+
+        C3D::DynamicArray<C3D::GeometryConfig> loaded;
+        ExpectTrue(C3D::CSM::Load(GetBytes(aligned), bytes.Size(), loaded));
+        ExpectEqual(geometries.Size(), loaded.Size());
+
+        for (u64 i = 0; i < geometries.Size(); i++)
+        {
+            const auto& expected = geometries[i];
+            const auto& actual   = loaded[i];
+
+            ExpectTrue(expected.name == actual.name);
+            ExpectTrue(expected.materialName == actual.materialName);
+            ExpectFloatEqual(expected.center.x, actual.center.x);
+            ExpectFloatEqual(expected.maxExtents.y, actual.maxExtents.y);
+
+            // Nothing should be copied into the arrays. Instead the config should point into the data.
+            ExpectTrue(actual.vertices.Empty());
+            ExpectTrue(actual.indices.Empty());
+            ExpectEqual(expected.vertices.Size(), actual.GetVertexCount());
+            ExpectEqual(expected.indices.Size(), actual.GetIndexCount());
+
+            const auto vertices = reinterpret_cast<const u8*>(actual.GetVertices());
+            const auto indices  = reinterpret_cast<const u8*>(actual.GetIndices());
+            ExpectTrue(vertices > GetBytes(aligned) && vertices < GetBytes(aligned) + bytes.Size());
+            ExpectEqual(0, reinterpret_cast<uintptr_t>(vertices) % C3D::CSM::CSM_BLOB_ALIGNMENT);
+            ExpectEqual(0, reinterpret_cast<uintptr_t>(indices) % C3D::CSM::CSM_BLOB_ALIGNMENT);
+
+            ExpectTrue(std::memcmp(expected.vertices.GetData(), vertices, expected.vertices.Size() * sizeof(C3D::Vertex3D)) == 0);
+            ExpectTrue(std::memcmp(expected.indices.GetData(), indices, expected.indices.Size() * sizeof(u32)) == 0);
+        }
+    }
+
+    TEST(CSMShouldRejectInvalidData)
+    {
+        const auto geometries = CreateGeometries(2, 4);
+
+        C3D::DynamicArray<u8> bytes;
+        C3D::CSM::Serialize("test_mesh", geometries, bytes);
+        auto aligned = MakeAligned(bytes);
+
+        // Loading with a different vertex type should fail
+        C3D::DynamicArray<C3D::UIGeometryConfig> uiGeometries;
+        ExpectFalse(C3D::CSM::Load(GetBytes(aligned), bytes.Size(), uiGeometries));
+
+        // Truncated data should fail
+        C3D::DynamicArray<C3D::GeometryConfig> loaded;
+        ExpectFalse(C3D::CSM::Load(GetBytes(aligned), bytes.Size() - 16, loaded));
+        ExpectFalse(C3D::CSM::Load(GetBytes(aligned), sizeof(C3D::CSM::CSMHeader) - 1, loaded));
+
+        // Unaligned data should fail
+        ExpectFalse(C3D::CSM::Load(GetBytes(aligned) + 4, bytes.Size() - 4, loaded));
+
+        // A corrupted vertex count should fail
+        const auto entries  = reinterpret_cast<u8*>(aligned.GetData()) + sizeof(C3D::CSM::CSMHeader);
+        const auto entry    = reinterpret_cast<C3D::CSM::CSMGeometryEntry*>(entries);
+        const auto original = entry->vertexCount;
+        entry->vertexCount  = 0xFFFFFFFFFFFFull;
+        ExpectFalse(C3D::CSM::Load(GetBytes(aligned), bytes.Size(), loaded));
+        entry->vertexCount = original;
+
+        // A different version should fail
+        reinterpret_cast<C3D::CSM::CSMHeader*>(aligned.GetData())->version = C3D::CSM::CSM_VERSION_1;
+        ExpectFalse(C3D::CSM::Load(GetBytes(aligned), bytes.Size(), loaded));
+
+        ExpectTrue(loaded.Empty());
+    }
+
+    TEST(CSMShouldLoadFromMappedFiles)
+    {
+        const auto geometries = CreateGeometries(4, 100);
+        const auto checksum   = Checksum(geometries);
+
+        C3D::DynamicArray<u8> bytes;
+        C3D::CSM::Serialize("mapped_mesh", geometries, bytes);
+
+        C3D::File file;
+        ExpectTrue(file.Open("mapped_mesh.csm", C3D::FileModeWrite | C3D::FileModeBinary));
+        ExpectTrue(file.Write(bytes.GetData(), bytes.Size()));
+        file.Close();
+
+        C3D::MappedFile mappedFile;
+        ExpectTrue(mappedFile.Open("mapped_mesh.csm"));
+
+        C3D::DynamicArray<C3D::GeometryConfig> loaded;
+        ExpectTrue(C3D::CSM::Load(mappedFile.GetData(), mappedFile.GetSize(), loaded));
+        ExpectEqual(geometries.Size(), loaded.Size());
+        ExpectFloatEqual(checksum, Checksum(loaded));
+    }
+
+    TEST(CSMShouldLoadVersion1Files)
+    {
+        const auto geometries = CreateGeometries(3, 50);
+
+        ExpectTrue(WriteVersion1("version1_mesh.csm", "version1_mesh", geometries));
+
+        C3D::File file;
+        ExpectTrue(file.Open("version1_mesh.csm", C3D::FileModeRead | C3D::FileModeBinary));
+
+        C3D::DynamicArray<C3D::GeometryConfig> loaded;
+        ExpectTrue(C3D::CSM::LoadVersion1(file, loaded));
+        file.Close();
+
+        ExpectEqual(geometries.Size(), loaded.Size());
+        ExpectTrue(geometries[2].name == loaded[2].name);
+        ExpectFloatEqual(Checksum(geometries), Checksum(loaded));
+    }
+
+    TEST(CSMLoadBenchmark)
+    {
+        // Roughly the size of Sponza: a few hundred geometries with ~250k vertices in total
+        constexpr u32 geometryCount = 384;
+        constexpr u32 vertexCount   = 500;
+
+        const auto geometries = CreateGeometries(geometryCount, vertexCount);
+        const auto checksum   = Checksum(geometries);
+
+        ExpectTrue(WriteVersion1("sponza_v1.csm", "sponza", geometries));
+
+        C3D::DynamicArray<u8> bytes;
+        C3D::CSM::Serialize("sponza", geometries, bytes);
+
+        C3D::File file;
+        ExpectTrue(file.Open("sponza_v2.csm", C3D::FileModeWrite | C3D::FileModeBinary));
+        ExpectTrue(file.Write(bytes.GetData(), bytes.Size()));
+        file.Close();
+
+        const auto size = bytes.Size();
+        bytes.Destroy();
+
+        // Reading v1 field by field into freshly allocated arrays
+        auto start = C3D::Platform::GetAbsoluteTime();
+        {
+            C3D::File v1File;
+            ExpectTrue(v1File.Open("sponza_v1.csm", C3D::FileModeRead | C3D::FileModeBinary));
+
+            C3D::DynamicArray<C3D::GeometryConfig> loaded;
+            ExpectTrue(C3D::CSM::LoadVersion1(v1File, loaded));
+            ExpectFloatEqual(checksum, Checksum(loaded));
+        }
+        const auto v1Time = C3D::Platform::GetAbsoluteTime() - start;
+
+        // Mapping v2 and using the vertices and indices in place
+        start = C3D::Platform::GetAbsoluteTime();
+        {
+            C3D::MappedFile mappedFile;
+            ExpectTrue(mappedFile.Open("sponza_v2.csm"));
+
+            C3D::DynamicArray<C3D::GeometryConfig> loaded;
+            ExpectTrue(C3D::CSM::Load(mappedFile.GetData(), mappedFile.GetSize(), loaded));
+            ExpectFloatEqual(checksum, Checksum(loaded));
+        }
+        const auto v2Time = C3D::Platform::GetAbsoluteTime() - start;
+
+        C3D::Logger::Info("Mesh with {} geometries ({:.1f}MB): CSM v1 {:.3f}ms, CSM v2 mapped {:.3f}ms ({:.1f}x faster).", geometryCount,
+                          static_cast<f64>(size) / (1024.0 * 1024.0), v1Time * 1000.0, v2Time * 1000.0, v1Time / v2Time);
+    }
+
+    void RegisterTests(TestManager& manager)
+    {
+        manager.StartType("CSMFile");
+        REGISTER_TEST(CSMShouldRoundTripGeometries, "Geometries serialized as CSM v2 should be loaded back in place.");
+        REGISTER_TEST(CSMShouldRejectInvalidData, "Loading CSM v2 data should reject invalid or corrupted data.");
+        REGISTER_TEST(CSMShouldLoadFromMappedFiles, "CSM v2 files should be loadable straight from a memory-mapped file.");
+        REGISTER_TEST(CSMShouldLoadVersion1Files, "Older CSM v1 files should still be loadable.");
+        REGISTER_BENCHMARK(CSMLoadBenchmark, "Benchmark loading a Sponza-sized mesh from CSM v1 against a memory-mapped CSM v2 file.");
+    }
+}  // namespace CSMFile
@@ -0,0 +1,7 @@
+#pragma once
+#include "../test_manager.h"
+
+namespace CSMFile
+{
+    void RegisterTests(TestManager& manager);
+}
\ No newline at end of file
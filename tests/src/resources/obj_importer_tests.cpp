@@ -0,0 +1,282 @@
+#include "obj_importer_tests.h"
+
+#include <containers/dynamic_array.h>
+#include <cson/cson_types.h>
+#include <logger/logger.h>
+#include <platform/platform.h>
+#include <resources/obj_importer.h>
+#include <systems/jobs/job_system.h>
+
+#include <cstdio>
+#include <cstring>
+
+#include "../expect.h"
+
+namespace ObjImporter
+{
+    constexpr auto SIMPLE_OBJ =
+        "# A quad and a triangle with different materials\n"
+        "mtllib test.mtl\n"
+        "o test_mesh\n"
+        "v -1.0 -1.0 0.0\n"
+        "v 1.0 -1.0 0.0\n"
+        "v 1.0 1.0 0.0\n"
+        "v -1.0 1.0 0.0\n"
+        "v 0.0 2.0 +1.5\r\n"
+        "vt 0.0 0.0\n"
+        "vt 1.0 0.0\n"
+        "vt 1.0 1.0\n"
+        "vt 0.0 1.0\n"
+        "vn 0.0 0.0 1.0\n"
+        "usemtl first\n"
+        "s off\n"
+        "f 1/1/1 2/2/1 3/3/1 4/4/1\n"
+        "\n"
+        "usemtl second\n"
+        "f 4//1 3//1 5//1\r\n";
+
+    static C3D::CSONObject MakeConfig(u8 threadCount)
+    {
+        C3D::CSONObject config(C3D::CSONObjectType::Object);
+        config.properties.EmplaceBack("threadCount", static_cast<i64>(threadCount));
+        return config;
+    }
+
+    static bool Import(C3D::JobSystem& jobs, const char* obj, u64 chunkSize, C3D::DynamicArray<C3D::GeometryConfig>& geometries)
+    {
+        C3D::ObjImporter importer(jobs, chunkSize);
+        return importer.Import(obj, std::strlen(obj), geometries);
+    }
+
+    /** @brief Generates a Sponza-like OBJ: many groups (with their own material) made out of grids of textured quads. */
+    static C3D::String GenerateObj(const u32 groupCount, const u32 gridSize)
+    {
+        C3D::String obj;
+        obj.Reserve(static_cast<u64>(groupCount) * gridSize * gridSize * 120);
+        obj += "mtllib generated.mtl\n";
+
+        char line[256];
+        u32 vertexOffset = 0;
+        for (u32 g = 0; g < groupCount; g++)
+        {
+            std::snprintf(line, sizeof(line), "g group_%u\nusemtl material_%u\n", g, g % 16);
+            obj += line;
+
+            for (u32 y = 0; y <= gridSize; y++)
+            {
+                for (u32 x = 0; x <= gridSize; x++)
+                {
+                    std::snprintf(line, sizeof(line), "v %.6f %.6f %.6f\nvt %.6f %.6f\nvn 0.000000 1.000000 0.000000\n", x * 0.5f,
+                                  g * 0.25f, y * 0.5f, static_cast<f32>(x) / gridSize, static_cast<f32>(y) / gridSize);
+                    obj += line;
+                }
+            }
+
+            for (u32 y = 0; y < gridSize; y++)
+            {
+                for (u32 x = 0; x < gridSize; x++)
+                {
+                    const u32 a = vertexOffset + y * (gridSize + 1) + x + 1;
+                    const u32 b = a + 1;
+                    const u32 c = a + gridSize + 1;
+                    const u32 d = c + 1;
+                    std::snprintf(line, sizeof(line), "f %u/%u/%u %u/%u/%u %u/%u/%u %u/%u/%u\n", a, a, a, b, b, b, d, d, d, c, c, c);
+                    obj += line;
+                }
+            }
+
+            vertexOffset += (gridSize + 1) * (gridSize + 1);
+        }
+        return obj;
+    }
+
+    /** @brief Parses the OBJ data line by line with sscanf (like the original importer did) to get a baseline for the benchmark. */
+    static u64 ParseWithSscanf(const C3D::String& obj)
+    {
+        C3D::DynamicArray<vec3> positions;
+        C3D::DynamicArray<vec3> normals;
+        C3D::DynamicArray<vec2> texCoords;
+        C3D::DynamicArray<u32> indices;
+
+        const char* pos = obj.Data();
+        const char* end = pos + obj.Size();
+        char lineBuffer[256];
+        char t[8];
+        while (pos < end)
+        {
+            const auto newLine = static_cast<const char*>(std::memchr(pos, '\n', end - pos));
+            const auto lineEnd = newLine ? newLine : end;
+            const auto length  = std::min<u64>(lineEnd - pos, sizeof(lineBuffer) - 1);
+            std::memcpy(lineBuffer, pos, length);
+            lineBuffer[length] = '\0';
+
+            if (lineBuffer[0] == 'v' && lineBuffer[1] == ' ')
+            {
+                vec3 p;
+                std::sscanf(lineBuffer, "%s %f %f %f", t, &p.x, &p.y, &p.z);
+                positions.PushBack(p);
+            }
+            else if (lineBuffer[0] == 'v' && lineBuffer[1] == 'n')
+            {
+                vec3 n;
+                std::sscanf(lineBuffer, "%s %f %f %f", t, &n.x, &n.y, &n.z);
+                normals.PushBack(n);
+            }
+            else if (lineBuffer[0] == 'v' && lineBuffer[1] == 't')
+            {
+                vec2 uv;
+                std::sscanf(lineBuffer, "%s %f %f", t, &uv.x, &uv.y);
+                texCoords.PushBack(uv);
+            }
+            else if (lineBuffer[0] == 'f')
+            {
+                u32 v[9];
+                std::sscanf(lineBuffer, "%s %u/%u/%u %u/%u/%u %u/%u/%u", t, &v[0], &v[1], &v[2], &v[3], &v[4], &v[5], &v[6], &v[7], &v[8]);
+                for (auto i : v) indices.PushBack(i);
+            }
+
+            pos = lineEnd + 1;
+        }
+        return positions.Size() + normals.Size() + texCoords.Size() + indices.Size();
+    }
+
+    TEST(ObjImporterShouldParseFacesAndGroups)
+    {
+        C3D::JobSystem jobs;
+        ExpectTrue(jobs.OnInit(MakeConfig(2)));
+
+        C3D::DynamicArray<C3D::GeometryConfig> geometries;
+        C3D::ObjImporter importer(jobs);
+        ExpectTrue(importer.Import(SIMPLE_OBJ, std::strlen(SIMPLE_OBJ), geometries));
+
+        ExpectTrue(importer.GetName() == "test_mesh");
+        ExpectTrue(importer.GetMaterialLibrary() == "test.mtl");
+        ExpectEqual(2, geometries.Size());
+
+        // The quad is triangulated into 2 triangles that share 2 of their vertices
+        const auto& quad = geometries[0];
+        ExpectTrue(quad.name == "test_mesh");
+        ExpectTrue(quad.materialName == "first");
+        ExpectEqual(4, quad.vertices.Size());
+        ExpectEqual(6, quad.indices.Size());
+        ExpectFloatEqual(0.0f, quad.center.x);
+        ExpectFloatEqual(-1.0f, quad.minExtents.y);
+        ExpectFloatEqual(1.0f, quad.maxExtents.x);
+        ExpectFloatEqual(1.0f, quad.vertices[2].texture.y);
+
+        // Vertices without texture coordinates get default ones
+        const auto& triangle = geometries[1];
+        ExpectTrue(triangle.name == "test_mesh1");
+        ExpectTrue(triangle.materialName == "second");
+        ExpectEqual(3, triangle.vertices.Size());
+        ExpectFloatEqual(1.5f, triangle.vertices[2].position.z);
+        ExpectFloatEqual(0.0f, triangle.vertices[2].texture.x);
+        ExpectFloatEqual(1.0f, triangle.vertices[2].normal.z);
+
+        jobs.OnShutdown();
+    }
+
+    TEST(ObjImporterShouldGiveTheSameResultForAnyChunkSize)
+    {
+        C3D::JobSystem jobs;
+        ExpectTrue(jobs.OnInit(MakeConfig(4)));
+
+        const auto obj = GenerateObj(6, 8);
+
+        // A single chunk
+        C3D::DynamicArray<C3D::GeometryConfig> expected;
+        ExpectTrue(Import(jobs, obj.Data(), obj.Size(), expected));
+        ExpectEqual(6, expected.Size());
+
+        // Tiny chunks so groups and faces are spread over many chunks
+        for (const u64 chunkSize : { 1, 64, 1000 })
+        {
+            C3D::DynamicArray<C3D::GeometryConfig> actual;
+            ExpectTrue(Import(jobs, obj.Data(), chunkSize, actual));
+            ExpectEqual(expected.Size(), actual.Size());
+
+            for (u64 i = 0; i < expected.Size(); i++)
+            {
+                ExpectTrue(expected[i].name == actual[i].name);
+                ExpectTrue(expected[i].materialName == actual[i].materialName);
+                ExpectEqual(expected[i].vertices.Size(), actual[i].vertices.Size());
+                ExpectEqual(expected[i].indices.Size(), actual[i].indices.Size());
+                ExpectTrue(std::memcmp(expected[i].vertices.GetData(), actual[i].vertices.GetData(),
+                                       expected[i].vertices.Size() * sizeof(C3D::Vertex3D)) == 0);
+                ExpectTrue(std::memcmp(expected[i].indices.GetData(), actual[i].indices.GetData(),
+                                       expected[i].indices.Size() * sizeof(u32)) == 0);
+            }
+        }
+
+        // Every grid shares it's vertices between the quads so only (8 + 1)^2 vertices should remain
+        ExpectEqual(81, expected[0].vertices.Size());
+        ExpectEqual(8 * 8 * 6, expected[0].indices.Size());
+
+        jobs.OnShutdown();
+    }
+
+    TEST(ObjImporterShouldRejectInvalidIndices)
+    {
+        C3D::JobSystem jobs;
+        ExpectTrue(jobs.OnInit(MakeConfig(2)));
+
+        C3D::DynamicArray<C3D::GeometryConfig> geometries;
+        ExpectFalse(Import(jobs, "v 0 0 0\nv 1 0 0\nv 1 1 0\nf 1 2 4\n", C3D::OBJ_IMPORTER_DEFAULT_CHUNK_SIZE, geometries));
+
+        // Faces with relative indices are skipped so there is nothing to import
+        C3D::DynamicArray<C3D::GeometryConfig> relative;
+        ExpectFalse(Import(jobs, "v 0 0 0\nv 1 0 0\nv 1 1 0\nf -3 -2 -1\n", C3D::OBJ_IMPORTER_DEFAULT_CHUNK_SIZE, relative));
+        ExpectEqual(0, relative.Size());
+
+        jobs.OnShutdown();
+    }
+
+    TEST(ObjImporterBenchmark)
+    {
+        constexpr u8 threadCount = 4;
+
+        C3D::JobSystem jobs;
+        ExpectTrue(jobs.OnInit(MakeConfig(threadCount)));
+
+        // Roughly the size of Sponza: a few hundred groups with ~150k vertices and ~260k triangles in total
+        const auto obj = GenerateObj(380, 20);
+
+        auto start            = C3D::Platform::GetAbsoluteTime();
+        const auto elements   = ParseWithSscanf(obj);
+        const auto sscanfTime = C3D::Platform::GetAbsoluteTime() - start;
+        ExpectTrue(elements > 0);
+
+        // Using the size of the data as the chunk size results in a single chunk which is parsed by a single thread
+        start = C3D::Platform::GetAbsoluteTime();
+        {
+            C3D::DynamicArray<C3D::GeometryConfig> geometries;
+            ExpectTrue(Import(jobs, obj.Data(), obj.Size(), geometries));
+            ExpectEqual(380, geometries.Size());
+        }
+        const auto singleChunkTime = C3D::Platform::GetAbsoluteTime() - start;
+
+        start = C3D::Platform::GetAbsoluteTime();
+        {
+            C3D::DynamicArray<C3D::GeometryConfig> geometries;
+            ExpectTrue(Import(jobs, obj.Data(), MebiBytes(1), geometries));
+            ExpectEqual(380, geometries.Size());
+        }
+        const auto chunkedTime = C3D::Platform::GetAbsoluteTime() - start;
+
+        C3D::Logger::Info(
+            "OBJ of {:.1f}MB: sscanf parse only {:.3f}ms, import with 1 chunk {:.3f}ms, import with 1MiB chunks on {} threads {:.3f}ms.",
+            static_cast<f64>(obj.Size()) / (1024.0 * 1024.0), sscanfTime * 1000.0, singleChunkTime * 1000.0, threadCount,
+            chunkedTime * 1000.0);
+
+        jobs.OnShutdown();
+    }
+
+    void RegisterTests(TestManager& manager)
+    {
+        manager.StartType("ObjImporter");
+        REGISTER_TEST(ObjImporterShouldParseFacesAndGroups, "The OBJ importer should parse all supported statements and face formats.");
+        REGISTER_TEST(ObjImporterShouldGiveTheSameResultForAnyChunkSize, "The OBJ importer should not depend on how the file is chunked.");
+        REGISTER_TEST(ObjImporterShouldRejectInvalidIndices, "The OBJ importer should reject faces that reference missing vertices.");
+        REGISTER_BENCHMARK(ObjImporterBenchmark, "Benchmark importing a Sponza-sized OBJ file.");
+    }
+}  // namespace ObjImporter
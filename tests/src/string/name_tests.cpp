@@ -0,0 +1,219 @@
+#include "name_tests.h"
+
+#include <containers/dynamic_array.h>
+#include <containers/flat_hash_map.h>
+#include <logger/logger.h>
+#include <platform/platform.h>
+#include <random/random.h>
+#include <string/name.h>
+#include <string/string.h>
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "../expect.h"
+
+using C3D::operator""_name;
+
+namespace Name
+{
+    TEST(NameShouldInternEqualStringsOnce)
+    {
+        const C3D::Name a("Texture.Interned");
+        const C3D::Name b("Texture.Interned");
+        const C3D::Name c(C3D::String("Texture.Interned"));
+        const C3D::Name d("Texture.Other");
+
+        ExpectTrue(a == b);
+        ExpectTrue(a == c);
+        ExpectTrue(a != d);
+        ExpectFalse(a.Empty());
+
+        // Interned strings are only stored once so they share the same characters
+        ExpectTrue(a.Data() == b.Data());
+        ExpectTrue(a.Data() == c.Data());
+        ExpectTrue(std::strcmp(a.Data(), "Texture.Interned") == 0);
+        ExpectEqual(16, a.Size());
+    }
+
+    TEST(NameShouldSupportStringsLongerThanTheSmallStringBuffer)
+    {
+        constexpr auto longName = "Material.With.A.Name.That.Is.Way.Longer.Than.The.Small.String.Buffer";
+
+        const C3D::Name a(longName);
+        const C3D::Name b{ C3D::String(longName) };
+        ExpectTrue(a == b);
+        ExpectEqual(std::strlen(longName), a.Size());
+        ExpectTrue(std::strcmp(a.Data(), longName) == 0);
+    }
+
+    TEST(DefaultNameShouldBeTheEmptyString)
+    {
+        const C3D::Name none;
+        ExpectTrue(none.Empty());
+        ExpectEqual(0, none.GetId());
+        ExpectEqual(0, none.Size());
+        ExpectTrue(std::strcmp(none.Data(), "") == 0);
+
+        ExpectTrue(C3D::Name("") == none);
+        ExpectTrue(C3D::Name(C3D::String()) == none);
+    }
+
+    TEST(NameLiteralShouldHashAtCompileTime)
+    {
+        constexpr auto literal = "Shader.PBR"_name;
+        static_assert(literal.hash == C3D::HashName("Shader.PBR", 10), "The hash of a literal should be calculated at compile time");
+        static_assert(literal.length == 10);
+
+        const C3D::Name fromLiteral = literal;
+        const C3D::Name fromString("Shader.PBR");
+        ExpectTrue(fromLiteral == fromString);
+
+        // The precomputed hash matches the hash of a String with the same characters
+        ExpectEqual(literal.hash, fromString.GetHash());
+        ExpectEqual(std::hash<C3D::String>()(C3D::String("Shader.PBR")), fromString.GetHash());
+    }
+
+    TEST(FindShouldNotInternNewNames)
+    {
+        constexpr auto str = "A.Name.That.Is.Only.Used.In.FindShouldNotInternNewNames";
+
+        ExpectTrue(C3D::Name::Find(str).Empty());
+        ExpectTrue(C3D::Name::Find(C3D::String(str)).Empty());
+
+        const C3D::Name name(str);
+        ExpectTrue(C3D::Name::Find(str) == name);
+        ExpectTrue(C3D::Name::Find(C3D::String(str)) == name);
+    }
+
+    TEST(NamesShouldBeUsableAsHashMapKeys)
+    {
+        C3D::FlatHashMap<C3D::Name, u32> map;
+        map.Create();
+
+        for (u32 i = 0; i < 500; ++i)
+        {
+            map.Set(C3D::Name(C3D::String::FromFormat("Uniform.{}", i)), i);
+        }
+
+        for (u32 i = 0; i < 500; ++i)
+        {
+            const C3D::Name name(C3D::String::FromFormat("Uniform.{}", i));
+            ExpectTrue(map.Has(name));
+            ExpectEqual(i, map.Get(name));
+        }
+
+        ExpectFalse(map.Has(C3D::Name("Uniform.500")));
+
+        map.Destroy();
+    }
+
+    TEST(NamesShouldBeThreadSafe)
+    {
+        constexpr u32 threadCount = 8;
+        constexpr u32 nameCount   = 5000;
+
+        // Every thread interns the same names (in a different order) so they all race to add them to the table
+        std::vector<std::vector<u32>> ids(threadCount, std::vector<u32>(nameCount));
+        std::vector<std::thread> threads;
+
+        for (u32 t = 0; t < threadCount; ++t)
+        {
+            threads.emplace_back([&ids, t] {
+                for (u32 i = 0; i < nameCount; ++i)
+                {
+                    const u32 index = (i + t * 613) % nameCount;
+
+                    char buffer[64];
+                    std::snprintf(buffer, sizeof(buffer), "Threaded.Name.%u", index);
+                    ids[t][index] = C3D::Name(buffer).GetId();
+                }
+            });
+        }
+
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        for (u32 i = 0; i < nameCount; ++i)
+        {
+            for (u32 t = 1; t < threadCount; ++t)
+            {
+                ExpectEqual(ids[0][i], ids[t][i]);
+            }
+
+            char buffer[64];
+            std::snprintf(buffer, sizeof(buffer), "Threaded.Name.%u", i);
+
+            ExpectTrue(std::strcmp(C3D::Name::Find(buffer).Data(), buffer) == 0);
+            ExpectEqual(ids[0][i], C3D::Name::Find(buffer).GetId());
+        }
+    }
+
+    TEST(NameLookupBenchmark)
+    {
+        constexpr u32 count   = 1000;
+        constexpr u32 lookups = 1000000;
+
+        C3D::DynamicArray<C3D::String> strings(count);
+        C3D::DynamicArray<C3D::Name> names(count);
+        for (u32 i = 0; i < count; ++i)
+        {
+            // Names similar to the ones we use for our textures, materials and shaders
+            strings.PushBack(C3D::String::FromFormat("Resource.Name.{}.{}", C3D::Random.GenerateString(4, 12), i));
+            names.PushBack(C3D::Name(strings[i]));
+        }
+
+        C3D::FlatHashMap<C3D::String, u32> stringMap;
+        C3D::FlatHashMap<C3D::Name, u32> nameMap;
+        stringMap.Create();
+        nameMap.Create();
+
+        for (u32 i = 0; i < count; ++i)
+        {
+            stringMap.Set(strings[i], i);
+            nameMap.Set(names[i], i);
+        }
+
+        // Lookups with a const char* (hashing and comparing the characters for every lookup)
+        u64 sum    = 0;
+        auto start = C3D::Platform::GetAbsoluteTime();
+        for (u32 i = 0; i < lookups; ++i) sum += stringMap.Get(strings[i % count].Data());
+        const auto stringTime = C3D::Platform::GetAbsoluteTime() - start;
+
+        // Lookups with a Name that is interned every time
+        start = C3D::Platform::GetAbsoluteTime();
+        for (u32 i = 0; i < lookups; ++i) sum -= nameMap.Get(C3D::Name(strings[i % count].Data()));
+        const auto internTime = C3D::Platform::GetAbsoluteTime() - start;
+        ExpectEqual(0, sum);
+
+        // Lookups with a Name that was interned up front (which is how per-frame lookups should be done)
+        start = C3D::Platform::GetAbsoluteTime();
+        for (u32 i = 0; i < lookups; ++i) sum += nameMap.Get(names[i % count]);
+        const auto nameTime = C3D::Platform::GetAbsoluteTime() - start;
+        ExpectEqual(static_cast<u64>(lookups / count) * (count * (count - 1) / 2), sum);
+
+        C3D::Logger::Info("{} lookups: const char* {:.3f}ms, Name (interned every lookup) {:.3f}ms, Name {:.3f}ms ({:.1f}x faster).",
+                          lookups, stringTime * 1000.0, internTime * 1000.0, nameTime * 1000.0, stringTime / nameTime);
+
+        stringMap.Destroy();
+        nameMap.Destroy();
+        strings.Destroy();
+        names.Destroy();
+    }
+
+    void RegisterTests(TestManager& manager)
+    {
+        manager.StartType("Name");
+        REGISTER_TEST(NameShouldInternEqualStringsOnce, "Names with the same characters should have the same id and characters.");
+        REGISTER_TEST(NameShouldSupportStringsLongerThanTheSmallStringBuffer, "Names should support strings of any length.");
+        REGISTER_TEST(DefaultNameShouldBeTheEmptyString, "The default Name should be the empty string with id 0.");
+        REGISTER_TEST(NameLiteralShouldHashAtCompileTime, "The _name literal should calculate the same hash at compile time.");
+        REGISTER_TEST(FindShouldNotInternNewNames, "Name::Find() should only find names that have been interned.");
+        REGISTER_TEST(NamesShouldBeUsableAsHashMapKeys, "Names should be usable as keys in a FlatHashMap.");
+        REGISTER_TEST(NamesShouldBeThreadSafe, "Interning the same names on multiple threads should give the same ids.");
+        REGISTER_BENCHMARK(NameLookupBenchmark, "Benchmark FlatHashMap lookups with Names against lookups with strings.");
+    }
+}  // namespace Name
@@ -5,28 +5,48 @@
 #include <platform/platform.h>
 #include <time/clock.h>
 
+#include <cstdlib>
+#include <cstring>
+
 #include "expect.h"
 
-TestManager::TestManager(const u64 memorySize)
+TestManager::TestManager(const u64 memorySize, const bool runBenchmarks) : m_runBenchmarks(runBenchmarks)
 {
     // Intialize our logger, platform, metrics and global memory system
     C3D::Logger::Init();
     C3D::Platform::Init();
     Metrics.Init();
     C3D::GlobalMemorySystem::Init({ memorySize });
+
+    if (!m_runBenchmarks)
+    {
+        C3D::Logger::Info("Benchmarks will be skipped. Pass --benchmarks or set C3D_RUN_BENCHMARKS=1 to run them.");
+    }
 }
 
 TestManager::~TestManager() { C3D::GlobalMemorySystem::Destroy(); }
 
+bool TestManager::ShouldRunBenchmarks(const int argc, char** argv)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--benchmarks") == 0) return true;
+    }
+
+    const auto env = std::getenv("C3D_RUN_BENCHMARKS");
+    return env && std::strcmp(env, "0") != 0;
+}
+
 void TestManager::StartType(const std::string& type) { m_currentType = type; }
 
-void TestManager::Register(TestFunc func, const std::string& name, const std::string& description)
+void TestManager::Register(TestFunc func, const std::string& name, const std::string& description, const bool isBenchmark)
 {
     TestEntry e;
     e.func        = func;
     e.name        = name;
     e.description = description;
     e.type        = m_currentType;
+    e.isBenchmark = isBenchmark;
     m_tests.push_back(e);
 }
 
@@ -53,19 +73,27 @@ void TestManager::RunTests()
 
         testTime.Begin();
 
-        try
+        if (test.isBenchmark && !m_runBenchmarks)
         {
-            test.func();
-            test.result.code = true;
+            test.result.code    = SKIPPED;
+            test.result.message = "Benchmarks only run with --benchmarks or C3D_RUN_BENCHMARKS=1.";
         }
-        catch (const ExpectException& exc)
+        else
         {
-            auto what = exc.what();
-
-            test.result.code    = false;
-            test.result.message = what;
-
-            C3D::Logger::Error(what);
+            try
+            {
+                test.func();
+                test.result.code = true;
+            }
+            catch (const ExpectException& exc)
+            {
+                auto what = exc.what();
+
+                test.result.code    = false;
+                test.result.message = what;
+
+                C3D::Logger::Error(what);
+            }
         }
 
         testTime.End();
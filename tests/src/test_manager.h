@@ -8,6 +8,8 @@
 #include <vector>
 
 #define REGISTER_TEST(name, description) manager.Register(name, #name, description)
+/** @brief Registers a test that is SKIPPED unless benchmarks are enabled (with --benchmarks or the C3D_RUN_BENCHMARKS env var). */
+#define REGISTER_BENCHMARK(name, description) manager.Register(name, #name, description, true)
 
 #define TEST(name) void name()
 
@@ -28,6 +30,7 @@ struct TestEntry
     int index;
     TestFunc func;
     TestResult result;
+    bool isBenchmark;
 
     std::string name;
     std::string description;
@@ -37,11 +40,14 @@ struct TestEntry
 class TestManager
 {
 public:
-    TestManager(u64 memorySize);
+    TestManager(u64 memorySize, bool runBenchmarks = false);
     ~TestManager();
 
+    /** @brief Checks if benchmarks should run (--benchmarks is passed on the command line or the C3D_RUN_BENCHMARKS env var is set). */
+    static bool ShouldRunBenchmarks(int argc, char** argv);
+
     void StartType(const std::string& type);
-    void Register(TestFunc func, const std::string& name, const std::string& description);
+    void Register(TestFunc func, const std::string& name, const std::string& description, bool isBenchmark = false);
 
     void RunTests();
 
@@ -49,6 +55,8 @@ private:
     std::string m_currentType;
     std::string m_prevType;
 
+    bool m_runBenchmarks = false;
+
     std::vector<TestEntry> m_tests;
     std::vector<TestEntry> m_skipped;
     std::vector<TestEntry> m_failures;
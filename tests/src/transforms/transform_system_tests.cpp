@@ -0,0 +1,228 @@
+#include "transform_system_tests.h"
+
+#include <containers/dynamic_array.h>
+#include <cson/cson_types.h>
+#include <logger/logger.h>
+#include <math/c3d_math.h>
+#include <platform/platform.h>
+#include <random/random.h>
+#include <systems/transforms/transform_system.h>
+
+#include "../expect.h"
+
+namespace TransformSystem
+{
+    static vec3 GenerateRandomVector(const f32 low, const f32 high)
+    {
+        return vec3(C3D::Random.Generate(low, high), C3D::Random.Generate(low, high), C3D::Random.Generate(low, high));
+    }
+
+    static quat GenerateRandomRotation()
+    {
+        auto axis = GenerateRandomVector(-1.0f, 1.0f);
+        if (glm::length(axis) < 0.01f) axis = C3D::VEC3_UP;
+        return glm::angleAxis(C3D::Random.Generate(-C3D::PI, C3D::PI), glm::normalize(axis));
+    }
+
+    static void AcquireRandomTransforms(C3D::TransformSystem& transforms, C3D::DynamicArray<C3D::Handle<C3D::Transform>>& handles,
+                                        const u32 count)
+    {
+        for (u32 i = 0; i < count; ++i)
+        {
+            handles.PushBack(transforms.Acquire(GenerateRandomVector(-100.0f, 100.0f), GenerateRandomRotation(),
+                                                GenerateRandomVector(0.1f, 10.0f)));
+        }
+    }
+
+    /** @brief The way the local matrix was calculated before we had a batched update. */
+    static mat4 ReferenceLocal(C3D::TransformSystem& transforms, C3D::Handle<C3D::Transform> handle, const vec3& scale)
+    {
+        return glm::translate(transforms.GetPosition(handle)) * glm::mat4_cast(transforms.GetRotation(handle)) * glm::scale(scale);
+    }
+
+    static void ExpectMatricesEqual(const mat4& expected, const mat4& actual)
+    {
+        for (u32 c = 0; c < 4; ++c)
+        {
+            for (u32 r = 0; r < 4; ++r)
+            {
+                ExpectFloatEqual(expected[c][r], actual[c][r]);
+            }
+        }
+    }
+
+    TEST(UpdateAllDirtyShouldMatchTheScalarCalculation)
+    {
+        C3D::TransformSystem transforms;
+        ExpectTrue(transforms.OnInit(C3D::CSONObject(C3D::CSONObjectType::Object)));
+
+        // Use an amount that is not a multiple of our batch size so the scalar tail is also tested
+        constexpr u32 count = 1003;
+
+        C3D::DynamicArray<C3D::Handle<C3D::Transform>> handles(count);
+        C3D::DynamicArray<vec3> scales(count);
+        for (u32 i = 0; i < count; ++i)
+        {
+            const auto scale = GenerateRandomVector(0.1f, 10.0f);
+            handles.PushBack(transforms.Acquire(GenerateRandomVector(-100.0f, 100.0f), GenerateRandomRotation(), scale));
+            scales.PushBack(scale);
+        }
+
+        for (const auto handle : handles) ExpectTrue(transforms.IsDirty(handle));
+
+        ExpectEqual(count, transforms.UpdateAllDirty());
+
+        for (u32 i = 0; i < count; ++i)
+        {
+            const auto expected = ReferenceLocal(transforms, handles[i], scales[i]);
+            ExpectMatricesEqual(expected, transforms.GetLocal(handles[i]));
+
+            // The determinant of the full matrix (compared relative to it's size since our scales go up to 1000x)
+            const auto determinant = glm::determinant(expected);
+            ExpectFloatEqual(1.0f, transforms.GetLocalDeterminant(handles[i]) / determinant);
+
+            ExpectFalse(transforms.IsDirty(handles[i]));
+            ExpectEqual(1, transforms.GetLocalGeneration(handles[i]));
+        }
+
+        // Nothing is dirty anymore so a second update should not do anything
+        ExpectEqual(0, transforms.UpdateAllDirty());
+
+        handles.Destroy();
+        scales.Destroy();
+        transforms.OnShutdown();
+    }
+
+    TEST(UpdateAllDirtyShouldOnlyUpdateDirtyTransforms)
+    {
+        C3D::TransformSystem transforms;
+        ExpectTrue(transforms.OnInit(C3D::CSONObject(C3D::CSONObjectType::Object)));
+
+        constexpr u32 count = 500;
+
+        C3D::DynamicArray<C3D::Handle<C3D::Transform>> handles(count);
+        AcquireRandomTransforms(transforms, handles, count);
+        ExpectEqual(count, transforms.UpdateAllDirty());
+
+        // Change every third transform and release every seventh (which should not be updated even if it was dirty)
+        u32 expectedDirty = 0;
+        for (u32 i = 0; i < count; ++i)
+        {
+            if (i % 3 == 0)
+            {
+                transforms.Translate(handles[i], vec3(1.0f, 2.0f, 3.0f));
+                if (i % 7 != 0) expectedDirty++;
+            }
+        }
+
+        for (u32 i = 0; i < count; i += 7) transforms.Release(handles[i]);
+
+        ExpectEqual(expectedDirty, transforms.UpdateAllDirty());
+
+        for (u32 i = 0; i < count; ++i)
+        {
+            if (!handles[i].IsValid()) continue;
+
+            const u32 expectedGeneration = i % 3 == 0 ? 2 : 1;
+            ExpectEqual(expectedGeneration, transforms.GetLocalGeneration(handles[i]));
+            ExpectFalse(transforms.IsDirty(handles[i]));
+        }
+
+        handles.Destroy();
+        transforms.OnShutdown();
+    }
+
+    TEST(UpdateLocalShouldMatchUpdateAllDirty)
+    {
+        C3D::TransformSystem transforms;
+        ExpectTrue(transforms.OnInit(C3D::CSONObject(C3D::CSONObjectType::Object)));
+
+        constexpr u32 count = 64;
+
+        C3D::DynamicArray<C3D::Handle<C3D::Transform>> handles(count);
+        AcquireRandomTransforms(transforms, handles, count);
+        transforms.UpdateAllDirty();
+
+        C3D::DynamicArray<mat4> batched(count);
+        for (const auto handle : handles) batched.PushBack(transforms.GetLocal(handle));
+
+        // Mark everything as dirty again without changing anything and update the transforms one by one
+        for (const auto handle : handles) transforms.Translate(handle, vec3(0.0f));
+        for (const auto handle : handles) ExpectTrue(transforms.UpdateLocal(handle));
+        for (const auto handle : handles) ExpectFalse(transforms.UpdateLocal(handle));
+
+        for (u32 i = 0; i < count; ++i)
+        {
+            ExpectMatricesEqual(batched[i], transforms.GetLocal(handles[i]));
+            ExpectEqual(2, transforms.GetLocalGeneration(handles[i]));
+        }
+
+        handles.Destroy();
+        batched.Destroy();
+        transforms.OnShutdown();
+    }
+
+    TEST(UpdateAllDirtyBenchmark)
+    {
+        constexpr u32 counts[] = { 1000, 10000, 50000, 100000 };
+        constexpr u32 runs     = 10;
+
+        for (const auto count : counts)
+        {
+            C3D::TransformSystem transforms;
+            ExpectTrue(transforms.OnInit(C3D::CSONObject(C3D::CSONObjectType::Object)));
+
+            C3D::DynamicArray<C3D::Handle<C3D::Transform>> handles(count);
+            C3D::DynamicArray<mat4> results(count);
+            AcquireRandomTransforms(transforms, handles, count);
+            results.Resize(count);
+
+            // The old way of calculating every local matrix with glm
+            auto start = C3D::Platform::GetAbsoluteTime();
+            for (u32 run = 0; run < runs; ++run)
+            {
+                for (u32 i = 0; i < count; ++i)
+                {
+                    const auto handle = handles[i];
+                    results[i] = glm::translate(transforms.GetPosition(handle)) * glm::mat4_cast(transforms.GetRotation(handle)) *
+                                 glm::scale(vec3(1.0f));
+                }
+            }
+            const auto glmTime = (C3D::Platform::GetAbsoluteTime() - start) / runs;
+
+            // Updating every handle one by one
+            start = C3D::Platform::GetAbsoluteTime();
+            for (u32 run = 0; run < runs; ++run)
+            {
+                for (const auto handle : handles) transforms.Translate(handle, vec3(0.0f));
+                for (const auto handle : handles) transforms.UpdateLocal(handle);
+            }
+            const auto singleTime = (C3D::Platform::GetAbsoluteTime() - start) / runs;
+
+            // Updating all dirty transforms in one batch
+            start = C3D::Platform::GetAbsoluteTime();
+            for (u32 run = 0; run < runs; ++run)
+            {
+                for (const auto handle : handles) transforms.Translate(handle, vec3(0.0f));
+                ExpectEqual(count, transforms.UpdateAllDirty());
+            }
+            const auto batchTime = (C3D::Platform::GetAbsoluteTime() - start) / runs;
+
+            C3D::Logger::Info("{:>6} transforms: glm {:.3f}ms, UpdateLocal() {:.3f}ms, UpdateAllDirty() {:.3f}ms ({:.1f}x faster).", count,
+                              glmTime * 1000.0, singleTime * 1000.0, batchTime * 1000.0, glmTime / batchTime);
+
+            handles.Destroy();
+            results.Destroy();
+            transforms.OnShutdown();
+        }
+    }
+
+    void RegisterTests(TestManager& manager)
+    {
+        manager.StartType("TransformSystem");
+        REGISTER_TEST(UpdateAllDirtyShouldMatchTheScalarCalculation, "Transforms.UpdateAllDirty() should give the same results as glm.");
+        REGISTER_TEST(UpdateAllDirtyShouldOnlyUpdateDirtyTransforms, "Transforms.UpdateAllDirty() should only update dirty transforms.");
+        REGISTER_TEST(UpdateLocalShouldMatchUpdateAllDirty, "Transforms.UpdateLocal() should give the same results as the batched update.");
+        REGISTER_BENCHMARK(UpdateAllDirtyBenchmark, "Benchmark Transforms.UpdateAllDirty() against glm for 1K to 100K transforms.");
+    }
+}  // namespace TransformSystem